@@ -53,6 +53,8 @@ namespace SystemConstants {
     constexpr uint32_t WIFI_CONNECT_TIMEOUT_MS = 10000;
     constexpr uint32_t WIFI_SCAN_TIMEOUT_MS = 5000;
     constexpr uint8_t WIFI_MAX_RETRY_ATTEMPTS = 3;
+    constexpr uint32_t WIFI_FAST_CONNECT_TIMEOUT_MS = 3000;  // Directed join before falling back to a scan
+    constexpr bool WIFI_FAST_CONNECT_STATIC_IP = false;     // Join with the cached lease; DHCP still restarts from scratch after
     
     // Network constants
     constexpr uint16_t NETWORK_TIMEOUT_MS = 5000;
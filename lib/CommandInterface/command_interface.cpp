@@ -22,14 +22,22 @@
 #include "command_interface.h"
 #include "wifi_manager.h"
 #include "wifi_task.h"
+#include "wifi_scan.h"
 #include "ap_manager.h"
 #include "ap_config.h"
 #include "station_config.h"
 #include "iperf_manager.h"
 #include "led_controller.h"
 #include "latency_analyzer.h"
+#include "echo_service.h"
+#include "traceroute.h"
+#include "pmtu_discovery.h"
+#include "dns_resolver.h"
+#include "host_discovery.h"
 #include "channel_analyzer.h"
+#include "airtime_monitor.h"
 #include "signal_monitor.h"
+#include "rogue_detector.h"
 #include "config.h"
 #include <esp_system.h>
 #ifdef USE_WEBSERVER
@@ -127,7 +135,9 @@ void executeCommand(String command) {
     if (currentMode == MODE_STATION) {
       scanningEnabled = true;
       Serial.println("✓ WiFi scanning ENABLED");
+      Serial.println("  Full table first, then only networks that change");
       lastScan = 0; // Force immediate scan
+      startWiFiScanUpdates();
 #ifdef USE_NEOPIXEL
       // Brief cyan flash to indicate scan enabled
       setNeoPixelColor(0, 255, 255);
@@ -154,6 +164,18 @@ void executeCommand(String command) {
   else if (command == "scan now" && currentMode == MODE_STATION) {
     performWiFiScan(); // Immediate detailed scan
   }
+  else if (command == "scan events") {
+    printWiFiScanEvents();
+  }
+  else if (command.startsWith("scan events threshold ")) {
+    int threshold = command.substring(22).toInt();
+    if (threshold < 1 || threshold > 40) {
+      Serial.println("✗ Error: Threshold must be 1-40 dB");
+    } else {
+      setWiFiScanEventThreshold((uint8_t)threshold);
+      Serial.printf("✓ Signal changes of %d dB or more are now reported\n", threshold);
+    }
+  }
   else if (command.startsWith("scan info ") && currentMode == MODE_STATION) {
     String networkId = command.substring(10);
     networkId.trim();
@@ -717,6 +739,36 @@ void executeCommand(String command) {
   else if (command == "jitter") {
     executeJitterAnalysis();
   }
+  else if (command.startsWith("echo ")) {
+    executeEchoCommand(command);
+  }
+  else if (command == "echo") {
+    printEchoServiceStatus();
+  }
+  else if (command.startsWith("trace ")) {
+    executeTraceCommand(command);
+  }
+  else if (command == "trace") {
+    printTraceHelp();
+  }
+  else if (command.startsWith("pmtu ")) {
+    executePmtuCommand(command);
+  }
+  else if (command == "pmtu") {
+    printPmtuHelp();
+  }
+  else if (command.startsWith("dns ")) {
+    executeDnsCommand(command);
+  }
+  else if (command == "dns") {
+    printDnsHelp();
+  }
+  else if (command.startsWith("discover ")) {
+    executeDiscoverCommand(command);
+  }
+  else if (command == "discover") {
+    printDiscoverHelp();
+  }
   else if (command == "network analysis") {
     executeNetworkAnalysis("");
   }
@@ -738,6 +790,9 @@ void executeCommand(String command) {
   else if (command == "signal") {
     printSignalHelp();
   }
+  else if (command == "rogue" || command.startsWith("rogue ")) {
+    executeRogueCommand(command, originalCommand);
+  }
   else if (command == "reset" || command == "restart") {
     executeResetCommand();
   }
@@ -800,6 +855,11 @@ void executeResetCommand() {
   // Stop latency analysis if running
   Serial.println("   - Stopping latency analysis");
   shutdownLatencyAnalysis();
+  stopEchoService();
+  stopTraceroute();
+  stopPmtuDiscovery();
+  stopDnsBenchmark();
+  stopHostDiscovery();
   
   // Stop channel monitoring
   Serial.println("   - Stopping channel monitoring");
@@ -899,6 +959,10 @@ void printHelp() {
   Serial.println("│ scan off        │ Stop WiFi scanning                   │");
   Serial.println("│ scan now        │ Perform detailed scan immediately    │");
   Serial.println("│ scan info <id>  │ Show detailed info for network ID    │");
+  Serial.println("│ scan events     │ Show networks that changed between   │");
+  Serial.println("│                 │   scans (appeared, vanished, moved)  │");
+  Serial.println("│ scan events     │ Set signal change to report          │");
+  Serial.println("│   threshold <n> │   (dB, default 10)                   │");
   Serial.println("│ connect <s> <p> │ Connect to network (station mode)    │");
   Serial.println("│   [security]    │   Security: auto, wpa3prefer, etc.   │");
   Serial.println("│ disconnect      │ Disconnect from network (station)    │");
@@ -927,6 +991,17 @@ void printHelp() {
   Serial.println("│ latency test    │ Start basic latency test             │");
   Serial.println("│ latency status  │ Show current latency test status     │");
   Serial.println("│ jitter          │ Quick jitter analysis                │");
+  Serial.println("│ echo start [p]  │ Start UDP echo service (default 7)   │");
+  Serial.println("│ echo stop       │ Stop UDP echo service                │");
+  Serial.println("│ echo status     │ Show echo counters and turnaround    │");
+  Serial.println("│ trace <host>    │ Traceroute with per-hop latency      │");
+  Serial.println("│ trace stop      │ Stop traceroute / MTR run            │");
+  Serial.println("│ pmtu <host>     │ Path MTU and fragmentation cost      │");
+  Serial.println("│ pmtu apply      │ Use discovered size for iPerf UDP    │");
+  Serial.println("│ dns <host>      │ Resolve through the DNS cache        │");
+  Serial.println("│ dns bench       │ Benchmark resolvers (cold/warm)      │");
+  Serial.println("│ discover start  │ Find hosts on the local subnet       │");
+  Serial.println("│ discover scan   │ Find hosts and scan their ports      │");
   Serial.println("│ network analysis│ Comprehensive network analysis       │");
   Serial.println("│ channel         │ Show channel congestion help         │");
   Serial.println("│ channel scan    │ Analyze channel congestion           │");
@@ -936,6 +1011,9 @@ void printHelp() {
   Serial.println("│ signal show     │ Display current signal strength      │");
   Serial.println("│ signal scan     │ Scan all nearby networks             │");
   Serial.println("│ signal monitor  │ Start continuous signal monitoring   │");
+  Serial.println("│ rogue           │ Rogue / evil-twin AP detector status │");
+  Serial.println("│ rogue learn <s> │ Learn the real APs of an SSID        │");
+  Serial.println("│ rogue on|off    │ Start/stop rogue AP monitoring       │");
 #ifdef USE_WEBSERVER
   Serial.println("│ webserver       │ Show web server help                 │");
   Serial.println("│ webserver start │ Start web server on port 80          │");
@@ -947,7 +1025,7 @@ void printHelp() {
   Serial.println("│ help            │ Show this help                       │");
   Serial.println("└─────────────────┴──────────────────────────────────────┘");
   Serial.println();
-  Serial.println("💡 TIP: Use 'station', 'iperf', 'latency', 'channel', 'signal' for detailed help");
+  Serial.println("💡 TIP: Use 'station', 'iperf', 'latency', 'channel', 'signal', 'rogue help' for detailed help");
   Serial.println();
 }
 
@@ -1087,7 +1165,8 @@ void printStatus() {
       
       // Connection uptime
       Serial.print("  Connection Time: ");
-      unsigned long uptimeSeconds = millis() / 1000;
+      unsigned long connectedSince = getStationConnectedSince();
+      unsigned long uptimeSeconds = connectedSince != 0 ? (millis() - connectedSince) / 1000 : 0;
       unsigned long hours = uptimeSeconds / 3600;
       unsigned long minutes = (uptimeSeconds % 3600) / 60;
       unsigned long seconds = uptimeSeconds % 60;
@@ -1124,6 +1203,18 @@ void printStatus() {
           break;
       }
       
+      // Connection state machine and why the link last dropped
+      StationState staState = getStationState();
+      Serial.printf("  Connection State: %s", getStationStateName(staState));
+      if (staState == STA_STATE_BACKOFF) {
+        Serial.printf(" (retry in %lu ms)", (unsigned long)getStationRetryInMs());
+      }
+      Serial.println();
+      uint8_t reason = getLastDisconnectReason();
+      if (reason != 0) {
+        Serial.printf("  Last Disconnect: reason %u (%s)\n", reason, getDisconnectReasonName(reason));
+      }
+      
       Serial.println("  Use 'scan now' to find networks");
       Serial.println("  Use 'connect <SSID> <password>' to connect");
     }
@@ -1160,6 +1251,12 @@ void executeLatencyCommand(String command) {
   String subCommand = command.substring(8);  // Remove "latency "
   subCommand.trim();
   
+  // The reflector also serves clients in AP mode, so handle it before the STA check
+  if (subCommand.startsWith("reflector")) {
+    executeTwampReflectorCommand(subCommand.substring(9));
+    return;
+  }
+  
   if (WiFi.status() != WL_CONNECTED) {
     Serial.println("❌ Not connected to WiFi. Connect to network first.");
     return;
@@ -1186,6 +1283,27 @@ void executeLatencyCommand(String command) {
       Serial.println("✅ HTTP latency test started. Use 'latency status' to monitor progress.");
     }
   }
+  else if (subCommand == "test twamp" || subCommand.startsWith("test twamp ")) {
+    // TWAMP-Light session-sender, defaults to the gateway on port 862
+    LatencyConfig config = getDefaultLatencyConfig(LATENCY_TWAMP_LIGHT);
+    String target = subCommand.substring(10);
+    target.trim();
+    if (target.length() > 0) {
+      int colonIndex = target.indexOf(':');
+      if (colonIndex > 0) {
+        config.target_port = target.substring(colonIndex + 1).toInt();
+        target = target.substring(0, colonIndex);
+      }
+      config.target_host = target;
+    }
+    if (startLatencyTest(config)) {
+      Serial.println("✅ TWAMP-Light test started. Use 'latency status' to monitor progress.");
+    }
+  }
+  else if (subCommand == "test dns" || subCommand.startsWith("test dns ")) {
+    // Resolver benchmark runs as its own task with per-resolver percentiles
+    executeDnsCommand("dns bench" + subCommand.substring(8));
+  }
   else if (subCommand.startsWith("test ")) {
     // Custom test with host
     String host = subCommand.substring(5);
@@ -1223,6 +1341,379 @@ void executeLatencyCommand(String command) {
   }
 }
 
+void executeTwampReflectorCommand(String args) {
+  args.trim();
+  
+  if (args == "start" || args.startsWith("start ")) {
+    uint16_t port = TWAMP_LIGHT_DEFAULT_PORT;
+    String portArg = args.substring(5);
+    portArg.trim();
+    if (portArg.length() > 0) {
+      port = portArg.toInt();
+    }
+    if (port == 0) {
+      Serial.println("❌ Invalid port");
+      return;
+    }
+    startTwampReflector(port);
+  }
+  else if (args == "stop") {
+    stopTwampReflector();
+  }
+  else if (args == "status" || args.length() == 0) {
+    if (!isTwampReflectorRunning()) {
+      Serial.println("📡 TWAMP-Light reflector: stopped");
+      return;
+    }
+    TwampReflectorStats stats = getTwampReflectorStats();
+    Serial.printf("📡 TWAMP-Light reflector: listening on UDP port %u\n", stats.port);
+    Serial.printf("   Reflected: %u | Rejected: %u\n", stats.packets_reflected, stats.packets_rejected);
+    Serial.printf("   Residence time: %u us (last), %u us (max)\n",
+                  stats.last_residence_us, stats.max_residence_us);
+  }
+  else {
+    printLatencyHelp();
+  }
+}
+
+void executeEchoCommand(String command) {
+  String subCommand = command.substring(5);  // Remove "echo "
+  subCommand.trim();
+  
+  if (subCommand == "start" || subCommand.startsWith("start ")) {
+    uint16_t port = ECHO_SERVICE_DEFAULT_PORT;
+    String portArg = subCommand.substring(5);
+    portArg.trim();
+    if (portArg.length() > 0) {
+      port = portArg.toInt();
+    }
+    if (port == 0) {
+      Serial.println("❌ Invalid port");
+      return;
+    }
+    if (startEchoService(port)) {
+      Serial.printf("💡 From a host: ./udp_echo_client <device_ip> %u\n", port);
+    }
+  }
+  else if (subCommand == "stop") {
+    stopEchoService();
+  }
+  else if (subCommand == "status") {
+    printEchoServiceStatus();
+  }
+  else if (subCommand == "reset") {
+    resetEchoServiceStats();
+    Serial.println("✅ Echo service counters reset");
+  }
+  else {
+    Serial.println("Usage: echo start [port] | echo stop | echo status | echo reset");
+  }
+}
+
+// ==========================================
+// TRACEROUTE COMMAND HANDLERS
+// ==========================================
+void executeTraceCommand(String command) {
+  String args = command.substring(6);  // Remove "trace "
+  args.trim();
+
+  if (args == "stop") {
+    stopTraceroute();
+    return;
+  }
+  if (args == "status" || args == "results") {
+    TracerouteState state = getTracerouteState();
+    Serial.printf("Traceroute state: %s\n", tracerouteStateToString(state).c_str());
+    if (state != TRACE_IDLE) {
+      printTracerouteResults(getTracerouteResults());
+    }
+    return;
+  }
+  if (args == "json") {
+    Serial.println(exportTracerouteJSON(getTracerouteResults()));
+    return;
+  }
+  if (args == "help" || args.length() == 0) {
+    printTraceHelp();
+    return;
+  }
+
+  // trace <host> [udp|icmp] [mtr]
+  String host;
+  TracerouteConfig config = getDefaultTracerouteConfig(TRACE_PROBE_UDP);
+  while (args.length() > 0) {
+    int spaceIndex = args.indexOf(' ');
+    String token = spaceIndex > 0 ? args.substring(0, spaceIndex) : args;
+    args = spaceIndex > 0 ? args.substring(spaceIndex + 1) : "";
+    args.trim();
+
+    if (host.length() == 0) {
+      host = token;
+    } else if (token == "udp") {
+      config.probe_type = TRACE_PROBE_UDP;
+    } else if (token == "icmp") {
+      config.probe_type = TRACE_PROBE_ICMP;
+    } else if (token == "mtr") {
+      config.continuous = true;
+    } else {
+      Serial.println("❌ Unknown option: " + token);
+      printTraceHelp();
+      return;
+    }
+  }
+
+  if (WiFi.status() != WL_CONNECTED) {
+    Serial.println("❌ Not connected to WiFi. Connect to network first.");
+    return;
+  }
+
+  if (startTraceroute(host, config) && config.continuous) {
+    Serial.println("💡 MTR mode: use 'trace status' for live results, 'trace stop' to end");
+  }
+}
+
+void printTraceHelp() {
+  Serial.println("\n🛰️ === Traceroute Commands ===");
+  Serial.println("• trace <host> [udp|icmp]   Trace the path once (default: UDP probes)");
+  Serial.println("• trace <host> [udp|icmp] mtr  Re-probe continuously, accumulate per-hop stats");
+  Serial.println("• trace stop                Stop the current trace");
+  Serial.println("• trace status              Show state and per-hop table");
+  Serial.println("• trace json                Print results as JSON");
+  Serial.println("\nProbes for several hops are sent in parallel; each hop reports");
+  Serial.println("loss and last/avg/min/max RTT. !N/!H/!X mark unreachable hops.");
+  Serial.println("==============================\n");
+}
+
+// ==========================================
+// PATH MTU COMMAND HANDLERS
+// ==========================================
+void executePmtuCommand(String command) {
+  String args = command.substring(5);  // Remove "pmtu "
+  args.trim();
+
+  if (args == "stop") {
+    stopPmtuDiscovery();
+    return;
+  }
+  if (args == "status" || args == "results") {
+    PmtuState state = getPmtuState();
+    Serial.printf("PMTU discovery state: %s\n", pmtuStateToString(state).c_str());
+    if (state == PMTU_COMPLETED) {
+      printPmtuResults(getPmtuResults());
+    }
+    return;
+  }
+  if (args == "json") {
+    Serial.println(exportPmtuJSON(getPmtuResults()));
+    return;
+  }
+  if (args == "apply") {
+    PmtuResults results = getPmtuResults();
+    if (getPmtuState() != PMTU_COMPLETED || results.recommended_udp_payload == 0) {
+      Serial.println("❌ No completed PMTU discovery. Run 'pmtu <host>' first.");
+      return;
+    }
+    setIperfDatagramSize(results.recommended_udp_payload);
+    Serial.printf("✅ iPerf UDP datagram size set to %u bytes (path MTU %u)\n",
+                  results.recommended_udp_payload, results.path_mtu);
+    return;
+  }
+  if (args == "help" || args.length() == 0) {
+    printPmtuHelp();
+    return;
+  }
+
+  // pmtu <host> [icmp|udp [port]]
+  String host;
+  PmtuConfig config = getDefaultPmtuConfig(PMTU_PROBE_ICMP);
+  bool expectPort = false;
+  while (args.length() > 0) {
+    int spaceIndex = args.indexOf(' ');
+    String token = spaceIndex > 0 ? args.substring(0, spaceIndex) : args;
+    args = spaceIndex > 0 ? args.substring(spaceIndex + 1) : "";
+    args.trim();
+
+    if (host.length() == 0) {
+      host = token;
+    } else if (token == "icmp") {
+      config.probe_type = PMTU_PROBE_ICMP;
+      expectPort = false;
+    } else if (token == "udp") {
+      config.probe_type = PMTU_PROBE_UDP;
+      expectPort = true;
+    } else if (expectPort && token.toInt() > 0 && token.toInt() <= 65535) {
+      config.udp_port = token.toInt();
+      expectPort = false;
+    } else {
+      Serial.println("❌ Unknown option: " + token);
+      printPmtuHelp();
+      return;
+    }
+  }
+
+  if (WiFi.status() != WL_CONNECTED) {
+    Serial.println("❌ Not connected to WiFi. Connect to network first.");
+    return;
+  }
+
+  startPmtuDiscovery(host, config);
+}
+
+void printPmtuHelp() {
+  Serial.println("\n📏 === Path MTU Commands ===");
+  Serial.println("• pmtu <host> [icmp]         Discover path MTU with ICMP echo probes");
+  Serial.println("• pmtu <host> udp [port]     Use UDP probes (default port 7, echo service)");
+  Serial.println("• pmtu stop                  Stop the current run");
+  Serial.println("• pmtu status                Show MTU, fragmentation cost, recommendations");
+  Serial.println("• pmtu json                  Print results as JSON");
+  Serial.println("• pmtu apply                 Set iPerf UDP datagram size from the result");
+  Serial.println("\nAfter the search, latency/loss/goodput are compared at the MTU and");
+  Serial.println("one byte above it, where every datagram is fragmented.");
+  Serial.println("==============================\n");
+}
+
+// ==========================================
+// DNS COMMAND HANDLERS
+// ==========================================
+void executeDnsCommand(String command) {
+  String args = command.substring(4);  // Remove "dns "
+  args.trim();
+
+  if (args == "cache") {
+    printDnsCache();
+    return;
+  }
+  if (args == "flush") {
+    dnsCacheFlush();
+    Serial.println("✅ DNS cache flushed");
+    return;
+  }
+  if (args == "stop") {
+    stopDnsBenchmark();
+    return;
+  }
+  if (args == "status" || args == "results") {
+    DnsBenchState state = getDnsBenchState();
+    Serial.printf("DNS benchmark state: %s\n", dnsBenchStateToString(state).c_str());
+    if (state == DNS_BENCH_COMPLETED) {
+      printDnsBenchResults(getDnsBenchResults());
+    }
+    return;
+  }
+  if (args == "json") {
+    Serial.println(exportDnsBenchJSON(getDnsBenchResults()));
+    return;
+  }
+  if (args == "help" || args.length() == 0) {
+    printDnsHelp();
+    return;
+  }
+
+  if (WiFi.status() != WL_CONNECTED) {
+    Serial.println("❌ Not connected to WiFi. Connect to network first.");
+    return;
+  }
+
+  if (args == "bench" || args.startsWith("bench ")) {
+    // dns bench [resolver ...]
+    DnsBenchConfig config = getDefaultDnsBenchConfig();
+    String list = args.substring(5);
+    list.trim();
+    while (list.length() > 0) {
+      int spaceIndex = list.indexOf(' ');
+      String token = spaceIndex > 0 ? list.substring(0, spaceIndex) : list;
+      list = spaceIndex > 0 ? list.substring(spaceIndex + 1) : "";
+      list.trim();
+
+      IPAddress resolver;
+      if (!resolver.fromString(token)) {
+        Serial.println("❌ Resolver must be an IP address: " + token);
+        return;
+      }
+      if (config.resolver_count == DNS_BENCH_MAX_RESOLVERS) {
+        Serial.printf("⚠️ At most %d resolvers, ignoring %s\n", DNS_BENCH_MAX_RESOLVERS, token.c_str());
+        continue;
+      }
+      config.resolvers[config.resolver_count++] = (uint32_t)resolver;
+    }
+    startDnsBenchmark(config);
+    return;
+  }
+
+  // dns <host>: resolve through the shared cache
+  IPAddress address;
+  DnsResolveInfo info;
+  if (!dnsResolve(args, address, &info)) {
+    Serial.printf("❌ %s: %s (%.1f ms)\n", args.c_str(), dnsQueryStatusToString(info.status),
+                  info.elapsed_us / 1000.0);
+    return;
+  }
+  const char* source = info.source == DNS_SOURCE_CACHE ? "cache" :
+                       info.source == DNS_SOURCE_LITERAL ? "literal" : "resolver";
+  Serial.printf("🔎 %s -> %s (%s, %.2f ms, TTL %lus)\n", args.c_str(), address.toString().c_str(),
+                source, info.elapsed_us / 1000.0, (unsigned long)info.ttl_remaining_s);
+}
+
+void printDnsHelp() {
+  Serial.println("\n🌐 === DNS Commands ===");
+  Serial.println("• dns <host>                 Resolve through the shared cache (shows source/TTL)");
+  Serial.println("• dns cache                  List cached answers, hit/miss counters");
+  Serial.println("• dns flush                  Drop all cached answers");
+  Serial.println("• dns bench [ip ...]         Benchmark resolvers (default: DHCP, 1.1.1.1, 8.8.8.8, 9.9.9.9)");
+  Serial.println("• dns stop                   Stop the benchmark");
+  Serial.println("• dns status                 Show benchmark state and results");
+  Serial.println("• dns json                   Print benchmark results as JSON");
+  Serial.println("\nLatency, traceroute, PMTU and iPerf tests resolve through the cache,");
+  Serial.println("so their timings no longer include DNS. Answers live for their TTL.");
+  Serial.println("Benchmark: cold = random names (resolver recursion), warm = cached names.");
+  Serial.println("==============================\n");
+}
+
+// ==========================================
+// HOST DISCOVERY COMMAND HANDLERS
+// ==========================================
+void executeDiscoverCommand(String command) {
+  String args = command.substring(9);  // Remove "discover "
+  args.trim();
+
+  if (args == "stop") {
+    stopHostDiscovery();
+    return;
+  }
+  if (args == "status" || args == "results") {
+    HostDiscoveryState state = getHostDiscoveryState();
+    Serial.printf("Host discovery state: %s\n", hostDiscoveryStateToString(state).c_str());
+    if (state != HOSTDISC_IDLE) {
+      printHostDiscoveryResults(getHostDiscoveryResults());
+    }
+    return;
+  }
+  if (args == "json") {
+    Serial.println(exportHostDiscoveryJSON(getHostDiscoveryResults()));
+    return;
+  }
+  if (args == "start" || args == "scan" || args == "start scan") {
+    if (startHostDiscovery(args.endsWith("scan"))) {
+      Serial.println("💡 Use 'discover status' for the host table, 'discover stop' to end");
+    }
+    return;
+  }
+
+  printDiscoverHelp();
+}
+
+void printDiscoverHelp() {
+  Serial.println("\n🔎 === Host Discovery Commands ===");
+  Serial.println("• discover start            Sweep the local subnet (up to a /24)");
+  Serial.println("• discover scan             Sweep, then scan common ports on each host");
+  Serial.println("• discover stop             Stop the current sweep or scan");
+  Serial.println("• discover status           Show state and host table");
+  Serial.println("• discover json             Print results as JSON");
+  Serial.println("\nOn-link hosts are found by ARP (with MAC and vendor); hosts that");
+  Serial.println("ARP cannot reach are pinged with ICMP echo, then TCP connects.");
+  Serial.println("==============================\n");
+}
+
 void executeJitterAnalysis() {
   if (WiFi.status() != WL_CONNECTED) {
     Serial.println("❌ Not connected to WiFi. Connect to network first.");
@@ -1249,6 +1740,7 @@ void printLatencyHelp() {
   Serial.println("│ latency test     │ Start basic UDP echo latency test    │");
   Serial.println("│ latency test tcp │ Start TCP connection latency test    │");
   Serial.println("│ latency test http│ Start HTTP request latency test      │");
+  Serial.println("│ latency test dns │ Benchmark DNS resolvers (cold/warm)  │");
   Serial.println("│ latency test <ip>│ Test latency to specific host/IP     │");
   Serial.println("│ latency stop     │ Stop current latency test            │");
   Serial.println("│ latency reset    │ Reset latency analyzer to idle       │");
@@ -1262,6 +1754,13 @@ void printLatencyHelp() {
   Serial.println("• UDP Echo: Tests round-trip time via UDP packets");
   Serial.println("• TCP Connect: Measures TCP connection establishment time");
   Serial.println("• HTTP Request: Tests HTTP response time");
+  Serial.println("• TWAMP-Light: RFC 5357 test session against standard reflectors");
+  Serial.println("• DNS: Query time per resolver, cold (recursion) vs warm (cached)");
+  Serial.println();
+  Serial.println("📡 TWAMP-Light:");
+  Serial.println("• latency test twamp [host[:port]]  Probe a reflector (default: gateway:862)");
+  Serial.println("• latency reflector start [port]    Reflect TWAMP-Light packets (default 862)");
+  Serial.println("• latency reflector stop|status     Stop reflector or show counters");
   Serial.println();
   Serial.println("📈 Metrics Measured:");
   Serial.println("• Latency: Round-trip time (min/max/average)");
@@ -1274,6 +1773,104 @@ void printLatencyHelp() {
 // ==========================================
 // CHANNEL ANALYSIS COMMAND HANDLERS
 // ==========================================
+// Plan of the last 'channel scan', analyzed when its scan lands
+static ChannelScanConfig pendingChannelConfig;
+
+static ChannelScanConfig getSpectrumScanConfig() {
+  ChannelScanConfig config = getDefaultChannelScanConfig();
+  config.detailed_analysis = true;
+  config.scan_duration_ms = 5000; // Longer scan for detailed analysis
+  return config;
+}
+
+/**
+ * Parse a scan plan: [channels] [<n>ms] [passive]
+ * channels is a comma list, each entry optionally with its own dwell
+ * ("1,6:800,11"); <n>ms is the time budget shared by the other channels.
+ */
+static bool parseChannelScanPlan(String args, ChannelScanConfig& config) {
+  args.trim();
+  while (args.length() > 0) {
+    int space = args.indexOf(' ');
+    String token = space < 0 ? args : args.substring(0, space);
+    args = space < 0 ? "" : args.substring(space + 1);
+    args.trim();
+
+    if (token == "passive") {
+      config.passive_scan = true;
+    } else if (token.endsWith("ms")) {
+      long budget = token.toInt();
+      if (budget <= 0) return false;
+      config.scan_duration_ms = budget > UINT16_MAX ? UINT16_MAX : budget;
+    } else {
+      config.channel_count = 0;
+      int start = 0;
+      while (start < (int)token.length()) {
+        int comma = token.indexOf(',', start);
+        String entry = token.substring(start, comma < 0 ? token.length() : comma);
+        start = comma < 0 ? token.length() : comma + 1;
+
+        int colon = entry.indexOf(':');
+        long ch = entry.toInt();
+        if (!isValidChannel(ch) || config.channel_count >= sizeof(config.channels)) return false;
+        config.channels[config.channel_count++] = ch;
+        if (colon >= 0) {
+          long dwell = entry.substring(colon + 1).toInt();
+          if (dwell <= 0) return false;
+          config.channel_dwell_ms[ch] = constrain(dwell, WIFI_SCAN_MIN_DWELL_MS, WIFI_SCAN_MAX_DWELL_MS);
+        }
+      }
+      if (config.channel_count == 0) return false;
+    }
+  }
+  return true;
+}
+
+// Scan callbacks: the analysis runs from the main loop once the background scan lands
+static void printChannelScan(bool success) {
+  promptShown = false;
+  if (!success) {
+    Serial.println("❌ WiFi scan failed");
+    return;
+  }
+  ChannelAnalysisResults results = performChannelCongestionScan(pendingChannelConfig);
+  printChannelAnalysisResults(results);
+  printChannelRecommendations(results);
+}
+
+static void printQuickChannelScan(bool success) {
+  promptShown = false;
+  if (!success) {
+    Serial.println("❌ WiFi scan failed");
+    return;
+  }
+  ChannelAnalysisResults results = quickChannelScan();
+  printChannelCongestionSummary(results);
+}
+
+static void printSpectrumAnalysis(bool success) {
+  promptShown = false;
+  if (!success) {
+    Serial.println("❌ WiFi scan failed");
+    return;
+  }
+  ChannelAnalysisResults results = performChannelCongestionScan(getSpectrumScanConfig());
+  printChannelAnalysisResults(results);
+  printChannelRecommendations(results);
+  
+  Serial.println("\n" + generateChannelOptimizationReport(results));
+}
+
+static void printAirtimeResults(bool success) {
+  promptShown = false;
+  AirtimeStats stats;
+  if (!success || !getAirtimeStats(stats)) {
+    Serial.println("❌ Airtime survey stopped or failed");
+    return;
+  }
+  printAirtimeSurvey(stats);
+}
+
 void executeChannelCommand(String command) {
   String subCommand = command.substring(8);  // Remove "channel "
   subCommand.trim();
@@ -1283,18 +1880,53 @@ void executeChannelCommand(String command) {
     return;
   }
   
-  if (subCommand == "scan") {
+  if (subCommand == "scan" || subCommand.startsWith("scan ")) {
+    // Optional plan: channel scan [1,6:800,11] [<n>ms] [passive]
+    ChannelScanConfig config = getDefaultChannelScanConfig();
+    if (!parseChannelScanPlan(subCommand.substring(4), config)) {
+      Serial.println("❌ Usage: channel scan [ch[:ms],...] [<budget>ms] [passive]");
+      return;
+    }
     Serial.println("🔍 Starting comprehensive channel congestion scan...");
-    ChannelAnalysisResults results = performChannelCongestionScan(getDefaultChannelScanConfig());
-    printChannelAnalysisResults(results);
-    printChannelRecommendations(results);
+    pendingChannelConfig = config;
+    if (!requestChannelScan(config, printChannelScan)) {
+      Serial.println("❌ Could not start WiFi scan (scanner busy?)");
+    }
   }
   else if (subCommand == "quick") {
     Serial.println("🔍 Performing quick channel scan...");
-    ChannelAnalysisResults results = quickChannelScan();
-    printChannelCongestionSummary(results);
+    if (!requestChannelScan(getQuickChannelScanConfig(), printQuickChannelScan)) {
+      Serial.println("❌ Could not start WiFi scan (scanner busy?)");
+    }
   }
-  else if (subCommand == "monitor start") {
+  else if (subCommand == "airtime stop") {
+    stopAirtimeSurvey();
+    Serial.println("⏹️ Stopping airtime survey after the current channel...");
+  }
+  else if (subCommand == "airtime" || subCommand.startsWith("airtime ")) {
+    // Optional dwell time per channel in ms: channel airtime [dwell_ms]
+    String dwellStr = subCommand.substring(7);
+    dwellStr.trim();
+    uint16_t dwellMs = dwellStr.length() > 0 ? dwellStr.toInt() : AIRTIME_DEFAULT_DWELL_MS;
+    if (WiFi.status() == WL_CONNECTED) {
+      Serial.println("❌ Airtime survey hops channels and would drop the connection. Use 'disconnect' first.");
+      return;
+    }
+    if (!startAirtimeSurvey(dwellMs, AIRTIME_DEFAULT_PASSES, printAirtimeResults)) {
+      Serial.println("❌ Could not start airtime survey (radio busy?)");
+      return;
+    }
+    Serial.printf("📡 Measuring airtime on channels 1-13 (%u ms per channel, %u passes)...\n",
+                  constrain(dwellMs, AIRTIME_MIN_DWELL_MS, AIRTIME_MAX_DWELL_MS), AIRTIME_DEFAULT_PASSES);
+  }
+  else if (subCommand == "monitor start" || subCommand.startsWith("monitor start ")) {
+    // Same plan syntax as 'channel scan', e.g. a fast 1/6/11 watch: monitor start 1,6,11 300ms
+    ChannelScanConfig config = getDefaultChannelScanConfig();
+    if (!parseChannelScanPlan(subCommand.substring(13), config)) {
+      Serial.println("❌ Usage: channel monitor start [ch[:ms],...] [<budget>ms] [passive]");
+      return;
+    }
+    channelScanConfig = config;
     startChannelMonitoring(30); // 30 second interval
   }
   else if (subCommand == "monitor stop") {
@@ -1303,6 +1935,9 @@ void executeChannelCommand(String command) {
   else if (subCommand == "monitor status") {
     Serial.println(getChannelMonitoringStatus());
   }
+  else if (subCommand == "history") {
+    printChannelHistory();
+  }
   else if (subCommand == "recommendations") {
     if (getLastChannelAnalysis().total_networks > 0) {
       printChannelRecommendations(getLastChannelAnalysis());
@@ -1337,8 +1972,9 @@ void executeChannelCongestionScan() {
   }
   
   Serial.println("🔍 Quick channel congestion analysis...");
-  ChannelAnalysisResults results = quickChannelScan();
-  printChannelCongestionSummary(results);
+  if (!requestChannelScan(getQuickChannelScanConfig(), printQuickChannelScan)) {
+    Serial.println("❌ Could not start WiFi scan (scanner busy?)");
+  }
 }
 
 void executeSpectrumAnalysis() {
@@ -1348,16 +1984,9 @@ void executeSpectrumAnalysis() {
   }
   
   Serial.println("🌐 Full spectrum analysis starting...");
-  
-  ChannelScanConfig config = getDefaultChannelScanConfig();
-  config.detailed_analysis = true;
-  config.scan_duration_ms = 5000; // Longer scan for detailed analysis
-  
-  ChannelAnalysisResults results = performChannelCongestionScan(config);
-  printChannelAnalysisResults(results);
-  printChannelRecommendations(results);
-  
-  Serial.println("\n" + generateChannelOptimizationReport(results));
+  if (!requestChannelScan(getSpectrumScanConfig(), printSpectrumAnalysis)) {
+    Serial.println("❌ Could not start WiFi scan (scanner busy?)");
+  }
 }
 
 void printChannelHelp() {
@@ -1366,9 +1995,13 @@ void printChannelHelp() {
   Serial.println("│ Command             │ Description                          │");
   Serial.println("├─────────────────────┼──────────────────────────────────────┤");
   Serial.println("│ channel scan        │ Comprehensive channel analysis       │");
+  Serial.println("│ channel scan <plan> │ Scan e.g. 1,6:800,11 300ms passive   │");
   Serial.println("│ channel quick       │ Quick channel congestion check       │");
+  Serial.println("│ channel airtime [ms]│ Measure airtime utilization per ch.  │");
+  Serial.println("│ channel airtime stop│ Stop a running airtime survey        │");
   Serial.println("│ channel monitor start│ Start continuous channel monitoring │");
   Serial.println("│ channel monitor stop│ Stop channel monitoring              │");
+  Serial.println("│ channel history     │ Trends and peaks from past scans     │");
   Serial.println("│ channel recommendations│ Show channel recommendations      │");
   Serial.println("│ channel report      │ Generate optimization report         │");
   Serial.println("│ channel export      │ Export data in JSON format           │");
@@ -1381,6 +2014,7 @@ void printChannelHelp() {
   Serial.println("• Network overlap detection");
   Serial.println("• Signal strength analysis");
   Serial.println("• Interference detection");
+  Serial.println("• Measured airtime utilization (promiscuous mode, not connected)");
   Serial.println("• Optimal channel recommendations");
   Serial.println("• Continuous monitoring capability");
   Serial.println();
@@ -1388,6 +2022,8 @@ void printChannelHelp() {
   Serial.println("• Use 'congestion' for quick status check");
   Serial.println("• Use 'spectrum' for detailed analysis");
   Serial.println("• Monitor changes with 'channel monitor start'");
+  Serial.println("• Plans: '1,6,11 300ms' = three channels in 300 ms total;");
+  Serial.println("  '6:800' dwells 800 ms on channel 6; 'passive' only listens");
   Serial.println("• Consider recommendations when setting AP channel");
   Serial.println();
 }
@@ -1427,6 +2063,42 @@ void printWebServerHelp() {
 // ==========================================
 // SIGNAL MONITORING COMMANDS
 // ==========================================
+static void printNearbySignals(bool success) {
+  promptShown = false;
+  if (!success) {
+    Serial.println("❌ WiFi scan failed");
+    return;
+  }
+  
+  std::vector<SignalInfo> networks = getNearbySignalStrengths(20);
+  
+  if (networks.empty()) {
+    Serial.println("No networks found.");
+    return;
+  }
+  
+  Serial.println("\n━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
+  Serial.println("Nearby Networks Signal Strength");
+  Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
+  Serial.println();
+  
+  for (size_t i = 0; i < networks.size(); i++) {
+    Serial.printf("%2d. %-32s %4d dBm  %3d%%  %s%s\n",
+                  i + 1,
+                  networks[i].ssid,
+                  networks[i].rssi,
+                  networks[i].quality,
+                  networks[i].qualityText,
+                  networks[i].isConnected ? " [CONNECTED]" : "");
+    
+    // Show mini signal meter
+    Serial.print("    ");
+    displaySignalMeter(networks[i].rssi);
+  }
+  
+  Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
+}
+
 void executeSignalCommand(String command) {
   if (command == "signal show" || command == "signal status") {
     SignalInfo info = getCurrentSignalStrength();
@@ -1434,33 +2106,9 @@ void executeSignalCommand(String command) {
   }
   else if (command == "signal scan") {
     Serial.println("Scanning nearby networks for signal strength...");
-    std::vector<SignalInfo> networks = getNearbySignalStrengths(20);
-    
-    if (networks.empty()) {
-      Serial.println("No networks found.");
-      return;
-    }
-    
-    Serial.println("\n━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
-    Serial.println("Nearby Networks Signal Strength");
-    Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
-    Serial.println();
-    
-    for (size_t i = 0; i < networks.size(); i++) {
-      Serial.printf("%2d. %-32s %4d dBm  %3d%%  %s%s\n",
-                    i + 1,
-                    networks[i].ssid.c_str(),
-                    networks[i].rssi,
-                    networks[i].quality,
-                    networks[i].qualityText.c_str(),
-                    networks[i].isConnected ? " [CONNECTED]" : "");
-      
-      // Show mini signal meter
-      Serial.print("    ");
-      displaySignalMeter(networks[i].rssi);
+    if (!requestWiFiScan(printNearbySignals)) {
+      Serial.println("❌ Could not start WiFi scan");
     }
-    
-    Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
   }
   else if (command.startsWith("signal monitor ")) {
     String arg = command.substring(15);
@@ -1518,3 +2166,95 @@ void printSignalHelp() {
   Serial.println();
 }
 
+
+// ==========================================
+// ROGUE AP DETECTION FUNCTIONS
+// ==========================================
+void executeRogueCommand(String command, String originalCommand) {
+  if (command == "rogue" || command == "rogue status") {
+    printRogueDetectorStatus();
+  }
+  else if (command == "rogue on") {
+    setRogueDetectorEnabled(true);
+    Serial.println("✓ Rogue AP monitoring enabled");
+    if (getRogueDetector().profileCount == 0) {
+      Serial.println("💡 No SSIDs are protected yet. Use 'rogue learn <ssid>' first.");
+    }
+    if (currentMode != MODE_STATION) {
+      Serial.println("💡 Periodic scans only run in station mode ('mode station')");
+    }
+  }
+  else if (command == "rogue off") {
+    setRogueDetectorEnabled(false);
+    Serial.println("✓ Rogue AP monitoring disabled");
+  }
+  else if (command == "rogue learn" || command.startsWith("rogue learn ")) {
+    String ssid = originalCommand.length() > 12 ? originalCommand.substring(12) : String("");
+    ssid.trim();
+    if ((ssid.startsWith("\"") && ssid.endsWith("\"")) ||
+        (ssid.startsWith("'") && ssid.endsWith("'"))) {
+      ssid = ssid.substring(1, ssid.length() - 1);
+    }
+    if (ssid.length() == 0 && WiFi.status() == WL_CONNECTED) {
+      ssid = WiFi.SSID(); // Protect the network we are connected to
+    }
+    if (ssid.length() == 0 || ssid.length() > ROGUE_SSID_LENGTH) {
+      Serial.println("✗ Error: Usage: rogue learn <ssid> (1-32 characters)");
+      return;
+    }
+    if (currentMode != MODE_STATION) {
+      Serial.println("✗ Error: Learning needs scans. Use 'mode station' first.");
+      return;
+    }
+    int learned = startRogueLearning(ssid.c_str());
+    Serial.printf("✓ Learning \"%s\" for %d s: %d access points from the last scan\n",
+                  ssid.c_str(), ROGUE_LEARN_MS / 1000, learned);
+    Serial.println("💡 Keep the real access points in range; 'rogue on' to start monitoring");
+  }
+  else if (command.startsWith("rogue forget ")) {
+    String ssid = originalCommand.substring(13);
+    ssid.trim();
+    if (ssid == "all") {
+      forgetRogueProfile(nullptr);
+      Serial.println("✓ All rogue AP profiles removed");
+    } else if (forgetRogueProfile(ssid.c_str())) {
+      Serial.printf("✓ \"%s\" is no longer protected\n", ssid.c_str());
+    } else {
+      Serial.printf("✗ Error: \"%s\" has no profile\n", ssid.c_str());
+    }
+  }
+  else if (command == "rogue clear") {
+    clearRogueAlerts();
+    Serial.println("✓ Rogue AP alerts cleared");
+  }
+  else {
+    printRogueHelp();
+  }
+}
+
+void printRogueHelp() {
+  Serial.println("\n🛡️ ROGUE AP DETECTOR COMMANDS:");
+  Serial.println("┌─────────────────────┬──────────────────────────────────────┐");
+  Serial.println("│ Command             │ Description                          │");
+  Serial.println("├─────────────────────┼──────────────────────────────────────┤");
+  Serial.println("│ rogue status        │ Show protected SSIDs and alerts      │");
+  Serial.println("│ rogue learn [ssid]  │ Learn an SSID's real access points   │");
+  Serial.println("│                     │   (default: the connected network)   │");
+  Serial.println("│ rogue on            │ Start monitoring (scans every 30 s)  │");
+  Serial.println("│ rogue off           │ Stop monitoring                      │");
+  Serial.println("│ rogue forget <ssid> │ Stop protecting an SSID ('all')      │");
+  Serial.println("│ rogue clear         │ Clear the alert list                 │");
+  Serial.println("└─────────────────────┴──────────────────────────────────────┘");
+  Serial.println();
+  Serial.println("🚨 Alerts for a protected SSID:");
+  Serial.println("• Unknown BSSID      : broadcast by an access point not learned");
+  Serial.println("• Security downgrade : weaker security than the real network");
+  Serial.println("• Unexpected channel : a channel the real network never used");
+  Serial.println();
+  Serial.println("💡 Usage Tips:");
+  Serial.println("• Learn while only the real access points are in range");
+  Serial.println("• Profiles and the on/off setting survive a restart");
+  Serial.println("• The LED flashes red while an alert was seen in the last 5 minutes");
+  Serial.println("• Access web interface at /rogue for the alert list");
+  Serial.println();
+}
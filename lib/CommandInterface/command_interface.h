@@ -112,6 +112,62 @@ void printStationHelp();
  */
 void executeLatencyCommand(String command);
 
+/**
+ * @brief Execute TWAMP-Light reflector commands (start [port] | stop | status)
+ * @param args Arguments following "latency reflector"
+ */
+void executeTwampReflectorCommand(String args);
+
+/**
+ * @brief Execute UDP echo service commands (start [port] | stop | status | reset)
+ * @param command Full command string starting with "echo "
+ */
+void executeEchoCommand(String command);
+
+/**
+ * @brief Execute traceroute commands (<host> [udp|icmp] [mtr] | stop | status | json)
+ * @param command Full command string starting with "trace "
+ */
+void executeTraceCommand(String command);
+
+/**
+ * @brief Print traceroute command help
+ */
+void printTraceHelp();
+
+/**
+ * @brief Execute path MTU commands (<host> [icmp|udp [port]] | stop | status | json | apply)
+ * @param command Full command string starting with "pmtu "
+ */
+void executePmtuCommand(String command);
+
+/**
+ * @brief Print path MTU command help
+ */
+void printPmtuHelp();
+
+/**
+ * @brief Execute DNS commands (<host> | cache | flush | bench [ip...] | stop | status | json)
+ * @param command Full command string starting with "dns "
+ */
+void executeDnsCommand(String command);
+
+/**
+ * @brief Print DNS command help
+ */
+void printDnsHelp();
+
+/**
+ * @brief Execute host discovery commands (start [scan] | stop | status | json)
+ * @param command Full command string starting with "discover "
+ */
+void executeDiscoverCommand(String command);
+
+/**
+ * @brief Print host discovery command help
+ */
+void printDiscoverHelp();
+
 /**
  * @brief Execute jitter analysis test
  * @details Performs statistical analysis of network latency variation
@@ -161,6 +217,20 @@ void executeSignalCommand(String command);
  */
 void printSignalHelp();
 
+// Rogue AP detection command handlers
+
+/**
+ * @brief Execute rogue AP detector commands
+ * @param command Lowercased command string
+ * @param originalCommand Command as typed, so SSIDs keep their case
+ */
+void executeRogueCommand(String command, String originalCommand);
+
+/**
+ * @brief Print rogue AP detector help information
+ */
+void printRogueHelp();
+
 #ifdef USE_WEBSERVER
 // Web server command handlers
 
@@ -8,6 +8,7 @@
  * - Blinking and pulsing effects
  * - WiFi mode-specific visual feedback
  * - Smooth brightness transitions
+ * - Rogue AP alert flash
  * 
  * @author Arunkumar Mourougappane
  * @version 1.0.0
@@ -16,6 +17,7 @@
 
 #include "led_controller.h"
 #include "wifi_manager.h"
+#include "rogue_detector.h"
 
 #ifdef USE_NEOPIXEL
 // NeoPixel instance
@@ -62,7 +64,29 @@ void blinkLED() {
 #endif
 }
 
+// Fast flash while a rogue AP alert is active, overriding the mode indication
+static void showRogueAlert() {
+  static unsigned long lastFlash = 0;
+  static bool flashState = false;
+  if (millis() - lastFlash < 100) return;
+  flashState = !flashState;
+  lastFlash = millis();
+#ifdef USE_NEOPIXEL
+  if (flashState) {
+    setNeoPixelColor(255, 0, 0); // Red
+  } else {
+    setNeoPixelColor(255, 0, 255); // Magenta
+  }
+#else
+  digitalWrite(LED_PIN, flashState);
+#endif
+}
+
 void updateLEDStatus() {
+  if (isRogueAlertActive()) {
+    showRogueAlert();
+    return;
+  }
 #ifdef USE_NEOPIXEL
   setNeoPixelStatus(currentMode, scanningEnabled);
 #else
@@ -0,0 +1,434 @@
+/**
+ * @file airtime_monitor.cpp
+ * @brief Measured channel airtime utilization implementation
+ *
+ * This file implements:
+ * - Lock-free SPSC ring between the promiscuous callback and the survey task
+ * - Frame duration model for DSSS/CCK, OFDM and HT mixed-format frames
+ * - Per-channel, per-frame-type aggregation of frames, bytes and airtime
+ * - ESP32 channel survey task hopping channels 1-13
+ *
+ * @author Arunkumar Mourougappane
+ * @version 4.3.0
+ * @date 2026-01-17
+ */
+
+#include "airtime_monitor.h"
+#include <string.h>
+
+#ifdef ARDUINO
+#include <WiFi.h>
+#include <esp_wifi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "wifi_scan.h"
+#include "wifi_manager.h"
+#include "logging.h"
+#endif
+
+// ==========================================
+// FRAME RING
+// ==========================================
+
+void airtimeRingClear(AirtimeRing& ring) {
+    ring.head.store(0, std::memory_order_relaxed);
+    ring.tail.store(0, std::memory_order_relaxed);
+    ring.dropped.store(0, std::memory_order_relaxed);
+}
+
+bool airtimeRingPush(AirtimeRing& ring, const AirtimeFrame& frame) {
+    uint32_t head = ring.head.load(std::memory_order_relaxed);
+    uint32_t tail = ring.tail.load(std::memory_order_acquire);
+    if (head - tail >= AIRTIME_RING_SIZE) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    ring.frames[head & (AIRTIME_RING_SIZE - 1)] = frame;
+    // Publish the slot before the consumer can see the new head
+    ring.head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+bool airtimeRingPop(AirtimeRing& ring, AirtimeFrame& frame) {
+    uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint32_t head = ring.head.load(std::memory_order_acquire);
+    if (tail == head) return false;
+    frame = ring.frames[tail & (AIRTIME_RING_SIZE - 1)];
+    // Hand the slot back only after it was copied out
+    ring.tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+// ==========================================
+// AIRTIME MODEL
+// ==========================================
+
+// Legacy PHY rate codes (wifi_phy_rate_t) in 100 kbps units; 0x00-0x07 are DSSS/CCK
+static const uint16_t legacyRates[16] = {
+    10, 20, 55, 110,    // 0x00-0x03: 1, 2, 5.5, 11 Mbps, long preamble
+    10, 20, 55, 110,    // 0x04-0x07: short preamble (0x04 unused)
+    480, 240, 120, 60,  // 0x08-0x0B: 48, 24, 12, 6 Mbps OFDM
+    540, 360, 180, 90   // 0x0C-0x0F: 54, 36, 18, 9 Mbps OFDM
+};
+
+// HT data bits per OFDM symbol and spatial stream, MCS 0-7
+static const uint16_t htBitsPerSymbol20[8] = {26, 52, 78, 104, 156, 208, 234, 260};
+static const uint16_t htBitsPerSymbol40[8] = {54, 108, 162, 216, 324, 432, 486, 540};
+
+#define DSSS_LONG_PREAMBLE_US 192
+#define DSSS_SHORT_PREAMBLE_US 96
+#define OFDM_PREAMBLE_US 20         // L-STF + L-LTF + L-SIG
+#define OFDM_SIGNAL_EXTENSION_US 6  // 2.4GHz ERP-OFDM
+#define OFDM_SERVICE_TAIL_BITS 22   // 16 service + 6 tail bits
+
+static uint32_t ofdmSymbols(uint32_t length, uint32_t bitsPerSymbol) {
+    return (OFDM_SERVICE_TAIL_BITS + 8 * length + bitsPerSymbol - 1) / bitsPerSymbol;
+}
+
+uint32_t airtimeFrameDurationUs(const AirtimeFrame& frame) {
+    if (frame.flags & AIRTIME_FLAG_HT) {
+        uint8_t mcs = frame.rate > 31 ? 31 : frame.rate;
+        uint32_t streams = mcs / 8 + 1;
+        const uint16_t* table = (frame.flags & AIRTIME_FLAG_40MHZ) ? htBitsPerSymbol40 : htBitsPerSymbol20;
+        uint32_t symbols = ofdmSymbols(frame.length, table[mcs % 8] * streams);
+        // Short guard interval: 3.6 us symbols instead of 4 us
+        uint32_t data_us = (frame.flags & AIRTIME_FLAG_SGI) ? (symbols * 36 + 9) / 10 : symbols * 4;
+        // Mixed-format preamble: legacy part, HT-SIG, HT-STF, one HT-LTF per stream
+        uint32_t preamble_us = OFDM_PREAMBLE_US + 8 + 4 + 4 * streams;
+        return preamble_us + data_us + OFDM_SIGNAL_EXTENSION_US;
+    }
+
+    uint8_t code = frame.rate & 0x0F;
+    uint32_t rate = legacyRates[code];
+    if (code < 0x08) {
+        uint32_t preamble_us = code < 0x04 ? DSSS_LONG_PREAMBLE_US : DSSS_SHORT_PREAMBLE_US;
+        return preamble_us + (frame.length * 8 * 10 + rate - 1) / rate;
+    }
+    // OFDM: 4 data bits per symbol for each Mbps
+    uint32_t symbols = ofdmSymbols(frame.length, rate * 4 / 10);
+    return OFDM_PREAMBLE_US + symbols * 4 + OFDM_SIGNAL_EXTENSION_US;
+}
+
+// ==========================================
+// AGGREGATION
+// ==========================================
+
+void airtimeStatsClear(AirtimeStats& stats) {
+    memset(&stats, 0, sizeof(stats));
+    for (AirtimeChannelStats& channel : stats.channels) {
+        channel.max_rssi = -128;
+    }
+}
+
+void airtimeStatsAdd(AirtimeStats& stats, const AirtimeFrame& frame) {
+    if (frame.channel == 0 || frame.channel > AIRTIME_MAX_CHANNEL) return;
+    AirtimeChannelStats& channel = stats.channels[frame.channel];
+    AirtimeTypeStats& type = channel.types[frame.type < AIRTIME_FRAME_TYPES ? frame.type : (uint8_t)AIRTIME_FRAME_MISC];
+    type.frames++;
+    type.bytes += frame.length;
+    type.airtime_us += airtimeFrameDurationUs(frame);
+    if (frame.flags & AIRTIME_FLAG_ERROR) channel.error_frames++;
+    if (frame.rssi > channel.max_rssi) channel.max_rssi = frame.rssi;
+}
+
+void airtimeStatsAddDwell(AirtimeStats& stats, uint8_t channel, uint32_t dwell_us) {
+    if (channel == 0 || channel > AIRTIME_MAX_CHANNEL) return;
+    stats.channels[channel].dwell_us += dwell_us;
+}
+
+uint32_t airtimeChannelBusyUs(const AirtimeStats& stats, uint8_t channel) {
+    if (channel == 0 || channel > AIRTIME_MAX_CHANNEL) return 0;
+    uint32_t busy = 0;
+    for (const AirtimeTypeStats& type : stats.channels[channel].types) {
+        busy += type.airtime_us;
+    }
+    return busy;
+}
+
+uint32_t airtimeChannelFrames(const AirtimeStats& stats, uint8_t channel) {
+    if (channel == 0 || channel > AIRTIME_MAX_CHANNEL) return 0;
+    uint32_t frames = 0;
+    for (const AirtimeTypeStats& type : stats.channels[channel].types) {
+        frames += type.frames;
+    }
+    return frames;
+}
+
+float airtimeUtilization(const AirtimeStats& stats, uint8_t channel) {
+    if (channel == 0 || channel > AIRTIME_MAX_CHANNEL) return -1;
+    uint32_t dwell = stats.channels[channel].dwell_us;
+    if (dwell == 0) return -1;
+    // Frames from overlapping channels can add up to more than the dwell time
+    float utilization = 100.0f * airtimeChannelBusyUs(stats, channel) / dwell;
+    return utilization > 100.0f ? 100.0f : utilization;
+}
+
+const char* airtimeFrameTypeName(uint8_t type) {
+    switch (type) {
+        case AIRTIME_FRAME_MGMT: return "mgmt";
+        case AIRTIME_FRAME_CTRL: return "ctrl";
+        case AIRTIME_FRAME_DATA: return "data";
+        default: return "misc";
+    }
+}
+
+#ifdef ARDUINO
+// ==========================================
+// ESP32 CHANNEL SURVEY
+// ==========================================
+#define AIRTIME_TASK_STACK 3072
+#define AIRTIME_DRAIN_INTERVAL_MS 10   // Ring holds ~25k frames/s at this interval
+#define AIRTIME_LAST_CHANNEL 13
+
+static AirtimeRing airtimeRing;             // Receive callback -> survey task
+static AirtimeStats surveyStats;            // Survey task only
+static AirtimeStats lastAirtimeStats;       // Guarded by airtimeMutex
+static bool haveAirtimeStats = false;       // Guarded by airtimeMutex
+static unsigned long airtimeCompletedAt = 0;
+static SemaphoreHandle_t airtimeMutex = nullptr;
+static TaskHandle_t airtimeTaskHandle = nullptr;
+static AirtimeSurveyCallback airtimeCallback = nullptr;
+static uint16_t surveyDwellMs = AIRTIME_DEFAULT_DWELL_MS;
+static uint8_t surveyPasses = AIRTIME_DEFAULT_PASSES;
+static volatile bool airtimeCancel = false;
+static volatile bool airtimeRunning = false;
+static volatile bool airtimeDone = false;   // Set by the task, cleared by handleAirtimeSurvey()
+static volatile bool airtimeSucceeded = false;
+
+// Runs in the Wi-Fi driver task: copy the metadata and return
+static void airtimeRxCallback(void* buffer, wifi_promiscuous_pkt_type_t type) {
+    const wifi_promiscuous_pkt_t* packet = static_cast<const wifi_promiscuous_pkt_t*>(buffer);
+    const wifi_pkt_rx_ctrl_t& rx = packet->rx_ctrl;
+
+    AirtimeFrame frame;
+    frame.timestamp_us = rx.timestamp;
+    frame.length = rx.sig_len;
+    frame.channel = rx.channel;
+    frame.rssi = rx.rssi;
+    frame.reserved = 0;
+    switch (type) {
+        case WIFI_PKT_MGMT: frame.type = AIRTIME_FRAME_MGMT; break;
+        case WIFI_PKT_CTRL: frame.type = AIRTIME_FRAME_CTRL; break;
+        case WIFI_PKT_DATA: frame.type = AIRTIME_FRAME_DATA; break;
+        default: frame.type = AIRTIME_FRAME_MISC; break;
+    }
+    if (rx.sig_mode != 0) {
+        frame.rate = rx.mcs;
+        frame.flags = AIRTIME_FLAG_HT | (rx.cwb ? AIRTIME_FLAG_40MHZ : 0) | (rx.sgi ? AIRTIME_FLAG_SGI : 0);
+    } else {
+        frame.rate = rx.rate;
+        frame.flags = 0;
+    }
+    if (rx.rx_state != 0) frame.flags |= AIRTIME_FLAG_ERROR;
+
+    airtimeRingPush(airtimeRing, frame);
+}
+
+static void drainAirtimeRing() {
+    AirtimeFrame frame;
+    while (airtimeRingPop(airtimeRing, frame)) {
+        airtimeStatsAdd(surveyStats, frame);
+    }
+}
+
+static void airtimeSurveyTask(void* parameter) {
+    airtimeStatsClear(surveyStats);
+    airtimeRingClear(airtimeRing);
+
+    wifi_promiscuous_filter_t filter = {WIFI_PROMIS_FILTER_MASK_ALL};
+    wifi_promiscuous_filter_t ctrlFilter = {WIFI_PROMIS_CTRL_FILTER_MASK_ALL};
+    esp_wifi_set_promiscuous_filter(&filter);
+    esp_wifi_set_promiscuous_ctrl_filter(&ctrlFilter);
+    esp_wifi_set_promiscuous_rx_cb(airtimeRxCallback);
+    bool finished = esp_wifi_set_promiscuous(true) == ESP_OK;
+    if (!finished) {
+        LOG_ERROR(TAG_CHANNEL, "Failed to enable promiscuous mode");
+    }
+
+    const uint32_t dwell_us = (uint32_t)surveyDwellMs * 1000;
+    for (uint8_t pass = 0; finished && pass < surveyPasses; pass++) {
+        for (uint8_t ch = 1; ch <= AIRTIME_LAST_CHANNEL; ch++) {
+            if (airtimeCancel) {
+                finished = false;
+                break;
+            }
+            esp_wifi_set_channel(ch, WIFI_SECOND_CHAN_NONE);
+            // Frames still queued from the previous channel carry its number
+            drainAirtimeRing();
+            uint32_t start = micros();
+            while (micros() - start < dwell_us) {
+                vTaskDelay(pdMS_TO_TICKS(AIRTIME_DRAIN_INTERVAL_MS));
+                drainAirtimeRing();
+            }
+            airtimeStatsAddDwell(surveyStats, ch, micros() - start);
+        }
+    }
+
+    esp_wifi_set_promiscuous(false);
+    drainAirtimeRing();
+    surveyStats.dropped = airtimeRing.dropped.load(std::memory_order_relaxed);
+    releaseWiFiScanner();
+
+    if (finished) {
+        xSemaphoreTake(airtimeMutex, portMAX_DELAY);
+        lastAirtimeStats = surveyStats;
+        haveAirtimeStats = true;
+        airtimeCompletedAt = millis();
+        xSemaphoreGive(airtimeMutex);
+        LOG_INFO(TAG_CHANNEL, "Airtime survey complete (%lu frames dropped)",
+                 (unsigned long)surveyStats.dropped);
+    }
+
+    airtimeSucceeded = finished;
+    airtimeDone = true;
+    airtimeTaskHandle = nullptr;
+    vTaskDelete(nullptr);
+}
+
+bool startAirtimeSurvey(uint16_t dwellMs, uint8_t passes, AirtimeSurveyCallback onComplete) {
+    if (airtimeRunning) {
+        LOG_WARN(TAG_CHANNEL, "Airtime survey already running");
+        return false;
+    }
+    if ((WiFi.getMode() & WIFI_MODE_STA) == 0 || WiFi.status() == WL_CONNECTED) {
+        LOG_WARN(TAG_CHANNEL, "Airtime survey needs an idle station interface");
+        return false;
+    }
+    // A connection still being set up (or waiting to retry) calls WiFi.begin()
+    // on its own schedule, which would retune the radio under the survey
+    StationState stationState = getStationState();
+    if (stationState != STA_STATE_IDLE) {
+        LOG_WARN(TAG_CHANNEL, "Airtime survey needs an idle station (station is %s)",
+                 getStationStateName(stationState));
+        return false;
+    }
+    if (airtimeMutex == nullptr) {
+        airtimeMutex = xSemaphoreCreateMutex();
+        if (airtimeMutex == nullptr) {
+            LOG_ERROR(TAG_CHANNEL, "Failed to create airtime mutex");
+            return false;
+        }
+    }
+    // Scans retune the radio too; keep them out until the survey ends
+    if (!reserveWiFiScanner()) {
+        LOG_WARN(TAG_CHANNEL, "Radio busy with a WiFi scan");
+        return false;
+    }
+
+    surveyDwellMs = constrain(dwellMs, AIRTIME_MIN_DWELL_MS, AIRTIME_MAX_DWELL_MS);
+    surveyPasses = passes > 0 ? passes : 1;
+    airtimeCallback = onComplete;
+    airtimeCancel = false;
+    airtimeDone = false;
+    airtimeRunning = true;
+
+    BaseType_t result = xTaskCreatePinnedToCore(
+        airtimeSurveyTask,        // Task function
+        "Airtime",                // Task name
+        AIRTIME_TASK_STACK,       // Stack size (bytes)
+        nullptr,                  // Task parameters
+        1,                        // Priority (same as loop)
+        &airtimeTaskHandle,       // Task handle
+        1                         // Core ID (1 = app core)
+    );
+
+    if (result != pdPASS) {
+        LOG_ERROR(TAG_CHANNEL, "Failed to create airtime survey task");
+        airtimeTaskHandle = nullptr;
+        airtimeRunning = false;
+        releaseWiFiScanner();
+        return false;
+    }
+
+    LOG_INFO(TAG_CHANNEL, "Airtime survey started (%u ms per channel, %u passes)",
+             surveyDwellMs, surveyPasses);
+    return true;
+}
+
+void stopAirtimeSurvey() {
+    if (airtimeRunning) {
+        airtimeCancel = true;
+    }
+}
+
+void handleAirtimeSurvey() {
+    if (!airtimeDone) return;
+    airtimeDone = false;
+    airtimeRunning = false;
+
+    AirtimeSurveyCallback callback = airtimeCallback;
+    airtimeCallback = nullptr;
+    if (callback != nullptr) {
+        callback(airtimeSucceeded);
+    }
+}
+
+bool isAirtimeSurveyRunning() {
+    return airtimeRunning;
+}
+
+bool getAirtimeStats(AirtimeStats& stats) {
+    if (airtimeMutex == nullptr) return false;
+    xSemaphoreTake(airtimeMutex, portMAX_DELAY);
+    bool available = haveAirtimeStats;
+    if (available) stats = lastAirtimeStats;
+    xSemaphoreGive(airtimeMutex);
+    return available;
+}
+
+float getMeasuredChannelUtilization(uint8_t channel) {
+    if (airtimeMutex == nullptr) return -1;
+    xSemaphoreTake(airtimeMutex, portMAX_DELAY);
+    bool fresh = haveAirtimeStats && millis() - airtimeCompletedAt <= AIRTIME_RESULT_MAX_AGE_MS;
+    float utilization = fresh ? airtimeUtilization(lastAirtimeStats, channel) : -1;
+    xSemaphoreGive(airtimeMutex);
+    return utilization;
+}
+
+uint32_t getAirtimeSurveyAge() {
+    if (airtimeMutex == nullptr) return UINT32_MAX;
+    xSemaphoreTake(airtimeMutex, portMAX_DELAY);
+    uint32_t age = haveAirtimeStats ? (uint32_t)(millis() - airtimeCompletedAt) : UINT32_MAX;
+    xSemaphoreGive(airtimeMutex);
+    return age;
+}
+
+void printAirtimeSurvey(const AirtimeStats& stats) {
+    Serial.println("\n📡 === Channel Airtime Survey === 📡");
+    Serial.println("┌────┬────────┬────────┬────────┬────────┬────────┬────────┬──────────┬──────┬──────────┐");
+    Serial.println("│ CH │ Util % │ Frames │  Mgmt  │  Ctrl  │  Data  │ Errors │  Bytes   │ RSSI │ Dwell ms │");
+    Serial.println("├────┼────────┼────────┼────────┼────────┼────────┼────────┼──────────┼──────┼──────────┤");
+
+    for (uint8_t ch = 1; ch <= AIRTIME_LAST_CHANNEL; ch++) {
+        const AirtimeChannelStats& channel = stats.channels[ch];
+        float utilization = airtimeUtilization(stats, ch);
+        uint32_t bytes = 0;
+        for (const AirtimeTypeStats& type : channel.types) {
+            bytes += type.bytes;
+        }
+        char rssi[8];
+        if (channel.max_rssi > -128) {
+            snprintf(rssi, sizeof(rssi), "%4d", channel.max_rssi);
+        } else {
+            snprintf(rssi, sizeof(rssi), "   -");
+        }
+        Serial.printf("│%3u │ %6.1f │%7lu │%7lu │%7lu │%7lu │%7lu │%9lu │ %s │%9lu │\n",
+                      ch, utilization < 0 ? 0.0f : utilization,
+                      (unsigned long)airtimeChannelFrames(stats, ch),
+                      (unsigned long)channel.types[AIRTIME_FRAME_MGMT].frames,
+                      (unsigned long)channel.types[AIRTIME_FRAME_CTRL].frames,
+                      (unsigned long)channel.types[AIRTIME_FRAME_DATA].frames,
+                      (unsigned long)channel.error_frames,
+                      (unsigned long)bytes, rssi,
+                      (unsigned long)(channel.dwell_us / 1000));
+    }
+    Serial.println("└────┴────────┴────────┴────────┴────────┴────────┴────────┴──────────┴──────┴──────────┘");
+
+    if (stats.dropped > 0) {
+        Serial.printf("⚠️  %lu frames dropped (ring full): utilization is a lower bound\n",
+                      (unsigned long)stats.dropped);
+    }
+    Serial.println("💡 Util % = estimated frame airtime / listening time per channel");
+}
+#endif
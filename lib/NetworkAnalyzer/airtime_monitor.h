@@ -0,0 +1,246 @@
+/**
+ * @file airtime_monitor.h
+ * @brief Measured channel airtime utilization from promiscuous capture
+ *
+ * The channel analyzer's congestion score is a heuristic built from the
+ * networks a scan reports. This module measures how busy each channel
+ * actually is: the radio hops channels in promiscuous mode, and every frame
+ * it hears is reduced to a few bytes of metadata (channel, type, length,
+ * PHY rate, RSSI, error flag). An estimated on-air duration is computed from
+ * the length and rate. Utilization is the sum of frame durations divided by
+ * the time spent listening on the channel.
+ *
+ * The Wi-Fi driver's receive callback only pushes metadata into a lock-free
+ * single-producer/single-consumer ring. A separate task drains the ring and
+ * does the aggregation, so the callback never blocks or allocates.
+ *
+ * The ring, the airtime model and the aggregation are plain C++ with no
+ * Arduino dependencies. pc_test_apps/airtime_test replays recorded frame
+ * metadata through them on Linux.
+ *
+ * @author Arunkumar Mourougappane
+ * @version 4.3.0
+ * @date 2026-01-17
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// ==========================================
+// AIRTIME MONITOR CONFIGURATION
+// ==========================================
+#define AIRTIME_RING_SIZE 256          // Frames buffered between callback and task (power of two)
+#define AIRTIME_MAX_CHANNEL 14         // 2.4GHz channels 1-14
+#define AIRTIME_DEFAULT_DWELL_MS 250   // Listening time per channel and pass
+#define AIRTIME_MIN_DWELL_MS 50
+#define AIRTIME_MAX_DWELL_MS 2000
+#define AIRTIME_DEFAULT_PASSES 2       // Sweeps over all channels
+#define AIRTIME_RESULT_MAX_AGE_MS 600000  // Survey results older than this are ignored
+#define AIRTIME_MIN_ERROR_SAMPLE 50    // Frames needed before judging a channel's error rate
+
+// ==========================================
+// FRAME METADATA
+// ==========================================
+
+enum AirtimeFrameType {
+    AIRTIME_FRAME_MGMT,
+    AIRTIME_FRAME_CTRL,
+    AIRTIME_FRAME_DATA,
+    AIRTIME_FRAME_MISC,
+    AIRTIME_FRAME_TYPES
+};
+
+// AirtimeFrame::flags
+#define AIRTIME_FLAG_HT    0x01   // 802.11n frame, rate holds the MCS index
+#define AIRTIME_FLAG_40MHZ 0x02   // HT 40MHz bandwidth
+#define AIRTIME_FLAG_SGI   0x04   // HT short guard interval
+#define AIRTIME_FLAG_ERROR 0x08   // Received with a bad FCS or PHY error
+
+/**
+ * @brief What the receive callback keeps of one frame
+ */
+struct AirtimeFrame {
+    uint32_t timestamp_us;      ///< Radio receive timestamp
+    uint16_t length;            ///< PPDU payload length in bytes (including FCS)
+    uint8_t channel;            ///< Channel the radio was tuned to
+    uint8_t type;               ///< AirtimeFrameType
+    uint8_t rate;               ///< Legacy PHY rate code (WIFI_PHY_RATE_*), or MCS index with AIRTIME_FLAG_HT
+    uint8_t flags;              ///< AIRTIME_FLAG_* bits
+    int8_t rssi;                ///< Signal strength in dBm
+    uint8_t reserved;
+};
+
+static_assert(sizeof(AirtimeFrame) == 12, "AirtimeFrame is copied by the receive callback");
+
+/**
+ * @brief Single-producer/single-consumer frame ring
+ * @details The producer only writes head, the consumer only writes tail.
+ *          A full ring drops the new frame and counts it.
+ */
+struct AirtimeRing {
+    AirtimeFrame frames[AIRTIME_RING_SIZE];
+    std::atomic<uint32_t> head;     ///< Next slot to write (producer)
+    std::atomic<uint32_t> tail;     ///< Next slot to read (consumer)
+    std::atomic<uint32_t> dropped;  ///< Frames lost to a full ring
+};
+
+static_assert((AIRTIME_RING_SIZE & (AIRTIME_RING_SIZE - 1)) == 0, "Ring size must be a power of two");
+
+// ==========================================
+// AGGREGATED STATISTICS
+// ==========================================
+
+struct AirtimeTypeStats {
+    uint32_t frames;
+    uint32_t bytes;
+    uint32_t airtime_us;        ///< Estimated time on air
+};
+
+struct AirtimeChannelStats {
+    AirtimeTypeStats types[AIRTIME_FRAME_TYPES];
+    uint32_t dwell_us;          ///< Time spent listening on the channel
+    uint32_t error_frames;      ///< Frames with AIRTIME_FLAG_ERROR (also counted in types)
+    int8_t max_rssi;            ///< Strongest frame heard, -128 if none
+};
+
+struct AirtimeStats {
+    AirtimeChannelStats channels[AIRTIME_MAX_CHANNEL + 1];  ///< Indexed by channel, 0 unused
+    uint32_t dropped;           ///< Frames lost to a full ring
+};
+
+// ==========================================
+// PORTABLE CORE
+// ==========================================
+
+/**
+ * @brief Empty the ring and reset its drop counter
+ */
+void airtimeRingClear(AirtimeRing& ring);
+
+/**
+ * @brief Add a frame (producer side, safe in the Wi-Fi receive callback)
+ * @return false if the ring was full and the frame was dropped
+ */
+bool airtimeRingPush(AirtimeRing& ring, const AirtimeFrame& frame);
+
+/**
+ * @brief Take the oldest frame (consumer side)
+ * @return false if the ring is empty
+ */
+bool airtimeRingPop(AirtimeRing& ring, AirtimeFrame& frame);
+
+/**
+ * @brief Estimate how long a frame occupied the channel
+ * @param frame Frame metadata
+ * @return Duration in microseconds: preamble plus payload symbols at the
+ *         frame's rate (DSSS/CCK, OFDM or HT mixed format)
+ */
+uint32_t airtimeFrameDurationUs(const AirtimeFrame& frame);
+
+/**
+ * @brief Reset all counters
+ */
+void airtimeStatsClear(AirtimeStats& stats);
+
+/**
+ * @brief Count one frame against its channel and type
+ */
+void airtimeStatsAdd(AirtimeStats& stats, const AirtimeFrame& frame);
+
+/**
+ * @brief Record time spent listening on a channel
+ */
+void airtimeStatsAddDwell(AirtimeStats& stats, uint8_t channel, uint32_t dwell_us);
+
+/**
+ * @brief Total estimated airtime on a channel, all frame types
+ */
+uint32_t airtimeChannelBusyUs(const AirtimeStats& stats, uint8_t channel);
+
+/**
+ * @brief Total frames on a channel, all frame types
+ */
+uint32_t airtimeChannelFrames(const AirtimeStats& stats, uint8_t channel);
+
+/**
+ * @brief Measured utilization of a channel
+ * @return Busy time as a percentage of listening time (0-100), or -1 if
+ *         the channel was never listened to
+ */
+float airtimeUtilization(const AirtimeStats& stats, uint8_t channel);
+
+/**
+ * @brief Short name of a frame type ("mgmt", "ctrl", "data", "misc")
+ */
+const char* airtimeFrameTypeName(uint8_t type);
+
+#ifdef ARDUINO
+// ==========================================
+// ESP32 CHANNEL SURVEY
+// ==========================================
+
+/**
+ * @brief Called from handleAirtimeSurvey() when a survey ends
+ * @param success false if the survey could not run or was stopped
+ */
+typedef void (*AirtimeSurveyCallback)(bool success);
+
+/**
+ * @brief Start hopping channels 1-13 in promiscuous mode
+ * @param dwellMs Listening time per channel and pass
+ * @param passes Number of sweeps over the channels
+ * @param onComplete Optional callback run from the main loop when done
+ * @return true if the survey task started
+ * @details Needs the station interface up with no connection in progress:
+ *          hopping channels would drop a connection, and a connection retry
+ *          would retune the radio in the middle of a dwell
+ */
+bool startAirtimeSurvey(uint16_t dwellMs = AIRTIME_DEFAULT_DWELL_MS, uint8_t passes = AIRTIME_DEFAULT_PASSES,
+                        AirtimeSurveyCallback onComplete = nullptr);
+
+/**
+ * @brief Ask a running survey to stop after the current channel
+ */
+void stopAirtimeSurvey();
+
+/**
+ * @brief Finish a completed survey and run its callback (call from loop)
+ */
+void handleAirtimeSurvey();
+
+/**
+ * @brief Check if a survey is in progress
+ */
+bool isAirtimeSurveyRunning();
+
+/**
+ * @brief Copy the results of the last completed survey
+ * @param stats Receives the statistics
+ * @return false if no survey has completed yet
+ */
+bool getAirtimeStats(AirtimeStats& stats);
+
+/**
+ * @brief Measured utilization of a channel from the last survey
+ * @return Percentage (0-100), or -1 if there is no measurement for the
+ *         channel or the survey is older than AIRTIME_RESULT_MAX_AGE_MS
+ */
+float getMeasuredChannelUtilization(uint8_t channel);
+
+/**
+ * @brief Milliseconds since the last survey completed (UINT32_MAX if never)
+ */
+uint32_t getAirtimeSurveyAge();
+
+/**
+ * @brief Print per-channel utilization and frame type breakdown to Serial
+ */
+void printAirtimeSurvey(const AirtimeStats& stats);
+#endif
@@ -3,11 +3,12 @@
  * @brief WiFi channel congestion analysis implementation
  * 
  * This file implements comprehensive channel analysis functionality:
- * - 2.4GHz spectrum scanning across channels 1-14
- * - Congestion scoring based on network count and signal strength
- * - Overlapping channel interference detection
+ * - 2.4GHz spectrum analysis of the shared scan store (channels 1-14)
+ * - Congestion scoring from spectral-mask weighted neighbour power and
+ *   airtime contention (spectral_overlap.h)
  * - Best/worst channel recommendations
  * - Continuous background monitoring support
+ * - Per-channel history with EWMA trends and peaks (channel_history.h)
  * - Channel utilization visualization data
  * 
  * @author Arunkumar Mourougappane
@@ -17,6 +18,10 @@
 
 #include "channel_analyzer.h"
 #include "config.h"
+#include "wifi_scan.h"
+#include "airtime_monitor.h"
+#include "channel_history.h"
+#include "spectral_overlap.h"
 #ifdef USE_NEOPIXEL
 #include "led_controller.h"
 #endif
@@ -36,6 +41,16 @@ unsigned long lastChannelScan = 0;
 static unsigned long lastMonitoringUpdate = 0;
 static uint8_t monitoringInterval = 30; // seconds
 
+// Congestion model
+static const float CCA_THRESHOLD_DBM = -82.0f;      // Neighbours heard above this make an AP defer
+static const float INTERFERENCE_FLOOR_DBM = -95.0f; // Interference score starts here
+static const float INTERFERENCE_CEILING_DBM = -45.0f;
+static const uint16_t OVERLAP_SIGNIFICANT = 50;     // 5% of a neighbour's power counts as overlap
+
+// One history pass per analyzed scan generation
+static ChannelHistory channelHistory;
+static uint32_t historyGeneration = 0;
+
 // Channel frequencies in MHz (2.4GHz band)
 static const uint16_t channelFrequencies[14] = {
     0,    // Channel 0 (invalid)
@@ -63,10 +78,75 @@ void initializeChannelAnalysis() {
     channelScanConfig = getDefaultChannelScanConfig();
     channelMonitoringActive = false;
     lastChannelScan = 0;
+    channelHistoryClear(channelHistory);
+    historyGeneration = 0;
     
     Serial.println("🔧 Channel Congestion Analyzer initialized");
 }
 
+// ==========================================
+// CHANNEL HISTORY
+// ==========================================
+static void recordChannelHistory(const ChannelAnalysisResults& results, uint16_t scannedMask) {
+    ChannelSample samples[CHANNEL_HISTORY_CHANNELS];
+    for (uint8_t ch = 1; ch <= CHANNEL_HISTORY_CHANNELS; ch++) {
+        const ChannelCongestionData& data = results.channels[ch];
+        ChannelSample& sample = samples[ch - 1];
+        sample.networks = data.network_count;
+        sample.strongest_rssi = (int8_t)constrain(data.strongest_rssi, -128, 0);
+        sample.average_rssi = (int8_t)constrain(data.average_rssi, -128, 0);
+        sample.score = (uint8_t)(data.congestion_score + 0.5f);
+    }
+    channelHistoryAdd(channelHistory, results.scan_timestamp / 1000, samples, scannedMask);
+}
+
+const ChannelHistory& getChannelHistory() {
+    return channelHistory;
+}
+
+void printChannelHistory() {
+    uint8_t count = channelHistoryCount(channelHistory);
+    if (count == 0) {
+        Serial.println("❌ No channel history yet. Run 'channel scan' or 'channel monitor start'.");
+        return;
+    }
+    
+    uint32_t nowSeconds = millis() / 1000;
+    uint32_t span = channelHistory.newest_s - channelHistoryTime(channelHistory, 0);
+    Serial.printf("\n📈 === Channel History (%u passes over %lu min) ===\n", count, (unsigned long)(span / 60));
+    Serial.println("  CH  Now  Short  Long  Trend    Peak  Peak age  Recent");
+    
+    static const char* const levels[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+    for (uint8_t ch = 1; ch <= CHANNEL_HISTORY_CHANNELS; ch++) {
+        const ChannelTrend& trend = channelHistoryTrend(channelHistory, ch);
+        if (trend.updated_s == 0) continue;
+        
+        // Sparkline of the last 16 passes, '·' where the channel was not scanned
+        String recent = "";
+        uint8_t first = count > 16 ? count - 16 : 0;
+        for (uint8_t i = first; i < count; i++) {
+            const ChannelHistoryPass& pass = channelHistoryPass(channelHistory, i);
+            if (pass.scanned_mask & (1u << ch)) {
+                recent += levels[min(7, pass.channels[ch - 1].score * 8 / 101)];
+            } else {
+                recent += "·";
+            }
+        }
+        
+        ChannelSample peak;
+        uint32_t peakTime = 0;
+        channelHistoryPeak(channelHistory, ch, peak, peakTime);
+        const ChannelHistoryPass& newest = channelHistoryPass(channelHistory, count - 1);
+        String now = (newest.scanned_mask & (1u << ch)) ? String(newest.channels[ch - 1].score) : "-";
+        
+        Serial.printf("  %2u %4s %6.1f %5.1f  %-7s %5u %6lu min  %s\n", ch, now.c_str(), trend.short_ewma,
+                      trend.long_ewma, channelTrendName(channelTrendDirection(trend)), peak.score,
+                      (unsigned long)((nowSeconds - peakTime) / 60), recent.c_str());
+    }
+    Serial.printf("Short/Long = %d s / %d s score averages; a trend needs %.0f points between them\n\n",
+                  CHANNEL_TREND_SHORT_TAU_S, CHANNEL_TREND_LONG_TAU_S, CHANNEL_TREND_THRESHOLD);
+}
+
 // ==========================================
 // CORE SCANNING FUNCTIONS
 // ==========================================
@@ -74,55 +154,72 @@ ChannelAnalysisResults performChannelCongestionScan(const ChannelScanConfig& con
     ChannelAnalysisResults results;
     memset(&results, 0, sizeof(ChannelAnalysisResults));
     
-    results.scan_timestamp = millis();
     unsigned long scanStart = millis();
     
     Serial.println("🔍 Starting comprehensive channel congestion analysis...");
     
 #ifdef USE_NEOPIXEL
-    // Show blue color during channel scanning
+    // Show blue color during channel analysis
     setNeoPixelColor(0, 0, 255);
 #endif
     
-    // Perform WiFi scan
-    int networkCount = WiFi.scanNetworks(false, config.include_hidden_networks);
+    // Analyze the last background scan (see wifi_scan.h)
+    const WiFiScanStore& store = lockWiFiScanStore();
+    int networkCount = store.count;
+    uint32_t generation = store.generation;
+    uint16_t scannedMask = store.channelMask;
+    results.scan_timestamp = store.completedAt;
+    results.scan_duration_ms = store.durationMs > UINT16_MAX ? UINT16_MAX : (uint16_t)store.durationMs;
     
     if (networkCount == 0) {
+        unlockWiFiScanStore();
         Serial.println("❌ No networks found during channel scan");
-        results.scan_duration_ms = millis() - scanStart;
         return results;
     }
     
-    results.total_networks = networkCount;
-    
     // Initialize channel data
     for (int i = 0; i < 14; i++) {
         results.channels[i].channel = i;
         results.channels[i].network_count = 0;
+        results.channels[i].radio_count = 0;
         results.channels[i].strongest_rssi = -100;
         results.channels[i].average_rssi = -100;
         results.channels[i].congestion_score = 0;
         results.channels[i].overlapping_networks = 0;
+        results.channels[i].interference_dbm = INTERFERENCE_FLOOR_DBM;
+        results.channels[i].contention = 0;
         results.channels[i].is_recommended = false;
-        results.channels[i].dominant_network = "";
+        results.channels[i].scanned = i > 0 && (store.channelMask & (1u << i)) != 0;
+        results.channels[i].scan_time_ms = store.channelTimeMs[i];
+        results.channels[i].dominant_network[0] = '\0';
     }
     
     // Collect network data per channel
+    uint64_t radiosSeen = 0;  // One bit per store radio (WIFI_SCAN_MAX_NETWORKS <= 64)
     for (int i = 0; i < networkCount; i++) {
-        uint8_t ch = WiFi.channel(i);
+        const ScanRecord& network = store.records[i];
+        if (!config.include_hidden_networks && network.ssid[0] == '\0') continue;
+        results.total_networks++;
+        
+        // SSIDs advertised by one access point count once
+        bool newRadio = (radiosSeen & (1ULL << network.radio)) == 0;
+        radiosSeen |= 1ULL << network.radio;
+        if (newRadio) results.total_radios++;
+        
+        uint8_t ch = network.channel;
         if (!isValidChannel(ch)) continue;
         
-        int32_t rssi = WiFi.RSSI(i);
-        String ssid = WiFi.SSID(i);
+        int32_t rssi = network.rssi;
         
         // Update channel statistics
         ChannelCongestionData& channelData = results.channels[ch];
         channelData.network_count++;
+        if (newRadio) channelData.radio_count++;
         
         // Track strongest signal and dominant network
         if (rssi > channelData.strongest_rssi) {
             channelData.strongest_rssi = rssi;
-            channelData.dominant_network = ssid;
+            memcpy(channelData.dominant_network, network.ssid, sizeof(channelData.dominant_network));
         }
         
         // Calculate running average RSSI
@@ -133,39 +230,36 @@ ChannelAnalysisResults performChannelCongestionScan(const ChannelScanConfig& con
         }
     }
     
-    // Calculate congestion scores and analyze overlaps
+    // Weight every neighbour into every channel by spectral overlap
+    analyzeChannelOverlap(results, store.records, networkCount, config.include_hidden_networks);
+    unlockWiFiScanStore();
+    
+    // Calculate congestion scores
     float totalCongestion = 0;
-    uint8_t activeChannels = 0;
+    uint8_t scannedChannels = 0;
     
     for (int ch = 1; ch <= 13; ch++) {
         ChannelCongestionData& channelData = results.channels[ch];
+        channelData.congestion_score =
+            calculateCongestionScore(channelData.contention, channelData.interference_dbm);
         
-        if (channelData.network_count > 0) {
-            activeChannels++;
-            
-            // Calculate congestion score
-            channelData.congestion_score = calculateCongestionScore(
-                ch, channelData.network_count, 
-                channelData.average_rssi, channelData.strongest_rssi
-            );
-            
+        if (channelData.scanned) {
+            scannedChannels++;
             totalCongestion += channelData.congestion_score;
         }
     }
     
     // Calculate overall congestion
-    if (activeChannels > 0) {
-        results.overall_congestion = totalCongestion / activeChannels;
+    if (scannedChannels > 0) {
+        results.overall_congestion = totalCongestion / scannedChannels;
     }
     
-    // Analyze channel overlap
-    analyzeChannelOverlap(results);
-    
-    // Find best and worst channels
+    // Find best and worst channels among those actually scanned
     uint8_t bestChannel = 1, worstChannel = 1;
     float lowestScore = 100, highestScore = 0;
     
     for (int ch = 1; ch <= 13; ch++) {
+        if (!results.channels[ch].scanned) continue;
         float score = results.channels[ch].congestion_score;
         if (score < lowestScore) {
             lowestScore = score;
@@ -193,11 +287,16 @@ ChannelAnalysisResults performChannelCongestionScan(const ChannelScanConfig& con
         }
     }
     
-    results.scan_duration_ms = millis() - scanStart;
     lastChannelAnalysis = results;
     lastChannelScan = millis();
     
-    Serial.printf("✅ Channel analysis completed in %dms\n", results.scan_duration_ms);
+    // Re-analyzing the same scan must not add a second pass
+    if (generation != historyGeneration) {
+        recordChannelHistory(results, scannedMask);
+        historyGeneration = generation;
+    }
+    
+    Serial.printf("✅ Channel analysis completed in %lums\n", millis() - scanStart);
     
 #ifdef USE_NEOPIXEL
     // Show green for completed scan
@@ -205,64 +304,107 @@ ChannelAnalysisResults performChannelCongestionScan(const ChannelScanConfig& con
     delay(500);
 #endif
     
-    // Clean up scan results
-    WiFi.scanDelete();
-    
     return results;
 }
 
 ChannelAnalysisResults quickChannelScan() {
-    ChannelScanConfig config = getDefaultChannelScanConfig();
-    config.detailed_analysis = false;
-    config.scan_duration_ms = 1000; // Quick 1-second scan
-    return performChannelCongestionScan(config);
+    return performChannelCongestionScan(getQuickChannelScanConfig());
+}
+
+void buildChannelScanSchedule(const ChannelScanConfig& config, WiFiScanSchedule& schedule) {
+    clearWiFiScanSchedule(schedule, config.passive_scan);
+    
+    uint8_t count = config.channel_count;
+    if (count == 0) count = 13;
+    
+    // Channels with an override keep it; the rest share what is left of the budget
+    uint32_t budget = config.scan_duration_ms;
+    uint8_t sharing = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t ch = config.channel_count == 0 ? i + 1 : config.channels[i];
+        if (!isValidChannel(ch)) continue;
+        uint16_t dwell = config.channel_dwell_ms[ch];
+        if (dwell > 0) {
+            budget = budget > dwell ? budget - dwell : 0;
+        } else {
+            sharing++;
+        }
+    }
+    uint16_t share = sharing > 0 ? budget / sharing : 0;
+    
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t ch = config.channel_count == 0 ? i + 1 : config.channels[i];
+        if (!isValidChannel(ch)) continue;
+        uint16_t dwell = config.channel_dwell_ms[ch];
+        addWiFiScanChannel(schedule, ch, dwell > 0 ? dwell : share);
+    }
+}
+
+bool requestChannelScan(const ChannelScanConfig& config, WiFiScanCallback onComplete) {
+    WiFiScanSchedule schedule;
+    buildChannelScanSchedule(config, schedule);
+    return requestWiFiScanSchedule(schedule, onComplete);
 }
 
 // ==========================================
 // ANALYSIS FUNCTIONS
 // ==========================================
-void analyzeChannelOverlap(ChannelAnalysisResults& results) {
-    // WiFi channels overlap: each channel affects ±2 channels
-    // Channel 1 overlaps with 1,2,3,4,5
-    // Channel 6 overlaps with 4,5,6,7,8
-    // Channel 11 overlaps with 9,10,11,12,13
-    
-    for (int ch = 1; ch <= 13; ch++) {
-        ChannelCongestionData& channelData = results.channels[ch];
-        channelData.overlapping_networks = 0;
+void analyzeChannelOverlap(ChannelAnalysisResults& results, const ScanRecord* networks, uint16_t count,
+                           bool includeHidden) {
+    // Received power per candidate channel, in mW, before converting to dBm
+    float interferenceMw[14] = {0};
+    const float ccaThresholdMw = powf(10.0f, CCA_THRESHOLD_DBM / 10.0f);
+    
+    uint64_t radiosSeen = 0;
+    
+    for (uint16_t i = 0; i < count; i++) {
+        const ScanRecord& network = networks[i];
+        if (!includeHidden && network.ssid[0] == '\0') continue;
+        if (!isValidChannel(network.channel)) continue;
+        
+        // One transmitter per radio, however many SSIDs it advertises;
+        // records are strongest first, so the first SSID stands for the radio
+        if (radiosSeen & (1ULL << network.radio)) continue;
+        radiosSeen |= 1ULL << network.radio;
         
-        // Count overlapping networks (±2 channels)
-        for (int overlap_ch = max(1, ch - 2); overlap_ch <= min(13, ch + 2); overlap_ch++) {
-            if (overlap_ch != ch && results.channels[overlap_ch].network_count > 0) {
-                channelData.overlapping_networks += results.channels[overlap_ch].network_count;
+        int8_t secondary = (network.phyFlags & SCAN_PHY_HT40_ABOVE)   ? 1
+                           : (network.phyFlags & SCAN_PHY_HT40_BELOW) ? -1
+                                                                      : 0;
+        float powerMw = powf(10.0f, network.rssi / 10.0f);
+        
+        for (uint8_t ch = 1; ch <= 13; ch++) {
+            uint16_t weight = spectralOverlap(ch, network.channel, secondary);
+            if (weight == 0) continue;
+            
+            ChannelCongestionData& channelData = results.channels[ch];
+            float received = powerMw * weight / SPECTRAL_OVERLAP_SCALE;
+            interferenceMw[ch] += received;
+            // Loud enough to trip carrier sense: an AP here shares airtime with it
+            if (received >= ccaThresholdMw) {
+                channelData.contention += (float)weight / SPECTRAL_OVERLAP_SCALE;
+            }
+            if (network.channel != ch && weight >= OVERLAP_SIGNIFICANT && channelData.overlapping_networks < UINT8_MAX) {
+                channelData.overlapping_networks++;
             }
         }
     }
+    
+    for (uint8_t ch = 1; ch <= 13; ch++) {
+        float dbm = interferenceMw[ch] > 0 ? 10.0f * log10f(interferenceMw[ch]) : INTERFERENCE_FLOOR_DBM;
+        results.channels[ch].interference_dbm = max(dbm, INTERFERENCE_FLOOR_DBM);
+    }
 }
 
-float calculateCongestionScore(uint8_t channel, uint8_t networkCount, 
-                              int32_t avgRssi, int32_t strongestRssi) {
-    float score = 0;
-    
-    // Base score from network count (0-50 points)
-    score += min(50.0f, networkCount * 8.0f);
-    
-    // Signal strength impact (0-30 points)
-    // Stronger signals = more interference
-    if (strongestRssi > -40) score += 30;
-    else if (strongestRssi > -50) score += 25;
-    else if (strongestRssi > -60) score += 20;
-    else if (strongestRssi > -70) score += 15;
-    else if (strongestRssi > -80) score += 10;
-    else score += 5;
-    
-    // Average signal strength (0-20 points)
-    if (avgRssi > -50) score += 20;
-    else if (avgRssi > -60) score += 15;
-    else if (avgRssi > -70) score += 10;
-    else if (avgRssi > -80) score += 5;
-    
-    // Ensure score is in valid range
+float calculateCongestionScore(float contention, float interferenceDbm) {
+    // Airtime contention (0-60 points): each co-channel network above the
+    // CCA threshold takes a share of the airtime
+    float score = min(60.0f, contention * 12.0f);
+    
+    // Interference (0-40 points): overlap-weighted neighbour power between
+    // the noise floor and a strong nearby AP
+    float span = INTERFERENCE_CEILING_DBM - INTERFERENCE_FLOOR_DBM;
+    score += 40.0f * constrain((interferenceDbm - INTERFERENCE_FLOOR_DBM) / span, 0.0f, 1.0f);
+    
     return min(100.0f, max(0.0f, score));
 }
 
@@ -274,13 +416,15 @@ std::vector<uint8_t> recommendChannels(const ChannelAnalysisResults& results) {
     
     // Add standard channels with their scores
     for (uint8_t ch : standardChannels) {
+        if (!results.channels[ch].scanned) continue;
         float score = results.channels[ch].congestion_score;
         channelScores.push_back({ch, score});
     }
     
     // Add other channels if they're significantly better
     for (int ch = 1; ch <= 13; ch++) {
-        if (std::find(standardChannels.begin(), standardChannels.end(), ch) == standardChannels.end()) {
+        if (results.channels[ch].scanned &&
+            std::find(standardChannels.begin(), standardChannels.end(), ch) == standardChannels.end()) {
             float score = results.channels[ch].congestion_score;
             // Only recommend non-standard channels if they're much better
             if (score < 20) { // Very low congestion
@@ -306,6 +450,12 @@ std::vector<uint8_t> recommendChannels(const ChannelAnalysisResults& results) {
 // ==========================================
 // MONITORING FUNCTIONS
 // ==========================================
+static void onMonitoringScanComplete(bool success) {
+    if (success && channelMonitoringActive) {
+        performChannelCongestionScan(channelScanConfig);
+    }
+}
+
 void startChannelMonitoring(uint8_t intervalSeconds) {
     channelMonitoringActive = true;
     monitoringInterval = intervalSeconds;
@@ -314,7 +464,7 @@ void startChannelMonitoring(uint8_t intervalSeconds) {
     Serial.printf("🔄 Channel monitoring started (interval: %d seconds)\n", intervalSeconds);
     
     // Perform initial scan
-    quickChannelScan();
+    requestChannelScan(channelScanConfig, onMonitoringScanComplete);
 }
 
 void stopChannelMonitoring() {
@@ -328,7 +478,7 @@ void handleChannelMonitoringTasks() {
     unsigned long currentTime = millis();
     if (currentTime - lastMonitoringUpdate >= (monitoringInterval * 1000)) {
         Serial.println("📊 Performing scheduled channel analysis...");
-        quickChannelScan();
+        requestChannelScan(channelScanConfig, onMonitoringScanComplete);
         lastMonitoringUpdate = currentTime;
     }
 }
@@ -338,8 +488,8 @@ void handleChannelMonitoringTasks() {
 // ==========================================
 void printChannelAnalysisResults(const ChannelAnalysisResults& results) {
     Serial.println("\n📡 === Comprehensive Channel Congestion Analysis ===");
-    Serial.printf("⏰ Scan Time: %lu ms | Networks Found: %d | Overall Congestion: %.1f%%\n", 
-                  results.scan_duration_ms, results.total_networks, results.overall_congestion);
+    Serial.printf("⏰ Scan Time: %lu ms | Networks Found: %d (%d radios) | Overall Congestion: %.1f%%\n", 
+                  results.scan_duration_ms, results.total_networks, results.total_radios, results.overall_congestion);
     Serial.println("┌────┬─────────┬──────────┬───────┬─────────────────────────┬────────────┐");
     Serial.println("│ CH │ Networks│ Congestion│  RSSI │      Dominant Network   │ Overlap │ R │");
     Serial.println("├────┼─────────┼──────────┼───────┼─────────────────────────┼────────────┤");
@@ -354,16 +504,42 @@ void printChannelAnalysisResults(const ChannelAnalysisResults& results) {
         }
         
         String rssiStr = (data.network_count > 0) ? String(data.strongest_rssi) + "dBm" : "N/A";
-        String networkName = data.dominant_network.substring(0, 20); // Truncate long names
+        char networkName[21];
+        snprintf(networkName, sizeof(networkName), "%s", data.dominant_network); // Truncate long names
         char recommended = data.is_recommended ? 'Y' : 'N';
+        // Raw SSID count, then physical radios when multi-SSID APs were merged
+        char networks[12];
+        if (data.radio_count != data.network_count) {
+            snprintf(networks, sizeof(networks), "%d (%d)", data.network_count, data.radio_count);
+        } else {
+            snprintf(networks, sizeof(networks), "%d", data.network_count);
+        }
         
-        Serial.printf("│%3d │%8d │%s│%7s│ %-23s │%11d │ %c │\n",
-                      ch, data.network_count, congestionBar.c_str(), 
-                      rssiStr.c_str(), networkName.c_str(), 
+        Serial.printf("│%3d │%8s │%s│%7s│ %-23s │%11d │ %c │\n",
+                      ch, networks, congestionBar.c_str(), 
+                      rssiStr.c_str(), networkName, 
                       data.overlapping_networks, recommended);
     }
     
     Serial.println("└────┴─────────┴──────────┴───────┴─────────────────────────┴────────────┘");
+    
+    // Per-channel dwell is only measured when channels were scanned one at a time
+    String dwellLine = "";
+    String skippedLine = "";
+    for (int ch = 1; ch <= 13; ch++) {
+        const ChannelCongestionData& data = results.channels[ch];
+        if (!data.scanned) {
+            skippedLine += " " + String(ch);
+        } else if (data.scan_time_ms > 0) {
+            dwellLine += " " + String(ch) + ":" + String(data.scan_time_ms);
+        }
+    }
+    if (dwellLine.length() > 0) {
+        Serial.printf("⏱️  Time per channel (ms):%s\n", dwellLine.c_str());
+    }
+    if (skippedLine.length() > 0) {
+        Serial.printf("⏭️  Not scanned:%s\n", skippedLine.c_str());
+    }
     Serial.printf("📊 Best Channel: %d (%.1f%% congestion)\n", 
                   results.best_channel_2g4, results.channels[results.best_channel_2g4].congestion_score);
     Serial.printf("⚠️  Worst Channel: %d (%.1f%% congestion)\n", 
@@ -373,7 +549,7 @@ void printChannelAnalysisResults(const ChannelAnalysisResults& results) {
         Serial.println("⚡ Non-WiFi interference detected on some channels");
     }
     
-    Serial.println("R = Recommended for AP use\n");
+    Serial.println("R = Recommended for AP use, (n) = physical radios behind the SSIDs\n");
 }
 
 void printChannelCongestionSummary(const ChannelAnalysisResults& results) {
@@ -393,11 +569,11 @@ void printChannelCongestionSummary(const ChannelAnalysisResults& results) {
     Serial.printf("🔴 High congestion channels: %d\n", highCongestion);
     Serial.printf("📊 Overall spectrum utilization: %.1f%%\n", results.overall_congestion);
     
-    // Show top 3 busiest channels
+    // Show top 3 busiest channels, by physical radios
     std::vector<std::pair<uint8_t, uint8_t>> busyChannels;
     for (int ch = 1; ch <= 13; ch++) {
-        if (results.channels[ch].network_count > 0) {
-            busyChannels.push_back({ch, results.channels[ch].network_count});
+        if (results.channels[ch].radio_count > 0) {
+            busyChannels.push_back({ch, results.channels[ch].radio_count});
         }
     }
     
@@ -410,8 +586,8 @@ void printChannelCongestionSummary(const ChannelAnalysisResults& results) {
     int count = 0;
     for (const std::pair<uint8_t, uint8_t>& pair : busyChannels) {
         if (count >= 3) break;
-        Serial.printf("  %d. Channel %d: %d networks\n", 
-                      count + 1, pair.first, pair.second);
+        Serial.printf("  %d. Channel %d: %d radios, %d networks\n", 
+                      count + 1, pair.first, pair.second, results.channels[pair.first].network_count);
         count++;
     }
     Serial.println();
@@ -426,8 +602,8 @@ void printChannelRecommendations(const ChannelAnalysisResults& results) {
     for (size_t i = 0; i < recommended.size() && i < 5; i++) {
         uint8_t ch = recommended[i];
         const ChannelCongestionData& data = results.channels[ch];
-        Serial.printf("  %zu. Channel %d - %.1f%% congestion, %d networks, %s MHz\n",
-                      i + 1, ch, data.congestion_score, data.network_count, 
+        Serial.printf("  %zu. Channel %d - %.1f%% congestion, %d networks on %d radios, %s MHz\n",
+                      i + 1, ch, data.congestion_score, data.network_count, data.radio_count,
                       String(getChannelFrequency(ch)).c_str());
     }
     
@@ -446,12 +622,23 @@ ChannelScanConfig getDefaultChannelScanConfig() {
     ChannelScanConfig config;
     config.include_hidden_networks = true;
     config.scan_duration_ms = 3000;
+    config.passive_scan = false;
+    config.channel_count = 0;
+    memset(config.channels, 0, sizeof(config.channels));
+    memset(config.channel_dwell_ms, 0, sizeof(config.channel_dwell_ms));
     config.detailed_analysis = true;
     config.continuous_monitoring = false;
     config.monitoring_interval_sec = 30;
     return config;
 }
 
+ChannelScanConfig getQuickChannelScanConfig() {
+    ChannelScanConfig config = getDefaultChannelScanConfig();
+    config.detailed_analysis = false;
+    config.scan_duration_ms = 1000; // Quick 1-second scan
+    return config;
+}
+
 void detectInterference(ChannelAnalysisResults& results) {
     // Simple interference detection based on unusual signal patterns
     results.interference_detected = false;
@@ -473,10 +660,25 @@ void detectInterference(ChannelAnalysisResults& results) {
             }
         }
     }
+    
+    // Many frames failing their FCS on a surveyed channel points at
+    // interference or collisions a scan cannot see
+    AirtimeStats airtime;
+    if (getAirtimeSurveyAge() <= AIRTIME_RESULT_MAX_AGE_MS && getAirtimeStats(airtime)) {
+        for (int ch = 1; ch <= 13; ch++) {
+            uint32_t frames = airtimeChannelFrames(airtime, ch);
+            if (frames >= AIRTIME_MIN_ERROR_SAMPLE && airtime.channels[ch].error_frames * 4 > frames) {
+                results.interference_detected = true;
+            }
+        }
+    }
 }
 
 float getChannelUtilization(uint8_t channel) {
     if (!isValidChannel(channel)) return 0;
+    // Measured airtime from a recent channel survey, else the scan heuristic
+    float measured = getMeasuredChannelUtilization(channel);
+    if (measured >= 0) return measured;
     return lastChannelAnalysis.channels[channel].congestion_score;
 }
 
@@ -548,8 +750,8 @@ bool channelsOverlap(uint8_t channel1, uint8_t channel2) {
         return false;
     }
     
-    // WiFi channels overlap if they are within ±2 channels
-    return abs(channel1 - channel2) <= 2;
+    // Two 20 MHz channels overlap if either leaks a significant share into the other
+    return spectralOverlap(channel1, channel2, 0) >= OVERLAP_SIGNIFICANT;
 }
 
 ChannelAnalysisResults getLastChannelAnalysis() {
@@ -559,6 +761,8 @@ ChannelAnalysisResults getLastChannelAnalysis() {
 void resetChannelAnalysis() {
     memset(&lastChannelAnalysis, 0, sizeof(ChannelAnalysisResults));
     lastChannelScan = 0;
+    channelHistoryClear(channelHistory);
+    historyGeneration = 0;
 }
 
 String exportChannelAnalysisToJSON(const ChannelAnalysisResults& results) {
@@ -566,6 +770,7 @@ String exportChannelAnalysisToJSON(const ChannelAnalysisResults& results) {
     json += "\"timestamp\":" + String(results.scan_timestamp) + ",";
     json += "\"scan_duration_ms\":" + String(results.scan_duration_ms) + ",";
     json += "\"total_networks\":" + String(results.total_networks) + ",";
+    json += "\"total_radios\":" + String(results.total_radios) + ",";
     json += "\"overall_congestion\":" + String(results.overall_congestion) + ",";
     json += "\"best_channel\":" + String(results.best_channel_2g4) + ",";
     json += "\"worst_channel\":" + String(results.worst_channel_2g4) + ",";
@@ -578,16 +783,56 @@ String exportChannelAnalysisToJSON(const ChannelAnalysisResults& results) {
         json += "{";
         json += "\"channel\":" + String(ch) + ",";
         json += "\"network_count\":" + String(data.network_count) + ",";
+        json += "\"radio_count\":" + String(data.radio_count) + ",";
         json += "\"congestion_score\":" + String(data.congestion_score) + ",";
         json += "\"strongest_rssi\":" + String(data.strongest_rssi) + ",";
         json += "\"average_rssi\":" + String(data.average_rssi) + ",";
         json += "\"overlapping_networks\":" + String(data.overlapping_networks) + ",";
+        json += "\"interference_dbm\":" + String(data.interference_dbm, 1) + ",";
+        json += "\"contention\":" + String(data.contention, 2) + ",";
         json += "\"is_recommended\":" + String(data.is_recommended ? "true" : "false") + ",";
-        json += "\"dominant_network\":\"" + data.dominant_network + "\"";
+        json += "\"scanned\":" + String(data.scanned ? "true" : "false") + ",";
+        json += "\"scan_time_ms\":" + String(data.scan_time_ms) + ",";
+        float airtime = getMeasuredChannelUtilization(ch);
+        if (airtime >= 0) {
+            json += "\"airtime_utilization\":" + String(airtime) + ",";
+        }
+        const ChannelTrend& trend = channelHistoryTrend(channelHistory, ch);
+        ChannelSample peak;
+        uint32_t peakTime;
+        if (trend.updated_s != 0 && channelHistoryPeak(channelHistory, ch, peak, peakTime)) {
+            json += "\"ewma_short\":" + String(trend.short_ewma, 1) + ",";
+            json += "\"ewma_long\":" + String(trend.long_ewma, 1) + ",";
+            json += "\"trend\":\"" + String(channelTrendName(channelTrendDirection(trend))) + "\",";
+            json += "\"peak_score\":" + String(peak.score) + ",";
+            json += "\"peak_networks\":" + String(peak.networks) + ",";
+            json += "\"peak_age_s\":" + String(millis() / 1000 - peakTime) + ",";
+        }
+        json += "\"dominant_network\":\"" + String(data.dominant_network) + "\"";
         json += "}";
     }
-    json += "]";
+    json += "],";
+    json += "\"history\":" + exportChannelHistoryToJSON();
     json += "}";
     
     return json;
-}
\ No newline at end of file
+}
+String exportChannelHistoryToJSON() {
+    // Oldest first; scores are null where a pass skipped the channel
+    uint32_t nowSeconds = millis() / 1000;
+    uint8_t count = channelHistoryCount(channelHistory);
+    String json = "[";
+    json.reserve(count * 64);
+    for (uint8_t i = 0; i < count; i++) {
+        const ChannelHistoryPass& pass = channelHistoryPass(channelHistory, i);
+        if (i > 0) json += ",";
+        json += "{\"age_s\":" + String(nowSeconds - channelHistoryTime(channelHistory, i)) + ",\"scores\":[";
+        for (uint8_t ch = 1; ch <= CHANNEL_HISTORY_CHANNELS; ch++) {
+            if (ch > 1) json += ",";
+            json += (pass.scanned_mask & (1u << ch)) ? String(pass.channels[ch - 1].score) : String("null");
+        }
+        json += "]}";
+    }
+    json += "]";
+    return json;
+}
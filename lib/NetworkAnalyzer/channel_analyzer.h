@@ -16,6 +16,9 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <vector>
+#include "config.h"
+#include "wifi_scan.h"
+#include "channel_history.h"
 
 // ==========================================
 // CHANNEL CONGESTION ANALYSIS STRUCTURES
@@ -26,13 +29,18 @@
  */
 typedef struct {
     uint8_t channel;                    // Channel number (1-14)
-    uint8_t network_count;              // Number of networks on this channel
+    uint8_t network_count;              // Number of networks (SSIDs/BSSIDs) on this channel
+    uint8_t radio_count;                // Physical radios on this channel (multi-SSID APs count once)
     int32_t strongest_rssi;             // Strongest signal on this channel
     int32_t average_rssi;               // Average RSSI for this channel
     float congestion_score;             // Congestion score (0-100, higher = more congested)
-    uint8_t overlapping_networks;       // Networks that overlap with this channel
+    uint8_t overlapping_networks;       // Networks on other channels leaking ≥5% of their power into this one
+    float interference_dbm;             // Neighbour power landing in this channel, spectral-mask weighted
+    float contention;                   // Overlap-weighted networks above the CCA threshold
     bool is_recommended;                // True if channel is recommended for use
-    String dominant_network;            // SSID of strongest network on channel
+    bool scanned;                       // Channel was covered by the scan
+    uint16_t scan_time_ms;              // Measured dwell on this channel (0 in a full sweep)
+    char dominant_network[SystemConstants::MAX_SSID_LENGTH + 1]; // SSID of strongest network on channel
 } ChannelCongestionData;
 
 /**
@@ -41,11 +49,12 @@ typedef struct {
 typedef struct {
     ChannelCongestionData channels[14]; // Channel data for channels 0-13 (1-14)
     uint8_t total_networks;             // Total networks scanned
+    uint8_t total_radios;               // Distinct physical radios among them
     uint8_t best_channel_2g4;           // Best 2.4GHz channel recommendation
     uint8_t worst_channel_2g4;          // Most congested 2.4GHz channel
     float overall_congestion;           // Overall spectrum congestion (0-100)
     unsigned long scan_timestamp;       // When scan was performed
-    uint16_t scan_duration_ms;          // How long the scan took
+    uint16_t scan_duration_ms;          // Radio time of the analyzed scan
     bool interference_detected;         // True if non-WiFi interference detected
 } ChannelAnalysisResults;
 
@@ -54,7 +63,11 @@ typedef struct {
  */
 typedef struct {
     bool include_hidden_networks;       // Include hidden SSIDs in analysis
-    uint16_t scan_duration_ms;          // How long to scan each channel
+    uint16_t scan_duration_ms;          // Time budget for one pass, shared by the channels
+    bool passive_scan;                  // Listen for beacons instead of sending probe requests
+    uint8_t channel_count;              // Channels listed in channels[], 0 = all of 1-13
+    uint8_t channels[13];               // Channels to scan, in order
+    uint16_t channel_dwell_ms[14];      // Per-channel dwell override by channel number, 0 = even share
     bool detailed_analysis;             // Perform detailed interference analysis
     bool continuous_monitoring;         // Enable continuous background monitoring
     uint8_t monitoring_interval_sec;    // Interval for continuous monitoring
@@ -81,31 +94,57 @@ void initializeChannelAnalysis();
  * @brief Perform comprehensive channel congestion analysis
  * @param config Scan configuration options
  * @return ChannelAnalysisResults Complete analysis results
+ * @details Analyzes the last background scan (wifi_scan.h) without touching
+ *          the radio; request a scan first for fresh results
  */
 ChannelAnalysisResults performChannelCongestionScan(const ChannelScanConfig& config);
 
+/**
+ * @brief Build the scan schedule for a configuration
+ * @param config Channels, time budget and dwell overrides
+ * @param schedule Receives one step per channel; each channel without an
+ *        override gets an even share of scan_duration_ms
+ */
+void buildChannelScanSchedule(const ChannelScanConfig& config, WiFiScanSchedule& schedule);
+
+/**
+ * @brief Request a background scan following a configuration
+ * @param config Channels, time budget and dwell overrides
+ * @param onComplete Callback run from the main loop when the scan finishes
+ * @return true if the scan started or a running scan covers the channels
+ */
+bool requestChannelScan(const ChannelScanConfig& config, WiFiScanCallback onComplete = nullptr);
+
 /**
  * @brief Quick channel congestion scan with default settings
  * @return ChannelAnalysisResults Basic analysis results
+ * @details Like performChannelCongestionScan(), reads the shared scan store
  */
 ChannelAnalysisResults quickChannelScan();
 
 /**
- * @brief Analyze channel overlap and interference
- * @param results Analysis results to enhance with overlap data
+ * @brief Weight every network into every channel by spectral overlap
+ * @param results Analysis results; fills interference_dbm, contention and
+ *        overlapping_networks for channels 1-13
+ * @param networks Scan records (e.g. a locked WiFiScanStore)
+ * @param count Number of records
+ * @param includeHidden Count networks with an empty SSID
+ * @details Each radio's RSSI is scaled by the overlap between its
+ *          spectral mask (20 MHz or HT40) and the candidate channel, using
+ *          the compile-time weights in spectral_overlap.h. SSIDs that share
+ *          a radio (ScanRecord::radio) count once.
  */
-void analyzeChannelOverlap(ChannelAnalysisResults& results);
+void analyzeChannelOverlap(ChannelAnalysisResults& results, const ScanRecord* networks, uint16_t count,
+                           bool includeHidden);
 
 /**
- * @brief Calculate congestion score for a specific channel
- * @param channel Channel number (1-14)
- * @param networkCount Number of networks on channel
- * @param avgRssi Average RSSI on channel
- * @param strongestRssi Strongest signal on channel
- * @return float Congestion score (0-100)
+ * @brief Calculate congestion score for a channel
+ * @param contention Overlap-weighted networks heard above the CCA threshold
+ * @param interferenceDbm Overlap-weighted neighbour power in the channel
+ * @return float Congestion score (0-100): up to 60 points for airtime
+ *         contention, up to 40 for interference between -95 and -45 dBm
  */
-float calculateCongestionScore(uint8_t channel, uint8_t networkCount, 
-                              int32_t avgRssi, int32_t strongestRssi);
+float calculateCongestionScore(float contention, float interferenceDbm);
 
 /**
  * @brief Recommend best channels for AP deployment
@@ -156,22 +195,47 @@ void printChannelRecommendations(const ChannelAnalysisResults& results);
  */
 String exportChannelAnalysisToJSON(const ChannelAnalysisResults& results);
 
+/**
+ * @brief History of analyzed scans (one pass per scan generation)
+ * @return Ring of passes and per-channel EWMA trends
+ */
+const ChannelHistory& getChannelHistory();
+
+/**
+ * @brief Print per-channel trends, peaks and a sparkline of recent passes
+ */
+void printChannelHistory();
+
+/**
+ * @brief Export the history passes to JSON
+ * @return String JSON array of {age_s, scores[13]}, oldest first
+ */
+String exportChannelHistoryToJSON();
+
 /**
  * @brief Get default channel scan configuration
  * @return ChannelScanConfig Default configuration
  */
 ChannelScanConfig getDefaultChannelScanConfig();
 
+/**
+ * @brief Configuration for a quick pass (1 second budget, no interference analysis)
+ */
+ChannelScanConfig getQuickChannelScanConfig();
+
 /**
  * @brief Detect non-WiFi interference on channels
  * @param results Analysis results to enhance with interference detection
+ * @details Also flags channels where a recent airtime survey saw a high
+ *          share of frames with bad FCS
  */
 void detectInterference(ChannelAnalysisResults& results);
 
 /**
  * @brief Get channel utilization percentage
  * @param channel Channel number (1-14)
- * @return float Utilization percentage (0-100)
+ * @return float Utilization percentage (0-100): measured airtime from a
+ *         recent survey (airtime_monitor.h), else the congestion score
  */
 float getChannelUtilization(uint8_t channel);
 
@@ -217,6 +281,6 @@ bool channelsOverlap(uint8_t channel1, uint8_t channel2);
 ChannelAnalysisResults getLastChannelAnalysis();
 
 /**
- * @brief Reset channel analysis data
+ * @brief Reset channel analysis data and history
  */
 void resetChannelAnalysis();
\ No newline at end of file
@@ -0,0 +1,132 @@
+/**
+ * @file channel_history.cpp
+ * @brief Per-channel congestion history implementation
+ *
+ * This file implements:
+ * - Fixed ring of analysis passes with delta-encoded timestamps
+ * - Time-weighted short and long EWMA of each channel's score
+ * - Peak lookup over the retained passes
+ *
+ * @author Arunkumar Mourougappane
+ * @version 4.3.0
+ * @date 2026-01-17
+ */
+
+#include "channel_history.h"
+#include <math.h>
+#include <string.h>
+
+static_assert(CHANNEL_HISTORY_PASSES <= 255, "Ring indices are uint8_t");
+
+// ==========================================
+// RING
+// ==========================================
+
+void channelHistoryClear(ChannelHistory& history) {
+    memset(&history, 0, sizeof(history));
+}
+
+// Weight of a new sample after dt seconds for time constant tau
+static float ewmaAlpha(uint32_t dt, float tau) {
+    return 1.0f - expf(-(float)dt / tau);
+}
+
+void channelHistoryAdd(ChannelHistory& history, uint32_t time_s,
+                       const ChannelSample samples[CHANNEL_HISTORY_CHANNELS], uint16_t scannedMask) {
+    uint32_t delta = history.count > 0 && time_s > history.newest_s ? time_s - history.newest_s : 0;
+    if (delta > UINT16_MAX) {
+        // The delta chain cannot span the gap and the passes before it are
+        // over 18 hours old: start a new chain rather than misdate them
+        history.head = 0;
+        history.count = 0;
+        delta = 0;
+    }
+    ChannelHistoryPass& pass = history.passes[history.head];
+    pass.delta_s = (uint16_t)delta;
+    pass.scanned_mask = scannedMask;
+    memcpy(pass.channels, samples, sizeof(pass.channels));
+
+    history.head = (history.head + 1) % CHANNEL_HISTORY_PASSES;
+    if (history.count < CHANNEL_HISTORY_PASSES) history.count++;
+    history.newest_s = time_s;
+
+    for (uint8_t i = 0; i < CHANNEL_HISTORY_CHANNELS; i++) {
+        if ((scannedMask & (1u << (i + 1))) == 0) continue;
+        ChannelTrend& trend = history.trends[i];
+        float score = samples[i].score;
+        if (trend.updated_s == 0) {
+            // First sample seeds both averages
+            trend.short_ewma = score;
+            trend.long_ewma = score;
+        } else {
+            uint32_t dt = time_s > trend.updated_s ? time_s - trend.updated_s : 0;
+            trend.short_ewma += ewmaAlpha(dt, CHANNEL_TREND_SHORT_TAU_S) * (score - trend.short_ewma);
+            trend.long_ewma += ewmaAlpha(dt, CHANNEL_TREND_LONG_TAU_S) * (score - trend.long_ewma);
+        }
+        // 0 marks an unseeded trend; a pass at time 0 still counts
+        trend.updated_s = time_s > 0 ? time_s : 1;
+    }
+}
+
+uint8_t channelHistoryCount(const ChannelHistory& history) {
+    return history.count;
+}
+
+static uint8_t slotOf(const ChannelHistory& history, uint8_t index) {
+    return (history.head + CHANNEL_HISTORY_PASSES - history.count + index) % CHANNEL_HISTORY_PASSES;
+}
+
+const ChannelHistoryPass& channelHistoryPass(const ChannelHistory& history, uint8_t index) {
+    return history.passes[slotOf(history, index)];
+}
+
+uint32_t channelHistoryTime(const ChannelHistory& history, uint8_t index) {
+    // Walk back from the newest pass; each delta links a pass to its predecessor
+    uint32_t time_s = history.newest_s;
+    for (int i = (int)history.count - 1; i > (int)index; i--) {
+        uint16_t delta = history.passes[slotOf(history, i)].delta_s;
+        time_s = time_s > delta ? time_s - delta : 0;
+    }
+    return time_s;
+}
+
+// ==========================================
+// TRENDS AND PEAKS
+// ==========================================
+
+bool channelHistoryPeak(const ChannelHistory& history, uint8_t channel, ChannelSample& peak, uint32_t& time_s) {
+    if (channel < 1 || channel > CHANNEL_HISTORY_CHANNELS) return false;
+    bool found = false;
+    uint32_t passTime = history.newest_s;
+    // Newest first so ties report the most recent peak and times decode as we go
+    for (int i = (int)history.count - 1; i >= 0; i--) {
+        const ChannelHistoryPass& pass = history.passes[slotOf(history, i)];
+        if ((pass.scanned_mask & (1u << channel)) != 0 &&
+            (!found || pass.channels[channel - 1].score > peak.score)) {
+            peak = pass.channels[channel - 1];
+            time_s = passTime;
+            found = true;
+        }
+        passTime = passTime > pass.delta_s ? passTime - pass.delta_s : 0;
+    }
+    return found;
+}
+
+const ChannelTrend& channelHistoryTrend(const ChannelHistory& history, uint8_t channel) {
+    if (channel < 1 || channel > CHANNEL_HISTORY_CHANNELS) channel = 1;
+    return history.trends[channel - 1];
+}
+
+int8_t channelTrendDirection(const ChannelTrend& trend) {
+    if (trend.updated_s == 0) return 0;
+    float difference = trend.short_ewma - trend.long_ewma;
+    if (difference > CHANNEL_TREND_THRESHOLD) return 1;
+    if (difference < -CHANNEL_TREND_THRESHOLD) return -1;
+    return 0;
+}
+
+const char* channelTrendName(int8_t direction) {
+    if (direction > 0) return "rising";
+    if (direction < 0) return "falling";
+    return "steady";
+}
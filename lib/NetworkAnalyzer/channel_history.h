@@ -0,0 +1,143 @@
+/**
+ * @file channel_history.h
+ * @brief Per-channel congestion history with EWMA trends and peaks
+ *
+ * Each channel analysis is a snapshot. This module keeps the last passes in
+ * a fixed ring so transient congestion (a neighbour streaming in the evening)
+ * stays visible after the next scan overwrites the snapshot.
+ *
+ * A pass stores four bytes per channel (network count, strongest and average
+ * RSSI, congestion score) and the seconds since the previous pass, so 64
+ * passes fit in under 4 KB. Alongside the ring each channel keeps a short and
+ * a long exponentially weighted moving average of its score. The weights
+ * follow the real time between passes, so irregular monitoring intervals and
+ * partial channel plans do not skew the trends.
+ *
+ * The module is plain C++ with no Arduino dependencies.
+ * pc_test_apps/channel_history_test exercises it on Linux.
+ *
+ * @author Arunkumar Mourougappane
+ * @version 4.3.0
+ * @date 2026-01-17
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==========================================
+// CHANNEL HISTORY CONFIGURATION
+// ==========================================
+#define CHANNEL_HISTORY_PASSES 64         // Passes kept in the ring
+#define CHANNEL_HISTORY_CHANNELS 13       // 2.4GHz channels 1-13
+#define CHANNEL_TREND_SHORT_TAU_S 120     // Short EWMA time constant (2 minutes)
+#define CHANNEL_TREND_LONG_TAU_S 1800     // Long EWMA time constant (30 minutes)
+#define CHANNEL_TREND_THRESHOLD 5.0f      // Score points between the averages that make a trend
+
+// ==========================================
+// HISTORY STRUCTURES
+// ==========================================
+
+/**
+ * @brief One channel in one pass
+ */
+struct ChannelSample {
+    uint8_t networks;           ///< Networks on the channel
+    int8_t strongest_rssi;      ///< Strongest signal in dBm
+    int8_t average_rssi;        ///< Average signal in dBm
+    uint8_t score;              ///< Congestion score 0-100, rounded
+};
+
+/**
+ * @brief One analysis pass over all channels
+ */
+struct ChannelHistoryPass {
+    uint16_t delta_s;           ///< Seconds since the previous pass (0 for the oldest)
+    uint16_t scanned_mask;      ///< Bit n set if channel n was scanned in this pass
+    ChannelSample channels[CHANNEL_HISTORY_CHANNELS];  ///< Index 0 = channel 1
+};
+
+/**
+ * @brief Running averages of one channel's score
+ */
+struct ChannelTrend {
+    float short_ewma;           ///< Reacts within minutes
+    float long_ewma;            ///< Baseline over the last half hour or so
+    uint32_t updated_s;         ///< Time of the last sample, 0 = no sample yet
+};
+
+struct ChannelHistory {
+    ChannelHistoryPass passes[CHANNEL_HISTORY_PASSES];
+    uint8_t head;               ///< Next slot to write
+    uint8_t count;              ///< Passes held
+    uint32_t newest_s;          ///< Time of the newest pass; older ones follow from the deltas
+    ChannelTrend trends[CHANNEL_HISTORY_CHANNELS];  ///< Index 0 = channel 1
+};
+
+// ==========================================
+// HISTORY API
+// ==========================================
+
+/**
+ * @brief Drop all passes and reset the trends
+ */
+void channelHistoryClear(ChannelHistory& history);
+
+/**
+ * @brief Append a pass, evicting the oldest when the ring is full
+ * @param history History to extend
+ * @param time_s Time of the pass in seconds (monotonic, e.g. uptime)
+ * @param samples One sample per channel, index 0 = channel 1
+ * @param scannedMask Bit n set if channel n was scanned; other channels
+ *        keep their trend and are stored as not scanned
+ * @details Pass times are stored as 16-bit deltas. A pass more than 65535 s
+ *          (about 18 hours) after the previous one drops the older passes
+ *          and starts a new chain; the trends carry on.
+ */
+void channelHistoryAdd(ChannelHistory& history, uint32_t time_s,
+                       const ChannelSample samples[CHANNEL_HISTORY_CHANNELS], uint16_t scannedMask);
+
+/**
+ * @brief Pass by age order
+ * @param index 0 = oldest, channelHistoryCount() - 1 = newest
+ */
+const ChannelHistoryPass& channelHistoryPass(const ChannelHistory& history, uint8_t index);
+
+/**
+ * @brief Decode the time of a pass from the delta chain
+ * @param index 0 = oldest
+ */
+uint32_t channelHistoryTime(const ChannelHistory& history, uint8_t index);
+
+/**
+ * @brief Passes held
+ */
+uint8_t channelHistoryCount(const ChannelHistory& history);
+
+/**
+ * @brief Busiest pass for a channel within the retained history
+ * @param channel Channel 1-13
+ * @param peak Receives the sample with the highest score
+ * @param time_s Receives when it was recorded
+ * @return false if the channel has no scanned sample
+ */
+bool channelHistoryPeak(const ChannelHistory& history, uint8_t channel, ChannelSample& peak, uint32_t& time_s);
+
+/**
+ * @brief Averages for a channel
+ * @param channel Channel 1-13
+ */
+const ChannelTrend& channelHistoryTrend(const ChannelHistory& history, uint8_t channel);
+
+/**
+ * @brief Direction of a trend
+ * @return 1 if the short average is CHANNEL_TREND_THRESHOLD above the long
+ *         one, -1 if below, 0 otherwise or without samples
+ */
+int8_t channelTrendDirection(const ChannelTrend& trend);
+
+/**
+ * @brief "rising", "falling" or "steady"
+ */
+const char* channelTrendName(int8_t direction);
@@ -0,0 +1,503 @@
+/**
+ * @file rogue_detector.cpp
+ * @brief Rogue and evil-twin access point detection implementation
+ *
+ * This file implements:
+ * - SSID-hashed profile table with bounded per-SSID BSSID lists
+ * - Sighting checks for unknown BSSIDs, security downgrades and
+ *   unexpected channels
+ * - Alert ring that folds repeated sightings into one alert
+ * - ESP32 glue: per-scan checks, learning window, NVS persistence and
+ *   the always-on scan cadence
+ *
+ * @author Arunkumar Mourougappane
+ * @version 4.3.0
+ * @date 2026-01-17
+ */
+
+#include "rogue_detector.h"
+#include <string.h>
+
+#ifdef ARDUINO
+#include <Preferences.h>
+#include <esp_wifi_types.h>
+#include "wifi_scan.h"
+#include "wifi_manager.h"
+#include "airtime_monitor.h"
+#include "logging.h"
+#endif
+
+#define ROGUE_NO_PROFILE 0xFF
+
+static_assert((ROGUE_PROFILE_SLOTS & (ROGUE_PROFILE_SLOTS - 1)) == 0, "Slot count must be a power of two");
+static_assert(ROGUE_MAX_PROFILES < ROGUE_PROFILE_SLOTS, "The table needs free slots to end probe chains");
+static_assert(ROGUE_MAX_PROFILES < ROGUE_NO_PROFILE, "Profile indices must fit the slots");
+
+// ==========================================
+// PROFILE TABLE
+// ==========================================
+
+// FNV-1a over the NUL-terminated SSID
+static uint32_t ssidHash(const char* ssid) {
+    uint32_t hash = 2166136261u;
+    while (*ssid) {
+        hash ^= (uint8_t)*ssid++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Slot holding the SSID's profile, or the free slot that ends its probe chain
+static uint8_t probe(const RogueDetector& detector, const char* ssid) {
+    uint8_t slot = ssidHash(ssid) & (ROGUE_PROFILE_SLOTS - 1);
+    while (detector.slots[slot] != ROGUE_NO_PROFILE &&
+           strcmp(detector.profiles[detector.slots[slot]].ssid, ssid) != 0) {
+        slot = (slot + 1) & (ROGUE_PROFILE_SLOTS - 1);
+    }
+    return slot;
+}
+
+static void rebuildSlots(RogueDetector& detector) {
+    memset(detector.slots, ROGUE_NO_PROFILE, sizeof(detector.slots));
+    for (uint8_t i = 0; i < detector.profileCount; i++) {
+        detector.slots[probe(detector, detector.profiles[i].ssid)] = i;
+    }
+}
+
+static bool hasBssid(const RogueProfile& profile, const uint8_t* bssid) {
+    for (uint8_t i = 0; i < profile.bssidCount; i++) {
+        if (memcmp(profile.bssids[i], bssid, 6) == 0) return true;
+    }
+    return false;
+}
+
+void rogueClear(RogueDetector& detector) {
+    memset(&detector, 0, sizeof(detector));
+    memset(detector.slots, ROGUE_NO_PROFILE, sizeof(detector.slots));
+}
+
+uint8_t rogueAuthRank(uint8_t authMode) {
+    switch (authMode) {
+        case ROGUE_AUTH_OPEN: return 0;
+        case ROGUE_AUTH_WEP: return 1;
+        case ROGUE_AUTH_WPA_PSK: return 2;
+        case ROGUE_AUTH_WPA_WPA2_PSK: return 3;
+        case ROGUE_AUTH_WPA2_PSK:
+        case ROGUE_AUTH_WPA2_ENTERPRISE: return 4;
+        case ROGUE_AUTH_WPA2_WPA3_PSK: return 5;
+        case ROGUE_AUTH_WPA3_PSK: return 6;
+        default: return 4;
+    }
+}
+
+const RogueProfile* rogueFindProfile(const RogueDetector& detector, const char* ssid) {
+    uint8_t index = detector.slots[probe(detector, ssid)];
+    return index == ROGUE_NO_PROFILE ? nullptr : &detector.profiles[index];
+}
+
+bool rogueAddProfile(RogueDetector& detector, const RogueProfile& profile) {
+    if (profile.ssid[0] == '\0' || detector.profileCount >= ROGUE_MAX_PROFILES) return false;
+    uint8_t slot = probe(detector, profile.ssid);
+    if (detector.slots[slot] != ROGUE_NO_PROFILE) return false;
+
+    RogueProfile& added = detector.profiles[detector.profileCount];
+    added = profile;
+    added.ssid[ROGUE_SSID_LENGTH] = '\0';
+    if (added.bssidCount > ROGUE_MAX_BSSIDS) added.bssidCount = ROGUE_MAX_BSSIDS;
+    detector.slots[slot] = detector.profileCount++;
+    return true;
+}
+
+bool rogueLearn(RogueDetector& detector, const char* ssid, const uint8_t bssid[6], uint8_t channel,
+                uint8_t authMode) {
+    if (ssid[0] == '\0') return false;
+    uint8_t slot = probe(detector, ssid);
+    if (detector.slots[slot] == ROGUE_NO_PROFILE) {
+        if (detector.profileCount >= ROGUE_MAX_PROFILES) return false;
+        RogueProfile& profile = detector.profiles[detector.profileCount];
+        memset(&profile, 0, sizeof(profile));
+        strncpy(profile.ssid, ssid, ROGUE_SSID_LENGTH);
+        profile.minAuthRank = rogueAuthRank(authMode);
+        profile.minAuthMode = authMode;
+        detector.slots[slot] = detector.profileCount++;
+    }
+
+    RogueProfile& profile = detector.profiles[detector.slots[slot]];
+    if (!hasBssid(profile, bssid)) {
+        if (profile.bssidCount >= ROGUE_MAX_BSSIDS) return false;
+        memcpy(profile.bssids[profile.bssidCount++], bssid, 6);
+    }
+    if (channel < 16) profile.channelMask |= 1u << channel;
+    if (rogueAuthRank(authMode) < profile.minAuthRank) {
+        profile.minAuthRank = rogueAuthRank(authMode);
+        profile.minAuthMode = authMode;
+    }
+    return true;
+}
+
+bool rogueForget(RogueDetector& detector, const char* ssid) {
+    uint8_t index = detector.slots[probe(detector, ssid)];
+    if (index == ROGUE_NO_PROFILE) return false;
+    // Keep the profiles packed; the slots are rebuilt (forgetting is rare)
+    detector.profileCount--;
+    if (index != detector.profileCount) {
+        detector.profiles[index] = detector.profiles[detector.profileCount];
+    }
+    rebuildSlots(detector);
+    return true;
+}
+
+// ==========================================
+// CHECKS AND ALERTS
+// ==========================================
+
+// Record an alert, or refresh the open one for the same AP and problem
+static bool raise(RogueDetector& detector, uint8_t type, const RogueProfile& profile, const uint8_t* bssid,
+                  uint8_t channel, uint8_t authMode, uint32_t now_s) {
+    for (uint8_t i = 0; i < detector.alertCount; i++) {
+        RogueAlert& alert = detector.alerts[i];
+        if (alert.type == type && !alert.gone && memcmp(alert.bssid, bssid, 6) == 0 &&
+            strcmp(alert.ssid, profile.ssid) == 0) {
+            alert.channel = channel;
+            alert.authMode = authMode;
+            alert.lastSeen_s = now_s;
+            if (alert.count < UINT16_MAX) alert.count++;
+            return false;
+        }
+    }
+
+    RogueAlert& alert = detector.alerts[detector.alertHead];
+    detector.alertHead = (detector.alertHead + 1) % ROGUE_MAX_ALERTS;
+    if (detector.alertCount < ROGUE_MAX_ALERTS) detector.alertCount++;
+    alert.type = type;
+    memcpy(alert.ssid, profile.ssid, sizeof(alert.ssid));
+    memcpy(alert.bssid, bssid, sizeof(alert.bssid));
+    alert.channel = channel;
+    alert.authMode = authMode;
+    alert.expectedAuthMode = profile.minAuthMode;
+    alert.count = 1;
+    alert.firstSeen_s = now_s;
+    alert.lastSeen_s = now_s;
+    alert.gone = false;
+    detector.alertsRaised++;
+    return true;
+}
+
+uint8_t rogueCheck(RogueDetector& detector, const char* ssid, const uint8_t bssid[6], uint8_t channel,
+                   uint8_t authMode, uint32_t now_s) {
+    const RogueProfile* profile = rogueFindProfile(detector, ssid);
+    if (profile == nullptr) return 0;
+
+    uint8_t raised = 0;
+    if (!hasBssid(*profile, bssid)) {
+        raised += raise(detector, ROGUE_UNKNOWN_BSSID, *profile, bssid, channel, authMode, now_s);
+    }
+    if (rogueAuthRank(authMode) < profile->minAuthRank) {
+        raised += raise(detector, ROGUE_SECURITY_DOWNGRADE, *profile, bssid, channel, authMode, now_s);
+    }
+    if (channel >= 16 || (profile->channelMask & (1u << channel)) == 0) {
+        raised += raise(detector, ROGUE_UNEXPECTED_CHANNEL, *profile, bssid, channel, authMode, now_s);
+    }
+    return raised;
+}
+
+uint8_t rogueResolve(RogueDetector& detector, const uint8_t bssid[6]) {
+    uint8_t resolved = 0;
+    for (uint8_t i = 0; i < detector.alertCount; i++) {
+        RogueAlert& alert = detector.alerts[i];
+        if (!alert.gone && memcmp(alert.bssid, bssid, 6) == 0) {
+            alert.gone = true;
+            resolved++;
+        }
+    }
+    return resolved;
+}
+
+const RogueAlert& rogueAlert(const RogueDetector& detector, uint8_t index) {
+    uint8_t slot = (detector.alertHead + ROGUE_MAX_ALERTS - 1 - index % ROGUE_MAX_ALERTS) % ROGUE_MAX_ALERTS;
+    return detector.alerts[slot];
+}
+
+uint8_t rogueRecentAlerts(const RogueDetector& detector, uint32_t now_s, uint32_t windowS) {
+    uint8_t recent = 0;
+    for (uint8_t i = 0; i < detector.alertCount; i++) {
+        const RogueAlert& alert = detector.alerts[i];
+        if (!alert.gone && now_s - alert.lastSeen_s <= windowS) recent++;
+    }
+    return recent;
+}
+
+void rogueClearAlerts(RogueDetector& detector) {
+    detector.alertHead = 0;
+    detector.alertCount = 0;
+}
+
+const char* rogueAlertTypeName(uint8_t type) {
+    switch (type) {
+        case ROGUE_UNKNOWN_BSSID: return "unknown BSSID";
+        case ROGUE_SECURITY_DOWNGRADE: return "security downgrade";
+        case ROGUE_UNEXPECTED_CHANNEL: return "unexpected channel";
+        default: return "unknown";
+    }
+}
+
+#ifdef ARDUINO
+// ==========================================
+// ROGUE MONITOR (ESP32)
+// ==========================================
+static_assert(WIFI_AUTH_OPEN == ROGUE_AUTH_OPEN && WIFI_AUTH_WEP == ROGUE_AUTH_WEP &&
+              WIFI_AUTH_WPA_PSK == ROGUE_AUTH_WPA_PSK && WIFI_AUTH_WPA2_PSK == ROGUE_AUTH_WPA2_PSK &&
+              WIFI_AUTH_WPA_WPA2_PSK == ROGUE_AUTH_WPA_WPA2_PSK &&
+              WIFI_AUTH_WPA2_ENTERPRISE == ROGUE_AUTH_WPA2_ENTERPRISE &&
+              WIFI_AUTH_WPA3_PSK == ROGUE_AUTH_WPA3_PSK && WIFI_AUTH_WPA2_WPA3_PSK == ROGUE_AUTH_WPA2_WPA3_PSK,
+              "ROGUE_AUTH_* must match wifi_auth_mode_t");
+
+static const char* NVS_NAMESPACE = "rogue_ap";
+static const char* KEY_ENABLED = "enabled";
+static const char* KEY_LAYOUT = "layout";
+static const char* KEY_PROFILES = "profiles";
+
+// Loop context only: the CLI, web handlers and monitor all run from loop()
+static RogueDetector detector;
+static bool monitorEnabled = false;
+static uint32_t checkedGeneration = 0;
+static uint32_t eventCursor = 0;
+static unsigned long lastScanRequest = 0;
+static char learningSsid[ROGUE_SSID_LENGTH + 1] = "";
+static unsigned long learningUntil = 0;
+
+static uint32_t nowSeconds() {
+    return millis() / 1000;
+}
+
+static void saveProfiles() {
+    Preferences preferences;
+    if (!preferences.begin(NVS_NAMESPACE, false)) {
+        LOG_ERROR(TAG_WIFI, "Failed to open NVS to save rogue AP profiles");
+        return;
+    }
+    // The layout key lets a firmware with a different profile struct ignore old data
+    preferences.putUShort(KEY_LAYOUT, sizeof(RogueProfile));
+    if (detector.profileCount == 0) {
+        preferences.remove(KEY_PROFILES);
+    } else {
+        preferences.putBytes(KEY_PROFILES, detector.profiles, sizeof(RogueProfile) * detector.profileCount);
+    }
+    preferences.end();
+}
+
+static void loadProfiles() {
+    Preferences preferences;
+    if (!preferences.begin(NVS_NAMESPACE, true)) return;  // Nothing saved yet
+    monitorEnabled = preferences.getBool(KEY_ENABLED, false);
+    if (preferences.getUShort(KEY_LAYOUT, 0) == sizeof(RogueProfile)) {
+        static RogueProfile loaded[ROGUE_MAX_PROFILES];
+        size_t length = preferences.getBytes(KEY_PROFILES, loaded, sizeof(loaded));
+        for (size_t i = 0; i < length / sizeof(RogueProfile); i++) {
+            rogueAddProfile(detector, loaded[i]);
+        }
+    }
+    preferences.end();
+}
+
+void initializeRogueDetector() {
+    rogueClear(detector);
+    loadProfiles();
+    eventCursor = getWiFiScanEventSequence();
+    if (detector.profileCount > 0 || monitorEnabled) {
+        LOG_INFO(TAG_WIFI, "Rogue AP detector: %u protected SSIDs, monitoring %s", detector.profileCount,
+                 monitorEnabled ? "on" : "off");
+    }
+}
+
+static void logNewAlerts(uint32_t raisedBefore) {
+    uint32_t fresh = detector.alertsRaised - raisedBefore;
+    for (uint32_t i = fresh < detector.alertCount ? fresh : detector.alertCount; i-- > 0;) {
+        const RogueAlert& alert = rogueAlert(detector, (uint8_t)i);
+        const uint8_t* b = alert.bssid;
+        LOG_WARN(TAG_WIFI, "Rogue AP: %s for \"%s\" from %02X:%02X:%02X:%02X:%02X:%02X on ch %u (%s)",
+                 rogueAlertTypeName(alert.type), alert.ssid, b[0], b[1], b[2], b[3], b[4], b[5], alert.channel,
+                 getWiFiAuthModeName(alert.authMode));
+    }
+}
+
+// Check (or, while learning, learn from) every network of the latest scan
+static void checkScanStore() {
+    uint32_t now_s = nowSeconds();
+    uint32_t raisedBefore = detector.alertsRaised;
+    bool profileFull = false;
+
+    const WiFiScanStore& store = lockWiFiScanStore();
+    for (uint16_t i = 0; i < store.count; i++) {
+        const ScanRecord& record = store.records[i];
+        if (record.ssid[0] == '\0') continue;
+        if (learningSsid[0] != '\0' && strcmp(record.ssid, learningSsid) == 0) {
+            if (!rogueLearn(detector, record.ssid, record.bssid, record.channel, record.authMode)) profileFull = true;
+        } else if (monitorEnabled) {
+            rogueCheck(detector, record.ssid, record.bssid, record.channel, record.authMode, now_s);
+        }
+    }
+    unlockWiFiScanStore();
+
+    if (profileFull) {
+        LOG_WARN(TAG_WIFI, "Rogue AP profile for \"%s\" is full (%d access points)", learningSsid, ROGUE_MAX_BSSIDS);
+    }
+    logNewAlerts(raisedBefore);
+}
+
+// Close the alerts of suspicious APs that vanished
+static void processScanEvents() {
+    ScanDeltaEvent events[8];
+    uint16_t count;
+    while ((count = readWiFiScanEvents(eventCursor, events, 8)) > 0) {
+        for (uint16_t i = 0; i < count; i++) {
+            if (events[i].type != SCAN_DELTA_VANISHED) continue;
+            if (rogueResolve(detector, events[i].network.bssid) > 0) {
+                const uint8_t* b = events[i].network.bssid;
+                LOG_INFO(TAG_WIFI, "Rogue AP %02X:%02X:%02X:%02X:%02X:%02X (\"%s\") no longer seen", b[0], b[1], b[2],
+                         b[3], b[4], b[5], events[i].network.ssid);
+            }
+        }
+    }
+}
+
+void handleRogueDetector() {
+    if (learningSsid[0] != '\0' && (long)(millis() - learningUntil) >= 0) {
+        const RogueProfile* profile = rogueFindProfile(detector, learningSsid);
+        LOG_INFO(TAG_WIFI, "Learned \"%s\": %u access points", learningSsid, profile ? profile->bssidCount : 0);
+        learningSsid[0] = '\0';
+        saveProfiles();
+    }
+    if (!monitorEnabled && learningSsid[0] == '\0') return;
+
+    uint32_t generation = getWiFiScanGeneration();
+    if (generation != checkedGeneration) {
+        checkedGeneration = generation;
+        checkScanStore();
+        processScanEvents();
+    }
+
+    // Keep results coming even when nothing else scans; requests join any running scan
+    if (currentMode == MODE_STATION && millis() - lastScanRequest >= ROGUE_SCAN_INTERVAL_MS) {
+        lastScanRequest = millis();
+        if (!isWiFiScanRunning() && !isAirtimeSurveyRunning()) {
+            requestWiFiScanIfStale(ROGUE_SCAN_INTERVAL_MS, nullptr);
+        }
+    }
+}
+
+void setRogueDetectorEnabled(bool enabled) {
+    monitorEnabled = enabled;
+    if (enabled) {
+        checkedGeneration = 0;  // Check the current results on the next loop
+        lastScanRequest = millis() - ROGUE_SCAN_INTERVAL_MS;
+        eventCursor = getWiFiScanEventSequence();
+    }
+    Preferences preferences;
+    if (preferences.begin(NVS_NAMESPACE, false)) {
+        preferences.putBool(KEY_ENABLED, enabled);
+        preferences.end();
+    }
+}
+
+bool isRogueDetectorEnabled() {
+    return monitorEnabled;
+}
+
+int startRogueLearning(const char* ssid) {
+    strncpy(learningSsid, ssid, ROGUE_SSID_LENGTH);
+    learningSsid[ROGUE_SSID_LENGTH] = '\0';
+    learningUntil = millis() + ROGUE_LEARN_MS;
+
+    int learned = 0;
+    const WiFiScanStore& store = lockWiFiScanStore();
+    for (int i = findScanRecordBySsid(store, learningSsid); i >= 0; i = findScanRecordBySsid(store, learningSsid, i)) {
+        const ScanRecord& record = store.records[i];
+        if (rogueLearn(detector, record.ssid, record.bssid, record.channel, record.authMode)) learned++;
+    }
+    unlockWiFiScanStore();
+
+    if (currentMode == MODE_STATION) {
+        requestWiFiScan();  // Pick up APs the last results missed
+        lastScanRequest = millis();
+    }
+    return learned;
+}
+
+bool forgetRogueProfile(const char* ssid) {
+    bool forgotten = true;
+    if (ssid == nullptr) {
+        detector.profileCount = 0;
+        memset(detector.slots, ROGUE_NO_PROFILE, sizeof(detector.slots));
+    } else {
+        forgotten = rogueForget(detector, ssid);
+    }
+    if (ssid == nullptr || (learningSsid[0] != '\0' && strcmp(ssid, learningSsid) == 0)) {
+        learningSsid[0] = '\0';
+    }
+    if (forgotten) saveProfiles();
+    return forgotten;
+}
+
+void clearRogueAlerts() {
+    rogueClearAlerts(detector);
+}
+
+bool isRogueAlertActive() {
+    return monitorEnabled && rogueRecentAlerts(detector, nowSeconds(), ROGUE_ALERT_ACTIVE_S) > 0;
+}
+
+const char* getRogueLearningSsid() {
+    return learningSsid[0] != '\0' ? learningSsid : nullptr;
+}
+
+const RogueDetector& getRogueDetector() {
+    return detector;
+}
+
+void printRogueDetectorStatus() {
+    uint32_t now_s = nowSeconds();
+    Serial.println("\n🛡️  === Rogue AP Detector === 🛡️");
+    Serial.printf("Monitoring: %s", monitorEnabled ? "ON" : "OFF");
+    if (monitorEnabled) {
+        Serial.printf(" (scans at least every %d s in station mode)", ROGUE_SCAN_INTERVAL_MS / 1000);
+    }
+    Serial.println();
+    if (learningSsid[0] != '\0') {
+        Serial.printf("Learning:   \"%s\" for another %lu s\n", learningSsid,
+                      (unsigned long)((learningUntil - millis()) / 1000));
+    }
+
+    Serial.printf("\nProtected SSIDs (%u/%d):\n", detector.profileCount, ROGUE_MAX_PROFILES);
+    if (detector.profileCount == 0) {
+        Serial.println("  None. Use 'rogue learn <ssid>' while the real access points are in range.");
+    }
+    for (uint8_t i = 0; i < detector.profileCount; i++) {
+        const RogueProfile& profile = detector.profiles[i];
+        Serial.printf("  %-32s  min %-10s  channels", profile.ssid, getWiFiAuthModeName(profile.minAuthMode));
+        for (uint8_t ch = 1; ch <= WIFI_SCAN_MAX_CHANNEL; ch++) {
+            if (profile.channelMask & (1u << ch)) Serial.printf(" %u", ch);
+        }
+        Serial.println();
+        for (uint8_t j = 0; j < profile.bssidCount; j++) {
+            const uint8_t* b = profile.bssids[j];
+            Serial.printf("    ✓ %02X:%02X:%02X:%02X:%02X:%02X\n", b[0], b[1], b[2], b[3], b[4], b[5]);
+        }
+    }
+
+    Serial.printf("\nAlerts (%u):\n", detector.alertCount);
+    if (detector.alertCount == 0) {
+        Serial.println("  None");
+    }
+    for (uint8_t i = 0; i < detector.alertCount; i++) {
+        const RogueAlert& alert = rogueAlert(detector, i);
+        const uint8_t* b = alert.bssid;
+        Serial.printf("  %s %-18s \"%s\" %02X:%02X:%02X:%02X:%02X:%02X ch %u %s (expected %s), seen %u×, last %lu s ago%s\n",
+                      alert.gone ? "⚪" : "🔴", rogueAlertTypeName(alert.type), alert.ssid, b[0], b[1], b[2], b[3],
+                      b[4], b[5], alert.channel, getWiFiAuthModeName(alert.authMode),
+                      getWiFiAuthModeName(alert.expectedAuthMode), alert.count,
+                      (unsigned long)(now_s - alert.lastSeen_s), alert.gone ? ", gone" : "");
+    }
+    Serial.println();
+}
+#endif
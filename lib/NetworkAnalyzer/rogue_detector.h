@@ -0,0 +1,253 @@
+/**
+ * @file rogue_detector.h
+ * @brief Rogue and evil-twin access point detection
+ *
+ * Keeps a known-good profile for each protected SSID: the BSSIDs that
+ * legitimately serve it, the channels they use and the weakest security
+ * they offer. Profiles are learned from scans (`rogue learn <ssid>`) and
+ * kept in NVS. Every network of every completed scan is checked against
+ * them, raising an alert when a protected SSID:
+ * - is broadcast from a BSSID that is not in its profile (evil twin),
+ * - offers weaker security than the profile (downgrade), or
+ * - shows up on a channel the profile never used.
+ *
+ * Profiles sit in an open-addressing table keyed by an FNV-1a hash of the
+ * SSID, so a check is one hash lookup plus a scan of at most
+ * ROGUE_MAX_BSSIDS addresses. Repeated sightings of the same problem update
+ * one alert instead of adding new ones, and the scan service's vanished
+ * events (see scan_delta.h) close the alerts of an AP that went away.
+ *
+ * While enabled the detector requests a scan every ROGUE_SCAN_INTERVAL_MS
+ * if nothing else has scanned, so the device works as an always-on
+ * wireless intrusion sensor in station mode. Alerts go to the log, the
+ * /rogue web page and the status LED.
+ *
+ * The detection core is plain C++ and builds on Linux for
+ * pc_test_apps/rogue_detector_test; the scan, NVS and LED glue is ESP32 only.
+ *
+ * @author Arunkumar Mourougappane
+ * @version 4.3.0
+ * @date 2026-01-17
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// ==========================================
+// ROGUE DETECTOR CONFIGURATION
+// ==========================================
+#define ROGUE_MAX_PROFILES 16            // Protected SSIDs
+#define ROGUE_PROFILE_SLOTS 32           // SSID hash table slots (power of two)
+#define ROGUE_MAX_BSSIDS 8               // Known access points per SSID
+#define ROGUE_MAX_ALERTS 16              // Alerts kept, oldest replaced first
+#define ROGUE_SSID_LENGTH 32
+#define ROGUE_SCAN_INTERVAL_MS 30000     // Scan at least this often while enabled
+#define ROGUE_LEARN_MS 120000            // Keep learning a new profile for this long
+#define ROGUE_ALERT_ACTIVE_S 300         // Alerts seen this recently light the LED
+
+// wifi_auth_mode_t values the ranking relies on (checked against the SDK on ESP32)
+#define ROGUE_AUTH_OPEN 0
+#define ROGUE_AUTH_WEP 1
+#define ROGUE_AUTH_WPA_PSK 2
+#define ROGUE_AUTH_WPA2_PSK 3
+#define ROGUE_AUTH_WPA_WPA2_PSK 4
+#define ROGUE_AUTH_WPA2_ENTERPRISE 5
+#define ROGUE_AUTH_WPA3_PSK 6
+#define ROGUE_AUTH_WPA2_WPA3_PSK 7
+
+// ==========================================
+// DETECTION STRUCTURES
+// ==========================================
+
+enum RogueAlertType : uint8_t {
+    ROGUE_UNKNOWN_BSSID = 0,    ///< Protected SSID from a BSSID not in its profile
+    ROGUE_SECURITY_DOWNGRADE,   ///< Weaker security than the profile allows
+    ROGUE_UNEXPECTED_CHANNEL    ///< Channel the profile never used
+};
+
+/**
+ * @brief Known-good picture of one SSID
+ */
+struct RogueProfile {
+    char ssid[ROGUE_SSID_LENGTH + 1];
+    uint8_t bssids[ROGUE_MAX_BSSIDS][6];
+    uint8_t bssidCount;
+    uint16_t channelMask;       ///< Bit n set if channel n is expected
+    uint8_t minAuthRank;        ///< Weakest security rank learned (see rogueAuthRank())
+    uint8_t minAuthMode;        ///< wifi_auth_mode_t with that rank, for display
+};
+
+/**
+ * @brief One detected problem, updated while it keeps being seen
+ */
+struct RogueAlert {
+    uint8_t type;               ///< RogueAlertType
+    char ssid[ROGUE_SSID_LENGTH + 1];
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t authMode;           ///< Security the suspicious AP offered
+    uint8_t expectedAuthMode;   ///< Weakest security in the profile
+    uint16_t count;             ///< Times seen
+    uint32_t firstSeen_s;
+    uint32_t lastSeen_s;
+    bool gone;                  ///< The AP vanished from the scans since
+};
+
+struct RogueDetector {
+    RogueProfile profiles[ROGUE_MAX_PROFILES];
+    uint8_t profileCount;
+    uint8_t slots[ROGUE_PROFILE_SLOTS];  ///< Profile index per slot, 0xFF = empty
+    RogueAlert alerts[ROGUE_MAX_ALERTS];
+    uint8_t alertHead;          ///< Next alert slot to write
+    uint8_t alertCount;
+    uint32_t alertsRaised;      ///< New alerts since the detector was cleared
+};
+
+// ==========================================
+// DETECTION API
+// ==========================================
+
+/**
+ * @brief Drop all profiles and alerts
+ */
+void rogueClear(RogueDetector& detector);
+
+/**
+ * @brief Order security modes from weakest to strongest
+ * @param authMode wifi_auth_mode_t value
+ * @return 0 open, 1 WEP, 2 WPA, 3 WPA/WPA2, 4 WPA2 (PSK or enterprise),
+ *         5 WPA2/WPA3, 6 WPA3; unknown modes rank as WPA2
+ */
+uint8_t rogueAuthRank(uint8_t authMode);
+
+/**
+ * @brief Profile of an SSID
+ * @return The profile, or nullptr if the SSID is not protected
+ */
+const RogueProfile* rogueFindProfile(const RogueDetector& detector, const char* ssid);
+
+/**
+ * @brief Add a sighting to an SSID's profile, creating it if needed
+ * @details Adds the BSSID and channel and lowers the expected security to
+ *          what this AP offers
+ * @return false if the SSID is empty, the profile table is full or the
+ *         profile already holds ROGUE_MAX_BSSIDS other BSSIDs
+ */
+bool rogueLearn(RogueDetector& detector, const char* ssid, const uint8_t bssid[6], uint8_t channel,
+                uint8_t authMode);
+
+/**
+ * @brief Add a complete profile (e.g. one loaded from NVS)
+ * @return false if the SSID is empty, already protected or the table is full
+ */
+bool rogueAddProfile(RogueDetector& detector, const RogueProfile& profile);
+
+/**
+ * @brief Stop protecting an SSID
+ * @return false if it had no profile
+ */
+bool rogueForget(RogueDetector& detector, const char* ssid);
+
+/**
+ * @brief Check a sighting against the profiles and record alerts
+ * @param now_s Current time in seconds (monotonic)
+ * @return Number of alerts that are new (not updates of an existing one)
+ */
+uint8_t rogueCheck(RogueDetector& detector, const char* ssid, const uint8_t bssid[6], uint8_t channel,
+                   uint8_t authMode, uint32_t now_s);
+
+/**
+ * @brief Mark the alerts of a BSSID as gone once it vanished from the scans
+ * @return Alerts that were open
+ */
+uint8_t rogueResolve(RogueDetector& detector, const uint8_t bssid[6]);
+
+/**
+ * @brief Alert by age
+ * @param index 0 = most recently raised
+ */
+const RogueAlert& rogueAlert(const RogueDetector& detector, uint8_t index);
+
+/**
+ * @brief Open alerts seen within the last windowS seconds
+ */
+uint8_t rogueRecentAlerts(const RogueDetector& detector, uint32_t now_s, uint32_t windowS);
+
+/**
+ * @brief Forget the alerts, keeping the profiles
+ */
+void rogueClearAlerts(RogueDetector& detector);
+
+/**
+ * @brief "unknown BSSID", "security downgrade" or "unexpected channel"
+ */
+const char* rogueAlertTypeName(uint8_t type);
+
+#ifdef ARDUINO
+// ==========================================
+// ROGUE MONITOR (ESP32)
+// ==========================================
+
+/**
+ * @brief Load saved profiles and the enabled flag from NVS
+ */
+void initializeRogueDetector();
+
+/**
+ * @brief Check new scan events and keep the scan cadence (call from loop)
+ */
+void handleRogueDetector();
+
+/**
+ * @brief Turn monitoring on or off (persisted)
+ */
+void setRogueDetectorEnabled(bool enabled);
+
+bool isRogueDetectorEnabled();
+
+/**
+ * @brief Learn an SSID from the current scan results and later scans
+ * @param ssid SSID to protect
+ * @return Access points learned from the current results (0 if none are visible yet)
+ * @details Learning continues for ROGUE_LEARN_MS so APs on other channels
+ *          join the profile; profiles are saved when learning ends
+ */
+int startRogueLearning(const char* ssid);
+
+/**
+ * @brief Stop protecting an SSID, or all SSIDs when ssid is nullptr (persisted)
+ * @return false if the SSID had no profile
+ */
+bool forgetRogueProfile(const char* ssid);
+
+/**
+ * @brief Forget the alerts, keeping the profiles
+ */
+void clearRogueAlerts();
+
+/**
+ * @brief Whether an alert was seen within ROGUE_ALERT_ACTIVE_S (drives the LED)
+ */
+bool isRogueAlertActive();
+
+/**
+ * @brief SSID being learned, or nullptr
+ */
+const char* getRogueLearningSsid();
+
+/**
+ * @brief Profiles and alerts for display (loop context only)
+ */
+const RogueDetector& getRogueDetector();
+
+/**
+ * @brief Print profiles and alerts to serial
+ */
+void printRogueDetectorStatus();
+#endif
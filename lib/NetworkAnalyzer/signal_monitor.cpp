@@ -7,7 +7,7 @@
  * - Signal quality percentage calculation (0-100%)
  * - Descriptive quality text (Excellent, Good, Fair, Weak)
  * - Real-time monitoring of connected network
- * - Nearby network signal scanning
+ * - Nearby network signals from the shared scan store
  * - Continuous monitoring with configurable intervals
  * 
  * @author Arunkumar Mourougappane
@@ -17,6 +17,7 @@
 
 #include "signal_monitor.h"
 #include "logging.h"
+#include "wifi_scan.h"
 #include <WiFi.h>
 #include <vector>
 
@@ -39,7 +40,7 @@ uint8_t rssiToQuality(int32_t rssi) {
     return 2 * (rssi + 100);
 }
 
-String rssiToQualityText(int32_t rssi) {
+const char* rssiToQualityText(int32_t rssi) {
     if (rssi >= -50) return "Excellent";
     if (rssi >= -60) return "Good";
     if (rssi >= -70) return "Fair";
@@ -57,16 +58,16 @@ SignalInfo getCurrentSignalStrength() {
     info.isConnected = false;
     
     if (WiFi.status() == WL_CONNECTED) {
-        info.ssid = WiFi.SSID();
+        snprintf(info.ssid, sizeof(info.ssid), "%s", WiFi.SSID().c_str());
         info.rssi = WiFi.RSSI();
         info.quality = rssiToQuality(info.rssi);
         info.qualityText = rssiToQualityText(info.rssi);
         info.isConnected = true;
         
         LOG_DEBUG(TAG_SIGNAL, "Connected to %s: %d dBm (%s)", 
-                  info.ssid.c_str(), info.rssi, info.qualityText.c_str());
+                  info.ssid, info.rssi, info.qualityText);
     } else {
-        info.ssid = "Not Connected";
+        snprintf(info.ssid, sizeof(info.ssid), "Not Connected");
         info.rssi = -100;
         info.quality = 0;
         info.qualityText = "No Signal";
@@ -80,45 +81,45 @@ SignalInfo getCurrentSignalStrength() {
 std::vector<SignalInfo> getNearbySignalStrengths(int maxNetworks) {
     std::vector<SignalInfo> networks;
     
-    LOG_DEBUG(TAG_SIGNAL, "Scanning for nearby networks...");
+    // Get current connected SSID (before locking the scan store)
+    String connectedSSID = WiFi.SSID();
+    bool isConnected = (WiFi.status() == WL_CONNECTED);
     
-    // Perform scan (show hidden networks, don't show duplicates)
-    int n = WiFi.scanNetworks(false, true, false, 300); // async=false, show_hidden=true, passive=false, max_ms_per_chan=300
+    // Read the last background scan (hidden networks included)
+    const WiFiScanStore& store = lockWiFiScanStore();
+    int n = store.count;
     
     if (n == 0) {
+        unlockWiFiScanStore();
         LOG_INFO(TAG_SIGNAL, "No networks found");
         return networks;
     }
     
     LOG_INFO(TAG_SIGNAL, "Found %d networks", n);
     
-    // Get current connected SSID
-    String connectedSSID = WiFi.SSID();
-    bool isConnected = (WiFi.status() == WL_CONNECTED);
-    
     // Limit to maxNetworks
     int count = (n < maxNetworks) ? n : maxNetworks;
+    networks.reserve(count);
     
     for (int i = 0; i < count; i++) {
         SignalInfo info;
-        String ssid = WiFi.SSID(i);
+        const ScanRecord& record = store.records[i];
         // Handle hidden networks (empty SSID)
-        info.ssid = (ssid.length() > 0) ? ssid : "<Hidden Network>";
-        info.rssi = WiFi.RSSI(i);
+        snprintf(info.ssid, sizeof(info.ssid), "%s", record.ssid[0] ? record.ssid : "<Hidden Network>");
+        info.rssi = record.rssi;
         info.quality = rssiToQuality(info.rssi);
         info.qualityText = rssiToQualityText(info.rssi);
-        info.isConnected = (isConnected && info.ssid == connectedSSID);
-        info.timestamp = millis();
+        info.isConnected = (isConnected && strcmp(record.ssid, connectedSSID.c_str()) == 0);
+        info.timestamp = store.completedAt;
         
         networks.push_back(info);
         
         LOG_DEBUG(TAG_SIGNAL, "%d: %s - %d dBm (%s)%s", 
-                  i+1, info.ssid.c_str(), info.rssi, info.qualityText.c_str(),
+                  i+1, info.ssid, info.rssi, info.qualityText,
                   info.isConnected ? " [CONNECTED]" : "");
     }
     
-    // Clean up scan results
-    WiFi.scanDelete();
+    unlockWiFiScanStore();
     
     return networks;
 }
@@ -131,10 +132,10 @@ void printSignalInfo(const SignalInfo& info) {
     Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
     Serial.println("Signal Strength Information");
     Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
-    Serial.printf("Network:  %s%s\n", info.ssid.c_str(), 
+    Serial.printf("Network:  %s%s\n", info.ssid, 
                   info.isConnected ? " [CONNECTED]" : "");
     Serial.printf("RSSI:     %d dBm\n", info.rssi);
-    Serial.printf("Quality:  %d%% (%s)\n", info.quality, info.qualityText.c_str());
+    Serial.printf("Quality:  %d%% (%s)\n", info.quality, info.qualityText);
     
     // Display signal meter
     displaySignalMeter(info.rssi);
@@ -202,8 +203,8 @@ void updateSignalMonitoring() {
         
         if (info.isConnected) {
             Serial.printf("%s: %d dBm | %d%% | %s\n",
-                         info.ssid.c_str(), info.rssi, 
-                         info.quality, info.qualityText.c_str());
+                         info.ssid, info.rssi, 
+                         info.quality, info.qualityText);
             
             // Mini meter
             int bars = (info.quality / 10);
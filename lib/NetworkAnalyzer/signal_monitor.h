@@ -25,10 +25,10 @@
  * @brief Structure to hold signal strength information
  */
 struct SignalInfo {
-    String ssid;
+    char ssid[SystemConstants::MAX_SSID_LENGTH + 1];
     int32_t rssi;           // Signal strength in dBm
     uint8_t quality;        // Signal quality percentage (0-100)
-    String qualityText;     // Quality description (Excellent, Good, Fair, Weak, No Signal)
+    const char* qualityText; // Quality description (Excellent, Good, Fair, Weak, No Signal)
     bool isConnected;       // True if this is the connected network
     unsigned long timestamp;
 };
@@ -43,6 +43,8 @@ SignalInfo getCurrentSignalStrength();
  * @brief Gets signal strength of all nearby networks
  * @param maxNetworks Maximum number of networks to return (default: 10)
  * @return Array of SignalInfo structures
+ * @details Reads the last background scan (wifi_scan.h) without touching the
+ *          radio; request a scan first for fresh results
  */
 std::vector<SignalInfo> getNearbySignalStrengths(int maxNetworks = 10);
 
@@ -56,9 +58,9 @@ uint8_t rssiToQuality(int32_t rssi);
 /**
  * @brief Converts RSSI to descriptive quality text
  * @param rssi Signal strength in dBm
- * @return Quality description string
+ * @return Quality description (static string)
  */
-String rssiToQualityText(int32_t rssi);
+const char* rssiToQualityText(int32_t rssi);
 
 /**
  * @brief Prints signal strength information to Serial
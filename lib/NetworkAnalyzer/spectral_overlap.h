@@ -0,0 +1,98 @@
+/**
+ * @file spectral_overlap.h
+ * @brief Compile-time 2.4GHz spectral overlap weights
+ *
+ * 2.4GHz channels are 5 MHz apart but transmissions are 20 or 40 MHz wide,
+ * so a network leaks into its neighbours. How much depends on the distance
+ * between the centre frequencies and on the transmit spectral mask, not on a
+ * fixed ±2 channel window.
+ *
+ * The kernels below are the normalised overlap integral of an 802.11
+ * transmit mask with a 20 MHz receiver mask, sampled at 5 MHz steps:
+ *
+ *   w(d) = ∫ Tx(f - 5d) · Rx(f) df / ∫ Tx20(f) · Rx(f) df
+ *
+ * - 20 MHz OFDM mask: 0 dBr to ±9 MHz, -20 dBr at ±11, -28 at ±20, -40 beyond ±30
+ * - 40 MHz HT mask: 0 dBr to ±19 MHz, -20 dBr at ±21, -28 at ±40, -45 beyond ±60
+ * - Both transmitters have the same total power, so a 40 MHz network puts
+ *   half the power density into any one 20 MHz channel
+ *
+ * Weights are in 1/1000 and indexed by the distance between the neighbour's
+ * centre and the candidate channel, in channels. An HT40 network's centre
+ * sits two channels above or below its primary.
+ *
+ * @author Arunkumar Mourougappane
+ * @version 4.3.0
+ * @date 2026-01-17
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// ==========================================
+// OVERLAP KERNELS
+// ==========================================
+#define SPECTRAL_OVERLAP_SCALE 1000     // Weight of a co-channel 20 MHz network
+#define SPECTRAL_OVERLAP_SPAN 16        // Centre distances 0-15 channels
+
+static constexpr uint16_t SPECTRAL_OVERLAP_20MHZ[SPECTRAL_OVERLAP_SPAN] = {
+    1000, 754, 485, 214, 6, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static constexpr uint16_t SPECTRAL_OVERLAP_40MHZ[SPECTRAL_OVERLAP_SPAN] = {
+    499, 499, 493, 367, 236, 105, 4, 2, 1, 1, 0, 0, 0, 0, 0, 0
+};
+
+// Kernels must fall off with distance, or the model ranks far channels as worse
+static constexpr bool kernelNonIncreasing(const uint16_t* kernel, int i) {
+    return i + 1 >= SPECTRAL_OVERLAP_SPAN || (kernel[i] >= kernel[i + 1] && kernelNonIncreasing(kernel, i + 1));
+}
+
+static_assert(SPECTRAL_OVERLAP_20MHZ[0] == SPECTRAL_OVERLAP_SCALE, "Co-channel 20 MHz is the reference");
+static_assert(kernelNonIncreasing(SPECTRAL_OVERLAP_20MHZ, 0), "20 MHz kernel must not increase");
+static_assert(kernelNonIncreasing(SPECTRAL_OVERLAP_40MHZ, 0), "40 MHz kernel must not increase");
+
+// ==========================================
+// OVERLAP LOOKUP
+// ==========================================
+
+/**
+ * @brief Where a neighbour's signal is centred, in channel units
+ * @param primary Primary channel
+ * @param secondary 0 for 20 MHz, +1 for HT40 with the secondary above, -1 below
+ */
+static constexpr int spectralCenter(uint8_t primary, int8_t secondary) {
+    return primary + 2 * secondary;
+}
+
+/**
+ * @brief Distance between a neighbour's centre and a candidate channel
+ */
+static constexpr int spectralDistance(uint8_t candidate, uint8_t primary, int8_t secondary) {
+    return spectralCenter(primary, secondary) > candidate ? spectralCenter(primary, secondary) - candidate
+                                                          : candidate - spectralCenter(primary, secondary);
+}
+
+static constexpr uint16_t spectralKernel(int distance, int8_t secondary) {
+    return distance >= SPECTRAL_OVERLAP_SPAN ? 0
+           : secondary == 0                  ? SPECTRAL_OVERLAP_20MHZ[distance]
+                                             : SPECTRAL_OVERLAP_40MHZ[distance];
+}
+
+/**
+ * @brief Share of a neighbour's power that lands in a 20 MHz candidate channel
+ * @param candidate Channel being evaluated
+ * @param primary Neighbour's primary channel
+ * @param secondary 0 for 20 MHz, +1 for HT40 above, -1 for HT40 below
+ * @return Weight in 1/SPECTRAL_OVERLAP_SCALE
+ */
+static constexpr uint16_t spectralOverlap(uint8_t candidate, uint8_t primary, int8_t secondary) {
+    return spectralKernel(spectralDistance(candidate, primary, secondary), secondary);
+}
+
+static_assert(spectralOverlap(6, 6, 0) == 1000, "Co-channel");
+static_assert(spectralOverlap(1, 6, 0) == 2 && spectralOverlap(6, 1, 0) == 2, "1 and 6 barely overlap");
+static_assert(spectralOverlap(4, 1, 0) == 214, "Three channels apart still overlap");
+static_assert(spectralOverlap(5, 3, 1) == 499, "HT40 above is centred two channels up");
+static_assert(spectralOverlap(1, 5, -1) == 493, "HT40 below is centred two channels down");
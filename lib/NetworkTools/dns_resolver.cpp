@@ -0,0 +1,856 @@
+/**
+ * @file dns_resolver.cpp
+ * @brief DNS resolution, answer cache and resolver benchmark implementation
+ *
+ * This file implements the shared DNS layer:
+ * - A/IN query encoding and reply decoding (RFC 1035, name compression)
+ * - TTL-respecting LRU cache used by the latency, traceroute, PMTU and iPerf tools
+ * - Cold/warm resolver benchmark with median and p90 latency
+ * - Background FreeRTOS task, serial tables and JSON export on the ESP32
+ *
+ * @author Arunkumar Mourougappane
+ * @version 3.0.0
+ * @date 2026-01-17
+ */
+
+#include "dns_resolver.h"
+#include <string.h>
+#include <stdio.h>
+#include <ctype.h>
+
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <WiFi.h>
+#include "logging.h"
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <time.h>
+#include <mutex>
+#endif
+
+#define DNS_HEADER_SIZE 12
+#define DNS_TYPE_A 1
+#define DNS_CLASS_IN 1
+#define DNS_FLAG_RESPONSE 0x8000
+#define DNS_FLAG_RECURSION_DESIRED 0x0100
+#define DNS_RCODE_NXDOMAIN 3
+#define DNS_RESOLVE_ATTEMPTS 2
+
+// ==========================================
+// CLOCK AND RANDOM HELPERS
+// ==========================================
+static uint64_t dnsMicros() {
+#ifdef ARDUINO
+  return (uint64_t)esp_timer_get_time();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)(ts.tv_nsec / 1000);
+#endif
+}
+
+uint32_t dnsMillis() {
+  return (uint32_t)(dnsMicros() / 1000ULL);
+}
+
+static uint32_t dnsRandom() {
+#ifdef ARDUINO
+  return esp_random();
+#else
+  static bool seeded = false;
+  if (!seeded) {
+    srandom((unsigned)(dnsMicros() ^ (uint64_t)getpid()));
+    seeded = true;
+  }
+  return ((uint32_t)random() << 16) ^ (uint32_t)random();
+#endif
+}
+
+// ==========================================
+// MESSAGE ENCODING
+// ==========================================
+static void putU16(uint8_t* p, uint16_t value) {
+  p[0] = (uint8_t)(value >> 8);
+  p[1] = (uint8_t)value;
+}
+
+static uint16_t getU16(const uint8_t* p) {
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static uint32_t getU32(const uint8_t* p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+size_t dnsEncodeQuery(uint8_t* buffer, size_t size, uint16_t id, const char* name) {
+  if (size < DNS_HEADER_SIZE + 2 + 4 || name == nullptr) return 0;
+
+  memset(buffer, 0, DNS_HEADER_SIZE);
+  putU16(buffer, id);
+  putU16(buffer + 2, DNS_FLAG_RECURSION_DESIRED);
+  putU16(buffer + 4, 1);  // QDCOUNT
+
+  size_t pos = DNS_HEADER_SIZE;
+  const char* label = name;
+  while (*label != '\0') {
+    const char* dot = strchr(label, '.');
+    size_t labelLength = dot ? (size_t)(dot - label) : strlen(label);
+    if (labelLength == 0 || labelLength > 63) return 0;
+    if (pos + 1 + labelLength + 1 + 4 > size) return 0;
+
+    buffer[pos++] = (uint8_t)labelLength;
+    memcpy(buffer + pos, label, labelLength);
+    pos += labelLength;
+
+    if (!dot) break;
+    label = dot + 1;  // A trailing dot ends the loop on the empty remainder
+  }
+  if (pos == DNS_HEADER_SIZE) return 0;
+
+  buffer[pos++] = 0;
+  putU16(buffer + pos, DNS_TYPE_A);
+  putU16(buffer + pos + 2, DNS_CLASS_IN);
+  return pos + 4;
+}
+
+// Advance past a possibly compressed name; returns 0 if it runs off the message
+static size_t skipName(const uint8_t* buffer, size_t length, size_t pos) {
+  while (pos < length) {
+    uint8_t labelLength = buffer[pos];
+    if (labelLength == 0) return pos + 1;
+    if ((labelLength & 0xC0) == 0xC0) return pos + 2 <= length ? pos + 2 : 0;
+    if (labelLength & 0xC0) return 0;
+    pos += 1 + labelLength;
+  }
+  return 0;
+}
+
+bool dnsDecodeResponse(const uint8_t* buffer, size_t length, uint16_t id, DnsAnswer& answer) {
+  if (length < DNS_HEADER_SIZE || getU16(buffer) != id) return false;
+
+  uint16_t flags = getU16(buffer + 2);
+  if (!(flags & DNS_FLAG_RESPONSE)) return false;
+
+  answer.rcode = flags & 0x0F;
+  answer.address = 0;
+  answer.ttl_s = 0;
+
+  uint16_t questions = getU16(buffer + 4);
+  uint16_t answers = getU16(buffer + 6);
+  size_t pos = DNS_HEADER_SIZE;
+
+  for (uint16_t i = 0; i < questions; i++) {
+    pos = skipName(buffer, length, pos);
+    if (pos == 0 || pos + 4 > length) {
+      answer.status = DNS_QUERY_SERVER_ERROR;
+      return true;
+    }
+    pos += 4;
+  }
+
+  bool found = false;
+  uint32_t lowestTtl = UINT32_MAX;
+  for (uint16_t i = 0; i < answers; i++) {
+    pos = skipName(buffer, length, pos);
+    if (pos == 0 || pos + 10 > length) break;
+
+    uint16_t type = getU16(buffer + pos);
+    uint16_t rrClass = getU16(buffer + pos + 2);
+    uint32_t ttl = getU32(buffer + pos + 4);
+    uint16_t dataLength = getU16(buffer + pos + 8);
+    pos += 10;
+    if (pos + dataLength > length) break;
+
+    // CNAME links and the final A record all bound how long the answer holds
+    if (ttl < lowestTtl) lowestTtl = ttl;
+    if (!found && type == DNS_TYPE_A && rrClass == DNS_CLASS_IN && dataLength == 4) {
+      memcpy(&answer.address, buffer + pos, 4);
+      found = true;
+    }
+    pos += dataLength;
+  }
+
+  if (answer.rcode == DNS_RCODE_NXDOMAIN) {
+    answer.status = DNS_QUERY_NXDOMAIN;
+  } else if (answer.rcode != 0) {
+    answer.status = DNS_QUERY_SERVER_ERROR;
+  } else if (found) {
+    answer.status = DNS_QUERY_OK;
+    answer.ttl_s = lowestTtl;
+  } else {
+    answer.status = DNS_QUERY_NO_ADDRESS;
+  }
+  return true;
+}
+
+// ==========================================
+// QUERY ENGINE
+// ==========================================
+bool dnsQuery(uint32_t resolver, uint16_t port, const char* name, uint32_t timeout_ms,
+              DnsAnswer& answer, uint32_t* elapsed_us) {
+  uint8_t buffer[DNS_MAX_MESSAGE_SIZE];
+  uint16_t id = (uint16_t)dnsRandom();
+  answer.status = DNS_QUERY_SOCKET_ERROR;
+  answer.address = 0;
+  answer.ttl_s = 0;
+  answer.rcode = 0;
+  if (elapsed_us) *elapsed_us = 0;
+
+  size_t queryLength = dnsEncodeQuery(buffer, sizeof(buffer), id, name);
+  if (queryLength == 0) {
+    answer.status = DNS_QUERY_SERVER_ERROR;
+    return false;
+  }
+
+  int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (fd < 0) return false;
+
+  // Connected socket: the stack drops datagrams from anyone but the resolver
+  struct sockaddr_in server;
+  memset(&server, 0, sizeof(server));
+  server.sin_family = AF_INET;
+  server.sin_port = htons(port);
+  server.sin_addr.s_addr = resolver;
+  if (connect(fd, (struct sockaddr*)&server, sizeof(server)) < 0) {
+    close(fd);
+    return false;
+  }
+
+  uint64_t start = dnsMicros();
+  if (send(fd, buffer, queryLength, 0) != (ssize_t)queryLength) {
+    close(fd);
+    return false;
+  }
+
+  uint64_t deadline = start + (uint64_t)timeout_ms * 1000ULL;
+  bool complete = false;
+  answer.status = DNS_QUERY_TIMEOUT;
+
+  while (!complete) {
+    uint64_t now = dnsMicros();
+    if (now >= deadline) break;
+
+    uint64_t remaining = deadline - now;
+    struct timeval tv;
+    tv.tv_sec = (long)(remaining / 1000000ULL);
+    tv.tv_usec = (long)(remaining % 1000000ULL);
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(fd, &readSet);
+    if (select(fd + 1, &readSet, nullptr, nullptr, &tv) <= 0) continue;
+
+    ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+    if (received <= 0) {
+      // ICMP Port Unreachable surfaces as ECONNREFUSED on a connected socket
+      answer.status = DNS_QUERY_SOCKET_ERROR;
+      break;
+    }
+    complete = dnsDecodeResponse(buffer, (size_t)received, id, answer);
+    if (complete && elapsed_us) {
+      *elapsed_us = (uint32_t)(dnsMicros() - start);
+    }
+  }
+
+  close(fd);
+  return complete;
+}
+
+const char* dnsQueryStatusToString(DnsQueryStatus status) {
+  switch (status) {
+    case DNS_QUERY_OK: return "ok";
+    case DNS_QUERY_NXDOMAIN: return "nxdomain";
+    case DNS_QUERY_NO_ADDRESS: return "no address";
+    case DNS_QUERY_SERVER_ERROR: return "server error";
+    case DNS_QUERY_TIMEOUT: return "timeout";
+    case DNS_QUERY_SOCKET_ERROR: return "socket error";
+    default: return "unknown";
+  }
+}
+
+// ==========================================
+// RESOLVER CACHE
+// ==========================================
+static DnsCacheEntry dnsCache[DNS_CACHE_SIZE];
+static DnsCacheStats dnsStats;
+static uint32_t configuredResolver = 0;
+static uint16_t configuredPort = DNS_PORT;
+
+#ifdef ARDUINO
+static SemaphoreHandle_t dnsCacheMutex = nullptr;
+
+static bool lockCache() {
+  if (dnsCacheMutex == nullptr) {
+    dnsCacheMutex = xSemaphoreCreateMutex();
+    if (dnsCacheMutex == nullptr) return false;
+  }
+  return xSemaphoreTake(dnsCacheMutex, portMAX_DELAY) == pdTRUE;
+}
+
+static void unlockCache() {
+  xSemaphoreGive(dnsCacheMutex);
+}
+#else
+static std::mutex dnsCacheMutex;
+
+static bool lockCache() {
+  dnsCacheMutex.lock();
+  return true;
+}
+
+static void unlockCache() {
+  dnsCacheMutex.unlock();
+}
+#endif
+
+static bool entryLive(const DnsCacheEntry& entry, uint32_t now) {
+  return entry.name[0] != '\0' && (int32_t)(entry.expires_ms - now) > 0;
+}
+
+// Cache keys are lower-case; returns false if the name is too long to cache
+static bool normaliseName(const char* host, char* name) {
+  size_t length = strlen(host);
+  if (length > 0 && host[length - 1] == '.') length--;
+  if (length == 0 || length >= DNS_MAX_NAME_LENGTH) return false;
+  for (size_t i = 0; i < length; i++) {
+    name[i] = (char)tolower((unsigned char)host[i]);
+  }
+  name[length] = '\0';
+  return true;
+}
+
+static bool cacheLookup(const char* name, uint32_t& address, uint32_t& ttlRemaining) {
+  if (!lockCache()) return false;
+
+  uint32_t now = dnsMillis();
+  bool hit = false;
+  for (uint8_t i = 0; i < DNS_CACHE_SIZE; i++) {
+    DnsCacheEntry& entry = dnsCache[i];
+    if (entry.name[0] == '\0' || strcmp(entry.name, name) != 0) continue;
+
+    if (entryLive(entry, now)) {
+      entry.last_used_ms = now;
+      entry.hits++;
+      address = entry.address;
+      ttlRemaining = (entry.expires_ms - now) / 1000;
+      hit = true;
+    } else {
+      entry.name[0] = '\0';
+      dnsStats.expired++;
+    }
+    break;
+  }
+
+  if (hit) {
+    dnsStats.hits++;
+  } else {
+    dnsStats.misses++;
+  }
+  unlockCache();
+  return hit;
+}
+
+static void cacheStore(const char* name, uint32_t address, uint32_t ttl_s) {
+  if (ttl_s == 0) return;  // Zero TTL means "do not cache"
+  if (ttl_s > DNS_CACHE_MAX_TTL_S) ttl_s = DNS_CACHE_MAX_TTL_S;
+  if (!lockCache()) return;
+
+  // Reuse the name's slot, else a free/expired one, else the least recently used
+  uint32_t now = dnsMillis();
+  int slot = -1;
+  int oldest = 0;
+  for (uint8_t i = 0; i < DNS_CACHE_SIZE; i++) {
+    if (dnsCache[i].name[0] != '\0' && strcmp(dnsCache[i].name, name) == 0) {
+      slot = i;
+      break;
+    }
+    if (slot < 0 && !entryLive(dnsCache[i], now)) slot = i;
+    if ((int32_t)(dnsCache[i].last_used_ms - dnsCache[oldest].last_used_ms) < 0) oldest = i;
+  }
+  if (slot < 0) {
+    slot = oldest;
+    dnsStats.evictions++;
+  }
+
+  DnsCacheEntry& entry = dnsCache[slot];
+  snprintf(entry.name, sizeof(entry.name), "%s", name);
+  entry.address = address;
+  entry.expires_ms = now + ttl_s * 1000;
+  entry.last_used_ms = now;
+  entry.hits = 0;
+  unlockCache();
+}
+
+static uint32_t defaultResolver() {
+#ifdef ARDUINO
+  return (uint32_t)WiFi.dnsIP(0);
+#else
+  // First nameserver from resolv.conf
+  uint32_t resolver = 0;
+  FILE* file = fopen("/etc/resolv.conf", "r");
+  if (file == nullptr) return 0;
+  char line[128];
+  char address[64];
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    struct in_addr parsed;
+    if (sscanf(line, " nameserver %63s", address) == 1 && inet_pton(AF_INET, address, &parsed) == 1) {
+      resolver = parsed.s_addr;
+      break;
+    }
+  }
+  fclose(file);
+  return resolver;
+#endif
+}
+
+void dnsSetResolver(uint32_t resolver, uint16_t port) {
+  configuredResolver = resolver;
+  configuredPort = port;
+}
+
+bool dnsResolve(const char* host, uint32_t& address, DnsResolveInfo* info) {
+  DnsResolveInfo local;
+  DnsResolveInfo& result = info ? *info : local;
+  result.source = DNS_SOURCE_QUERY;
+  result.status = DNS_QUERY_SERVER_ERROR;
+  result.elapsed_us = 0;
+  result.ttl_remaining_s = 0;
+
+  if (host == nullptr || host[0] == '\0') return false;
+
+  struct in_addr literal;
+  if (inet_pton(AF_INET, host, &literal) == 1) {
+    address = literal.s_addr;
+    result.source = DNS_SOURCE_LITERAL;
+    result.status = DNS_QUERY_OK;
+    return true;
+  }
+
+  char name[DNS_MAX_NAME_LENGTH];
+  bool cacheable = normaliseName(host, name);
+  uint64_t start = dnsMicros();
+
+  if (cacheable && cacheLookup(name, address, result.ttl_remaining_s)) {
+    result.source = DNS_SOURCE_CACHE;
+    result.status = DNS_QUERY_OK;
+    result.elapsed_us = (uint32_t)(dnsMicros() - start);
+    return true;
+  }
+
+  uint32_t resolver = configuredResolver != 0 ? configuredResolver : defaultResolver();
+  if (resolver == 0) {
+    result.status = DNS_QUERY_SOCKET_ERROR;
+    return false;
+  }
+
+  DnsAnswer answer;
+  for (uint8_t attempt = 0; attempt < DNS_RESOLVE_ATTEMPTS; attempt++) {
+    if (dnsQuery(resolver, configuredPort, host, DNS_DEFAULT_TIMEOUT_MS, answer)) break;
+    if (answer.status != DNS_QUERY_TIMEOUT) break;
+  }
+  result.status = answer.status;
+  result.elapsed_us = (uint32_t)(dnsMicros() - start);
+  if (answer.status != DNS_QUERY_OK) return false;
+
+  address = answer.address;
+  result.ttl_remaining_s = answer.ttl_s > DNS_CACHE_MAX_TTL_S ? DNS_CACHE_MAX_TTL_S : answer.ttl_s;
+  if (cacheable) {
+    cacheStore(name, answer.address, answer.ttl_s);
+  }
+  return true;
+}
+
+void dnsCacheFlush() {
+  if (!lockCache()) return;
+  memset(dnsCache, 0, sizeof(dnsCache));
+  unlockCache();
+}
+
+DnsCacheStats dnsCacheGetStats() {
+  DnsCacheStats snapshot;
+  memset(&snapshot, 0, sizeof(snapshot));
+  if (!lockCache()) return snapshot;
+
+  snapshot = dnsStats;
+  uint32_t now = dnsMillis();
+  snapshot.entries = 0;
+  for (uint8_t i = 0; i < DNS_CACHE_SIZE; i++) {
+    if (entryLive(dnsCache[i], now)) snapshot.entries++;
+  }
+  unlockCache();
+  return snapshot;
+}
+
+uint8_t dnsCacheSnapshot(DnsCacheEntry* entries, uint8_t max) {
+  if (!lockCache()) return 0;
+
+  uint32_t now = dnsMillis();
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < DNS_CACHE_SIZE && count < max; i++) {
+    if (entryLive(dnsCache[i], now)) entries[count++] = dnsCache[i];
+  }
+  unlockCache();
+  return count;
+}
+
+// ==========================================
+// RESOLVER BENCHMARK
+// ==========================================
+static const char* const defaultBenchDomains[] = {
+  "google.com", "cloudflare.com", "wikipedia.org", "github.com", "amazon.com"
+};
+
+DnsBenchConfig getDefaultDnsBenchConfig() {
+  DnsBenchConfig config;
+  memset(&config, 0, sizeof(config));
+  config.port = DNS_PORT;
+  config.domain_count = sizeof(defaultBenchDomains) / sizeof(defaultBenchDomains[0]);
+  for (uint8_t i = 0; i < config.domain_count; i++) {
+    config.domains[i] = defaultBenchDomains[i];
+  }
+  config.queries = DNS_BENCH_DEFAULT_QUERIES;
+  config.timeout_ms = DNS_DEFAULT_TIMEOUT_MS;
+  return config;
+}
+
+static float percentile(const float* sorted, uint16_t count, float fraction) {
+  if (count == 0) return 0;
+  float rank = fraction * (count - 1);
+  uint16_t lower = (uint16_t)rank;
+  if (lower + 1 >= count) return sorted[count - 1];
+  return sorted[lower] + (sorted[lower + 1] - sorted[lower]) * (rank - lower);
+}
+
+static void summarise(DnsLatencyStats& stats, float* samples, uint16_t count) {
+  // Insertion sort: at most DNS_BENCH_MAX_QUERIES samples
+  for (uint16_t i = 1; i < count; i++) {
+    float value = samples[i];
+    int j = i - 1;
+    while (j >= 0 && samples[j] > value) {
+      samples[j + 1] = samples[j];
+      j--;
+    }
+    samples[j + 1] = value;
+  }
+
+  if (count == 0) return;
+  float total = 0;
+  for (uint16_t i = 0; i < count; i++) total += samples[i];
+  stats.min_ms = samples[0];
+  stats.max_ms = samples[count - 1];
+  stats.avg_ms = total / count;
+  stats.median_ms = percentile(samples, count, 0.5f);
+  stats.p90_ms = percentile(samples, count, 0.9f);
+}
+
+static void timedQuery(const DnsBenchConfig& config, uint32_t resolver, const char* name,
+                       DnsLatencyStats& stats, float* samples) {
+  DnsAnswer answer;
+  uint32_t elapsed = 0;
+  stats.sent++;
+  // NXDOMAIN is the expected answer for cold names and still a full round trip
+  if (dnsQuery(resolver, config.port, name, config.timeout_ms, answer, &elapsed) &&
+      answer.status != DNS_QUERY_SERVER_ERROR) {
+    samples[stats.answered++] = elapsed / 1000.0f;
+  } else {
+    stats.failed++;
+  }
+}
+
+bool dnsRunBenchmark(const DnsBenchConfig& config, DnsBenchResults& results, volatile bool* cancel) {
+  memset(&results, 0, sizeof(results));
+  uint8_t resolverCount = config.resolver_count < DNS_BENCH_MAX_RESOLVERS ? config.resolver_count
+                                                                          : DNS_BENCH_MAX_RESOLVERS;
+  uint8_t domainCount = config.domain_count < DNS_BENCH_MAX_DOMAINS ? config.domain_count
+                                                                    : DNS_BENCH_MAX_DOMAINS;
+  uint8_t queries = config.queries < DNS_BENCH_MAX_QUERIES ? config.queries : DNS_BENCH_MAX_QUERIES;
+  results.resolver_count = resolverCount;
+  if (resolverCount == 0 || domainCount == 0) return true;
+
+  float coldSamples[DNS_BENCH_MAX_RESOLVERS][DNS_BENCH_MAX_QUERIES];
+  float warmSamples[DNS_BENCH_MAX_RESOLVERS][DNS_BENCH_MAX_QUERIES];
+  char name[DNS_MAX_NAME_LENGTH + 16];
+
+  for (uint8_t r = 0; r < resolverCount; r++) {
+    results.resolvers[r].resolver = config.resolvers[r];
+  }
+
+  // Cold: a fresh random label per query cannot be in any resolver cache
+  for (uint8_t q = 0; q < queries; q++) {
+    for (uint8_t r = 0; r < resolverCount; r++) {
+      if (cancel && *cancel) return false;
+      snprintf(name, sizeof(name), "dnsb-%08lx.%s", (unsigned long)dnsRandom(),
+               config.domains[q % domainCount]);
+      timedQuery(config, config.resolvers[r], name, results.resolvers[r].cold, coldSamples[r]);
+    }
+  }
+
+  // Warm: prime every domain once (untimed), then time repeats
+  DnsAnswer answer;
+  for (uint8_t d = 0; d < domainCount; d++) {
+    for (uint8_t r = 0; r < resolverCount; r++) {
+      if (cancel && *cancel) return false;
+      dnsQuery(config.resolvers[r], config.port, config.domains[d], config.timeout_ms, answer);
+    }
+  }
+  for (uint8_t q = 0; q < queries; q++) {
+    for (uint8_t r = 0; r < resolverCount; r++) {
+      if (cancel && *cancel) return false;
+      timedQuery(config, config.resolvers[r], config.domains[q % domainCount],
+                 results.resolvers[r].warm, warmSamples[r]);
+    }
+  }
+
+  bool haveFastest = false;
+  for (uint8_t r = 0; r < resolverCount; r++) {
+    DnsResolverResult& result = results.resolvers[r];
+    summarise(result.cold, coldSamples[r], result.cold.answered);
+    summarise(result.warm, warmSamples[r], result.warm.answered);
+    if (result.warm.answered == 0) continue;
+    if (!haveFastest || result.warm.median_ms < results.resolvers[results.fastest].warm.median_ms) {
+      results.fastest = r;
+      haveFastest = true;
+    }
+  }
+  return true;
+}
+
+#ifdef ARDUINO
+// ==========================================
+// ESP32 RUNNER
+// ==========================================
+#define TAG_DNS "DNS"
+#define DNS_BENCH_TASK_STACK 6144
+
+static TaskHandle_t benchTaskHandle = nullptr;
+static SemaphoreHandle_t benchMutex = nullptr;
+static volatile bool benchCancel = false;
+static DnsBenchState benchState = DNS_BENCH_IDLE;
+static DnsBenchResults benchResults;       // Published snapshot, guarded by benchMutex
+static DnsBenchConfig benchConfig;
+
+bool dnsResolve(const String& host, IPAddress& ip, DnsResolveInfo* info) {
+  uint32_t address = 0;
+  if (!dnsResolve(host.c_str(), address, info)) return false;
+  ip = IPAddress(address);
+  return true;
+}
+
+void printDnsCache() {
+  DnsCacheEntry entries[DNS_CACHE_SIZE];
+  uint8_t count = dnsCacheSnapshot(entries, DNS_CACHE_SIZE);
+  DnsCacheStats stats = dnsCacheGetStats();
+  uint32_t now = dnsMillis();
+  uint32_t lookups = stats.hits + stats.misses;
+
+  Serial.println("\n📇 === DNS Cache ===");
+  Serial.printf("Entries: %u/%u | Hits: %lu | Misses: %lu (%lu expired) | Hit rate: %.1f%%\n",
+                count, DNS_CACHE_SIZE, (unsigned long)stats.hits, (unsigned long)stats.misses,
+                (unsigned long)stats.expired, lookups > 0 ? stats.hits * 100.0f / lookups : 0.0f);
+  if (count == 0) {
+    Serial.println("(empty)");
+  }
+  for (uint8_t i = 0; i < count; i++) {
+    Serial.printf("  %-32s %-16s TTL %5lus  hits %u\n", entries[i].name,
+                  IPAddress(entries[i].address).toString().c_str(),
+                  (unsigned long)((entries[i].expires_ms - now) / 1000), entries[i].hits);
+  }
+  Serial.println("===================\n");
+}
+
+String exportDnsCacheJSON() {
+  DnsCacheEntry entries[DNS_CACHE_SIZE];
+  uint8_t count = dnsCacheSnapshot(entries, DNS_CACHE_SIZE);
+  DnsCacheStats stats = dnsCacheGetStats();
+  uint32_t now = dnsMillis();
+
+  String json = "{";
+  json += "\"hits\":" + String(stats.hits) + ",";
+  json += "\"misses\":" + String(stats.misses) + ",";
+  json += "\"expired\":" + String(stats.expired) + ",";
+  json += "\"evictions\":" + String(stats.evictions) + ",";
+  json += "\"entries\":[";
+  for (uint8_t i = 0; i < count; i++) {
+    if (i > 0) json += ",";
+    json += "{\"name\":\"" + String(entries[i].name) + "\"";
+    json += ",\"ip\":\"" + IPAddress(entries[i].address).toString() + "\"";
+    json += ",\"ttl\":" + String((entries[i].expires_ms - now) / 1000);
+    json += ",\"hits\":" + String(entries[i].hits) + "}";
+  }
+  json += "]}";
+  return json;
+}
+
+static void dnsBenchTask(void* parameter) {
+  static DnsBenchResults working;
+
+  LOG_INFO(TAG_DNS, "Benchmarking %u resolvers, %u queries per phase",
+           benchConfig.resolver_count, benchConfig.queries);
+  bool finished = dnsRunBenchmark(benchConfig, working, &benchCancel);
+
+  if (xSemaphoreTake(benchMutex, portMAX_DELAY) == pdTRUE) {
+    benchResults = working;
+    xSemaphoreGive(benchMutex);
+  }
+  benchState = finished ? DNS_BENCH_COMPLETED : DNS_BENCH_IDLE;
+
+  if (finished) {
+    printDnsBenchResults(working);
+  } else {
+    Serial.println("⏹️ DNS benchmark stopped");
+  }
+
+  benchTaskHandle = nullptr;
+  vTaskDelete(nullptr);
+}
+
+bool startDnsBenchmark(const DnsBenchConfig& config) {
+  if (benchTaskHandle != nullptr) {
+    Serial.println("❌ DNS benchmark already running. Use 'dns stop' first.");
+    return false;
+  }
+
+  if (benchMutex == nullptr) {
+    benchMutex = xSemaphoreCreateMutex();
+    if (benchMutex == nullptr) {
+      LOG_ERROR(TAG_DNS, "Failed to create results mutex");
+      return false;
+    }
+  }
+
+  benchConfig = config;
+  if (benchConfig.resolver_count == 0) {
+    const uint32_t publicResolvers[] = {
+      (uint32_t)IPAddress(1, 1, 1, 1), (uint32_t)IPAddress(8, 8, 8, 8), (uint32_t)IPAddress(9, 9, 9, 9)
+    };
+    uint32_t dhcpResolver = (uint32_t)WiFi.dnsIP(0);
+    if (dhcpResolver != 0) {
+      benchConfig.resolvers[benchConfig.resolver_count++] = dhcpResolver;
+    }
+    for (uint8_t i = 0; i < 3 && benchConfig.resolver_count < DNS_BENCH_MAX_RESOLVERS; i++) {
+      if (publicResolvers[i] != dhcpResolver) {
+        benchConfig.resolvers[benchConfig.resolver_count++] = publicResolvers[i];
+      }
+    }
+  }
+
+  benchCancel = false;
+  benchState = DNS_BENCH_RUNNING;
+
+  BaseType_t result = xTaskCreatePinnedToCore(
+    dnsBenchTask,             // Task function
+    "DNS_Benchmark",          // Task name
+    DNS_BENCH_TASK_STACK,     // Stack size (bytes)
+    nullptr,                  // Task parameters
+    1,                        // Priority (same as loop)
+    &benchTaskHandle,         // Task handle
+    1                         // Core ID (1 = app core)
+  );
+
+  if (result != pdPASS) {
+    LOG_ERROR(TAG_DNS, "Failed to create DNS benchmark task");
+    benchTaskHandle = nullptr;
+    benchState = DNS_BENCH_ERROR;
+    return false;
+  }
+
+  Serial.printf("🌐 Benchmarking %u resolvers: %u cold + %u warm queries each\n",
+                benchConfig.resolver_count, benchConfig.queries, benchConfig.queries);
+  return true;
+}
+
+void stopDnsBenchmark() {
+  if (benchTaskHandle == nullptr) return;
+  benchCancel = true;
+  Serial.println("⏹️ Stopping DNS benchmark...");
+}
+
+DnsBenchState getDnsBenchState() {
+  return benchState;
+}
+
+DnsBenchResults getDnsBenchResults() {
+  DnsBenchResults snapshot;
+  memset(&snapshot, 0, sizeof(snapshot));
+  if (benchMutex != nullptr && xSemaphoreTake(benchMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+    snapshot = benchResults;
+    xSemaphoreGive(benchMutex);
+  }
+  return snapshot;
+}
+
+static void printPhase(const char* resolver, const char* phase, const DnsLatencyStats& stats) {
+  if (stats.answered == 0) {
+    Serial.printf("%-16s %-5s %3u/%-3u       no answers\n", resolver, phase, stats.answered, stats.sent);
+    return;
+  }
+  Serial.printf("%-16s %-5s %3u/%-3u %7.1f %7.1f %7.1f %7.1f\n", resolver, phase,
+                stats.answered, stats.sent, stats.min_ms, stats.median_ms, stats.p90_ms, stats.max_ms);
+}
+
+void printDnsBenchResults(const DnsBenchResults& results) {
+  Serial.println("\n🌐 === DNS Resolver Benchmark ===");
+  Serial.println("Resolver         Phase  Answered   Min  Median     P90     Max  (ms)");
+  for (uint8_t i = 0; i < results.resolver_count; i++) {
+    const DnsResolverResult& result = results.resolvers[i];
+    String address = IPAddress(result.resolver).toString();
+    printPhase(address.c_str(), "cold", result.cold);
+    printPhase("", "warm", result.warm);
+  }
+  if (results.resolver_count > 0 && results.resolvers[results.fastest].warm.answered > 0) {
+    Serial.printf("⭐ Fastest warm median: %s (%.1f ms)\n",
+                  IPAddress(results.resolvers[results.fastest].resolver).toString().c_str(),
+                  results.resolvers[results.fastest].warm.median_ms);
+  }
+  Serial.println("Cold = resolver recursion (random names), warm = resolver cache hit");
+  Serial.println("================================\n");
+}
+
+static String phaseJSON(const DnsLatencyStats& stats) {
+  String json = "{";
+  json += "\"sent\":" + String(stats.sent);
+  json += ",\"answered\":" + String(stats.answered);
+  json += ",\"failed\":" + String(stats.failed);
+  json += ",\"min\":" + String(stats.min_ms, 2);
+  json += ",\"median\":" + String(stats.median_ms, 2);
+  json += ",\"p90\":" + String(stats.p90_ms, 2);
+  json += ",\"max\":" + String(stats.max_ms, 2);
+  json += ",\"avg\":" + String(stats.avg_ms, 2);
+  json += "}";
+  return json;
+}
+
+String exportDnsBenchJSON(const DnsBenchResults& results) {
+  String json = "{";
+  json += "\"state\":\"" + dnsBenchStateToString(benchState) + "\",";
+  json += "\"fastest\":\"" +
+          (results.resolver_count > 0 ? IPAddress(results.resolvers[results.fastest].resolver).toString()
+                                      : String("")) + "\",";
+  json += "\"resolvers\":[";
+  for (uint8_t i = 0; i < results.resolver_count; i++) {
+    if (i > 0) json += ",";
+    json += "{\"ip\":\"" + IPAddress(results.resolvers[i].resolver).toString() + "\"";
+    json += ",\"cold\":" + phaseJSON(results.resolvers[i].cold);
+    json += ",\"warm\":" + phaseJSON(results.resolvers[i].warm);
+    json += "}";
+  }
+  json += "]}";
+  return json;
+}
+
+String dnsBenchStateToString(DnsBenchState state) {
+  switch (state) {
+    case DNS_BENCH_IDLE: return "idle";
+    case DNS_BENCH_RUNNING: return "running";
+    case DNS_BENCH_COMPLETED: return "completed";
+    case DNS_BENCH_ERROR: return "error";
+    default: return "unknown";
+  }
+}
+#endif
@@ -0,0 +1,301 @@
+/**
+ * @file dns_resolver.h
+ * @brief DNS resolution with a TTL-respecting cache and resolver benchmark
+ *
+ * Minimal stub resolver (A records over UDP) that keeps answers for the TTL
+ * the server returned, so every network tool resolves a hostname once and
+ * its probes measure only the connection or request they claim to.
+ *
+ * The benchmark times queries against several resolvers: cold queries use a
+ * random label under each test domain so the resolver has to recurse, warm
+ * queries repeat names the resolver has just answered. Results report
+ * min/median/p90/max per resolver and phase.
+ *
+ * The engine is portable BSD-socket code; pc_test_apps/dns_bench_test runs
+ * it on Linux against scripts/dns_test_server.py.
+ *
+ * @author Arunkumar Mourougappane
+ * @version 3.0.0
+ * @date 2026-01-17
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <IPAddress.h>
+#endif
+
+// ==========================================
+// DNS CONFIGURATION
+// ==========================================
+#define DNS_PORT 53
+#define DNS_MAX_NAME_LENGTH 64            // Hostnames kept in the cache, incl. terminator
+#define DNS_MAX_MESSAGE_SIZE 512          // Plain UDP DNS (RFC 1035)
+#define DNS_CACHE_SIZE 16
+#define DNS_CACHE_MAX_TTL_S 3600          // Cap very long TTLs so renumbering is noticed
+#define DNS_DEFAULT_TIMEOUT_MS 2000
+#define DNS_BENCH_MAX_RESOLVERS 4
+#define DNS_BENCH_MAX_DOMAINS 8
+#define DNS_BENCH_DEFAULT_QUERIES 10      // Timed queries per resolver and phase
+#define DNS_BENCH_MAX_QUERIES 32
+
+// ==========================================
+// TYPES AND STATES
+// ==========================================
+enum DnsQueryStatus {
+  DNS_QUERY_OK = 0,           // Answer with an A record
+  DNS_QUERY_NXDOMAIN = 1,     // Name does not exist (still a complete answer)
+  DNS_QUERY_NO_ADDRESS = 2,   // NOERROR without an A record
+  DNS_QUERY_SERVER_ERROR = 3, // SERVFAIL, REFUSED, malformed reply
+  DNS_QUERY_TIMEOUT = 4,
+  DNS_QUERY_SOCKET_ERROR = 5
+};
+
+enum DnsResolveSource {
+  DNS_SOURCE_LITERAL = 0,     // Host was already an IPv4 address
+  DNS_SOURCE_CACHE = 1,
+  DNS_SOURCE_QUERY = 2
+};
+
+enum DnsBenchState {
+  DNS_BENCH_IDLE = 0,
+  DNS_BENCH_RUNNING = 1,
+  DNS_BENCH_COMPLETED = 2,
+  DNS_BENCH_ERROR = 3
+};
+
+// ==========================================
+// DATA STRUCTURES
+// ==========================================
+struct DnsAnswer {
+  DnsQueryStatus status;
+  uint32_t address;           // First A record, network byte order
+  uint32_t ttl_s;             // Lowest TTL along the answer chain
+  uint8_t rcode;
+};
+
+struct DnsResolveInfo {
+  DnsResolveSource source;
+  DnsQueryStatus status;
+  uint32_t elapsed_us;        // Time spent resolving, 0 for literals
+  uint32_t ttl_remaining_s;   // Cache lifetime left for the returned address
+};
+
+struct DnsCacheEntry {
+  char name[DNS_MAX_NAME_LENGTH];
+  uint32_t address;
+  uint32_t expires_ms;
+  uint32_t last_used_ms;
+  uint16_t hits;
+};
+
+struct DnsCacheStats {
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t expired;           // Misses caused by an entry running out of TTL
+  uint32_t evictions;
+  uint8_t entries;
+};
+
+/**
+ * @brief Latency distribution of one benchmark phase
+ */
+struct DnsLatencyStats {
+  uint16_t sent;
+  uint16_t answered;          // Any complete reply, NXDOMAIN included
+  uint16_t failed;            // Timeouts, server errors
+  float min_ms;
+  float median_ms;
+  float p90_ms;
+  float max_ms;
+  float avg_ms;
+};
+
+struct DnsBenchConfig {
+  uint32_t resolvers[DNS_BENCH_MAX_RESOLVERS];  // Network byte order
+  uint8_t resolver_count;
+  uint16_t port;
+  const char* domains[DNS_BENCH_MAX_DOMAINS];   // Base names for cold/warm queries
+  uint8_t domain_count;
+  uint8_t queries;            // Timed queries per resolver and phase
+  uint16_t timeout_ms;
+};
+
+struct DnsResolverResult {
+  uint32_t resolver;
+  DnsLatencyStats cold;       // Random label: resolver must recurse
+  DnsLatencyStats warm;       // Name the resolver answered moments ago
+};
+
+struct DnsBenchResults {
+  uint8_t resolver_count;
+  uint8_t fastest;            // Index with the lowest warm median
+  DnsResolverResult resolvers[DNS_BENCH_MAX_RESOLVERS];
+};
+
+// ==========================================
+// QUERY ENGINE (portable)
+// ==========================================
+
+/**
+ * @brief Send one A query and wait for its answer
+ * @param resolver Resolver address (network byte order)
+ * @param port Resolver UDP port
+ * @param name Hostname to look up
+ * @param timeout_ms Maximum wait for the reply
+ * @param answer Filled with status, address and TTL
+ * @param elapsed_us Optional round-trip time of the exchange
+ * @return true if a complete reply arrived (answer.status tells which kind)
+ */
+bool dnsQuery(uint32_t resolver, uint16_t port, const char* name, uint32_t timeout_ms,
+              DnsAnswer& answer, uint32_t* elapsed_us = nullptr);
+
+/**
+ * @brief Encode an A/IN query
+ * @return Message length, 0 if the name does not fit
+ */
+size_t dnsEncodeQuery(uint8_t* buffer, size_t size, uint16_t id, const char* name);
+
+/**
+ * @brief Decode a reply to a query built by dnsEncodeQuery
+ * @return false if the message is not a reply to this id
+ */
+bool dnsDecodeResponse(const uint8_t* buffer, size_t length, uint16_t id, DnsAnswer& answer);
+
+// ==========================================
+// RESOLVER CACHE (portable)
+// ==========================================
+
+/**
+ * @brief Set the resolver used by dnsResolve on cache misses
+ * @param resolver Address in network byte order (0 = platform default)
+ * @param port UDP port
+ */
+void dnsSetResolver(uint32_t resolver, uint16_t port = DNS_PORT);
+
+/**
+ * @brief Resolve a hostname or IPv4 literal through the cache
+ * @param host Hostname or dotted-quad address
+ * @param address Result in network byte order
+ * @param info Optional: where the answer came from and how long it took
+ * @return true if an address is available
+ */
+bool dnsResolve(const char* host, uint32_t& address, DnsResolveInfo* info = nullptr);
+
+/**
+ * @brief Drop all cached answers (statistics are kept)
+ */
+void dnsCacheFlush();
+
+/**
+ * @brief Get cache hit/miss counters
+ */
+DnsCacheStats dnsCacheGetStats();
+
+/**
+ * @brief Copy live cache entries
+ * @param entries Destination array
+ * @param max Capacity of entries
+ * @return Number of entries copied
+ */
+uint8_t dnsCacheSnapshot(DnsCacheEntry* entries, uint8_t max);
+
+/**
+ * @brief Monotonic millisecond clock used for cache expiry
+ */
+uint32_t dnsMillis();
+
+// ==========================================
+// RESOLVER BENCHMARK (portable)
+// ==========================================
+
+/**
+ * @brief Get default benchmark configuration (no resolvers set)
+ */
+DnsBenchConfig getDefaultDnsBenchConfig();
+
+/**
+ * @brief Time cold and warm queries against every configured resolver
+ *
+ * Queries are interleaved across resolvers so changing link conditions
+ * affect all of them equally.
+ *
+ * @param config Resolvers, domains and query counts
+ * @param results Filled with per-resolver statistics
+ * @param cancel Optional external stop flag
+ * @return false if cancelled
+ */
+bool dnsRunBenchmark(const DnsBenchConfig& config, DnsBenchResults& results,
+                     volatile bool* cancel = nullptr);
+
+/**
+ * @brief Convert query status to string
+ */
+const char* dnsQueryStatusToString(DnsQueryStatus status);
+
+#ifdef ARDUINO
+// ==========================================
+// ESP32 RUNNER (cache helpers, benchmark task)
+// ==========================================
+
+/**
+ * @brief Resolve into an IPAddress through the cache
+ * @param host Hostname or IPv4 literal
+ * @param ip Resolved address
+ * @param info Optional resolution details
+ * @return true if resolved
+ */
+bool dnsResolve(const String& host, IPAddress& ip, DnsResolveInfo* info = nullptr);
+
+/**
+ * @brief Print cache entries and counters to serial
+ */
+void printDnsCache();
+
+/**
+ * @brief Export cache entries and counters to JSON format
+ */
+String exportDnsCacheJSON();
+
+/**
+ * @brief Start the resolver benchmark in a background task
+ * @param config Benchmark configuration; with no resolvers the DHCP resolver
+ *               plus 1.1.1.1, 8.8.8.8 and 9.9.9.9 are used
+ * @return true if the task was started
+ */
+bool startDnsBenchmark(const DnsBenchConfig& config);
+
+/**
+ * @brief Stop a running benchmark
+ */
+void stopDnsBenchmark();
+
+/**
+ * @brief Get current benchmark state
+ */
+DnsBenchState getDnsBenchState();
+
+/**
+ * @brief Get a copy of the last benchmark results
+ */
+DnsBenchResults getDnsBenchResults();
+
+/**
+ * @brief Print benchmark results to serial
+ */
+void printDnsBenchResults(const DnsBenchResults& results);
+
+/**
+ * @brief Export benchmark results to JSON format
+ */
+String exportDnsBenchJSON(const DnsBenchResults& results);
+
+/**
+ * @brief Convert benchmark state to string
+ */
+String dnsBenchStateToString(DnsBenchState state);
+#endif
@@ -0,0 +1,240 @@
+/**
+ * @file echo_service.cpp
+ * @brief On-device UDP echo service implementation
+ *
+ * This file implements the UDP echo responder:
+ * - Dedicated FreeRTOS task on a blocking lwIP socket (no loop() polling)
+ * - PING/PONG text probes rewritten in place, other payloads echoed verbatim
+ * - Per-datagram receive-to-send turnaround measurement
+ * - Works on any interface (AP, STA or both)
+ *
+ * @author Arunkumar Mourougappane
+ * @version 3.0.0
+ * @date 2026-01-17
+ */
+
+#include "echo_service.h"
+#include "logging.h"
+#include <lwip/sockets.h>
+#include <esp_timer.h>
+
+#define TAG_ECHO "Echo"
+
+// ==========================================
+// SERVICE STATE
+// ==========================================
+static TaskHandle_t echoTaskHandle = nullptr;
+static SemaphoreHandle_t echoStatsMutex = nullptr;
+static int echoSocket = -1;
+static volatile bool echoStopRequested = false;
+static EchoServiceStats echoStats;
+static uint64_t turnaroundTotalUs = 0;
+
+static void recordEcho(bool isPing, size_t len, uint32_t turnaround, const struct sockaddr_in& client, bool sent) {
+  if (xSemaphoreTake(echoStatsMutex, portMAX_DELAY) != pdTRUE) return;
+
+  if (!sent) {
+    echoStats.send_errors++;
+    xSemaphoreGive(echoStatsMutex);
+    return;
+  }
+
+  echoStats.packets_echoed++;
+  if (isPing) {
+    echoStats.ping_packets++;
+  } else {
+    echoStats.binary_packets++;
+  }
+  echoStats.bytes_echoed += len;
+  echoStats.last_turnaround_us = turnaround;
+  if (echoStats.packets_echoed == 1 || turnaround < echoStats.min_turnaround_us) {
+    echoStats.min_turnaround_us = turnaround;
+  }
+  if (turnaround > echoStats.max_turnaround_us) {
+    echoStats.max_turnaround_us = turnaround;
+  }
+  turnaroundTotalUs += turnaround;
+  echoStats.last_client_ip = client.sin_addr.s_addr;
+  echoStats.last_client_port = ntohs(client.sin_port);
+  echoStats.last_packet_ms = millis();
+
+  xSemaphoreGive(echoStatsMutex);
+}
+
+// ==========================================
+// ECHO TASK
+// ==========================================
+static void echoServiceTask(void* parameter) {
+  // Task-private buffer; static keeps it off the task stack
+  static uint8_t buffer[ECHO_SERVICE_BUFFER_SIZE];
+
+  LOG_INFO(TAG_ECHO, "Echo task started on Core 1");
+
+  while (!echoStopRequested) {
+    struct sockaddr_in client;
+    socklen_t clientLen = sizeof(client);
+
+    int len = recvfrom(echoSocket, buffer, sizeof(buffer), 0, (struct sockaddr*)&client, &clientLen);
+    int64_t receivedAt = esp_timer_get_time();
+    if (len <= 0) {
+      continue;  // Receive timeout: re-check the stop flag
+    }
+
+    // "PING <timestamp> <sequence>" -> "PONG <timestamp> <sequence>", anything else as-is
+    bool isPing = len >= 4 && memcmp(buffer, "PING", 4) == 0;
+    if (isPing) {
+      buffer[1] = 'O';
+    }
+
+    int sent = sendto(echoSocket, buffer, len, 0, (struct sockaddr*)&client, clientLen);
+    uint32_t turnaround = (uint32_t)(esp_timer_get_time() - receivedAt);
+
+    recordEcho(isPing, len, turnaround, client, sent == len);
+  }
+
+  close(echoSocket);
+  echoSocket = -1;
+  LOG_INFO(TAG_ECHO, "Echo task stopped");
+
+  echoTaskHandle = nullptr;
+  vTaskDelete(nullptr);
+}
+
+// ==========================================
+// SERVICE CONTROL
+// ==========================================
+bool startEchoService(uint16_t port) {
+  if (echoTaskHandle != nullptr) {
+    Serial.printf("❌ Echo service already running on UDP port %u\n", echoStats.port);
+    return false;
+  }
+
+  if (echoStatsMutex == nullptr) {
+    echoStatsMutex = xSemaphoreCreateMutex();
+    if (echoStatsMutex == nullptr) {
+      LOG_ERROR(TAG_ECHO, "Failed to create stats mutex");
+      return false;
+    }
+  }
+
+  // Bind here rather than in the task so errors reach the caller
+  int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (sock < 0) {
+    LOG_ERROR(TAG_ECHO, "Failed to create socket: errno %d", errno);
+    return false;
+  }
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    Serial.printf("❌ Echo service failed to bind UDP port %u (errno %d)\n", port, errno);
+    close(sock);
+    return false;
+  }
+
+  struct timeval timeout;
+  timeout.tv_sec = 0;
+  timeout.tv_usec = ECHO_SERVICE_POLL_MS * 1000;
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  echoSocket = sock;
+  echoStopRequested = false;
+  resetEchoServiceStats();
+  echoStats.port = port;
+
+  BaseType_t result = xTaskCreatePinnedToCore(
+    echoServiceTask,              // Task function
+    "Echo_Service",               // Task name
+    ECHO_SERVICE_TASK_STACK,      // Stack size (bytes)
+    nullptr,                      // Task parameters
+    ECHO_SERVICE_TASK_PRIORITY,   // Priority
+    &echoTaskHandle,              // Task handle
+    1                             // Core ID (1 = app core)
+  );
+
+  if (result != pdPASS) {
+    LOG_ERROR(TAG_ECHO, "Failed to create echo task");
+    close(sock);
+    echoSocket = -1;
+    echoTaskHandle = nullptr;
+    return false;
+  }
+
+  Serial.printf("✅ UDP echo service listening on port %u\n", port);
+  return true;
+}
+
+void stopEchoService() {
+  if (echoTaskHandle == nullptr) {
+    return;
+  }
+
+  echoStopRequested = true;
+
+  // The task notices within one receive timeout and clears its handle
+  unsigned long start = millis();
+  while (echoTaskHandle != nullptr && millis() - start < ECHO_SERVICE_POLL_MS * 3) {
+    delay(10);
+  }
+
+  Serial.printf("⏹️ UDP echo service stopped (%u packets echoed)\n", echoStats.packets_echoed);
+}
+
+bool isEchoServiceRunning() {
+  return echoTaskHandle != nullptr;
+}
+
+EchoServiceStats getEchoServiceStats() {
+  EchoServiceStats snapshot;
+  memset(&snapshot, 0, sizeof(snapshot));
+  if (echoStatsMutex == nullptr) {
+    return snapshot;
+  }
+
+  if (xSemaphoreTake(echoStatsMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+    snapshot = echoStats;
+    if (snapshot.packets_echoed > 0) {
+      snapshot.avg_turnaround_us = (uint32_t)(turnaroundTotalUs / snapshot.packets_echoed);
+    }
+    xSemaphoreGive(echoStatsMutex);
+  }
+  snapshot.running = isEchoServiceRunning();
+  return snapshot;
+}
+
+void resetEchoServiceStats() {
+  if (echoStatsMutex == nullptr) return;
+
+  if (xSemaphoreTake(echoStatsMutex, portMAX_DELAY) == pdTRUE) {
+    uint16_t port = echoStats.port;
+    memset(&echoStats, 0, sizeof(echoStats));
+    echoStats.port = port;
+    turnaroundTotalUs = 0;
+    xSemaphoreGive(echoStatsMutex);
+  }
+}
+
+void printEchoServiceStatus() {
+  EchoServiceStats stats = getEchoServiceStats();
+
+  if (!stats.running) {
+    Serial.println("📡 UDP echo service: stopped");
+    return;
+  }
+
+  Serial.printf("📡 UDP echo service: listening on port %u\n", stats.port);
+  Serial.printf("   Echoed: %u (PING: %u, binary: %u) | Send errors: %u\n",
+                stats.packets_echoed, stats.ping_packets, stats.binary_packets, stats.send_errors);
+
+  if (stats.packets_echoed > 0) {
+    IPAddress client(stats.last_client_ip);
+    Serial.printf("   Turnaround: %u/%u/%u us (min/avg/max), last %u us\n",
+                  stats.min_turnaround_us, stats.avg_turnaround_us,
+                  stats.max_turnaround_us, stats.last_turnaround_us);
+    Serial.printf("   Last client: %s:%u (%lu ms ago)\n", client.toString().c_str(),
+                  stats.last_client_port, millis() - stats.last_packet_ms);
+  }
+}
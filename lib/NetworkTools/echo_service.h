@@ -0,0 +1,88 @@
+/**
+ * @file echo_service.h
+ * @brief On-device UDP echo service for host-initiated latency tests
+ *
+ * Lets a laptop measure round-trip time to the ESP32 in either AP or STA
+ * mode. Runs in its own FreeRTOS task on a blocking lwIP socket so the
+ * main loop is never involved. Compatible with the PING/PONG text format
+ * used by the latency analyzer and pc_test_apps, and echoes any other
+ * (binary) payload back verbatim as per RFC 862.
+ *
+ * Receive-to-send turnaround inside the task is measured for every
+ * datagram so device-side processing can be separated from air time.
+ *
+ * @author Arunkumar Mourougappane
+ * @version 3.0.0
+ * @date 2026-01-17
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+// ==========================================
+// ECHO SERVICE CONFIGURATION
+// ==========================================
+#define ECHO_SERVICE_DEFAULT_PORT 7       // RFC 862 echo
+#define ECHO_SERVICE_BUFFER_SIZE 1472     // Largest unfragmented UDP payload
+#define ECHO_SERVICE_TASK_STACK 4096
+#define ECHO_SERVICE_TASK_PRIORITY 3      // Above loop() and WiFi_Command so replies are prompt
+#define ECHO_SERVICE_POLL_MS 500          // Receive timeout used to notice stop requests
+
+// ==========================================
+// DATA STRUCTURES
+// ==========================================
+struct EchoServiceStats {
+  bool running;                   // Derived from the task handle at snapshot time
+  uint16_t port;
+  uint32_t packets_echoed;
+  uint32_t ping_packets;          // PING -> PONG text probes
+  uint32_t binary_packets;        // Echoed verbatim
+  uint32_t send_errors;
+  uint64_t bytes_echoed;
+  uint32_t min_turnaround_us;     // Receive-to-send time inside the task
+  uint32_t max_turnaround_us;
+  uint32_t avg_turnaround_us;
+  uint32_t last_turnaround_us;
+  uint32_t last_client_ip;        // Network byte order
+  uint16_t last_client_port;
+  unsigned long last_packet_ms;   // millis() of last echoed packet
+};
+
+// ==========================================
+// SERVICE CONTROL
+// ==========================================
+
+/**
+ * @brief Start the echo service task
+ * @param port UDP port to listen on
+ * @return true if the socket is bound and the task is running
+ */
+bool startEchoService(uint16_t port = ECHO_SERVICE_DEFAULT_PORT);
+
+/**
+ * @brief Stop the echo service task and close its socket
+ */
+void stopEchoService();
+
+/**
+ * @brief Check whether the echo service is running
+ * @return true if running
+ */
+bool isEchoServiceRunning();
+
+/**
+ * @brief Get a consistent snapshot of echo service counters
+ * @return Copy of current statistics
+ */
+EchoServiceStats getEchoServiceStats();
+
+/**
+ * @brief Reset echo service counters (keeps the service running)
+ */
+void resetEchoServiceStats();
+
+/**
+ * @brief Print echo service status and turnaround statistics
+ */
+void printEchoServiceStatus();
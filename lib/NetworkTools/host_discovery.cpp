@@ -0,0 +1,994 @@
+/**
+ * @file host_discovery.cpp
+ * @brief Subnet host discovery sweep implementation
+ *
+ * This file implements live host discovery:
+ * - ARP sweep of on-link ranges (lwIP etharp / Linux packet socket)
+ * - ICMP echo and TCP connect ping fallback for off-link ranges
+ * - Sliding probe windows with per-probe timeouts and retries
+ * - Host table with MAC, OUI vendor and RTT, optional per-host port scan
+ * - Background FreeRTOS task, serial table and JSON export on the ESP32
+ *
+ * @author Arunkumar Mourougappane
+ * @version 3.0.0
+ * @date 2026-01-17
+ */
+
+#include "host_discovery.h"
+#include "icmp_probe.h"
+#include <string.h>
+#include <errno.h>
+
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#include <lwip/netif.h>
+#include <lwip/etharp.h>
+#include <lwip/priv/tcpip_priv.h>
+#include <WiFi.h>
+#include "logging.h"
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/ioctl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <ifaddrs.h>
+#include <stdio.h>
+#include <linux/if_packet.h>
+#include <linux/if_ether.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+#define HOSTDISC_MAX_WINDOW 32       // Largest of the per-method windows
+#define HOSTDISC_POLL_US 10000       // ARP table poll interval on the ESP32
+#define ARP_PACKET_SIZE 28
+
+// ==========================================
+// OUI VENDOR TABLE
+// ==========================================
+struct OuiEntry {
+  uint32_t oui;                 // First three MAC bytes
+  const char* vendor;
+};
+
+// Sorted by OUI for binary search
+static const OuiEntry OUI_TABLE[] = {
+  {0x000C29, "VMware"},
+  {0x000E58, "Sonos"},
+  {0x001132, "Synology"},
+  {0x00155D, "Microsoft"},
+  {0x001788, "Philips Hue"},
+  {0x001B63, "Apple"},
+  {0x002500, "Apple"},
+  {0x005056, "VMware"},
+  {0x04D6AA, "Samsung"},
+  {0x083AF2, "Espressif"},
+  {0x14CC20, "TP-Link"},
+  {0x18FE34, "Espressif"},
+  {0x240AC4, "Espressif"},
+  {0x2462AB, "Espressif"},
+  {0x246F28, "Espressif"},
+  {0x24A43C, "Ubiquiti"},
+  {0x24B2DE, "Espressif"},
+  {0x28CDC1, "Raspberry Pi"},
+  {0x28CFE9, "Apple"},
+  {0x2CCF67, "Raspberry Pi"},
+  {0x30AEA4, "Espressif"},
+  {0x3C0754, "Apple"},
+  {0x3C5AB4, "Google"},
+  {0x3C71BF, "Espressif"},
+  {0x44650D, "Amazon"},
+  {0x50C7BF, "TP-Link"},
+  {0x546009, "Google"},
+  {0x5CCF7F, "Espressif"},
+  {0x600194, "Espressif"},
+  {0x74C246, "Amazon"},
+  {0x788A20, "Ubiquiti"},
+  {0x7C9EBD, "Espressif"},
+  {0x7CD1C3, "Apple"},
+  {0x802AA8, "Ubiquiti"},
+  {0x840D8E, "Espressif"},
+  {0x84CCA8, "Espressif"},
+  {0x84F3EB, "Espressif"},
+  {0x94B97E, "Espressif"},
+  {0x98DAC4, "TP-Link"},
+  {0x98F4AB, "Espressif"},
+  {0x9C3DCF, "Netgear"},
+  {0xA040A0, "Netgear"},
+  {0xA4CF12, "Espressif"},
+  {0xA848FA, "Espressif"},
+  {0xAC67B2, "Espressif"},
+  {0xB4E62D, "Espressif"},
+  {0xB827EB, "Raspberry Pi"},
+  {0xBCDDC2, "Espressif"},
+  {0xC44F33, "Espressif"},
+  {0xCC50E3, "Espressif"},
+  {0xD83ADD, "Raspberry Pi"},
+  {0xDCA632, "Raspberry Pi"},
+  {0xDC4F22, "Espressif"},
+  {0xE45F01, "Raspberry Pi"},
+  {0xE8DB84, "Espressif"},
+  {0xEC086B, "TP-Link"},
+  {0xECB5FA, "Philips Hue"},
+  {0xECFABC, "Espressif"},
+  {0xF0272D, "Amazon"},
+  {0xF0189C, "Apple"},
+  {0xF4F5D8, "Google"},
+  {0xFCECDA, "Ubiquiti"},
+};
+
+const char* hostVendorForMac(const uint8_t mac[6]) {
+  uint32_t oui = ((uint32_t)mac[0] << 16) | ((uint32_t)mac[1] << 8) | mac[2];
+  size_t low = 0;
+  size_t high = sizeof(OUI_TABLE) / sizeof(OUI_TABLE[0]);
+  while (low < high) {
+    size_t mid = (low + high) / 2;
+    if (OUI_TABLE[mid].oui == oui) return OUI_TABLE[mid].vendor;
+    if (OUI_TABLE[mid].oui < oui) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  // Locally administered bit: randomised (phones) or virtual interfaces
+  return (mac[0] & 0x02) ? "Private" : "Unknown";
+}
+
+const char* hostDiscoveryMethodToString(uint8_t method) {
+  switch (method) {
+    case HOSTDISC_METHOD_ARP: return "arp";
+    case HOSTDISC_METHOD_ICMP: return "icmp";
+    case HOSTDISC_METHOD_TCP: return "tcp";
+    default: return "none";
+  }
+}
+
+// ==========================================
+// SWEEP BOOKKEEPING
+// ==========================================
+struct SweepSlot {
+  bool busy;
+  bool answered;
+  bool failed;                  // Definite negative (e.g. host unreachable)
+  uint16_t index;               // Offset from the first address
+  uint32_t address;             // Network byte order
+  uint8_t attempt;
+  int fd;                       // TCP ping socket
+  uint64_t sent_us;
+  uint32_t rtt_us;
+  uint8_t mac[6];
+  bool has_mac;
+};
+
+struct SweepPhase {
+  uint8_t method;
+  uint8_t window;
+  bool (*send)(HostDiscoverySession& session, SweepSlot& slot);
+  void (*collect)(HostDiscoverySession& session, SweepSlot* slots, uint8_t count, uint32_t wait_us);
+  void (*release)(HostDiscoverySession& session, SweepSlot& slot);  // Optional, frees per-slot resources
+};
+
+static bool isCancelled(const HostDiscoverySession& session) {
+  return session.cancel != nullptr && *session.cancel;
+}
+
+static void markAnswered(SweepSlot& slot, uint64_t now) {
+  slot.answered = true;
+  slot.rtt_us = (uint32_t)(now - slot.sent_us);
+}
+
+// ==========================================
+// ARP (PLATFORM)
+// ==========================================
+#ifdef ARDUINO
+// Every reply takes an ARP table entry; a wider window evicts replies before
+// they are read, and the gateway the station is using along with them
+static_assert(HOSTDISC_ARP_WINDOW + HOSTDISC_ARP_HEADROOM <= ARP_TABLE_SIZE,
+              "HOSTDISC_ARP_WINDOW must fit lwIP's ARP table");
+
+// etharp must run in the tcpip thread; tcpip_api_call blocks until it has
+struct ArpCall {
+  struct tcpip_api_call_data call;   // Must be first
+  struct netif* netif;
+  uint32_t first;
+  uint32_t last;
+  uint32_t address;
+  SweepSlot* slots;
+  uint8_t count;
+};
+
+static err_t findNetifInTcpip(struct tcpip_api_call_data* data) {
+  ArpCall* call = (ArpCall*)data;
+  for (struct netif* netif = netif_list; netif != nullptr; netif = netif->next) {
+    if (!netif_is_up(netif) || netif->hwaddr_len != 6) continue;
+    uint32_t address = ip4_addr_get_u32(netif_ip4_addr(netif));
+    uint32_t mask = ip4_addr_get_u32(netif_ip4_netmask(netif));
+    if (address == 0 || mask == 0) continue;
+    if ((call->first & mask) == (address & mask) && (call->last & mask) == (address & mask)) {
+      call->netif = netif;
+      call->address = address;
+      return ERR_OK;
+    }
+  }
+  return ERR_IF;
+}
+
+static err_t arpRequestInTcpip(struct tcpip_api_call_data* data) {
+  ArpCall* call = (ArpCall*)data;
+  ip4_addr_t target;
+  target.addr = call->address;
+  return etharp_request(call->netif, &target);
+}
+
+static err_t arpLookupInTcpip(struct tcpip_api_call_data* data) {
+  ArpCall* call = (ArpCall*)data;
+  uint64_t now = icmpMonotonicMicros();
+  for (uint8_t i = 0; i < call->count; i++) {
+    SweepSlot& slot = call->slots[i];
+    if (!slot.busy || slot.answered) continue;
+
+    ip4_addr_t target;
+    target.addr = slot.address;
+    struct eth_addr* mac = nullptr;
+    const ip4_addr_t* entry = nullptr;
+    if (etharp_find_addr(call->netif, &target, &mac, &entry) >= 0 && mac != nullptr) {
+      memcpy(slot.mac, mac->addr, 6);
+      slot.has_mac = true;
+      markAnswered(slot, now);
+    }
+  }
+  return ERR_OK;
+}
+
+static bool arpOpen(HostDiscoverySession& session) {
+  ArpCall call;
+  memset(&call, 0, sizeof(call));
+  call.first = session.config.first;
+  call.last = session.config.last;
+  if (tcpip_api_call(findNetifInTcpip, &call.call) != ERR_OK) {
+    return false;
+  }
+  session.netif = call.netif;
+  session.local_address = call.address;
+  return true;
+}
+
+static bool arpSend(HostDiscoverySession& session, SweepSlot& slot) {
+  ArpCall call;
+  memset(&call, 0, sizeof(call));
+  call.netif = (struct netif*)session.netif;
+  call.address = slot.address;
+  return tcpip_api_call(arpRequestInTcpip, &call.call) == ERR_OK;
+}
+
+static void arpCollect(HostDiscoverySession& session, SweepSlot* slots, uint8_t count, uint32_t wait_us) {
+  // Replies land in the lwIP ARP table; poll it
+  uint32_t sleepUs = wait_us < HOSTDISC_POLL_US ? wait_us : HOSTDISC_POLL_US;
+  vTaskDelay(pdMS_TO_TICKS(sleepUs / 1000 > 0 ? sleepUs / 1000 : 1));
+
+  ArpCall call;
+  memset(&call, 0, sizeof(call));
+  call.netif = (struct netif*)session.netif;
+  call.slots = slots;
+  call.count = count;
+  tcpip_api_call(arpLookupInTcpip, &call.call);
+}
+#else
+static bool arpOpen(HostDiscoverySession& session) {
+  struct ifaddrs* interfaces = nullptr;
+  if (getifaddrs(&interfaces) != 0) return false;
+
+  char name[IFNAMSIZ] = "";
+  for (struct ifaddrs* ifa = interfaces; ifa != nullptr; ifa = ifa->ifa_next) {
+    if (ifa->ifa_addr == nullptr || ifa->ifa_netmask == nullptr || ifa->ifa_addr->sa_family != AF_INET) continue;
+    if (ifa->ifa_flags & IFF_LOOPBACK) continue;
+    uint32_t address = ((struct sockaddr_in*)ifa->ifa_addr)->sin_addr.s_addr;
+    uint32_t mask = ((struct sockaddr_in*)ifa->ifa_netmask)->sin_addr.s_addr;
+    if ((session.config.first & mask) == (address & mask) && (session.config.last & mask) == (address & mask)) {
+      snprintf(name, sizeof(name), "%s", ifa->ifa_name);
+      session.local_address = address;
+      break;
+    }
+  }
+  freeifaddrs(interfaces);
+  if (name[0] == '\0') return false;
+
+  session.arp_fd = socket(AF_PACKET, SOCK_DGRAM, htons(ETH_P_ARP));
+  if (session.arp_fd < 0) return false;
+
+  struct ifreq request;
+  memset(&request, 0, sizeof(request));
+  snprintf(request.ifr_name, sizeof(request.ifr_name), "%s", name);
+  if (ioctl(session.arp_fd, SIOCGIFHWADDR, &request) < 0) return false;
+  memcpy(session.local_mac, request.ifr_hwaddr.sa_data, 6);
+  session.ifindex = (int)if_nametoindex(name);
+
+  struct sockaddr_ll local;
+  memset(&local, 0, sizeof(local));
+  local.sll_family = AF_PACKET;
+  local.sll_protocol = htons(ETH_P_ARP);
+  local.sll_ifindex = session.ifindex;
+  if (bind(session.arp_fd, (struct sockaddr*)&local, sizeof(local)) < 0) return false;
+
+  int flags = fcntl(session.arp_fd, F_GETFL, 0);
+  fcntl(session.arp_fd, F_SETFL, flags | O_NONBLOCK);
+  return true;
+}
+
+static bool arpSend(HostDiscoverySession& session, SweepSlot& slot) {
+  uint8_t packet[ARP_PACKET_SIZE];
+  packet[0] = 0x00; packet[1] = 0x01;       // Ethernet
+  packet[2] = 0x08; packet[3] = 0x00;       // IPv4
+  packet[4] = 6;
+  packet[5] = 4;
+  packet[6] = 0x00; packet[7] = 0x01;       // Request
+  memcpy(packet + 8, session.local_mac, 6);
+  memcpy(packet + 14, &session.local_address, 4);
+  memset(packet + 18, 0, 6);
+  memcpy(packet + 24, &slot.address, 4);
+
+  struct sockaddr_ll destination;
+  memset(&destination, 0, sizeof(destination));
+  destination.sll_family = AF_PACKET;
+  destination.sll_protocol = htons(ETH_P_ARP);
+  destination.sll_ifindex = session.ifindex;
+  destination.sll_halen = 6;
+  memset(destination.sll_addr, 0xFF, 6);
+  return sendto(session.arp_fd, packet, sizeof(packet), 0, (struct sockaddr*)&destination,
+                sizeof(destination)) == (int)sizeof(packet);
+}
+
+static void arpCollect(HostDiscoverySession& session, SweepSlot* slots, uint8_t count, uint32_t wait_us) {
+  if (!icmpWaitReadable(session.arp_fd, wait_us)) return;
+
+  uint8_t packet[64];
+  ssize_t len;
+  while ((len = recv(session.arp_fd, packet, sizeof(packet), 0)) >= ARP_PACKET_SIZE) {
+    uint64_t now = icmpMonotonicMicros();
+    if (packet[6] != 0x00 || packet[7] != 0x02) continue;   // Replies only
+    uint32_t sender;
+    memcpy(&sender, packet + 14, 4);
+    for (uint8_t i = 0; i < count; i++) {
+      SweepSlot& slot = slots[i];
+      if (!slot.busy || slot.answered || slot.address != sender) continue;
+      memcpy(slot.mac, packet + 8, 6);
+      slot.has_mac = true;
+      markAnswered(slot, now);
+    }
+  }
+}
+#endif
+
+// ==========================================
+// ICMP AND TCP PINGS
+// ==========================================
+static bool icmpSend(HostDiscoverySession& session, SweepSlot& slot) {
+  return icmpSendEchoRequest(session.icmp_fd, slot.address, session.ident, slot.index, 0);
+}
+
+static void icmpCollect(HostDiscoverySession& session, SweepSlot* slots, uint8_t count, uint32_t wait_us) {
+  if (!icmpWaitReadable(session.icmp_fd, wait_us)) return;
+
+  IcmpMessage msg;
+  int rc;
+  while ((rc = icmpReceive(session.icmp_fd, msg)) >= 0) {
+    uint64_t now = icmpMonotonicMicros();
+    if (rc == 0) continue;
+
+    for (uint8_t i = 0; i < count; i++) {
+      SweepSlot& slot = slots[i];
+      if (!slot.busy || slot.answered || slot.failed) continue;
+
+      if (msg.type == ICMP_TYPE_ECHO_REPLY && msg.id == session.ident && msg.sequence == slot.index &&
+          msg.source == slot.address) {
+        markAnswered(slot, now);
+      } else if (msg.type == ICMP_TYPE_DEST_UNREACHABLE && msg.has_quote &&
+                 msg.quoted_protocol == ICMP_PROTO_ICMP && msg.quoted_id == session.ident &&
+                 msg.quoted_destination == slot.address) {
+        // A router reports the address dead; stop waiting for it
+        slot.failed = true;
+      }
+    }
+  }
+}
+
+static void closeTcpPing(int fd) {
+  struct linger abortive = {1, 0};
+  setsockopt(fd, SOL_SOCKET, SO_LINGER, &abortive, sizeof(abortive));
+  close(fd);
+}
+
+static bool tcpSend(HostDiscoverySession& session, SweepSlot& slot) {
+  if (slot.fd >= 0) {
+    closeTcpPing(slot.fd);   // Retry: fresh connect
+    slot.fd = -1;
+  }
+  int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) return false;
+
+  int flags = fcntl(fd, F_GETFL, 0);
+  fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(session.config.tcp_port);
+  address.sin_addr.s_addr = slot.address;
+
+  slot.fd = fd;
+  if (connect(fd, (struct sockaddr*)&address, sizeof(address)) == 0 || errno == ECONNREFUSED) {
+    markAnswered(slot, icmpMonotonicMicros());
+  } else if (errno != EINPROGRESS) {
+    slot.failed = true;
+  }
+  return true;
+}
+
+static void tcpCollect(HostDiscoverySession& session, SweepSlot* slots, uint8_t count, uint32_t wait_us) {
+  (void)session;
+  fd_set writeSet;
+  fd_set errorSet;
+  FD_ZERO(&writeSet);
+  FD_ZERO(&errorSet);
+  int maxFd = -1;
+  for (uint8_t i = 0; i < count; i++) {
+    const SweepSlot& slot = slots[i];
+    if (!slot.busy || slot.answered || slot.failed || slot.fd < 0) continue;
+    FD_SET(slot.fd, &writeSet);
+    FD_SET(slot.fd, &errorSet);
+    if (slot.fd > maxFd) maxFd = slot.fd;
+  }
+  if (maxFd < 0) return;
+
+  struct timeval tv;
+  tv.tv_sec = wait_us / 1000000;
+  tv.tv_usec = wait_us % 1000000;
+  if (select(maxFd + 1, nullptr, &writeSet, &errorSet, &tv) <= 0) return;
+
+  uint64_t now = icmpMonotonicMicros();
+  for (uint8_t i = 0; i < count; i++) {
+    SweepSlot& slot = slots[i];
+    if (!slot.busy || slot.answered || slot.failed || slot.fd < 0) continue;
+    if (!FD_ISSET(slot.fd, &writeSet) && !FD_ISSET(slot.fd, &errorSet)) continue;
+
+    // SYN-ACK and RST both prove the host is up
+    int error = 0;
+    socklen_t length = sizeof(error);
+    getsockopt(slot.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+    if (error == 0 || error == ECONNREFUSED || error == ECONNRESET) {
+      markAnswered(slot, now);
+    } else {
+      slot.failed = true;
+    }
+  }
+}
+
+static void tcpRelease(HostDiscoverySession& session, SweepSlot& slot) {
+  (void)session;
+  if (slot.fd >= 0) {
+    closeTcpPing(slot.fd);
+    slot.fd = -1;
+  }
+}
+
+// ==========================================
+// CONFIGURATION AND SETUP
+// ==========================================
+HostDiscoveryConfig getDefaultHostDiscoveryConfig() {
+  HostDiscoveryConfig config;
+  config.first = 0;
+  config.last = 0;
+  config.methods = HOSTDISC_METHOD_ALL;
+  config.timeout_ms = HOSTDISC_DEFAULT_TIMEOUT_MS;
+  config.retries = 1;
+  config.tcp_port = HOSTDISC_DEFAULT_TCP_PORT;
+  config.scan_ports = false;
+  return config;
+}
+
+void hostDiscoverySubnetRange(uint32_t address, uint32_t netmask, HostDiscoveryConfig& config) {
+  uint32_t host = ntohl(address);
+  uint32_t mask = ntohl(netmask);
+  if (mask < 0xFFFFFF00UL) mask = 0xFFFFFF00UL;   // Larger subnets: sweep our /24
+
+  if (mask >= 0xFFFFFFFEUL) {
+    config.first = address;
+    config.last = address;
+    return;
+  }
+  uint32_t network = host & mask;
+  config.first = htonl(network + 1);
+  config.last = htonl((network | ~mask) - 1);
+}
+
+void hostDiscoveryResetResults(HostDiscoveryResults& results, const HostDiscoveryConfig& config) {
+  memset(&results, 0, sizeof(results));
+  results.first = config.first;
+  results.last = config.last;
+  results.total = (uint16_t)(ntohl(config.last) - ntohl(config.first) + 1);
+}
+
+bool hostDiscoveryBegin(HostDiscoverySession& session, const HostDiscoveryConfig& config) {
+  memset(&session, 0, sizeof(session));
+  session.arp_fd = -1;
+  session.icmp_fd = -1;
+  session.config = config;
+
+  HostDiscoveryConfig& c = session.config;
+  uint32_t first = ntohl(c.first);
+  uint32_t last = ntohl(c.last);
+  if (first == 0 || last < first || last - first >= HOSTDISC_MAX_SWEEP) {
+    return false;
+  }
+  if (c.timeout_ms == 0) c.timeout_ms = HOSTDISC_DEFAULT_TIMEOUT_MS;
+  if (c.tcp_port == 0) c.tcp_port = HOSTDISC_DEFAULT_TCP_PORT;
+  session.ident = (uint16_t)((icmpMonotonicMicros() >> 4) | 1);
+
+  if ((c.methods & HOSTDISC_METHOD_ARP) && !arpOpen(session)) {
+    c.methods &= ~HOSTDISC_METHOD_ARP;
+    if (session.arp_fd >= 0) {
+      close(session.arp_fd);
+      session.arp_fd = -1;
+    }
+  }
+  if (c.methods & HOSTDISC_METHOD_ARP) {
+    // On the link every host must answer ARP; pings would only add timeouts
+    c.methods = HOSTDISC_METHOD_ARP;
+  }
+
+  if (c.methods & HOSTDISC_METHOD_ICMP) {
+    session.icmp_fd = icmpOpenRawSocket();
+    if (session.icmp_fd < 0) {
+      c.methods &= ~HOSTDISC_METHOD_ICMP;
+    }
+  }
+  return c.methods != 0;
+}
+
+void hostDiscoveryEnd(HostDiscoverySession& session) {
+  icmpCloseSocket(session.icmp_fd);
+  session.icmp_fd = -1;
+  if (session.arp_fd >= 0) {
+    close(session.arp_fd);
+    session.arp_fd = -1;
+  }
+}
+
+// ==========================================
+// SWEEP
+// ==========================================
+static void addHost(HostDiscoveryResults& results, const SweepSlot& slot, uint8_t method) {
+  if (results.host_count >= HOSTDISC_MAX_HOSTS) {
+    results.hosts_dropped++;
+    return;
+  }
+  DiscoveredHost& host = results.hosts[results.host_count++];
+  memset(&host, 0, sizeof(host));
+  host.address = slot.address;
+  host.found_by = method;
+  host.rtt_us = slot.rtt_us;
+  host.has_mac = slot.has_mac;
+  memcpy(host.mac, slot.mac, 6);
+}
+
+static inline bool isFound(const uint8_t* found, uint16_t index) {
+  return (found[index >> 3] >> (index & 7)) & 1;
+}
+
+static bool runPhase(HostDiscoverySession& session, HostDiscoveryResults& results,
+                     const SweepPhase& phase, uint8_t* found) {
+  SweepSlot slots[HOSTDISC_MAX_WINDOW];
+  memset(slots, 0, sizeof(slots));
+  for (uint8_t i = 0; i < HOSTDISC_MAX_WINDOW; i++) slots[i].fd = -1;
+
+  uint32_t first = ntohl(session.config.first);
+  uint64_t timeoutUs = (uint64_t)session.config.timeout_ms * 1000ULL;
+  uint16_t next = 0;
+  uint16_t done = 0;
+  uint8_t busy = 0;
+
+  while (true) {
+    if (isCancelled(session)) {
+      for (uint8_t i = 0; i < phase.window; i++) {
+        if (slots[i].busy && phase.release != nullptr) phase.release(session, slots[i]);
+      }
+      return false;
+    }
+
+    // Top the window up with addresses nobody has answered for yet
+    for (uint8_t i = 0; i < phase.window && next < results.total; i++) {
+      SweepSlot& slot = slots[i];
+      if (slot.busy) continue;
+
+      while (next < results.total &&
+             (isFound(found, next) || htonl(first + next) == session.local_address)) {
+        next++;
+        done++;
+      }
+      if (next >= results.total) break;
+
+      slot.busy = true;
+      slot.answered = false;
+      slot.failed = false;
+      slot.has_mac = false;
+      slot.index = next;
+      slot.address = htonl(first + next);
+      slot.attempt = 0;
+      slot.sent_us = icmpMonotonicMicros();
+      next++;
+      if (!phase.send(session, slot)) {
+        slot.busy = false;
+        if (busy == 0) {
+          done++;       // Nothing in flight to wait for: give up on this address
+        } else {
+          next--;       // Out of sockets: retry once a probe finishes
+        }
+        break;
+      }
+      busy++;
+    }
+    if (busy == 0) {
+      if (next >= results.total) break;
+      continue;
+    }
+
+    // Wait for replies until the earliest deadline
+    uint64_t now = icmpMonotonicMicros();
+    uint64_t wait = timeoutUs;
+    for (uint8_t i = 0; i < phase.window; i++) {
+      const SweepSlot& slot = slots[i];
+      if (!slot.busy || slot.answered || slot.failed) {
+        if (slot.busy) wait = 0;
+        continue;
+      }
+      uint64_t deadline = slot.sent_us + timeoutUs;
+      uint64_t remaining = deadline > now ? deadline - now : 0;
+      if (remaining < wait) wait = remaining;
+    }
+    if (wait > 0) {
+      phase.collect(session, slots, phase.window, (uint32_t)wait);
+    }
+
+    now = icmpMonotonicMicros();
+    for (uint8_t i = 0; i < phase.window; i++) {
+      SweepSlot& slot = slots[i];
+      if (!slot.busy) continue;
+
+      if (slot.answered) {
+        found[slot.index >> 3] |= (uint8_t)(1 << (slot.index & 7));
+        addHost(results, slot, phase.method);
+      } else if (!slot.failed && now - slot.sent_us < timeoutUs) {
+        continue;
+      } else if (!slot.failed && slot.attempt < session.config.retries) {
+        slot.attempt++;
+        slot.sent_us = now;
+        if (phase.send(session, slot)) continue;
+      }
+
+      if (phase.release != nullptr) phase.release(session, slot);
+      slot.busy = false;
+      busy--;
+      done++;
+      results.swept = done > results.swept ? done : results.swept;
+      if (slot.answered && session.on_progress != nullptr) {
+        session.on_progress(results, session.progress_context);
+      }
+    }
+  }
+
+  results.swept = results.total;
+  return true;
+}
+
+static void sortHosts(HostDiscoveryResults& results) {
+  for (uint8_t i = 1; i < results.host_count; i++) {
+    DiscoveredHost host = results.hosts[i];
+    uint8_t j = i;
+    while (j > 0 && ntohl(results.hosts[j - 1].address) > ntohl(host.address)) {
+      results.hosts[j] = results.hosts[j - 1];
+      j--;
+    }
+    results.hosts[j] = host;
+  }
+}
+
+bool hostDiscoverySweep(HostDiscoverySession& session, HostDiscoveryResults& results) {
+  static const SweepPhase PHASES[] = {
+    {HOSTDISC_METHOD_ARP, HOSTDISC_ARP_WINDOW, arpSend, arpCollect, nullptr},
+    {HOSTDISC_METHOD_ICMP, HOSTDISC_PING_WINDOW, icmpSend, icmpCollect, nullptr},
+    {HOSTDISC_METHOD_TCP, HOSTDISC_TCP_WINDOW, tcpSend, tcpCollect, tcpRelease},
+  };
+
+  uint8_t found[(HOSTDISC_MAX_SWEEP + 7) / 8];
+  memset(found, 0, sizeof(found));
+  uint64_t started = icmpMonotonicMicros();
+  bool finished = true;
+
+  for (const SweepPhase& phase : PHASES) {
+    if (!(session.config.methods & phase.method)) continue;
+    if (!runPhase(session, results, phase, found)) {
+      finished = false;
+      break;
+    }
+  }
+
+  sortHosts(results);
+  results.sweep_ms = (uint32_t)((icmpMonotonicMicros() - started) / 1000);
+  return finished;
+}
+
+// ==========================================
+// PER-HOST PORT SCAN
+// ==========================================
+static void recordHostPort(uint16_t port, PortScanOutcome outcome, uint32_t elapsed_us, void* context) {
+  (void)elapsed_us;
+  if (outcome != PORT_OUTCOME_OPEN) return;
+  DiscoveredHost* host = static_cast<DiscoveredHost*>(context);
+  if (host->open_count < HOSTDISC_HOST_OPEN_PORTS) {
+    host->open_ports[host->open_count] = port;
+  }
+  host->open_count++;
+}
+
+bool hostDiscoveryScanPorts(HostDiscoverySession& session, HostDiscoveryResults& results,
+                            const PortSet& ports, uint8_t window, uint32_t timeout_ms) {
+  uint64_t started = icmpMonotonicMicros();
+
+  for (uint8_t i = 0; i < results.host_count; i++) {
+    DiscoveredHost& host = results.hosts[i];
+    PortScanSession scan;
+    portScanBegin(scan, host.address, ports, window, timeout_ms);
+    scan.on_result = recordHostPort;
+    scan.context = &host;
+    scan.cancel = session.cancel;
+
+    bool finished = portScanRun(scan);
+    portScanEnd(scan);
+    if (!finished) return false;
+
+    // Completion order: keep the listed ports sorted
+    uint8_t listed = host.open_count < HOSTDISC_HOST_OPEN_PORTS ? host.open_count : HOSTDISC_HOST_OPEN_PORTS;
+    for (uint8_t a = 1; a < listed; a++) {
+      for (uint8_t b = a; b > 0 && host.open_ports[b - 1] > host.open_ports[b]; b--) {
+        uint16_t swap = host.open_ports[b];
+        host.open_ports[b] = host.open_ports[b - 1];
+        host.open_ports[b - 1] = swap;
+      }
+    }
+    host.scanned = true;
+    results.hosts_scanned++;
+    results.scan_ms = (uint32_t)((icmpMonotonicMicros() - started) / 1000);
+    if (session.on_progress != nullptr) {
+      session.on_progress(results, session.progress_context);
+    }
+  }
+  return true;
+}
+
+#ifdef ARDUINO
+// ==========================================
+// ESP32 RUNNER
+// ==========================================
+#define TAG_DISCOVERY "Discovery"
+#define HOSTDISC_TASK_STACK 6144
+#define HOSTDISC_SCAN_TIMEOUT_MS 500   // Per-host port scan, common ports
+
+static TaskHandle_t discoveryTaskHandle = nullptr;
+static SemaphoreHandle_t discoveryMutex = nullptr;
+static volatile bool discoveryCancel = false;
+static HostDiscoveryState discoveryState = HOSTDISC_IDLE;
+static HostDiscoveryResults discoveryResults;   // Published snapshot, guarded by discoveryMutex
+static HostDiscoveryConfig discoveryConfig;
+
+static void publishHostDiscoveryResults(const HostDiscoveryResults& results, void* context) {
+  (void)context;
+  if (xSemaphoreTake(discoveryMutex, portMAX_DELAY) == pdTRUE) {
+    discoveryResults = results;
+    xSemaphoreGive(discoveryMutex);
+  }
+}
+
+static void hostDiscoveryTask(void* parameter) {
+  (void)parameter;
+  // Working copy lives outside the task stack
+  static HostDiscoveryResults working;
+  static PortSet ports;
+  HostDiscoverySession session;
+
+  hostDiscoveryResetResults(working, discoveryConfig);
+  publishHostDiscoveryResults(working, nullptr);
+
+  if (!hostDiscoveryBegin(session, discoveryConfig)) {
+    LOG_ERROR(TAG_DISCOVERY, "No usable discovery method for this range");
+    discoveryState = HOSTDISC_ERROR;
+    discoveryTaskHandle = nullptr;
+    vTaskDelete(nullptr);
+    return;
+  }
+  session.cancel = &discoveryCancel;
+  session.on_progress = publishHostDiscoveryResults;
+
+  LOG_INFO(TAG_DISCOVERY, "Sweeping %u addresses (%s)", working.total,
+           (session.config.methods & HOSTDISC_METHOD_ARP) ? "ARP" : "ICMP/TCP ping");
+
+  bool finished = hostDiscoverySweep(session, working);
+  publishHostDiscoveryResults(working, nullptr);
+  LOG_INFO(TAG_DISCOVERY, "Sweep found %u hosts in %lu ms", working.host_count,
+           (unsigned long)working.sweep_ms);
+
+  if (finished && discoveryConfig.scan_ports && working.host_count > 0) {
+    discoveryState = HOSTDISC_SCANNING;
+    getCommonPorts(ports);
+    hostDiscoveryScanPorts(session, working, ports, CONCURRENT_CONNECTIONS, HOSTDISC_SCAN_TIMEOUT_MS);
+  }
+
+  hostDiscoveryEnd(session);
+  publishHostDiscoveryResults(working, nullptr);
+  discoveryState = HOSTDISC_COMPLETED;
+
+  printHostDiscoveryResults(working);
+
+  discoveryTaskHandle = nullptr;
+  vTaskDelete(nullptr);
+}
+
+bool startHostDiscovery(bool scanPorts) {
+  if (discoveryTaskHandle != nullptr) {
+    Serial.println("❌ Host discovery already running. Use 'discover stop' first.");
+    return false;
+  }
+  if (WiFi.status() != WL_CONNECTED) {
+    Serial.println("❌ Not connected to WiFi");
+    return false;
+  }
+  if (getPortScanState() == PORTSCAN_RUNNING) {
+    // Both need the same small lwIP socket budget
+    Serial.println("❌ Port scan in progress. Stop it first.");
+    return false;
+  }
+
+  if (discoveryMutex == nullptr) {
+    discoveryMutex = xSemaphoreCreateMutex();
+    if (discoveryMutex == nullptr) {
+      LOG_ERROR(TAG_DISCOVERY, "Failed to create results mutex");
+      return false;
+    }
+  }
+
+  discoveryConfig = getDefaultHostDiscoveryConfig();
+  hostDiscoverySubnetRange((uint32_t)WiFi.localIP(), (uint32_t)WiFi.subnetMask(), discoveryConfig);
+  discoveryConfig.scan_ports = scanPorts;
+  discoveryCancel = false;
+  discoveryState = HOSTDISC_SWEEPING;
+
+  BaseType_t result = xTaskCreatePinnedToCore(
+    hostDiscoveryTask,        // Task function
+    "HostDiscovery",          // Task name
+    HOSTDISC_TASK_STACK,      // Stack size (bytes)
+    nullptr,                  // Task parameters
+    1,                        // Priority (same as loop)
+    &discoveryTaskHandle,     // Task handle
+    1                         // Core ID (1 = app core)
+  );
+
+  if (result != pdPASS) {
+    LOG_ERROR(TAG_DISCOVERY, "Failed to create discovery task");
+    discoveryTaskHandle = nullptr;
+    discoveryState = HOSTDISC_ERROR;
+    return false;
+  }
+
+  Serial.printf("🔎 Discovering hosts %s - %s%s\n", IPAddress(discoveryConfig.first).toString().c_str(),
+                IPAddress(discoveryConfig.last).toString().c_str(),
+                scanPorts ? ", then scanning common ports" : "");
+  return true;
+}
+
+void stopHostDiscovery() {
+  if (discoveryTaskHandle == nullptr) return;
+  discoveryCancel = true;
+  Serial.println("⏹️ Stopping host discovery...");
+}
+
+HostDiscoveryState getHostDiscoveryState() {
+  return discoveryState;
+}
+
+HostDiscoveryResults getHostDiscoveryResults() {
+  HostDiscoveryResults snapshot;
+  hostDiscoveryResetResults(snapshot, discoveryConfig);
+  if (discoveryMutex != nullptr && xSemaphoreTake(discoveryMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+    snapshot = discoveryResults;
+    xSemaphoreGive(discoveryMutex);
+  }
+  return snapshot;
+}
+
+static String formatMac(const DiscoveredHost& host) {
+  if (!host.has_mac) return String("");
+  char text[18];
+  snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", host.mac[0], host.mac[1], host.mac[2],
+           host.mac[3], host.mac[4], host.mac[5]);
+  return String(text);
+}
+
+static String formatOpenPorts(const DiscoveredHost& host) {
+  String ports;
+  uint8_t listed = host.open_count < HOSTDISC_HOST_OPEN_PORTS ? host.open_count : HOSTDISC_HOST_OPEN_PORTS;
+  for (uint8_t i = 0; i < listed; i++) {
+    if (i > 0) ports += ",";
+    ports += String(host.open_ports[i]);
+  }
+  return ports;
+}
+
+void printHostDiscoveryResults(const HostDiscoveryResults& results) {
+  Serial.printf("\n🔎 === Hosts %s - %s ===\n", IPAddress(results.first).toString().c_str(),
+                IPAddress(results.last).toString().c_str());
+  Serial.printf("Swept: %u/%u | Hosts: %u | Sweep: %lu ms", results.swept, results.total,
+                results.host_count, (unsigned long)results.sweep_ms);
+  if (results.hosts_scanned > 0) {
+    Serial.printf(" | Port scan: %u hosts in %lu ms", results.hosts_scanned, (unsigned long)results.scan_ms);
+  }
+  Serial.println();
+  Serial.println("Address          MAC                Vendor        Via    RTT ms  Open ports");
+
+  for (uint8_t i = 0; i < results.host_count; i++) {
+    const DiscoveredHost& host = results.hosts[i];
+    String ports = host.scanned ? formatOpenPorts(host) : String("-");
+    if (host.open_count > HOSTDISC_HOST_OPEN_PORTS) ports += " (+" + String(host.open_count - HOSTDISC_HOST_OPEN_PORTS) + ")";
+    Serial.printf("%-16s %-18s %-13s %-5s %7.2f  %s\n", IPAddress(host.address).toString().c_str(),
+                  host.has_mac ? formatMac(host).c_str() : "-",
+                  host.has_mac ? hostVendorForMac(host.mac) : "-",
+                  hostDiscoveryMethodToString(host.found_by), host.rtt_us / 1000.0, ports.c_str());
+  }
+  if (results.hosts_dropped > 0) {
+    Serial.printf("⚠️ %u more hosts did not fit in the table\n", results.hosts_dropped);
+  }
+  Serial.println("==========================================\n");
+}
+
+String exportHostDiscoveryJSON(const HostDiscoveryResults& results) {
+  String json = "{";
+  json += "\"state\":\"" + hostDiscoveryStateToString(discoveryState) + "\",";
+  json += "\"first\":\"" + IPAddress(results.first).toString() + "\",";
+  json += "\"last\":\"" + IPAddress(results.last).toString() + "\",";
+  json += "\"swept\":" + String(results.swept) + ",";
+  json += "\"total\":" + String(results.total) + ",";
+  json += "\"sweepMs\":" + String(results.sweep_ms) + ",";
+  json += "\"scanMs\":" + String(results.scan_ms) + ",";
+  json += "\"hostsScanned\":" + String(results.hosts_scanned) + ",";
+  json += "\"dropped\":" + String(results.hosts_dropped) + ",";
+  json += "\"hosts\":[";
+
+  for (uint8_t i = 0; i < results.host_count; i++) {
+    const DiscoveredHost& host = results.hosts[i];
+    if (i > 0) json += ",";
+    json += "{\"ip\":\"" + IPAddress(host.address).toString() + "\"";
+    json += ",\"mac\":\"" + formatMac(host) + "\"";
+    json += ",\"vendor\":\"" + String(host.has_mac ? hostVendorForMac(host.mac) : "") + "\"";
+    json += ",\"via\":\"" + String(hostDiscoveryMethodToString(host.found_by)) + "\"";
+    json += ",\"rtt\":" + String(host.rtt_us / 1000.0, 2);
+    json += ",\"scanned\":" + String(host.scanned ? "true" : "false");
+    json += ",\"openCount\":" + String(host.open_count);
+    json += ",\"ports\":[" + formatOpenPorts(host) + "]";
+    json += "}";
+  }
+
+  json += "]}";
+  return json;
+}
+
+String hostDiscoveryStateToString(HostDiscoveryState state) {
+  switch (state) {
+    case HOSTDISC_IDLE: return "idle";
+    case HOSTDISC_SWEEPING: return "sweeping";
+    case HOSTDISC_SCANNING: return "scanning";
+    case HOSTDISC_COMPLETED: return "completed";
+    case HOSTDISC_ERROR: return "error";
+    default: return "unknown";
+  }
+}
+#endif
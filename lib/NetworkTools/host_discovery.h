@@ -0,0 +1,227 @@
+/**
+ * @file host_discovery.h
+ * @brief Subnet host discovery sweep with optional per-host port scan
+ *
+ * Sweeps an address range (normally the local /24) to find live hosts and
+ * builds a host table with IP, MAC, vendor (from the OUI) and RTT:
+ * - ARP requests for on-link ranges (lwIP etharp on the ESP32, a packet
+ *   socket on Linux). A host that does not answer ARP is not reachable on
+ *   the link, so ARP is authoritative there.
+ * - ICMP echo and TCP connect pings for ranges ARP cannot cover (behind a
+ *   router, or when ARP is disabled).
+ * Probes run in bounded sliding windows, so a /24 sweep takes a few
+ * seconds. Live hosts can then be port scanned one after another with the
+ * concurrent port scan engine.
+ *
+ * Builds against lwIP on the ESP32 and against the host socket API on
+ * Linux for pc_test_apps/discovery_test. ARP and ICMP need root on Linux.
+ *
+ * @author Arunkumar Mourougappane
+ * @version 3.0.0
+ * @date 2026-01-17
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "port_scanner.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// ==========================================
+// DISCOVERY CONFIGURATION
+// ==========================================
+#define HOSTDISC_MAX_HOSTS 64            // Host table rows
+#define HOSTDISC_MAX_SWEEP 254           // Addresses per sweep (one /24)
+#define HOSTDISC_ARP_WINDOW 8            // ARP requests in flight; replies land in lwIP's ARP
+                                         // table, so this must leave room for the gateway
+#define HOSTDISC_ARP_HEADROOM 2          // ARP table entries kept for the station's own traffic
+#define HOSTDISC_PING_WINDOW 32          // ICMP echoes in flight (one raw socket)
+#define HOSTDISC_TCP_WINDOW 8            // TCP pings in flight (one socket each)
+#define HOSTDISC_DEFAULT_TIMEOUT_MS 200
+#define HOSTDISC_DEFAULT_TCP_PORT 80     // SYN-ACK or RST both prove the host is up
+#define HOSTDISC_HOST_OPEN_PORTS 8       // Open ports kept per host after a scan
+
+// Discovery methods (bit mask)
+#define HOSTDISC_METHOD_ARP 0x01
+#define HOSTDISC_METHOD_ICMP 0x02
+#define HOSTDISC_METHOD_TCP 0x04
+#define HOSTDISC_METHOD_ALL (HOSTDISC_METHOD_ARP | HOSTDISC_METHOD_ICMP | HOSTDISC_METHOD_TCP)
+
+// ==========================================
+// TYPES AND STATES
+// ==========================================
+enum HostDiscoveryState {
+  HOSTDISC_IDLE = 0,
+  HOSTDISC_SWEEPING = 1,
+  HOSTDISC_SCANNING = 2,       // Port scanning the live hosts
+  HOSTDISC_COMPLETED = 3,
+  HOSTDISC_ERROR = 4
+};
+
+// ==========================================
+// DATA STRUCTURES
+// ==========================================
+struct HostDiscoveryConfig {
+  uint32_t first;               // First address (network byte order)
+  uint32_t last;                // Last address, at most HOSTDISC_MAX_SWEEP after first
+  uint8_t methods;              // HOSTDISC_METHOD_* mask
+  uint16_t timeout_ms;          // Per-probe reply timeout
+  uint8_t retries;              // Extra probes for silent addresses
+  uint16_t tcp_port;            // TCP ping port
+  bool scan_ports;              // Port scan every live host after the sweep
+};
+
+struct DiscoveredHost {
+  uint32_t address;             // Network byte order
+  uint8_t mac[6];
+  bool has_mac;                 // Only ARP answers carry a MAC
+  uint8_t found_by;             // HOSTDISC_METHOD_* that answered first
+  uint32_t rtt_us;
+  bool scanned;
+  uint16_t open_count;
+  uint16_t open_ports[HOSTDISC_HOST_OPEN_PORTS];   // First open ports found
+};
+
+struct HostDiscoveryResults {
+  uint32_t first;
+  uint32_t last;
+  uint16_t swept;               // Addresses probed so far
+  uint16_t total;               // Addresses in the range
+  uint8_t host_count;
+  uint16_t hosts_dropped;       // Live hosts that did not fit in the table
+  uint8_t hosts_scanned;
+  uint32_t sweep_ms;
+  uint32_t scan_ms;
+  DiscoveredHost hosts[HOSTDISC_MAX_HOSTS];   // Sorted by address after the sweep
+};
+
+/**
+ * @brief Engine state for one discovery run
+ */
+struct HostDiscoverySession {
+  HostDiscoveryConfig config;
+  uint32_t local_address;       // Our address on the swept link (skipped), 0 if off-link
+  int arp_fd;                   // Linux packet socket, -1 on the ESP32
+  int icmp_fd;
+  int ifindex;
+  uint8_t local_mac[6];
+  void* netif;                  // lwIP netif on the ESP32
+  uint16_t ident;
+  volatile bool* cancel;        // Optional external stop flag
+
+  // Called as hosts are found and after each scanned host
+  void (*on_progress)(const HostDiscoveryResults& results, void* context);
+  void* progress_context;
+};
+
+// ==========================================
+// DISCOVERY ENGINE (portable)
+// ==========================================
+
+/**
+ * @brief Get default discovery configuration (range left empty)
+ */
+HostDiscoveryConfig getDefaultHostDiscoveryConfig();
+
+/**
+ * @brief Sweep range for a local subnet: the /24 (or smaller) around address
+ * @param address Local address (network byte order)
+ * @param netmask Subnet mask (network byte order)
+ * @param config Receives first/last
+ */
+void hostDiscoverySubnetRange(uint32_t address, uint32_t netmask, HostDiscoveryConfig& config);
+
+/**
+ * @brief Open sockets and prepare a session
+ *
+ * ARP is dropped from the methods when the range is not on a local link or
+ * the socket cannot be opened; ICMP likewise when raw sockets fail.
+ *
+ * @return false if no method is usable or the range is invalid
+ */
+bool hostDiscoveryBegin(HostDiscoverySession& session, const HostDiscoveryConfig& config);
+
+/**
+ * @brief Sweep the range and fill the host table
+ * @return false if cancelled
+ */
+bool hostDiscoverySweep(HostDiscoverySession& session, HostDiscoveryResults& results);
+
+/**
+ * @brief Port scan every live host with the concurrent engine
+ * @param ports Ports to probe on each host
+ * @param window Connects in flight per host
+ * @param timeout_ms Initial/maximum probe timeout
+ * @return false if cancelled
+ */
+bool hostDiscoveryScanPorts(HostDiscoverySession& session, HostDiscoveryResults& results,
+                            const PortSet& ports, uint8_t window, uint32_t timeout_ms);
+
+/**
+ * @brief Close the session sockets
+ */
+void hostDiscoveryEnd(HostDiscoverySession& session);
+
+/**
+ * @brief Clear results for a new run
+ */
+void hostDiscoveryResetResults(HostDiscoveryResults& results, const HostDiscoveryConfig& config);
+
+/**
+ * @brief Vendor for a MAC address from the built-in OUI table
+ * @return Vendor name, "Private" for locally administered (randomised)
+ *         addresses, or "Unknown"
+ */
+const char* hostVendorForMac(const uint8_t mac[6]);
+
+/**
+ * @brief Short name of a discovery method
+ */
+const char* hostDiscoveryMethodToString(uint8_t method);
+
+#ifdef ARDUINO
+// ==========================================
+// ESP32 RUNNER (task, serial, JSON)
+// ==========================================
+
+/**
+ * @brief Sweep the station subnet in a background task
+ * @param scanPorts Port scan each live host (common ports) after the sweep
+ * @return true if the task was started
+ */
+bool startHostDiscovery(bool scanPorts);
+
+/**
+ * @brief Stop a running discovery
+ */
+void stopHostDiscovery();
+
+/**
+ * @brief Get current discovery state
+ */
+HostDiscoveryState getHostDiscoveryState();
+
+/**
+ * @brief Get a snapshot of the current or last discovery results
+ */
+HostDiscoveryResults getHostDiscoveryResults();
+
+/**
+ * @brief Print the host table to serial
+ */
+void printHostDiscoveryResults(const HostDiscoveryResults& results);
+
+/**
+ * @brief Export the host table to JSON format
+ */
+String exportHostDiscoveryJSON(const HostDiscoveryResults& results);
+
+/**
+ * @brief Convert discovery state to string
+ */
+String hostDiscoveryStateToString(HostDiscoveryState state);
+#endif
@@ -0,0 +1,223 @@
+/**
+ * @file icmp_probe.cpp
+ * @brief Raw ICMP socket helpers implementation
+ *
+ * This file implements the shared ICMP layer:
+ * - Raw ICMP socket setup (lwIP or host BSD sockets)
+ * - Echo request construction with RFC 1071 checksum
+ * - ICMP decoding including quoted UDP/TCP/ICMP headers
+ *
+ * @author Arunkumar Mourougappane
+ * @version 3.0.0
+ * @date 2026-01-17
+ */
+
+#include "icmp_probe.h"
+#include <string.h>
+
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#include <esp_timer.h>
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#endif
+
+// ==========================================
+// SOCKET HELPERS
+// ==========================================
+uint64_t icmpMonotonicMicros() {
+#ifdef ARDUINO
+  return (uint64_t)esp_timer_get_time();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)(ts.tv_nsec / 1000);
+#endif
+}
+
+int icmpOpenRawSocket() {
+  int fd = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+  if (fd < 0) {
+    return -1;
+  }
+
+  int flags = fcntl(fd, F_GETFL, 0);
+  fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+  return fd;
+}
+
+void icmpCloseSocket(int fd) {
+  if (fd >= 0) {
+    close(fd);
+  }
+}
+
+bool icmpSetTtl(int fd, uint8_t ttl) {
+  int value = ttl;
+  return setsockopt(fd, IPPROTO_IP, IP_TTL, &value, sizeof(value)) == 0;
+}
+
+bool icmpSetDontFragment(int fd, bool enable) {
+#if defined(IP_MTU_DISCOVER) && defined(IP_PMTUDISC_PROBE)
+  // PROBE sets DF but ignores the cached path MTU, so every size is really sent
+  int value = enable ? IP_PMTUDISC_PROBE : IP_PMTUDISC_DONT;
+  return setsockopt(fd, IPPROTO_IP, IP_MTU_DISCOVER, &value, sizeof(value)) == 0;
+#else
+  (void)fd;
+  return !enable;
+#endif
+}
+
+bool icmpWaitReadable(int fd, uint32_t timeout_us) {
+  fd_set readSet;
+  FD_ZERO(&readSet);
+  FD_SET(fd, &readSet);
+
+  struct timeval tv;
+  tv.tv_sec = timeout_us / 1000000;
+  tv.tv_usec = timeout_us % 1000000;
+  return select(fd + 1, &readSet, nullptr, nullptr, &tv) > 0;
+}
+
+// ==========================================
+// PACKET HELPERS
+// ==========================================
+static uint16_t readBE16(const uint8_t* p) {
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+uint16_t icmpChecksum(const void* data, size_t len) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  uint32_t sum = 0;
+
+  while (len > 1) {
+    sum += readBE16(bytes);
+    bytes += 2;
+    len -= 2;
+  }
+  if (len == 1) {
+    sum += (uint16_t)(bytes[0] << 8);
+  }
+  while (sum >> 16) {
+    sum = (sum & 0xFFFF) + (sum >> 16);
+  }
+  return (uint16_t)~sum;
+}
+
+size_t icmpBuildEchoRequest(uint8_t* buffer, size_t buffer_len, uint16_t id,
+                            uint16_t sequence, size_t payload_len) {
+  size_t total = ICMP_HEADER_SIZE + payload_len;
+  if (buffer == nullptr || buffer_len < total) {
+    return 0;
+  }
+
+  buffer[0] = ICMP_TYPE_ECHO_REQUEST;
+  buffer[1] = 0;
+  buffer[2] = 0;
+  buffer[3] = 0;
+  buffer[4] = (uint8_t)(id >> 8);
+  buffer[5] = (uint8_t)id;
+  buffer[6] = (uint8_t)(sequence >> 8);
+  buffer[7] = (uint8_t)sequence;
+  for (size_t i = 0; i < payload_len; i++) {
+    buffer[ICMP_HEADER_SIZE + i] = (uint8_t)(0x20 + (i % 64));
+  }
+
+  uint16_t checksum = icmpChecksum(buffer, total);
+  buffer[2] = (uint8_t)(checksum >> 8);
+  buffer[3] = (uint8_t)checksum;
+  return total;
+}
+
+bool icmpSendEchoRequest(int fd, uint32_t destination, uint16_t id, uint16_t sequence,
+                         size_t payload_len) {
+  uint8_t packet[ICMP_MAX_MESSAGE_SIZE];
+  size_t len = icmpBuildEchoRequest(packet, sizeof(packet), id, sequence, payload_len);
+  if (len == 0) {
+    return false;
+  }
+
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = destination;
+  return sendto(fd, packet, len, 0, (struct sockaddr*)&addr, sizeof(addr)) == (int)len;
+}
+
+bool icmpParseDatagram(const uint8_t* buffer, size_t len, IcmpMessage& msg) {
+  memset(&msg, 0, sizeof(msg));
+  if (buffer == nullptr || len < ICMP_IP_HEADER_MIN + ICMP_HEADER_SIZE) {
+    return false;
+  }
+
+  // Outer IPv4 header
+  size_t ipHeaderLen = (size_t)(buffer[0] & 0x0F) * 4;
+  if ((buffer[0] >> 4) != 4 || ipHeaderLen < ICMP_IP_HEADER_MIN || len < ipHeaderLen + ICMP_HEADER_SIZE) {
+    return false;
+  }
+  if (buffer[9] != ICMP_PROTO_ICMP) {
+    return false;
+  }
+  memcpy(&msg.source, buffer + 12, sizeof(msg.source));
+  msg.ttl = buffer[8];
+
+  const uint8_t* icmp = buffer + ipHeaderLen;
+  size_t icmpLen = len - ipHeaderLen;
+  msg.type = icmp[0];
+  msg.code = icmp[1];
+
+  if (msg.type == ICMP_TYPE_ECHO_REPLY || msg.type == ICMP_TYPE_ECHO_REQUEST) {
+    msg.id = readBE16(icmp + 4);
+    msg.sequence = readBE16(icmp + 6);
+    return true;
+  }
+
+  if (msg.type != ICMP_TYPE_DEST_UNREACHABLE && msg.type != ICMP_TYPE_TIME_EXCEEDED) {
+    return true;  // Valid ICMP, nothing more to decode
+  }
+
+  if (msg.type == ICMP_TYPE_DEST_UNREACHABLE && msg.code == ICMP_CODE_FRAG_NEEDED) {
+    msg.next_hop_mtu = readBE16(icmp + 6);
+  }
+
+  // Quoted original IPv4 header plus at least 8 bytes of its payload
+  const uint8_t* quoted = icmp + ICMP_HEADER_SIZE;
+  size_t quotedLen = icmpLen - ICMP_HEADER_SIZE;
+  if (quotedLen < ICMP_IP_HEADER_MIN) {
+    return true;
+  }
+  size_t quotedHeaderLen = (size_t)(quoted[0] & 0x0F) * 4;
+  if (quotedHeaderLen < ICMP_IP_HEADER_MIN || quotedLen < quotedHeaderLen + 8) {
+    return true;
+  }
+
+  msg.has_quote = true;
+  msg.quoted_protocol = quoted[9];
+  msg.quoted_total_length = readBE16(quoted + 2);
+  memcpy(&msg.quoted_destination, quoted + 16, sizeof(msg.quoted_destination));
+
+  const uint8_t* inner = quoted + quotedHeaderLen;
+  if (msg.quoted_protocol == ICMP_PROTO_UDP || msg.quoted_protocol == ICMP_PROTO_TCP) {
+    msg.quoted_src_port = readBE16(inner);
+    msg.quoted_dst_port = readBE16(inner + 2);
+  } else if (msg.quoted_protocol == ICMP_PROTO_ICMP) {
+    msg.quoted_id = readBE16(inner + 4);
+    msg.quoted_sequence = readBE16(inner + 6);
+  }
+  return true;
+}
+
+int icmpReceive(int fd, IcmpMessage& msg) {
+  uint8_t buffer[ICMP_RECV_BUFFER_SIZE];
+  int len = recv(fd, buffer, sizeof(buffer), 0);
+  if (len <= 0) {
+    return -1;
+  }
+  return icmpParseDatagram(buffer, (size_t)len, msg) ? 1 : 0;
+}
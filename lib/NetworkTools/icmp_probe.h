@@ -0,0 +1,171 @@
+/**
+ * @file icmp_probe.h
+ * @brief Raw ICMP socket helpers shared by the network probing tools
+ *
+ * Small BSD-socket layer used by traceroute (and other tools that need to
+ * see ICMP errors) to open raw ICMP sockets, build echo requests and
+ * decode received ICMP messages including the quoted original datagram
+ * carried by Time Exceeded / Destination Unreachable errors.
+ *
+ * Builds against lwIP on the ESP32 and against the host socket API on
+ * Linux, so the probing logic can be exercised from pc_test_apps inside a
+ * network namespace. Raw sockets require root on Linux.
+ *
+ * @author Arunkumar Mourougappane
+ * @version 3.0.0
+ * @date 2026-01-17
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==========================================
+// ICMP CONSTANTS
+// ==========================================
+#define ICMP_TYPE_ECHO_REPLY 0
+#define ICMP_TYPE_DEST_UNREACHABLE 3
+#define ICMP_TYPE_ECHO_REQUEST 8
+#define ICMP_TYPE_TIME_EXCEEDED 11
+
+#define ICMP_CODE_NET_UNREACHABLE 0
+#define ICMP_CODE_HOST_UNREACHABLE 1
+#define ICMP_CODE_PROTOCOL_UNREACHABLE 2
+#define ICMP_CODE_PORT_UNREACHABLE 3
+#define ICMP_CODE_FRAG_NEEDED 4
+#define ICMP_CODE_ADMIN_PROHIBITED 13
+
+#define ICMP_HEADER_SIZE 8
+#define ICMP_IP_HEADER_MIN 20
+#define ICMP_RECV_BUFFER_SIZE 576   // Errors quote at most this much (RFC 1812)
+#define ICMP_MAX_MESSAGE_SIZE 1480  // Largest echo request on a 1500-byte MTU
+
+#define ICMP_PROTO_ICMP 1
+#define ICMP_PROTO_TCP 6
+#define ICMP_PROTO_UDP 17
+
+// ==========================================
+// DATA STRUCTURES
+// ==========================================
+
+/**
+ * @brief Decoded ICMP message
+ *
+ * For errors (Time Exceeded, Destination Unreachable) the quoted_* fields
+ * describe the original datagram that triggered it, which is how probes
+ * are matched back to their sender.
+ */
+struct IcmpMessage {
+  uint32_t source;              // Responder address (network byte order)
+  uint8_t ttl;                  // TTL of the ICMP packet as received
+  uint8_t type;
+  uint8_t code;
+  uint16_t id;                  // Echo identifier (echo reply only)
+  uint16_t sequence;            // Echo sequence (echo reply only)
+  uint16_t next_hop_mtu;        // Fragmentation needed only (RFC 1191)
+
+  bool has_quote;
+  uint8_t quoted_protocol;
+  uint16_t quoted_total_length; // Length of the original datagram
+  uint32_t quoted_destination;  // Network byte order
+  uint16_t quoted_src_port;     // UDP/TCP
+  uint16_t quoted_dst_port;     // UDP/TCP
+  uint16_t quoted_id;           // ICMP echo
+  uint16_t quoted_sequence;     // ICMP echo
+};
+
+// ==========================================
+// SOCKET HELPERS
+// ==========================================
+
+/**
+ * @brief Monotonic microsecond clock used for probe timing
+ */
+uint64_t icmpMonotonicMicros();
+
+/**
+ * @brief Open a non-blocking raw ICMP socket
+ * @return File descriptor, or -1 on failure (Linux: needs CAP_NET_RAW)
+ */
+int icmpOpenRawSocket();
+
+/**
+ * @brief Close a socket opened by these helpers (ignores -1)
+ */
+void icmpCloseSocket(int fd);
+
+/**
+ * @brief Set the unicast TTL used for subsequent sends on a socket
+ * @return true on success
+ */
+bool icmpSetTtl(int fd, uint8_t ttl);
+
+/**
+ * @brief Control the Don't Fragment bit on subsequent sends
+ *
+ * With DF set, oversized datagrams are neither fragmented locally nor by
+ * routers; the bottleneck answers with ICMP Fragmentation Needed instead.
+ * lwIP never sets DF, so enabling it fails on the ESP32.
+ *
+ * @param fd Socket descriptor
+ * @param enable true to set DF, false to allow fragmentation
+ * @return true if the stack honours the request
+ */
+bool icmpSetDontFragment(int fd, bool enable);
+
+/**
+ * @brief Wait until a socket is readable
+ * @param fd Socket descriptor
+ * @param timeout_us Maximum wait in microseconds
+ * @return true if readable before the timeout
+ */
+bool icmpWaitReadable(int fd, uint32_t timeout_us);
+
+// ==========================================
+// PACKET HELPERS
+// ==========================================
+
+/**
+ * @brief Internet checksum (RFC 1071)
+ */
+uint16_t icmpChecksum(const void* data, size_t len);
+
+/**
+ * @brief Build an ICMP echo request
+ * @param buffer Output buffer
+ * @param buffer_len Size of output buffer
+ * @param id Echo identifier
+ * @param sequence Echo sequence number
+ * @param payload_len Bytes of pattern payload after the ICMP header
+ * @return Total ICMP message length, or 0 if the buffer is too small
+ */
+size_t icmpBuildEchoRequest(uint8_t* buffer, size_t buffer_len, uint16_t id,
+                            uint16_t sequence, size_t payload_len);
+
+/**
+ * @brief Send an ICMP echo request to an address
+ * @param fd Raw ICMP socket
+ * @param destination Target address (network byte order)
+ * @return true if the datagram was queued
+ */
+bool icmpSendEchoRequest(int fd, uint32_t destination, uint16_t id, uint16_t sequence,
+                         size_t payload_len);
+
+/**
+ * @brief Decode a datagram read from a raw ICMP socket
+ * @param buffer Received bytes, starting at the IPv4 header
+ * @param len Number of bytes received
+ * @param msg Decoded message
+ * @return true if this is a well-formed ICMP message
+ */
+bool icmpParseDatagram(const uint8_t* buffer, size_t len, IcmpMessage& msg);
+
+/**
+ * @brief Read and decode one pending datagram from a raw ICMP socket
+ * @param fd Raw ICMP socket (non-blocking)
+ * @param msg Decoded message
+ * @return 1 if a valid ICMP message was read, 0 if a datagram was read but
+ *         is not valid ICMP, -1 if nothing is pending
+ */
+int icmpReceive(int fd, IcmpMessage& msg);
@@ -17,6 +17,7 @@
 
 #include "iperf_manager.h"
 #include "config.h"
+#include "dns_resolver.h"
 
 // ==========================================
 // GLOBAL VARIABLES
@@ -37,6 +38,7 @@ static unsigned long packetsTransferred = 0;
 static unsigned long packetsLost = 0;
 static float jitterSum = 0;
 static unsigned long lastPacketTime = 0;
+static int iperfDatagramSize = IPERF_BUFFER_SIZE;
 
 // ==========================================
 // INITIALIZATION AND CLEANUP
@@ -110,7 +112,16 @@ void runIperfTcpClient(const IperfConfig& config) {
   Serial.print(":");
   Serial.println(config.port);
   
-  if (!iperfClient.connect(config.serverIP.c_str(), config.port)) {
+  IPAddress serverAddress;
+  if (!dnsResolve(config.serverIP, serverAddress)) {
+    Serial.println("❌ Failed to resolve server");
+    currentIperfState = IPERF_IDLE;
+    lastResults.testCompleted = false;
+    lastResults.errorMessage = "DNS resolution failed";
+    return;
+  }
+  
+  if (!iperfClient.connect(serverAddress, config.port)) {
     Serial.println("❌ Failed to connect to server");
     currentIperfState = IPERF_IDLE;
     lastResults.testCompleted = false;
@@ -120,7 +131,7 @@ void runIperfTcpClient(const IperfConfig& config) {
   
   Serial.println("✅ Connected to server");
   
-  uint8_t buffer[IPERF_BUFFER_SIZE];
+  uint8_t buffer[IPERF_MAX_BUFFER_SIZE];
   memset(buffer, 0xAA, sizeof(buffer)); // Fill with test pattern
   
   unsigned long startTime = millis();
@@ -178,6 +189,16 @@ void runIperfUdpClient(const IperfConfig& config) {
   Serial.print(":");
   Serial.println(config.port);
   
+  // Resolve once; beginPacket(host) would look the name up for every datagram
+  IPAddress serverAddress;
+  if (!dnsResolve(config.serverIP, serverAddress)) {
+    Serial.println("❌ Failed to resolve server");
+    currentIperfState = IPERF_IDLE;
+    lastResults.testCompleted = false;
+    lastResults.errorMessage = "DNS resolution failed";
+    return;
+  }
+  
   if (!iperfUdp.begin(config.port + 1)) { // Use different port for client
     Serial.println("❌ Failed to initialize UDP");
     currentIperfState = IPERF_IDLE;
@@ -186,7 +207,7 @@ void runIperfUdpClient(const IperfConfig& config) {
     return;
   }
   
-  uint8_t buffer[IPERF_BUFFER_SIZE];
+  uint8_t buffer[IPERF_MAX_BUFFER_SIZE];
   memset(buffer, 0xBB, sizeof(buffer)); // Fill with test pattern
   
   unsigned long startTime = millis();
@@ -208,7 +229,7 @@ void runIperfUdpClient(const IperfConfig& config) {
       uint32_t seqNum = packetsTransferred;
       memcpy(buffer, &seqNum, sizeof(seqNum));
       
-      iperfUdp.beginPacket(config.serverIP.c_str(), config.port);
+      iperfUdp.beginPacket(serverAddress, config.port);
       size_t written = iperfUdp.write(buffer, config.bufferSize);
       iperfUdp.endPacket();
       
@@ -510,6 +531,11 @@ void printIperfConfig(const IperfConfig& config) {
     Serial.print(config.bandwidth / 1000000.0, 1);
     Serial.println(" Mbps");
   }
+  if (config.mode == IPERF_CLIENT) {
+    Serial.print("   Write Size: ");
+    Serial.print(config.bufferSize);
+    Serial.println(" bytes");
+  }
   Serial.println();
 }
 
@@ -535,6 +561,18 @@ String formatBytes(unsigned long bytes) {
   }
 }
 
+bool setIperfDatagramSize(int size) {
+  if (size < IPERF_MIN_BUFFER_SIZE || size > IPERF_MAX_BUFFER_SIZE) {
+    return false;
+  }
+  iperfDatagramSize = size;
+  return true;
+}
+
+int getIperfDatagramSize() {
+  return iperfDatagramSize;
+}
+
 IperfConfig getDefaultConfig() {
   IperfConfig config;
   config.protocol = IPERF_TCP;
@@ -544,7 +582,7 @@ IperfConfig getDefaultConfig() {
   config.duration = IPERF_DEFAULT_DURATION;
   config.interval = IPERF_DEFAULT_INTERVAL;
   config.bandwidth = 1000000; // 1 Mbps for UDP
-  config.bufferSize = IPERF_BUFFER_SIZE;
+  config.bufferSize = iperfDatagramSize;
   config.reverse = false;
   config.bidir = false;
   config.parallel = 1;
@@ -568,6 +606,16 @@ void executeIperfCommand(const String& command) {
   else if (cmd == "iperf stop") {
     stopIperfTest();
   }
+  else if (cmd == "iperf length" || cmd.startsWith("iperf length ")) {
+    String params = cmd.substring(12);
+    params.trim();
+
+    if (params.length() > 0 && !setIperfDatagramSize(params.toInt())) {
+      Serial.printf("❌ Length must be %d-%d bytes\n", IPERF_MIN_BUFFER_SIZE, IPERF_MAX_BUFFER_SIZE);
+      return;
+    }
+    Serial.printf("📏 iPerf client write size: %d bytes\n", getIperfDatagramSize());
+  }
   else if (cmd.startsWith("iperf server tcp")) {
     String params = cmd.substring(16);
     params.trim();
@@ -716,6 +764,7 @@ void printIperfHelp() {
   Serial.println("│ iperf help                    │ Show iPerf help                    │");
   Serial.println("│ iperf status                  │ Show current iPerf status          │");
   Serial.println("│ iperf stop                    │ Stop running test                  │");
+  Serial.println("│ iperf length [bytes]          │ Client write size (def: 1024)      │");
   Serial.println("│ iperf server tcp [port]       │ Start TCP server (def: 5201)       │");
   Serial.println("│ iperf server udp [port]       │ Start UDP server (def: 5201)       │");
   Serial.println("│ iperf client tcp <ip> [p] [d] │ TCP client test                    │");
@@ -25,6 +25,8 @@
 // ==========================================
 #define IPERF_DEFAULT_PORT 5201
 #define IPERF_BUFFER_SIZE 1024
+#define IPERF_MAX_BUFFER_SIZE 1472    // Largest UDP payload that fits a 1500-byte MTU
+#define IPERF_MIN_BUFFER_SIZE 64
 #define IPERF_DEFAULT_DURATION 10
 #define IPERF_DEFAULT_INTERVAL 1
 #define IPERF_MAX_PARALLEL_STREAMS 4
@@ -122,6 +124,8 @@ void printIperfConfig(const IperfConfig& config);
 String formatThroughput(float mbps);
 String formatBytes(unsigned long bytes);
 IperfConfig getDefaultConfig();
+bool setIperfDatagramSize(int size);   // Client write size, e.g. from 'pmtu apply'
+int getIperfDatagramSize();
 
 // Command interface functions
 void executeIperfCommand(const String& command);
@@ -5,7 +5,8 @@
  * This file implements comprehensive latency testing:
  * - UDP echo latency measurement
  * - TCP connection time testing
- * - HTTP request latency analysis
+ * - HTTP request latency analysis (raw GET, time to status line)
+ * - TWAMP-Light session-sender and reflector (RFC 5357)
  * - Statistical analysis (min, max, average, jitter)
  * - Real-time monitoring with configurable intervals
  * - Packet loss detection
@@ -17,13 +18,15 @@
 
 #include "latency_analyzer.h"
 #include "config.h"
+#include "dns_resolver.h"
 #ifdef USE_NEOPIXEL
 #include "led_controller.h"
 #endif
-#include <HTTPClient.h>
 #include <WiFiUdp.h>
 #include <AsyncUDP.h>
 #include <WiFi.h>
+#include <sys/time.h>
+#include <time.h>
 
 // ==========================================
 // GLOBAL VARIABLES
@@ -38,6 +41,7 @@ static AsyncUDP asyncUdp;
 static unsigned long testStartTime = 0;
 static unsigned long lastPingTime = 0;
 static uint16_t currentSequence = 0;
+static IPAddress latencyTargetIP;      // Resolved once per test, see startLatencyTest()
 static float latencyBuffer[JITTER_BUFFER_SIZE];
 static uint8_t bufferIndex = 0;
 static bool bufferFull = false;
@@ -45,6 +49,34 @@ static bool bufferFull = false;
 // Running statistics
 JitterStats runningStats;
 
+// TWAMP-Light state. Replies are decoded in the AsyncUDP task and handed to
+// the main loop through a queue so T4 is stamped at reception, not at the
+// next loop() iteration.
+struct TwampReply {
+  uint32_t sequence;
+  int32_t rtt_us;
+  uint32_t residence_us;
+  uint8_t sender_ttl;
+};
+
+static QueueHandle_t twampReplyQueue = nullptr;
+static AsyncUDP twampReflectorUdp;
+static TwampReflectorStats twampReflectorStats;
+static bool twampReflectorRunning = false;
+
+// Wall clock in NTP format. Only differences on one clock are used for RTT,
+// so an unsynchronised clock still gives correct results.
+static TwampTimestamp twampNow() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  return twampTimestampFromMicros((uint64_t)tv.tv_sec * 1000000ULL + (uint64_t)tv.tv_usec);
+}
+
+static uint16_t twampErrorEstimate() {
+  // Treat the clock as synchronised once SNTP/RTC has set a plausible date
+  return time(nullptr) > 1700000000 ? TWAMP_ERROR_ESTIMATE_SYNCED : TWAMP_ERROR_ESTIMATE_UNSYNCED;
+}
+
 // ==========================================
 // INITIALIZATION AND CLEANUP
 // ==========================================
@@ -58,6 +90,10 @@ void initializeLatencyAnalysis() {
   bufferIndex = 0;
   bufferFull = false;
   
+  if (twampReplyQueue == nullptr) {
+    twampReplyQueue = xQueueCreate(TWAMP_REPLY_QUEUE_LENGTH, sizeof(TwampReply));
+  }
+  
   Serial.println("🔧 Latency Analysis system initialized");
 }
 
@@ -97,6 +133,19 @@ bool startLatencyTest(const LatencyConfig& config) {
     return false;
   }
   
+  // Resolve once up front so name lookups are not timed as part of each probe
+  DnsResolveInfo dnsInfo;
+  if (!dnsResolve(config.target_host, latencyTargetIP, &dnsInfo)) {
+    Serial.printf("❌ Failed to resolve %s (%s)\n", config.target_host.c_str(),
+                  dnsQueryStatusToString(dnsInfo.status));
+    return false;
+  }
+  if (dnsInfo.source != DNS_SOURCE_LITERAL) {
+    Serial.printf("🔎 %s -> %s (%s, %.1f ms)\n", config.target_host.c_str(),
+                  latencyTargetIP.toString().c_str(),
+                  dnsInfo.source == DNS_SOURCE_CACHE ? "cached" : "resolved", dnsInfo.elapsed_us / 1000.0);
+  }
+  
   // Ensure clean state - stop any existing UDP connections
   Serial.println("Debug: Stopping existing UDP connections...");
   latencyUdp.stop();
@@ -143,6 +192,9 @@ bool startLatencyTest(const LatencyConfig& config) {
     case LATENCY_HTTP_REQUEST:
       result = executeHttpLatencyTest(config);
       break;
+    case LATENCY_TWAMP_LIGHT:
+      result = executeTwampLightTest(config);
+      break;
     default:
       Serial.println("❌ Unsupported test type");
       currentLatencyState = LATENCY_IDLE;
@@ -189,6 +241,40 @@ bool executeHttpLatencyTest(const LatencyConfig& config) {
   return true;
 }
 
+bool executeTwampLightTest(const LatencyConfig& config) {
+  Serial.printf("🔍 Starting TWAMP-Light test to %s:%d\n", config.target_host.c_str(), config.target_port);
+  
+  if (twampReplyQueue == nullptr) {
+    Serial.println("❌ TWAMP reply queue not initialized");
+    return false;
+  }
+  xQueueReset(twampReplyQueue);
+  
+  asyncUdp.close();
+  if (!asyncUdp.connect(latencyTargetIP, config.target_port)) {
+    Serial.println("❌ Failed to open TWAMP-Light session socket");
+    return false;
+  }
+  
+  asyncUdp.onPacket([](AsyncUDPPacket& packet) {
+    TwampTimestamp arrival = twampNow();
+    TwampReflectorPacket reflected;
+    if (!twampDecodeReflectorPacket(packet.data(), packet.length(), reflected)) {
+      return;
+    }
+    
+    TwampReply reply;
+    reply.sequence = reflected.sender_sequence;
+    reply.rtt_us = (int32_t)twampRoundTripMicros(reflected, arrival);
+    reply.residence_us = (uint32_t)twampTimestampDiffMicros(reflected.timestamp, reflected.receive_timestamp);
+    reply.sender_ttl = reflected.sender_ttl;
+    xQueueSend(twampReplyQueue, &reply, 0);
+  });
+  
+  Serial.println("✅ TWAMP-Light test initialized");
+  return true;
+}
+
 void stopLatencyTest() {
   if (currentLatencyState == LATENCY_RUNNING) {
     currentLatencyState = LATENCY_COMPLETED;
@@ -199,6 +285,15 @@ void stopLatencyTest() {
     // Calculate final statistics
     lastLatencyResults.statistics = calculateJitterStats(lastLatencyResults.results, lastLatencyResults.results_count);
     
+    // Datagram tests only store replies, so take sent/lost from the live counters
+    JitterStats& finalStats = lastLatencyResults.statistics;
+    if (runningStats.packets_sent > 0) {
+      finalStats.packets_sent = runningStats.packets_sent;
+      finalStats.packets_received = runningStats.packets_received;
+      finalStats.packets_lost = runningStats.packets_sent - min(runningStats.packets_received, runningStats.packets_sent);
+      finalStats.packet_loss_percent = (float)finalStats.packets_lost / finalStats.packets_sent * 100.0;
+    }
+    
     Serial.println("⏹️ Latency test stopped");
     printLatencyResults(lastLatencyResults);
     
@@ -227,10 +322,15 @@ void handleLatencyTasks() {
   
   unsigned long currentTime = millis();
   
-  // Check for test completion
+  // Check for test completion, allowing one timeout window for the last replies
   if (!activeLatencyConfig.continuous_mode && 
       runningStats.packets_sent >= activeLatencyConfig.packet_count) {
-    stopLatencyTest();
+    bool repliesOutstanding = runningStats.packets_received + runningStats.packets_lost < runningStats.packets_sent;
+    if (!repliesOutstanding || currentTime - lastPingTime >= activeLatencyConfig.timeout_ms) {
+      stopLatencyTest();
+      return;
+    }
+    processLatencyResponses();
     return;
   }
   
@@ -264,6 +364,11 @@ void sendLatencyProbe() {
     case LATENCY_HTTP_REQUEST:
       sendHttpLatencyProbe(sendTime);
       break;
+    case LATENCY_TWAMP_LIGHT:
+      sendTwampLightProbe(sendTime);
+      break;
+    default:
+      break;
   }
   
   runningStats.packets_sent++;
@@ -271,22 +376,25 @@ void sendLatencyProbe() {
 }
 
 void sendUdpEchoProbe(unsigned long sendTime) {
-  // Create UDP ping packet
-  char packet[64];
-  snprintf(packet, sizeof(packet), "PING %lu %d", sendTime, currentSequence);
-  
-  latencyUdp.beginPacket(activeLatencyConfig.target_host.c_str(), activeLatencyConfig.target_port);
-  latencyUdp.write((uint8_t*)packet, strlen(packet));
+  // Create UDP ping packet, zero-padded to the configured size (echoed back verbatim)
+  static uint8_t packet[TWAMP_MAX_PACKET_SIZE];
+  int headerLen = snprintf((char*)packet, sizeof(packet), "PING %lu %d", sendTime, currentSequence);
+  size_t packetSize = constrain((size_t)activeLatencyConfig.packet_size, (size_t)headerLen + 1,
+                                (size_t)TWAMP_MAX_PACKET_SIZE);
+  memset(packet + headerLen, 0, packetSize - headerLen);
+  
+  latencyUdp.beginPacket(latencyTargetIP, activeLatencyConfig.target_port);
+  latencyUdp.write(packet, packetSize);
   latencyUdp.endPacket();
   
-  Serial.printf("📤 UDP ping sent: seq=%d\n", currentSequence);
+  Serial.printf("📤 UDP ping sent: seq=%d, %u bytes\n", currentSequence, (unsigned)packetSize);
 }
 
 void sendTcpConnectProbe(unsigned long sendTime) {
   WiFiClient tcpClient;
   unsigned long startConnect = micros();
   
-  bool connected = tcpClient.connect(activeLatencyConfig.target_host.c_str(), 
+  bool connected = tcpClient.connect(latencyTargetIP, 
                                    activeLatencyConfig.target_port, 
                                    activeLatencyConfig.timeout_ms);
   
@@ -320,19 +428,41 @@ void sendTcpConnectProbe(unsigned long sendTime) {
 }
 
 void sendHttpLatencyProbe(unsigned long sendTime) {
-  HTTPClient http;
+  // Plain HTTP/1.1 GET to the pre-resolved address, timed from connect to
+  // the status line. HTTPClient would look the host up again on every request.
+  WiFiClient client;
+  int httpCode = -1;
   unsigned long startRequest = micros();
+  unsigned long endRequest = 0;
   
-  String url = "http://" + activeLatencyConfig.target_host;
-  if (activeLatencyConfig.target_port != 80) {
-    url += ":" + String(activeLatencyConfig.target_port);
+  if (client.connect(latencyTargetIP, activeLatencyConfig.target_port, activeLatencyConfig.timeout_ms)) {
+    String host = activeLatencyConfig.target_host;
+    if (activeLatencyConfig.target_port != 80) {
+      host += ":" + String(activeLatencyConfig.target_port);
+    }
+    client.print("GET / HTTP/1.1\r\nHost: " + host +
+                 "\r\nUser-Agent: ESP32-WiFi-Utility\r\nConnection: close\r\n\r\n");
+    
+    unsigned long deadline = millis() + activeLatencyConfig.timeout_ms;
+    while (!client.available() && client.connected() && (long)(deadline - millis()) > 0) {
+      delay(1);
+    }
+    endRequest = micros();
+    
+    if (client.available()) {
+      char statusLine[48];
+      size_t len = client.readBytesUntil('\n', statusLine, sizeof(statusLine) - 1);
+      statusLine[len] = '\0';
+      int code;
+      if (sscanf(statusLine, "HTTP/%*d.%*d %d", &code) == 1) {
+        httpCode = code;
+      }
+    }
+    client.stop();
+  }
+  if (endRequest == 0) {
+    endRequest = micros();
   }
-  
-  http.begin(url);
-  http.setTimeout(activeLatencyConfig.timeout_ms);
-  
-  int httpCode = http.GET();
-  unsigned long endRequest = micros();
   float latency = (endRequest - startRequest) / 1000.0;  // Convert to ms
   
   PingResult result;
@@ -348,8 +478,6 @@ void sendHttpLatencyProbe(unsigned long sendTime) {
     runningStats.packets_received++;
   }
   
-  http.end();
-  
   // Store result
   if (lastLatencyResults.results_count < PING_MAX_COUNT) {
     lastLatencyResults.results[lastLatencyResults.results_count] = result;
@@ -362,7 +490,50 @@ void sendHttpLatencyProbe(unsigned long sendTime) {
                 currentSequence, latency, httpCode);
 }
 
+void sendTwampLightProbe(unsigned long sendTime) {
+  static uint8_t packet[TWAMP_MAX_PACKET_SIZE];
+  
+  TwampSenderPacket probe;
+  probe.sequence = currentSequence;
+  probe.error_estimate = twampErrorEstimate();
+  probe.timestamp = twampNow();
+  
+  size_t packetSize = min((size_t)activeLatencyConfig.packet_size, (size_t)TWAMP_MAX_PACKET_SIZE);
+  size_t len = twampEncodeSenderPacket(packet, sizeof(packet), packetSize, probe);
+  asyncUdp.write(packet, len);
+  
+  Serial.printf("📤 TWAMP test packet sent: seq=%d, %u bytes\n", currentSequence, (unsigned)len);
+}
+
 void processLatencyResponses() {
+  if (activeLatencyConfig.test_type == LATENCY_TWAMP_LIGHT && twampReplyQueue != nullptr) {
+    TwampReply reply;
+    while (xQueueReceive(twampReplyQueue, &reply, 0) == pdTRUE) {
+      if (reply.sequence >= currentSequence || reply.rtt_us < 0) {
+        continue;  // Not one of ours, or reflector clock stepped mid-packet
+      }
+      
+      PingResult result;
+      result.success = true;
+      result.latency_ms = reply.rtt_us / 1000.0;
+      result.timestamp = millis();
+      result.sequence = reply.sequence;
+      
+      if (lastLatencyResults.results_count < PING_MAX_COUNT) {
+        lastLatencyResults.results[lastLatencyResults.results_count] = result;
+        lastLatencyResults.results_count++;
+      }
+      
+      updateRunningStats(result);
+      runningStats.packets_received++;
+      
+      Serial.printf("📥 TWAMP reply: seq=%u, rtt=%.2fms, reflector=%uus, ttl=%u\n",
+                    reply.sequence, result.latency_ms, reply.residence_us, reply.sender_ttl);
+    }
+    return;
+  }
+  
+
   // For UDP echo test, check for incoming responses
   if (activeLatencyConfig.test_type == LATENCY_UDP_ECHO) {
     int packetSize = latencyUdp.parsePacket();
@@ -522,6 +693,14 @@ LatencyConfig getDefaultLatencyConfig(LatencyTestType test_type) {
       config.target_host = "www.google.com";
       config.target_port = 80;
       break;
+    case LATENCY_TWAMP_LIGHT:
+      // No public TWAMP reflectors; the first hop is usually the carrier CPE
+      config.target_host = WiFi.gatewayIP().toString();
+      config.target_port = TWAMP_LIGHT_DEFAULT_PORT;
+      config.packet_size = TWAMP_REFLECTOR_PACKET_SIZE;  // Symmetric size for RFC 6038 reflectors
+      break;
+    default:
+      break;
   }
   
   return config;
@@ -602,6 +781,7 @@ String latencyTestTypeToString(LatencyTestType type) {
     case LATENCY_UDP_ECHO: return "UDP Echo";
     case LATENCY_TCP_CONNECT: return "TCP Connect";
     case LATENCY_HTTP_REQUEST: return "HTTP Request";
+    case LATENCY_TWAMP_LIGHT: return "TWAMP-Light";
     default: return "Unknown";
   }
 }
@@ -664,6 +844,69 @@ JitterStats executeNetworkAnalysis(const String& target_host) {
   return runningStats;
 }
 
+// ==========================================
+// TWAMP-LIGHT REFLECTOR
+// ==========================================
+bool startTwampReflector(uint16_t port) {
+  if (twampReflectorRunning) {
+    stopTwampReflector();
+  }
+  
+  if (!twampReflectorUdp.listen(port)) {
+    Serial.printf("❌ TWAMP reflector failed to listen on UDP port %u\n", port);
+    return false;
+  }
+  
+  memset(&twampReflectorStats, 0, sizeof(twampReflectorStats));
+  twampReflectorStats.port = port;
+  
+  twampReflectorUdp.onPacket([](AsyncUDPPacket& packet) {
+    TwampTimestamp receiveTime = twampNow();
+    
+    // Callbacks are serialised on the AsyncUDP task, so one static buffer is safe
+    static uint8_t reply[TWAMP_MAX_PACKET_SIZE];
+    size_t len = twampBuildReflectorReply(packet.data(), packet.length(), receiveTime,
+                                          twampReflectorStats.packets_reflected, twampErrorEstimate(),
+                                          TWAMP_UNKNOWN_TTL, reply, sizeof(reply));
+    if (len == 0) {
+      twampReflectorStats.packets_rejected++;
+      return;
+    }
+    
+    TwampTimestamp transmitTime = twampNow();
+    twampStampReflectorTransmit(reply, transmitTime);
+    packet.write(reply, len);
+    
+    uint32_t residence = (uint32_t)twampTimestampDiffMicros(transmitTime, receiveTime);
+    twampReflectorStats.last_residence_us = residence;
+    if (residence > twampReflectorStats.max_residence_us) {
+      twampReflectorStats.max_residence_us = residence;
+    }
+    twampReflectorStats.packets_reflected++;
+  });
+  
+  twampReflectorRunning = true;
+  Serial.printf("✅ TWAMP-Light reflector listening on UDP port %u\n", port);
+  return true;
+}
+
+void stopTwampReflector() {
+  if (!twampReflectorRunning) return;
+  
+  twampReflectorUdp.close();
+  twampReflectorRunning = false;
+  Serial.printf("⏹️ TWAMP-Light reflector stopped (%u packets reflected)\n",
+                twampReflectorStats.packets_reflected);
+}
+
+bool isTwampReflectorRunning() {
+  return twampReflectorRunning;
+}
+
+TwampReflectorStats getTwampReflectorStats() {
+  return twampReflectorStats;
+}
+
 // ==========================================
 // GETTER FUNCTIONS FOR EXTERNAL ACCESS
 // ==========================================
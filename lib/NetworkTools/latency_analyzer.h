@@ -4,7 +4,9 @@
  * 
  * This header defines structures and functions for comprehensive network
  * latency testing and jitter analysis. Supports multiple test methods:
- * ICMP ping, UDP echo, TCP connection timing, and HTTP request latency.
+ * ICMP ping, UDP echo, TCP connection timing, HTTP request latency and
+ * TWAMP-Light (RFC 5357) session-sender. Also hosts a TWAMP-Light reflector
+ * so a central measurement server can probe the ESP32.
  * Provides statistical analysis including min, max, average, and jitter.
  * 
  * @author Arunkumar Mourougappane
@@ -18,6 +20,7 @@
 #include <WiFi.h>
 #include <WiFiUdp.h>
 #include <AsyncUDP.h>
+#include "twamp_protocol.h"
 
 // ==========================================
 // JITTER & LATENCY ANALYSIS CONFIGURATION
@@ -28,6 +31,7 @@
 #define PING_MAX_COUNT 100
 #define JITTER_BUFFER_SIZE 50
 #define LATENCY_STATS_WINDOW 100
+#define TWAMP_REPLY_QUEUE_LENGTH 16
 
 // ==========================================
 // TEST TYPES AND STATES
@@ -36,7 +40,8 @@ enum LatencyTestType {
   LATENCY_ICMP_PING = 0,     // ICMP ping test (if supported)
   LATENCY_UDP_ECHO = 1,      // UDP echo test
   LATENCY_TCP_CONNECT = 2,   // TCP connection time test
-  LATENCY_HTTP_REQUEST = 3   // HTTP request latency test
+  LATENCY_HTTP_REQUEST = 3,  // HTTP request latency test
+  LATENCY_TWAMP_LIGHT = 4    // TWAMP-Light (RFC 5357) session-sender
 };
 
 enum LatencyTestState {
@@ -90,6 +95,14 @@ struct LatencyTestResults {
   String error_message;
 };
 
+struct TwampReflectorStats {
+  uint16_t port;
+  uint32_t packets_reflected;
+  uint32_t packets_rejected;      // Datagrams too short to be TWAMP test packets
+  uint32_t last_residence_us;     // T3 - T2 of the most recent reflection
+  uint32_t max_residence_us;
+};
+
 // ==========================================
 // GLOBAL VARIABLES
 // ==========================================
@@ -153,6 +166,12 @@ void sendTcpConnectProbe(unsigned long sendTime);
  */
 void sendHttpLatencyProbe(unsigned long sendTime);
 
+/**
+ * @brief Send TWAMP-Light session-sender test packet
+ * @param sendTime Timestamp when packet was sent
+ */
+void sendTwampLightProbe(unsigned long sendTime);
+
 /**
  * @brief Process incoming latency test responses
  */
@@ -189,6 +208,13 @@ bool executeTcpConnectTest(const LatencyConfig& config);
  */
 bool executeHttpLatencyTest(const LatencyConfig& config);
 
+/**
+ * @brief Execute TWAMP-Light session-sender test
+ * @param config Test configuration (target must run a TWAMP-Light reflector)
+ * @return true if test execution started successfully
+ */
+bool executeTwampLightTest(const LatencyConfig& config);
+
 /**
  * @brief Execute comprehensive network analysis
  * @param target_host Target host for analysis
@@ -295,6 +321,38 @@ String* detectNetworkIssues(const LatencyTestResults& results);
  */
 String generateOptimizationRecommendations(const JitterStats& stats);
 
+// ==========================================
+// TWAMP-LIGHT REFLECTOR
+// ==========================================
+
+/**
+ * @brief Start answering TWAMP-Light test packets
+ *
+ * Runs from the AsyncUDP receive callback, independently of latency tests,
+ * and works in both station and AP mode.
+ *
+ * @param port UDP port to listen on
+ * @return true if the reflector is listening
+ */
+bool startTwampReflector(uint16_t port = TWAMP_LIGHT_DEFAULT_PORT);
+
+/**
+ * @brief Stop the TWAMP-Light reflector
+ */
+void stopTwampReflector();
+
+/**
+ * @brief Check whether the TWAMP-Light reflector is listening
+ * @return true if running
+ */
+bool isTwampReflectorRunning();
+
+/**
+ * @brief Get TWAMP-Light reflector counters
+ * @return Snapshot of reflector statistics
+ */
+TwampReflectorStats getTwampReflectorStats();
+
 // ==========================================
 // GETTER FUNCTIONS FOR EXTERNAL ACCESS
 // ==========================================
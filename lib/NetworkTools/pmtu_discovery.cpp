@@ -0,0 +1,659 @@
+/**
+ * @file pmtu_discovery.cpp
+ * @brief Path MTU discovery and fragmentation-cost implementation
+ *
+ * This file implements:
+ * - DF-set binary search with ICMP echo or UDP probes
+ * - Fragmentation Needed handling (next-hop MTU short-cut, black holes)
+ * - Latency, loss and goodput at and just above the discovered MTU
+ * - Background FreeRTOS task, serial report and JSON export on the ESP32
+ *
+ * @author Arunkumar Mourougappane
+ * @version 3.0.0
+ * @date 2026-01-17
+ */
+
+#include "pmtu_discovery.h"
+#include <string.h>
+#include <errno.h>
+
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#include <WiFi.h>
+#include "logging.h"
+#include "dns_resolver.h"
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+// ==========================================
+// PROBE BOOKKEEPING
+// ==========================================
+enum ProbeOutcome {
+  PROBE_NONE = 0,           // Nothing relevant arrived
+  PROBE_DELIVERED = 1,      // Echo reply, UDP echo or Port Unreachable from the target
+  PROBE_TOO_BIG = 2,        // Fragmentation Needed from a router on the path
+  PROBE_LOCAL_TOO_BIG = 3,  // Our own interface MTU refused the datagram
+  PROBE_LOST = 4,           // No answer within the timeout
+  PROBE_ERROR = 5           // Socket error
+};
+
+struct ProbeReply {
+  ProbeOutcome outcome;
+  uint16_t sequence;
+  uint16_t next_hop_mtu;
+  uint32_t from;
+};
+
+static bool isCancelled(const PmtuSession& session) {
+  return session.cancel != nullptr && *session.cancel;
+}
+
+static uint16_t payloadSize(uint16_t ipSize) {
+  return ipSize - PMTU_IP_UDP_OVERHEAD;
+}
+
+static bool inWindow(uint16_t sequence, uint16_t first, uint16_t count) {
+  return (uint16_t)(sequence - first) < count;
+}
+
+static int probeSendFd(const PmtuSession& session) {
+  return session.config.probe_type == PMTU_PROBE_UDP ? session.udp_fd : session.icmp_fd;
+}
+
+// ==========================================
+// CONFIGURATION AND SETUP
+// ==========================================
+PmtuConfig getDefaultPmtuConfig(PmtuProbeType type) {
+  PmtuConfig config;
+  config.probe_type = type;
+  config.udp_port = PMTU_DEFAULT_UDP_PORT;
+  config.min_mtu = PMTU_MIN_MTU;
+  config.max_mtu = PMTU_MAX_MTU;
+  config.retries = PMTU_DEFAULT_RETRIES;
+  config.timeout_ms = PMTU_DEFAULT_TIMEOUT_MS;
+  config.measure_count = PMTU_DEFAULT_MEASURE_COUNT;
+  config.burst_count = PMTU_DEFAULT_BURST_COUNT;
+  return config;
+}
+
+bool pmtuBegin(PmtuSession& session, uint32_t target, const PmtuConfig& config) {
+  memset(&session, 0, sizeof(session));
+  session.udp_fd = -1;
+  session.config = config;
+  session.target = target;
+
+  PmtuConfig& c = session.config;
+  if (c.max_mtu == 0 || c.max_mtu > PMTU_MAX_MTU) c.max_mtu = PMTU_MAX_MTU;
+  if (c.min_mtu < PMTU_IP_UDP_OVERHEAD + 4 || c.min_mtu > c.max_mtu) c.min_mtu = PMTU_MIN_MTU;
+  if (c.retries == 0) c.retries = 1;
+  if (c.timeout_ms == 0) c.timeout_ms = PMTU_DEFAULT_TIMEOUT_MS;
+  if (c.burst_count > PMTU_MAX_BURST_COUNT) c.burst_count = PMTU_MAX_BURST_COUNT;
+  if (c.udp_port == 0) c.udp_port = PMTU_DEFAULT_UDP_PORT;
+
+  // Fragmentation Needed arrives on the raw socket for both probe types
+  session.icmp_fd = icmpOpenRawSocket();
+  if (session.icmp_fd < 0) {
+    return false;
+  }
+
+  if (c.probe_type == PMTU_PROBE_UDP) {
+    session.udp_fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (session.udp_fd < 0) {
+      pmtuEnd(session);
+      return false;
+    }
+
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    socklen_t localLen = sizeof(local);
+    if (bind(session.udp_fd, (struct sockaddr*)&local, sizeof(local)) < 0 ||
+        getsockname(session.udp_fd, (struct sockaddr*)&local, &localLen) < 0) {
+      pmtuEnd(session);
+      return false;
+    }
+    session.ident = ntohs(local.sin_port);
+
+    int flags = fcntl(session.udp_fd, F_GETFL, 0);
+    fcntl(session.udp_fd, F_SETFL, flags | O_NONBLOCK);
+  } else {
+    session.ident = (uint16_t)((icmpMonotonicMicros() >> 4) | 1);
+  }
+
+  return true;
+}
+
+void pmtuEnd(PmtuSession& session) {
+  icmpCloseSocket(session.icmp_fd);
+  session.icmp_fd = -1;
+  icmpCloseSocket(session.udp_fd);
+  session.udp_fd = -1;
+}
+
+// ==========================================
+// PROBING
+// ==========================================
+static ProbeOutcome sendProbe(PmtuSession& session, uint16_t ipSize, uint16_t sequence) {
+  uint16_t payload = payloadSize(ipSize);
+  bool sent;
+
+  if (session.config.probe_type == PMTU_PROBE_ICMP) {
+    sent = icmpSendEchoRequest(session.icmp_fd, session.target, session.ident, sequence, payload);
+  } else {
+    uint8_t buffer[PMTU_MAX_MTU - PMTU_IP_UDP_OVERHEAD];
+    // Marker byte first so echo responders never mistake a probe for "PING"
+    memset(buffer, 0x5A, payload);
+    buffer[0] = 0xA5;
+    buffer[1] = (uint8_t)(sequence >> 8);
+    buffer[2] = (uint8_t)sequence;
+
+    struct sockaddr_in dest;
+    memset(&dest, 0, sizeof(dest));
+    dest.sin_family = AF_INET;
+    dest.sin_addr.s_addr = session.target;
+    dest.sin_port = htons(session.config.udp_port);
+    sent = sendto(session.udp_fd, buffer, payload, 0, (struct sockaddr*)&dest, sizeof(dest)) == (int)payload;
+  }
+
+  if (sent) return PROBE_NONE;
+  return errno == EMSGSIZE ? PROBE_LOCAL_TOO_BIG : PROBE_ERROR;
+}
+
+/**
+ * @brief Wait for either probe socket to become readable
+ */
+static bool waitForSockets(const PmtuSession& session, uint32_t timeout_us) {
+  fd_set readSet;
+  FD_ZERO(&readSet);
+  FD_SET(session.icmp_fd, &readSet);
+  int maxFd = session.icmp_fd;
+  if (session.udp_fd >= 0) {
+    FD_SET(session.udp_fd, &readSet);
+    if (session.udp_fd > maxFd) maxFd = session.udp_fd;
+  }
+
+  struct timeval tv;
+  tv.tv_sec = timeout_us / 1000000;
+  tv.tv_usec = timeout_us % 1000000;
+  return select(maxFd + 1, &readSet, nullptr, nullptr, &tv) > 0;
+}
+
+/**
+ * @brief Read one pending datagram and classify it against a window of probes
+ * @return false if nothing is pending on either socket
+ */
+static bool readReply(PmtuSession& session, uint16_t ipSize, uint16_t first, uint16_t count,
+                      ProbeReply& reply) {
+  reply.outcome = PROBE_NONE;
+
+  // UDP echo of our own payload
+  if (session.udp_fd >= 0) {
+    uint8_t buffer[PMTU_MAX_MTU];
+    struct sockaddr_in from;
+    socklen_t fromLen = sizeof(from);
+    int len = recvfrom(session.udp_fd, buffer, sizeof(buffer), 0, (struct sockaddr*)&from, &fromLen);
+    if (len > 0) {
+      uint16_t sequence = (uint16_t)((buffer[1] << 8) | buffer[2]);
+      if (from.sin_addr.s_addr == session.target && len == payloadSize(ipSize) && buffer[0] == 0xA5 &&
+          inWindow(sequence, first, count)) {
+        reply.outcome = PROBE_DELIVERED;
+        reply.sequence = sequence;
+        reply.from = session.target;
+      }
+      return true;
+    }
+  }
+
+  IcmpMessage msg;
+  int rc = icmpReceive(session.icmp_fd, msg);
+  if (rc < 0) return false;
+  if (rc == 0) return true;
+
+  bool tooBig = msg.type == ICMP_TYPE_DEST_UNREACHABLE && msg.code == ICMP_CODE_FRAG_NEEDED;
+
+  if (session.config.probe_type == PMTU_PROBE_ICMP) {
+    if (msg.type == ICMP_TYPE_ECHO_REPLY) {
+      if (msg.id == session.ident && msg.source == session.target && inWindow(msg.sequence, first, count)) {
+        reply.outcome = PROBE_DELIVERED;
+        reply.sequence = msg.sequence;
+        reply.from = msg.source;
+      }
+      return true;
+    }
+    if (!tooBig || !msg.has_quote || msg.quoted_protocol != ICMP_PROTO_ICMP ||
+        msg.quoted_id != session.ident || msg.quoted_destination != session.target ||
+        !inWindow(msg.quoted_sequence, first, count)) {
+      return true;
+    }
+    reply.sequence = msg.quoted_sequence;
+  } else {
+    // The quote carries no sequence; the probe size identifies it
+    if (!msg.has_quote || msg.quoted_protocol != ICMP_PROTO_UDP ||
+        msg.quoted_src_port != session.ident || msg.quoted_dst_port != session.config.udp_port ||
+        msg.quoted_destination != session.target || msg.quoted_total_length != ipSize) {
+      return true;
+    }
+    if (msg.type == ICMP_TYPE_DEST_UNREACHABLE && msg.code == ICMP_CODE_PORT_UNREACHABLE &&
+        msg.source == session.target) {
+      reply.outcome = PROBE_DELIVERED;
+      reply.sequence = first;
+      reply.from = msg.source;
+      return true;
+    }
+    if (!tooBig) return true;
+    reply.sequence = first;
+  }
+
+  reply.outcome = PROBE_TOO_BIG;
+  reply.next_hop_mtu = msg.next_hop_mtu;
+  reply.from = msg.source;
+  return true;
+}
+
+/**
+ * @brief Send one probe and wait for its answer
+ * @param rtt_us Round-trip time when delivered
+ */
+static ProbeReply probeOnce(PmtuSession& session, uint16_t ipSize, uint32_t& rtt_us) {
+  ProbeReply reply;
+  memset(&reply, 0, sizeof(reply));
+
+  uint16_t sequence = session.next_sequence++;
+  uint64_t sentAt = icmpMonotonicMicros();
+  reply.outcome = sendProbe(session, ipSize, sequence);
+  if (reply.outcome != PROBE_NONE) return reply;
+
+  uint64_t deadline = sentAt + (uint64_t)session.config.timeout_ms * 1000ULL;
+  while (!isCancelled(session)) {
+    uint64_t now = icmpMonotonicMicros();
+    if (now >= deadline) break;
+    if (!waitForSockets(session, (uint32_t)(deadline - now))) continue;
+
+    while (readReply(session, ipSize, sequence, 1, reply)) {
+      if (reply.outcome != PROBE_NONE) {
+        rtt_us = (uint32_t)(icmpMonotonicMicros() - sentAt);
+        return reply;
+      }
+    }
+  }
+
+  reply.outcome = PROBE_LOST;
+  return reply;
+}
+
+/**
+ * @brief Probe one size, retrying losses
+ */
+static ProbeReply probeSize(PmtuSession& session, PmtuResults& results, uint16_t ipSize) {
+  ProbeReply reply;
+  memset(&reply, 0, sizeof(reply));
+  reply.outcome = PROBE_LOST;
+  results.search_steps++;
+
+  for (uint8_t attempt = 0; attempt < session.config.retries && !isCancelled(session); attempt++) {
+    uint32_t rtt_us = 0;
+    results.probes_sent++;
+    reply = probeOnce(session, ipSize, rtt_us);
+    if (reply.outcome != PROBE_LOST) break;
+  }
+  return reply;
+}
+
+// ==========================================
+// DISCOVERY
+// ==========================================
+bool pmtuDiscover(PmtuSession& session, PmtuResults& results) {
+  const PmtuConfig& c = session.config;
+
+  memset(&results, 0, sizeof(results));
+  results.target = session.target;
+  results.probe_type = c.probe_type;
+  results.df_supported = icmpSetDontFragment(probeSendFd(session), true);
+
+  ProbeReply reply = probeSize(session, results, c.min_mtu);
+  if (reply.outcome != PROBE_DELIVERED) {
+    return false;
+  }
+  results.target_reachable = true;
+
+  uint16_t low = c.min_mtu;     // Known to get through
+  uint16_t high = c.max_mtu;    // Upper bound still possible
+  uint16_t next = c.max_mtu;    // Most paths carry the full MTU: try it first
+  bool lostAbove = false;
+
+  while (low < high) {
+    if (isCancelled(session)) return false;
+
+    reply = probeSize(session, results, next);
+    switch (reply.outcome) {
+      case PROBE_DELIVERED:
+        low = next;
+        break;
+      case PROBE_TOO_BIG:
+        if (results.reported_mtu == 0 || reply.next_hop_mtu < results.reported_mtu) {
+          results.reported_mtu = reply.next_hop_mtu;
+          results.frag_needed_from = reply.from;
+        }
+        high = next - 1;
+        // RFC 1191 routers tell us the answer; verify it next
+        if (reply.next_hop_mtu > low && reply.next_hop_mtu < next) {
+          high = reply.next_hop_mtu;
+          next = reply.next_hop_mtu;
+          continue;
+        }
+        break;
+      case PROBE_LOCAL_TOO_BIG:
+        high = next - 1;
+        break;
+      case PROBE_LOST:
+        lostAbove = true;
+        high = next - 1;
+        break;
+      default:
+        return false;
+    }
+    next = low + (high - low + 1) / 2;
+  }
+
+  results.path_mtu = low;
+  results.black_hole = lostAbove && results.reported_mtu == 0 && results.df_supported;
+  results.recommended_udp_payload = payloadSize(low);
+  results.recommended_icmp_payload = payloadSize(low);
+  return true;
+}
+
+// ==========================================
+// FRAGMENTATION COST
+// ==========================================
+static bool measureSize(PmtuSession& session, uint16_t ipSize, PmtuSizeStats& stats) {
+  const PmtuConfig& c = session.config;
+  memset(&stats, 0, sizeof(stats));
+  stats.ip_size = ipSize;
+
+  // Sequential probes for latency and loss
+  float totalMs = 0;
+  for (uint8_t i = 0; i < c.measure_count; i++) {
+    if (isCancelled(session)) return false;
+
+    uint32_t rtt_us = 0;
+    stats.sent++;
+    ProbeReply reply = probeOnce(session, ipSize, rtt_us);
+    if (reply.outcome == PROBE_ERROR || reply.outcome == PROBE_LOCAL_TOO_BIG) return false;
+    if (reply.outcome != PROBE_DELIVERED) continue;
+
+    float ms = rtt_us / 1000.0f;
+    stats.received++;
+    if (stats.received == 1 || ms < stats.min_ms) stats.min_ms = ms;
+    if (ms > stats.max_ms) stats.max_ms = ms;
+    totalMs += ms;
+  }
+  if (stats.received > 0) stats.avg_ms = totalMs / stats.received;
+  if (stats.sent > 0) stats.loss_percent = (float)(stats.sent - stats.received) * 100.0f / stats.sent;
+
+  if (c.burst_count == 0) return true;
+
+  // Back-to-back burst for goodput
+  uint16_t first = session.next_sequence;
+  uint64_t start = icmpMonotonicMicros();
+  for (uint8_t i = 0; i < c.burst_count; i++) {
+    if (sendProbe(session, ipSize, session.next_sequence++) != PROBE_NONE) return false;
+  }
+
+  uint16_t received = 0;
+  uint64_t lastArrival = start;
+  uint64_t deadline = icmpMonotonicMicros() + (uint64_t)c.timeout_ms * 1000ULL;
+  while (received < c.burst_count && !isCancelled(session)) {
+    uint64_t now = icmpMonotonicMicros();
+    if (now >= deadline) break;
+    if (!waitForSockets(session, (uint32_t)(deadline - now))) continue;
+
+    ProbeReply reply;
+    while (readReply(session, ipSize, first, c.burst_count, reply)) {
+      if (reply.outcome == PROBE_DELIVERED) {
+        received++;
+        lastArrival = icmpMonotonicMicros();
+      }
+    }
+  }
+
+  if (received > 0 && lastArrival > start) {
+    float bits = (float)received * payloadSize(ipSize) * 8.0f;
+    stats.goodput_kbps = bits * 1000.0f / (float)(lastArrival - start);
+  }
+  return true;
+}
+
+bool pmtuMeasureFragmentationCost(PmtuSession& session, PmtuResults& results) {
+  if (results.path_mtu == 0) return false;
+
+  // Fragmentation must be allowed for the size above the MTU
+  icmpSetDontFragment(probeSendFd(session), false);
+
+  if (!measureSize(session, results.path_mtu, results.below)) return false;
+  return measureSize(session, results.path_mtu + 1, results.above);
+}
+
+#ifdef ARDUINO
+// ==========================================
+// ESP32 RUNNER
+// ==========================================
+#define TAG_PMTU "PMTU"
+#define PMTU_TASK_STACK 8192
+
+static TaskHandle_t pmtuTaskHandle = nullptr;
+static SemaphoreHandle_t pmtuMutex = nullptr;
+static volatile bool pmtuCancel = false;
+static volatile PmtuState pmtuState = PMTU_IDLE;
+static PmtuResults pmtuResults;     // Published copy, guarded by pmtuMutex
+static PmtuConfig pmtuConfig;
+static uint32_t pmtuTarget = 0;
+static char pmtuHost[64] = "";
+
+static void publishPmtuResults(const PmtuResults& results) {
+  if (xSemaphoreTake(pmtuMutex, portMAX_DELAY) == pdTRUE) {
+    pmtuResults = results;
+    xSemaphoreGive(pmtuMutex);
+  }
+}
+
+static void pmtuTask(void* parameter) {
+  static PmtuResults working;
+  PmtuSession session;
+
+  if (!pmtuBegin(session, pmtuTarget, pmtuConfig)) {
+    LOG_ERROR(TAG_PMTU, "Failed to open probe sockets");
+    pmtuState = PMTU_ERROR;
+    pmtuTaskHandle = nullptr;
+    vTaskDelete(nullptr);
+    return;
+  }
+  session.cancel = &pmtuCancel;
+
+  bool ok = pmtuDiscover(session, working);
+  publishPmtuResults(working);
+
+  if (ok && !pmtuCancel) {
+    pmtuState = PMTU_MEASURING;
+    ok = pmtuMeasureFragmentationCost(session, working);
+    publishPmtuResults(working);
+  }
+  pmtuEnd(session);
+
+  if (pmtuCancel) {
+    pmtuState = PMTU_IDLE;
+    Serial.println("⏹️ PMTU discovery stopped");
+  } else if (!working.target_reachable) {
+    pmtuState = PMTU_ERROR;
+    Serial.printf("❌ PMTU: %s did not answer %u-byte probes\n", pmtuHost, pmtuConfig.min_mtu);
+  } else {
+    pmtuState = ok ? PMTU_COMPLETED : PMTU_ERROR;
+    printPmtuResults(working);
+  }
+
+  pmtuTaskHandle = nullptr;
+  vTaskDelete(nullptr);
+}
+
+bool startPmtuDiscovery(const String& host, const PmtuConfig& config) {
+  if (pmtuTaskHandle != nullptr) {
+    Serial.println("❌ PMTU discovery already running. Use 'pmtu stop' first.");
+    return false;
+  }
+
+  if (pmtuMutex == nullptr) {
+    pmtuMutex = xSemaphoreCreateMutex();
+    if (pmtuMutex == nullptr) {
+      LOG_ERROR(TAG_PMTU, "Failed to create results mutex");
+      return false;
+    }
+  }
+
+  IPAddress targetIP;
+  if (!dnsResolve(host, targetIP)) {
+    Serial.printf("❌ Failed to resolve %s\n", host.c_str());
+    return false;
+  }
+
+  strncpy(pmtuHost, host.c_str(), sizeof(pmtuHost) - 1);
+  pmtuHost[sizeof(pmtuHost) - 1] = '\0';
+  pmtuTarget = (uint32_t)targetIP;
+  pmtuConfig = config;
+  pmtuCancel = false;
+  pmtuState = PMTU_DISCOVERING;
+
+  BaseType_t result = xTaskCreatePinnedToCore(
+    pmtuTask,                 // Task function
+    "PMTU_Discovery",         // Task name
+    PMTU_TASK_STACK,          // Stack size (bytes)
+    nullptr,                  // Task parameters
+    1,                        // Priority (same as loop)
+    &pmtuTaskHandle,          // Task handle
+    1                         // Core ID (1 = app core)
+  );
+
+  if (result != pdPASS) {
+    LOG_ERROR(TAG_PMTU, "Failed to create PMTU task");
+    pmtuTaskHandle = nullptr;
+    pmtuState = PMTU_ERROR;
+    return false;
+  }
+
+  Serial.printf("📏 Discovering path MTU to %s (%s) with %s probes, %u-%u bytes\n",
+                pmtuHost, targetIP.toString().c_str(),
+                config.probe_type == PMTU_PROBE_UDP ? "UDP" : "ICMP", config.min_mtu, config.max_mtu);
+  return true;
+}
+
+void stopPmtuDiscovery() {
+  if (pmtuTaskHandle == nullptr) return;
+  pmtuCancel = true;
+}
+
+PmtuState getPmtuState() {
+  return pmtuState;
+}
+
+PmtuResults getPmtuResults() {
+  PmtuResults snapshot;
+  memset(&snapshot, 0, sizeof(snapshot));
+  if (pmtuMutex != nullptr && xSemaphoreTake(pmtuMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+    snapshot = pmtuResults;
+    xSemaphoreGive(pmtuMutex);
+  }
+  return snapshot;
+}
+
+static void printSizeStats(const char* label, const PmtuSizeStats& stats) {
+  Serial.printf("%-22s %5u %5u %6.1f%% %7.2f %7.2f %7.2f %9.1f\n", label, stats.ip_size,
+                payloadSize(stats.ip_size), stats.loss_percent, stats.min_ms, stats.avg_ms,
+                stats.max_ms, stats.goodput_kbps);
+}
+
+void printPmtuResults(const PmtuResults& results) {
+  Serial.printf("\n📏 === Path MTU to %s (%s) ===\n", pmtuHost, IPAddress(results.target).toString().c_str());
+  Serial.printf("Probe type:        %s\n", results.probe_type == PMTU_PROBE_UDP ? "UDP" : "ICMP");
+  Serial.printf("Path MTU:          %u bytes (%u search steps, %u probes)\n",
+                results.path_mtu, results.search_steps, results.probes_sent);
+
+  if (!results.df_supported) {
+    Serial.println("⚠️  DF not available in this IP stack: result is the largest size");
+    Serial.println("    delivered end to end up to the local MTU");
+  }
+  if (results.reported_mtu > 0) {
+    Serial.printf("Frag. Needed:      next-hop MTU %u from %s\n", results.reported_mtu,
+                  IPAddress(results.frag_needed_from).toString().c_str());
+  }
+  if (results.black_hole) {
+    Serial.println("⚠️  PMTU black hole: larger DF packets were dropped without ICMP feedback");
+  }
+
+  if (results.below.sent > 0) {
+    Serial.println("\nFragmentation cost  IP size  Data   Loss     Min     Avg     Max  Goodput kbps");
+    printSizeStats("At MTU (unfragmented)", results.below);
+    printSizeStats("MTU+1  (fragmented)", results.above);
+
+    if (results.below.avg_ms > 0 && results.above.avg_ms > 0) {
+      Serial.printf("Fragmenting adds %.2f ms avg latency and %+.1f%% loss\n",
+                    results.above.avg_ms - results.below.avg_ms,
+                    results.above.loss_percent - results.below.loss_percent);
+    }
+  }
+
+  Serial.println("\n💡 Recommended sizes for this site:");
+  Serial.printf("   iPerf UDP datagram: %u bytes ('pmtu apply' or 'iperf length %u')\n",
+                results.recommended_udp_payload, results.recommended_udp_payload);
+  Serial.printf("   Ping / probe data:  %u bytes\n", results.recommended_icmp_payload);
+  Serial.println("==========================================\n");
+}
+
+static String sizeStatsJSON(const PmtuSizeStats& stats) {
+  String json = "{";
+  json += "\"ip_size\":" + String(stats.ip_size) + ",";
+  json += "\"sent\":" + String(stats.sent) + ",";
+  json += "\"received\":" + String(stats.received) + ",";
+  json += "\"loss\":" + String(stats.loss_percent, 1) + ",";
+  json += "\"min\":" + String(stats.min_ms, 2) + ",";
+  json += "\"avg\":" + String(stats.avg_ms, 2) + ",";
+  json += "\"max\":" + String(stats.max_ms, 2) + ",";
+  json += "\"goodput_kbps\":" + String(stats.goodput_kbps, 1);
+  json += "}";
+  return json;
+}
+
+String exportPmtuJSON(const PmtuResults& results) {
+  String json = "{";
+  json += "\"target\":\"" + String(pmtuHost) + "\",";
+  json += "\"ip\":\"" + IPAddress(results.target).toString() + "\",";
+  json += "\"state\":\"" + pmtuStateToString(pmtuState) + "\",";
+  json += "\"protocol\":\"" + String(results.probe_type == PMTU_PROBE_UDP ? "udp" : "icmp") + "\",";
+  json += "\"df_supported\":" + String(results.df_supported ? "true" : "false") + ",";
+  json += "\"path_mtu\":" + String(results.path_mtu) + ",";
+  json += "\"reported_mtu\":" + String(results.reported_mtu) + ",";
+  json += "\"black_hole\":" + String(results.black_hole ? "true" : "false") + ",";
+  json += "\"search_steps\":" + String(results.search_steps) + ",";
+  json += "\"below\":" + sizeStatsJSON(results.below) + ",";
+  json += "\"above\":" + sizeStatsJSON(results.above) + ",";
+  json += "\"recommended_udp_payload\":" + String(results.recommended_udp_payload) + ",";
+  json += "\"recommended_icmp_payload\":" + String(results.recommended_icmp_payload);
+  json += "}";
+  return json;
+}
+
+String pmtuStateToString(PmtuState state) {
+  switch (state) {
+    case PMTU_IDLE: return "idle";
+    case PMTU_DISCOVERING: return "discovering";
+    case PMTU_MEASURING: return "measuring";
+    case PMTU_COMPLETED: return "completed";
+    case PMTU_ERROR: return "error";
+    default: return "unknown";
+  }
+}
+#endif
@@ -0,0 +1,208 @@
+/**
+ * @file pmtu_discovery.h
+ * @brief Path MTU discovery and fragmentation-cost measurement
+ *
+ * Binary-searches the largest IP datagram that crosses the path with the
+ * Don't Fragment bit set, using ICMP echo or UDP probes. Routers that cannot
+ * forward a probe answer with ICMP Fragmentation Needed (and usually the
+ * next-hop MTU, which short-cuts the search); probes that vanish without any
+ * answer above a working size indicate a PMTU black hole.
+ *
+ * After discovery, latency, loss and echo goodput are measured with
+ * fragmentation allowed at the discovered MTU and just above it, which shows
+ * what fragmenting costs on this path and which iPerf / probe payload sizes
+ * to use.
+ *
+ * lwIP never sets DF, so on the ESP32 the search finds the largest size that
+ * is delivered end to end up to the local MTU rather than a router-reported
+ * MTU; results.df_supported records which case applies. The engine itself is
+ * portable and is exercised on Linux by pc_test_apps/pmtu_test.
+ *
+ * @author Arunkumar Mourougappane
+ * @version 3.0.0
+ * @date 2026-01-17
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "icmp_probe.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// ==========================================
+// PMTU CONFIGURATION
+// ==========================================
+#define PMTU_MIN_MTU 576                  // Every IPv4 path must carry this (RFC 791)
+#define PMTU_MAX_MTU 1500                 // Ethernet / WiFi MTU
+#define PMTU_IP_UDP_OVERHEAD 28           // IPv4 header + UDP or ICMP header
+#define PMTU_DEFAULT_RETRIES 3            // Attempts before a size counts as lost
+#define PMTU_DEFAULT_TIMEOUT_MS 1000
+#define PMTU_DEFAULT_MEASURE_COUNT 20     // Latency samples per size
+#define PMTU_DEFAULT_BURST_COUNT 32       // Back-to-back probes for goodput
+#define PMTU_MAX_BURST_COUNT 64
+#define PMTU_DEFAULT_UDP_PORT 7           // Echo responders; closed ports answer Port Unreachable
+
+// ==========================================
+// TYPES AND STATES
+// ==========================================
+enum PmtuProbeType {
+  PMTU_PROBE_ICMP = 0,    // Echo request, target answers Echo Reply
+  PMTU_PROBE_UDP = 1      // UDP datagram, target echoes it or answers Port Unreachable
+};
+
+enum PmtuState {
+  PMTU_IDLE = 0,
+  PMTU_DISCOVERING = 1,
+  PMTU_MEASURING = 2,
+  PMTU_COMPLETED = 3,
+  PMTU_ERROR = 4
+};
+
+// ==========================================
+// DATA STRUCTURES
+// ==========================================
+struct PmtuConfig {
+  PmtuProbeType probe_type;
+  uint16_t udp_port;            // UDP probe destination port
+  uint16_t min_mtu;
+  uint16_t max_mtu;
+  uint8_t retries;              // Attempts per size during the search
+  uint16_t timeout_ms;          // Wait per probe
+  uint8_t measure_count;        // Latency samples per measured size (0 skips)
+  uint8_t burst_count;          // Goodput burst length (0 skips)
+};
+
+/**
+ * @brief Latency and goodput at one datagram size, fragmentation allowed
+ */
+struct PmtuSizeStats {
+  uint16_t ip_size;             // Total IP datagram length
+  uint16_t sent;
+  uint16_t received;
+  float loss_percent;
+  float min_ms;
+  float avg_ms;
+  float max_ms;
+  float goodput_kbps;           // Delivered probe payload during the burst
+};
+
+struct PmtuResults {
+  uint32_t target;              // Network byte order
+  PmtuProbeType probe_type;
+  bool df_supported;            // false: search bounded by the local MTU only
+  bool target_reachable;        // Smallest size got through
+  uint16_t path_mtu;            // Largest IP datagram delivered unfragmented
+  uint16_t reported_mtu;        // Lowest next-hop MTU from Fragmentation Needed, 0 = none
+  uint32_t frag_needed_from;    // Router that reported it (network byte order)
+  bool black_hole;              // Oversized probes lost with no Fragmentation Needed
+  uint8_t search_steps;         // Sizes tried during the search
+  uint16_t probes_sent;
+  PmtuSizeStats below;          // At path_mtu
+  PmtuSizeStats above;          // path_mtu + 1: every probe is fragmented
+  uint16_t recommended_udp_payload;    // iPerf UDP datagram / echo probe size
+  uint16_t recommended_icmp_payload;   // Ping data size
+};
+
+/**
+ * @brief Engine state for one discovery run
+ */
+struct PmtuSession {
+  PmtuConfig config;
+  uint32_t target;
+  int icmp_fd;                  // Receives ICMP replies/errors; sends ICMP probes
+  int udp_fd;                   // Sends UDP probes, receives UDP echoes
+  uint16_t ident;               // ICMP echo id / UDP source port
+  uint16_t next_sequence;
+  volatile bool* cancel;        // Optional external stop flag
+};
+
+// ==========================================
+// DISCOVERY ENGINE (portable)
+// ==========================================
+
+/**
+ * @brief Get default PMTU discovery configuration
+ * @param type Probe protocol
+ * @return Default configuration
+ */
+PmtuConfig getDefaultPmtuConfig(PmtuProbeType type = PMTU_PROBE_ICMP);
+
+/**
+ * @brief Open sockets and prepare a discovery session
+ * @param session Session to initialise
+ * @param target Target address (network byte order)
+ * @param config Probe configuration (values are clamped to supported limits)
+ * @return true if sockets were opened
+ */
+bool pmtuBegin(PmtuSession& session, uint32_t target, const PmtuConfig& config);
+
+/**
+ * @brief Binary-search the path MTU with DF-set probes
+ * @param session Open session
+ * @param results Filled with path_mtu, reported_mtu, black_hole, recommendations
+ * @return false if cancelled, on socket errors, or if the target never answered
+ */
+bool pmtuDiscover(PmtuSession& session, PmtuResults& results);
+
+/**
+ * @brief Measure latency, loss and goodput at and just above the path MTU
+ * @param session Open session
+ * @param results Results from pmtuDiscover; below/above are filled in
+ * @return false if cancelled or on socket errors
+ */
+bool pmtuMeasureFragmentationCost(PmtuSession& session, PmtuResults& results);
+
+/**
+ * @brief Close the session sockets
+ */
+void pmtuEnd(PmtuSession& session);
+
+#ifdef ARDUINO
+// ==========================================
+// ESP32 RUNNER (task, serial, JSON)
+// ==========================================
+
+/**
+ * @brief Start PMTU discovery and fragmentation measurement in a background task
+ * @param host Target hostname or IP address
+ * @param config Probe configuration
+ * @return true if the task was started
+ */
+bool startPmtuDiscovery(const String& host, const PmtuConfig& config);
+
+/**
+ * @brief Stop a running discovery
+ */
+void stopPmtuDiscovery();
+
+/**
+ * @brief Get current discovery state
+ */
+PmtuState getPmtuState();
+
+/**
+ * @brief Get a copy of the current or last results
+ */
+PmtuResults getPmtuResults();
+
+/**
+ * @brief Print discovery and fragmentation-cost results to serial
+ */
+void printPmtuResults(const PmtuResults& results);
+
+/**
+ * @brief Export results to JSON format
+ * @param results Results to export
+ * @return JSON formatted string
+ */
+String exportPmtuJSON(const PmtuResults& results);
+
+/**
+ * @brief Convert discovery state to string
+ */
+String pmtuStateToString(PmtuState state);
+#endif
@@ -4,11 +4,15 @@
  * 
  * This file implements network port scanning functionality:
  * - TCP connection-based port scanning
- * - Concurrent scanning for improved performance
+ * - Non-blocking connects, a window of probes in flight polled with select()
+ * - RTT-adaptive probe timeouts, closed (RST) vs filtered (silence)
+ * - UDP probes with protocol payloads, ICMP port unreachable detection
+ * - Range-list port sets and bitmap results (fixed memory for any range)
  * - Common service identification (HTTP, SSH, FTP, etc.)
+ * - Banner grabbing against a signature table, with a per-host cache
  * - Response time measurement
- * - Progress tracking and cancellation support
- * - Configurable timeout and port ranges
+ * - Background FreeRTOS scan task with progress and cancellation support
+ * - Configurable timeout, window and port ranges
  * 
  * @author Arunkumar Mourougappane
  * @version 4.3.0
@@ -16,84 +20,1336 @@
  */
 
 #include "port_scanner.h"
-#include "logging.h"
+#include "icmp_probe.h"
+#include <string.h>
+#include <errno.h>
+
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#include <esp_timer.h>
 #include <WiFiClient.h>
+#include "logging.h"
+#include "dns_resolver.h"
+#include "host_discovery.h"
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <strings.h>
+#endif
 
 #define TAG_PORTSCAN "PortScan"
+#define PORTSCAN_POLL_MS 100       // Longest select() wait, keeps cancel responsive
 
 // ==========================================
-// GLOBAL STATE
+// PORT SETS
 // ==========================================
 
-PortScanState currentPortScanState = PORTSCAN_IDLE;
-PortScanConfig activePortScanConfig;
-PortScanResults lastPortScanResults;
+void portSetClear(PortSet& set) {
+    set.range_count = 0;
+    set.mask = nullptr;
+}
+
+bool portSetAddRange(PortSet& set, uint16_t first, uint16_t last) {
+    if (first == 0 || first > last || set.range_count >= PORTSCAN_MAX_RANGES) {
+        return false;
+    }
+    set.ranges[set.range_count].first = first;
+    set.ranges[set.range_count].last = last;
+    set.range_count++;
+    return true;
+}
+
+uint32_t portSetCount(const PortSet& set) {
+    uint32_t count = 0;
+    for (uint8_t i = 0; i < set.range_count; i++) {
+        const PortRange& range = set.ranges[i];
+        if (set.mask == nullptr) {
+            count += (uint32_t)range.last - range.first + 1;
+            continue;
+        }
+        for (uint32_t port = range.first; port <= range.last; port++) {
+            if (portBitmapTest(*set.mask, (uint16_t)port)) count++;
+        }
+    }
+    return count;
+}
+
+bool portSetNext(const PortSet& set, PortSetCursor& cursor, uint16_t& port) {
+    while (cursor.range < set.range_count) {
+        const PortRange& range = set.ranges[cursor.range];
+        if (cursor.next < range.first) {
+            cursor.next = range.first;
+        }
+        while (cursor.next <= range.last) {
+            uint16_t candidate = (uint16_t)cursor.next++;
+            if (set.mask == nullptr || portBitmapTest(*set.mask, candidate)) {
+                port = candidate;
+                return true;
+            }
+        }
+        cursor.range++;
+        cursor.next = 0;
+    }
+    return false;
+}
+
+// ==========================================
+// SERVICE NAMES
+// ==========================================
+
+#define SVC_TCP 0x01
+#define SVC_UDP 0x02
+#define SVC_COMMON_TCP 0x04   // Probed by the common-port TCP scan
+#define SVC_COMMON_UDP 0x08   // Probed by the common-port UDP scan (has a payload)
+
+struct ServiceEntry {
+    uint16_t port;
+    uint8_t flags;
+    const char* name;
+};
+
+// IANA and de facto assignments, sorted by port (TCP row first where the
+// protocols differ); lives in flash and is searched in place
+static constexpr ServiceEntry SERVICE_TABLE[] = {
+    {1, SVC_TCP | SVC_UDP, "TCPMUX"},
+    {5, SVC_TCP | SVC_UDP, "RJE"},
+    {7, SVC_TCP | SVC_UDP | SVC_COMMON_UDP, "Echo"},
+    {9, SVC_TCP | SVC_UDP, "Discard"},
+    {11, SVC_TCP | SVC_UDP, "Systat"},
+    {13, SVC_TCP | SVC_UDP, "Daytime"},
+    {17, SVC_TCP | SVC_UDP, "QOTD"},
+    {18, SVC_TCP | SVC_UDP, "MSP"},
+    {19, SVC_TCP | SVC_UDP, "Chargen"},
+    {20, SVC_TCP, "FTP-Data"},
+    {21, SVC_TCP | SVC_COMMON_TCP, "FTP"},
+    {22, SVC_TCP | SVC_COMMON_TCP, "SSH"},
+    {23, SVC_TCP | SVC_COMMON_TCP, "Telnet"},
+    {25, SVC_TCP | SVC_COMMON_TCP, "SMTP"},
+    {37, SVC_TCP | SVC_UDP, "Time"},
+    {38, SVC_TCP | SVC_UDP, "RAP"},
+    {39, SVC_UDP, "RLP"},
+    {42, SVC_TCP | SVC_UDP, "Nameserver"},
+    {43, SVC_TCP, "WHOIS"},
+    {49, SVC_TCP | SVC_UDP, "TACACS"},
+    {53, SVC_TCP | SVC_UDP | SVC_COMMON_TCP | SVC_COMMON_UDP, "DNS"},
+    {63, SVC_TCP | SVC_UDP, "WHOIS++"},
+    {67, SVC_UDP, "DHCP-Server"},
+    {68, SVC_UDP, "DHCP-Client"},
+    {69, SVC_UDP, "TFTP"},
+    {70, SVC_TCP, "Gopher"},
+    {79, SVC_TCP, "Finger"},
+    {80, SVC_TCP | SVC_COMMON_TCP, "HTTP"},
+    {88, SVC_TCP | SVC_UDP, "Kerberos"},
+    {95, SVC_TCP, "SUPDUP"},
+    {101, SVC_TCP, "Hostname"},
+    {102, SVC_TCP, "ISO-TSAP"},
+    {104, SVC_TCP, "DICOM"},
+    {105, SVC_TCP, "CSO"},
+    {106, SVC_TCP, "POP3PW"},
+    {107, SVC_TCP, "RTelnet"},
+    {109, SVC_TCP, "POP2"},
+    {110, SVC_TCP | SVC_COMMON_TCP, "POP3"},
+    {111, SVC_TCP | SVC_UDP, "RPCbind"},
+    {113, SVC_TCP, "Ident"},
+    {115, SVC_TCP, "SFTP"},
+    {117, SVC_TCP, "UUCP-Path"},
+    {118, SVC_TCP | SVC_UDP, "SQLServ"},
+    {119, SVC_TCP, "NNTP"},
+    {123, SVC_UDP | SVC_COMMON_UDP, "NTP"},
+    {135, SVC_TCP | SVC_UDP, "MSRPC"},
+    {137, SVC_UDP | SVC_COMMON_UDP, "NetBIOS-NS"},
+    {138, SVC_UDP, "NetBIOS-DGM"},
+    {139, SVC_TCP, "NetBIOS-SSN"},
+    {143, SVC_TCP | SVC_COMMON_TCP, "IMAP"},
+    {152, SVC_TCP | SVC_UDP, "BFTP"},
+    {153, SVC_TCP | SVC_UDP, "SGMP"},
+    {156, SVC_TCP | SVC_UDP, "SQLSrv"},
+    {158, SVC_TCP | SVC_UDP, "DMSP"},
+    {161, SVC_UDP | SVC_COMMON_UDP, "SNMP"},
+    {162, SVC_UDP, "SNMP-Trap"},
+    {170, SVC_TCP, "Print-Srv"},
+    {174, SVC_TCP, "MAILQ"},
+    {177, SVC_UDP, "XDMCP"},
+    {179, SVC_TCP, "BGP"},
+    {194, SVC_TCP, "IRC"},
+    {199, SVC_TCP, "SMUX"},
+    {209, SVC_TCP, "QMTP"},
+    {210, SVC_TCP, "Z39.50"},
+    {213, SVC_UDP, "IPX"},
+    {218, SVC_TCP, "MPP"},
+    {220, SVC_TCP, "IMAP3"},
+    {259, SVC_TCP | SVC_UDP, "ESRO-Gen"},
+    {264, SVC_TCP | SVC_UDP, "BGMP"},
+    {280, SVC_TCP, "HTTP-Mgmt"},
+    {308, SVC_TCP, "Novastor"},
+    {311, SVC_TCP, "AppleShare-Admin"},
+    {318, SVC_TCP, "TSP"},
+    {350, SVC_TCP, "MATIP-A"},
+    {351, SVC_TCP, "MATIP-B"},
+    {366, SVC_TCP, "ODMR"},
+    {369, SVC_TCP | SVC_UDP, "RPC2PortMap"},
+    {370, SVC_TCP | SVC_UDP, "CodaAuth2"},
+    {371, SVC_TCP | SVC_UDP, "ClearCase"},
+    {383, SVC_TCP, "HP-Alarm-Mgr"},
+    {384, SVC_TCP, "ARNS"},
+    {387, SVC_TCP, "AURP"},
+    {389, SVC_TCP | SVC_UDP, "LDAP"},
+    {401, SVC_TCP | SVC_UDP, "UPS"},
+    {406, SVC_TCP, "IMSP"},
+    {407, SVC_TCP, "Timbuktu"},
+    {411, SVC_TCP, "RMT"},
+    {413, SVC_TCP, "SMSP"},
+    {414, SVC_TCP, "InfoSeek"},
+    {415, SVC_TCP, "BNet"},
+    {417, SVC_TCP, "Onmux"},
+    {418, SVC_TCP, "Hyper-G"},
+    {425, SVC_TCP, "ICAD-EL"},
+    {427, SVC_TCP | SVC_UDP, "SLP"},
+    {434, SVC_UDP, "Mobile-IP"},
+    {443, SVC_TCP | SVC_COMMON_TCP, "HTTPS"},
+    {443, SVC_UDP, "QUIC"},
+    {444, SVC_TCP, "SNPP"},
+    {445, SVC_TCP | SVC_COMMON_TCP, "SMB"},
+    {458, SVC_TCP, "Apple-QT"},
+    {464, SVC_TCP | SVC_UDP, "Kpasswd"},
+    {465, SVC_TCP, "SMTPS"},
+    {475, SVC_TCP | SVC_UDP, "TCPnetHaspSrv"},
+    {491, SVC_TCP, "GO-Login"},
+    {497, SVC_TCP, "Retrospect"},
+    {500, SVC_UDP, "ISAKMP"},
+    {501, SVC_TCP | SVC_UDP, "STMF"},
+    {502, SVC_TCP, "Modbus"},
+    {504, SVC_TCP, "Citadel"},
+    {510, SVC_TCP, "FCP"},
+    {512, SVC_TCP, "Rexec"},
+    {512, SVC_UDP, "Biff"},
+    {513, SVC_TCP, "Rlogin"},
+    {513, SVC_UDP, "Who"},
+    {514, SVC_TCP, "Rsh"},
+    {514, SVC_UDP, "Syslog"},
+    {515, SVC_TCP, "LPD"},
+    {517, SVC_UDP, "Talk"},
+    {518, SVC_UDP, "NTalk"},
+    {520, SVC_UDP, "RIP"},
+    {521, SVC_UDP, "RIPng"},
+    {523, SVC_TCP, "IBM-DB2"},
+    {524, SVC_TCP, "NCP"},
+    {525, SVC_UDP, "Timed"},
+    {526, SVC_TCP, "Tempo"},
+    {530, SVC_TCP, "Courier"},
+    {531, SVC_TCP, "Conference"},
+    {532, SVC_TCP, "NetNews"},
+    {533, SVC_UDP, "NetWall"},
+    {538, SVC_TCP, "GDOMAP"},
+    {540, SVC_TCP, "UUCP"},
+    {542, SVC_TCP | SVC_UDP, "Commerce"},
+    {543, SVC_TCP, "Klogin"},
+    {544, SVC_TCP, "Kshell"},
+    {546, SVC_UDP, "DHCPv6-Client"},
+    {547, SVC_UDP, "DHCPv6-Server"},
+    {548, SVC_TCP, "AFP"},
+    {554, SVC_TCP | SVC_UDP, "RTSP"},
+    {556, SVC_TCP, "RemoteFS"},
+    {560, SVC_UDP, "Rmonitor"},
+    {561, SVC_UDP, "Monitor"},
+    {563, SVC_TCP, "NNTPS"},
+    {587, SVC_TCP, "SMTP-Submission"},
+    {591, SVC_TCP, "FileMaker"},
+    {593, SVC_TCP, "HTTP-RPC-EPMAP"},
+    {604, SVC_TCP, "Tunnel"},
+    {607, SVC_TCP, "NQS"},
+    {623, SVC_UDP, "IPMI"},
+    {631, SVC_TCP | SVC_UDP, "IPP"},
+    {635, SVC_TCP | SVC_UDP, "RLZDBase"},
+    {636, SVC_TCP, "LDAPS"},
+    {639, SVC_TCP, "MSDP"},
+    {643, SVC_TCP, "SANity"},
+    {646, SVC_TCP | SVC_UDP, "LDP"},
+    {647, SVC_TCP, "DHCP-Failover"},
+    {648, SVC_TCP, "RRP"},
+    {651, SVC_TCP, "IEEE-MMS"},
+    {654, SVC_TCP, "AODV"},
+    {655, SVC_TCP, "Tinc"},
+    {657, SVC_TCP, "RMC"},
+    {660, SVC_TCP, "MacOS-Server-Admin"},
+    {666, SVC_TCP, "Doom"},
+    {674, SVC_TCP, "ACAP"},
+    {688, SVC_TCP, "REALM-RUSD"},
+    {690, SVC_TCP, "VATP"},
+    {691, SVC_TCP, "MS-Exchange-Routing"},
+    {694, SVC_TCP | SVC_UDP, "HA-Cluster"},
+    {695, SVC_TCP, "IEEE-MMS-SSL"},
+    {698, SVC_TCP, "OLSR"},
+    {700, SVC_TCP, "EPP"},
+    {701, SVC_TCP, "LMP"},
+    {702, SVC_TCP, "IRIS-BEEP"},
+    {706, SVC_TCP, "SILC"},
+    {711, SVC_TCP, "Cisco-TDP"},
+    {712, SVC_TCP, "TBRPF"},
+    {749, SVC_TCP | SVC_UDP, "Kerberos-Adm"},
+    {750, SVC_UDP, "Kerberos-IV"},
+    {754, SVC_TCP, "Krb-Prop"},
+    {782, SVC_TCP, "Conserver"},
+    {783, SVC_TCP, "SpamAssassin"},
+    {800, SVC_TCP, "MDBS-Daemon"},
+    {829, SVC_TCP, "PKIX-3-CA-RA"},
+    {830, SVC_TCP, "NETCONF-SSH"},
+    {831, SVC_TCP, "NETCONF-BEEP"},
+    {847, SVC_TCP, "DHCP-Failover2"},
+    {848, SVC_TCP | SVC_UDP, "GDOI"},
+    {853, SVC_TCP, "DNS-over-TLS"},
+    {861, SVC_TCP | SVC_UDP, "OWAMP-Control"},
+    {862, SVC_TCP | SVC_UDP, "TWAMP-Control"},
+    {873, SVC_TCP, "Rsync"},
+    {902, SVC_TCP, "VMware-Auth"},
+    {953, SVC_TCP, "RNDC"},
+    {989, SVC_TCP, "FTPS-Data"},
+    {990, SVC_TCP, "FTPS"},
+    {991, SVC_TCP, "NAS"},
+    {992, SVC_TCP, "TelnetS"},
+    {993, SVC_TCP, "IMAPS"},
+    {995, SVC_TCP, "POP3S"},
+    {1080, SVC_TCP, "SOCKS"},
+    {1099, SVC_TCP, "Java-RMI"},
+    {1167, SVC_TCP | SVC_UDP, "Cisco-IPSLA"},
+    {1194, SVC_TCP | SVC_UDP, "OpenVPN"},
+    {1241, SVC_TCP, "Nessus"},
+    {1270, SVC_TCP, "MS-OpsMgr"},
+    {1344, SVC_TCP, "ICAP"},
+    {1352, SVC_TCP, "Lotus-Notes"},
+    {1414, SVC_TCP, "IBM-MQ"},
+    {1433, SVC_TCP, "MSSQL"},
+    {1434, SVC_UDP, "MSSQL-Monitor"},
+    {1494, SVC_TCP, "Citrix-ICA"},
+    {1512, SVC_TCP | SVC_UDP, "WINS"},
+    {1521, SVC_TCP, "Oracle"},
+    {1524, SVC_TCP, "Ingres"},
+    {1583, SVC_TCP, "Pervasive-SQL"},
+    {1589, SVC_UDP, "Cisco-VQP"},
+    {1666, SVC_TCP, "Perforce"},
+    {1688, SVC_TCP, "KMS"},
+    {1701, SVC_UDP, "L2TP"},
+    {1719, SVC_UDP, "H.323-RAS"},
+    {1720, SVC_TCP, "H.323"},
+    {1723, SVC_TCP, "PPTP"},
+    {1755, SVC_TCP | SVC_UDP, "MMS"},
+    {1801, SVC_TCP, "MSMQ"},
+    {1812, SVC_UDP, "RADIUS"},
+    {1813, SVC_UDP, "RADIUS-Acct"},
+    {1863, SVC_TCP, "MSNP"},
+    {1883, SVC_TCP, "MQTT"},
+    {1900, SVC_UDP | SVC_COMMON_UDP, "SSDP"},
+    {1935, SVC_TCP, "RTMP"},
+    {1985, SVC_UDP, "HSRP"},
+    {2000, SVC_TCP, "Cisco-SCCP"},
+    {2049, SVC_TCP | SVC_UDP, "NFS"},
+    {2082, SVC_TCP, "cPanel"},
+    {2083, SVC_TCP, "cPanel-SSL"},
+    {2086, SVC_TCP, "WHM"},
+    {2087, SVC_TCP, "WHM-SSL"},
+    {2100, SVC_TCP, "Oracle-XDB"},
+    {2123, SVC_UDP, "GTP-C"},
+    {2152, SVC_UDP, "GTP-U"},
+    {2159, SVC_TCP, "GDB-Remote"},
+    {2181, SVC_TCP, "ZooKeeper"},
+    {2222, SVC_TCP, "SSH-Alt"},
+    {2323, SVC_TCP, "Telnet-Alt"},
+    {2375, SVC_TCP, "Docker"},
+    {2376, SVC_TCP, "Docker-TLS"},
+    {2377, SVC_TCP, "Docker-Swarm"},
+    {2379, SVC_TCP, "etcd"},
+    {2380, SVC_TCP, "etcd-Peer"},
+    {2401, SVC_TCP, "CVS"},
+    {2404, SVC_TCP, "IEC-104"},
+    {2427, SVC_UDP, "MGCP"},
+    {2483, SVC_TCP, "Oracle-TTC"},
+    {2484, SVC_TCP, "Oracle-TTC-SSL"},
+    {2525, SVC_TCP, "SMTP-Alt"},
+    {2598, SVC_TCP, "Citrix-CGP"},
+    {2601, SVC_TCP, "Zebra"},
+    {2604, SVC_TCP, "OSPFd"},
+    {2638, SVC_TCP, "Sybase"},
+    {2947, SVC_TCP, "GPSD"},
+    {2967, SVC_TCP, "Symantec-AV"},
+    {3031, SVC_TCP, "EPPC"},
+    {3050, SVC_TCP, "Firebird"},
+    {3052, SVC_TCP, "APC-PowerChute"},
+    {3128, SVC_TCP, "Squid"},
+    {3260, SVC_TCP, "iSCSI"},
+    {3268, SVC_TCP, "LDAP-GC"},
+    {3269, SVC_TCP, "LDAPS-GC"},
+    {3283, SVC_TCP | SVC_UDP, "Apple-Remote-Desktop"},
+    {3299, SVC_TCP, "SAP-Router"},
+    {3306, SVC_TCP | SVC_COMMON_TCP, "MySQL"},
+    {3310, SVC_TCP, "ClamAV"},
+    {3389, SVC_TCP | SVC_UDP | SVC_COMMON_TCP, "RDP"},
+    {3478, SVC_TCP | SVC_UDP, "STUN"},
+    {3493, SVC_TCP, "NUT"},
+    {3632, SVC_TCP, "distcc"},
+    {3671, SVC_UDP, "KNXnet-IP"},
+    {3689, SVC_TCP, "DAAP"},
+    {3690, SVC_TCP, "SVN"},
+    {3702, SVC_UDP, "WS-Discovery"},
+    {3784, SVC_UDP, "BFD"},
+    {3799, SVC_UDP, "RADIUS-DynAuth"},
+    {3868, SVC_TCP, "Diameter"},
+    {4369, SVC_TCP, "EPMD"},
+    {4500, SVC_UDP, "IPsec-NAT-T"},
+    {4662, SVC_TCP, "eDonkey"},
+    {4730, SVC_TCP, "Gearman"},
+    {4786, SVC_TCP, "Cisco-Smart-Install"},
+    {4789, SVC_UDP, "VXLAN"},
+    {4840, SVC_TCP, "OPC-UA"},
+    {4848, SVC_TCP, "GlassFish"},
+    {4899, SVC_TCP, "Radmin"},
+    {5000, SVC_TCP, "UPnP"},
+    {5004, SVC_UDP, "RTP"},
+    {5005, SVC_UDP, "RTCP"},
+    {5009, SVC_TCP, "AirPort-Admin"},
+    {5060, SVC_TCP | SVC_UDP, "SIP"},
+    {5061, SVC_TCP, "SIPS"},
+    {5093, SVC_UDP, "Sentinel-LM"},
+    {5222, SVC_TCP, "XMPP-Client"},
+    {5246, SVC_UDP, "CAPWAP-Control"},
+    {5247, SVC_UDP, "CAPWAP-Data"},
+    {5269, SVC_TCP, "XMPP-Server"},
+    {5280, SVC_TCP, "XMPP-BOSH"},
+    {5351, SVC_UDP, "NAT-PMP"},
+    {5353, SVC_UDP | SVC_COMMON_UDP, "mDNS"},
+    {5355, SVC_UDP, "LLMNR"},
+    {5357, SVC_TCP, "WSDAPI"},
+    {5432, SVC_TCP, "PostgreSQL"},
+    {5555, SVC_TCP, "ADB"},
+    {5601, SVC_TCP, "Kibana"},
+    {5631, SVC_TCP, "pcAnywhere"},
+    {5632, SVC_UDP, "pcAnywhere-Stat"},
+    {5666, SVC_TCP, "NRPE"},
+    {5671, SVC_TCP, "AMQPS"},
+    {5672, SVC_TCP, "AMQP"},
+    {5683, SVC_UDP | SVC_COMMON_UDP, "CoAP"},
+    {5684, SVC_UDP, "CoAPS"},
+    {5800, SVC_TCP, "VNC-HTTP"},
+    {5900, SVC_TCP | SVC_COMMON_TCP, "VNC"},
+    {5901, SVC_TCP, "VNC-1"},
+    {5938, SVC_TCP, "TeamViewer"},
+    {5984, SVC_TCP, "CouchDB"},
+    {5985, SVC_TCP, "WinRM"},
+    {5986, SVC_TCP, "WinRM-HTTPS"},
+    {6000, SVC_TCP, "X11"},
+    {6129, SVC_TCP, "DameWare"},
+    {6346, SVC_TCP, "Gnutella"},
+    {6379, SVC_TCP, "Redis"},
+    {6443, SVC_TCP, "Kubernetes-API"},
+    {6514, SVC_TCP, "Syslog-TLS"},
+    {6566, SVC_TCP, "SANE"},
+    {6600, SVC_TCP, "MPD"},
+    {6653, SVC_TCP, "OpenFlow"},
+    {6667, SVC_TCP, "IRC"},
+    {6697, SVC_TCP, "IRCS"},
+    {6881, SVC_TCP, "BitTorrent"},
+    {7001, SVC_TCP, "WebLogic"},
+    {7199, SVC_TCP, "Cassandra-JMX"},
+    {7474, SVC_TCP, "Neo4j"},
+    {7547, SVC_TCP, "TR-069"},
+    {8000, SVC_TCP, "HTTP-Alt"},
+    {8005, SVC_TCP, "Tomcat-Shutdown"},
+    {8008, SVC_TCP, "HTTP-Alt"},
+    {8009, SVC_TCP, "AJP"},
+    {8080, SVC_TCP | SVC_COMMON_TCP, "HTTP-Proxy"},
+    {8081, SVC_TCP, "HTTP-Alt"},
+    {8086, SVC_TCP, "InfluxDB"},
+    {8089, SVC_TCP, "Splunkd"},
+    {8118, SVC_TCP, "Privoxy"},
+    {8123, SVC_TCP, "Home-Assistant"},
+    {8161, SVC_TCP, "ActiveMQ-Admin"},
+    {8291, SVC_TCP, "MikroTik-Winbox"},
+    {8333, SVC_TCP, "Bitcoin"},
+    {8384, SVC_TCP, "Syncthing-GUI"},
+    {8443, SVC_TCP | SVC_COMMON_TCP, "HTTPS-Alt"},
+    {8500, SVC_TCP, "Consul"},
+    {8554, SVC_TCP, "RTSP-Alt"},
+    {8728, SVC_TCP, "MikroTik-API"},
+    {8834, SVC_TCP, "Nessus-Web"},
+    {8883, SVC_TCP, "MQTT-TLS"},
+    {8888, SVC_TCP, "HTTP-Alt"},
+    {9000, SVC_TCP, "HTTP-Alt"},
+    {9001, SVC_TCP, "Tor-ORPort"},
+    {9042, SVC_TCP, "Cassandra"},
+    {9050, SVC_TCP, "Tor-SOCKS"},
+    {9090, SVC_TCP, "Prometheus"},
+    {9091, SVC_TCP, "Transmission"},
+    {9092, SVC_TCP, "Kafka"},
+    {9100, SVC_TCP | SVC_COMMON_TCP, "Printer"},
+    {9200, SVC_TCP, "Elasticsearch"},
+    {9300, SVC_TCP, "Elasticsearch-Node"},
+    {9418, SVC_TCP, "Git"},
+    {9600, SVC_UDP, "OMRON-FINS"},
+    {10000, SVC_TCP, "Webmin"},
+    {10050, SVC_TCP, "Zabbix-Agent"},
+    {10051, SVC_TCP, "Zabbix-Server"},
+    {10250, SVC_TCP, "Kubelet"},
+    {11211, SVC_TCP | SVC_UDP, "Memcached"},
+    {11371, SVC_TCP, "HKP"},
+    {15672, SVC_TCP, "RabbitMQ-Mgmt"},
+    {16992, SVC_TCP, "Intel-AMT"},
+    {16993, SVC_TCP, "Intel-AMT-TLS"},
+    {17500, SVC_UDP, "Dropbox-LAN"},
+    {19132, SVC_UDP, "Minecraft-Bedrock"},
+    {20000, SVC_TCP, "DNP3"},
+    {25565, SVC_TCP, "Minecraft"},
+    {27017, SVC_TCP, "MongoDB"},
+    {27018, SVC_TCP, "MongoDB-Shard"},
+    {28017, SVC_TCP, "MongoDB-Web"},
+    {32400, SVC_TCP, "Plex"},
+    {33434, SVC_UDP, "Traceroute"},
+    {44818, SVC_TCP | SVC_UDP, "EtherNet-IP"},
+    {47808, SVC_UDP, "BACnet"},
+    {50070, SVC_TCP, "HDFS-NameNode"},
+    {51820, SVC_UDP, "WireGuard"},
+};
+
+static constexpr size_t SERVICE_COUNT = sizeof(SERVICE_TABLE) / sizeof(SERVICE_TABLE[0]);
+
+static constexpr bool serviceTableSorted(size_t i) {
+    return i + 1 >= SERVICE_COUNT ||
+           (SERVICE_TABLE[i].port <= SERVICE_TABLE[i + 1].port && serviceTableSorted(i + 1));
+}
+
+static constexpr size_t countServices(uint8_t flag, size_t i) {
+    return i >= SERVICE_COUNT ? 0 : ((SERVICE_TABLE[i].flags & flag) ? 1 : 0) + countServices(flag, i + 1);
+}
+
+static_assert(serviceTableSorted(0), "SERVICE_TABLE must be sorted by port");
+static_assert(countServices(SVC_COMMON_TCP, 0) <= PORTSCAN_MAX_RANGES, "Common TCP ports must fit a port set");
+static_assert(countServices(SVC_COMMON_UDP, 0) <= PORTSCAN_MAX_RANGES, "Common UDP ports must fit a port set");
+
+const char* getServiceName(uint16_t port, PortScanProtocol protocol) {
+    // Lower bound: first entry with this port
+    size_t low = 0;
+    size_t high = SERVICE_COUNT;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (SERVICE_TABLE[mid].port < port) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    uint8_t wanted = protocol == PORTSCAN_PROTO_UDP ? SVC_UDP : SVC_TCP;
+    const char* other = nullptr;
+    for (size_t i = low; i < SERVICE_COUNT && SERVICE_TABLE[i].port == port; i++) {
+        if (SERVICE_TABLE[i].flags & wanted) return SERVICE_TABLE[i].name;
+        if (other == nullptr) other = SERVICE_TABLE[i].name;
+    }
+    // Registered for the other protocol only: still the likeliest guess
+    return other != nullptr ? other : "Unknown";
+}
+
+void getCommonPorts(PortSet& set, PortScanProtocol protocol) {
+    uint8_t flag = protocol == PORTSCAN_PROTO_UDP ? SVC_COMMON_UDP : SVC_COMMON_TCP;
+    portSetClear(set);
+    for (const ServiceEntry& entry : SERVICE_TABLE) {
+        if (entry.flags & flag) {
+            portSetAddRange(set, entry.port, entry.port);
+        }
+    }
+}
+
+// ==========================================
+// SCAN ENGINE
+// ==========================================
+
+static uint64_t scanMicros() {
+#ifdef ARDUINO
+    return (uint64_t)esp_timer_get_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)(ts.tv_nsec / 1000);
+#endif
+}
+
+static PortScanOutcome outcomeFromError(int error) {
+    switch (error) {
+        case 0: return PORT_OUTCOME_OPEN;
+        case ECONNREFUSED:
+        case ECONNRESET: return PORT_OUTCOME_CLOSED;
+        case ETIMEDOUT: return PORT_OUTCOME_FILTERED;
+        default: return PORT_OUTCOME_ERROR;
+    }
+}
 
-// Current scan state
-static uint16_t currentPortIndex = 0;
-static std::vector<uint16_t> portsToScan;
+static void closeProbeSocket(int fd) {
+    // Abort instead of FIN: no TIME_WAIT PCB is left behind per open port
+    struct linger abortive = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &abortive, sizeof(abortive));
+    close(fd);
+}
+
+// RFC 6298 smoothing; only answered probes (SYN-ACK or RST) are samples
+static void updateRtt(PortScanSession& session, uint32_t rtt_us) {
+    if (session.rtt_samples == 0) {
+        session.srtt_us = rtt_us;
+        session.rttvar_us = rtt_us / 2;
+    } else {
+        uint32_t delta = session.srtt_us > rtt_us ? session.srtt_us - rtt_us : rtt_us - session.srtt_us;
+        session.rttvar_us = (3 * session.rttvar_us + delta) / 4;
+        session.srtt_us = (7 * session.srtt_us + rtt_us) / 8;
+    }
+    session.rtt_samples++;
+}
+
+static uint32_t probeTimeoutUs(const PortScanSession& session, uint8_t attempt) {
+    uint64_t maxUs = (uint64_t)session.timeout_ms * 1000ULL;
+    uint64_t timeout = maxUs;
+    if (session.rtt_samples > 0) {
+        timeout = (uint64_t)session.srtt_us + 4ULL * session.rttvar_us;
+        uint64_t minUs = (uint64_t)session.min_timeout_ms * 1000ULL;
+        if (timeout < minUs) timeout = minUs;
+    }
+    timeout <<= attempt;  // Back off on retries
+    return (uint32_t)(timeout < maxUs ? timeout : maxUs);
+}
+
+uint32_t portScanProbeTimeoutMs(const PortScanSession& session) {
+    return probeTimeoutUs(session, 0) / 1000;
+}
+
+static void reportProbe(PortScanSession& session, uint16_t port, PortScanOutcome outcome,
+                        uint64_t started_us) {
+    uint32_t elapsed = (uint32_t)(scanMicros() - started_us);
+    if (outcome == PORT_OUTCOME_OPEN || outcome == PORT_OUTCOME_CLOSED) {
+        updateRtt(session, elapsed);
+    }
+    if (session.on_result) {
+        session.on_result(port, outcome, elapsed, session.context);
+    }
+}
+
+static void finishProbe(PortScanSession& session, PortScanProbe& probe, PortScanOutcome outcome) {
+    reportProbe(session, probe.port, outcome, probe.started_us);
+    closeProbeSocket(probe.fd);
+    probe.fd = -1;
+    session.in_flight--;
+}
 
 // ==========================================
-// COMMON PORTS DEFINITIONS
+// UDP PAYLOADS
 // ==========================================
 
-std::vector<uint16_t> getCommonPorts() {
-    return {
-        21,    // FTP
-        22,    // SSH
-        23,    // Telnet
-        25,    // SMTP
-        53,    // DNS
-        80,    // HTTP
-        110,   // POP3
-        143,   // IMAP
-        443,   // HTTPS
-        445,   // SMB
-        3306,  // MySQL
-        3389,  // RDP
-        5900,  // VNC
-        8080,  // HTTP Alt
-        8443,  // HTTPS Alt
-        9100   // Printer
-    };
+struct UdpPayload {
+    uint16_t port;
+    uint8_t length;
+    const uint8_t* data;
+};
+
+// DNS: query for the root NS records
+static const uint8_t UDP_DNS[] = {
+    0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x02, 0x00, 0x01
+};
+// NTP: version 3 client request
+static const uint8_t UDP_NTP[48] = {0x1B};
+// NetBIOS: node status request for "*"
+static const uint8_t UDP_NETBIOS[] = {
+    0x80, 0xF0, 0x00, 0x10, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x20, 0x43, 0x4B, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41,
+    0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41,
+    0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x00, 0x00, 0x21,
+    0x00, 0x01
+};
+// SNMP v1: get sysDescr.0 with community "public"
+static const uint8_t UDP_SNMP[] = {
+    0x30, 0x26, 0x02, 0x01, 0x00, 0x04, 0x06, 'p', 'u', 'b', 'l', 'i', 'c',
+    0xA0, 0x19, 0x02, 0x01, 0x01, 0x02, 0x01, 0x00, 0x02, 0x01, 0x00,
+    0x30, 0x0E, 0x30, 0x0C, 0x06, 0x08, 0x2B, 0x06, 0x01, 0x02, 0x01, 0x01, 0x01, 0x00, 0x05, 0x00
+};
+// SSDP: unicast M-SEARCH
+static const char UDP_SSDP[] =
+    "M-SEARCH * HTTP/1.1\r\nHOST: 239.255.255.250:1900\r\nMAN: \"ssdp:discover\"\r\nMX: 1\r\nST: ssdp:all\r\n\r\n";
+// mDNS: unicast (legacy) query for _services._dns-sd._udp.local PTR
+static const uint8_t UDP_MDNS[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x09, '_', 's', 'e', 'r', 'v', 'i', 'c', 'e', 's', 0x07, '_', 'd', 'n', 's', '-', 's', 'd',
+    0x04, '_', 'u', 'd', 'p', 0x05, 'l', 'o', 'c', 'a', 'l', 0x00, 0x00, 0x0C, 0x00, 0x01
+};
+// CoAP: confirmable GET /.well-known/core
+static const uint8_t UDP_COAP[] = {
+    0x40, 0x01, 0x12, 0x34, 0xBB, '.', 'w', 'e', 'l', 'l', '-', 'k', 'n', 'o', 'w', 'n',
+    0x04, 'c', 'o', 'r', 'e'
+};
+static const char UDP_ECHO[] = "ESP32 WiFi Utility UDP scan";
+
+#define UDP_PAYLOAD(port, data) {port, (uint8_t)sizeof(data), (const uint8_t*)data}
+
+// Sorted by port; these are the SVC_COMMON_UDP ports of the service table
+static const UdpPayload UDP_PAYLOADS[] = {
+    UDP_PAYLOAD(7, UDP_ECHO),
+    UDP_PAYLOAD(53, UDP_DNS),
+    UDP_PAYLOAD(123, UDP_NTP),
+    UDP_PAYLOAD(137, UDP_NETBIOS),
+    UDP_PAYLOAD(161, UDP_SNMP),
+    UDP_PAYLOAD(1900, UDP_SSDP),
+    UDP_PAYLOAD(5353, UDP_MDNS),
+    UDP_PAYLOAD(5683, UDP_COAP),
+};
+
+static const UdpPayload* findUdpPayload(uint16_t port) {
+    for (const UdpPayload& payload : UDP_PAYLOADS) {
+        if (payload.port == port) return &payload;
+    }
+    return nullptr;
+}
+
+const char* portScanUdpService(uint16_t port) {
+    return findUdpPayload(port) != nullptr ? getServiceName(port, PORTSCAN_PROTO_UDP) : nullptr;
 }
 
 // ==========================================
-// SERVICE NAME MAPPING
+// PROBES
 // ==========================================
 
-String getServiceName(uint16_t port) {
-    switch(port) {
-        case 20: return "FTP-Data";
-        case 21: return "FTP";
-        case 22: return "SSH";
-        case 23: return "Telnet";
-        case 25: return "SMTP";
-        case 53: return "DNS";
-        case 80: return "HTTP";
-        case 110: return "POP3";
-        case 143: return "IMAP";
-        case 443: return "HTTPS";
-        case 445: return "SMB";
-        case 465: return "SMTPS";
-        case 587: return "SMTP-Submission";
-        case 993: return "IMAPS";
-        case 995: return "POP3S";
-        case 1433: return "MSSQL";
-        case 1521: return "Oracle";
-        case 3306: return "MySQL";
-        case 3389: return "RDP";
-        case 5432: return "PostgreSQL";
-        case 5900: return "VNC";
-        case 6379: return "Redis";
-        case 8080: return "HTTP-Proxy";
-        case 8443: return "HTTPS-Alt";
-        case 9100: return "Printer";
-        case 27017: return "MongoDB";
-        default: return "Unknown";
+static void claimProbeSlot(PortScanSession& session, int fd, uint16_t port, uint8_t attempt, uint64_t started) {
+    for (uint8_t i = 0; i < session.window; i++) {
+        PortScanProbe& probe = session.probes[i];
+        if (probe.fd < 0) {
+            probe.fd = fd;
+            probe.port = port;
+            probe.attempt = attempt;
+            probe.started_us = started;
+            probe.timeout_us = probeTimeoutUs(session, attempt);
+            session.in_flight++;
+            return;
+        }
+    }
+    closeProbeSocket(fd);  // Unreachable: callers keep in_flight below window
+}
+
+static bool startTcpProbe(PortScanSession& session, uint16_t port, uint8_t attempt, uint64_t started,
+                          const struct sockaddr_in& address) {
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0) {
+        return false;
+    }
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) == 0) {
+        // Loopback and some stacks complete immediately
+        reportProbe(session, port, PORT_OUTCOME_OPEN, started);
+        closeProbeSocket(fd);
+        return true;
+    }
+    if (errno != EINPROGRESS) {
+        reportProbe(session, port, outcomeFromError(errno), started);
+        closeProbeSocket(fd);
+        return true;
+    }
+
+    claimProbeSlot(session, fd, port, attempt, started);
+    return true;
+}
+
+static bool startUdpProbe(PortScanSession& session, uint16_t port, uint8_t attempt, uint64_t started,
+                          const struct sockaddr_in& address) {
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd < 0) {
+        return false;
+    }
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    // Connected, so replies from elsewhere are not taken for the port's answer
+    const UdpPayload* payload = findUdpPayload(port);
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        send(fd, payload ? payload->data : nullptr, payload ? payload->length : 0, 0) < 0) {
+        reportProbe(session, port, errno == ECONNREFUSED ? PORT_OUTCOME_CLOSED : PORT_OUTCOME_ERROR, started);
+        closeProbeSocket(fd);
+        return true;
+    }
+
+    claimProbeSlot(session, fd, port, attempt, started);
+    return true;
+}
+
+// Returns false if no socket is available right now
+static bool startProbe(PortScanSession& session, uint16_t port, uint8_t attempt) {
+    uint64_t started = scanMicros();
+    session.last_start_us = started;
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = session.target;
+
+    if (session.protocol == PORTSCAN_PROTO_UDP) {
+        return startUdpProbe(session, port, attempt, started, address);
+    }
+    return startTcpProbe(session, port, attempt, started, address);
+}
+
+// UDP: an answered probe is readable; ECONNREFUSED carries a port unreachable (Linux)
+static void finishUdpProbe(PortScanSession& session, PortScanProbe& probe) {
+    uint8_t reply[64];
+    ssize_t received = recv(probe.fd, reply, sizeof(reply), 0);
+    if (received >= 0) {
+        finishProbe(session, probe, PORT_OUTCOME_OPEN);
+    } else if (errno == ECONNREFUSED) {
+        finishProbe(session, probe, PORT_OUTCOME_CLOSED);
+    } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        finishProbe(session, probe, PORT_OUTCOME_ERROR);
+    }
+}
+
+// UDP: lwIP does not pass ICMP errors to UDP sockets, the raw socket sees them
+static void drainIcmpErrors(PortScanSession& session) {
+    IcmpMessage msg;
+    int rc;
+    while ((rc = icmpReceive(session.icmp_fd, msg)) >= 0) {
+        if (rc == 0 || msg.type != ICMP_TYPE_DEST_UNREACHABLE || !msg.has_quote) continue;
+        if (msg.quoted_protocol != ICMP_PROTO_UDP || msg.quoted_destination != session.target) continue;
+
+        for (uint8_t i = 0; i < session.window; i++) {
+            PortScanProbe& probe = session.probes[i];
+            if (probe.fd < 0 || probe.port != msg.quoted_dst_port) continue;
+            finishProbe(session, probe, msg.code == ICMP_CODE_PORT_UNREACHABLE ? PORT_OUTCOME_CLOSED
+                                                                             : PORT_OUTCOME_FILTERED);
+            break;
+        }
+    }
+}
+
+static void scanSleepUs(uint64_t us) {
+#ifdef ARDUINO
+    vTaskDelay(pdMS_TO_TICKS(us / 1000 > 0 ? us / 1000 : 1));
+#else
+    usleep((useconds_t)us);
+#endif
+}
+
+void portScanBegin(PortScanSession& session, uint32_t target, const PortSet& ports,
+                   uint8_t window, uint32_t timeout_ms, PortScanProtocol protocol) {
+    memset(&session, 0, sizeof(session));
+    session.target = target;
+    session.protocol = protocol;
+    session.icmp_fd = protocol == PORTSCAN_PROTO_UDP ? icmpOpenRawSocket() : -1;
+    session.ports = &ports;
+    session.port_count = portSetCount(ports);
+    session.has_next = portSetNext(ports, session.cursor, session.next_port);
+    session.window = window == 0 ? 1 : (window > PORTSCAN_MAX_WINDOW ? PORTSCAN_MAX_WINDOW : window);
+    session.timeout_ms = timeout_ms;
+    session.min_timeout_ms = timeout_ms < PORTSCAN_MIN_TIMEOUT_MS ? timeout_ms : PORTSCAN_MIN_TIMEOUT_MS;
+    session.max_retries = PORTSCAN_MAX_RETRIES;
+    for (uint8_t i = 0; i < PORTSCAN_MAX_WINDOW; i++) {
+        session.probes[i].fd = -1;
+    }
+}
+
+void portScanSetRate(PortScanSession& session, uint32_t probes_per_second) {
+    session.probe_interval_us = probes_per_second > 0 ? 1000000UL / probes_per_second : 0;
+}
+
+bool portScanRun(PortScanSession& session) {
+    bool udp = session.protocol == PORTSCAN_PROTO_UDP;
+
+    while (session.has_next || session.in_flight > 0) {
+        if (session.cancel && *session.cancel) {
+            return false;
+        }
+
+        // Top the window up; on socket exhaustion wait for a probe to finish
+        uint64_t nextStart = 0;
+        while (session.in_flight < session.window && session.has_next) {
+            if (session.probe_interval_us > 0 && session.last_start_us > 0) {
+                nextStart = session.last_start_us + session.probe_interval_us;
+                if (scanMicros() < nextStart) break;
+                nextStart = 0;
+            }
+            if (!startProbe(session, session.next_port, 0)) {
+                if (session.in_flight > 0) {
+                    break;
+                }
+                reportProbe(session, session.next_port, PORT_OUTCOME_ERROR, scanMicros());
+            }
+            session.has_next = portSetNext(*session.ports, session.cursor, session.next_port);
+        }
+        if (session.in_flight == 0) {
+            // Only the rate limit holds the next probe back
+            uint64_t now = scanMicros();
+            if (nextStart > now) scanSleepUs(nextStart - now);
+            continue;
+        }
+
+        fd_set readSet;
+        fd_set writeSet;
+        fd_set errorSet;
+        FD_ZERO(&readSet);
+        FD_ZERO(&writeSet);
+        FD_ZERO(&errorSet);
+        int maxFd = -1;
+        uint64_t now = scanMicros();
+        uint64_t wait = (uint64_t)PORTSCAN_POLL_MS * 1000ULL;
+        if (nextStart > now && nextStart - now < wait) wait = nextStart - now;
+
+        for (uint8_t i = 0; i < session.window; i++) {
+            const PortScanProbe& probe = session.probes[i];
+            if (probe.fd < 0) continue;
+            if (udp) {
+                FD_SET(probe.fd, &readSet);
+            } else {
+                FD_SET(probe.fd, &writeSet);
+                FD_SET(probe.fd, &errorSet);
+            }
+            if (probe.fd > maxFd) maxFd = probe.fd;
+            uint64_t deadline = probe.started_us + probe.timeout_us;
+            uint64_t remaining = deadline > now ? deadline - now : 0;
+            if (remaining < wait) wait = remaining;
+        }
+        if (session.icmp_fd >= 0) {
+            FD_SET(session.icmp_fd, &readSet);
+            if (session.icmp_fd > maxFd) maxFd = session.icmp_fd;
+        }
+
+        struct timeval tv;
+        tv.tv_sec = (long)(wait / 1000000ULL);
+        tv.tv_usec = (long)(wait % 1000000ULL);
+        int ready = select(maxFd + 1, &readSet, &writeSet, &errorSet, &tv);
+        now = scanMicros();
+
+        if (ready > 0 && session.icmp_fd >= 0 && FD_ISSET(session.icmp_fd, &readSet)) {
+            drainIcmpErrors(session);
+        }
+
+        // Retries start after the pass so a reused fd number can't match a stale FD_ISSET
+        uint16_t retryPorts[PORTSCAN_MAX_WINDOW];
+        uint8_t retryAttempts[PORTSCAN_MAX_WINDOW];
+        uint8_t retryCount = 0;
+
+        for (uint8_t i = 0; i < session.window; i++) {
+            PortScanProbe& probe = session.probes[i];
+            if (probe.fd < 0) continue;
+
+            if (ready > 0 && udp && FD_ISSET(probe.fd, &readSet)) {
+                finishUdpProbe(session, probe);
+                if (probe.fd < 0) continue;
+            } else if (ready > 0 && !udp && (FD_ISSET(probe.fd, &writeSet) || FD_ISSET(probe.fd, &errorSet))) {
+                // Connect finished (either way): SO_ERROR holds the result
+                int error = 0;
+                socklen_t length = sizeof(error);
+                getsockopt(probe.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+                finishProbe(session, probe, outcomeFromError(error));
+                continue;
+            }
+
+            if (now - probe.started_us >= probe.timeout_us) {
+                // Silence: retry unless this attempt already waited the full timeout.
+                // UDP has no retransmission of its own, so it always gets its retries.
+                uint16_t port = probe.port;
+                uint8_t attempt = probe.attempt;
+                bool retry = attempt < session.max_retries &&
+                             (udp || probe.timeout_us < session.timeout_ms * 1000ULL);
+                if (!retry) {
+                    finishProbe(session, probe, udp ? PORT_OUTCOME_OPEN_FILTERED : PORT_OUTCOME_FILTERED);
+                    continue;
+                }
+                closeProbeSocket(probe.fd);
+                probe.fd = -1;
+                session.in_flight--;
+                retryPorts[retryCount] = port;
+                retryAttempts[retryCount] = attempt + 1;
+                retryCount++;
+            }
+        }
+
+        for (uint8_t i = 0; i < retryCount; i++) {
+            if (!startProbe(session, retryPorts[i], retryAttempts[i])) {
+                reportProbe(session, retryPorts[i], udp ? PORT_OUTCOME_OPEN_FILTERED : PORT_OUTCOME_FILTERED, now);
+            }
+        }
+    }
+    return true;
+}
+
+void portScanEnd(PortScanSession& session) {
+    for (uint8_t i = 0; i < PORTSCAN_MAX_WINDOW; i++) {
+        if (session.probes[i].fd >= 0) {
+            closeProbeSocket(session.probes[i].fd);
+            session.probes[i].fd = -1;
+        }
+    }
+    session.in_flight = 0;
+    icmpCloseSocket(session.icmp_fd);
+    session.icmp_fd = -1;
+}
+
+// ==========================================
+// SERVICE FINGERPRINTING
+// ==========================================
+
+enum BannerDetail {
+    BANNER_DETAIL_NONE,
+    BANNER_DETAIL_LINE,          // First line of the reply
+    BANNER_DETAIL_HTTP_SERVER,   // Server header, else the status line
+    BANNER_DETAIL_MYSQL          // NUL-terminated version after the handshake header
+};
+
+struct BannerSignature {
+    uint8_t offset;              // Where the pattern must appear
+    uint8_t length;
+    const char* pattern;
+    const char* contains;        // Optional token anywhere in the first line
+    const char* service;
+    uint8_t detail;              // BannerDetail
+};
+
+#define BANNER_PATTERN(text) (uint8_t)(sizeof(text) - 1), text
+
+// First match wins: specific entries before generic ones with the same prefix
+static const BannerSignature BANNER_SIGNATURES[] = {
+    {0, BANNER_PATTERN("SSH-"), nullptr, "SSH", BANNER_DETAIL_LINE},
+    {0, BANNER_PATTERN("HTTP/"), nullptr, "HTTP", BANNER_DETAIL_HTTP_SERVER},
+    {0, BANNER_PATTERN("RTSP/"), nullptr, "RTSP", BANNER_DETAIL_LINE},
+    {0, BANNER_PATTERN("220"), "SMTP", "SMTP", BANNER_DETAIL_LINE},
+    {0, BANNER_PATTERN("220"), "FTP", "FTP", BANNER_DETAIL_LINE},
+    {0, BANNER_PATTERN("220"), nullptr, "FTP/SMTP", BANNER_DETAIL_LINE},
+    {0, BANNER_PATTERN("+OK"), nullptr, "POP3", BANNER_DETAIL_LINE},
+    {0, BANNER_PATTERN("* OK"), nullptr, "IMAP", BANNER_DETAIL_LINE},
+    {0, BANNER_PATTERN("RFB "), nullptr, "VNC", BANNER_DETAIL_LINE},
+    {0, BANNER_PATTERN("-ERR"), nullptr, "Redis", BANNER_DETAIL_NONE},
+    {0, BANNER_PATTERN("@RSYNCD:"), nullptr, "rsync", BANNER_DETAIL_LINE},
+    {0, BANNER_PATTERN("AMQP"), nullptr, "AMQP", BANNER_DETAIL_NONE},
+    {0, BANNER_PATTERN("\x15\x03"), nullptr, "TLS", BANNER_DETAIL_NONE},   // Alert for our plaintext
+    {0, BANNER_PATTERN("\x16\x03"), nullptr, "TLS", BANNER_DETAIL_NONE},
+    {0, BANNER_PATTERN("\xff"), nullptr, "Telnet", BANNER_DETAIL_NONE},    // IAC option negotiation
+    {3, BANNER_PATTERN("\x00\x0a"), nullptr, "MySQL", BANNER_DETAIL_MYSQL},
+};
+
+// Ports that usually carry HTTP get the HEAD request without waiting for a greeting
+static const uint16_t HTTP_FIRST_PORTS[] = {80, 443, 631, 3000, 5000, 8000, 8008, 8080, 8081, 8443, 8888};
+
+static const char HTTP_PROBE[] = "HEAD / HTTP/1.0\r\n\r\n";
+
+enum BannerPhase {
+    BANNER_CONNECTING,
+    BANNER_WAITING,              // Connected, listening for a greeting
+    BANNER_PROBED                // HEAD sent
+};
+
+struct BannerSlot {
+    int fd;                      // -1 when the slot is free
+    uint16_t index;              // Into the services array
+    uint8_t phase;
+    uint64_t started_us;
+    uint64_t probe_at_us;        // When to give up on a greeting and send HEAD
+    uint16_t length;
+    uint8_t buffer[PORTSCAN_BANNER_BUFFER];
+};
+
+static uint32_t bannerClockSeconds() {
+    return (uint32_t)(scanMicros() / 1000000ULL);
+}
+
+// Printable ASCII only; quotes, backslashes and angle brackets become '.'
+static void copyDetail(char* detail, const uint8_t* text, size_t length) {
+    size_t out = 0;
+    for (size_t i = 0; i < length && out < PORTSCAN_BANNER_DETAIL - 1; i++) {
+        uint8_t c = text[i];
+        if (c == '\r' || c == '\n' || c == '\0') break;
+        bool safe = c >= 0x20 && c < 0x7F && c != '"' && c != '\\' && c != '<' && c != '>';
+        detail[out++] = safe ? (char)c : '.';
+    }
+    while (out > 0 && detail[out - 1] == ' ') out--;
+    detail[out] = '\0';
+}
+
+static size_t firstLineLength(const uint8_t* text, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] == '\r' || text[i] == '\n') return i;
+    }
+    return length;
+}
+
+static bool lineContains(const uint8_t* text, size_t length, const char* token) {
+    size_t tokenLength = strlen(token);
+    size_t line = firstLineLength(text, length);
+    for (size_t i = 0; i + tokenLength <= line; i++) {
+        if (memcmp(text + i, token, tokenLength) == 0) return true;
+    }
+    return false;
+}
+
+static void extractHttpServer(const uint8_t* text, size_t length, char* detail) {
+    static const char HEADER[] = "\nServer:";
+    const size_t headerLength = sizeof(HEADER) - 1;
+    for (size_t i = 0; i + headerLength <= length; i++) {
+        if (strncasecmp((const char*)text + i, HEADER, headerLength) == 0) {
+            size_t start = i + headerLength;
+            while (start < length && text[start] == ' ') start++;
+            copyDetail(detail, text + start, length - start);
+            return;
+        }
+    }
+    copyDetail(detail, text, length);
+}
+
+bool portScanMatchBanner(const uint8_t* banner, size_t length, ServiceInfo& info) {
+    info.detail[0] = '\0';
+    for (const BannerSignature& signature : BANNER_SIGNATURES) {
+        if (length < (size_t)signature.offset + signature.length) continue;
+        if (memcmp(banner + signature.offset, signature.pattern, signature.length) != 0) continue;
+        if (signature.contains != nullptr && !lineContains(banner, length, signature.contains)) continue;
+
+        info.service = signature.service;
+        switch (signature.detail) {
+            case BANNER_DETAIL_LINE:
+                copyDetail(info.detail, banner, length);
+                break;
+            case BANNER_DETAIL_HTTP_SERVER:
+                extractHttpServer(banner, length, info.detail);
+                break;
+            case BANNER_DETAIL_MYSQL:
+                copyDetail(info.detail, banner + 5, length - 5);
+                break;
+            default:
+                break;
+        }
+        return true;
+    }
+    info.service = length > 0 ? "unknown" : nullptr;
+    copyDetail(info.detail, banner, length);
+    return false;
+}
+
+void serviceCacheClear(ServiceCache& cache) {
+    memset(&cache, 0, sizeof(cache));
+}
+
+static bool serviceCacheLookup(const ServiceCache& cache, uint32_t address, ServiceInfo& info, uint32_t now_s) {
+    for (const ServiceCacheEntry& entry : cache.entries) {
+        if (entry.address != address || entry.port != info.port) continue;
+        if (now_s - entry.stamp_s >= PORTSCAN_SERVICE_CACHE_TTL_S) return false;
+        info.service = entry.service;
+        memcpy(info.detail, entry.detail, sizeof(info.detail));
+        return true;
+    }
+    return false;
+}
+
+static void serviceCacheStore(ServiceCache& cache, uint32_t address, const ServiceInfo& info, uint32_t now_s) {
+    ServiceCacheEntry* slot = &cache.entries[0];
+    for (ServiceCacheEntry& entry : cache.entries) {
+        if (entry.address == address && entry.port == info.port) {
+            slot = &entry;
+            break;
+        }
+        if (entry.address == 0) {
+            if (slot->address != 0) slot = &entry;
+        } else if (slot->address != 0 && entry.stamp_s < slot->stamp_s) {
+            slot = &entry;   // Oldest so far
+        }
+    }
+    slot->address = address;
+    slot->port = info.port;
+    slot->service = info.service;
+    memcpy(slot->detail, info.detail, sizeof(slot->detail));
+    slot->stamp_s = now_s;
+}
+
+static bool isHttpFirstPort(uint16_t port) {
+    for (uint16_t candidate : HTTP_FIRST_PORTS) {
+        if (candidate == port) return true;
+    }
+    return false;
+}
+
+// Enough bytes to decide: HTTP needs its headers, others one line or any binary greeting
+static bool bannerComplete(const BannerSlot& slot) {
+    if (slot.length >= sizeof(slot.buffer)) return true;
+    ServiceInfo probe;
+    probe.port = 0;
+    if (portScanMatchBanner(slot.buffer, slot.length, probe)) {
+        if (strcmp(probe.service, "HTTP") != 0) return true;
+        for (uint16_t i = 0; i + 3 < slot.length; i++) {
+            if (memcmp(slot.buffer + i, "\r\n\r\n", 4) == 0) return true;
+        }
+        return false;
+    }
+    return firstLineLength(slot.buffer, slot.length) < slot.length;
+}
+
+static void finishBanner(BannerSlot& slot, ServiceInfo* services, uint32_t target, ServiceCache* cache) {
+    ServiceInfo& info = services[slot.index];
+    portScanMatchBanner(slot.buffer, slot.length, info);
+    if (cache != nullptr && info.service != nullptr) {
+        serviceCacheStore(*cache, target, info, bannerClockSeconds());
+    }
+    closeProbeSocket(slot.fd);
+    slot.fd = -1;
+}
+
+// Returns false if no socket is available right now; a refused connect leaves the slot free
+static bool startBanner(BannerSlot& slot, uint32_t target, uint16_t index, uint16_t port, uint32_t timeout_us) {
+    int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0) return false;
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = target;
+
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0 && errno != EINPROGRESS) {
+        closeProbeSocket(fd);
+        return true;
+    }
+    slot.fd = fd;
+    slot.index = index;
+    slot.length = 0;
+    slot.phase = BANNER_CONNECTING;
+    slot.started_us = scanMicros();
+    slot.probe_at_us = slot.started_us + (isHttpFirstPort(port) ? 0 : timeout_us / 2);
+    return true;
+}
+
+bool portScanGrabBanners(uint32_t target, ServiceInfo* services, uint16_t count, uint8_t window,
+                         uint32_t timeout_ms, ServiceCache* cache, volatile bool* cancel) {
+    BannerSlot slots[PORTSCAN_MAX_WINDOW];
+    window = window == 0 ? 1 : (window > PORTSCAN_MAX_WINDOW ? PORTSCAN_MAX_WINDOW : window);
+    for (uint8_t i = 0; i < PORTSCAN_MAX_WINDOW; i++) {
+        slots[i].fd = -1;
+    }
+
+    uint64_t timeoutUs = (uint64_t)timeout_ms * 1000ULL;
+    uint32_t nowSeconds = bannerClockSeconds();
+    uint16_t next = 0;
+    uint8_t inFlight = 0;
+
+    while (next < count || inFlight > 0) {
+        if (cancel != nullptr && *cancel) {
+            for (uint8_t i = 0; i < window; i++) {
+                if (slots[i].fd >= 0) closeProbeSocket(slots[i].fd);
+            }
+            return false;
+        }
+
+        // Top the window up; cached ports are answered without a connection
+        while (next < count && inFlight < window) {
+            ServiceInfo& info = services[next];
+            info.service = nullptr;
+            info.detail[0] = '\0';
+            info.cached = cache != nullptr && serviceCacheLookup(*cache, target, info, nowSeconds);
+            if (info.cached) {
+                next++;
+                continue;
+            }
+
+            uint8_t freeSlot = 0;
+            while (slots[freeSlot].fd >= 0) freeSlot++;
+            if (!startBanner(slots[freeSlot], target, next, info.port, (uint32_t)timeoutUs)) {
+                if (inFlight == 0) next++;   // No socket at all: leave the port unidentified
+                break;
+            }
+            next++;
+            if (slots[freeSlot].fd >= 0) inFlight++;
+        }
+        if (inFlight == 0) continue;
+
+        fd_set readSet;
+        fd_set writeSet;
+        FD_ZERO(&readSet);
+        FD_ZERO(&writeSet);
+        int maxFd = -1;
+        uint64_t now = scanMicros();
+        uint64_t wait = (uint64_t)PORTSCAN_POLL_MS * 1000ULL;
+
+        for (uint8_t i = 0; i < window; i++) {
+            const BannerSlot& slot = slots[i];
+            if (slot.fd < 0) continue;
+            FD_SET(slot.fd, slot.phase == BANNER_CONNECTING ? &writeSet : &readSet);
+            if (slot.fd > maxFd) maxFd = slot.fd;
+            uint64_t deadline = slot.started_us + timeoutUs;
+            if (slot.phase == BANNER_WAITING && slot.probe_at_us < deadline) deadline = slot.probe_at_us;
+            uint64_t remaining = deadline > now ? deadline - now : 0;
+            if (remaining < wait) wait = remaining;
+        }
+
+        struct timeval tv;
+        tv.tv_sec = (long)(wait / 1000000ULL);
+        tv.tv_usec = (long)(wait % 1000000ULL);
+        int ready = select(maxFd + 1, &readSet, &writeSet, nullptr, &tv);
+        now = scanMicros();
+
+        for (uint8_t i = 0; i < window; i++) {
+            BannerSlot& slot = slots[i];
+            if (slot.fd < 0) continue;
+
+            if (ready > 0 && slot.phase == BANNER_CONNECTING && FD_ISSET(slot.fd, &writeSet)) {
+                int error = 0;
+                socklen_t length = sizeof(error);
+                getsockopt(slot.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+                if (error != 0) {
+                    finishBanner(slot, services, target, cache);
+                    inFlight--;
+                    continue;
+                }
+                slot.phase = BANNER_WAITING;
+            } else if (ready > 0 && slot.phase != BANNER_CONNECTING && FD_ISSET(slot.fd, &readSet)) {
+                ssize_t received = recv(slot.fd, slot.buffer + slot.length, sizeof(slot.buffer) - slot.length, 0);
+                if (received > 0) slot.length += (uint16_t)received;
+                if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK) ||
+                    bannerComplete(slot)) {
+                    finishBanner(slot, services, target, cache);
+                    inFlight--;
+                    continue;
+                }
+            }
+
+            if (now - slot.started_us >= timeoutUs) {
+                finishBanner(slot, services, target, cache);
+                inFlight--;
+            } else if (slot.phase == BANNER_WAITING && slot.length == 0 && now >= slot.probe_at_us) {
+                // No greeting: servers that wait for the client get a HEAD request
+                send(slot.fd, HTTP_PROBE, sizeof(HTTP_PROBE) - 1, 0);
+                slot.phase = BANNER_PROBED;
+            }
+        }
     }
+    return true;
 }
 
+#ifdef ARDUINO
+// ==========================================
+// GLOBAL STATE
+// ==========================================
+
+PortScanState currentPortScanState = PORTSCAN_IDLE;
+PortScanConfig activePortScanConfig;
+PortScanResults lastPortScanResults;  // Guarded by portScanMutex while a scan runs
+
+#define PORTSCAN_TASK_STACK 6144   // Fingerprinting keeps a reply buffer per connection
+
+static PortSet portsToScan;
+static ServiceCache serviceCache;  // Fingerprints by host and port, used by the scan task only
+static ServiceInfo bannerServices[PORTSCAN_OPEN_LIST_SIZE];
+static PortBitmap openPortBitmap;  // Open ports of the current/last scan, guarded by portScanMutex
+static uint32_t scanTarget = 0;
+static TaskHandle_t portScanTaskHandle = nullptr;
+static SemaphoreHandle_t portScanMutex = nullptr;
+static QueueHandle_t portScanEvents = nullptr;  // Scan task -> web event stream
+static uint8_t lastProgressEvent = 0;           // Scan task only
+static volatile bool portScanCancel = false;
+
 // ==========================================
 // PORT SCANNER INITIALIZATION
 // ==========================================
@@ -103,7 +1359,21 @@ void initializePortScanner() {
     lastPortScanResults.scanCompleted = false;
     lastPortScanResults.openPorts = 0;
     lastPortScanResults.closedPorts = 0;
+    lastPortScanResults.filteredPorts = 0;
+    lastPortScanResults.openFilteredPorts = 0;
     lastPortScanResults.portsScanned = 0;
+    lastPortScanResults.totalPorts = 0;
+    lastPortScanResults.openListCount = 0;
+    lastPortScanResults.identifying = false;
+    lastPortScanResults.servicesIdentified = 0;
+    serviceCacheClear(serviceCache);
+    
+    if (portScanMutex == nullptr) {
+        portScanMutex = xSemaphoreCreateMutex();
+    }
+    if (portScanEvents == nullptr) {
+        portScanEvents = xQueueCreate(PORTSCAN_EVENT_QUEUE_SIZE, sizeof(PortScanEvent));
+    }
     
     LOG_INFO(TAG_PORTSCAN, "Port scanner initialized");
 }
@@ -132,12 +1402,230 @@ bool isPortOpen(const String& targetIP, uint16_t port, uint32_t timeout) {
     return false;
 }
 
+// ==========================================
+// BACKGROUND SCAN TASK
+// ==========================================
+
+// Never blocks the scan: with nobody draining the queue, events are dropped
+static void queuePortScanEvent(PortScanEventType type, uint16_t port, uint32_t value,
+                               const char* service = nullptr, const char* detail = nullptr,
+                               bool fingerprinted = false) {
+    if (portScanEvents == nullptr) {
+        return;
+    }
+    PortScanEvent event;
+    event.type = type;
+    event.port = port;
+    event.value = value;
+    event.service = service;
+    event.fingerprinted = fingerprinted;
+    snprintf(event.detail, sizeof(event.detail), "%s", detail != nullptr ? detail : "");
+    xQueueSend(portScanEvents, &event, 0);
+}
+
+static void recordPortResult(uint16_t port, PortScanOutcome outcome, uint32_t elapsed_us, void* context) {
+    const PortScanSession* session = static_cast<const PortScanSession*>(context);
+    if (xSemaphoreTake(portScanMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    
+    lastPortScanResults.portsScanned++;
+    uint8_t progress = lastPortScanResults.totalPorts > 0
+        ? (uint8_t)((uint64_t)lastPortScanResults.portsScanned * 100 / lastPortScanResults.totalPorts) : 0;
+    const char* udpService = session->protocol == PORTSCAN_PROTO_UDP ? portScanUdpService(port) : nullptr;
+    if (outcome == PORT_OUTCOME_OPEN) {
+        portBitmapSet(openPortBitmap, port);
+        if (lastPortScanResults.openListCount < PORTSCAN_OPEN_LIST_SIZE) {
+            PortInfo& info = lastPortScanResults.openPortsList[lastPortScanResults.openListCount++];
+            info.port = port;
+            info.isOpen = true;
+            info.service = getServiceName(port, session->protocol);
+            info.responseTime = elapsed_us / 1000;
+            info.fingerprinted = udpService != nullptr;  // It answered the protocol's own request
+            info.banner[0] = '\0';
+        }
+        lastPortScanResults.openPorts++;
+    } else if (outcome == PORT_OUTCOME_CLOSED) {
+        lastPortScanResults.closedPorts++;
+    } else if (outcome == PORT_OUTCOME_OPEN_FILTERED) {
+        lastPortScanResults.openFilteredPorts++;
+    } else {
+        // Silence and ICMP unreachable both leave the port state unknown
+        lastPortScanResults.filteredPorts++;
+    }
+    lastPortScanResults.smoothedRttMs = session->srtt_us / 1000;
+    lastPortScanResults.probeTimeoutMs = portScanProbeTimeoutMs(*session);
+    xSemaphoreGive(portScanMutex);
+    
+    if (outcome == PORT_OUTCOME_OPEN) {
+        const char* service = getServiceName(port, session->protocol);
+        queuePortScanEvent(PORTSCAN_EVENT_OPEN, port, elapsed_us / 1000, service, nullptr, udpService != nullptr);
+        LOG_INFO(TAG_PORTSCAN, "Found open port: %d (%s, %lu ms)", port, service, (unsigned long)(elapsed_us / 1000));
+    }
+    if (progress != lastProgressEvent) {
+        // At most 100 per scan, however many ports it covers
+        lastProgressEvent = progress;
+        queuePortScanEvent(PORTSCAN_EVENT_PROGRESS, 0, progress);
+    }
+}
+
+// Second pass over the listed open ports; returns false if cancelled
+static bool fingerprintOpenPorts() {
+    uint8_t count = 0;
+    if (xSemaphoreTake(portScanMutex, portMAX_DELAY) == pdTRUE) {
+        count = lastPortScanResults.openListCount;
+        for (uint8_t i = 0; i < count; i++) {
+            bannerServices[i].port = lastPortScanResults.openPortsList[i].port;
+        }
+        lastPortScanResults.identifying = count > 0;
+        xSemaphoreGive(portScanMutex);
+    }
+    if (count == 0) {
+        return true;
+    }
+    
+    LOG_INFO(TAG_PORTSCAN, "Fingerprinting %u open ports", count);
+    bool finished = portScanGrabBanners(scanTarget, bannerServices, count, activePortScanConfig.window,
+                                        activePortScanConfig.timeout, &serviceCache, &portScanCancel);
+    
+    if (xSemaphoreTake(portScanMutex, portMAX_DELAY) == pdTRUE) {
+        for (uint8_t i = 0; finished && i < count; i++) {
+            const ServiceInfo& service = bannerServices[i];
+            PortInfo& info = lastPortScanResults.openPortsList[i];
+            if (service.service == nullptr) continue;
+            info.fingerprinted = true;
+            info.service = service.service;
+            memcpy(info.banner, service.detail, sizeof(info.banner));
+            lastPortScanResults.servicesIdentified++;
+            queuePortScanEvent(PORTSCAN_EVENT_SERVICE, service.port, 0, service.service, service.detail, true);
+        }
+        lastPortScanResults.identifying = false;
+        xSemaphoreGive(portScanMutex);
+    }
+    if (finished) {
+        LOG_INFO(TAG_PORTSCAN, "Identified %u of %u services", lastPortScanResults.servicesIdentified, count);
+    }
+    return finished;
+}
+
+static void portScanTask(void* parameter) {
+    PortScanSession session;
+    portScanBegin(session, scanTarget, portsToScan, activePortScanConfig.window,
+                  activePortScanConfig.timeout, activePortScanConfig.protocol);
+    session.on_result = recordPortResult;
+    session.context = &session;
+    session.cancel = &portScanCancel;
+    
+    bool finished = portScanRun(session);
+    portScanEnd(session);
+    
+    if (finished && activePortScanConfig.grabBanners && activePortScanConfig.protocol == PORTSCAN_PROTO_TCP) {
+        finished = fingerprintOpenPorts();
+    }
+    
+    if (xSemaphoreTake(portScanMutex, portMAX_DELAY) == pdTRUE) {
+        lastPortScanResults.endTime = millis();
+        lastPortScanResults.scanCompleted = finished;
+        xSemaphoreGive(portScanMutex);
+    }
+    currentPortScanState = finished ? PORTSCAN_COMPLETED : PORTSCAN_IDLE;
+    queuePortScanEvent(PORTSCAN_EVENT_DONE, 0, finished ? 1 : 0);
+    
+    if (finished) {
+        unsigned long duration = lastPortScanResults.endTime - lastPortScanResults.startTime;
+        LOG_INFO(TAG_PORTSCAN, "Scan completed: %lu open, %lu closed, %lu filtered, %lu open|filtered "
+                 "(duration: %lu ms, SRTT %lu ms)",
+                 (unsigned long)lastPortScanResults.openPorts, (unsigned long)lastPortScanResults.closedPorts,
+                 (unsigned long)lastPortScanResults.filteredPorts,
+                 (unsigned long)lastPortScanResults.openFilteredPorts, duration,
+                 (unsigned long)lastPortScanResults.smoothedRttMs);
+    } else {
+        LOG_INFO(TAG_PORTSCAN, "Port scan stopped by user");
+    }
+    
+    portScanTaskHandle = nullptr;
+    vTaskDelete(nullptr);
+}
+
 // ==========================================
 // PORT SCAN OPERATIONS
 // ==========================================
 
-bool startPortScan(const String& targetIP, uint16_t startPort, uint16_t endPort, uint32_t timeout) {
-    if (currentPortScanState == PORTSCAN_RUNNING) {
+// Shared by both entry points once portsToScan and activePortScanConfig are set
+static bool launchPortScan() {
+    HostDiscoveryState discovery = getHostDiscoveryState();
+    if (discovery == HOSTDISC_SWEEPING || discovery == HOSTDISC_SCANNING) {
+        // Both need the same small lwIP socket budget
+        LOG_WARN(TAG_PORTSCAN, "Host discovery in progress");
+        return false;
+    }
+    
+    IPAddress targetAddress;
+    if (!dnsResolve(activePortScanConfig.targetIP, targetAddress)) {
+        LOG_ERROR(TAG_PORTSCAN, "Failed to resolve %s", activePortScanConfig.targetIP.c_str());
+        return false;
+    }
+    scanTarget = (uint32_t)targetAddress;
+    
+    if (portScanMutex == nullptr) {
+        portScanMutex = xSemaphoreCreateMutex();
+        if (portScanMutex == nullptr) {
+            LOG_ERROR(TAG_PORTSCAN, "Failed to create results mutex");
+            return false;
+        }
+    }
+    if (portScanEvents == nullptr) {
+        portScanEvents = xQueueCreate(PORTSCAN_EVENT_QUEUE_SIZE, sizeof(PortScanEvent));
+    } else {
+        xQueueReset(portScanEvents);  // Drop what the last scan left
+    }
+    lastProgressEvent = 0;
+    
+    if (xSemaphoreTake(portScanMutex, portMAX_DELAY) == pdTRUE) {
+        lastPortScanResults.targetIP = activePortScanConfig.targetIP;
+        lastPortScanResults.totalPorts = portSetCount(portsToScan);
+        lastPortScanResults.portsScanned = 0;
+        lastPortScanResults.openPorts = 0;
+        lastPortScanResults.closedPorts = 0;
+        lastPortScanResults.filteredPorts = 0;
+        lastPortScanResults.openFilteredPorts = 0;
+        lastPortScanResults.smoothedRttMs = 0;
+        lastPortScanResults.probeTimeoutMs = activePortScanConfig.timeout;
+        lastPortScanResults.startTime = millis();
+        lastPortScanResults.endTime = 0;
+        lastPortScanResults.scanCompleted = false;
+        lastPortScanResults.openListCount = 0;
+        lastPortScanResults.identifying = false;
+        lastPortScanResults.servicesIdentified = 0;
+        portBitmapClear(openPortBitmap);
+        xSemaphoreGive(portScanMutex);
+    }
+    
+    portScanCancel = false;
+    currentPortScanState = PORTSCAN_RUNNING;
+    
+    BaseType_t result = xTaskCreatePinnedToCore(
+        portScanTask,             // Task function
+        "PortScan",               // Task name
+        PORTSCAN_TASK_STACK,      // Stack size (bytes)
+        nullptr,                  // Task parameters
+        1,                        // Priority (same as loop)
+        &portScanTaskHandle,      // Task handle
+        1                         // Core ID (1 = app core)
+    );
+    
+    if (result != pdPASS) {
+        LOG_ERROR(TAG_PORTSCAN, "Failed to create port scan task");
+        portScanTaskHandle = nullptr;
+        currentPortScanState = PORTSCAN_ERROR;
+        return false;
+    }
+    return true;
+}
+
+bool startPortScan(const String& targetIP, uint16_t startPort, uint16_t endPort, uint32_t timeout, uint8_t window,
+                   bool grabBanners, PortScanProtocol protocol) {
+    if (portScanTaskHandle != nullptr) {
         LOG_WARN(TAG_PORTSCAN, "Scan already in progress");
         return false;
     }
@@ -148,7 +1636,7 @@ bool startPortScan(const String& targetIP, uint16_t startPort, uint16_t endPort,
     }
     
     // Validate port range
-    if (startPort > endPort || endPort > 65535) {
+    if (startPort == 0 || startPort > endPort) {
         LOG_ERROR(TAG_PORTSCAN, "Invalid port range: %d-%d", startPort, endPort);
         return false;
     }
@@ -158,35 +1646,28 @@ bool startPortScan(const String& targetIP, uint16_t startPort, uint16_t endPort,
     activePortScanConfig.startPort = startPort;
     activePortScanConfig.endPort = endPort;
     activePortScanConfig.timeout = timeout;
+    activePortScanConfig.window = window;
     activePortScanConfig.scanCommonOnly = false;
+    activePortScanConfig.grabBanners = grabBanners;
+    activePortScanConfig.protocol = protocol;
     
-    // Build port list
-    portsToScan.clear();
-    for (uint16_t p = startPort; p <= endPort; p++) {
-        portsToScan.push_back(p);
-    }
-    
-    // Initialize results
-    lastPortScanResults.targetIP = targetIP;
-    lastPortScanResults.totalPorts = portsToScan.size();
-    lastPortScanResults.portsScanned = 0;
-    lastPortScanResults.openPorts = 0;
-    lastPortScanResults.closedPorts = 0;
-    lastPortScanResults.startTime = millis();
-    lastPortScanResults.scanCompleted = false;
-    lastPortScanResults.openPortsList.clear();
+    // Describe the ports as a range; nothing is materialised per port
+    portSetClear(portsToScan);
+    portSetAddRange(portsToScan, startPort, endPort);
     
-    currentPortIndex = 0;
-    currentPortScanState = PORTSCAN_RUNNING;
+    if (!launchPortScan()) {
+        return false;
+    }
     
-    LOG_INFO(TAG_PORTSCAN, "Started port scan on %s (ports %d-%d, %d total)", 
-             targetIP.c_str(), startPort, endPort, portsToScan.size());
+    LOG_INFO(TAG_PORTSCAN, "Started %s port scan on %s (ports %d-%d, %lu total, %d in flight)", 
+             protocol == PORTSCAN_PROTO_UDP ? "UDP" : "TCP", targetIP.c_str(), startPort, endPort,
+             (unsigned long)portSetCount(portsToScan), window);
     
     return true;
 }
 
-bool startCommonPortScan(const String& targetIP) {
-    if (currentPortScanState == PORTSCAN_RUNNING) {
+bool startCommonPortScan(const String& targetIP, bool grabBanners, PortScanProtocol protocol) {
+    if (portScanTaskHandle != nullptr) {
         LOG_WARN(TAG_PORTSCAN, "Scan already in progress");
         return false;
     }
@@ -201,83 +1682,30 @@ bool startCommonPortScan(const String& targetIP) {
     activePortScanConfig.startPort = 0;
     activePortScanConfig.endPort = 0;
     activePortScanConfig.timeout = DEFAULT_SCAN_TIMEOUT;
+    activePortScanConfig.window = CONCURRENT_CONNECTIONS;
     activePortScanConfig.scanCommonOnly = true;
+    activePortScanConfig.grabBanners = grabBanners;
+    activePortScanConfig.protocol = protocol;
     
-    // Build port list from common ports
-    portsToScan = getCommonPorts();
-    
-    // Initialize results
-    lastPortScanResults.targetIP = targetIP;
-    lastPortScanResults.totalPorts = portsToScan.size();
-    lastPortScanResults.portsScanned = 0;
-    lastPortScanResults.openPorts = 0;
-    lastPortScanResults.closedPorts = 0;
-    lastPortScanResults.startTime = millis();
-    lastPortScanResults.scanCompleted = false;
-    lastPortScanResults.openPortsList.clear();
+    // Build port set from the service table's common ports
+    getCommonPorts(portsToScan, protocol);
     
-    currentPortIndex = 0;
-    currentPortScanState = PORTSCAN_RUNNING;
+    if (!launchPortScan()) {
+        return false;
+    }
     
-    LOG_INFO(TAG_PORTSCAN, "Started common port scan on %s (%d ports)", 
-             targetIP.c_str(), portsToScan.size());
+    LOG_INFO(TAG_PORTSCAN, "Started common %s port scan on %s (%lu ports)", 
+             protocol == PORTSCAN_PROTO_UDP ? "UDP" : "TCP", targetIP.c_str(),
+             (unsigned long)portSetCount(portsToScan));
     
     return true;
 }
 
 void stopPortScan() {
-    if (currentPortScanState == PORTSCAN_RUNNING) {
-        currentPortScanState = PORTSCAN_IDLE;
-        LOG_INFO(TAG_PORTSCAN, "Port scan stopped by user");
-    }
-}
-
-// ==========================================
-// BACKGROUND SCAN PROCESSING
-// ==========================================
-
-void handlePortScanTasks() {
-    if (currentPortScanState != PORTSCAN_RUNNING) {
-        return;
-    }
-    
-    // Check if scan is complete
-    if (currentPortIndex >= portsToScan.size()) {
-        lastPortScanResults.endTime = millis();
-        lastPortScanResults.scanCompleted = true;
-        currentPortScanState = PORTSCAN_COMPLETED;
-        
-        unsigned long duration = (lastPortScanResults.endTime - lastPortScanResults.startTime) / 1000;
-        LOG_INFO(TAG_PORTSCAN, "Scan completed: %d open, %d closed (duration: %lu seconds)",
-                 lastPortScanResults.openPorts, lastPortScanResults.closedPorts, duration);
-        return;
-    }
-    
-    // Scan current port
-    uint16_t port = portsToScan[currentPortIndex];
-    bool isOpen = isPortOpen(activePortScanConfig.targetIP, port, activePortScanConfig.timeout);
-    
-    lastPortScanResults.portsScanned++;
-    
-    if (isOpen) {
-        PortInfo info;
-        info.port = port;
-        info.isOpen = true;
-        info.service = getServiceName(port);
-        info.responseTime = activePortScanConfig.timeout;
-        
-        lastPortScanResults.openPortsList.push_back(info);
-        lastPortScanResults.openPorts++;
-        
-        LOG_INFO(TAG_PORTSCAN, "Found open port: %d (%s)", port, info.service.c_str());
-    } else {
-        lastPortScanResults.closedPorts++;
+    if (portScanTaskHandle != nullptr) {
+        // The scan task closes its sockets and moves to IDLE
+        portScanCancel = true;
     }
-    
-    currentPortIndex++;
-    
-    // Small delay to prevent overwhelming the network
-    delay(10);
 }
 
 // ==========================================
@@ -289,7 +1717,34 @@ PortScanState getPortScanState() {
 }
 
 PortScanResults getLastPortScanResults() {
-    return lastPortScanResults;
+    if (portScanMutex == nullptr || xSemaphoreTake(portScanMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return lastPortScanResults;
+    }
+    PortScanResults snapshot = lastPortScanResults;
+    xSemaphoreGive(portScanMutex);
+    return snapshot;
+}
+
+uint16_t getOpenPorts(uint16_t* ports, uint16_t maxPorts, uint16_t after) {
+    if (portScanMutex == nullptr || xSemaphoreTake(portScanMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return 0;
+    }
+    uint16_t count = 0;
+    for (uint32_t port = (uint32_t)after + 1; port <= 65535 && count < maxPorts; port++) {
+        if (openPortBitmap.bits[port >> 3] == 0) {
+            port |= 7;  // Skip the whole empty byte
+            continue;
+        }
+        if (portBitmapTest(openPortBitmap, (uint16_t)port)) {
+            ports[count++] = (uint16_t)port;
+        }
+    }
+    xSemaphoreGive(portScanMutex);
+    return count;
+}
+
+bool getPortScanEvent(PortScanEvent& event) {
+    return portScanEvents != nullptr && xQueueReceive(portScanEvents, &event, 0) == pdTRUE;
 }
 
 uint8_t getPortScanProgress() {
@@ -298,3 +1753,4 @@ uint8_t getPortScanProgress() {
     }
     return (lastPortScanResults.portsScanned * 100) / lastPortScanResults.totalPorts;
 }
+#endif
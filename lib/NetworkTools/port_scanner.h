@@ -1,12 +1,37 @@
 /**
  * @file port_scanner.h
  * @brief TCP port scanning and service discovery interface
- * 
+ *
  * This header defines structures and functions for network port scanning
- * and service identification. Supports concurrent port scanning with
- * configurable timeout and port ranges. Identifies common services
- * (HTTP, SSH, FTP, etc.) running on open ports.
- * 
+ * and service identification. Ports are probed with non-blocking connects:
+ * a configurable window of connects is kept in flight and polled with
+ * select(), so scan time is bounded by RTT and window size rather than
+ * ports x timeout. Per-probe timeouts adapt to the measured RTT (smoothed
+ * RTT plus four variances, as in TCP and nmap), and silent ports are
+ * reported as filtered rather than closed. Identifies common services (HTTP, SSH, FTP, etc.)
+ * running on open ports.
+ *
+ * Port sets are range lists (optionally masked by a bitmap) iterated lazily,
+ * and results go into a bitmap plus a short detail list, so memory use is
+ * the same for 16 ports and for 1-65535.
+ *
+ * UDP mode sends a protocol-specific payload where one is known (DNS, NTP,
+ * SNMP, mDNS, SSDP, ...), counts any reply as open, ICMP port unreachable
+ * (seen on a raw ICMP socket, or as ECONNREFUSED on Linux) as closed, and
+ * silence after the retries as open|filtered. It shares the window, adaptive
+ * timeouts, retries and optional probe pacing with TCP.
+ *
+ * An optional fingerprinting pass reconnects to the open ports, reads the
+ * greeting or sends a minimal probe (HTTP HEAD) and matches the reply against
+ * a compile-time signature table, so the service name reflects what is
+ * actually listening rather than the port number. Fingerprints are cached
+ * per host and port.
+ *
+ * The scan engine is portable BSD-socket code; the ESP32 runner executes it
+ * in its own FreeRTOS task and queues small live events (open port, progress
+ * step, identified service, completion) for push clients such as the web
+ * server's event stream. pc_test_apps/portscan_test runs the engine on Linux.
+ *
  * @author Arunkumar Mourougappane
  * @version 4.3.0
  * @date 2026-01-17
@@ -14,9 +39,14 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef ARDUINO
 #include <Arduino.h>
 #include <WiFi.h>
-#include <vector>
+#endif
 
 // ==========================================
 // PORT SCANNER CONFIGURATION
@@ -25,7 +55,18 @@
 // Common port definitions
 #define MAX_PORTS_TO_SCAN 100
 #define DEFAULT_SCAN_TIMEOUT 1000  // milliseconds
-#define CONCURRENT_CONNECTIONS 5   // Number of simultaneous port checks
+#define CONCURRENT_CONNECTIONS 8   // Default number of connects in flight
+#define PORTSCAN_MAX_WINDOW 10     // lwIP has 16 sockets in total, shared with the web server
+#define PORTSCAN_MIN_TIMEOUT_MS 100 // Floor for adaptive probe timeouts
+#define PORTSCAN_MAX_RETRIES 1     // Extra attempts for a port that stayed silent
+#define PORTSCAN_MAX_RANGES 24     // Ranges per port set (common ports use 16)
+#define PORTSCAN_BITMAP_BYTES 8192 // One bit per port, 0-65535
+#define PORTSCAN_OPEN_LIST_SIZE 32 // Open ports kept with details; the bitmap has all of them
+#define PORTSCAN_BANNER_BUFFER 192 // Bytes read per port while fingerprinting
+#define PORTSCAN_BANNER_DETAIL 40  // Version/server text kept per port
+#define PORTSCAN_SERVICE_CACHE_SIZE 32     // Fingerprints remembered across scans
+#define PORTSCAN_SERVICE_CACHE_TTL_S 600   // Re-probe after 10 minutes
+#define PORTSCAN_EVENT_QUEUE_SIZE 32       // Live events waiting for the consumer
 
 // ==========================================
 // PORT SCANNER STATE
@@ -38,6 +79,255 @@ enum PortScanState {
     PORTSCAN_ERROR
 };
 
+enum PortScanProtocol {
+    PORTSCAN_PROTO_TCP,
+    PORTSCAN_PROTO_UDP
+};
+
+enum PortScanOutcome {
+    PORT_OUTCOME_OPEN,       // Handshake completed (UDP: reply received)
+    PORT_OUTCOME_CLOSED,     // RST received (UDP: ICMP port unreachable)
+    PORT_OUTCOME_FILTERED,   // No answer: SYN (or SYN-ACK) dropped, e.g. by a firewall
+                             // (UDP: ICMP unreachable other than port)
+    PORT_OUTCOME_ERROR,      // Host/network unreachable, socket failure
+    PORT_OUTCOME_OPEN_FILTERED  // UDP only: no reply; open and silent, or dropped
+};
+
+// ==========================================
+// PORT SETS (portable)
+// ==========================================
+
+struct PortRange {
+    uint16_t first;
+    uint16_t last;           // Inclusive
+};
+
+struct PortBitmap {
+    uint8_t bits[PORTSCAN_BITMAP_BYTES];
+};
+
+inline void portBitmapClear(PortBitmap& bitmap) {
+    memset(bitmap.bits, 0, sizeof(bitmap.bits));
+}
+
+inline void portBitmapSet(PortBitmap& bitmap, uint16_t port) {
+    bitmap.bits[port >> 3] |= (uint8_t)(1 << (port & 7));
+}
+
+inline bool portBitmapTest(const PortBitmap& bitmap, uint16_t port) {
+    return (bitmap.bits[port >> 3] >> (port & 7)) & 1;
+}
+
+/**
+ * @brief Ports to scan: ranges in order, optionally restricted by a bitmap
+ */
+struct PortSet {
+    PortRange ranges[PORTSCAN_MAX_RANGES];
+    uint8_t range_count;
+    const PortBitmap* mask;  // Optional: only ports whose bit is set
+};
+
+struct PortSetCursor {
+    uint8_t range;
+    uint32_t next;           // Next candidate port in ranges[range]
+};
+
+/**
+ * @brief Empty a port set (no mask)
+ */
+void portSetClear(PortSet& set);
+
+/**
+ * @brief Append an inclusive range
+ * @return false if the range is invalid or the set is full
+ */
+bool portSetAddRange(PortSet& set, uint16_t first, uint16_t last);
+
+/**
+ * @brief Number of ports the set yields (honours the mask)
+ */
+uint32_t portSetCount(const PortSet& set);
+
+/**
+ * @brief Yield the next port of the set
+ * @param set Port set
+ * @param cursor Cursor, zero-initialised before the first call
+ * @param port Next port
+ * @return false when the set is exhausted
+ */
+bool portSetNext(const PortSet& set, PortSetCursor& cursor, uint16_t& port);
+
+// ==========================================
+// SCAN ENGINE (portable)
+// ==========================================
+
+/**
+ * @brief Called once per port as its probe completes (in completion order)
+ */
+typedef void (*PortScanResultCallback)(uint16_t port, PortScanOutcome outcome,
+                                       uint32_t elapsed_us, void* context);
+
+struct PortScanProbe {
+    int fd;                  // -1 when the slot is free
+    uint16_t port;
+    uint8_t attempt;         // 0 for the first connect
+    uint64_t started_us;
+    uint32_t timeout_us;     // Fixed when the connect starts
+};
+
+struct PortScanSession {
+    uint32_t target;         // Network byte order
+    PortScanProtocol protocol;
+    int icmp_fd;             // UDP: raw ICMP socket for port unreachables, -1 if unavailable
+    uint32_t probe_interval_us;  // Minimum gap between probe starts, 0 for none
+    uint64_t last_start_us;
+    uint8_t window;          // Connects kept in flight
+    uint32_t timeout_ms;     // Initial and maximum probe timeout
+    uint32_t min_timeout_ms;
+    uint8_t max_retries;
+    uint32_t srtt_us;        // Smoothed RTT of answered probes
+    uint32_t rttvar_us;      // RTT variance
+    uint32_t rtt_samples;    // 0: no RTT yet, probes use timeout_ms
+    const PortSet* ports;
+    uint32_t port_count;
+    PortSetCursor cursor;
+    bool has_next;           // next_port is waiting for a free slot
+    uint16_t next_port;
+    uint8_t in_flight;
+    PortScanProbe probes[PORTSCAN_MAX_WINDOW];
+    PortScanResultCallback on_result;
+    void* context;
+    volatile bool* cancel;   // Optional external stop flag
+};
+
+/**
+ * @brief Prepare a scan session
+ * @param session Session to initialise
+ * @param target Target address (network byte order)
+ * @param ports Ports to probe (must stay valid until portScanEnd)
+ * @param window Connects in flight (clamped to 1..PORTSCAN_MAX_WINDOW)
+ * @param timeout_ms Initial and maximum per-connect timeout; once probes are
+ *                   answered, timeouts follow SRTT + 4 * RTTVAR, floored at
+ *                   PORTSCAN_MIN_TIMEOUT_MS
+ * @param protocol TCP connect or UDP probes (UDP opens a raw ICMP socket
+ *                 when allowed; portScanEnd closes it)
+ */
+void portScanBegin(PortScanSession& session, uint32_t target, const PortSet& ports,
+                   uint8_t window, uint32_t timeout_ms, PortScanProtocol protocol = PORTSCAN_PROTO_TCP);
+
+/**
+ * @brief Probe all ports, reporting each through session.on_result
+ * @param session Prepared session
+ * @return false if cancelled
+ */
+bool portScanRun(PortScanSession& session);
+
+/**
+ * @brief Close any probes still in flight
+ */
+void portScanEnd(PortScanSession& session);
+
+/**
+ * @brief Timeout a probe started now would get (first attempt)
+ */
+uint32_t portScanProbeTimeoutMs(const PortScanSession& session);
+
+/**
+ * @brief Limit probe starts (retries included) to a rate
+ * @param probes_per_second 0 removes the limit
+ */
+void portScanSetRate(PortScanSession& session, uint32_t probes_per_second);
+
+/**
+ * @brief Service whose payload UDP probes send to a port
+ * @return Service name, or nullptr if the port gets an empty datagram
+ */
+const char* portScanUdpService(uint16_t port);
+
+// ==========================================
+// SERVICE NAMES (portable)
+// ==========================================
+
+/**
+ * @brief Registered service name for a port
+ *
+ * Binary search over a sorted table of a few hundred IANA (and widely used
+ * unofficial) assignments kept in flash; nothing is allocated.
+ *
+ * @param port Port number
+ * @param protocol Protocol the port was scanned with; a port registered for
+ *                 the other protocol only still returns that name
+ * @return Static service name, or "Unknown"
+ */
+const char* getServiceName(uint16_t port, PortScanProtocol protocol = PORTSCAN_PROTO_TCP);
+
+/**
+ * @brief Fill a port set with the ports the service table marks common
+ * @param protocol TCP: the 16 usual suspects; UDP: the ports with a probe payload
+ */
+void getCommonPorts(PortSet& set, PortScanProtocol protocol = PORTSCAN_PROTO_TCP);
+
+// ==========================================
+// SERVICE FINGERPRINTING (portable)
+// ==========================================
+
+struct ServiceInfo {
+    uint16_t port;
+    const char* service;     // nullptr: nothing came back; "unknown": unmatched reply
+    char detail[PORTSCAN_BANNER_DETAIL];  // Version or server text, safe for JSON/HTML
+    bool cached;             // Taken from the service cache, no connection made
+};
+
+struct ServiceCacheEntry {
+    uint32_t address;        // Network byte order, 0 when unused
+    uint16_t port;
+    const char* service;
+    char detail[PORTSCAN_BANNER_DETAIL];
+    uint32_t stamp_s;        // When the fingerprint was taken
+};
+
+/**
+ * @brief Fingerprints per host and port, oldest entry replaced when full
+ */
+struct ServiceCache {
+    ServiceCacheEntry entries[PORTSCAN_SERVICE_CACHE_SIZE];
+};
+
+/**
+ * @brief Empty a service cache
+ */
+void serviceCacheClear(ServiceCache& cache);
+
+/**
+ * @brief Identify the services on open ports
+ *
+ * Connects to each port, keeping up to window connections in flight. A port
+ * that sends nothing within half the timeout gets an HTTP HEAD request (ports
+ * that usually carry HTTP get it at once). The reply is matched against the
+ * signature table. Ports found in the cache are not contacted.
+ *
+ * @param target Target address (network byte order)
+ * @param services Ports to identify (port set); service/detail/cached are filled in
+ * @param count Number of entries
+ * @param window Connections in flight (clamped to 1..PORTSCAN_MAX_WINDOW)
+ * @param timeout_ms Time allowed per port
+ * @param cache Optional cache, consulted and updated
+ * @param cancel Optional external stop flag
+ * @return false if cancelled
+ */
+bool portScanGrabBanners(uint32_t target, ServiceInfo* services, uint16_t count, uint8_t window,
+                         uint32_t timeout_ms, ServiceCache* cache, volatile bool* cancel);
+
+/**
+ * @brief Match a reply against the signature table
+ * @param banner Bytes received
+ * @param length Number of bytes
+ * @param info Receives service and detail
+ * @return true if a signature matched
+ */
+bool portScanMatchBanner(const uint8_t* banner, size_t length, ServiceInfo& info);
+
+#ifdef ARDUINO
 // ==========================================
 // DATA STRUCTURES
 // ==========================================
@@ -45,8 +335,10 @@ enum PortScanState {
 struct PortInfo {
     uint16_t port;
     bool isOpen;
-    String service;      // Common service name for the port
-    uint32_t responseTime;  // Response time in milliseconds
+    const char* service; // Fingerprinted service, else the registered name for the port
+    uint32_t responseTime;  // Measured connect time in milliseconds
+    bool fingerprinted;  // Service identified from the port's reply
+    char banner[PORTSCAN_BANNER_DETAIL];  // Version/server text from the reply
 };
 
 struct PortScanConfig {
@@ -54,18 +346,44 @@ struct PortScanConfig {
     uint16_t startPort;
     uint16_t endPort;
     uint32_t timeout;
+    uint8_t window;       // Connects in flight
     bool scanCommonOnly;  // If true, scan only common ports
+    bool grabBanners;     // Fingerprint open ports after the scan (TCP)
+    PortScanProtocol protocol;
+};
+
+enum PortScanEventType {
+    PORTSCAN_EVENT_OPEN,       // port, value = response time in ms
+    PORTSCAN_EVENT_PROGRESS,   // value = percent scanned (one event per step)
+    PORTSCAN_EVENT_SERVICE,    // port, service and detail from fingerprinting
+    PORTSCAN_EVENT_DONE        // value = 1 completed, 0 stopped
+};
+
+struct PortScanEvent {
+    PortScanEventType type;
+    uint16_t port;
+    uint32_t value;
+    const char* service;       // Static name
+    bool fingerprinted;        // Service confirmed by the port's reply
+    char detail[PORTSCAN_BANNER_DETAIL];
 };
 
 struct PortScanResults {
     String targetIP;
-    uint16_t totalPorts;
-    uint16_t portsScanned;
-    uint16_t openPorts;
-    uint16_t closedPorts;
+    uint32_t totalPorts;
+    uint32_t portsScanned;
+    uint32_t openPorts;
+    uint32_t closedPorts;       // Answered with RST
+    uint32_t filteredPorts;     // No answer or unreachable
+    uint32_t openFilteredPorts; // UDP: no reply
+    uint32_t smoothedRttMs;     // Current SRTT of the target
+    uint32_t probeTimeoutMs;    // Current adaptive probe timeout
     unsigned long startTime;
     unsigned long endTime;
-    std::vector<PortInfo> openPortsList;
+    PortInfo openPortsList[PORTSCAN_OPEN_LIST_SIZE];  // First open ports found, with timing
+    uint8_t openListCount;
+    bool identifying;           // Fingerprinting pass running
+    uint8_t servicesIdentified;
     bool scanCompleted;
 };
 
@@ -87,32 +405,35 @@ extern PortScanResults lastPortScanResults;
 void initializePortScanner();
 
 /**
- * @brief Start a port scan
- * @param targetIP Target IP address to scan
+ * @brief Start a port scan in the background scan task
+ * @param targetIP Target IP address or hostname to scan
  * @param startPort Starting port number
  * @param endPort Ending port number
  * @param timeout Connection timeout in milliseconds
+ * @param window Number of connects kept in flight
+ * @param grabBanners Fingerprint the open ports after the scan (TCP only)
+ * @param protocol TCP connect or UDP scan
  * @return true if scan started successfully
  */
-bool startPortScan(const String& targetIP, uint16_t startPort, uint16_t endPort, uint32_t timeout = DEFAULT_SCAN_TIMEOUT);
+bool startPortScan(const String& targetIP, uint16_t startPort, uint16_t endPort,
+                   uint32_t timeout = DEFAULT_SCAN_TIMEOUT, uint8_t window = CONCURRENT_CONNECTIONS,
+                   bool grabBanners = false, PortScanProtocol protocol = PORTSCAN_PROTO_TCP);
 
 /**
  * @brief Start a scan of common ports only
  * @param targetIP Target IP address to scan
+ * @param grabBanners Fingerprint the open ports after the scan (TCP only)
+ * @param protocol TCP connect or UDP scan (UDP uses its own common port list)
  * @return true if scan started successfully
  */
-bool startCommonPortScan(const String& targetIP);
+bool startCommonPortScan(const String& targetIP, bool grabBanners = false,
+                         PortScanProtocol protocol = PORTSCAN_PROTO_TCP);
 
 /**
  * @brief Stop current port scan
  */
 void stopPortScan();
 
-/**
- * @brief Handle port scanning background tasks (call in loop)
- */
-void handlePortScanTasks();
-
 /**
  * @brief Get current port scan state
  * @return Current scan state
@@ -121,22 +442,37 @@ PortScanState getPortScanState();
 
 /**
  * @brief Get last port scan results
- * @return Last scan results structure
+ * @return Copy of the current or last scan results
  */
 PortScanResults getLastPortScanResults();
 
 /**
- * @brief Get scan progress percentage
- * @return Progress percentage (0-100)
+ * @brief Copy open ports of the current or last scan from the result bitmap
+ * @param ports Output buffer, ascending order
+ * @param maxPorts Buffer capacity
+ * @param after Only ports greater than this (for paging)
+ * @return Number of ports copied
  */
-uint8_t getPortScanProgress();
+uint16_t getOpenPorts(uint16_t* ports, uint16_t maxPorts, uint16_t after = 0);
 
 /**
- * @brief Get service name for a port number
- * @param port Port number
- * @return Service name or "Unknown"
+ * @brief Take the next live event of the current scan
+ *
+ * Events are queued by the scan task and dropped when nobody drains the
+ * queue, so a consumer that falls behind should re-read the full results
+ * (getLastPortScanResults) once it sees PORTSCAN_EVENT_DONE. Starting a scan
+ * discards events left from the previous one.
+ *
+ * @param event Receives the event
+ * @return false if no event is pending
+ */
+bool getPortScanEvent(PortScanEvent& event);
+
+/**
+ * @brief Get scan progress percentage
+ * @return Progress percentage (0-100)
  */
-String getServiceName(uint16_t port);
+uint8_t getPortScanProgress();
 
 /**
  * @brief Check if a specific port is open
@@ -146,10 +482,4 @@ String getServiceName(uint16_t port);
  * @return true if port is open
  */
 bool isPortOpen(const String& targetIP, uint16_t port, uint32_t timeout);
-
-// ==========================================
-// COMMON PORTS LIST
-// ==========================================
-
-// Returns list of common ports to scan
-std::vector<uint16_t> getCommonPorts();
+#endif
@@ -0,0 +1,558 @@
+/**
+ * @file traceroute.cpp
+ * @brief UDP/ICMP traceroute implementation
+ *
+ * This file implements hop-by-hop path analysis:
+ * - TTL-limited UDP or ICMP echo probes, several TTLs in flight at once
+ * - Reply matching via the datagram quoted in ICMP errors
+ * - Per-hop last/min/avg/max latency and loss across rounds (MTR mode)
+ * - Background FreeRTOS task, serial table and JSON export on the ESP32
+ *
+ * @author Arunkumar Mourougappane
+ * @version 3.0.0
+ * @date 2026-01-17
+ */
+
+#include "traceroute.h"
+#include <string.h>
+
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#include <WiFi.h>
+#include "logging.h"
+#include "dns_resolver.h"
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+// ==========================================
+// PROBE BOOKKEEPING
+// ==========================================
+enum ReplyKind {
+  REPLY_NONE = 0,
+  REPLY_HOP = 1,            // Time Exceeded from an intermediate router
+  REPLY_DESTINATION = 2,    // Port Unreachable / Echo Reply from the target
+  REPLY_UNREACHABLE = 3     // Other Destination Unreachable: path ends here
+};
+
+struct ProbeSlot {
+  uint16_t id;
+  uint8_t ttl;
+  uint8_t kind;
+  uint8_t code;
+  bool answered;
+  uint32_t responder;
+  uint64_t sent_us;
+  uint32_t rtt_us;
+};
+
+#define TRACEROUTE_MAX_WINDOW (TRACEROUTE_MAX_PARALLEL_HOPS * TRACEROUTE_MAX_PROBES_PER_HOP)
+
+static bool isCancelled(const TracerouteSession& session) {
+  return session.cancel != nullptr && *session.cancel;
+}
+
+// ==========================================
+// CONFIGURATION AND SETUP
+// ==========================================
+TracerouteConfig getDefaultTracerouteConfig(TracerouteProbeType type) {
+  TracerouteConfig config;
+  config.probe_type = type;
+  config.max_hops = TRACEROUTE_MAX_HOPS;
+  config.probes_per_hop = TRACEROUTE_DEFAULT_PROBES;
+  config.parallel_hops = TRACEROUTE_DEFAULT_PARALLEL;
+  config.timeout_ms = TRACEROUTE_DEFAULT_TIMEOUT_MS;
+  config.base_port = TRACEROUTE_BASE_PORT;
+  config.continuous = false;
+  config.interval_ms = TRACEROUTE_DEFAULT_INTERVAL_MS;
+  return config;
+}
+
+void tracerouteResetResults(TracerouteResults& results, uint32_t target, TracerouteProbeType type) {
+  memset(&results, 0, sizeof(results));
+  results.target = target;
+  results.probe_type = type;
+}
+
+float tracerouteHopLoss(const TracerouteHop& hop) {
+  if (hop.sent == 0) return 0.0f;
+  return (float)(hop.sent - hop.received) * 100.0f / hop.sent;
+}
+
+bool tracerouteBegin(TracerouteSession& session, uint32_t target, const TracerouteConfig& config) {
+  memset(&session, 0, sizeof(session));
+  session.udp_fd = -1;
+  session.config = config;
+  session.target = target;
+
+  // Clamp to the bookkeeping limits
+  TracerouteConfig& c = session.config;
+  if (c.max_hops == 0 || c.max_hops > TRACEROUTE_MAX_HOPS) c.max_hops = TRACEROUTE_MAX_HOPS;
+  if (c.probes_per_hop == 0) c.probes_per_hop = 1;
+  if (c.probes_per_hop > TRACEROUTE_MAX_PROBES_PER_HOP) c.probes_per_hop = TRACEROUTE_MAX_PROBES_PER_HOP;
+  if (c.parallel_hops == 0) c.parallel_hops = 1;
+  if (c.parallel_hops > TRACEROUTE_MAX_PARALLEL_HOPS) c.parallel_hops = TRACEROUTE_MAX_PARALLEL_HOPS;
+  if (c.timeout_ms == 0) c.timeout_ms = TRACEROUTE_DEFAULT_TIMEOUT_MS;
+  if (c.base_port == 0 || c.base_port > 65535 - TRACEROUTE_PROBE_ID_SPAN) c.base_port = TRACEROUTE_BASE_PORT;
+
+  // ICMP replies and errors for both probe types arrive on the raw socket
+  session.icmp_fd = icmpOpenRawSocket();
+  if (session.icmp_fd < 0) {
+    return false;
+  }
+
+  if (c.probe_type == TRACE_PROBE_UDP) {
+    session.udp_fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (session.udp_fd < 0) {
+      tracerouteEnd(session);
+      return false;
+    }
+
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = 0;
+    socklen_t localLen = sizeof(local);
+    if (bind(session.udp_fd, (struct sockaddr*)&local, sizeof(local)) < 0 ||
+        getsockname(session.udp_fd, (struct sockaddr*)&local, &localLen) < 0) {
+      tracerouteEnd(session);
+      return false;
+    }
+    // Quoted UDP source port identifies our probes
+    session.ident = ntohs(local.sin_port);
+  } else {
+    session.ident = (uint16_t)((icmpMonotonicMicros() >> 4) | 1);
+  }
+
+  return true;
+}
+
+void tracerouteEnd(TracerouteSession& session) {
+  icmpCloseSocket(session.icmp_fd);
+  session.icmp_fd = -1;
+  if (session.udp_fd >= 0) {
+    close(session.udp_fd);
+    session.udp_fd = -1;
+  }
+}
+
+// ==========================================
+// PROBING
+// ==========================================
+static bool sendProbe(TracerouteSession& session, ProbeSlot& slot) {
+  slot.sent_us = icmpMonotonicMicros();
+
+  if (session.config.probe_type == TRACE_PROBE_ICMP) {
+    if (!icmpSetTtl(session.icmp_fd, slot.ttl)) return false;
+    return icmpSendEchoRequest(session.icmp_fd, session.target, session.ident, slot.id,
+                               TRACEROUTE_PAYLOAD_SIZE);
+  }
+
+  if (!icmpSetTtl(session.udp_fd, slot.ttl)) return false;
+
+  uint8_t payload[TRACEROUTE_PAYLOAD_SIZE];
+  memset(payload, 0, sizeof(payload));
+  payload[0] = slot.ttl;
+
+  struct sockaddr_in dest;
+  memset(&dest, 0, sizeof(dest));
+  dest.sin_family = AF_INET;
+  dest.sin_addr.s_addr = session.target;
+  dest.sin_port = htons(session.config.base_port + slot.id);
+  return sendto(session.udp_fd, payload, sizeof(payload), 0, (struct sockaddr*)&dest, sizeof(dest)) ==
+         (int)sizeof(payload);
+}
+
+/**
+ * @brief Map an ICMP message to the probe id it answers
+ * @return Probe id, or -1 if the message is not for this session
+ */
+static int matchProbeId(const TracerouteSession& session, const IcmpMessage& msg) {
+  if (session.config.probe_type == TRACE_PROBE_ICMP) {
+    if (msg.type == ICMP_TYPE_ECHO_REPLY) {
+      if (msg.id != session.ident || msg.source != session.target) return -1;
+      return msg.sequence;
+    }
+    if (!msg.has_quote || msg.quoted_protocol != ICMP_PROTO_ICMP) return -1;
+    if (msg.quoted_id != session.ident || msg.quoted_destination != session.target) return -1;
+    return msg.quoted_sequence;
+  }
+
+  if (!msg.has_quote || msg.quoted_protocol != ICMP_PROTO_UDP) return -1;
+  if (msg.quoted_src_port != session.ident || msg.quoted_destination != session.target) return -1;
+  if (msg.quoted_dst_port < session.config.base_port ||
+      msg.quoted_dst_port >= session.config.base_port + TRACEROUTE_PROBE_ID_SPAN) {
+    return -1;
+  }
+  return msg.quoted_dst_port - session.config.base_port;
+}
+
+static uint8_t classifyReply(const TracerouteSession& session, const IcmpMessage& msg) {
+  switch (msg.type) {
+    case ICMP_TYPE_TIME_EXCEEDED:
+      return REPLY_HOP;
+    case ICMP_TYPE_ECHO_REPLY:
+      return REPLY_DESTINATION;
+    case ICMP_TYPE_DEST_UNREACHABLE:
+      if (msg.source == session.target &&
+          (msg.code == ICMP_CODE_PORT_UNREACHABLE || msg.code == ICMP_CODE_PROTOCOL_UNREACHABLE)) {
+        return REPLY_DESTINATION;
+      }
+      return REPLY_UNREACHABLE;
+    default:
+      return REPLY_NONE;
+  }
+}
+
+static void collectReplies(TracerouteSession& session, ProbeSlot* slots, size_t count) {
+  uint64_t deadline = icmpMonotonicMicros() + (uint64_t)session.config.timeout_ms * 1000ULL;
+  size_t pending = count;
+
+  while (pending > 0 && !isCancelled(session)) {
+    uint64_t now = icmpMonotonicMicros();
+    if (now >= deadline) break;
+    if (!icmpWaitReadable(session.icmp_fd, (uint32_t)(deadline - now))) continue;
+
+    IcmpMessage msg;
+    int rc;
+    while ((rc = icmpReceive(session.icmp_fd, msg)) >= 0) {
+      uint64_t arrival = icmpMonotonicMicros();
+      if (rc == 0) continue;
+
+      int id = matchProbeId(session, msg);
+      uint8_t kind = classifyReply(session, msg);
+      if (id < 0 || kind == REPLY_NONE) continue;
+
+      for (size_t i = 0; i < count; i++) {
+        ProbeSlot& slot = slots[i];
+        if (slot.answered || slot.id != (uint16_t)id) continue;
+
+        slot.answered = true;
+        slot.kind = kind;
+        slot.code = msg.code;
+        slot.responder = msg.source;
+        slot.rtt_us = (uint32_t)(arrival - slot.sent_us);
+        pending--;
+        break;
+      }
+    }
+  }
+}
+
+static void applySlot(TracerouteHop& hop, const ProbeSlot& slot) {
+  hop.sent++;
+  if (!slot.answered) return;
+
+  float ms = slot.rtt_us / 1000.0f;
+  hop.received++;
+  hop.last_ms = ms;
+  if (hop.received == 1 || ms < hop.min_ms) hop.min_ms = ms;
+  if (ms > hop.max_ms) hop.max_ms = ms;
+  hop.total_ms += ms;
+  hop.avg_ms = hop.total_ms / hop.received;
+
+  if (hop.address != 0 && hop.address != slot.responder) {
+    hop.flags |= TRACE_HOP_MULTIPATH;
+  }
+  hop.address = slot.responder;
+
+  if (slot.kind == REPLY_DESTINATION) {
+    hop.flags |= TRACE_HOP_DESTINATION;
+  } else if (slot.kind == REPLY_UNREACHABLE) {
+    hop.flags |= TRACE_HOP_UNREACHABLE;
+    hop.unreachable_code = slot.code;
+  }
+}
+
+bool tracerouteRunRound(TracerouteSession& session, TracerouteResults& results) {
+  const TracerouteConfig& c = session.config;
+  ProbeSlot slots[TRACEROUTE_MAX_WINDOW];
+
+  // Once the destination answered, later MTR rounds stop at its hop
+  uint8_t limit = results.hop_count > 0 && results.destination_reached ? results.hop_count : c.max_hops;
+  uint8_t ttl = 1;
+
+  while (ttl <= limit) {
+    if (isCancelled(session)) return false;
+
+    uint8_t windowEnd = ttl + c.parallel_hops - 1;
+    if (windowEnd > limit) windowEnd = limit;
+
+    // Fire every probe for the window of TTLs back to back
+    size_t count = 0;
+    for (uint8_t t = ttl; t <= windowEnd; t++) {
+      for (uint8_t k = 0; k < c.probes_per_hop; k++) {
+        ProbeSlot& slot = slots[count++];
+        memset(&slot, 0, sizeof(slot));
+        slot.id = session.next_probe_id;
+        slot.ttl = t;
+        session.next_probe_id = (session.next_probe_id + 1) % TRACEROUTE_PROBE_ID_SPAN;
+        if (!sendProbe(session, slot)) return false;
+      }
+    }
+
+    collectReplies(session, slots, count);
+
+    // Probes past the first terminal hop also reach the target; ignore them
+    uint8_t terminal = 0;
+    bool terminalIsDestination = false;
+    for (size_t i = 0; i < count; i++) {
+      const ProbeSlot& slot = slots[i];
+      if (!slot.answered || (slot.kind != REPLY_DESTINATION && slot.kind != REPLY_UNREACHABLE)) continue;
+      if (terminal == 0 || slot.ttl < terminal) {
+        terminal = slot.ttl;
+        terminalIsDestination = slot.kind == REPLY_DESTINATION;
+      }
+    }
+
+    uint8_t applyEnd = terminal != 0 ? terminal : windowEnd;
+    for (size_t i = 0; i < count; i++) {
+      if (slots[i].ttl <= applyEnd) {
+        applySlot(results.hops[slots[i].ttl - 1], slots[i]);
+      }
+    }
+    if (applyEnd > results.hop_count) {
+      results.hop_count = applyEnd;
+    }
+
+    if (terminal != 0) {
+      results.destination_reached = results.destination_reached || terminalIsDestination;
+    }
+
+    if (session.on_progress != nullptr) {
+      session.on_progress(results, session.progress_context);
+    }
+
+    if (terminal != 0) break;
+    ttl = windowEnd + 1;
+  }
+
+  results.rounds++;
+  return true;
+}
+
+#ifdef ARDUINO
+// ==========================================
+// ESP32 RUNNER
+// ==========================================
+#define TAG_TRACE "Trace"
+#define TRACEROUTE_TASK_STACK 6144
+
+static TaskHandle_t traceTaskHandle = nullptr;
+static SemaphoreHandle_t traceMutex = nullptr;
+static volatile bool traceCancel = false;
+static TracerouteState traceState = TRACE_IDLE;
+static TracerouteResults traceResults;     // Published snapshot, guarded by traceMutex
+static TracerouteConfig traceConfig;
+static uint32_t traceTarget = 0;
+static char traceHost[64] = "";
+
+static void publishTracerouteResults(const TracerouteResults& results, void* context) {
+  if (xSemaphoreTake(traceMutex, portMAX_DELAY) == pdTRUE) {
+    traceResults = results;
+    xSemaphoreGive(traceMutex);
+  }
+}
+
+static void tracerouteTask(void* parameter) {
+  // Working copy lives outside the task stack
+  static TracerouteResults working;
+  TracerouteSession session;
+
+  tracerouteResetResults(working, traceTarget, traceConfig.probe_type);
+  publishTracerouteResults(working, nullptr);
+
+  if (!tracerouteBegin(session, traceTarget, traceConfig)) {
+    LOG_ERROR(TAG_TRACE, "Failed to open probe sockets");
+    traceState = TRACE_ERROR;
+    traceTaskHandle = nullptr;
+    vTaskDelete(nullptr);
+    return;
+  }
+  session.cancel = &traceCancel;
+  session.on_progress = publishTracerouteResults;
+
+  LOG_INFO(TAG_TRACE, "Traceroute to %s started", traceHost);
+
+  while (!traceCancel) {
+    if (!tracerouteRunRound(session, working)) break;
+    publishTracerouteResults(working, nullptr);
+    if (!traceConfig.continuous) break;
+
+    // MTR pause between rounds, staying responsive to stop requests
+    uint32_t waited = 0;
+    while (!traceCancel && waited < traceConfig.interval_ms) {
+      vTaskDelay(pdMS_TO_TICKS(50));
+      waited += 50;
+    }
+  }
+
+  tracerouteEnd(session);
+  publishTracerouteResults(working, nullptr);
+  traceState = TRACE_COMPLETED;
+
+  printTracerouteResults(working);
+
+  traceTaskHandle = nullptr;
+  vTaskDelete(nullptr);
+}
+
+bool startTraceroute(const String& host, const TracerouteConfig& config) {
+  if (traceTaskHandle != nullptr) {
+    Serial.println("❌ Traceroute already running. Use 'trace stop' first.");
+    return false;
+  }
+
+  if (traceMutex == nullptr) {
+    traceMutex = xSemaphoreCreateMutex();
+    if (traceMutex == nullptr) {
+      LOG_ERROR(TAG_TRACE, "Failed to create results mutex");
+      return false;
+    }
+  }
+
+  IPAddress targetIP;
+  if (!dnsResolve(host, targetIP)) {
+    Serial.printf("❌ Failed to resolve %s\n", host.c_str());
+    return false;
+  }
+
+  strncpy(traceHost, host.c_str(), sizeof(traceHost) - 1);
+  traceHost[sizeof(traceHost) - 1] = '\0';
+  traceTarget = (uint32_t)targetIP;
+  traceConfig = config;
+  traceCancel = false;
+  traceState = TRACE_RUNNING;
+
+  BaseType_t result = xTaskCreatePinnedToCore(
+    tracerouteTask,           // Task function
+    "Traceroute",             // Task name
+    TRACEROUTE_TASK_STACK,    // Stack size (bytes)
+    nullptr,                  // Task parameters
+    1,                        // Priority (same as loop)
+    &traceTaskHandle,         // Task handle
+    1                         // Core ID (1 = app core)
+  );
+
+  if (result != pdPASS) {
+    LOG_ERROR(TAG_TRACE, "Failed to create traceroute task");
+    traceTaskHandle = nullptr;
+    traceState = TRACE_ERROR;
+    return false;
+  }
+
+  Serial.printf("🛰️ Tracing route to %s (%s), %s probes, max %u hops%s\n",
+                traceHost, targetIP.toString().c_str(),
+                config.probe_type == TRACE_PROBE_ICMP ? "ICMP" : "UDP", config.max_hops,
+                config.continuous ? ", continuous" : "");
+  return true;
+}
+
+void stopTraceroute() {
+  if (traceTaskHandle == nullptr) return;
+  traceCancel = true;
+  Serial.println("⏹️ Stopping traceroute...");
+}
+
+TracerouteState getTracerouteState() {
+  return traceState;
+}
+
+TracerouteResults getTracerouteResults() {
+  TracerouteResults snapshot;
+  tracerouteResetResults(snapshot, traceTarget, traceConfig.probe_type);
+  if (traceMutex != nullptr && xSemaphoreTake(traceMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
+    snapshot = traceResults;
+    xSemaphoreGive(traceMutex);
+  }
+  return snapshot;
+}
+
+String getTracerouteTarget() {
+  return String(traceHost);
+}
+
+static const char* unreachableSuffix(uint8_t code) {
+  switch (code) {
+    case ICMP_CODE_NET_UNREACHABLE: return "!N";
+    case ICMP_CODE_HOST_UNREACHABLE: return "!H";
+    case ICMP_CODE_PROTOCOL_UNREACHABLE: return "!P";
+    case ICMP_CODE_FRAG_NEEDED: return "!F";
+    case ICMP_CODE_ADMIN_PROHIBITED: return "!X";
+    default: return "!";
+  }
+}
+
+void printTracerouteResults(const TracerouteResults& results) {
+  IPAddress target(results.target);
+  Serial.printf("\n🛰️ === Traceroute to %s (%s) ===\n", traceHost, target.toString().c_str());
+  Serial.printf("Protocol: %s | Rounds: %u | Destination: %s\n",
+                results.probe_type == TRACE_PROBE_ICMP ? "ICMP" : "UDP", results.rounds,
+                results.destination_reached ? "reached" : "not reached");
+  Serial.println("Hop  Address           Loss%  Sent    Last     Avg     Min     Max");
+
+  for (uint8_t i = 0; i < results.hop_count; i++) {
+    const TracerouteHop& hop = results.hops[i];
+    if (hop.received == 0) {
+      Serial.printf("%3u  %-16s %5.1f%% %5u       *\n", i + 1, "???", tracerouteHopLoss(hop), hop.sent);
+      continue;
+    }
+
+    IPAddress addr(hop.address);
+    Serial.printf("%3u  %-16s %5.1f%% %5u %7.2f %7.2f %7.2f %7.2f %s%s\n", i + 1,
+                  addr.toString().c_str(), tracerouteHopLoss(hop), hop.sent,
+                  hop.last_ms, hop.avg_ms, hop.min_ms, hop.max_ms,
+                  (hop.flags & TRACE_HOP_UNREACHABLE) ? unreachableSuffix(hop.unreachable_code) : "",
+                  (hop.flags & TRACE_HOP_MULTIPATH) ? " (multipath)" : "");
+  }
+  Serial.println("==========================================\n");
+}
+
+String exportTracerouteJSON(const TracerouteResults& results) {
+  String json = "{";
+  json += "\"target\":\"" + String(traceHost) + "\",";
+  json += "\"ip\":\"" + IPAddress(results.target).toString() + "\",";
+  json += "\"state\":\"" + tracerouteStateToString(traceState) + "\",";
+  json += "\"protocol\":\"" + String(results.probe_type == TRACE_PROBE_ICMP ? "icmp" : "udp") + "\",";
+  json += "\"continuous\":" + String(traceConfig.continuous ? "true" : "false") + ",";
+  json += "\"rounds\":" + String(results.rounds) + ",";
+  json += "\"reached\":" + String(results.destination_reached ? "true" : "false") + ",";
+  json += "\"hops\":[";
+
+  for (uint8_t i = 0; i < results.hop_count; i++) {
+    const TracerouteHop& hop = results.hops[i];
+    if (i > 0) json += ",";
+    json += "{\"ttl\":" + String(i + 1);
+    json += ",\"ip\":\"" + (hop.received > 0 ? IPAddress(hop.address).toString() : String("")) + "\"";
+    json += ",\"sent\":" + String(hop.sent);
+    json += ",\"received\":" + String(hop.received);
+    json += ",\"loss\":" + String(tracerouteHopLoss(hop), 1);
+    json += ",\"last\":" + String(hop.last_ms, 2);
+    json += ",\"avg\":" + String(hop.avg_ms, 2);
+    json += ",\"min\":" + String(hop.min_ms, 2);
+    json += ",\"max\":" + String(hop.max_ms, 2);
+    json += ",\"destination\":" + String((hop.flags & TRACE_HOP_DESTINATION) ? "true" : "false");
+    json += ",\"multipath\":" + String((hop.flags & TRACE_HOP_MULTIPATH) ? "true" : "false");
+    json += ",\"unreachable\":\"" +
+            String((hop.flags & TRACE_HOP_UNREACHABLE) ? unreachableSuffix(hop.unreachable_code) : "") + "\"";
+    json += "}";
+  }
+
+  json += "]}";
+  return json;
+}
+
+String tracerouteStateToString(TracerouteState state) {
+  switch (state) {
+    case TRACE_IDLE: return "idle";
+    case TRACE_RUNNING: return "running";
+    case TRACE_COMPLETED: return "completed";
+    case TRACE_ERROR: return "error";
+    default: return "unknown";
+  }
+}
+#endif
@@ -0,0 +1,210 @@
+/**
+ * @file traceroute.h
+ * @brief UDP/ICMP traceroute with per-hop latency statistics
+ *
+ * Sends probes with increasing TTL and matches the ICMP Time Exceeded,
+ * Port Unreachable and Echo Reply messages that come back, so latency can
+ * be attributed to a specific hop. Probes for several TTLs are in flight at
+ * once, and each hop gets several probes per round. Continuous (MTR-style)
+ * mode keeps re-probing the path and accumulates min/avg/max/loss per hop.
+ *
+ * The probing engine uses only BSD sockets (see icmp_probe.h) and is also
+ * built on Linux by pc_test_apps/traceroute_test. The task runner, serial
+ * output and JSON export are ESP32-only.
+ *
+ * @author Arunkumar Mourougappane
+ * @version 3.0.0
+ * @date 2026-01-17
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "icmp_probe.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// ==========================================
+// TRACEROUTE CONFIGURATION
+// ==========================================
+#define TRACEROUTE_MAX_HOPS 30
+#define TRACEROUTE_MAX_PROBES_PER_HOP 5
+#define TRACEROUTE_MAX_PARALLEL_HOPS 8
+#define TRACEROUTE_DEFAULT_PROBES 3
+#define TRACEROUTE_DEFAULT_PARALLEL 4
+#define TRACEROUTE_DEFAULT_TIMEOUT_MS 2000
+#define TRACEROUTE_DEFAULT_INTERVAL_MS 1000
+#define TRACEROUTE_BASE_PORT 33434       // Classic traceroute destination port range
+#define TRACEROUTE_PROBE_ID_SPAN 1024    // Probe ids wrap at this; also the UDP port span
+#define TRACEROUTE_PAYLOAD_SIZE 24
+
+// ==========================================
+// TYPES AND STATES
+// ==========================================
+enum TracerouteProbeType {
+  TRACE_PROBE_UDP = 0,    // UDP to high ports, destination answers Port Unreachable
+  TRACE_PROBE_ICMP = 1    // ICMP echo, destination answers Echo Reply
+};
+
+enum TracerouteState {
+  TRACE_IDLE = 0,
+  TRACE_RUNNING = 1,
+  TRACE_COMPLETED = 2,
+  TRACE_ERROR = 3
+};
+
+// Hop flags
+#define TRACE_HOP_DESTINATION 0x01   // Responder is the target
+#define TRACE_HOP_UNREACHABLE 0x02   // Net/host/admin unreachable, path ends here
+#define TRACE_HOP_MULTIPATH 0x04     // Different responders seen for this TTL
+
+// ==========================================
+// DATA STRUCTURES
+// ==========================================
+struct TracerouteConfig {
+  TracerouteProbeType probe_type;
+  uint8_t max_hops;
+  uint8_t probes_per_hop;
+  uint8_t parallel_hops;        // TTLs probed simultaneously
+  uint16_t timeout_ms;          // Wait for replies per window of TTLs
+  uint16_t base_port;           // UDP destination port base
+  bool continuous;              // MTR mode: repeat rounds until stopped
+  uint32_t interval_ms;         // Pause between MTR rounds
+};
+
+struct TracerouteHop {
+  uint32_t address;             // Last responder (network byte order), 0 = none
+  uint32_t sent;
+  uint32_t received;
+  float last_ms;
+  float min_ms;
+  float max_ms;
+  float avg_ms;
+  float total_ms;               // Running sum behind avg_ms
+  uint8_t flags;
+  uint8_t unreachable_code;     // ICMP code when TRACE_HOP_UNREACHABLE
+};
+
+struct TracerouteResults {
+  uint32_t target;              // Network byte order
+  TracerouteProbeType probe_type;
+  uint8_t hop_count;            // Rows in hops[] that are meaningful
+  bool destination_reached;
+  uint32_t rounds;
+  TracerouteHop hops[TRACEROUTE_MAX_HOPS];   // hops[i] is TTL i + 1
+};
+
+/**
+ * @brief Engine state for one traceroute run
+ */
+struct TracerouteSession {
+  TracerouteConfig config;
+  uint32_t target;
+  int icmp_fd;                  // Receives all ICMP replies/errors; sends ICMP probes
+  int udp_fd;                   // Sends UDP probes
+  uint16_t ident;               // ICMP echo id / expected UDP source port
+  uint16_t next_probe_id;
+  volatile bool* cancel;        // Optional external stop flag
+
+  // Called after every window of TTLs so callers can publish progress
+  void (*on_progress)(const TracerouteResults& results, void* context);
+  void* progress_context;
+};
+
+// ==========================================
+// PROBING ENGINE (portable)
+// ==========================================
+
+/**
+ * @brief Get default traceroute configuration
+ * @param type Probe protocol
+ * @return Default configuration
+ */
+TracerouteConfig getDefaultTracerouteConfig(TracerouteProbeType type = TRACE_PROBE_UDP);
+
+/**
+ * @brief Open sockets and prepare a traceroute session
+ * @param session Session to initialise
+ * @param target Target address (network byte order)
+ * @param config Probe configuration (values are clamped to supported limits)
+ * @return true if sockets were opened
+ */
+bool tracerouteBegin(TracerouteSession& session, uint32_t target, const TracerouteConfig& config);
+
+/**
+ * @brief Probe the whole path once and merge replies into results
+ * @param session Open session
+ * @param results Accumulated per-hop statistics (call tracerouteResetResults first)
+ * @return false if cancelled or a socket error occurred
+ */
+bool tracerouteRunRound(TracerouteSession& session, TracerouteResults& results);
+
+/**
+ * @brief Close the session sockets
+ */
+void tracerouteEnd(TracerouteSession& session);
+
+/**
+ * @brief Clear results for a new run
+ */
+void tracerouteResetResults(TracerouteResults& results, uint32_t target, TracerouteProbeType type);
+
+/**
+ * @brief Packet loss for a hop in percent
+ */
+float tracerouteHopLoss(const TracerouteHop& hop);
+
+#ifdef ARDUINO
+// ==========================================
+// ESP32 RUNNER (task, serial, JSON)
+// ==========================================
+
+/**
+ * @brief Start a traceroute in a background task
+ * @param host Target hostname or IP address
+ * @param config Probe configuration
+ * @return true if the task was started
+ */
+bool startTraceroute(const String& host, const TracerouteConfig& config);
+
+/**
+ * @brief Stop a running traceroute (MTR runs only end this way)
+ */
+void stopTraceroute();
+
+/**
+ * @brief Get current traceroute state
+ */
+TracerouteState getTracerouteState();
+
+/**
+ * @brief Get a snapshot of the current or last traceroute results
+ */
+TracerouteResults getTracerouteResults();
+
+/**
+ * @brief Target host string of the current or last traceroute
+ */
+String getTracerouteTarget();
+
+/**
+ * @brief Print a per-hop table to serial
+ * @param results Results to print
+ */
+void printTracerouteResults(const TracerouteResults& results);
+
+/**
+ * @brief Export results to JSON format
+ * @param results Results to export
+ * @return JSON formatted string
+ */
+String exportTracerouteJSON(const TracerouteResults& results);
+
+/**
+ * @brief Convert traceroute state to string
+ */
+String tracerouteStateToString(TracerouteState state);
+#endif
@@ -0,0 +1,292 @@
+/**
+ * @file twamp_protocol.h
+ * @brief TWAMP-Light (RFC 5357) unauthenticated test packet codec
+ *
+ * Header-only encoder/decoder for the TWAMP-Light test packet formats so the
+ * firmware session-sender, the firmware reflector and the Linux reflector in
+ * pc_test_apps all share one wire implementation. Deliberately free of
+ * Arduino dependencies: only fixed-width integers and memcpy/memset.
+ *
+ * Wire formats (unauthenticated mode, all fields network byte order):
+ *
+ *   Session-Sender (14 bytes + padding)
+ *     0  Sequence Number            (4)
+ *     4  Timestamp                  (8)  NTP format
+ *    12  Error Estimate             (2)
+ *
+ *   Session-Reflector (41 bytes + padding)
+ *     0  Sequence Number            (4)
+ *     4  Timestamp (T3, transmit)   (8)
+ *    12  Error Estimate             (2)
+ *    14  MBZ                        (2)
+ *    16  Receive Timestamp (T2)     (8)
+ *    24  Sender Sequence Number     (4)
+ *    28  Sender Timestamp (T1)      (8)
+ *    36  Sender Error Estimate      (2)
+ *    38  MBZ                        (2)
+ *    40  Sender TTL                 (1)
+ *
+ * Round-trip time excluding reflector residence: (T4 - T1) - (T3 - T2).
+ * Only clock differences on each side are used, so sender and reflector
+ * clocks do not need to be synchronised.
+ *
+ * @author Arunkumar Mourougappane
+ * @version 3.0.0
+ * @date 2026-01-17
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ==========================================
+// PROTOCOL CONSTANTS
+// ==========================================
+#define TWAMP_LIGHT_DEFAULT_PORT 862          // IANA "twamp-control"; TWAMP-Light reuses it by convention
+#define TWAMP_SENDER_PACKET_SIZE 14           // Unauthenticated sender header
+#define TWAMP_REFLECTOR_PACKET_SIZE 41        // Unauthenticated reflector header
+#define TWAMP_MAX_PACKET_SIZE 1472            // Keep test packets inside a 1500 byte MTU
+#define TWAMP_NTP_UNIX_OFFSET 2208988800ULL   // Seconds from 1900-01-01 to 1970-01-01
+#define TWAMP_UNKNOWN_TTL 255                 // Reported when the receive TTL is unavailable
+
+// Error estimate: S(1) Z(1) Scale(6) Multiplier(8), RFC 4656 section 4.1.2
+#define TWAMP_ERROR_SYNC_BIT 0x8000
+#define TWAMP_ERROR_ESTIMATE_UNSYNCED 0x0001  // Unsynchronised, multiplier 1, scale 0
+#define TWAMP_ERROR_ESTIMATE_SYNCED (TWAMP_ERROR_SYNC_BIT | TWAMP_ERROR_ESTIMATE_UNSYNCED)
+
+// ==========================================
+// DATA STRUCTURES
+// ==========================================
+struct TwampTimestamp {
+  uint32_t seconds;    // Seconds since 1900-01-01 (NTP era 0)
+  uint32_t fraction;   // Binary fraction of a second
+};
+
+struct TwampSenderPacket {
+  uint32_t sequence;
+  TwampTimestamp timestamp;
+  uint16_t error_estimate;
+};
+
+struct TwampReflectorPacket {
+  uint32_t sequence;
+  TwampTimestamp timestamp;            // T3
+  uint16_t error_estimate;
+  TwampTimestamp receive_timestamp;    // T2
+  uint32_t sender_sequence;
+  TwampTimestamp sender_timestamp;     // T1
+  uint16_t sender_error_estimate;
+  uint8_t sender_ttl;
+};
+
+// ==========================================
+// BYTE ORDER HELPERS
+// ==========================================
+namespace twamp_detail {
+
+inline void put16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)(v >> 8);
+  p[1] = (uint8_t)v;
+}
+
+inline void put32(uint8_t* p, uint32_t v) {
+  p[0] = (uint8_t)(v >> 24);
+  p[1] = (uint8_t)(v >> 16);
+  p[2] = (uint8_t)(v >> 8);
+  p[3] = (uint8_t)v;
+}
+
+inline uint16_t get16(const uint8_t* p) {
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+inline uint32_t get32(const uint8_t* p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+inline void putTimestamp(uint8_t* p, const TwampTimestamp& ts) {
+  put32(p, ts.seconds);
+  put32(p + 4, ts.fraction);
+}
+
+inline TwampTimestamp getTimestamp(const uint8_t* p) {
+  TwampTimestamp ts;
+  ts.seconds = get32(p);
+  ts.fraction = get32(p + 4);
+  return ts;
+}
+
+}  // namespace twamp_detail
+
+// ==========================================
+// TIMESTAMP CONVERSION
+// ==========================================
+
+/**
+ * @brief Convert microseconds since the Unix epoch to an NTP timestamp
+ * @param unix_us Microseconds since 1970-01-01 (any monotonic base works for RTT)
+ * @return NTP formatted timestamp
+ */
+inline TwampTimestamp twampTimestampFromMicros(uint64_t unix_us) {
+  TwampTimestamp ts;
+  ts.seconds = (uint32_t)(unix_us / 1000000ULL + TWAMP_NTP_UNIX_OFFSET);
+  ts.fraction = (uint32_t)(((unix_us % 1000000ULL) << 32) / 1000000ULL);
+  return ts;
+}
+
+/**
+ * @brief Convert an NTP timestamp back to microseconds since the Unix epoch
+ * @param ts NTP formatted timestamp
+ * @return Microseconds since 1970-01-01
+ */
+inline uint64_t twampTimestampToMicros(const TwampTimestamp& ts) {
+  uint64_t seconds = (uint64_t)ts.seconds - TWAMP_NTP_UNIX_OFFSET;
+  uint64_t micros_part = ((uint64_t)ts.fraction * 1000000ULL + 0x80000000ULL) >> 32;
+  return seconds * 1000000ULL + micros_part;
+}
+
+/**
+ * @brief Signed difference a - b in microseconds
+ */
+inline int64_t twampTimestampDiffMicros(const TwampTimestamp& a, const TwampTimestamp& b) {
+  return (int64_t)(twampTimestampToMicros(a) - twampTimestampToMicros(b));
+}
+
+// ==========================================
+// ENCODE / DECODE
+// ==========================================
+
+/**
+ * @brief Encode a session-sender test packet
+ * @param buffer Output buffer
+ * @param buffer_len Size of output buffer
+ * @param packet_len Desired on-wire length (padded with zeros, minimum 14)
+ * @param packet Header fields to encode
+ * @return Encoded length, or 0 if the buffer is too small
+ */
+inline size_t twampEncodeSenderPacket(uint8_t* buffer, size_t buffer_len, size_t packet_len,
+                                      const TwampSenderPacket& packet) {
+  if (packet_len < TWAMP_SENDER_PACKET_SIZE) packet_len = TWAMP_SENDER_PACKET_SIZE;
+  if (buffer == nullptr || buffer_len < packet_len) return 0;
+
+  memset(buffer, 0, packet_len);
+  twamp_detail::put32(buffer, packet.sequence);
+  twamp_detail::putTimestamp(buffer + 4, packet.timestamp);
+  twamp_detail::put16(buffer + 12, packet.error_estimate);
+  return packet_len;
+}
+
+/**
+ * @brief Decode a session-sender test packet
+ * @return true if the datagram is long enough to hold the sender header
+ */
+inline bool twampDecodeSenderPacket(const uint8_t* buffer, size_t len, TwampSenderPacket& packet) {
+  if (buffer == nullptr || len < TWAMP_SENDER_PACKET_SIZE) return false;
+
+  packet.sequence = twamp_detail::get32(buffer);
+  packet.timestamp = twamp_detail::getTimestamp(buffer + 4);
+  packet.error_estimate = twamp_detail::get16(buffer + 12);
+  return true;
+}
+
+/**
+ * @brief Encode a session-reflector test packet
+ * @param buffer Output buffer
+ * @param buffer_len Size of output buffer
+ * @param packet_len Desired on-wire length (padded with zeros, minimum 41)
+ * @param packet Header fields to encode
+ * @return Encoded length, or 0 if the buffer is too small
+ */
+inline size_t twampEncodeReflectorPacket(uint8_t* buffer, size_t buffer_len, size_t packet_len,
+                                         const TwampReflectorPacket& packet) {
+  if (packet_len < TWAMP_REFLECTOR_PACKET_SIZE) packet_len = TWAMP_REFLECTOR_PACKET_SIZE;
+  if (buffer == nullptr || buffer_len < packet_len) return 0;
+
+  memset(buffer, 0, packet_len);
+  twamp_detail::put32(buffer, packet.sequence);
+  twamp_detail::putTimestamp(buffer + 4, packet.timestamp);
+  twamp_detail::put16(buffer + 12, packet.error_estimate);
+  twamp_detail::putTimestamp(buffer + 16, packet.receive_timestamp);
+  twamp_detail::put32(buffer + 24, packet.sender_sequence);
+  twamp_detail::putTimestamp(buffer + 28, packet.sender_timestamp);
+  twamp_detail::put16(buffer + 36, packet.sender_error_estimate);
+  buffer[40] = packet.sender_ttl;
+  return packet_len;
+}
+
+/**
+ * @brief Decode a session-reflector test packet
+ * @return true if the datagram is long enough to hold the reflector header
+ */
+inline bool twampDecodeReflectorPacket(const uint8_t* buffer, size_t len, TwampReflectorPacket& packet) {
+  if (buffer == nullptr || len < TWAMP_REFLECTOR_PACKET_SIZE) return false;
+
+  packet.sequence = twamp_detail::get32(buffer);
+  packet.timestamp = twamp_detail::getTimestamp(buffer + 4);
+  packet.error_estimate = twamp_detail::get16(buffer + 12);
+  packet.receive_timestamp = twamp_detail::getTimestamp(buffer + 16);
+  packet.sender_sequence = twamp_detail::get32(buffer + 24);
+  packet.sender_timestamp = twamp_detail::getTimestamp(buffer + 28);
+  packet.sender_error_estimate = twamp_detail::get16(buffer + 36);
+  packet.sender_ttl = buffer[40];
+  return true;
+}
+
+/**
+ * @brief Build the reflector reply for a received sender packet
+ *
+ * Reply length mirrors the request (RFC 6038 symmetric size) but never drops
+ * below the reflector header. The caller stamps T3 immediately before
+ * transmitting via twampStampReflectorTransmit().
+ *
+ * @param request Raw received datagram
+ * @param request_len Length of received datagram
+ * @param receive_time T2, captured as close to reception as possible
+ * @param reflector_sequence Reflector's own sequence counter value
+ * @param error_estimate Reflector clock error estimate
+ * @param sender_ttl IP TTL of the received datagram (TWAMP_UNKNOWN_TTL if unknown)
+ * @param reply Output buffer
+ * @param reply_len Size of output buffer
+ * @return Length of reply to send, or 0 if the request is not a TWAMP packet
+ */
+inline size_t twampBuildReflectorReply(const uint8_t* request, size_t request_len,
+                                       const TwampTimestamp& receive_time,
+                                       uint32_t reflector_sequence, uint16_t error_estimate,
+                                       uint8_t sender_ttl, uint8_t* reply, size_t reply_len) {
+  TwampSenderPacket sender;
+  if (!twampDecodeSenderPacket(request, request_len, sender)) return 0;
+
+  TwampReflectorPacket out;
+  out.sequence = reflector_sequence;
+  out.timestamp = receive_time;  // Overwritten by twampStampReflectorTransmit()
+  out.error_estimate = error_estimate;
+  out.receive_timestamp = receive_time;
+  out.sender_sequence = sender.sequence;
+  out.sender_timestamp = sender.timestamp;
+  out.sender_error_estimate = sender.error_estimate;
+  out.sender_ttl = sender_ttl;
+
+  size_t wanted = request_len > TWAMP_MAX_PACKET_SIZE ? TWAMP_MAX_PACKET_SIZE : request_len;
+  return twampEncodeReflectorPacket(reply, reply_len, wanted, out);
+}
+
+/**
+ * @brief Patch the transmit timestamp (T3) into an encoded reflector packet
+ */
+inline void twampStampReflectorTransmit(uint8_t* reply, const TwampTimestamp& transmit_time) {
+  twamp_detail::putTimestamp(reply + 4, transmit_time);
+}
+
+/**
+ * @brief Round-trip time with reflector residence time removed
+ * @param reply Decoded reflector packet
+ * @param arrival_time T4, sender clock at reception
+ * @return (T4 - T1) - (T3 - T2) in microseconds
+ */
+inline int64_t twampRoundTripMicros(const TwampReflectorPacket& reply, const TwampTimestamp& arrival_time) {
+  int64_t total = twampTimestampDiffMicros(arrival_time, reply.sender_timestamp);
+  int64_t residence = twampTimestampDiffMicros(reply.timestamp, reply.receive_timestamp);
+  return total - residence;
+}
@@ -5,6 +5,7 @@
  * Implements saving and loading of Station configuration using ESP32 NVS.
  * Includes support for WiFi credentials, auto-connect settings, and
  * security preferences (Auto, WPA3 Prefer, WPA3 Only, WPA2 Min, WPA2 Only).
+ * Also keeps the last good BSSID, channel and DHCP lease for fast reconnects.
  * Uses Base64 encoding for secure password storage.
  * 
  * @author Arunkumar Mourougappane
@@ -25,6 +26,7 @@ static const char* KEY_PASSWORD = "password";
 static const char* KEY_AUTO_CONNECT = "auto_connect";
 static const char* KEY_SEC_PREF = "sec_pref";
 static const char* KEY_VALID = "valid";
+static const char* KEY_CONNECT_CACHE = "fast_cache";
 
 // Default security preference (auto-negotiate)
 static const StationSecurityPreference DEFAULT_SEC_PREF = STA_SEC_AUTO;
@@ -164,6 +166,59 @@ bool clearStationConfig() {
     return success;
 }
 
+// ==========================================
+// FAST RECONNECT CACHE
+// ==========================================
+
+bool saveStationConnectCache(const StationConnectCache& cache) {
+    // Reconnects reuse the same values; avoid wearing the flash with rewrites
+    StationConnectCache saved;
+    if (loadStationConnectCache(cache.ssid, saved) && memcmp(&saved, &cache, sizeof(cache)) == 0) {
+        return true;
+    }
+    
+    if (!preferences.begin(NVS_NAMESPACE, false)) {
+        Serial.println("[Station Config] ERROR: Failed to open NVS for writing");
+        return false;
+    }
+    
+    bool success = preferences.putBytes(KEY_CONNECT_CACHE, &cache, sizeof(cache)) == sizeof(cache);
+    preferences.end();
+    
+    if (!success) {
+        Serial.println("[Station Config] ERROR: Failed to save fast reconnect cache");
+    }
+    return success;
+}
+
+bool loadStationConnectCache(const char* ssid, StationConnectCache& cache) {
+    if (!preferences.begin(NVS_NAMESPACE, true)) {
+        return false;
+    }
+    
+    // A blob of another size was written by firmware with a different layout
+    bool found = preferences.isKey(KEY_CONNECT_CACHE) &&
+                 preferences.getBytesLength(KEY_CONNECT_CACHE) == sizeof(cache) &&
+                 preferences.getBytes(KEY_CONNECT_CACHE, &cache, sizeof(cache)) == sizeof(cache);
+    preferences.end();
+    
+    if (!found) {
+        return false;
+    }
+    cache.ssid[sizeof(cache.ssid) - 1] = '\0';
+    return strcmp(cache.ssid, ssid) == 0 && cache.channel >= 1 && cache.channel <= 14;
+}
+
+bool clearStationConnectCache() {
+    if (!preferences.begin(NVS_NAMESPACE, false)) {
+        return false;
+    }
+    
+    bool success = !preferences.isKey(KEY_CONNECT_CACHE) || preferences.remove(KEY_CONNECT_CACHE);
+    preferences.end();
+    return success;
+}
+
 bool hasStationConfig() {
     if (!preferences.begin(NVS_NAMESPACE, true)) {
         return false;
@@ -218,5 +273,14 @@ void printStationConfig(const StationConfig& config) {
     Serial.printf("  Security:     %s\n", secPrefName);
     Serial.printf("  Auto-Connect: %s\n", config.autoConnect ? "Yes" : "No");
     Serial.printf("  Valid:        %s\n", config.isValid ? "Yes" : "No");
+    
+    StationConnectCache cache;
+    if (loadStationConnectCache(config.ssid, cache)) {
+        Serial.printf("  Last AP:      %02X:%02X:%02X:%02X:%02X:%02X (channel %u)\n", cache.bssid[0], cache.bssid[1],
+                      cache.bssid[2], cache.bssid[3], cache.bssid[4], cache.bssid[5], cache.channel);
+        if (cache.ip != 0) {
+            Serial.printf("  Last Lease:   %s\n", IPAddress(cache.ip).toString().c_str());
+        }
+    }
     Serial.println("==========================================");
 }
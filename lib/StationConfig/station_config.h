@@ -42,6 +42,25 @@ struct StationConfig {
     bool isValid;         // Configuration validity flag
 };
 
+/**
+ * @brief Last good association and DHCP lease for fast reconnects
+ * @details Saved after every successful connection. A later connect to the
+ *          same SSID joins this BSSID on this channel (no all-channel scan)
+ *          and bridges the join with the lease as a static IP until DHCP,
+ *          restarted once the link is up, renews it. Only DHCP-assigned
+ *          addresses are saved.
+ */
+struct StationConnectCache {
+    char ssid[33];        // SSID the cache belongs to
+    uint8_t bssid[6];     // Access point that accepted us
+    uint8_t channel;      // Its primary channel
+    uint8_t authMode;     // wifi_auth_mode_t it offered
+    uint32_t ip;          // DHCP lease (IPAddress values, 0 if none)
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+};
+
 // ==========================================
 // FUNCTION DECLARATIONS
 // ==========================================
@@ -78,6 +97,28 @@ bool clearStationConfig();
  */
 bool hasStationConfig();
 
+/**
+ * @brief Save the last good association and lease
+ * @details Skips the NVS write when nothing changed since the last save
+ * @param cache Association to save
+ * @return true if the cache is stored, false otherwise
+ */
+bool saveStationConnectCache(const StationConnectCache& cache);
+
+/**
+ * @brief Load the last good association for an SSID
+ * @param ssid SSID about to be joined
+ * @param cache Structure to populate
+ * @return true if a cache for this SSID exists, false otherwise
+ */
+bool loadStationConnectCache(const char* ssid, StationConnectCache& cache);
+
+/**
+ * @brief Forget the last good association (e.g. after a failed fast reconnect)
+ * @return true if clear successful, false otherwise
+ */
+bool clearStationConnectCache();
+
 /**
  * @brief Print current Station configuration
  * @param config Configuration to display
@@ -12,7 +12,7 @@
  * - iPerf performance testing with real-time updates
  * - System status dashboard with connection info
  * - Automatic web server restart on WiFi state changes
- * - Scan result caching for improved performance
+ * - Shared background scan results for scan, details and signal pages
  * 
  * @author Arunkumar Mourougappane
  * @version 1.0.0
@@ -25,14 +25,18 @@
 
 #include "wifi_manager.h"
 #include "wifi_task.h"
+#include "wifi_scan.h"
 #include "ap_manager.h"
 #include "ap_config.h"
 #include "station_config.h"
 #include "channel_analyzer.h"
 #include "iperf_manager.h"
 #include "latency_analyzer.h"
+#include "traceroute.h"
 #include "signal_monitor.h"
 #include "port_scanner.h"
+#include "host_discovery.h"
+#include "rogue_detector.h"
 #include "logging.h"
 #include <qrcode.h>
 
@@ -40,56 +44,55 @@
 WebServer* webServer = nullptr;
 bool webServerEnabled = false;
 
+static void pumpPortScanEvents();
+static void closePortScanStreams();
+
 // ==========================================
-// SCAN RESULT CACHING
+// SHARED SCAN RESULTS
 // ==========================================
-// Structure to cache scan results for details view
-struct CachedScanResult {
-    String ssid;
-    int32_t rssi;
-    uint8_t channel;
-    wifi_auth_mode_t encryptionType;
-    uint8_t bssid[6];
-    bool hasBssid;
-};
-
-#define MAX_CACHED_NETWORKS 50
-#define CACHE_TIMEOUT_MS 300000  // 5 minutes
-
-static CachedScanResult cachedNetworks[MAX_CACHED_NETWORKS];
-static int cachedNetworkCount = 0;
-static unsigned long lastScanTime = 0;
-
-// Check if cached results are still valid
-bool isCacheValid() {
-    return (cachedNetworkCount > 0 && (millis() - lastScanTime < CACHE_TIMEOUT_MS));
+// Scan pages start a background scan (see wifi_scan.h), then reload with
+// ?after=<generation> until the shared store moves past that generation.
+static bool scanPending(uint32_t after) {
+    return isWiFiScanRunning() && getWiFiScanGeneration() <= after;
 }
 
-// Cache scan results
-void cacheScanResults() {
-    cachedNetworkCount = WiFi.scanComplete();
-    if (cachedNetworkCount <= 0) return;
-    
-    if (cachedNetworkCount > MAX_CACHED_NETWORKS) {
-        cachedNetworkCount = MAX_CACHED_NETWORKS;
-    }
-    
-    for (int i = 0; i < cachedNetworkCount; i++) {
-        cachedNetworks[i].ssid = WiFi.SSID(i);
-        cachedNetworks[i].rssi = WiFi.RSSI(i);
-        cachedNetworks[i].channel = WiFi.channel(i);
-        cachedNetworks[i].encryptionType = WiFi.encryptionType(i);
-        
-        uint8_t* bssid = WiFi.BSSID(i);
-        if (bssid) {
-            memcpy(cachedNetworks[i].bssid, bssid, 6);
-            cachedNetworks[i].hasBssid = true;
+static void appendScanPending(String& html) {
+    html += F("<div style=\"text-align:center;padding:40px;color:#666\"><p style=\"font-size:1.2em\">🔄 Scanning...</p>");
+    html += F("<p style=\"font-size:0.9em\">Results appear as soon as the radio finishes</p></div>");
+    html += F("<script>setTimeout(function(){location.reload()},1000)</script>");
+}
+
+// SSIDs are arbitrary bytes: escape what would break a JSON string
+static void appendJsonString(String& json, const char* text) {
+    json += '"';
+    for (; *text; text++) {
+        char c = *text;
+        if (c == '"' || c == '\\') {
+            json += '\\';
+            json += c;
+        } else if ((uint8_t)c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", (uint8_t)c);
+            json += escaped;
         } else {
-            cachedNetworks[i].hasBssid = false;
+            json += c;
+        }
+    }
+    json += '"';
+}
+
+// Profiles and alerts hold SSIDs seen on the air: escape them in pages
+static void appendHtmlEscaped(String& html, const char* text) {
+    for (; *text; text++) {
+        switch (*text) {
+            case '<': html += F("&lt;"); break;
+            case '>': html += F("&gt;"); break;
+            case '&': html += F("&amp;"); break;
+            case '"': html += F("&quot;"); break;
+            case '\'': html += F("&#39;"); break;
+            default: html += *text; break;
         }
     }
-    
-    lastScanTime = millis();
 }
 
 // ==========================================
@@ -540,7 +543,7 @@ String generateHtmlFooter() {
 }
 
 // Generate common navigation menu - stored in PROGMEM
-const char NAV_MENU_START[] PROGMEM = "<div class=\"nav\"><div class=\"nav-container\"><div class=\"hamburger\" onclick=\"toggleMenu()\"><span></span><span></span><span></span></div><div class=\"page-title\" id=\"pageTitle\"></div><div class=\"nav-items\"><div><a href=\"/\">🏠 Home</a></div><div><a href=\"/status\">📊 Status</a></div><div><a href=\"/config\">⚙️ Config</a></div><div class=\"dropdown\"><a href=\"/analysis\">🔬 Analysis ▾</a><div class=\"dropdown-content\"><a href=\"/analysis\">📊 Dashboard</a><a href=\"/scan\">🔍 Network Scan</a><a href=\"/signal\">📶 Signal</a><a href=\"/portscan\">🔒 Port Scanner</a><a href=\"/iperf\">⚡ iPerf</a><a href=\"/latency\">📉 Latency</a><a href=\"/channel\">📡 Channel</a></div></div></div></div></div>";
+const char NAV_MENU_START[] PROGMEM = "<div class=\"nav\"><div class=\"nav-container\"><div class=\"hamburger\" onclick=\"toggleMenu()\"><span></span><span></span><span></span></div><div class=\"page-title\" id=\"pageTitle\"></div><div class=\"nav-items\"><div><a href=\"/\">🏠 Home</a></div><div><a href=\"/status\">📊 Status</a></div><div><a href=\"/config\">⚙️ Config</a></div><div class=\"dropdown\"><a href=\"/analysis\">🔬 Analysis ▾</a><div class=\"dropdown-content\"><a href=\"/analysis\">📊 Dashboard</a><a href=\"/scan\">🔍 Network Scan</a><a href=\"/signal\">📶 Signal</a><a href=\"/portscan\">🔒 Port Scanner</a><a href=\"/iperf\">⚡ iPerf</a><a href=\"/latency\">📉 Latency</a><a href=\"/traceroute\">🛰️ Traceroute</a><a href=\"/channel\">📡 Channel</a><a href=\"/rogue\">🛡️ Rogue APs</a></div></div></div></div></div>";
 
 String generateNav(const String& pageTitle = "") {
     String nav = FPSTR(NAV_MENU_START);
@@ -588,6 +591,7 @@ bool startWebServer() {
     webServer->on("/status", handleStatus);
     webServer->on("/scan", handleScan);
     webServer->on("/scan/details", handleScanDetails);  // New route for network details
+    webServer->on("/scan/events", handleScanEvents);
     webServer->on("/analysis", handleNetworkAnalysis);
     webServer->on("/channel", handleChannelAnalysis);
     webServer->on("/channel/scan", handleChannelScan);
@@ -596,6 +600,10 @@ bool startWebServer() {
     webServer->on("/latency/start", HTTP_POST, handleLatencyStart);
     webServer->on("/latency/stop", HTTP_GET, handleLatencyStop);
     webServer->on("/latency/status", HTTP_GET, handleLatencyStatusJSON);
+    webServer->on("/traceroute", handleTraceroute);
+    webServer->on("/traceroute/start", HTTP_POST, handleTracerouteStart);
+    webServer->on("/traceroute/stop", HTTP_GET, handleTracerouteStop);
+    webServer->on("/traceroute/status", HTTP_GET, handleTracerouteStatus);
     webServer->on("/iperf", handleIperf);
     webServer->on("/iperf/start", handleIperfStart);
     webServer->on("/iperf/stop", handleIperfStop);
@@ -608,11 +616,17 @@ bool startWebServer() {
     webServer->on("/mode/switch", HTTP_POST, handleModeSwitch);
     webServer->on("/signal", handleSignalMonitor);
     webServer->on("/signal/api", handleSignalStrengthAPI);
+    webServer->on("/rogue", handleRoguePage);
+    webServer->on("/rogue/api", handleRogueAPI);
+    webServer->on("/rogue/action", HTTP_POST, handleRogueAction);
     webServer->on("/portscan", handlePortScanner);
     webServer->on("/portscan/start", handlePortScanStart);
     webServer->on("/portscan/stop", handlePortScanStop);
     webServer->on("/portscan/status", handlePortScanStatus);
+    webServer->on("/portscan/events", handlePortScanEvents);
     webServer->on("/portscan/api", handlePortScanAPI);
+    webServer->on("/portscan/discover", handleHostDiscover);
+    webServer->on("/portscan/hosts", handleHostDiscoveryStatus);
     webServer->onNotFound(handleNotFound);
 
     // Start the server
@@ -633,6 +647,7 @@ void stopWebServer() {
     }
 
     Serial.println("🛑 Stopping web server...");
+    closePortScanStreams();
     webServer->stop();
     delete webServer;
     webServer = nullptr;
@@ -646,6 +661,7 @@ void stopWebServer() {
 void handleWebServerRequests() {
     if (webServer != nullptr && webServerEnabled) {
         webServer->handleClient();
+        pumpPortScanEvents();
     }
 }
 
@@ -1116,20 +1132,42 @@ void handleStatus() {
 // Scan page header - stored in PROGMEM
 const char SCAN_HEADER[] PROGMEM = R"rawliteral(<div class="header"><h1>🔍 Network Scan</h1></div><h2>📡 Available Networks</h2><div style="text-align:center;margin:20px 0"><button onclick="startScan('/scan?doscan=1','🔍 Scanning Networks...','Please wait while we discover nearby WiFi networks')" style="padding:15px 40px;background:linear-gradient(135deg,#667eea 0%,#764ba2 100%);color:white;border:none;border-radius:8px;font-size:1.1em;font-weight:bold;cursor:pointer;box-shadow:0 4px 12px rgba(102,126,234,0.4)">🔍 Start Network Scan</button></div>)rawliteral";
 
+// Live change feed under the scan list; polls /scan/events and renders with
+// textContent so SSIDs cannot inject markup
+const char SCAN_EVENTS_PANEL[] PROGMEM = R"rawliteral(<h2>🔄 Recent Changes</h2><p style="color:#666;font-size:0.9em">Networks that appeared, vanished, moved channel, changed security or signal between scans. Updates while scanning runs.</p><ul id="scanEvents" class="network-list"></ul><p id="scanEventsEmpty" style="text-align:center;color:#999">No changes recorded yet.</p><script>
+(function(){let cursor=0;const list=document.getElementById('scanEvents');const empty=document.getElementById('scanEventsEmpty');
+const icons={appeared:'➕',vanished:'➖',rssi:'📶',channel:'🔀',auth:'⚠️'};
+function describe(e){switch(e.type){case 'appeared':return 'Appeared on ch '+e.channel+', '+e.rssi+' dBm, '+e.auth;case 'vanished':return 'Vanished from ch '+e.channel;case 'rssi':return 'Signal '+e.prev_rssi+' → '+e.rssi+' dBm';case 'channel':return 'Channel '+e.prev_channel+' → '+e.channel;case 'auth':return 'Security '+e.prev_auth+' → '+e.auth;}return e.type;}
+function poll(){fetch('/scan/events?since='+cursor).then(r=>r.json()).then(d=>{cursor=d.next;d.events.forEach(e=>{const li=document.createElement('li');li.className='network-item';const name=document.createElement('div');name.className='network-name';name.textContent=icons[e.type]+' '+(e.ssid||'<Hidden Network>');const detail=document.createElement('div');detail.className='network-details';detail.textContent='Scan #'+e.generation+' | '+describe(e)+' | '+e.bssid;const info=document.createElement('div');info.className='network-info';info.appendChild(name);info.appendChild(detail);li.appendChild(info);if(e.type==='auth'){li.style.borderLeft='4px solid #ef4444';}list.insertBefore(li,list.firstChild);});while(list.children.length>30){list.removeChild(list.lastChild);}empty.style.display=list.children.length?'none':'block';}).catch(()=>{});}
+poll();setInterval(poll,5000);})();
+</script>)rawliteral";
+
 void handleScan() {
+    // Start a background scan and reload until it lands
+    if (webServer->hasArg("doscan")) {
+        uint32_t generation = getWiFiScanGeneration();
+        requestWiFiScan();
+        webServer->sendHeader("Location", "/scan?after=" + String(generation), true);
+        webServer->send(302, "text/plain", "");
+        return;
+    }
+    
     String html;
     html.reserve(8192);  // Pre-allocate for scan results
     html = FPSTR(HTML_HEADER);
     html += generateNav("🔍 Network Scan");
     html += FPSTR(SCAN_HEADER);
+    if (isRogueAlertActive()) {
+        html += F("<div style=\"background:#fee;padding:15px;border-left:4px solid #f44;border-radius:5px;margin:20px 0\"><strong>🚨 Rogue AP alert:</strong> a protected SSID was seen from an unknown or weakened access point. <a href=\"/rogue\">View alerts</a></div>");
+    }
     
-    // Check if scan was requested
-    if (webServer->hasArg("doscan")) {
-        // Perform WiFi scan
-        int n = WiFi.scanNetworks();
-        
-        // Cache the results for details view
-        cacheScanResults();
+    if (webServer->hasArg("after") && scanPending(webServer->arg("after").toInt())) {
+        appendScanPending(html);
+    } else if (getWiFiScanGeneration() > 0) {
+        char scanAge[16];
+        formatWiFiScanAge(getWiFiScanAge(), scanAge, sizeof(scanAge));
+        const WiFiScanStore& store = lockWiFiScanStore();
+        int n = store.count;
         
         if (n == 0) {
             html += F("<p style='text-align:center;padding:40px;color:#666'>No networks found. Try scanning again.</p>");
@@ -1139,17 +1177,21 @@ void handleScan() {
             for (int i = 0; i < n; i++) {
             // Make the entire list item clickable
             html += F("<li class=\"network-item\" onclick=\"window.location.href='/scan/details?id=");
-            html += i;
+            html += store.records[i].id;
             html += F("'\" style=\"cursor:pointer;transition:background-color 0.2s\" onmouseover=\"this.style.backgroundColor='#f0f0f0'\" onmouseout=\"this.style.backgroundColor='#f8f9fa'\"><div class=\"network-info\"><div class=\"network-name\">");
-            html += WiFi.SSID(i).length() > 0 ? WiFi.SSID(i) : F("<Hidden Network>");
+            if (store.records[i].ssid[0] != '\0') {
+                html += store.records[i].ssid;
+            } else {
+                html += F("<Hidden Network>");
+            }
             html += F("</div><div class=\"network-details\">Channel: ");
-            html += WiFi.channel(i);
+            html += store.records[i].channel;
             html += F(" | Security: ");
-            html += (WiFi.encryptionType(i) == WIFI_AUTH_OPEN) ? F("Open") : F("Secured");
+            html += (store.records[i].authMode == WIFI_AUTH_OPEN) ? F("Open") : F("Secured");
             html += F("</div></div>");
             
             // Signal strength with colored circles
-            int rssi = WiFi.RSSI(i);
+            int rssi = store.records[i].rssi;
             int bars = 0;
             String color;
             
@@ -1191,12 +1233,15 @@ void handleScan() {
         
         html += F("</ul><p style='text-align:center;margin-top:20px'><strong>Found ");
         html += n;
-        html += F(" network(s)</strong></p>");
+        html += F(" network(s)</strong> <span style='color:#666'>(scan #");
+        html += store.generation;
+        html += F(", ");
+        html += scanAge;
+        html += F(")</span></p>");
         html += F("<p style='text-align:center;color:#666;font-size:0.9em;margin-top:10px'>💡 Click on any network to view detailed information</p>");
         }
-        
-        // Don't delete scan results yet - keep them cached for details view
-        // WiFi.scanDelete();
+        unlockWiFiScanStore();
+        html += FPSTR(SCAN_EVENTS_PANEL);
     } else {
         html += F("<p style='text-align:center;padding:40px;color:#999'>Click the button above to scan for available WiFi networks.</p>");
     }
@@ -1205,18 +1250,51 @@ void handleScan() {
     webServer->send(200, "text/html", html);
 }
 
+void handleScanEvents() {
+    uint32_t cursor = webServer->hasArg("since") ? (uint32_t)webServer->arg("since").toInt() : 0;
+    ScanDeltaEvent events[8];
+    uint32_t skipped = 0;
+    uint32_t totalSkipped = 0;
+    uint16_t count;
+    bool first = true;
+    
+    String json;
+    json.reserve(2048);
+    json = "{\"threshold_db\":" + String(getWiFiScanEventThreshold()) + ",\"events\":[";
+    while ((count = readWiFiScanEvents(cursor, events, 8, &skipped)) > 0) {
+        totalSkipped += skipped;
+        for (uint16_t i = 0; i < count; i++) {
+            const ScanDeltaEvent& event = events[i];
+            const ScanDeltaNetwork& network = event.network;
+            char bssid[18];
+            snprintf(bssid, sizeof(bssid), "%02X:%02X:%02X:%02X:%02X:%02X", network.bssid[0], network.bssid[1],
+                     network.bssid[2], network.bssid[3], network.bssid[4], network.bssid[5]);
+            if (!first) json += ",";
+            first = false;
+            json += "{\"sequence\":" + String(event.sequence);
+            json += ",\"generation\":" + String(event.generation);
+            json += ",\"type\":\"" + String(scanDeltaTypeName(event.type)) + "\"";
+            json += ",\"id\":" + String(network.id);
+            json += ",\"ssid\":";
+            appendJsonString(json, network.ssid);
+            json += ",\"bssid\":\"" + String(bssid) + "\"";
+            json += ",\"channel\":" + String(network.channel);
+            json += ",\"rssi\":" + String(network.rssi);
+            json += ",\"auth\":\"" + String(getWiFiAuthModeName(network.authMode)) + "\"";
+            json += ",\"prev_channel\":" + String(event.previousChannel);
+            json += ",\"prev_rssi\":" + String(event.previousRssi);
+            json += ",\"prev_auth\":\"" + String(getWiFiAuthModeName(event.previousAuthMode)) + "\"}";
+        }
+    }
+    json += "],\"skipped\":" + String(totalSkipped);
+    json += ",\"next\":" + String(cursor) + "}";
+    webServer->send(200, "application/json", json);
+}
+
 // ==========================================
 // NETWORK DETAILS PAGE HANDLER
 // ==========================================
 void handleScanDetails() {
-    // Check if cache is valid
-    if (!isCacheValid()) {
-        // Redirect back to scan page if cache expired
-        webServer->sendHeader("Location", "/scan");
-        webServer->send(302, "text/plain", "Scan results expired. Please scan again.");
-        return;
-    }
-    
     // Get network ID from query parameter
     if (!webServer->hasArg("id")) {
         webServer->sendHeader("Location", "/scan");
@@ -1226,22 +1304,32 @@ void handleScanDetails() {
     
     int networkId = webServer->arg("id").toInt();
     
-    // Validate network ID
-    if (networkId < 0 || networkId >= cachedNetworkCount) {
+    // Copy the network and its channel neighbours out of the shared store
+    const WiFiScanStore& store = lockWiFiScanStore();
+    int index = findScanRecord(store, (uint16_t)networkId);
+    if (index < 0) {
+        unlockWiFiScanStore();
         webServer->sendHeader("Location", "/scan");
-        webServer->send(302, "text/plain", "Invalid network ID");
+        webServer->send(302, "text/plain", "Network not in the last scan");
         return;
     }
-    
-    // Get cached network data
-    CachedScanResult& network = cachedNetworks[networkId];
+    ScanRecord network = store.records[index];
+    uint32_t generation = store.generation;
+    uint32_t ageMs = (uint32_t)(millis() - store.completedAt);
+    int channelUsage = 0;
+    for (int i = 0; i < store.count; i++) {
+        if (store.records[i].channel == network.channel) {
+            channelUsage++;
+        }
+    }
+    unlockWiFiScanStore();
     
     String html;
     html.reserve(8192);
     html = FPSTR(HTML_HEADER);
     
     // Header with back button
-    html += F("<div class=\"header\"><a href=\"/scan?doscan=1\" style=\"position:absolute;left:30px;top:30px;color:#667eea;text-decoration:none;font-weight:bold;font-size:1.1em\">← Back to Scan</a><h1>🔍 Network Details</h1></div>");
+    html += F("<div class=\"header\"><a href=\"/scan\" style=\"position:absolute;left:30px;top:30px;color:#667eea;text-decoration:none;font-weight:bold;font-size:1.1em\">← Back to Scan</a><h1>🔍 Network Details</h1></div>");
     
     html += generateNav("🔍 Network Details");
     
@@ -1249,21 +1337,30 @@ void handleScanDetails() {
     html += F("<h2>📡 Network Information</h2>");
     html += F("<div style=\"background:#f8f9fa;padding:20px;border-radius:10px;margin:20px 0\">");
     html += F("<p><strong>Network Name (SSID):</strong> ");
-    html += network.ssid.length() > 0 ? network.ssid : F("<em>Hidden Network</em>");
+    if (network.ssid[0] != '\0') {
+        html += network.ssid;
+    } else {
+        html += F("<em>Hidden Network</em>");
+    }
     html += F("</p>");
     
     // BSSID (MAC Address)
     html += F("<p><strong>MAC Address (BSSID):</strong> ");
-    if (network.hasBssid) {
-        char bssidStr[18];
-        sprintf(bssidStr, "%02X:%02X:%02X:%02X:%02X:%02X", 
-                network.bssid[0], network.bssid[1], network.bssid[2], 
-                network.bssid[3], network.bssid[4], network.bssid[5]);
-        html += bssidStr;
-    } else {
-        html += F("<em>Not Available</em>");
-    }
-    html += F("</p></div>");
+    char bssidStr[18];
+    sprintf(bssidStr, "%02X:%02X:%02X:%02X:%02X:%02X", 
+            network.bssid[0], network.bssid[1], network.bssid[2], 
+            network.bssid[3], network.bssid[4], network.bssid[5]);
+    html += bssidStr;
+    html += F("</p>");
+    
+    // Details come from the last scan; say how old it is
+    char age[16];
+    formatWiFiScanAge(ageMs, age, sizeof(age));
+    html += F("<p><strong>Last Seen:</strong> ");
+    html += age;
+    html += F(" <span style=\"color:#666\">(scan #");
+    html += generation;
+    html += F(")</span></p></div>");
     
     // Signal Strength section
     html += F("<h2>📶 Signal Strength</h2>");
@@ -1331,14 +1428,7 @@ void handleScanDetails() {
     html += bandInfo;
     html += F("</p>");
     
-    // Calculate channel congestion
-    int channelUsage = 0;
-    for (int i = 0; i < cachedNetworkCount; i++) {
-        if (cachedNetworks[i].channel == network.channel) {
-            channelUsage++;
-        }
-    }
-    
+    // Channel congestion (channelUsage counted from the store above)
     String congestionLevel = "";
     String congestionColor = "";
     if (channelUsage == 1) {
@@ -1372,7 +1462,7 @@ void handleScanDetails() {
     String securityLevel = "";
     String securityColor = "";
     
-    switch (network.encryptionType) {
+    switch ((wifi_auth_mode_t)network.authMode) {
         case WIFI_AUTH_OPEN:
             encIcon = F("🔓"); encDescription = F("Open (No Security)"); 
             securityLevel = F("None"); securityColor = "#ef4444";
@@ -1426,11 +1516,11 @@ void handleScanDetails() {
     html += F("</span></p>");
     
     // Security warning for open/weak networks
-    if (network.encryptionType == WIFI_AUTH_OPEN) {
+    if (network.authMode == WIFI_AUTH_OPEN) {
         html += F("<div style=\"background:#fef2f2;border-left:4px solid #ef4444;padding:15px;margin-top:15px;border-radius:5px\">");
         html += F("<p style=\"color:#ef4444;margin:0\"><strong>⚠️ Security Warning:</strong> This is an open network with no encryption. Your data will be transmitted unencrypted and could be intercepted by others.</p>");
         html += F("</div>");
-    } else if (network.encryptionType == WIFI_AUTH_WEP) {
+    } else if (network.authMode == WIFI_AUTH_WEP) {
         html += F("<div style=\"background:#fef2f2;border-left:4px solid #f59e0b;padding:15px;margin-top:15px;border-radius:5px\">");
         html += F("<p style=\"color:#f59e0b;margin:0\"><strong>⚠️ Security Warning:</strong> WEP encryption is deprecated and easily cracked. This network is not secure.</p>");
         html += F("</div>");
@@ -1451,11 +1541,11 @@ void handleScanDetails() {
     }
     
     // Security analysis
-    if (network.encryptionType == WIFI_AUTH_OPEN) {
+    if (network.authMode == WIFI_AUTH_OPEN) {
         html += F("<p>❌ <strong>Security:</strong> No encryption - avoid transmitting sensitive data</p>");
-    } else if (network.encryptionType == WIFI_AUTH_WEP) {
+    } else if (network.authMode == WIFI_AUTH_WEP) {
         html += F("<p>⚠️ <strong>Security:</strong> Weak encryption - not recommended</p>");
-    } else if (network.encryptionType >= WIFI_AUTH_WPA3_PSK) {
+    } else if (network.authMode >= WIFI_AUTH_WPA3_PSK) {
         html += F("<p>✅ <strong>Security:</strong> Excellent encryption with modern security standards</p>");
     } else {
         html += F("<p>✅ <strong>Security:</strong> Adequate encryption for most purposes</p>");
@@ -1476,6 +1566,210 @@ void handleScanDetails() {
     webServer->send(200, "text/html", html);
 }
 
+// ==========================================
+// ROGUE AP DETECTOR PAGE HANDLERS
+// ==========================================
+static void appendBssid(String& text, const uint8_t* b) {
+    char bssid[18];
+    snprintf(bssid, sizeof(bssid), "%02X:%02X:%02X:%02X:%02X:%02X", b[0], b[1], b[2], b[3], b[4], b[5]);
+    text += bssid;
+}
+
+void handleRoguePage() {
+    const RogueDetector& detector = getRogueDetector();
+    uint32_t now_s = millis() / 1000;
+    
+    String html;
+    html.reserve(6144);
+    html = FPSTR(HTML_HEADER);
+    html += generateNav("🛡️ Rogue APs");
+    html += F("<div class=\"header\"><h1>🛡️ Rogue AP Detector</h1></div>");
+    
+    if (webServer->hasArg("error")) {
+        String error = webServer->arg("error");
+        html += F("<div style=\"background:#fee;padding:15px;border-left:4px solid #f44;border-radius:5px;margin:20px 0\"><strong>❌ Error:</strong> ");
+        if (error == "ssid") {
+            html += F("Enter an SSID of 1-32 characters.");
+        } else if (error == "mode") {
+            html += F("Learning needs scans. Switch to station mode first.");
+        } else {
+            html += F("No profile for that SSID.");
+        }
+        html += F("</div>");
+    }
+    
+    html += F("<div class=\"stat-grid\"><div class=\"stat-card\"><div class=\"stat-label\">📡 Monitoring</div><div class=\"stat-value\">");
+    html += isRogueDetectorEnabled() ? F("ON") : F("OFF");
+    html += F("</div></div><div class=\"stat-card\"><div class=\"stat-label\">🔐 Protected SSIDs</div><div class=\"stat-value\">");
+    html += detector.profileCount;
+    html += F("</div></div><div class=\"stat-card\"><div class=\"stat-label\">🚨 Active Alerts</div><div class=\"stat-value\">");
+    html += rogueRecentAlerts(detector, now_s, ROGUE_ALERT_ACTIVE_S);
+    html += F("</div></div></div>");
+    
+    html += F("<form method=\"POST\" action=\"/rogue/action\" style=\"text-align:center;margin:20px 0\"><input type=\"hidden\" name=\"action\" value=\"");
+    html += isRogueDetectorEnabled() ? F("off") : F("on");
+    html += F("\"><button type=\"submit\" class=\"submit-btn\" style=\"width:auto;padding:12px 30px\">");
+    html += isRogueDetectorEnabled() ? F("⏹️ Stop Monitoring") : F("▶️ Start Monitoring");
+    html += F("</button></form>");
+    
+    // Alerts, newest first
+    html += F("<h2>🚨 Alerts</h2>");
+    if (detector.alertCount == 0) {
+        html += F("<p style=\"text-align:center;color:#999\">No alerts.</p>");
+    } else {
+        html += F("<ul class=\"network-list\">");
+        for (uint8_t i = 0; i < detector.alertCount; i++) {
+            const RogueAlert& alert = rogueAlert(detector, i);
+            html += F("<li class=\"network-item\" style=\"border-left:4px solid ");
+            html += alert.gone ? F("#d1d5db") : F("#ef4444");
+            html += F("\"><div class=\"network-info\"><div class=\"network-name\">");
+            html += alert.gone ? F("⚪ ") : F("🔴 ");
+            appendHtmlEscaped(html, alert.ssid);
+            html += F(" - ");
+            html += rogueAlertTypeName(alert.type);
+            html += F("</div><div class=\"network-details\">");
+            appendBssid(html, alert.bssid);
+            html += F(" | Channel ");
+            html += alert.channel;
+            html += F(" | ");
+            html += getWiFiAuthModeName(alert.authMode);
+            html += F(" (expected ");
+            html += getWiFiAuthModeName(alert.expectedAuthMode);
+            html += F(") | Seen ");
+            html += alert.count;
+            html += F("×, last ");
+            html += now_s - alert.lastSeen_s;
+            html += alert.gone ? F(" s ago, gone") : F(" s ago");
+            html += F("</div></div></li>");
+        }
+        html += F("</ul><form method=\"POST\" action=\"/rogue/action\" style=\"text-align:center;margin:15px 0\"><input type=\"hidden\" name=\"action\" value=\"clear\"><button type=\"submit\" class=\"submit-btn\" style=\"width:auto;padding:10px 25px\">🧹 Clear Alerts</button></form>");
+    }
+    
+    // Profiles
+    html += F("<h2>🔐 Protected SSIDs</h2>");
+    const char* learning = getRogueLearningSsid();
+    if (learning != nullptr) {
+        html += F("<p style=\"color:#666\">🔄 Learning <strong>");
+        appendHtmlEscaped(html, learning);
+        html += F("</strong> from the next scans...</p>");
+    }
+    if (detector.profileCount == 0) {
+        html += F("<p style=\"text-align:center;color:#999\">No SSIDs are protected yet.</p>");
+    } else {
+        html += F("<ul class=\"network-list\">");
+        for (uint8_t i = 0; i < detector.profileCount; i++) {
+            const RogueProfile& profile = detector.profiles[i];
+            html += F("<li class=\"network-item\"><div class=\"network-info\"><div class=\"network-name\">");
+            appendHtmlEscaped(html, profile.ssid);
+            html += F("</div><div class=\"network-details\">Minimum security: ");
+            html += getWiFiAuthModeName(profile.minAuthMode);
+            html += F(" | Channels:");
+            for (uint8_t ch = 1; ch <= WIFI_SCAN_MAX_CHANNEL; ch++) {
+                if (profile.channelMask & (1u << ch)) {
+                    html += ' ';
+                    html += ch;
+                }
+            }
+            html += F(" | Access points: ");
+            for (uint8_t j = 0; j < profile.bssidCount; j++) {
+                if (j > 0) html += F(", ");
+                appendBssid(html, profile.bssids[j]);
+            }
+            html += F("</div></div><form method=\"POST\" action=\"/rogue/action\" style=\"margin:0\"><input type=\"hidden\" name=\"action\" value=\"forget\"><input type=\"hidden\" name=\"ssid\" value=\"");
+            appendHtmlEscaped(html, profile.ssid);
+            html += F("\"><button type=\"submit\" style=\"padding:6px 14px;background:#ef4444;color:white;border:none;border-radius:5px;cursor:pointer\">Forget</button></form></li>");
+        }
+        html += F("</ul>");
+    }
+    
+    html += F("<h2>➕ Learn an SSID</h2><form method=\"POST\" action=\"/rogue/action\"><input type=\"hidden\" name=\"action\" value=\"learn\"><div class=\"form-group\"><label for=\"ssid\">SSID</label><input type=\"text\" id=\"ssid\" name=\"ssid\" maxlength=\"32\" value=\"");
+    if (WiFi.status() == WL_CONNECTED) {
+        appendHtmlEscaped(html, WiFi.SSID().c_str());
+    }
+    html += F("\" required></div><button type=\"submit\" class=\"submit-btn\">Learn Access Points</button></form>");
+    html += F("<p style=\"color:#666;font-size:0.9em;margin-top:10px\">💡 Learn while only the real access points are in range. Learning adds every access point seen with this SSID for the next two minutes. While monitoring, the device scans at least every 30 seconds in station mode and flashes its LED when an alert was seen in the last 5 minutes.</p>");
+    
+    html += generateHtmlFooter();
+    webServer->send(200, "text/html", html);
+}
+
+void handleRogueAPI() {
+    const RogueDetector& detector = getRogueDetector();
+    uint32_t now_s = millis() / 1000;
+    
+    String json;
+    json.reserve(2048);
+    json = "{\"enabled\":" + String(isRogueDetectorEnabled() ? "true" : "false");
+    json += ",\"active\":" + String(isRogueAlertActive() ? "true" : "false");
+    json += ",\"learning\":";
+    const char* learning = getRogueLearningSsid();
+    if (learning != nullptr) {
+        appendJsonString(json, learning);
+    } else {
+        json += "null";
+    }
+    json += ",\"profiles\":[";
+    for (uint8_t i = 0; i < detector.profileCount; i++) {
+        const RogueProfile& profile = detector.profiles[i];
+        if (i > 0) json += ",";
+        json += "{\"ssid\":";
+        appendJsonString(json, profile.ssid);
+        json += ",\"min_auth\":\"" + String(getWiFiAuthModeName(profile.minAuthMode)) + "\"";
+        json += ",\"channel_mask\":" + String(profile.channelMask);
+        json += ",\"bssids\":[";
+        for (uint8_t j = 0; j < profile.bssidCount; j++) {
+            if (j > 0) json += ",";
+            json += '"';
+            appendBssid(json, profile.bssids[j]);
+            json += '"';
+        }
+        json += "]}";
+    }
+    json += "],\"alerts\":[";
+    for (uint8_t i = 0; i < detector.alertCount; i++) {
+        const RogueAlert& alert = rogueAlert(detector, i);
+        if (i > 0) json += ",";
+        json += "{\"type\":\"" + String(rogueAlertTypeName(alert.type)) + "\"";
+        json += ",\"ssid\":";
+        appendJsonString(json, alert.ssid);
+        json += ",\"bssid\":\"";
+        appendBssid(json, alert.bssid);
+        json += "\",\"channel\":" + String(alert.channel);
+        json += ",\"auth\":\"" + String(getWiFiAuthModeName(alert.authMode)) + "\"";
+        json += ",\"expected_auth\":\"" + String(getWiFiAuthModeName(alert.expectedAuthMode)) + "\"";
+        json += ",\"count\":" + String(alert.count);
+        json += ",\"age_s\":" + String(now_s - alert.lastSeen_s);
+        json += ",\"gone\":" + String(alert.gone ? "true" : "false") + "}";
+    }
+    json += "]}";
+    webServer->send(200, "application/json", json);
+}
+
+void handleRogueAction() {
+    String action = webServer->arg("action");
+    String ssid = webServer->arg("ssid");
+    String location = "/rogue";
+    
+    if (action == "on" || action == "off") {
+        setRogueDetectorEnabled(action == "on");
+    } else if (action == "clear") {
+        clearRogueAlerts();
+    } else if (action == "learn") {
+        if (ssid.length() == 0 || ssid.length() > ROGUE_SSID_LENGTH) {
+            location += "?error=ssid";
+        } else if (currentMode != MODE_STATION) {
+            location += "?error=mode";
+        } else {
+            startRogueLearning(ssid.c_str());
+        }
+    } else if (action == "forget") {
+        if (!forgetRogueProfile(ssid.c_str())) location += "?error=profile";
+    }
+    
+    webServer->sendHeader("Location", location, true);
+    webServer->send(303, "text/plain", "");
+}
+
 void handleNetworkAnalysis() {
     String html = HTML_HEADER;
     
@@ -1914,11 +2208,21 @@ void handleChannelGraph() {
         
         html += "<p><strong>Best Channel:</strong> <span class=\"badge success\">Channel " + String(lastChannelAnalysis.best_channel_2g4) + "</span></p>";
         html += "<p><strong>Least Crowded:</strong> Channel " + String(lastChannelAnalysis.best_channel_2g4) + " with " + String((int)(100 - lastChannelAnalysis.channels[lastChannelAnalysis.best_channel_2g4 - 1].congestion_score)) + "% available capacity</p>";
-        html += "<p><strong>Total Networks Found:</strong> " + String(lastChannelAnalysis.total_networks) + "</p>";
+        html += "<p><strong>Total Networks Found:</strong> " + String(lastChannelAnalysis.total_networks) + " from " + String(lastChannelAnalysis.total_radios) + " access point radios</p>";
         html += "<p><strong>Recommended Non-Overlapping Channels:</strong> 1, 6, 11</p>";
         
         html += "</div>";
         
+        if (channelHistoryCount(getChannelHistory()) >= 2) {
+            html += R"rawliteral(
+            <h2>📉 Congestion History</h2>
+            <div style="background:#f8f9fa;padding:25px;border-radius:10px;margin:20px 0">
+                <canvas id="historyGraph" width="1000" height="260" style="width:100%;height:260px;background:white;border-radius:8px"></canvas>
+                <p style="color:#666;font-size:0.9em;margin-top:10px">On the spectrum graph, the solid line is each channel's 30-minute average and the dashed red line its peak.</p>
+            </div>
+            )rawliteral";
+        }
+        
         // Network list by channel
         html += R"rawliteral(
         <h2>📡 Networks by Channel</h2>
@@ -1935,12 +2239,22 @@ void handleChannelGraph() {
                 if (i > 0) html += ",";
                 html += "{ch:" + String(lastChannelAnalysis.channels[i].channel);
                 html += ",nets:" + String(lastChannelAnalysis.channels[i].network_count);
+                html += ",radios:" + String(lastChannelAnalysis.channels[i].radio_count);
                 html += ",cong:" + String(lastChannelAnalysis.channels[i].congestion_score, 1);
                 html += ",rec:" + String(lastChannelAnalysis.channels[i].is_recommended ? "true" : "false");
+                const ChannelTrend& trend = channelHistoryTrend(getChannelHistory(), lastChannelAnalysis.channels[i].channel);
+                ChannelSample peak;
+                uint32_t peakTime;
+                if (trend.updated_s != 0 &&
+                    channelHistoryPeak(getChannelHistory(), lastChannelAnalysis.channels[i].channel, peak, peakTime)) {
+                    html += ",avg:" + String(trend.long_ewma, 1);
+                    html += ",peak:" + String(peak.score);
+                }
                 html += "}";
             }
         }
         html += "];";
+        html += "const channelHistory = " + exportChannelHistoryToJSON() + ";";
         
         // Draw function
         html += R"rawliteral(
@@ -2052,6 +2366,29 @@ void handleChannelGraph() {
                         ctx.textAlign = 'center';
                         const textY = y + barHeight / 2;
                         ctx.fillText(data.nets + ' net' + (data.nets > 1 ? 's' : ''), x + channelWidth / 2, textY + 4);
+                        if (data.radios != data.nets) {
+                            ctx.font = '11px Arial';
+                            ctx.fillText(data.radios + ' AP' + (data.radios > 1 ? 's' : ''), x + channelWidth / 2, textY + 18);
+                        }
+                    }
+                    
+                    // Long-term average (solid) and peak (dashed) from the channel history
+                    if (data.avg !== undefined) {
+                        const avgY = height - padding - (data.avg / 100) * graphHeight;
+                        const peakY = height - padding - (data.peak / 100) * graphHeight;
+                        ctx.strokeStyle = '#1f2937';
+                        ctx.lineWidth = 2;
+                        ctx.beginPath();
+                        ctx.moveTo(x + 2, avgY);
+                        ctx.lineTo(x + channelWidth - 2, avgY);
+                        ctx.stroke();
+                        ctx.setLineDash([4, 3]);
+                        ctx.strokeStyle = '#dc2626';
+                        ctx.beginPath();
+                        ctx.moveTo(x + 2, peakY);
+                        ctx.lineTo(x + channelWidth - 2, peakY);
+                        ctx.stroke();
+                        ctx.setLineDash([]);
                     }
                     
                     // Mark recommended channels
@@ -2088,9 +2425,67 @@ void handleChannelGraph() {
             });
         }
         
+        // Score over time for channels 1, 6 and 11 plus the busiest other channel
+        function drawHistoryGraph() {
+            const canvas = document.getElementById('historyGraph');
+            if (!canvas || channelHistory.length < 2) return;
+            const ctx = canvas.getContext('2d');
+            const width = canvas.width;
+            const height = canvas.height;
+            const padding = 50;
+            ctx.clearRect(0, 0, width, height);
+            
+            const oldest = channelHistory[0].age_s || 1;
+            const xOf = age => padding + (1 - age / oldest) * (width - padding * 2);
+            const yOf = score => height - padding - (score / 100) * (height - padding * 2);
+            
+            ctx.strokeStyle = '#e5e7eb';
+            ctx.fillStyle = '#666';
+            ctx.font = '12px Arial';
+            ctx.textAlign = 'right';
+            for (let v = 0; v <= 100; v += 25) {
+                ctx.beginPath();
+                ctx.moveTo(padding, yOf(v));
+                ctx.lineTo(width - padding, yOf(v));
+                ctx.stroke();
+                ctx.fillText(v + '%', padding - 8, yOf(v) + 4);
+            }
+            ctx.textAlign = 'center';
+            ctx.fillText(Math.round(oldest / 60) + ' min ago', padding, height - padding + 20);
+            ctx.fillText('now', width - padding, height - padding + 20);
+            
+            let busiest = 0, busiestPeak = -1;
+            channelData.forEach(d => {
+                if (d.ch != 1 && d.ch != 6 && d.ch != 11 && d.peak !== undefined && d.peak > busiestPeak) {
+                    busiest = d.ch;
+                    busiestPeak = d.peak;
+                }
+            });
+            const series = [[1, '#2563eb'], [6, '#10b981'], [11, '#f59e0b']];
+            if (busiest > 0) series.push([busiest, '#ef4444']);
+            
+            ctx.textAlign = 'left';
+            series.forEach(([ch, color], idx) => {
+                ctx.strokeStyle = color;
+                ctx.lineWidth = 2;
+                ctx.beginPath();
+                let drawing = false;
+                channelHistory.forEach(pass => {
+                    const score = pass.scores[ch - 1];
+                    if (score === null) { drawing = false; return; }
+                    if (drawing) ctx.lineTo(xOf(pass.age_s), yOf(score));
+                    else ctx.moveTo(xOf(pass.age_s), yOf(score));
+                    drawing = true;
+                });
+                ctx.stroke();
+                ctx.fillStyle = color;
+                ctx.fillText('Ch ' + ch, width - padding + 8, padding + idx * 18);
+            });
+        }
+        
         // Draw on page load
-        window.onload = drawChannelGraph;
-        window.onresize = drawChannelGraph;
+        window.onload = function() { drawChannelGraph(); drawHistoryGraph(); };
+        window.onresize = function() { drawChannelGraph(); drawHistoryGraph(); };
         )rawliteral";
         
         html += "</script>";
@@ -2517,8 +2912,27 @@ void handleIperfResults() {
 // ==========================================
 
 void handleChannelScan() {
-    // Perform channel scan
-    ChannelAnalysisResults results = quickChannelScan();
+    // Start a background scan, then reload here until it lands
+    if (!webServer->hasArg("after")) {
+        uint32_t generation = getWiFiScanGeneration();
+        requestChannelScan(getQuickChannelScanConfig());
+        webServer->sendHeader("Location", "/channel/scan?after=" + String(generation), true);
+        webServer->send(302, "text/plain", "");
+        return;
+    }
+    
+    if (scanPending(webServer->arg("after").toInt())) {
+        String html = FPSTR(HTML_HEADER);
+        html += generateNav("📡 Channel");
+        html += F("<div class=\"header\"><h1>📡 Channel Analysis</h1></div>");
+        appendScanPending(html);
+        html += generateHtmlFooter();
+        webServer->send(200, "text/html", html);
+        return;
+    }
+    
+    // Analyze the completed scan
+    quickChannelScan();
     
     // Redirect back to channel page
     webServer->sendHeader("Location", "/channel?scanned=1", true);
@@ -2671,6 +3085,7 @@ void handleLatency() {
                     <option value="udp">UDP Echo (Fast, Low Overhead)</option>
                     <option value="tcp">TCP Connect (Connection Time)</option>
                     <option value="http">HTTP Request (Real-World Latency)</option>
+                    <option value="twamp">TWAMP-Light (RFC 5357 Reflector)</option>
                 </select>
                 </div>
             </div>
@@ -2685,6 +3100,11 @@ void handleLatency() {
                     <label for="interval">Interval (ms)</label>
                     <input type="number" id="interval" name="interval" value="1000" min="100" max="10000" required>
                 </div>
+
+                <div class="form-group">
+                    <label for="packetBytes">Packet Size (bytes, UDP)</label>
+                    <input type="number" id="packetBytes" name="packetBytes" value="32" min="32" max="1472">
+                </div>
             </div>
             
             <div class="info-box">
@@ -2702,6 +3122,10 @@ void handleLatency() {
                         <strong>HTTP Request</strong>: Best for Web/API performance.<br>
                         <small>Measures full request time including server processing. Mimics real web browsing.</small>
                     </li>
+                    <li style="margin-bottom:8px">
+                        <strong>TWAMP-Light</strong>: Best for carrier/ISP equipment.<br>
+                        <small>Standard RFC 5357 test packets (port 862). Reflector processing time is removed from the RTT.</small>
+                    </li>
                 </ul>
                 <p style="margin-top:10px;font-size:0.9em"><strong>💡 Tip:</strong> You can specify a custom port in the host field, e.g., <code>192.168.1.10:8080</code></p>
             </div>
@@ -2790,6 +3214,7 @@ void handleLatency() {
         <li><strong>UDP Echo:</strong> Fastest test method with minimal overhead</li>
         <li><strong>TCP Connect:</strong> Measures connection establishment time</li>
         <li><strong>HTTP Request:</strong> Real-world application latency testing</li>
+        <li><strong>TWAMP-Light:</strong> Interoperable RFC 5357 probing of network equipment</li>
         <li><strong>Jitter:</strong> Variation in latency between packets (critical for VoIP/gaming)</li>
         <li><strong>Packet Loss:</strong> Percentage of packets that failed to arrive</li>
     </ul>
@@ -2829,7 +3254,7 @@ void handleLatencyStart() {
         config.packet_count = packetCount.length() > 0 ? packetCount.toInt() : PING_DEFAULT_COUNT;
         config.interval_ms = interval.length() > 0 ? interval.toInt() : PING_DEFAULT_INTERVAL;
         config.timeout_ms = PING_DEFAULT_TIMEOUT;
-        config.packet_size = 32;
+        config.packet_size = constrain(webServer->arg("packetBytes").toInt(), 32, 1472);
         config.continuous_mode = false;
 
         if (testType == "udp") {
@@ -2841,6 +3266,10 @@ void handleLatencyStart() {
         } else if (testType == "http") {
             config.test_type = LATENCY_HTTP_REQUEST;
             config.target_port = (specifiedPort > 0) ? specifiedPort : 80;
+        } else if (testType == "twamp") {
+            config.test_type = LATENCY_TWAMP_LIGHT;
+            config.target_port = (specifiedPort > 0) ? specifiedPort : TWAMP_LIGHT_DEFAULT_PORT;
+            config.packet_size = TWAMP_REFLECTOR_PACKET_SIZE;
         } else {
             config.test_type = LATENCY_UDP_ECHO;
             config.target_port = (specifiedPort > 0) ? specifiedPort : 53;
@@ -2916,6 +3345,168 @@ void handleLatencyStatusJSON() {
     webServer->send(200, "application/json", json);
 }
 
+// ==========================================
+// TRACEROUTE HANDLERS
+// ==========================================
+void handleTraceroute() {
+    String html = HTML_HEADER;
+
+    html += R"rawliteral(
+    <div class="header">
+        <h1>🛰️ Traceroute</h1>
+        <p>Hop-by-Hop Path & Latency Attribution</p>
+    </div>
+    )rawliteral";
+
+    html += generateNav("🛰️ Traceroute");
+
+    if (webServer->hasArg("error")) {
+        html += "<div style=\"background: #fee; padding: 15px; border-left: 4px solid #f44; border-radius: 5px; margin: 20px 0;\">";
+        html += "<strong>❌ Error:</strong> " + webServer->arg("error");
+        html += "</div>";
+    } else if (webServer->hasArg("stopped")) {
+        html += R"rawliteral(
+        <div style="background: #fff3cd; padding: 15px; border-left: 4px solid #ffc107; border-radius: 5px; margin: 20px 0;">
+            <strong>🛑 Stopped:</strong> Traceroute has been stopped.
+        </div>
+        )rawliteral";
+    }
+
+    bool running = getTracerouteState() == TRACE_RUNNING;
+
+    if (!running) {
+        html += R"rawliteral(
+        <h2>🔧 Trace Configuration</h2>
+        <form method="POST" action="/traceroute/start">
+            <div class="form-group">
+                <label for="target">Target Host (IP or Domain)</label>
+                <input type="text" id="target" name="target" placeholder="e.g., google.com or 8.8.8.8" required>
+            </div>
+
+            <div class="form-group">
+                <label for="protocol">Probe Type</label>
+                <div class="select-wrapper">
+                <select id="protocol" name="protocol">
+                    <option value="udp">UDP (classic traceroute)</option>
+                    <option value="icmp">ICMP Echo (passes more firewalls)</option>
+                </select>
+                </div>
+            </div>
+
+            <div class="checkbox-group">
+                <input type="checkbox" id="mtr" name="mtr" value="1">
+                <label for="mtr">Continuous (MTR) mode - keep probing until stopped</label>
+            </div>
+
+            <button type="submit" class="submit-btn" style="background: linear-gradient(135deg, #667eea 0%, #764ba2 100%); color: white; border: none;">Start Traceroute</button>
+        </form>
+        )rawliteral";
+    } else {
+        html += R"rawliteral(
+        <div style="display: flex; gap: 15px; justify-content: center; margin: 20px 0;">
+            <button onclick="location.href='/traceroute/stop'" style="padding: 15px 30px; background: #ef4444; color: white; border: none; border-radius: 5px; font-size: 1.1em; cursor: pointer; font-weight: bold;">
+                🛑 Stop Trace
+            </button>
+        </div>
+        )rawliteral";
+    }
+
+    html += R"rawliteral(
+    <h2>📊 Path</h2>
+    <p id="traceSummary" style="color:#666">No traceroute has been run yet.</p>
+    <div id="traceTable" style="overflow-x:auto"></div>
+
+    <h2>ℹ️ Reading the Results</h2>
+    <ul style="margin: 15px 0 15px 30px; line-height: 1.8;">
+        <li><strong>Latency attribution:</strong> A jump in Avg between two hops shows where delay is added</li>
+        <li><strong>Loss at one hop only:</strong> Usually ICMP rate limiting on that router, not real loss</li>
+        <li><strong>* rows:</strong> The router did not answer; the path continues if later hops reply</li>
+        <li><strong>!N / !H / !X:</strong> Network, host or administratively unreachable - the path ends there</li>
+    </ul>
+    )rawliteral";
+
+    html += "<script>";
+    html += "function renderTrace(data) {";
+    html += "  if (data.state === 'idle') return;";
+    html += "  let summary = 'Target ' + data.target + ' (' + data.ip + ') via ' + data.protocol.toUpperCase();";
+    html += "  summary += ' | Rounds: ' + data.rounds + ' | ' + (data.reached ? '✅ Destination reached' : '⏳ Destination not reached');";
+    html += "  summary += ' | State: ' + data.state;";
+    html += "  document.getElementById('traceSummary').innerText = summary;";
+    html += "  let html = '<table style=\"width:100%;border-collapse:collapse\">';";
+    html += "  html += '<tr style=\"background:#667eea;color:white\">';";
+    html += "  ['Hop','Address','Loss','Sent','Last','Avg','Min','Max'].forEach(function(h) {";
+    html += "    html += '<th style=\"padding:10px;text-align:left\">' + h + '</th>';";
+    html += "  });";
+    html += "  html += '</tr>';";
+    html += "  data.hops.forEach(function(hop) {";
+    html += "    let addr = hop.received > 0 ? hop.ip : '*';";
+    html += "    if (hop.unreachable) addr += ' ' + hop.unreachable;";
+    html += "    if (hop.multipath) addr += ' (multipath)';";
+    html += "    let style = hop.destination ? 'font-weight:bold;color:#059669' : '';";
+    html += "    html += '<tr style=\"border-bottom:1px solid #ddd;' + style + '\">';";
+    html += "    html += '<td style=\"padding:10px\">' + hop.ttl + '</td><td style=\"padding:10px\">' + addr + '</td>';";
+    html += "    html += '<td style=\"padding:10px\">' + hop.loss.toFixed(1) + '%</td><td style=\"padding:10px\">' + hop.sent + '</td>';";
+    html += "    if (hop.received > 0) {";
+    html += "      [hop.last, hop.avg, hop.min, hop.max].forEach(function(v) {";
+    html += "        html += '<td style=\"padding:10px\">' + v.toFixed(2) + ' ms</td>';";
+    html += "      });";
+    html += "    } else {";
+    html += "      html += '<td style=\"padding:10px\" colspan=\"4\">*</td>';";
+    html += "    }";
+    html += "    html += '</tr>';";
+    html += "  });";
+    html += "  html += '</table>';";
+    html += "  document.getElementById('traceTable').innerHTML = html;";
+    html += "}";
+    html += "function pollTrace() {";
+    html += "  fetch('/traceroute/status').then(r => r.json()).then(data => {";
+    html += "    renderTrace(data);";
+    html += "    if (data.state === 'running') setTimeout(pollTrace, 1000);";
+    html += "    else if (" + String(running ? "true" : "false") + ") location.reload();";
+    html += "  }).catch(e => console.error('Polling error:', e));";
+    html += "}";
+    html += "pollTrace();";
+    html += "</script>";
+
+    html += generateHtmlFooter();
+    webServer->send(200, "text/html", html);
+}
+
+void handleTracerouteStart() {
+    String targetHost = webServer->arg("target");
+    targetHost.trim();
+
+    TracerouteConfig config = getDefaultTracerouteConfig(
+        webServer->arg("protocol") == "icmp" ? TRACE_PROBE_ICMP : TRACE_PROBE_UDP);
+    config.continuous = webServer->hasArg("mtr");
+
+    String errorMsg = "";
+    if (targetHost.length() == 0) {
+        errorMsg = "Target host required";
+    } else if (WiFi.status() != WL_CONNECTED) {
+        errorMsg = "Traceroute requires a station connection";
+    } else if (!startTraceroute(targetHost, config)) {
+        errorMsg = "Failed to start traceroute. Check the host name or stop the running trace.";
+    }
+
+    if (errorMsg.length() > 0) {
+        webServer->sendHeader("Location", "/traceroute?error=" + errorMsg, true);
+    } else {
+        webServer->sendHeader("Location", "/traceroute", true);
+    }
+    webServer->send(302, "text/plain", "");
+}
+
+void handleTracerouteStop() {
+    stopTraceroute();
+    webServer->sendHeader("Location", "/traceroute?stopped=1", true);
+    webServer->send(302, "text/plain", "");
+}
+
+void handleTracerouteStatus() {
+    webServer->send(200, "application/json", exportTracerouteJSON(getTracerouteResults()));
+}
+
 // ==========================================
 // CONFIGURATION HANDLERS
 // ==========================================
@@ -3987,9 +4578,14 @@ void handleSignalMonitor() {
     html += "  if (autoScanEnabled) {";
     html += "    document.getElementById('scanStatus').innerHTML = '🔄 Scanning...';";
     html += "  }";
+    html += "  fetchNearbySignals();";
+    html += "}";
+    
+    html += "function fetchNearbySignals() {";
     html += "  fetch('/signal/api?scan=1')";
     html += "    .then(response => response.json())";
     html += "    .then(data => {";
+    html += "      if (data.scanning) { setTimeout(fetchNearbySignals, 1000); return; }";
     html += "      scanInProgress = false;";
     html += "      lastScanTime = Date.now();";
     html += "      document.getElementById('scanBtn').disabled = false;";
@@ -4061,14 +4657,19 @@ void handleSignalStrengthAPI() {
         SignalInfo info = getCurrentSignalStrength();
         
         json += "\"connected\":" + String(info.isConnected ? "true" : "false") + ",";
-        json += "\"ssid\":\"" + info.ssid + "\",";
+        json += "\"ssid\":\"" + String(info.ssid) + "\",";
         json += "\"rssi\":" + String(info.rssi) + ",";
         json += "\"quality\":" + String(info.quality) + ",";
-        json += "\"qualityText\":\"" + info.qualityText + "\",";
+        json += "\"qualityText\":\"" + String(info.qualityText) + "\",";
         json += "\"timestamp\":" + String(info.timestamp);
         
+    } else if (webServer->hasArg("scan") &&
+               (isWiFiScanRunning() || (getWiFiScanAge() > WIFI_SCAN_FRESH_MS && requestWiFiScan()))) {
+        // Background scan in progress; the page polls again
+        json += "\"scanning\":true";
+        
     } else if (webServer->hasArg("scan")) {
-        // Scan nearby networks
+        // Nearby networks from the latest scan
         std::vector<SignalInfo> networks = getNearbySignalStrengths(20);
         
         json += "\"count\":" + String(networks.size()) + ",";
@@ -4077,10 +4678,10 @@ void handleSignalStrengthAPI() {
         for (size_t i = 0; i < networks.size(); i++) {
             if (i > 0) json += ",";
             json += "{";
-            json += "\"ssid\":\"" + networks[i].ssid + "\",";
+            json += "\"ssid\":\"" + String(networks[i].ssid) + "\",";
             json += "\"rssi\":" + String(networks[i].rssi) + ",";
             json += "\"quality\":" + String(networks[i].quality) + ",";
-            json += "\"qualityText\":\"" + networks[i].qualityText + "\",";
+            json += "\"qualityText\":\"" + String(networks[i].qualityText) + "\",";
             json += "\"connected\":" + String(networks[i].isConnected ? "true" : "false");
             json += "}";
         }
@@ -4129,6 +4730,18 @@ void handlePortScanner() {
                     <option value="all">All Ports (1-65535)</option>
                 </select>
             </div>
+            
+            <div>
+                <label style="display:block;font-weight:500;margin-bottom:8px;color:#333">Protocol:</label>
+                <select id="scanProto" style="width:100%;padding:12px;border:2px solid #667eea;border-radius:5px;font-size:1em;cursor:pointer">
+                    <option value="tcp">TCP (connect)</option>
+                    <option value="udp">UDP (service probes)</option>
+                </select>
+            </div>
+        </div>
+        
+        <div style="margin-top:20px">
+            <label style="cursor:pointer;color:#333"><input type="checkbox" id="grabBanners" checked style="margin-right:8px">Identify services (read banners / send HTTP HEAD to open ports)</label>
         </div>
         
         <div id="portRangeDiv" style="display:none;margin-top:20px">
@@ -4161,6 +4774,21 @@ void handlePortScanner() {
         <p style="text-align:center;color:#666">Configure scan parameters above and click "Start Scan" to begin port analysis.</p>
     </div>
 
+    <h2>🔎 Host Discovery</h2>
+    <div style="background:#f8f9fa;padding:25px;border-radius:10px;margin:20px 0">
+        <p style="margin:0 0 15px;color:#666">Find live hosts on the local subnet (ARP, then ICMP/TCP ping). Click a host to use it as the scan target.</p>
+        <div style="display:flex;gap:15px;flex-wrap:wrap">
+            <button id="discoverBtn" onclick="startDiscovery(false)" style="padding:12px 30px;background:linear-gradient(135deg,#667eea 0%,#764ba2 100%);color:white;border:none;border-radius:8px;font-size:1em;font-weight:bold;cursor:pointer">
+                🔎 Discover Hosts
+            </button>
+            <button id="discoverScanBtn" onclick="startDiscovery(true)" style="padding:12px 30px;background:#8b5cf6;color:white;border:none;border-radius:8px;font-size:1em;font-weight:bold;cursor:pointer">
+                🔎 Discover + Scan Common Ports
+            </button>
+        </div>
+        <div id="discoveryStatus" style="margin-top:15px"></div>
+        <div id="discoveryResults" style="margin-top:15px"></div>
+    </div>
+
     <h2>⚠️ Important Notes</h2>
     <div style="background:#fff3cd;padding:20px;border-left:4px solid #ffc107;border-radius:5px;margin:20px 0">
         <ul style="margin:10px 0;padding-left:25px">
@@ -4177,6 +4805,8 @@ void handlePortScanner() {
     html += "<script>";
     html += "let scanInterval;";
     html += "let scanRunning = false;";
+    html += "let scanEvents = null;";
+    html += "let livePorts = [];";
     
     // Set default IP to gateway
     html += "window.onload = function() {";
@@ -4200,6 +4830,8 @@ void handlePortScanner() {
     html += "  const scanType = document.getElementById('scanType').value;";
     html += "  if (!targetIP) { alert('Please enter target IP address'); return; }";
     html += "  let url = '/portscan/start?ip=' + encodeURIComponent(targetIP) + '&type=' + scanType;";
+    html += "  if (document.getElementById('grabBanners').checked) url += '&banners=1';";
+    html += "  if (document.getElementById('scanProto').value === 'udp') url += '&proto=udp';";
     html += "  if (scanType === 'range') {";
     html += "    const start = document.getElementById('startPort').value;";
     html += "    const end = document.getElementById('endPort').value;";
@@ -4215,7 +4847,7 @@ void handlePortScanner() {
     html += "        document.getElementById('stopScanBtn').disabled = false;";
     html += "        document.getElementById('stopScanBtn').style.opacity = '1';";
     html += "        document.getElementById('scanResults').innerHTML = '<p style=\"text-align:center;color:#667eea\">🔄 Initializing scan...</p>';";
-    html += "        scanInterval = setInterval(updateScanStatus, 1000);";
+    html += "        watchScan(targetIP);";
     html += "      } else {";
     html += "        alert('Failed to start scan: ' + (data.error || 'Unknown error'));";
     html += "      }";
@@ -4226,6 +4858,7 @@ void handlePortScanner() {
     html += "function stopPortScan() {";
     html += "  fetch('/portscan/stop')";
     html += "    .then(() => {";
+    html += "      closeScanEvents();";
     html += "      clearInterval(scanInterval);";
     html += "      scanRunning = false;";
     html += "      document.getElementById('startScanBtn').disabled = false;";
@@ -4236,21 +4869,57 @@ void handlePortScanner() {
     html += "    });";
     html += "}";
     
-    // Update scan status
+    // Progress bar
+    html += "function showProgress(progress, text) {";
+    html += "  document.getElementById('scanStatus').innerHTML = ";
+    html += "    '<div style=\"margin-top:10px\">' +";
+    html += "    '<div style=\"background:#e5e7eb;border-radius:5px;height:30px;position:relative;overflow:hidden\">' +";
+    html += "    '<div style=\"background:linear-gradient(135deg,#667eea,#764ba2);height:100%;width:' + progress + '%;transition:width 0.3s\"></div>' +";
+    html += "    '<div style=\"position:absolute;top:50%;left:50%;transform:translate(-50%,-50%);font-weight:bold;color:#333\">' + progress + '%</div>' +";
+    html += "    '</div>' +";
+    html += "    '<p style=\"margin-top:10px;text-align:center;color:#666\">' + text + '</p>' +";
+    html += "    '</div>';";
+    html += "}";
+    
+    // Live events pushed by the scanner; the full status is fetched once at the end
+    html += "function watchScan(targetIP) {";
+    html += "  if (!window.EventSource) { scanInterval = setInterval(updateScanStatus, 1000); return; }";
+    html += "  livePorts = [];";
+    html += "  scanEvents = new EventSource('/portscan/events');";
+    html += "  scanEvents.addEventListener('progress', function(e) {";
+    html += "    const progress = JSON.parse(e.data).progress;";
+    html += "    showProgress(progress, progress < 100 ? 'Scanning ' + targetIP + '...' : 'Finishing...');";
+    html += "  });";
+    html += "  scanEvents.addEventListener('open', function(e) {";
+    html += "    livePorts.push(JSON.parse(e.data));";
+    html += "    livePorts.sort(function(a, b) { return a.port - b.port; });";
+    html += "    displayResults({openPorts: livePorts.length, targetIP: targetIP, ports: livePorts});";
+    html += "  });";
+    html += "  scanEvents.addEventListener('service', function(e) {";
+    html += "    const found = JSON.parse(e.data);";
+    html += "    livePorts.forEach(function(port) { if (port.port === found.port) { port.service = found.service; port.banner = found.banner; port.fingerprinted = true; } });";
+    html += "    displayResults({openPorts: livePorts.length, targetIP: targetIP, ports: livePorts});";
+    html += "  });";
+    html += "  scanEvents.addEventListener('done', function(e) {";
+    html += "    closeScanEvents();";
+    html += "    if (JSON.parse(e.data).completed) updateScanStatus(); else stopPortScan();";
+    html += "  });";
+    html += "  scanEvents.onerror = function() {";
+    html += "    if (scanEvents.readyState === EventSource.CLOSED) { closeScanEvents(); scanInterval = setInterval(updateScanStatus, 1000); }";
+    html += "  };";
+    html += "}";
+    
+    html += "function closeScanEvents() {";
+    html += "  if (scanEvents) { scanEvents.close(); scanEvents = null; }";
+    html += "}";
+    
+    // Update scan status (fallback polling, and the final result)
     html += "function updateScanStatus() {";
     html += "  fetch('/portscan/status')";
     html += "    .then(response => response.json())";
     html += "    .then(data => {";
     html += "      if (data.state === 'running') {";
-    html += "        const progress = data.progress || 0;";
-    html += "        document.getElementById('scanStatus').innerHTML = ";
-    html += "          '<div style=\"margin-top:10px\">' +";
-    html += "          '<div style=\"background:#e5e7eb;border-radius:5px;height:30px;position:relative;overflow:hidden\">' +";
-    html += "          '<div style=\"background:linear-gradient(135deg,#667eea,#764ba2);height:100%;width:' + progress + '%;transition:width 0.3s\"></div>' +";
-    html += "          '<div style=\"position:absolute;top:50%;left:50%;transform:translate(-50%,-50%);font-weight:bold;color:#333\">' + progress + '%</div>' +";
-    html += "          '</div>' +";
-    html += "          '<p style=\"margin-top:10px;text-align:center;color:#666\">Scanning port ' + data.currentPort + ' of ' + data.totalPorts + '</p>' +";
-    html += "          '</div>';";
+    html += "        showProgress(data.progress || 0, data.identifying ? 'Identifying services on open ports...' : 'Scanning port ' + data.currentPort + ' of ' + data.totalPorts + ' (RTT ' + data.rttMs + ' ms, timeout ' + data.timeoutMs + ' ms)');";
     html += "        if (data.openPorts > 0) {";
     html += "          displayResults(data);";
     html += "        }";
@@ -4261,7 +4930,7 @@ void handlePortScanner() {
     html += "        document.getElementById('startScanBtn').style.opacity = '1';";
     html += "        document.getElementById('stopScanBtn').disabled = true;";
     html += "        document.getElementById('stopScanBtn').style.opacity = '0.5';";
-    html += "        document.getElementById('scanStatus').innerHTML = '<p style=\"color:#10b981;font-weight:500\">✅ Scan completed in ' + data.duration + ' seconds</p>';";
+    html += "        document.getElementById('scanStatus').innerHTML = '<p style=\"color:#10b981;font-weight:500\">✅ Scan completed in ' + data.duration + ' seconds: ' + data.closedPorts + ' closed, ' + data.filteredPorts + ' filtered' + (data.protocol === 'udp' ? ', ' + data.openFilteredPorts + ' open|filtered' : '') + ', RTT ' + data.rttMs + ' ms</p>';";
     html += "        displayResults(data);";
     html += "      }";
     html += "    });";
@@ -4280,12 +4949,14 @@ void handlePortScanner() {
     html += "    html += '<tr style=\"background:#667eea;color:white\">';";
     html += "    html += '<th style=\"padding:12px;text-align:left\">Port</th>';";
     html += "    html += '<th style=\"padding:12px;text-align:left\">Service</th>';";
+    html += "    html += '<th style=\"padding:12px;text-align:right\">Response</th>';";
     html += "    html += '<th style=\"padding:12px;text-align:center\">Status</th>';";
     html += "    html += '</tr>';";
     html += "    data.ports.forEach(function(port) {";
     html += "      html += '<tr style=\"border-bottom:1px solid #ddd\">';";
     html += "      html += '<td style=\"padding:12px;font-weight:500\">' + port.port + '</td>';";
-    html += "      html += '<td style=\"padding:12px\">' + port.service + '</td>';";
+    html += "      html += '<td style=\"padding:12px\">' + (port.fingerprinted ? '<strong>' + port.service + '</strong>' : port.service) + (port.banner ? '<br><span style=\"color:#666;font-size:0.85em;font-family:monospace\">' + port.banner + '</span>' : '') + '</td>';";
+    html += "      html += '<td style=\"padding:12px;text-align:right\">' + (port.responseTime !== undefined ? port.responseTime + ' ms' : '-') + '</td>';";
     html += "      html += '<td style=\"padding:12px;text-align:center\"><span style=\"background:#10b981;color:white;padding:4px 12px;border-radius:12px;font-size:0.9em\">OPEN</span></td>';";
     html += "      html += '</tr>';";
     html += "    });";
@@ -4294,6 +4965,59 @@ void handlePortScanner() {
     html += "  document.getElementById('scanResults').innerHTML = html;";
     html += "}";
     
+    // Host discovery
+    html += "let discoveryInterval;";
+    html += "function startDiscovery(scan) {";
+    html += "  fetch('/portscan/discover?action=start' + (scan ? '&scan=1' : ''))";
+    html += "    .then(response => response.json())";
+    html += "    .then(data => {";
+    html += "      if (data.success) {";
+    html += "        document.getElementById('discoveryResults').innerHTML = '';";
+    html += "        clearInterval(discoveryInterval);";
+    html += "        discoveryInterval = setInterval(updateDiscovery, 1000);";
+    html += "      } else {";
+    html += "        alert('Failed to start discovery: ' + (data.error || 'Unknown error'));";
+    html += "      }";
+    html += "    });";
+    html += "}";
+    
+    html += "function updateDiscovery() {";
+    html += "  fetch('/portscan/hosts')";
+    html += "    .then(response => response.json())";
+    html += "    .then(data => {";
+    html += "      let status = '';";
+    html += "      if (data.state === 'sweeping') {";
+    html += "        status = '🔄 Sweeping ' + data.first + ' - ' + data.last + ': ' + data.swept + '/' + data.total + ' addresses';";
+    html += "      } else if (data.state === 'scanning') {";
+    html += "        status = '🔄 Scanning ports: ' + data.hostsScanned + '/' + data.hosts.length + ' hosts';";
+    html += "      } else {";
+    html += "        clearInterval(discoveryInterval);";
+    html += "        status = data.state === 'error' ? '❌ Discovery failed' : '✅ ' + data.hosts.length + ' hosts found in ' + (data.sweepMs / 1000).toFixed(1) + ' s';";
+    html += "        if (data.dropped > 0) status += ' (' + data.dropped + ' more not listed)';";
+    html += "      }";
+    html += "      document.getElementById('discoveryStatus').innerHTML = '<p style=\"font-weight:500\">' + status + '</p>';";
+    html += "      displayHosts(data);";
+    html += "    });";
+    html += "}";
+    
+    html += "function displayHosts(data) {";
+    html += "  if (data.hosts.length === 0) { document.getElementById('discoveryResults').innerHTML = ''; return; }";
+    html += "  let html = '<table style=\"width:100%;border-collapse:collapse\">';";
+    html += "  html += '<tr style=\"background:#667eea;color:white\"><th style=\"padding:10px;text-align:left\">IP</th><th style=\"padding:10px;text-align:left\">MAC</th><th style=\"padding:10px;text-align:left\">Vendor</th><th style=\"padding:10px;text-align:right\">RTT</th><th style=\"padding:10px;text-align:left\">Open Ports</th></tr>';";
+    html += "  data.hosts.forEach(function(host) {";
+    html += "    const ports = host.scanned ? (host.ports.join(', ') || 'none') + (host.openCount > host.ports.length ? ' …' : '') : '-';";
+    html += "    html += '<tr style=\"border-bottom:1px solid #ddd;cursor:pointer\" onclick=\"document.getElementById(\\'targetIP\\').value=\\'' + host.ip + '\\'\">';";
+    html += "    html += '<td style=\"padding:10px;font-weight:500\">' + host.ip + '</td>';";
+    html += "    html += '<td style=\"padding:10px;font-family:monospace\">' + (host.mac || '-') + '</td>';";
+    html += "    html += '<td style=\"padding:10px\">' + (host.vendor || host.via) + '</td>';";
+    html += "    html += '<td style=\"padding:10px;text-align:right\">' + host.rtt + ' ms</td>';";
+    html += "    html += '<td style=\"padding:10px\">' + ports + '</td>';";
+    html += "    html += '</tr>';";
+    html += "  });";
+    html += "  html += '</table>';";
+    html += "  document.getElementById('discoveryResults').innerHTML = html;";
+    html += "}";
+    
     html += "</script>";
     
     html += generateHtmlFooter();
@@ -4318,17 +5042,23 @@ void handlePortScanStart() {
     
     bool started = false;
     
+    bool grabBanners = webServer->hasArg("banners");
+    PortScanProtocol protocol = webServer->arg("proto") == "udp" ? PORTSCAN_PROTO_UDP : PORTSCAN_PROTO_TCP;
+    
     if (scanType == "common") {
-        started = startCommonPortScan(targetIP);
+        started = startCommonPortScan(targetIP, grabBanners, protocol);
     } else if (scanType == "well-known") {
-        started = startPortScan(targetIP, 1, 1024);
+        started = startPortScan(targetIP, 1, 1024, DEFAULT_SCAN_TIMEOUT, CONCURRENT_CONNECTIONS, grabBanners,
+                                protocol);
     } else if (scanType == "all") {
-        started = startPortScan(targetIP, 1, 65535);
+        started = startPortScan(targetIP, 1, 65535, DEFAULT_SCAN_TIMEOUT, CONCURRENT_CONNECTIONS, grabBanners,
+                                protocol);
     } else if (scanType == "range") {
         if (webServer->hasArg("start") && webServer->hasArg("end")) {
             uint16_t startPort = webServer->arg("start").toInt();
             uint16_t endPort = webServer->arg("end").toInt();
-            started = startPortScan(targetIP, startPort, endPort);
+            started = startPortScan(targetIP, startPort, endPort, DEFAULT_SCAN_TIMEOUT, CONCURRENT_CONNECTIONS,
+                                    grabBanners, protocol);
         }
     }
     
@@ -4366,25 +5096,57 @@ void handlePortScanStatus() {
     }
     json += "\",";
     json += "\"targetIP\":\"" + results.targetIP + "\",";
+    json += "\"protocol\":\"" + String(activePortScanConfig.protocol == PORTSCAN_PROTO_UDP ? "udp" : "tcp") + "\",";
     json += "\"totalPorts\":" + String(results.totalPorts) + ",";
     json += "\"portsScanned\":" + String(results.portsScanned) + ",";
     json += "\"currentPort\":" + String(results.portsScanned + 1) + ",";
     json += "\"openPorts\":" + String(results.openPorts) + ",";
     json += "\"closedPorts\":" + String(results.closedPorts) + ",";
+    json += "\"filteredPorts\":" + String(results.filteredPorts) + ",";
+    json += "\"openFilteredPorts\":" + String(results.openFilteredPorts) + ",";
+    json += "\"rttMs\":" + String(results.smoothedRttMs) + ",";
+    json += "\"timeoutMs\":" + String(results.probeTimeoutMs) + ",";
     json += "\"progress\":" + String(getPortScanProgress()) + ",";
+    json += "\"identifying\":" + String(results.identifying ? "true" : "false") + ",";
+    json += "\"servicesIdentified\":" + String(results.servicesIdentified) + ",";
     
     if (results.scanCompleted) {
         unsigned long duration = (results.endTime - results.startTime) / 1000;
         json += "\"duration\":" + String(duration) + ",";
     }
     
+    // All open ports come from the result bitmap, paged through a small buffer
     json += "\"ports\":[";
-    for (size_t i = 0; i < results.openPortsList.size(); i++) {
-        if (i > 0) json += ",";
-        json += "{";
-        json += "\"port\":" + String(results.openPortsList[i].port) + ",";
-        json += "\"service\":\"" + results.openPortsList[i].service + "\"";
-        json += "}";
+    uint16_t page[32];
+    uint16_t after = 0;
+    bool first = true;
+    uint16_t count;
+    while ((count = getOpenPorts(page, 32, after)) > 0) {
+        for (uint16_t i = 0; i < count; i++) {
+            if (!first) json += ",";
+            first = false;
+            const PortInfo* info = nullptr;
+            for (uint8_t j = 0; j < results.openListCount; j++) {
+                if (results.openPortsList[j].port == page[i]) {
+                    info = &results.openPortsList[j];
+                    break;
+                }
+            }
+            json += "{";
+            json += "\"port\":" + String(page[i]) + ",";
+            const char* service = info != nullptr ? info->service
+                                                  : getServiceName(page[i], activePortScanConfig.protocol);
+            json += "\"service\":\"" + String(service) + "\"";
+            if (info != nullptr) {
+                // Banner text is sanitised by the scanner (no quotes, backslashes or tags)
+                json += ",\"responseTime\":" + String(info->responseTime);
+                json += ",\"fingerprinted\":" + String(info->fingerprinted ? "true" : "false");
+                json += ",\"banner\":\"" + String(info->banner) + "\"";
+            }
+            json += "}";
+        }
+        after = page[count - 1];
+        if (count < 32) break;
     }
     json += "]";
     json += "}";
@@ -4392,6 +5154,138 @@ void handlePortScanStatus() {
     webServer->send(200, "application/json", json);
 }
 
+// ==========================================
+// PORT SCANNER EVENT STREAM (SSE)
+// ==========================================
+#define PORTSCAN_STREAM_CLIENTS 2
+#define PORTSCAN_STREAM_KEEPALIVE_MS 15000
+
+// Open /portscan/events connections; the scan task's events are written to
+// them from loop(), so nothing is rebuilt per request while a scan runs
+static WiFiClient portScanStreams[PORTSCAN_STREAM_CLIENTS];
+static unsigned long lastStreamKeepalive = 0;
+
+static void writePortScanStreams(const char* message, size_t length) {
+    for (WiFiClient& stream : portScanStreams) {
+        if (!stream) continue;
+        if (stream.write((const uint8_t*)message, length) != length) {
+            stream.stop();  // Browser went away
+        }
+    }
+}
+
+static size_t formatPortScanEvent(const PortScanEvent& event, char* message, size_t size) {
+    int length = 0;
+    switch (event.type) {
+        case PORTSCAN_EVENT_OPEN:
+            length = snprintf(message, size,
+                              "event: open\ndata: {\"port\":%u,\"service\":\"%s\",\"responseTime\":%lu,"
+                              "\"fingerprinted\":%s}\n\n",
+                              event.port, event.service, (unsigned long)event.value,
+                              event.fingerprinted ? "true" : "false");
+            break;
+        case PORTSCAN_EVENT_PROGRESS:
+            length = snprintf(message, size, "event: progress\ndata: {\"progress\":%lu}\n\n",
+                              (unsigned long)event.value);
+            break;
+        case PORTSCAN_EVENT_SERVICE:
+            // Detail text is sanitised by the scanner (no quotes, backslashes or tags)
+            length = snprintf(message, size,
+                              "event: service\ndata: {\"port\":%u,\"service\":\"%s\",\"banner\":\"%s\"}\n\n",
+                              event.port, event.service, event.detail);
+            break;
+        case PORTSCAN_EVENT_DONE:
+            length = snprintf(message, size, "event: done\ndata: {\"completed\":%s}\n\n",
+                              event.value ? "true" : "false");
+            break;
+    }
+    return length > 0 && (size_t)length < size ? (size_t)length : 0;
+}
+
+void handlePortScanEvents() {
+    WiFiClient* slot = nullptr;
+    for (WiFiClient& stream : portScanStreams) {
+        if (!stream.connected()) {
+            stream.stop();
+            slot = &stream;
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        webServer->send(503, "application/json", "{\"error\":\"Too many event streams\"}");
+        return;
+    }
+    
+    // Headers go straight to the socket: the response never ends, and our
+    // copy of the client keeps the connection open after this handler returns
+    WiFiClient client = webServer->client();
+    client.setNoDelay(true);
+    client.print("HTTP/1.1 200 OK\r\n"
+                 "Content-Type: text/event-stream\r\n"
+                 "Cache-Control: no-cache\r\n"
+                 "Connection: keep-alive\r\n\r\n");
+    
+    // Current position, so a late subscriber (or a scan that already ended) is in sync
+    char message[64];
+    PortScanState state = getPortScanState();
+    int length = state == PORTSCAN_RUNNING
+        ? snprintf(message, sizeof(message), "event: progress\ndata: {\"progress\":%u}\n\n", getPortScanProgress())
+        : snprintf(message, sizeof(message), "event: done\ndata: {\"completed\":%s}\n\n",
+                   state == PORTSCAN_COMPLETED ? "true" : "false");
+    client.write((const uint8_t*)message, length);
+    *slot = client;
+}
+
+static void pumpPortScanEvents() {
+    // Drained even with no subscriber, so a new stream never sees stale events
+    PortScanEvent event;
+    char message[192];
+    while (getPortScanEvent(event)) {
+        size_t length = formatPortScanEvent(event, message, sizeof(message));
+        if (length > 0) {
+            writePortScanStreams(message, length);
+        }
+    }
+    
+    if (millis() - lastStreamKeepalive >= PORTSCAN_STREAM_KEEPALIVE_MS) {
+        // Comment line: ignored by EventSource, detects closed connections
+        static const char KEEPALIVE[] = ": keepalive\n\n";
+        lastStreamKeepalive = millis();
+        writePortScanStreams(KEEPALIVE, sizeof(KEEPALIVE) - 1);
+    }
+}
+
+static void closePortScanStreams() {
+    for (WiFiClient& stream : portScanStreams) {
+        stream.stop();
+    }
+}
+
+// ==========================================
+// HOST DISCOVERY ENDPOINTS
+// ==========================================
+void handleHostDiscover() {
+    String action = webServer->hasArg("action") ? webServer->arg("action") : "start";
+    
+    if (action == "stop") {
+        stopHostDiscovery();
+        webServer->send(200, "application/json", "{\"success\":true}");
+        return;
+    }
+    
+    bool started = startHostDiscovery(webServer->hasArg("scan"));
+    String json = "{\"success\":" + String(started ? "true" : "false");
+    if (!started) {
+        json += ",\"error\":\"Discovery already running, port scan active, or not connected\"";
+    }
+    json += "}";
+    webServer->send(200, "application/json", json);
+}
+
+void handleHostDiscoveryStatus() {
+    webServer->send(200, "application/json", exportHostDiscoveryJSON(getHostDiscoveryResults()));
+}
+
 // ==========================================
 // PORT SCANNER API ENDPOINT
 // ==========================================
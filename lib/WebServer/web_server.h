@@ -123,6 +123,13 @@ void handleScan();
  */
 void handleScanDetails();
 
+/**
+ * @brief Handle scan events API (/scan/events?since=<sequence>)
+ * @details Returns the networks that appeared, vanished or changed between
+ *          scans as JSON, plus the cursor for the next poll
+ */
+void handleScanEvents();
+
 /**
  * @brief Handle network analysis page (/network)
  * @details Provides network analysis dashboard
@@ -165,6 +172,30 @@ void handleLatencyStart();
  */
 void handleLatencyStop();
 
+/**
+ * @brief Handle traceroute page (/traceroute)
+ * @details Provides traceroute form and live per-hop table
+ */
+void handleTraceroute();
+
+/**
+ * @brief Handle traceroute start endpoint (/traceroute/start)
+ * @details Starts a traceroute or MTR run with the submitted target and probe type
+ */
+void handleTracerouteStart();
+
+/**
+ * @brief Handle traceroute stop endpoint (/traceroute/stop)
+ * @details Stops the running traceroute
+ */
+void handleTracerouteStop();
+
+/**
+ * @brief Handle traceroute status endpoint (/traceroute/status)
+ * @details Returns current per-hop results as JSON for polling
+ */
+void handleTracerouteStatus();
+
 /**
  * @brief Handle iPerf page (/iperf)
  * @details Provides iPerf testing interface
@@ -205,7 +236,31 @@ void handlePortScanner();
 void handlePortScanStart();
 void handlePortScanStop();
 void handlePortScanStatus();
+
+/**
+ * @brief Handle port scan event stream (/portscan/events)
+ * @details Server-Sent Events: open, progress, service and done events are
+ *          pushed as the scan task produces them
+ */
+void handlePortScanEvents();
 void handlePortScanAPI();
+
+/**
+ * @brief Handle rogue AP detector page (/rogue)
+ * @details Shows alerts and protected SSIDs with learn, forget and
+ *          monitoring controls
+ */
+void handleRoguePage();
+void handleRogueAPI();
+
+/**
+ * @brief Handle rogue AP detector form posts (/rogue/action)
+ * @details action=on|off|clear|learn|forget (learn and forget take ssid),
+ *          then redirects back to /rogue
+ */
+void handleRogueAction();
+void handleHostDiscover();
+void handleHostDiscoveryStatus();
 void handleNotFound();
 
 #endif // USE_WEBSERVER
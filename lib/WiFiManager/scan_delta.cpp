@@ -0,0 +1,214 @@
+/**
+ * @file scan_delta.cpp
+ * @brief Scan-to-scan network event implementation
+ *
+ * This file implements:
+ * - Open-addressing BSSID hash table with linear probing and
+ *   backward-shift deletion (no tombstones)
+ * - Appeared, channel, auth and RSSI events while a scan is fed
+ * - Vanished events for networks missing from scans covering their channel
+ * - Event ring with per-reader cursors
+ *
+ * @author Arunkumar Mourougappane
+ * @version 5.0.0
+ * @date 2026-01-17
+ */
+
+#include "scan_delta.h"
+#include <stdlib.h>
+#include <string.h>
+
+static_assert((SCAN_DELTA_SLOTS & (SCAN_DELTA_SLOTS - 1)) == 0, "Slot count must be a power of two");
+static_assert(SCAN_DELTA_MAX_TRACKED < SCAN_DELTA_SLOTS, "The table needs a free slot to end probe chains");
+
+// ==========================================
+// BSSID HASH TABLE
+// ==========================================
+
+// FNV-1a over the six BSSID bytes
+static uint32_t bssidHash(const uint8_t* bssid) {
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; i < 6; i++) {
+        hash ^= bssid[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint16_t homeSlot(const uint8_t* bssid) {
+    return bssidHash(bssid) & (SCAN_DELTA_SLOTS - 1);
+}
+
+// Slot holding the BSSID, or the free slot that ends its probe chain
+static uint16_t probe(const ScanDeltaEngine& engine, const uint8_t* bssid) {
+    uint16_t slot = homeSlot(bssid);
+    while (engine.slots[slot].used &&
+           memcmp(engine.slots[slot].network.bssid, bssid, sizeof(engine.slots[slot].network.bssid)) != 0) {
+        slot = (slot + 1) & (SCAN_DELTA_SLOTS - 1);
+    }
+    return slot;
+}
+
+// Free a slot and pull later members of its probe chains back into the gap
+static void removeSlot(ScanDeltaEngine& engine, uint16_t slot) {
+    uint16_t gap = slot;
+    uint16_t next = (gap + 1) & (SCAN_DELTA_SLOTS - 1);
+    while (engine.slots[next].used) {
+        uint16_t home = homeSlot(engine.slots[next].network.bssid);
+        // Move the entry if its home is not between the gap and where it sits
+        uint16_t fromHome = (next - home) & (SCAN_DELTA_SLOTS - 1);
+        uint16_t fromGap = (next - gap) & (SCAN_DELTA_SLOTS - 1);
+        if (fromHome >= fromGap) {
+            engine.slots[gap] = engine.slots[next];
+            gap = next;
+        }
+        next = (next + 1) & (SCAN_DELTA_SLOTS - 1);
+    }
+    engine.slots[gap].used = false;
+    engine.tracked--;
+}
+
+// ==========================================
+// EVENTS
+// ==========================================
+
+static void emit(ScanDeltaEngine& engine, uint8_t type, const ScanDeltaNetwork& network, uint8_t previousChannel,
+                 int8_t previousRssi, uint8_t previousAuthMode) {
+    ScanDeltaEvent& event = engine.events[engine.nextSequence % SCAN_DELTA_EVENTS];
+    event.sequence = engine.nextSequence++;
+    event.generation = engine.generation;
+    event.type = type;
+    event.previousChannel = previousChannel;
+    event.previousRssi = previousRssi;
+    event.previousAuthMode = previousAuthMode;
+    event.network = network;
+}
+
+void scanDeltaClear(ScanDeltaEngine& engine) {
+    memset(&engine, 0, sizeof(engine));
+    engine.nextSequence = 1;
+    engine.rssiThreshold = SCAN_DELTA_RSSI_DB;
+}
+
+void scanDeltaSetRssiThreshold(ScanDeltaEngine& engine, uint8_t db) {
+    engine.rssiThreshold = db > 0 ? db : 1;
+}
+
+// ==========================================
+// DIFFING
+// ==========================================
+
+void scanDeltaBegin(ScanDeltaEngine& engine, uint32_t generation, uint16_t channelMask) {
+    engine.generation = generation;
+    engine.channelMask = channelMask;
+    engine.scanSequence = engine.nextSequence;
+    engine.untracked = 0;
+    engine.pass++;
+}
+
+void scanDeltaAdd(ScanDeltaEngine& engine, const ScanDeltaNetwork& network) {
+    uint16_t slot = probe(engine, network.bssid);
+    ScanDeltaEntry& entry = engine.slots[slot];
+
+    if (!entry.used) {
+        if (engine.tracked >= SCAN_DELTA_MAX_TRACKED) {
+            engine.untracked++;
+            return;
+        }
+        entry.network = network;
+        entry.seenGeneration = engine.generation;
+        entry.reportedRssi = network.rssi;
+        entry.missed = 0;
+        entry.checked = engine.pass;
+        entry.used = true;
+        engine.tracked++;
+        emit(engine, SCAN_DELTA_APPEARED, network, network.channel, network.rssi, network.authMode);
+        return;
+    }
+    if (entry.seenGeneration == engine.generation) return;
+
+    ScanDeltaNetwork previous = entry.network;
+    entry.network = network;
+    entry.seenGeneration = engine.generation;
+    entry.missed = 0;
+    entry.checked = engine.pass;
+
+    if (network.channel != previous.channel) {
+        emit(engine, SCAN_DELTA_CHANNEL, network, previous.channel, previous.rssi, previous.authMode);
+    }
+    if (network.authMode != previous.authMode) {
+        emit(engine, SCAN_DELTA_AUTH, network, previous.channel, previous.rssi, previous.authMode);
+    }
+    if (abs(network.rssi - entry.reportedRssi) >= engine.rssiThreshold) {
+        emit(engine, SCAN_DELTA_RSSI, network, previous.channel, entry.reportedRssi, previous.authMode);
+        entry.reportedRssi = network.rssi;
+    }
+}
+
+uint16_t scanDeltaEnd(ScanDeltaEngine& engine) {
+    uint16_t slot = 0;
+    while (slot < SCAN_DELTA_SLOTS) {
+        ScanDeltaEntry& entry = engine.slots[slot];
+        // Removal can pull an already checked entry back into this slot, so
+        // each entry is stamped and checked once per pass
+        if (!entry.used || entry.checked == engine.pass) {
+            slot++;
+            continue;
+        }
+        entry.checked = engine.pass;
+        if (entry.seenGeneration == engine.generation ||
+            (engine.channelMask & (1u << entry.network.channel)) == 0 || ++entry.missed < SCAN_DELTA_MISS_LIMIT) {
+            slot++;
+            continue;
+        }
+        emit(engine, SCAN_DELTA_VANISHED, entry.network, entry.network.channel, entry.network.rssi,
+             entry.network.authMode);
+        removeSlot(engine, slot);  // Re-examine the slot: a later entry may have moved in
+    }
+    return (uint16_t)(engine.nextSequence - engine.scanSequence);
+}
+
+// ==========================================
+// READERS
+// ==========================================
+
+uint32_t scanDeltaSequence(const ScanDeltaEngine& engine) {
+    return engine.nextSequence;
+}
+
+uint16_t scanDeltaRead(const ScanDeltaEngine& engine, uint32_t& cursor, ScanDeltaEvent* events, uint16_t max,
+                       uint32_t* skipped) {
+    uint32_t oldest = engine.nextSequence > SCAN_DELTA_EVENTS ? engine.nextSequence - SCAN_DELTA_EVENTS : 1;
+    uint32_t lost = 0;
+    if (cursor == 0) {
+        cursor = oldest;
+    } else if (cursor < oldest) {
+        lost = oldest - cursor;
+        cursor = oldest;
+    }
+    if (cursor > engine.nextSequence) cursor = engine.nextSequence;  // Engine was cleared
+    if (skipped != nullptr) *skipped = lost;
+
+    uint16_t copied = 0;
+    while (copied < max && cursor < engine.nextSequence) {
+        events[copied++] = engine.events[cursor % SCAN_DELTA_EVENTS];
+        cursor++;
+    }
+    return copied;
+}
+
+const ScanDeltaEntry* scanDeltaFind(const ScanDeltaEngine& engine, const uint8_t bssid[6]) {
+    uint16_t slot = probe(engine, bssid);
+    return engine.slots[slot].used ? &engine.slots[slot] : nullptr;
+}
+
+const char* scanDeltaTypeName(uint8_t type) {
+    switch (type) {
+        case SCAN_DELTA_APPEARED: return "appeared";
+        case SCAN_DELTA_VANISHED: return "vanished";
+        case SCAN_DELTA_RSSI: return "rssi";
+        case SCAN_DELTA_CHANNEL: return "channel";
+        case SCAN_DELTA_AUTH: return "auth";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,169 @@
+/**
+ * @file scan_delta.h
+ * @brief Differences between consecutive WiFi scans as network events
+ *
+ * Periodic scans mostly see the same networks again. This module diffs each
+ * scan against the networks it is tracking and turns the differences into
+ * events: a network appeared, vanished, changed channel, changed security,
+ * or its signal moved by more than a threshold. Consumers (serial output,
+ * web page, log, rogue AP checks) read the events instead of comparing full
+ * tables.
+ *
+ * Tracked networks live in an open-addressing hash table keyed by BSSID, so
+ * each network in a scan costs one lookup. A network only vanishes after it
+ * is missing from SCAN_DELTA_MISS_LIMIT scans that covered its channel, so a
+ * single missed beacon or a partial channel schedule does not make it flap.
+ * Signal changes are measured against the last reported level, so slow
+ * drift is reported once it adds up.
+ *
+ * Events go into a fixed ring with increasing sequence numbers. Each reader
+ * keeps its own cursor; a reader that falls behind by more than the ring
+ * skips ahead and is told how many events it missed.
+ *
+ * The module is plain C++ with no Arduino dependencies.
+ * pc_test_apps/scan_delta_test exercises it on Linux.
+ *
+ * @author Arunkumar Mourougappane
+ * @version 5.0.0
+ * @date 2026-01-17
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==========================================
+// SCAN DELTA CONFIGURATION
+// ==========================================
+#define SCAN_DELTA_SLOTS 128          // BSSID hash table slots (power of two)
+#define SCAN_DELTA_MAX_TRACKED 96     // Networks tracked at once (keeps probe chains short)
+#define SCAN_DELTA_EVENTS 64          // Events kept for readers
+#define SCAN_DELTA_MISS_LIMIT 2       // Scans covering its channel a network may miss before it vanishes
+#define SCAN_DELTA_RSSI_DB 10         // Default signal change worth reporting
+#define SCAN_DELTA_SSID_LENGTH 32
+
+// ==========================================
+// SCAN DELTA STRUCTURES
+// ==========================================
+
+enum ScanDeltaType : uint8_t {
+    SCAN_DELTA_APPEARED = 0,    ///< BSSID not tracked before
+    SCAN_DELTA_VANISHED,        ///< Missing from SCAN_DELTA_MISS_LIMIT covering scans
+    SCAN_DELTA_RSSI,            ///< Signal moved by the threshold since last reported
+    SCAN_DELTA_CHANNEL,         ///< Primary channel changed
+    SCAN_DELTA_AUTH             ///< Security mode changed
+};
+
+/**
+ * @brief A network as the delta engine sees it
+ */
+struct ScanDeltaNetwork {
+    char ssid[SCAN_DELTA_SSID_LENGTH + 1];  ///< NUL-terminated, empty for hidden networks
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t rssi;
+    uint8_t authMode;           ///< wifi_auth_mode_t
+    uint16_t id;                ///< Stable scan table ID
+};
+
+/**
+ * @brief One change between scans
+ * @details network holds the new state (the last known state for
+ *          SCAN_DELTA_VANISHED); the previous fields hold the old values
+ */
+struct ScanDeltaEvent {
+    uint32_t sequence;          ///< 1 for the first event, +1 per event
+    uint32_t generation;        ///< Scan that produced the event
+    uint8_t type;               ///< ScanDeltaType
+    uint8_t previousChannel;
+    int8_t previousRssi;
+    uint8_t previousAuthMode;
+    ScanDeltaNetwork network;
+};
+
+struct ScanDeltaEntry {
+    ScanDeltaNetwork network;
+    uint32_t seenGeneration;    ///< Last scan that reported the network
+    int8_t reportedRssi;        ///< Level of the last appeared or RSSI event
+    uint8_t missed;             ///< Covering scans missed in a row
+    uint8_t checked;            ///< Pass stamp while looking for vanished networks
+    bool used;
+};
+
+struct ScanDeltaEngine {
+    ScanDeltaEntry slots[SCAN_DELTA_SLOTS];
+    uint16_t tracked;           ///< Used slots
+    uint16_t untracked;         ///< Networks of the current scan that did not fit
+    ScanDeltaEvent events[SCAN_DELTA_EVENTS];
+    uint32_t nextSequence;      ///< Sequence of the next event
+    uint32_t scanSequence;      ///< Sequence of the first event of the scan being diffed
+    uint32_t generation;        ///< Scan being diffed
+    uint16_t channelMask;       ///< Channels it covered (bit n = channel n)
+    uint8_t rssiThreshold;      ///< Signal change in dB that makes an event
+    uint8_t pass;               ///< Incremented per scan, stamps entries when checked
+};
+
+// ==========================================
+// SCAN DELTA API
+// ==========================================
+
+/**
+ * @brief Forget all networks and events and restore the default threshold
+ */
+void scanDeltaClear(ScanDeltaEngine& engine);
+
+/**
+ * @brief Set the signal change that makes an RSSI event
+ * @param db Change in dB (at least 1)
+ */
+void scanDeltaSetRssiThreshold(ScanDeltaEngine& engine, uint8_t db);
+
+/**
+ * @brief Start diffing a scan
+ * @param generation Scan generation, stamped on the events
+ * @param channelMask Channels the scan covered; networks on other channels
+ *        are not counted as missed
+ */
+void scanDeltaBegin(ScanDeltaEngine& engine, uint32_t generation, uint16_t channelMask);
+
+/**
+ * @brief Feed one network of the scan
+ * @details Emits appeared, channel, auth and RSSI events. A BSSID fed twice
+ *          in one scan is only compared once
+ */
+void scanDeltaAdd(ScanDeltaEngine& engine, const ScanDeltaNetwork& network);
+
+/**
+ * @brief Finish the scan, emitting vanished events
+ * @return Events emitted for the whole scan
+ */
+uint16_t scanDeltaEnd(ScanDeltaEngine& engine);
+
+/**
+ * @brief Sequence the next event will get; a reader starting now uses it as its cursor
+ */
+uint32_t scanDeltaSequence(const ScanDeltaEngine& engine);
+
+/**
+ * @brief Copy the events after a cursor and advance it
+ * @param cursor Sequence of the first event wanted, 0 for the oldest still
+ *        held; updated past the copied events
+ * @param events Output array
+ * @param max Capacity of events
+ * @param skipped Optional, receives the number of events already overwritten
+ * @return Events copied; call again while it returns max
+ */
+uint16_t scanDeltaRead(const ScanDeltaEngine& engine, uint32_t& cursor, ScanDeltaEvent* events, uint16_t max,
+                       uint32_t* skipped = nullptr);
+
+/**
+ * @brief Look up a tracked network by BSSID
+ * @return The entry, or nullptr if the BSSID is not tracked
+ */
+const ScanDeltaEntry* scanDeltaFind(const ScanDeltaEngine& engine, const uint8_t bssid[6]);
+
+/**
+ * @brief "appeared", "vanished", "rssi", "channel" or "auth"
+ */
+const char* scanDeltaTypeName(uint8_t type);
@@ -6,6 +6,7 @@
  * - WiFi mode control (Station, AP, Idle)
  * - Network scanning with security validation
  * - Network connection with security preference enforcement
+ * - Event-driven station state machine with per-reason retry backoff
  * - Access Point configuration and startup
  * - QR code generation for AP credentials
  * - Security type validation and filtering
@@ -21,6 +22,8 @@
 #include "ap_config.h"
 #include "station_config.h"
 #include "logging.h"
+#include "wifi_scan.h"
+#include "wifi_task.h"
 #include <WiFi.h>
 #include <WiFiAP.h>
 #include <WiFiUdp.h>
@@ -45,14 +48,22 @@ unsigned long lastScan = 0;
 unsigned long lastBlink = 0;
 bool ledState = false;
 
-// Connection state tracking for non-blocking operation
-static bool isConnecting = false;
+// Connection being made or kept by the station state machine
 static unsigned long connectionStartTime = 0;
 static String connectingSSID = "";
 static String connectingPassword = "";
-static int connectionAttempts = 0;
 static StationSecurityPreference currentSecurityPreference = STA_SEC_AUTO;
 
+// Fast reconnect: directed join to the cached BSSID/channel with the cached lease
+static bool fastConnectAttempt = false;
+static bool staticLeaseApplied = false;
+static uint8_t connectedAuthMode = WIFI_AUTH_WPA2_PSK;  // Security of the current link, for the cache
+
+// Connection waiting for scan results to validate its security preference
+static String pendingConnectSSID = "";
+static String pendingConnectPassword = "";
+static StationSecurityPreference pendingConnectPreference = STA_SEC_AUTO;
+
 // ==========================================
 // ACCESS POINT CONFIGURATION VARIABLES
 // ==========================================
@@ -205,6 +216,9 @@ static const char* securityPreferenceToString(StationSecurityPreference preferen
 // WIFI INITIALIZATION
 // ==========================================
 void initializeWiFi() {
+  // Shared scan store used by every scan consumer
+  initializeWiFiScan();
+  
   // Initialize AP configuration system
   initAPConfig();
   
@@ -234,6 +248,7 @@ void initializeWiFi() {
     
     // Start station mode and connect
     WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false);  // Retries are the station state machine's job
     delay(100);
     currentMode = MODE_STATION;
     
@@ -252,6 +267,7 @@ void startStationMode() {
   delay(100);
   
   WiFi.mode(WIFI_STA);
+  WiFi.setAutoReconnect(false);  // Retries are the station state machine's job
   WiFi.disconnect();
   
   delay(100);
@@ -480,18 +496,27 @@ void setIdleMode() {
 // ==========================================
 // WIFI SCANNING
 // ==========================================
-void performWiFiScan() {
-  Serial.println("\n🔍 === WiFi Network Scanner === 🔍");
-  Serial.println("Scanning for available networks...");
+
+/**
+ * @brief Print the scan table and summary from the shared scan store
+ * @param success false if the background scan failed
+ */
+static void printWiFiScanResults(bool success) {
+  if (!success) {
+    Serial.println("❌ WiFi scan failed");
+    RESET_PROMPT();
+    return;
+  }
   
-  // Start comprehensive scan
-  int networkCount = WiFi.scanNetworks(false, true); // async=false, show_hidden=true
+  const WiFiScanStore& store = lockWiFiScanStore();
+  int networkCount = store.count;
   
   if (networkCount == 0) {
     Serial.println("❌ No networks found");
     Serial.println("Try moving closer to WiFi access points or check antenna connection");
   } else {
-    Serial.printf("✅ Discovered %d networks:\n\n", networkCount);
+    Serial.printf("✅ Discovered %d networks from %u radios (scan #%lu):\n\n", networkCount, store.radioCount,
+                  (unsigned long)store.generation);
     
     // Print detailed header
     Serial.println("╔════╤═══════════════════════════╤══════╤════╤══════════════════╤═════════╤═══════════════════╗");
@@ -500,20 +525,20 @@ void performWiFiScan() {
     
     for (int i = 0; i < networkCount; ++i) {
       // Get network details
-      String ssid = WiFi.SSID(i);
-      int32_t rssi = WiFi.RSSI(i);
-      uint8_t channel = WiFi.channel(i);
-      wifi_auth_mode_t encryptionType = WiFi.encryptionType(i);
-      uint8_t* bssid = WiFi.BSSID(i);
-      
-      // Handle empty/hidden SSIDs
-      if (ssid.length() == 0) {
-        ssid = "<Hidden Network>";
-      }
+      const ScanRecord& network = store.records[i];
+      int32_t rssi = network.rssi;
+      uint8_t channel = network.channel;
+      wifi_auth_mode_t encryptionType = (wifi_auth_mode_t)network.authMode;
+      const uint8_t* bssid = network.bssid;
       
-      // Truncate long SSIDs
-      if (ssid.length() > 25) {
-        ssid = ssid.substring(0, 22) + "...";
+      // Handle empty/hidden SSIDs and truncate long ones
+      char ssid[26];
+      if (network.ssid[0] == '\0') {
+        snprintf(ssid, sizeof(ssid), "<Hidden Network>");
+      } else if (strlen(network.ssid) > 25) {
+        snprintf(ssid, sizeof(ssid), "%.22s...", network.ssid);
+      } else {
+        snprintf(ssid, sizeof(ssid), "%s", network.ssid);
       }
       
       // Calculate signal quality percentage
@@ -526,7 +551,7 @@ void performWiFiScan() {
       else quality = 0;
       
       // Print network row
-      Serial.printf("║%3d │ %-25s │%5d │%3d │", i + 1, ssid.c_str(), rssi, channel);
+      Serial.printf("║%3u │ %-25s │%5d │%3d │", network.id, ssid, rssi, channel);
       
       // Print encryption type with icon
       String encStr = "";
@@ -573,12 +598,8 @@ void performWiFiScan() {
       Serial.printf(" %s %3d%% │", qualityStr.c_str(), quality);
       
       // Print BSSID (MAC address)
-      if (bssid) {
-        Serial.printf(" %02X:%02X:%02X:%02X:%02X:%02X ║\n", 
-                     bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
-      } else {
-        Serial.printf(" ??:??:??:??:??:?? ║\n");
-      }
+      Serial.printf(" %02X:%02X:%02X:%02X:%02X:%02X ║\n", 
+                   bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
     }
     
     Serial.println("╚════╧═══════════════════════════╧══════╧════╧══════════════════╧═════════╧═══════════════════╝");
@@ -591,8 +612,8 @@ void performWiFiScan() {
     int strongSignals = 0, weakSignals = 0;
     
     for (int i = 0; i < networkCount; ++i) {
-      wifi_auth_mode_t encType = WiFi.encryptionType(i);
-      int32_t rssi = WiFi.RSSI(i);
+      wifi_auth_mode_t encType = (wifi_auth_mode_t)store.records[i].authMode;
+      int32_t rssi = store.records[i].rssi;
       
       switch (encType) {
         case WIFI_AUTH_OPEN: openNetworks++; break;
@@ -617,7 +638,7 @@ void performWiFiScan() {
     // Channel usage analysis
     uint8_t channelCount[14] = {0}; // Channels 1-13 (14 is special)
     for (int i = 0; i < networkCount; ++i) {
-      uint8_t ch = WiFi.channel(i);
+      uint8_t ch = store.records[i].channel;
       if (ch >= 1 && ch <= 13) {
         channelCount[ch]++;
       }
@@ -640,37 +661,173 @@ void performWiFiScan() {
 
   }
   
-  // Clean up
-  WiFi.scanDelete();
+  unlockWiFiScanStore();
   RESET_PROMPT(); // Show prompt after scan results
 }
 
-void showNetworkDetails(int networkId) {
-  Serial.println("\n📡 === Detailed Network Information === 📡");
+void performWiFiScan() {
+  Serial.println("\n🔍 === WiFi Network Scanner === 🔍");
+  Serial.println("Scanning for available networks...");
   
-  // Perform a fresh scan to get current data
-  int networkCount = WiFi.scanNetworks(false, true);
+  // Results are printed from the main loop once the background scan lands
+  if (!requestWiFiScan(printWiFiScanResults)) {
+    Serial.println("❌ Could not start WiFi scan");
+    RESET_PROMPT();
+  }
+}
+
+// Event cursor of the periodic scan output, 0 = print the full table next
+static uint32_t scanUpdateCursor = 0;
+
+/**
+ * @brief Print one scan event as a single line
+ */
+static void printWiFiScanEvent(const ScanDeltaEvent& event) {
+  const ScanDeltaNetwork& network = event.network;
+  char ssid[26];
+  if (network.ssid[0] == '\0') {
+    snprintf(ssid, sizeof(ssid), "<Hidden Network>");
+  } else if (strlen(network.ssid) > 25) {
+    snprintf(ssid, sizeof(ssid), "%.22s...", network.ssid);
+  } else {
+    snprintf(ssid, sizeof(ssid), "%s", network.ssid);
+  }
   
-  if (networkCount == 0) {
-    Serial.println("❌ No networks found. Run 'scan now' first.");
+  Serial.printf("  %3u │ %-25s │ ", network.id, ssid);
+  switch (event.type) {
+    case SCAN_DELTA_APPEARED:
+      Serial.printf("➕ Appeared  ch %u, %d dBm, %s\n", network.channel, network.rssi,
+                    getWiFiAuthModeName(network.authMode));
+      break;
+    case SCAN_DELTA_VANISHED:
+      Serial.printf("➖ Vanished  from ch %u (last %d dBm)\n", network.channel, network.rssi);
+      break;
+    case SCAN_DELTA_RSSI:
+      Serial.printf("📶 Signal    %d → %d dBm\n", event.previousRssi, network.rssi);
+      break;
+    case SCAN_DELTA_CHANNEL:
+      Serial.printf("🔀 Channel   %u → %u\n", event.previousChannel, network.channel);
+      break;
+    case SCAN_DELTA_AUTH:
+      Serial.printf("⚠️  Security  %s → %s\n", getWiFiAuthModeName(event.previousAuthMode),
+                    getWiFiAuthModeName(network.authMode));
+      break;
+  }
+}
+
+/**
+ * @brief Print the changes since the previous periodic scan
+ * @param success false if the background scan failed
+ */
+static void printWiFiScanChanges(bool success) {
+  if (scanUpdateCursor == 0) {
+    // First scan of a scanning session: the full table is the baseline
+    printWiFiScanResults(success);
+    if (success) scanUpdateCursor = getWiFiScanEventSequence();
+    return;
+  }
+  if (!success) {
+    Serial.println("❌ WiFi scan failed");
+    RESET_PROMPT();
     return;
   }
   
-  // Convert to 0-based index
-  int index = networkId - 1;
+  ScanDeltaEvent events[8];
+  uint32_t skipped = 0;
+  uint16_t count;
+  bool printedHeader = false;
+  while ((count = readWiFiScanEvents(scanUpdateCursor, events, 8, &skipped)) > 0) {
+    if (!printedHeader) {
+      const WiFiScanStore& store = lockWiFiScanStore();
+      Serial.printf("\n🔄 Scan #%lu: %u networks, changes:\n", (unsigned long)store.generation, store.count);
+      unlockWiFiScanStore();
+      printedHeader = true;
+    }
+    if (skipped > 0) {
+      Serial.printf("  … %lu older changes not shown\n", (unsigned long)skipped);
+    }
+    for (uint16_t i = 0; i < count; i++) {
+      printWiFiScanEvent(events[i]);
+    }
+  }
   
-  if (index < 0 || index >= networkCount) {
-    Serial.printf("❌ Invalid network ID. Valid range: 1-%d\n", networkCount);
+  // Quiet scans print nothing, so an unchanged neighbourhood stays quiet
+  if (printedHeader) {
+    RESET_PROMPT();
+  }
+}
+
+void performWiFiScanUpdate() {
+  if (!requestWiFiScan(printWiFiScanChanges)) {
+    LOG_WARN(TAG_WIFI, "Periodic scan could not start");
+  }
+}
+
+void startWiFiScanUpdates() {
+  scanUpdateCursor = 0;
+}
+
+void printWiFiScanEvents() {
+  ScanDeltaEvent events[8];
+  uint32_t cursor = 0;  // Oldest held
+  uint16_t count;
+  uint16_t total = 0;
+  uint32_t generation = 0;
+  
+  Serial.printf("\n🔄 === Scan Changes (signal threshold %u dB) ===\n", getWiFiScanEventThreshold());
+  while ((count = readWiFiScanEvents(cursor, events, 8)) > 0) {
+    for (uint16_t i = 0; i < count; i++) {
+      if (events[i].generation != generation) {
+        generation = events[i].generation;
+        Serial.printf("Scan #%lu:\n", (unsigned long)generation);
+      }
+      printWiFiScanEvent(events[i]);
+      total++;
+    }
+  }
+  if (total == 0) {
+    Serial.println("No changes recorded yet. Use 'scan on' or 'scan now' to start scanning.");
+  }
+  Serial.println();
+  RESET_PROMPT();
+}
+
+/**
+ * @brief Print the detail box for one network of the shared scan store
+ * @param networkId Stable network ID from the scan table
+ */
+static void printNetworkDetails(int networkId) {
+  const WiFiScanStore& store = lockWiFiScanStore();
+  int networkCount = store.count;
+  int index = findScanRecord(store, (uint16_t)networkId);
+  
+  if (index < 0) {
+    unlockWiFiScanStore();
+    Serial.printf("❌ Network ID %d is not in the last scan\n", networkId);
     Serial.println("💡 Use 'scan now' to see available networks");
+    RESET_PROMPT();
     return;
   }
   
   // Get detailed network information
-  String ssid = WiFi.SSID(index);
-  int32_t rssi = WiFi.RSSI(index);
-  uint8_t channel = WiFi.channel(index);
-  wifi_auth_mode_t encryptionType = WiFi.encryptionType(index);
-  uint8_t* bssid = WiFi.BSSID(index);
+  const ScanRecord& record = store.records[index];
+  String ssid = record.ssid;
+  int32_t rssi = record.rssi;
+  uint8_t channel = record.channel;
+  wifi_auth_mode_t encryptionType = (wifi_auth_mode_t)record.authMode;
+  uint8_t bssid[6];
+  memcpy(bssid, record.bssid, sizeof(bssid));
+  uint32_t generation = store.generation;
+  uint32_t ageMs = (uint32_t)(millis() - store.completedAt);
+  
+  // Channel congestion analysis
+  int channelUsage = 0;
+  for (int i = 0; i < networkCount; i++) {
+    if (store.records[i].channel == channel) {
+      channelUsage++;
+    }
+  }
+  unlockWiFiScanStore();
   
   // Handle hidden networks
   if (ssid.length() == 0) {
@@ -681,15 +838,17 @@ void showNetworkDetails(int networkId) {
   Serial.printf("│ 🏷️  Network Name: %-38s │\n", ssid.c_str());
   Serial.println("├─────────────────────────────────────────────────────────┤");
   
+  // Result age: details come from the last scan, not a live measurement
+  char age[16];
+  formatWiFiScanAge(ageMs, age, sizeof(age));
+  String ageString = String(age) + " (scan #" + String(generation) + ")";
+  Serial.printf("│ ⏱️  Last seen:    %-38s │\n", ageString.c_str());
+  
   // BSSID (MAC Address)
-  if (bssid) {
-    char bssidStr[18]; // XX:XX:XX:XX:XX:XX format
-    sprintf(bssidStr, "%02X:%02X:%02X:%02X:%02X:%02X", 
-            bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
-    Serial.printf("│ 🔗 BSSID (MAC):  %-38s │\n", bssidStr);
-  } else {
-    Serial.printf("│ 🔗 BSSID (MAC):  %-38s │\n", "Unknown");
-  }
+  char bssidStr[18]; // XX:XX:XX:XX:XX:XX format
+  sprintf(bssidStr, "%02X:%02X:%02X:%02X:%02X:%02X", 
+          bssid[0], bssid[1], bssid[2], bssid[3], bssid[4], bssid[5]);
+  Serial.printf("│ 🔗 BSSID (MAC):  %-38s │\n", bssidStr);
   
   // Signal Information
   Serial.printf("│ 📶 Signal (RSSI): %-37s │\n", String(rssi) + " dBm");
@@ -734,14 +893,6 @@ void showNetworkDetails(int networkId) {
   String channelString = String(channel) + " (" + bandInfo + ")";
   Serial.printf("│ 📻 Channel:      %-38s │\n", channelString.c_str());
   
-  // Channel congestion analysis
-  int channelUsage = 0;
-  for (int i = 0; i < networkCount; i++) {
-    if (WiFi.channel(i) == channel) {
-      channelUsage++;
-    }
-  }
-  
   String congestionLevel = "";
   if (channelUsage == 1) congestionLevel = "Clear";
   else if (channelUsage <= 3) congestionLevel = "Light";
@@ -842,59 +993,51 @@ void showNetworkDetails(int networkId) {
   }
   
   Serial.println();
-  
-  // Cleanup
-  WiFi.scanDelete();
   RESET_PROMPT();
 }
 
+void showNetworkDetails(int networkId) {
+  Serial.println("\n📡 === Detailed Network Information === 📡");
+  
+  // IDs come from the last scan table, so read that scan rather than rescanning
+  if (getWiFiScanGeneration() == 0) {
+    Serial.println("❌ No scan results yet. Run 'scan now' first.");
+    RESET_PROMPT();
+    return;
+  }
+  printNetworkDetails(networkId);
+}
+
 // ==========================================
 // NETWORK CONNECTION
 // ==========================================
 
 /**
  * @brief Find network by SSID in scan results
+ * @param store Locked scan store
  * @param ssid Network SSID to find
  * @return Network index (0-based) or -1 if not found
  */
-static int findNetworkBySSID(const String& ssid) {
-  int n = WiFi.scanComplete();
-  if (n <= 0) {
-    return -1;
-  }
-  
-  for (int i = 0; i < n; i++) {
-    if (WiFi.SSID(i).equals(ssid)) {
-      return i;
-    }
-  }
-  
-  return -1;
+static int findNetworkBySSID(const WiFiScanStore& store, const String& ssid) {
+  return findScanRecordBySsid(store, ssid.c_str());
 }
 
 /**
  * @brief Find best matching network based on security preference
+ * @param store Locked scan store
  * @param ssid Target network SSID
  * @param preference Security preference
  * @return Best matching network index or -1 if no suitable network found
  */
-static int findBestSecurityMatch(const String& ssid, StationSecurityPreference preference) {
-  int n = WiFi.scanComplete();
-  if (n <= 0) {
-    return -1;
-  }
-  
+static int findBestSecurityMatch(const WiFiScanStore& store, const String& ssid, StationSecurityPreference preference) {
   int bestMatch = -1;
   int bestScore = -1;
   
   // For WPA3_PREFER, find the most secure version of the network
   if (preference == STA_SEC_WPA3_PREFER) {
-    for (int i = 0; i < n; i++) {
-      if (!WiFi.SSID(i).equals(ssid)) {
-        continue;
-      }
-      
-      wifi_auth_mode_t authMode = (wifi_auth_mode_t)WiFi.encryptionType(i);
+    for (int i = findScanRecordBySsid(store, ssid.c_str()); i >= 0;
+         i = findScanRecordBySsid(store, ssid.c_str(), i)) {
+      wifi_auth_mode_t authMode = (wifi_auth_mode_t)store.records[i].authMode;
       int score = 0;
       
       // Score networks by security level
@@ -925,7 +1068,7 @@ static int findBestSecurityMatch(const String& ssid, StationSecurityPreference p
       }
       
       // Factor in signal strength
-      int rssi = WiFi.RSSI(i);
+      int rssi = store.records[i].rssi;
       if (rssi > -50) score += 10;
       else if (rssi > -70) score += 5;
       
@@ -936,98 +1079,206 @@ static int findBestSecurityMatch(const String& ssid, StationSecurityPreference p
     }
   } else {
     // For other preferences, just find the first matching network
-    bestMatch = findNetworkBySSID(ssid);
+    bestMatch = findNetworkBySSID(store, ssid);
   }
   
   return bestMatch;
 }
 
 /**
- * @brief Connects to a WiFi network using SSID and password (non-blocking)
- * 
- * This function initiates a connection to a specific WiFi network when
- * the ESP32 is in station mode. The connection process is asynchronous -
- * this function starts the connection and returns immediately. Call
- * handleWiFiConnection() periodically to monitor connection progress.
- * 
- * For WPA3_PREFER mode, this function will scan available networks first
- * and select the most secure version (WPA3 if available, fallback to WPA2).
- * 
- * @param ssid Network name to connect to
- * @param password Network password for authentication
- * @param securityPreference Security level requirement (default: AUTO)
- * 
- * @pre Device must be in station mode (MODE_STATION)
- * @pre SSID must be available and in range
- * @pre Password must be correct for the target network
- * 
- * @note Connection timeout is set to 10 seconds
- * @note This is a non-blocking call - returns immediately after initiating connection
- * @note Use handleWiFiConnection() in main loop to monitor progress
- * @note Security validation occurs after connection is established
- * 
- * @return void Outputs connection start message to Serial
+ * @brief Check the target network's security against the preference
+ * @param ssid Target network SSID
+ * @param preference Security preference
+ * @return false if the network was found and its security is incompatible
  */
-void connectToNetwork(String ssid, String password, StationSecurityPreference securityPreference) {
-  if (currentMode != MODE_STATION) {
-    LOG_ERROR(TAG_WIFI, "Must be in station mode to connect. Use 'mode station' first");
-    return;
+static bool validateNetworkSecurity(const String& ssid, StationSecurityPreference preference) {
+  const WiFiScanStore& store = lockWiFiScanStore();
+  int networkIndex = findBestSecurityMatch(store, ssid, preference);
+  wifi_auth_mode_t authMode = networkIndex >= 0 ? (wifi_auth_mode_t)store.records[networkIndex].authMode : WIFI_AUTH_OPEN;
+  unlockWiFiScanStore();
+  
+  if (networkIndex < 0) {
+    LOG_WARN(TAG_WIFI, "Network '%s' not found in scan", ssid.c_str());
+    LOG_INFO(TAG_WIFI, "Attempting connection anyway...");
+    return true;
   }
   
-  // Cancel any existing connection attempt
-  if (isConnecting) {
-    Serial.println("⚠️  Canceling previous connection attempt");
-    isConnecting = false;
-  }
-  
-  LOG_INFO(TAG_WIFI, "Connecting to '%s'...", ssid.c_str());
-  if (securityPreference != STA_SEC_AUTO) {
-    LOG_INFO(TAG_WIFI, "Security preference: %s", securityPreferenceToString(securityPreference));
-  }
-  
-  // For WPA3_PREFER or strict security modes, scan networks first
-  if (securityPreference != STA_SEC_AUTO) {
-    LOG_DEBUG(TAG_WIFI, "Scanning networks for security validation...");
-    int scanResult = WiFi.scanNetworks(false, false, false, 300);
+  // Pre-validate security before connecting
+  if (!isSecurityAcceptable(authMode, preference)) {
+    LOG_ERROR(TAG_WIFI, "Network '%s' found but security is incompatible", ssid.c_str());
+    LOG_ERROR(TAG_WIFI, "Network uses: %s", authModeToString(authMode));
+    LOG_ERROR(TAG_WIFI, "Required: %s", securityPreferenceToString(preference));
+    LOG_INFO(TAG_WIFI, "Suggestion: Use 'auto' mode or change security preference");
     
-    if (scanResult > 0) {
-      int networkIndex = findBestSecurityMatch(ssid, securityPreference);
-      
-      if (networkIndex >= 0) {
-        wifi_auth_mode_t authMode = (wifi_auth_mode_t)WiFi.encryptionType(networkIndex);
-        
-        // Pre-validate security before connecting
-        if (!isSecurityAcceptable(authMode, securityPreference)) {
-          LOG_ERROR(TAG_WIFI, "Network '%s' found but security is incompatible", ssid.c_str());
-          LOG_ERROR(TAG_WIFI, "Network uses: %s", authModeToString(authMode));
-          LOG_ERROR(TAG_WIFI, "Required: %s", securityPreferenceToString(securityPreference));
-          LOG_INFO(TAG_WIFI, "Suggestion: Use 'auto' mode or change security preference");
-          
-          WiFi.scanDelete();
-          
 #if defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_TFT) || defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_REVERSETFT)
-          sendTFTStatus("Security\nMismatch");
+    sendTFTStatus("Security\nMismatch");
 #endif
-          
+    
 #ifdef USE_NEOPIXEL
-          setNeoPixelColor(255, 0, 0); // Red for security failure
+    setNeoPixelColor(255, 0, 0); // Red for security failure
 #endif
-          
-          return;
-        }
-        
-        LOG_INFO(TAG_WIFI, "Found compatible network with %s security", authModeToString(authMode));
-      } else {
-        LOG_WARN(TAG_WIFI, "Network '%s' not found in scan", ssid.c_str());
-        LOG_INFO(TAG_WIFI, "Attempting connection anyway...");
-      }
-      
-      WiFi.scanDelete();
-    } else {
-      LOG_WARN(TAG_WIFI, "Network scan failed, attempting direct connection");
-    }
+    
+    return false;
   }
   
+  LOG_INFO(TAG_WIFI, "Found compatible network with %s security", authModeToString(authMode));
+  return true;
+}
+
+/**
+ * @brief Go back to DHCP after a fast reconnect applied a cached lease
+ */
+static void restoreDhcp() {
+  if (staticLeaseApplied) {
+    WiFi.config(IPAddress(), IPAddress(), IPAddress());
+    staticLeaseApplied = false;
+  }
+}
+
+// ==========================================
+// STATION CONNECTION STATE MACHINE
+// ==========================================
+// Everything below up to connectToNetwork() runs in the WiFi command task:
+// driver events arrive through its queue (see wifi_task.cpp) and the queue
+// wait is the timer for the deadline armed here.
+
+static const char* const stationStateNames[] = {
+  "idle", "scanning", "connecting", "associated", "connected", "backoff"
+};
+
+const char* getStationStateName(StationState state) {
+  return state <= STA_STATE_BACKOFF ? stationStateNames[state] : "unknown";
+}
+
+/**
+ * @brief Short description of a wifi_err_reason_t code
+ * @details Covers the 802.11 reason codes the ESP32 reports plus its own
+ *          200+ codes; 0 stands for a connect attempt that timed out
+ */
+const char* getDisconnectReasonName(uint8_t reason) {
+  switch (reason) {
+    case 0: return "timeout";
+    case WIFI_REASON_UNSPECIFIED: return "unspecified";
+    case WIFI_REASON_AUTH_EXPIRE: return "auth expired";
+    case WIFI_REASON_AUTH_LEAVE: return "deauthenticated by AP";
+    case WIFI_REASON_ASSOC_EXPIRE: return "inactivity";
+    case WIFI_REASON_ASSOC_TOOMANY: return "AP full";
+    case WIFI_REASON_NOT_AUTHED: return "not authenticated";
+    case WIFI_REASON_NOT_ASSOCED: return "not associated";
+    case WIFI_REASON_ASSOC_LEAVE: return "left network";
+    case WIFI_REASON_ASSOC_NOT_AUTHED: return "assoc before auth";
+    case WIFI_REASON_IE_INVALID: return "invalid IE";
+    case WIFI_REASON_MIC_FAILURE: return "MIC failure";
+    case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT: return "4-way handshake timeout";
+    case WIFI_REASON_GROUP_KEY_UPDATE_TIMEOUT: return "group key timeout";
+    case WIFI_REASON_IE_IN_4WAY_DIFFERS: return "handshake IE mismatch";
+    case WIFI_REASON_GROUP_CIPHER_INVALID: return "group cipher unsupported";
+    case WIFI_REASON_PAIRWISE_CIPHER_INVALID: return "pairwise cipher unsupported";
+    case WIFI_REASON_AKMP_INVALID: return "AKM unsupported";
+    case WIFI_REASON_UNSUPP_RSN_IE_VERSION: return "RSN version unsupported";
+    case WIFI_REASON_INVALID_RSN_IE_CAP: return "RSN capabilities invalid";
+    case WIFI_REASON_802_1X_AUTH_FAILED: return "802.1X auth failed";
+    case WIFI_REASON_CIPHER_SUITE_REJECTED: return "cipher suite rejected";
+    case WIFI_REASON_BEACON_TIMEOUT: return "beacon timeout";
+    case WIFI_REASON_NO_AP_FOUND: return "AP not found";
+    case WIFI_REASON_AUTH_FAIL: return "auth failed";
+    case WIFI_REASON_ASSOC_FAIL: return "assoc failed";
+    case WIFI_REASON_HANDSHAKE_TIMEOUT: return "handshake timeout";
+    case WIFI_REASON_CONNECTION_FAIL: return "connection failed";
+    case WIFI_REASON_AP_TSF_RESET: return "AP TSF reset";
+    case WIFI_REASON_ROAMING: return "roaming";
+    default: return "other";
+  }
+}
+
+// How a disconnect reason is retried
+enum DisconnectClass : uint8_t {
+  DISCONNECT_TRANSIENT,    // Interference, beacon loss, AP restart: retry quickly
+  DISCONNECT_NO_AP,        // AP not in range: retry slowly
+  DISCONNECT_AP_BUSY,      // AP refused more stations: give it time
+  DISCONNECT_CREDENTIALS,  // Wrong password: one more try, then stop
+  DISCONNECT_UNSUPPORTED   // Security the station cannot do: stop
+};
+
+static DisconnectClass classifyDisconnect(uint8_t reason) {
+  switch (reason) {
+    case WIFI_REASON_NO_AP_FOUND:
+      return DISCONNECT_NO_AP;
+    case WIFI_REASON_ASSOC_TOOMANY:
+      return DISCONNECT_AP_BUSY;
+    case WIFI_REASON_AUTH_FAIL:
+    case WIFI_REASON_MIC_FAILURE:
+    case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+    case WIFI_REASON_HANDSHAKE_TIMEOUT:
+    case WIFI_REASON_802_1X_AUTH_FAILED:
+      return DISCONNECT_CREDENTIALS;
+    case WIFI_REASON_GROUP_CIPHER_INVALID:
+    case WIFI_REASON_PAIRWISE_CIPHER_INVALID:
+    case WIFI_REASON_AKMP_INVALID:
+    case WIFI_REASON_UNSUPP_RSN_IE_VERSION:
+    case WIFI_REASON_INVALID_RSN_IE_CAP:
+    case WIFI_REASON_CIPHER_SUITE_REJECTED:
+      return DISCONNECT_UNSUPPORTED;
+    default:
+      return DISCONNECT_TRANSIENT;
+  }
+}
+
+// Backoff per class: first delay and ceiling, doubled on every retry
+static const uint32_t backoffBaseMs[] = {500, 2000, 10000, 5000, 0};
+static const uint32_t backoffMaxMs[] = {30000, 60000, 60000, 5000, 0};
+static const uint32_t STA_BACKOFF_CONNECTED_MAX_MS = 60000;  // Ceiling once a link was up
+static const uint32_t STA_SCAN_WAIT_MS = 15000;              // Longest wait for a security scan
+
+static volatile StationState stationState = STA_STATE_IDLE;
+static volatile uint8_t lastDisconnectReason = 0;
+static volatile unsigned long connectedSince = 0;
+static unsigned long stateDeadline = 0;  // millis() of the next timeout or retry
+static bool deadlineArmed = false;
+static uint8_t retryCount = 0;
+static bool wasConnected = false;        // Link was up since the last connect request: never give up
+
+static void setStationState(StationState state) {
+  if (state != stationState) {
+    LOG_DEBUG(TAG_WIFI, "Station %s -> %s", getStationStateName(stationState), getStationStateName(state));
+    stationState = state;
+  }
+}
+
+static void armDeadline(uint32_t delayMs) {
+  stateDeadline = millis() + delayMs;
+  deadlineArmed = true;
+}
+
+/**
+ * @brief Forget the connection in progress (no driver calls)
+ */
+static void resetStationConnection() {
+  setStationState(STA_STATE_IDLE);
+  deadlineArmed = false;
+  pendingConnectSSID = "";
+  pendingConnectPassword = "";
+  fastConnectAttempt = false;
+  connectedSince = 0;
+}
+
+/**
+ * @brief Record connection state shared by the normal and fast paths
+ */
+static void trackConnection(const String& ssid, const String& password, StationSecurityPreference securityPreference) {
+  connectionStartTime = millis();
+  connectingSSID = ssid;
+  connectingPassword = password;
+  currentSecurityPreference = securityPreference;
+  setStationState(STA_STATE_CONNECTING);
+  armDeadline(fastConnectAttempt ? SystemConstants::WIFI_FAST_CONNECT_TIMEOUT_MS
+                                 : SystemConstants::WIFI_CONNECT_TIMEOUT_MS);
+}
+
+/**
+ * @brief Start the association; its events advance the state machine
+ */
+static void beginConnection(const String& ssid, const String& password, StationSecurityPreference securityPreference) {
 #if defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_TFT) || defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_REVERSETFT)
   // Show connecting animation on TFT
   sendTFTConnecting();
@@ -1039,171 +1290,506 @@ void connectToNetwork(String ssid, String password, StationSecurityPreference se
 #endif
   
   // Start connection asynchronously
+  restoreDhcp();
   WiFi.begin(ssid.c_str(), password.c_str());
   
   // Track connection state
-  isConnecting = true;
-  connectionStartTime = millis();
-  connectingSSID = ssid;
-  connectingPassword = password;
-  currentSecurityPreference = securityPreference;
-  connectionAttempts = 0;
+  fastConnectAttempt = false;
+  trackConnection(ssid, password, securityPreference);
   
-  Serial.println("  Connection initiated (non-blocking)");
-  Serial.println("  Monitoring connection progress...");
+  LOG_DEBUG(TAG_WIFI, "Connection initiated, waiting for WiFi events");
 }
 
 /**
- * @brief Monitors and handles WiFi connection progress (non-blocking)
- * 
- * This function should be called periodically from the main loop to monitor
- * the progress of an ongoing WiFi connection attempt. It provides visual
- * feedback and handles connection success/failure without blocking.
- * 
- * @note Call this from main loop when isConnecting is true
- * @note Automatically times out after 10 seconds
- * @note Provides visual feedback during connection attempts
- * 
- * @return void Updates connection state and outputs progress to Serial
+ * @brief Rejoin the access point of the last good connection without scanning
+ * @details Joins the cached BSSID on its channel (a single-channel probe
+ *          instead of an all-channel scan). With WIFI_FAST_CONNECT_STATIC_IP
+ *          the cached lease is applied as a static IP for the join; it is
+ *          handed back to DHCP once the link is up, and the station only
+ *          counts as connected when DHCP assigns the address. The cached
+ *          security mode stands in for the scan-based security check; the
+ *          check on the CONNECTED event still applies.
+ * @return false if there is no usable cache (caller takes the normal path)
  */
-void handleWiFiConnection() {
-  if (!isConnecting) {
-    return; // Nothing to do
+static bool beginFastConnection(const String& ssid, const String& password, StationSecurityPreference securityPreference) {
+  StationConnectCache cache;
+  if (!loadStationConnectCache(ssid.c_str(), cache)) {
+    return false;
+  }
+  if (!isSecurityAcceptable((wifi_auth_mode_t)cache.authMode, securityPreference)) {
+    return false; // Preference changed since; let the scan pick a suitable AP
   }
   
-  wl_status_t status = WiFi.status();
-  
-  // Check if connected successfully
-  if (status == WL_CONNECTED) {
-    Serial.println();
-    
-    // Validate security level if preference is set
-    if (currentSecurityPreference != STA_SEC_AUTO) {
-      // Get the network's actual security type
-      wifi_ap_record_t ap_info;
-      if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-        wifi_auth_mode_t authMode = ap_info.authmode;
-        
-        LOG_DEBUG(TAG_WIFI, "Network security: %s", authModeToString(authMode));
-        
-        // Check if security meets requirements
-        if (!isSecurityAcceptable(authMode, currentSecurityPreference)) {
-          Serial.println();
-          LOG_ERROR(TAG_WIFI, "Security validation failed!");
-          LOG_ERROR(TAG_WIFI, "Network '%s' uses: %s", WiFi.SSID().c_str(), authModeToString(authMode));
-          LOG_ERROR(TAG_WIFI, "Required: %s", securityPreferenceToString(currentSecurityPreference));
-          
 #if defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_TFT) || defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_REVERSETFT)
-          sendTFTStatus("Security\nMismatch");
+  sendTFTConnecting();
 #endif
-          
+  
 #ifdef USE_NEOPIXEL
-          setNeoPixelColor(255, 0, 0); // Red for security failure
+  setNeoPixelColor(255, 255, 0);
 #endif
-          
-          // Disconnect due to security mismatch
-          WiFi.disconnect();
-          isConnecting = false;
-          RESET_PROMPT();
-          return;
-        }
-        
-        LOG_INFO(TAG_WIFI, "Security validated: %s", authModeToString(authMode));
-      }
-    }
-    
-    LOG_INFO(TAG_WIFI, "Connected to '%s'", WiFi.SSID().c_str());
-    LOG_INFO(TAG_WIFI, "IP Address: %s", WiFi.localIP().toString().c_str());
-    LOG_DEBUG(TAG_WIFI, "Gateway: %s", WiFi.gatewayIP().toString().c_str());
-    LOG_DEBUG(TAG_WIFI, "DNS: %s", WiFi.dnsIP().toString().c_str());
+  
+  if (SystemConstants::WIFI_FAST_CONNECT_STATIC_IP && cache.ip != 0) {
+    WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet), IPAddress(cache.dns));
+    staticLeaseApplied = true;
+  } else {
+    restoreDhcp();
+  }
+  WiFi.begin(ssid.c_str(), password.c_str(), cache.channel, cache.bssid);
+  
+  fastConnectAttempt = true;
+  trackConnection(ssid, password, securityPreference);
+  
+  LOG_INFO(TAG_WIFI, "Fast reconnect to %02X:%02X:%02X:%02X:%02X:%02X on channel %u%s", cache.bssid[0],
+           cache.bssid[1], cache.bssid[2], cache.bssid[3], cache.bssid[4], cache.bssid[5], cache.channel,
+           staticLeaseApplied ? " with cached IP" : "");
+  return true;
+}
+
+/**
+ * @brief Remember the association and lease that just succeeded
+ * @details Only called while the address came from DHCP, so a cached lease
+ *          applied as a static IP is never saved back as if it were fresh
+ */
+static void saveConnectCache(uint8_t authMode) {
+  StationConnectCache cache;
+  memset(&cache, 0, sizeof(cache));
+  strncpy(cache.ssid, connectingSSID.c_str(), sizeof(cache.ssid) - 1);
+  const uint8_t* bssid = WiFi.BSSID();
+  if (bssid == nullptr) return;
+  memcpy(cache.bssid, bssid, sizeof(cache.bssid));
+  cache.channel = WiFi.channel();
+  cache.authMode = authMode;
+  cache.ip = WiFi.localIP();
+  cache.gateway = WiFi.gatewayIP();
+  cache.subnet = WiFi.subnetMask();
+  cache.dns = WiFi.dnsIP();
+  saveStationConnectCache(cache);
+}
+
+/**
+ * @brief Scan callback for a connection waiting on security validation
+ * @details Runs in the main loop (or in the task when the results are
+ *          fresh), so it only hands the result to the state machine
+ */
+static void onSecurityScanComplete(bool success) {
+  if (!requestStationEvent(STA_EVENT_SCAN_READY, success ? 1 : 0)) {
+    LOG_WARN(TAG_WIFI, "WiFi command queue full, connection continues after the scan timeout");
+  }
+}
+
+/**
+ * @brief Connect through the scan results (security validation) or a plain begin
+ */
+static void startFullConnection(const String& ssid, const String& password, StationSecurityPreference securityPreference) {
+  // For WPA3_PREFER or strict security modes, check the scan results first
+  if (securityPreference != STA_SEC_AUTO) {
+    LOG_DEBUG(TAG_WIFI, "Checking scan results for security validation...");
+    pendingConnectSSID = ssid;
+    pendingConnectPassword = password;
+    pendingConnectPreference = securityPreference;
+    setStationState(STA_STATE_SCANNING);
+    armDeadline(STA_SCAN_WAIT_MS);
     
-#if defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_TFT) || defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_REVERSETFT)
-    // Get encryption type for display
-    wifi_ap_record_t ap_info;
-    uint8_t encType = 0;  // Default to WIFI_AUTH_OPEN
-    if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-        encType = (uint8_t)ap_info.authmode;
-        LOG_DEBUG(TAG_WIFI, "Encryption type for TFT display: %s", authModeToString(ap_info.authmode));
+    // Recent results are reused; otherwise the connection starts when the scan lands
+    if (!requestWiFiScanIfStale(WIFI_SCAN_FRESH_MS, onSecurityScanComplete)) {
+      LOG_WARN(TAG_WIFI, "Network scan failed, attempting direct connection");
+      pendingConnectSSID = "";
+      beginConnection(ssid, password, securityPreference);
     }
-    
-    // Send station mode info to TFT display task via queue (with password for QR code)
-    sendTFTStationUpdate(connectingSSID.c_str(), connectingPassword.c_str(), 
-                        WiFi.localIP().toString().c_str(), WiFi.RSSI(), encType);
+    return;
+  }
+  
+  beginConnection(ssid, password, securityPreference);
+}
+
+/**
+ * @brief Scan results for a SCANNING connection are in (or never came)
+ */
+static void continueAfterSecurityScan(bool success) {
+  String ssid = pendingConnectSSID;
+  String password = pendingConnectPassword;
+  pendingConnectSSID = "";
+  pendingConnectPassword = "";
+  
+  if (!success) {
+    LOG_WARN(TAG_WIFI, "Network scan failed, attempting direct connection");
+  } else if (!validateNetworkSecurity(ssid, pendingConnectPreference)) {
+    resetStationConnection();
+    RESET_PROMPT();
+    return;
+  }
+  beginConnection(ssid, password, pendingConnectPreference);
+}
+
+/**
+ * @brief A fast reconnect that fails falls back to the normal scan-based path
+ */
+static void fallBackFromFastConnection(uint8_t reason) {
+  LOG_WARN(TAG_WIFI, "Fast reconnect failed (%s), falling back to a full scan", getDisconnectReasonName(reason));
+  clearStationConnectCache();
+  fastConnectAttempt = false;
+  restoreDhcp();
+  String ssid = connectingSSID;
+  String password = connectingPassword;
+  startFullConnection(ssid, password, currentSecurityPreference);
+}
+
+/**
+ * @brief Stop retrying and report the failure
+ */
+static void giveUpConnection(uint8_t reason, DisconnectClass cls) {
+  LOG_ERROR(TAG_WIFI, "Failed to connect to '%s' (reason %u: %s)", connectingSSID.c_str(), reason,
+            getDisconnectReasonName(reason));
+  if (cls == DISCONNECT_CREDENTIALS) {
+    LOG_WARN(TAG_WIFI, "Check the password");
+  } else if (cls == DISCONNECT_UNSUPPORTED) {
+    LOG_WARN(TAG_WIFI, "The network's security mode is not supported");
+  } else {
+    LOG_WARN(TAG_WIFI, "Check SSID, password, and signal strength");
+  }
+  
+#if defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_TFT) || defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_REVERSETFT)
+  // Show connection failed status on TFT with red icon
+  sendTFTConnectionFailed();
 #endif
-    
+  
 #ifdef USE_NEOPIXEL
-    // Show solid green for successful connection
-    setNeoPixelColor(0, 255, 0);
+  // Show red for connection failure
+  setNeoPixelColor(255, 0, 0);
 #endif
+  
+  resetStationConnection();
+  WiFi.disconnect();
+  RESET_PROMPT();
+}
 
-#ifdef USE_WEB_SERVER 
-    // Automatically start web server after successful connection
-    if (!isWebServerRunning()) {
-      LOG_INFO(TAG_WEB, "Starting web server...");
-      if (startWebServer()) {
-        LOG_INFO(TAG_WEB, "Web server ready at: %s", getWebServerURL().c_str());
-      }
+/**
+ * @brief Pick the retry delay for a failed or lost connection, or give up
+ * @details Credential failures get one more try (a handshake can time out on
+ *          a weak link) and unsupported security none. Other reasons back off
+ *          exponentially per class, up to WIFI_MAX_RETRY_ATTEMPTS retries.
+ *          Once a link was up the station keeps retrying at the ceiling, so
+ *          an AP reboot or a walk out of range does not need a manual connect.
+ */
+static void scheduleRetry(uint8_t reason) {
+  DisconnectClass cls = classifyDisconnect(reason);
+  
+  if (!wasConnected) {
+    bool giveUp = cls == DISCONNECT_UNSUPPORTED ||
+                  (cls == DISCONNECT_CREDENTIALS && retryCount >= 1) ||
+                  retryCount >= SystemConstants::WIFI_MAX_RETRY_ATTEMPTS;
+    if (giveUp) {
+      giveUpConnection(reason, cls);
+      return;
     }
+  }
+  
+  uint32_t delayMs;
+  if (wasConnected && (cls == DISCONNECT_CREDENTIALS || cls == DISCONNECT_UNSUPPORTED)) {
+    delayMs = STA_BACKOFF_CONNECTED_MAX_MS;
+  } else {
+    uint32_t maxMs = wasConnected ? STA_BACKOFF_CONNECTED_MAX_MS : backoffMaxMs[cls];
+    uint8_t doublings = retryCount < 16 ? retryCount : 16;
+    delayMs = backoffBaseMs[cls] << doublings;
+    if (delayMs > maxMs) delayMs = maxMs;
+  }
+  
+  if (retryCount < UINT8_MAX) retryCount++;
+  setStationState(STA_STATE_BACKOFF);
+  armDeadline(delayMs);
+  
+  LOG_WARN(TAG_WIFI, "'%s': %s (reason %u), retry %u in %lu ms", connectingSSID.c_str(),
+           getDisconnectReasonName(reason), reason, retryCount, (unsigned long)delayMs);
+  
+#ifdef USE_NEOPIXEL
+  setNeoPixelColor(100, 100, 0); // Dim yellow while waiting to retry
 #endif
-    
-    // Reset connection state
-    isConnecting = false;
-    RESET_PROMPT();
-    return;
+}
+
+/**
+ * @brief Link is up: check the security the AP actually negotiated
+ * @return false if the connection was dropped for a security mismatch
+ */
+static bool checkConnectedSecurity() {
+  if (currentSecurityPreference == STA_SEC_AUTO) {
+    return true;
   }
   
-  // Check for timeout (10 seconds)
-  unsigned long elapsed = millis() - connectionStartTime;
-  if (elapsed > 10000) {
-    Serial.println();
-    LOG_ERROR(TAG_WIFI, "Failed to connect to '%s'", WiFi.SSID().c_str());
-    LOG_WARN(TAG_WIFI, "Check SSID, password, and signal strength");
+  // Get the network's actual security type
+  wifi_ap_record_t ap_info;
+  if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+    return true;
+  }
+  wifi_auth_mode_t authMode = ap_info.authmode;
+  
+  LOG_DEBUG(TAG_WIFI, "Network security: %s", authModeToString(authMode));
+  
+  // Check if security meets requirements
+  if (!isSecurityAcceptable(authMode, currentSecurityPreference)) {
+    LOG_ERROR(TAG_WIFI, "Security validation failed!");
+    LOG_ERROR(TAG_WIFI, "Network '%s' uses: %s", connectingSSID.c_str(), authModeToString(authMode));
+    LOG_ERROR(TAG_WIFI, "Required: %s", securityPreferenceToString(currentSecurityPreference));
     
 #if defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_TFT) || defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_REVERSETFT)
-    // Show connection failed status on TFT with red icon
-    sendTFTConnectionFailed();
+    sendTFTStatus("Security\nMismatch");
 #endif
     
 #ifdef USE_NEOPIXEL
-    // Show red for connection failure
-    setNeoPixelColor(255, 0, 0);
+    setNeoPixelColor(255, 0, 0); // Red for security failure
 #endif
     
-    // Reset connection state
-    isConnecting = false;
+    // Disconnect due to security mismatch
+    if (fastConnectAttempt) {
+      clearStationConnectCache(); // The cached AP no longer qualifies
+    }
+    resetStationConnection();
     WiFi.disconnect();
     RESET_PROMPT();
-    return;
+    return false;
   }
   
-  // Provide periodic visual feedback (every 100ms)
-  if (elapsed / 100 > connectionAttempts) {
-    Serial.print(".");
-    connectionAttempts = elapsed / 100;
-    
+  LOG_INFO(TAG_WIFI, "Security validated: %s", authModeToString(authMode));
+  return true;
+}
+
+/**
+ * @brief Link and IP are up: report, start services and cache the AP
+ */
+static void onStationConnected() {
+  LOG_INFO(TAG_WIFI, "Connected to '%s'%s in %lu ms", connectingSSID.c_str(),
+           fastConnectAttempt ? " (fast reconnect)" : "", millis() - connectionStartTime);
+  LOG_INFO(TAG_WIFI, "IP Address: %s", WiFi.localIP().toString().c_str());
+  LOG_DEBUG(TAG_WIFI, "Gateway: %s", WiFi.gatewayIP().toString().c_str());
+  LOG_DEBUG(TAG_WIFI, "DNS: %s", WiFi.dnsIP().toString().c_str());
+  
+  wifi_ap_record_t ap_info;
+  bool haveApInfo = esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK;
+  
+#if defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_TFT) || defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_REVERSETFT)
+  // Get encryption type for display
+  uint8_t encType = 0;  // Default to WIFI_AUTH_OPEN
+  if (haveApInfo) {
+      encType = (uint8_t)ap_info.authmode;
+      LOG_DEBUG(TAG_WIFI, "Encryption type for TFT display: %s", authModeToString(ap_info.authmode));
+  }
+  
+  // Send station mode info to TFT display task via queue (with password for QR code)
+  sendTFTStationUpdate(connectingSSID.c_str(), connectingPassword.c_str(), 
+                      WiFi.localIP().toString().c_str(), WiFi.RSSI(), encType);
+#endif
+  
 #ifdef USE_NEOPIXEL
-    // Blink yellow during connection attempts
-    if (connectionAttempts % 2 == 0) {
-      setNeoPixelColor(255, 255, 0); // Yellow
-    } else {
-      setNeoPixelColor(100, 100, 0); // Dim yellow
-    }
+  // Show solid green for successful connection
+  setNeoPixelColor(0, 255, 0);
 #endif
+
+  // Web server will be auto-started by monitorWebServerState() on the loop
+  // task; this runs on the WiFi task and must not race it
+  
+  // Remember this AP and lease for the next fast reconnect
+  connectedAuthMode = haveApInfo ? (uint8_t)ap_info.authmode : (uint8_t)WIFI_AUTH_WPA2_PSK;
+  saveConnectCache(connectedAuthMode);
+  
+  setStationState(STA_STATE_CONNECTED);
+  deadlineArmed = false;
+  retryCount = 0;
+  wasConnected = true;
+  fastConnectAttempt = false;
+  connectedSince = millis();
+  RESET_PROMPT();
+}
+
+static void onStationDisconnected(uint8_t reason) {
+  StationState state = stationState;
+  
+  // Nothing in flight, or an echo of a disconnect we asked for
+  if (state == STA_STATE_IDLE || state == STA_STATE_SCANNING || state == STA_STATE_BACKOFF) {
+    return;
   }
+  if (reason == WIFI_REASON_ASSOC_LEAVE) {
+    // begin() leaving the previous AP, or someone called WiFi.disconnect()
+    if (state == STA_STATE_ASSOCIATED || state == STA_STATE_CONNECTED) {
+      LOG_INFO(TAG_WIFI, "Left '%s'", connectingSSID.c_str());
+      resetStationConnection();
+    }
+    return;
+  }
+  
+  if (fastConnectAttempt) {
+    fallBackFromFastConnection(reason);
+    return;
+  }
+  
+  if (state == STA_STATE_CONNECTED) {
+    LOG_WARN(TAG_WIFI, "Connection to '%s' lost after %lu s", connectingSSID.c_str(),
+             (millis() - connectedSince) / 1000);
+    connectedSince = 0;
+  }
+  scheduleRetry(reason);
 }
 
-/**
- * @brief Disconnects from current WiFi network
- * 
- * Disconnects from the currently connected WiFi network while maintaining
- * station mode for future connections.
- */
-void disconnectFromNetwork() {
+void handleStationEvent(StationEvent event, uint8_t reason) {
+  switch (event) {
+    case STA_EVENT_START:
+      LOG_DEBUG(TAG_WIFI, "Station interface started");
+      break;
+      
+    case STA_EVENT_STOP:
+      // Left station mode: whatever was in flight is gone. The stop from
+      // startStationMode() restarting the interface can arrive after the
+      // new connect request, so it must not cancel it
+      if (currentMode != MODE_STATION && stationState != STA_STATE_IDLE) {
+        LOG_DEBUG(TAG_WIFI, "Station interface stopped, connection abandoned");
+        resetStationConnection();
+      }
+      break;
+      
+    case STA_EVENT_CONNECTED:
+      if (stationState == STA_STATE_BACKOFF) {
+        // The link came back before the retry: wait for the IP instead of
+        // tearing it down with another begin()
+        if (checkConnectedSecurity()) {
+          LOG_INFO(TAG_WIFI, "Link to '%s' restored, retry canceled", connectingSSID.c_str());
+          setStationState(STA_STATE_ASSOCIATED);
+          armDeadline(SystemConstants::WIFI_CONNECT_TIMEOUT_MS);
+        }
+        break;
+      }
+      if (stationState != STA_STATE_CONNECTING) break;
+      if (checkConnectedSecurity()) {
+        setStationState(STA_STATE_ASSOCIATED);  // Deadline still runs until the IP arrives
+      }
+      break;
+      
+    case STA_EVENT_GOT_IP:
+      if (stationState == STA_STATE_ASSOCIATED ||
+          ((stationState == STA_STATE_CONNECTING || stationState == STA_STATE_BACKOFF) &&
+           checkConnectedSecurity())) {
+        if (staticLeaseApplied) {
+          // This is the cached address we set ourselves: hand the interface
+          // to DHCP and wait for the address it assigns
+          LOG_DEBUG(TAG_WIFI, "Joined with the cached IP, waiting for DHCP");
+          restoreDhcp();
+          setStationState(STA_STATE_ASSOCIATED);
+          armDeadline(SystemConstants::WIFI_CONNECT_TIMEOUT_MS);  // The join worked; give DHCP the full time
+          break;
+        }
+        onStationConnected();
+      } else if (stationState == STA_STATE_CONNECTED) {
+        LOG_INFO(TAG_WIFI, "IP Address: %s", WiFi.localIP().toString().c_str());  // Lease changed
+        saveConnectCache(connectedAuthMode);  // Unchanged leases are not rewritten
+      }
+      break;
+      
+    case STA_EVENT_LOST_IP:
+      if (stationState == STA_STATE_CONNECTED) {
+        LOG_WARN(TAG_WIFI, "Lost IP address, waiting for DHCP");
+        setStationState(STA_STATE_ASSOCIATED);
+        armDeadline(SystemConstants::WIFI_CONNECT_TIMEOUT_MS);
+        connectedSince = 0;
+      }
+      break;
+      
+    case STA_EVENT_DISCONNECTED:
+      lastDisconnectReason = reason;
+      LOG_DEBUG(TAG_WIFI, "Disconnected, reason %u (%s)", reason, getDisconnectReasonName(reason));
+      onStationDisconnected(reason);
+      break;
+      
+    case STA_EVENT_SCAN_READY:
+      if (stationState == STA_STATE_SCANNING) {
+        continueAfterSecurityScan(reason != 0);
+      }
+      break;
+  }
+}
+
+uint32_t serviceStationConnection() {
+  if (!deadlineArmed) {
+    return UINT32_MAX;
+  }
   if (currentMode != MODE_STATION) {
-    LOG_ERROR(TAG_WIFI, "Must be in station mode");
+    resetStationConnection();
+    return UINT32_MAX;
+  }
+  
+  long remaining = (long)(stateDeadline - millis());
+  if (remaining > 0) {
+    return (uint32_t)remaining;
+  }
+  deadlineArmed = false;
+  
+  String ssid = connectingSSID;
+  String password = connectingPassword;
+  switch (stationState) {
+    case STA_STATE_SCANNING:
+      // The scan never reported back; connect without the pre-check
+      pendingConnectSSID = ssid;
+      pendingConnectPassword = password;
+      continueAfterSecurityScan(false);
+      break;
+      
+    case STA_STATE_CONNECTING:
+    case STA_STATE_ASSOCIATED:
+      // The echoed ASSOC_LEAVE is ignored in the states that follow
+      setStationState(STA_STATE_BACKOFF);
+      WiFi.disconnect();
+      if (fastConnectAttempt) {
+        fallBackFromFastConnection(0);
+      } else {
+        scheduleRetry(0);
+      }
+      break;
+      
+    case STA_STATE_BACKOFF:
+      LOG_INFO(TAG_WIFI, "Retrying '%s' (attempt %u)", ssid.c_str(), retryCount + 1);
+      beginConnection(ssid, password, currentSecurityPreference);
+      break;
+      
+    default:
+      break;
+  }
+  
+  if (!deadlineArmed) {
+    return UINT32_MAX;
+  }
+  remaining = (long)(stateDeadline - millis());
+  return remaining > 0 ? (uint32_t)remaining : 0;
+}
+
+void startStationConnection(const String& ssid, const String& password, StationSecurityPreference securityPreference) {
+  if (currentMode != MODE_STATION) {
+    LOG_ERROR(TAG_WIFI, "Must be in station mode to connect. Use 'mode station' first");
     return;
   }
   
+  // Cancel any existing connection attempt
+  StationState state = stationState;
+  if (state != STA_STATE_IDLE && state != STA_STATE_CONNECTED) {
+    Serial.println("⚠️  Canceling previous connection attempt");
+  }
+  resetStationConnection();
+  retryCount = 0;
+  wasConnected = false;
+  
+  LOG_INFO(TAG_WIFI, "Connecting to '%s'...", ssid.c_str());
+  if (securityPreference != STA_SEC_AUTO) {
+    LOG_INFO(TAG_WIFI, "Security preference: %s", securityPreferenceToString(securityPreference));
+  }
+  
+  // Rejoin the last good AP directly; its failure events fall back to the scan path
+  if (beginFastConnection(ssid, password, securityPreference)) {
+    return;
+  }
+  
+  startFullConnection(ssid, password, securityPreference);
+}
+
+void stopStationConnection() {
+  StationState state = stationState;
+  resetStationConnection();  // First, so the disconnect event that follows is ignored
+  wasConnected = false;
+  
   if (WiFi.status() == WL_CONNECTED) {
     String ssid = WiFi.SSID();
     
@@ -1217,6 +1803,9 @@ void disconnectFromNetwork() {
     
     WiFi.disconnect();
     LOG_INFO(TAG_WIFI, "Disconnected from '%s'", ssid.c_str());
+  } else if (state != STA_STATE_IDLE) {
+    WiFi.disconnect();
+    LOG_INFO(TAG_WIFI, "Connection attempt to '%s' canceled", connectingSSID.c_str());
   } else {
     LOG_INFO(TAG_WIFI, "Not connected to any network");
   }
@@ -1224,6 +1813,96 @@ void disconnectFromNetwork() {
   RESET_PROMPT();
 }
 
+StationState getStationState() {
+  return stationState;
+}
+
+uint8_t getLastDisconnectReason() {
+  return lastDisconnectReason;
+}
+
+uint32_t getStationRetryInMs() {
+  if (stationState != STA_STATE_BACKOFF || !deadlineArmed) {
+    return 0;
+  }
+  long remaining = (long)(stateDeadline - millis());
+  return remaining > 0 ? (uint32_t)remaining : 0;
+}
+
+unsigned long getStationConnectedSince() {
+  return connectedSince;
+}
+
+// ==========================================
+// CONNECTION REQUESTS
+// ==========================================
+
+/**
+ * @brief Connects to a WiFi network using SSID and password (non-blocking)
+ * 
+ * This function hands a connection request to the WiFi command task and
+ * returns immediately. The task runs the station state machine: WiFi driver
+ * events (connected, got IP, disconnected with a reason code) move it
+ * between states, and failures are retried with a backoff chosen from the
+ * disconnect reason instead of a fixed polling timeout.
+ * 
+ * If the last good connection to this SSID was cached (see
+ * StationConnectCache), its access point is joined directly on its channel
+ * with the cached lease, falling back to the path below if that fails.
+ * 
+ * For WPA3_PREFER mode, the shared scan results are checked first and the
+ * most secure version is selected (WPA3 if available, fallback to WPA2).
+ * If the results are stale, a background scan is requested and the
+ * connection starts once it completes.
+ * 
+ * @param ssid Network name to connect to
+ * @param password Network password for authentication
+ * @param securityPreference Security level requirement (default: AUTO)
+ * 
+ * @pre Device must be in station mode (MODE_STATION)
+ * @pre WiFi command task must be running (initWiFiTask())
+ * 
+ * @note Each attempt times out after SystemConstants::WIFI_CONNECT_TIMEOUT_MS
+ * @note Security validation occurs again once the link is established
+ * 
+ * @return void Outputs connection start message to Serial
+ */
+void connectToNetwork(String ssid, String password, StationSecurityPreference securityPreference) {
+  if (currentMode != MODE_STATION) {
+    LOG_ERROR(TAG_WIFI, "Must be in station mode to connect. Use 'mode station' first");
+    return;
+  }
+  
+  if (isWiFiTaskContext()) {
+    startStationConnection(ssid, password, securityPreference);
+    return;
+  }
+  if (!requestConnect(ssid.c_str(), password.c_str(), (uint8_t)securityPreference)) {
+    LOG_ERROR(TAG_WIFI, "WiFi task not available, cannot connect to '%s'", ssid.c_str());
+  }
+}
+
+/**
+ * @brief Disconnects from current WiFi network
+ * 
+ * Disconnects from the currently connected WiFi network while maintaining
+ * station mode for future connections. Also cancels a connection attempt
+ * or retry in progress.
+ */
+void disconnectFromNetwork() {
+  if (currentMode != MODE_STATION) {
+    LOG_ERROR(TAG_WIFI, "Must be in station mode");
+    return;
+  }
+  
+  if (isWiFiTaskContext()) {
+    stopStationConnection();
+    return;
+  }
+  if (!requestDisconnect()) {
+    LOG_ERROR(TAG_WIFI, "WiFi task not available");
+  }
+}
 
 
 // ==========================================
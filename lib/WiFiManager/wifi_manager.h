@@ -143,14 +143,35 @@ void generateAPQRCode(const String& ssid, const String& password, const String&
 
 /**
  * @brief Perform a WiFi network scan
- * @details Scans for available networks and displays results with signal strength
+ * @details Requests a background scan (see wifi_scan.h) and prints the results
+ *          with signal strength from the main loop once it completes
  */
 void performWiFiScan();
 
+/**
+ * @brief Periodic scan that prints only what changed (call from the scan loop)
+ * @details The first scan after startWiFiScanUpdates() prints the full table;
+ *          later ones print the networks that appeared, vanished, moved
+ *          channel, changed security or signal since the previous scan
+ */
+void performWiFiScanUpdate();
+
+/**
+ * @brief Make the next performWiFiScanUpdate() print the full table again
+ */
+void startWiFiScanUpdates();
+
+/**
+ * @brief Print the scan events still held, oldest first
+ * @details Works from the event history; does not scan
+ */
+void printWiFiScanEvents();
+
 /**
  * @brief Shows detailed information about a specific network from the last scan
- * @param networkId Network ID (1-based index) from the scan results
- * @details Displays SSID, BSSID, channel, RSSI, encryption type
+ * @param networkId Stable network ID from the scan table (see wifi_scan.h)
+ * @details Displays SSID, BSSID, channel, RSSI, encryption type and result age
+ *          from the shared scan store without touching the radio
  */
 void showNetworkDetails(int networkId);
 
@@ -158,24 +179,98 @@ void showNetworkDetails(int networkId);
 // NETWORK CONNECTION
 // ==========================================
 
+/**
+ * @brief Station connection states, driven by WiFi driver events
+ */
+enum StationState : uint8_t {
+  STA_STATE_IDLE = 0,     ///< Not connected and not trying
+  STA_STATE_SCANNING,     ///< Waiting for scan results to check the security preference
+  STA_STATE_CONNECTING,   ///< Association started
+  STA_STATE_ASSOCIATED,   ///< Link up, waiting for an IP address
+  STA_STATE_CONNECTED,    ///< Link up with an IP address
+  STA_STATE_BACKOFF       ///< Disconnected, waiting to retry
+};
+
+/**
+ * @brief Inputs to the station state machine (see handleStationEvent())
+ */
+enum StationEvent : uint8_t {
+  STA_EVENT_START = 0,    ///< Station interface started
+  STA_EVENT_STOP,         ///< Station interface stopped (mode change)
+  STA_EVENT_CONNECTED,    ///< Associated with the access point
+  STA_EVENT_GOT_IP,       ///< DHCP lease or static IP applied
+  STA_EVENT_LOST_IP,      ///< IP address lost
+  STA_EVENT_DISCONNECTED, ///< Link down or association failed (reason = wifi_err_reason_t)
+  STA_EVENT_SCAN_READY    ///< Security scan finished (reason = 1 on success)
+};
+
 /**
  * @brief Connects to a WiFi network using SSID and password (non-blocking)
  * @param ssid Network name to connect to
  * @param password Network password for authentication
  * @param securityPreference Security level requirement (default: AUTO)
- * @details This is non-blocking - call handleWiFiConnection() in main loop
+ * @details Queues the request for the WiFi command task, which runs the
+ *          connection state machine; progress is reported as it happens
  * @note Validates network security against preference before attempting connection
  * @see wifi_manager.cpp for detailed implementation documentation
  */
 void connectToNetwork(String ssid, String password, StationSecurityPreference securityPreference = STA_SEC_AUTO);
 
 /**
- * @brief Monitors WiFi connection progress (call from main loop)
- * @details Only active when a connection attempt is in progress
- * @note Call this function repeatedly in the main loop during connection attempts
- * @see wifi_manager.cpp for detailed implementation documentation
+ * @brief Start a connection (WiFi command task only)
+ * @details Fast reconnect from the cached AP if possible, otherwise the
+ *          scan-based path; resets the retry budget
+ */
+void startStationConnection(const String& ssid, const String& password, StationSecurityPreference securityPreference);
+
+/**
+ * @brief Stop connecting or retrying and leave the network (WiFi command task only)
+ */
+void stopStationConnection();
+
+/**
+ * @brief Advance the state machine with a driver event (WiFi command task only)
+ * @param event What happened
+ * @param reason wifi_err_reason_t for STA_EVENT_DISCONNECTED, success flag
+ *        for STA_EVENT_SCAN_READY, otherwise 0
+ */
+void handleStationEvent(StationEvent event, uint8_t reason);
+
+/**
+ * @brief Run connect timeouts and backoff retries (WiFi command task only)
+ * @return Milliseconds until the next deadline, UINT32_MAX if none
+ */
+uint32_t serviceStationConnection();
+
+/**
+ * @brief Current connection state
+ */
+StationState getStationState();
+
+/**
+ * @brief "idle", "scanning", "connecting", "associated", "connected" or "backoff"
+ */
+const char* getStationStateName(StationState state);
+
+/**
+ * @brief Reason code of the last disconnect (0 if none yet)
+ */
+uint8_t getLastDisconnectReason();
+
+/**
+ * @brief Short description of a wifi_err_reason_t code
+ */
+const char* getDisconnectReasonName(uint8_t reason);
+
+/**
+ * @brief Milliseconds until the next retry while in STA_STATE_BACKOFF, else 0
+ */
+uint32_t getStationRetryInMs();
+
+/**
+ * @brief millis() when the current connection got its IP address (0 if not connected)
  */
-void handleWiFiConnection();
+unsigned long getStationConnectedSince();
 
 /**
  * @brief Disconnects from current WiFi network
@@ -0,0 +1,655 @@
+/**
+ * @file wifi_scan.cpp
+ * @brief Shared asynchronous WiFi scan service implementation
+ *
+ * This file implements the background scan service:
+ * - Non-blocking scans via WiFi.scanNetworks(async=true)
+ * - Channel schedules: per-channel steps with their own dwell, merged by BSSID
+ * - Measured time per scheduled channel
+ * - Request coalescing: callers join a scan that already covers their channels
+ * - Generation-numbered table of fixed-size scan records guarded by a mutex
+ * - SSID hash index for by-name lookups
+ * - Grouping of multi-SSID BSSIDs into physical radios
+ * - Stable per-BSSID network IDs that survive rescans
+ * - Scan-to-scan network events for incremental consumers
+ * - Completion callbacks dispatched from the main loop
+ * - Recovery from failed or stuck scans
+ *
+ * @author Arunkumar Mourougappane
+ * @version 5.0.0
+ * @date 2026-01-17
+ */
+
+#include "wifi_scan.h"
+#include "logging.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_wifi_types.h>
+
+// ==========================================
+// SERVICE STATE
+// ==========================================
+static WiFiScanStore scanStore;                 // Guarded by scanMutex
+static SemaphoreHandle_t scanMutex = nullptr;
+static bool scanRunning = false;                // Guarded by scanMutex
+static bool scannerReserved = false;            // Guarded by scanMutex
+static unsigned long scanStartedAt = 0;
+static WiFiScanSchedule activeSchedule;         // Guarded by scanMutex
+static uint16_t activeMask = 0;                 // Channels the running scan covers
+static uint8_t scheduleStep = 0;                // Index into activeSchedule.channels
+static unsigned long stepStartedAt = 0;
+static volatile unsigned long stepDoneAt = 0;   // Set by the SCAN_DONE event, 0 while the step runs
+static WiFiScanCallback scanCallbacks[WIFI_SCAN_MAX_CALLBACKS];
+static uint8_t scanCallbackCount = 0;           // Guarded by scanMutex
+
+// BSSID -> ID assignments, kept across scans (guarded by scanMutex)
+struct TrackedBssid {
+    uint8_t bssid[6];
+    uint16_t id;                // 0 = free slot
+    uint32_t lastGeneration;    // Last scan that saw this BSSID
+};
+static TrackedBssid trackedBssids[WIFI_SCAN_TRACKED_BSSIDS];
+static uint16_t nextNetworkId = 1;
+
+// Differences between published scans (guarded by scanMutex)
+static ScanDeltaEngine scanDelta;
+static uint32_t loggedEventSequence = 0;
+
+// Results of the finished steps of a running scan (guarded by scanMutex)
+static ScanRecord stagedRecords[WIFI_SCAN_MAX_NETWORKS];
+static uint16_t stagedCount = 0;
+static uint16_t stagedFound = 0;
+static uint16_t stagedTimeMs[WIFI_SCAN_MAX_CHANNEL + 1];
+
+static void lockScan() {
+    if (scanMutex == nullptr) {
+        initializeWiFiScan();
+    }
+    xSemaphoreTake(scanMutex, portMAX_DELAY);
+}
+
+static void unlockScan() {
+    xSemaphoreGive(scanMutex);
+}
+
+// ==========================================
+// STABLE NETWORK IDS
+// ==========================================
+static bool networkIdInUse(uint16_t id) {
+    for (const TrackedBssid& tracked : trackedBssids) {
+        if (tracked.id == id) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief ID for a BSSID seen in scan `generation`, assigning one on first sight
+ * @details Unknown BSSIDs take the slot least recently seen; IDs wrap within
+ *          1..WIFI_SCAN_MAX_ID and skip any still assigned
+ */
+static uint16_t networkIdFor(const uint8_t* bssid, uint32_t generation) {
+    TrackedBssid* oldest = nullptr;  // Free slot, else the least recently seen
+    for (TrackedBssid& tracked : trackedBssids) {
+        if (tracked.id != 0 && memcmp(tracked.bssid, bssid, sizeof(tracked.bssid)) == 0) {
+            tracked.lastGeneration = generation;
+            return tracked.id;
+        }
+        if (oldest == nullptr ||
+            (oldest->id != 0 && (tracked.id == 0 || tracked.lastGeneration < oldest->lastGeneration))) {
+            oldest = &tracked;
+        }
+    }
+
+    oldest->id = 0;
+    uint16_t id = nextNetworkId;
+    while (networkIdInUse(id)) {
+        id = id >= WIFI_SCAN_MAX_ID ? 1 : id + 1;
+    }
+    nextNetworkId = id >= WIFI_SCAN_MAX_ID ? 1 : id + 1;
+
+    memcpy(oldest->bssid, bssid, sizeof(oldest->bssid));
+    oldest->id = id;
+    oldest->lastGeneration = generation;
+    return id;
+}
+
+// ==========================================
+// SSID HASH INDEX
+// ==========================================
+static_assert(WIFI_SCAN_MAX_NETWORKS < WIFI_SCAN_NO_RECORD, "Record indices must fit the SSID chains");
+static_assert((WIFI_SCAN_SSID_BUCKETS & (WIFI_SCAN_SSID_BUCKETS - 1)) == 0, "Bucket count must be a power of two");
+
+// FNV-1a over the NUL-terminated SSID
+static uint32_t ssidHash(const char* ssid) {
+    uint32_t hash = 2166136261u;
+    while (*ssid) {
+        hash ^= (uint8_t)*ssid++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void buildSsidIndex(uint16_t count) {
+    memset(scanStore.ssidBuckets, WIFI_SCAN_NO_RECORD, sizeof(scanStore.ssidBuckets));
+    // Insert backwards so each chain lists records in scan order
+    for (int i = (int)count - 1; i >= 0; i--) {
+        uint32_t hash = ssidHash(scanStore.records[i].ssid);
+        uint8_t& head = scanStore.ssidBuckets[hash & (WIFI_SCAN_SSID_BUCKETS - 1)];
+        scanStore.ssidHashes[i] = hash;
+        scanStore.ssidNext[i] = head;
+        head = (uint8_t)i;
+    }
+}
+
+// ==========================================
+// RADIO GROUPING
+// ==========================================
+bool isSameScanRadio(const ScanRecord& a, const ScanRecord& b) {
+    if (a.channel != b.channel) return false;
+    if (abs(a.rssi - b.rssi) > WIFI_SCAN_RADIO_RSSI_DB) return false;
+    // Vendors derive extra BSSIDs by setting the locally administered bit
+    // and/or counting up the last byte
+    if ((a.bssid[0] | 0x02) != (b.bssid[0] | 0x02)) return false;
+    if (memcmp(a.bssid + 1, b.bssid + 1, 4) != 0) return false;
+    return abs(a.bssid[5] - b.bssid[5]) <= WIFI_SCAN_RADIO_BSSID_SPAN;
+}
+
+// Number the records' radios; records are strongest first, so each radio is
+// represented by its strongest SSID
+static uint16_t groupRadios(uint16_t count) {
+    uint16_t radios = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        ScanRecord& record = scanStore.records[i];
+        record.radio = (uint8_t)radios;
+        for (uint16_t j = 0; j < i; j++) {
+            if (isSameScanRadio(scanStore.records[j], record)) {
+                record.radio = scanStore.records[j].radio;
+                break;
+            }
+        }
+        if (record.radio == radios) radios++;
+    }
+    return radios;
+}
+
+// ==========================================
+// SCAN EVENTS
+// ==========================================
+static_assert(sizeof(ScanDeltaNetwork::ssid) == sizeof(ScanRecord::ssid), "Event SSIDs must hold a full SSID");
+
+// Diff the freshly published records against the earlier scans (caller holds scanMutex)
+static void diffPublishedScan() {
+    scanDeltaBegin(scanDelta, scanStore.generation, scanStore.channelMask);
+    for (uint16_t i = 0; i < scanStore.count; i++) {
+        const ScanRecord& record = scanStore.records[i];
+        ScanDeltaNetwork network;
+        memcpy(network.ssid, record.ssid, sizeof(network.ssid));
+        memcpy(network.bssid, record.bssid, sizeof(network.bssid));
+        network.channel = record.channel;
+        network.rssi = record.rssi;
+        network.authMode = record.authMode;
+        network.id = record.id;
+        scanDeltaAdd(scanDelta, network);
+    }
+    scanDeltaEnd(scanDelta);
+}
+
+// Log the events of the latest scans; signal changes only at debug level
+static void logScanEvents() {
+    ScanDeltaEvent events[8];
+    uint32_t skipped = 0;
+    uint16_t count;
+    while ((count = readWiFiScanEvents(loggedEventSequence, events, 8, &skipped)) > 0) {
+        if (skipped > 0) {
+            LOG_DEBUG(TAG_WIFI, "%lu scan events not logged", (unsigned long)skipped);
+        }
+        for (uint16_t i = 0; i < count; i++) {
+            const ScanDeltaEvent& event = events[i];
+            const ScanDeltaNetwork& network = event.network;
+            const char* ssid = network.ssid[0] != '\0' ? network.ssid : "<hidden>";
+            const uint8_t* b = network.bssid;
+            switch (event.type) {
+                case SCAN_DELTA_APPEARED:
+                    if (event.generation == 1) break;  // The first scan finds everything; no news
+                    LOG_INFO(TAG_WIFI, "Network appeared: %s (%02X:%02X:%02X:%02X:%02X:%02X) ch %u, %d dBm, %s", ssid,
+                             b[0], b[1], b[2], b[3], b[4], b[5], network.channel, network.rssi,
+                             getWiFiAuthModeName(network.authMode));
+                    break;
+                case SCAN_DELTA_VANISHED:
+                    LOG_INFO(TAG_WIFI, "Network vanished: %s (%02X:%02X:%02X:%02X:%02X:%02X) ch %u", ssid, b[0], b[1],
+                             b[2], b[3], b[4], b[5], network.channel);
+                    break;
+                case SCAN_DELTA_CHANNEL:
+                    LOG_INFO(TAG_WIFI, "Network %s moved from channel %u to %u", ssid, event.previousChannel,
+                             network.channel);
+                    break;
+                case SCAN_DELTA_AUTH:
+                    LOG_WARN(TAG_WIFI, "Network %s changed security from %s to %s", ssid,
+                             getWiFiAuthModeName(event.previousAuthMode), getWiFiAuthModeName(network.authMode));
+                    break;
+                case SCAN_DELTA_RSSI:
+                    LOG_DEBUG(TAG_WIFI, "Network %s signal %d -> %d dBm", ssid, event.previousRssi, network.rssi);
+                    break;
+            }
+        }
+    }
+}
+
+const char* getWiFiAuthModeName(uint8_t authMode) {
+    switch ((wifi_auth_mode_t)authMode) {
+        case WIFI_AUTH_OPEN: return "Open";
+        case WIFI_AUTH_WEP: return "WEP";
+        case WIFI_AUTH_WPA_PSK: return "WPA";
+        case WIFI_AUTH_WPA2_PSK: return "WPA2";
+        case WIFI_AUTH_WPA_WPA2_PSK: return "WPA/WPA2";
+        case WIFI_AUTH_WPA2_ENTERPRISE: return "WPA2-Ent";
+        case WIFI_AUTH_WPA3_PSK: return "WPA3";
+        case WIFI_AUTH_WPA2_WPA3_PSK: return "WPA2/WPA3";
+        case WIFI_AUTH_WAPI_PSK: return "WAPI";
+        default: return "Unknown";
+    }
+}
+
+// ==========================================
+// INITIALIZATION
+// ==========================================
+void initializeWiFiScan() {
+    if (scanMutex != nullptr) return;
+
+    scanMutex = xSemaphoreCreateMutex();
+    if (scanMutex == nullptr) {
+        LOG_ERROR(TAG_WIFI, "Failed to create scan store mutex");
+        return;
+    }
+    buildSsidIndex(0);
+    scanStore.count = 0;
+    scanStore.found = 0;
+    scanStore.radioCount = 0;
+    scanStore.generation = 0;
+    scanStore.completedAt = 0;
+    scanStore.channelMask = 0;
+    memset(scanStore.channelTimeMs, 0, sizeof(scanStore.channelTimeMs));
+    scanStore.durationMs = 0;
+    scanStore.passive = false;
+    scanDeltaClear(scanDelta);
+    loggedEventSequence = scanDeltaSequence(scanDelta);
+    scanRunning = false;
+    scanCallbackCount = 0;
+
+    // The loop polls scanComplete() only every few ms; the event marks the
+    // real end of each step for the per-channel timing
+    WiFi.onEvent([](arduino_event_id_t, arduino_event_info_t) { stepDoneAt = millis(); },
+                 ARDUINO_EVENT_WIFI_SCAN_DONE);
+}
+
+// ==========================================
+// SCAN SCHEDULES
+// ==========================================
+void clearWiFiScanSchedule(WiFiScanSchedule& schedule, bool passive) {
+    schedule.count = 0;
+    schedule.passive = passive;
+}
+
+bool addWiFiScanChannel(WiFiScanSchedule& schedule, uint8_t channel, uint16_t dwellMs) {
+    if (channel < 1 || channel > WIFI_SCAN_MAX_CHANNEL || schedule.count >= WIFI_SCAN_MAX_CHANNEL) {
+        return false;
+    }
+    if (getWiFiScanScheduleMask(schedule) & (1u << channel)) return false;
+
+    schedule.channels[schedule.count] = channel;
+    schedule.dwellMs[schedule.count] = constrain(dwellMs, WIFI_SCAN_MIN_DWELL_MS, WIFI_SCAN_MAX_DWELL_MS);
+    schedule.count++;
+    return true;
+}
+
+uint16_t getWiFiScanScheduleMask(const WiFiScanSchedule& schedule) {
+    if (schedule.count == 0) return WIFI_SCAN_ALL_CHANNELS;
+    uint16_t mask = 0;
+    for (uint8_t i = 0; i < schedule.count; i++) {
+        mask |= 1u << schedule.channels[i];
+    }
+    return mask;
+}
+
+// Start the current step of activeSchedule (caller holds scanMutex)
+static bool startScanStep() {
+    uint8_t channel = 0;  // 0 = all channels
+    uint32_t dwellMs = WIFI_SCAN_MAX_MS_PER_CHANNEL;
+    if (activeSchedule.count > 0) {
+        channel = activeSchedule.channels[scheduleStep];
+        dwellMs = activeSchedule.dwellMs[scheduleStep];
+    }
+    stepDoneAt = 0;
+    stepStartedAt = millis();
+    // async=true, show_hidden=true
+    int16_t result = WiFi.scanNetworks(true, true, activeSchedule.passive, dwellMs, channel);
+    if (result != WIFI_SCAN_RUNNING) {
+        LOG_ERROR(TAG_WIFI, "Failed to start scan on channel %u (%d)", channel, result);
+        return false;
+    }
+    return true;
+}
+
+// Merge the driver's results for the finished step into stagedRecords
+static void stageScanResults(int16_t found, unsigned long seenAt) {
+    for (int16_t i = 0; i < found; i++) {
+        // Copy straight from the driver's record: no String per network
+        const wifi_ap_record_t* ap = static_cast<const wifi_ap_record_t*>(WiFi.getScanInfoByIndex(i));
+        if (ap == nullptr) break;
+
+        // A strong AP leaks into neighbouring channels' steps: keep its best reading
+        ScanRecord* record = nullptr;
+        for (uint16_t j = 0; j < stagedCount; j++) {
+            if (memcmp(stagedRecords[j].bssid, ap->bssid, sizeof(stagedRecords[j].bssid)) == 0) {
+                record = &stagedRecords[j];
+                break;
+            }
+        }
+        if (record != nullptr) {
+            if (ap->rssi <= record->rssi) continue;
+        } else if (stagedCount < WIFI_SCAN_MAX_NETWORKS) {
+            record = &stagedRecords[stagedCount++];
+            stagedFound++;
+        } else {
+            stagedFound++;
+            continue;
+        }
+
+        memcpy(record->ssid, ap->ssid, sizeof(record->ssid) - 1);
+        record->ssid[sizeof(record->ssid) - 1] = '\0';
+        memcpy(record->bssid, ap->bssid, sizeof(record->bssid));
+        record->channel = ap->primary;
+        record->rssi = ap->rssi;
+        record->authMode = (uint8_t)ap->authmode;
+        record->phyFlags = (ap->phy_11b ? SCAN_PHY_11B : 0) | (ap->phy_11g ? SCAN_PHY_11G : 0) |
+                           (ap->phy_11n ? SCAN_PHY_11N : 0) | (ap->phy_lr ? SCAN_PHY_LR : 0) |
+                           (ap->wps ? SCAN_PHY_WPS : 0) |
+                           (ap->second == WIFI_SECOND_CHAN_ABOVE ? SCAN_PHY_HT40_ABOVE : 0) |
+                           (ap->second == WIFI_SECOND_CHAN_BELOW ? SCAN_PHY_HT40_BELOW : 0);
+        record->seenAt = seenAt;
+    }
+}
+
+// Copy the staged results into the store as a new generation (caller holds scanMutex)
+static void publishStagedResults(unsigned long now) {
+    uint32_t generation = scanStore.generation + 1;
+    // A sweep arrives strongest first; merged steps are re-sorted to match
+    for (uint16_t i = 1; i < stagedCount; i++) {
+        ScanRecord record = stagedRecords[i];
+        uint16_t j = i;
+        for (; j > 0 && stagedRecords[j - 1].rssi < record.rssi; j--) {
+            stagedRecords[j] = stagedRecords[j - 1];
+        }
+        stagedRecords[j] = record;
+    }
+    for (uint16_t i = 0; i < stagedCount; i++) {
+        scanStore.records[i] = stagedRecords[i];
+        scanStore.records[i].id = networkIdFor(stagedRecords[i].bssid, generation);
+    }
+    buildSsidIndex(stagedCount);
+    scanStore.radioCount = groupRadios(stagedCount);
+    scanStore.count = stagedCount;
+    scanStore.found = stagedFound;
+    scanStore.generation = generation;
+    scanStore.completedAt = now;
+    scanStore.channelMask = activeMask;
+    memcpy(scanStore.channelTimeMs, stagedTimeMs, sizeof(scanStore.channelTimeMs));
+    scanStore.durationMs = now - scanStartedAt;
+    scanStore.passive = activeSchedule.passive;
+    diffPublishedScan();
+}
+
+// ==========================================
+// SCAN REQUESTS
+// ==========================================
+bool requestWiFiScan(WiFiScanCallback onComplete) {
+    static const WiFiScanSchedule fullSweep = {};
+    return requestWiFiScanSchedule(fullSweep, onComplete);
+}
+
+bool requestWiFiScanSchedule(const WiFiScanSchedule& schedule, WiFiScanCallback onComplete) {
+    if ((WiFi.getMode() & WIFI_MODE_STA) == 0) {
+        LOG_WARN(TAG_WIFI, "Scan requested without a station interface");
+        return false;
+    }
+
+    uint16_t mask = getWiFiScanScheduleMask(schedule);
+    lockScan();
+    if (scannerReserved) {
+        unlockScan();
+        LOG_WARN(TAG_WIFI, "Scan refused: radio reserved by a channel survey");
+        return false;
+    }
+    if (!scanRunning) {
+        activeSchedule = schedule;
+        activeMask = mask;
+        scheduleStep = 0;
+        stagedCount = 0;
+        stagedFound = 0;
+        memset(stagedTimeMs, 0, sizeof(stagedTimeMs));
+        if (!startScanStep()) {
+            unlockScan();
+            return false;
+        }
+        scanRunning = true;
+        scanStartedAt = stepStartedAt;
+        LOG_DEBUG(TAG_WIFI, "Background scan started (generation %lu, %u channel steps, %s)",
+                  (unsigned long)scanStore.generation + 1, schedule.count, schedule.passive ? "passive" : "active");
+    } else if ((mask & ~activeMask) != 0) {
+        unlockScan();
+        LOG_WARN(TAG_WIFI, "Scanner busy with a scan that skips requested channels");
+        return false;
+    } else {
+        LOG_DEBUG(TAG_WIFI, "Joining background scan already in progress");
+    }
+
+    bool queued = true;
+    if (onComplete != nullptr) {
+        bool present = false;
+        for (uint8_t i = 0; i < scanCallbackCount; i++) {
+            if (scanCallbacks[i] == onComplete) present = true;
+        }
+        if (!present) {
+            if (scanCallbackCount < WIFI_SCAN_MAX_CALLBACKS) {
+                scanCallbacks[scanCallbackCount++] = onComplete;
+            } else {
+                queued = false;
+            }
+        }
+    }
+    unlockScan();
+
+    if (!queued) {
+        LOG_WARN(TAG_WIFI, "Too many scan listeners, request dropped");
+    }
+    return queued;
+}
+
+bool requestWiFiScanIfStale(uint32_t maxAgeMs, WiFiScanCallback onComplete) {
+    lockScan();
+    bool fresh = !scanRunning && scanStore.generation != 0 && scanStore.channelMask == WIFI_SCAN_ALL_CHANNELS &&
+                 millis() - scanStore.completedAt <= maxAgeMs;
+    unlockScan();
+    if (fresh) {
+        if (onComplete != nullptr) onComplete(true);
+        return true;
+    }
+    return requestWiFiScan(onComplete);
+}
+
+// ==========================================
+// RESULT PUBLISHING
+// ==========================================
+void handleWiFiScan() {
+    if (scanMutex == nullptr) return;
+
+    lockScan();
+    if (!scanRunning) {
+        unlockScan();
+        return;
+    }
+
+    int16_t found = WiFi.scanComplete();
+    if (found == WIFI_SCAN_RUNNING && millis() - stepStartedAt < WIFI_SCAN_STUCK_MS) {
+        unlockScan();
+        return;
+    }
+
+    bool success = found >= 0;
+    if (success) {
+        unsigned long doneAt = stepDoneAt != 0 ? stepDoneAt : millis();
+        stageScanResults(found, doneAt);
+        if (activeSchedule.count > 0) {
+            uint8_t channel = activeSchedule.channels[scheduleStep];
+            uint32_t elapsed = doneAt - stepStartedAt;
+            stagedTimeMs[channel] = elapsed > UINT16_MAX ? UINT16_MAX : (uint16_t)elapsed;
+        }
+        // Staged; release the driver's copy before the next step reuses it
+        WiFi.scanDelete();
+
+        if (activeSchedule.count > 0 && ++scheduleStep < activeSchedule.count) {
+            if (startScanStep()) {
+                unlockScan();
+                return;
+            }
+            success = false;
+        } else {
+            publishStagedResults(doneAt);
+        }
+    } else {
+        WiFi.scanDelete();
+    }
+    scanRunning = false;
+
+    WiFiScanCallback callbacks[WIFI_SCAN_MAX_CALLBACKS];
+    uint8_t callbackCount = scanCallbackCount;
+    memcpy(callbacks, scanCallbacks, sizeof(callbacks[0]) * callbackCount);
+    scanCallbackCount = 0;
+    uint32_t generation = scanStore.generation;
+    uint16_t count = scanStore.count;
+    uint32_t durationMs = scanStore.durationMs;
+    unlockScan();
+
+    if (success) {
+        LOG_DEBUG(TAG_WIFI, "Scan generation %lu: %u networks in %lu ms", (unsigned long)generation, count,
+                  (unsigned long)durationMs);
+        logScanEvents();
+    } else if (found >= 0) {
+        LOG_WARN(TAG_WIFI, "Scan schedule stopped before its last channel");
+    } else if (found == WIFI_SCAN_RUNNING) {
+        LOG_WARN(TAG_WIFI, "Background scan did not complete within %d ms, abandoned", WIFI_SCAN_STUCK_MS);
+    } else {
+        LOG_WARN(TAG_WIFI, "Background scan failed (%d)", found);
+    }
+
+    // Callbacks run unlocked so they can read the store or request another scan
+    for (uint8_t i = 0; i < callbackCount; i++) {
+        callbacks[i](success);
+    }
+}
+
+// ==========================================
+// STORE ACCESS
+// ==========================================
+bool isWiFiScanRunning() {
+    lockScan();
+    bool running = scanRunning;
+    unlockScan();
+    return running;
+}
+
+bool reserveWiFiScanner() {
+    lockScan();
+    bool reserved = !scanRunning && !scannerReserved;
+    if (reserved) scannerReserved = true;
+    unlockScan();
+    return reserved;
+}
+
+void releaseWiFiScanner() {
+    lockScan();
+    scannerReserved = false;
+    unlockScan();
+}
+
+uint32_t getWiFiScanGeneration() {
+    lockScan();
+    uint32_t generation = scanStore.generation;
+    unlockScan();
+    return generation;
+}
+
+uint32_t getWiFiScanAge() {
+    lockScan();
+    uint32_t age = scanStore.generation == 0 ? UINT32_MAX : (uint32_t)(millis() - scanStore.completedAt);
+    unlockScan();
+    return age;
+}
+
+void formatWiFiScanAge(uint32_t ageMs, char* buffer, size_t length) {
+    if (ageMs == UINT32_MAX) {
+        snprintf(buffer, length, "never");
+    } else if (ageMs < 2000) {
+        snprintf(buffer, length, "just now");
+    } else if (ageMs < 120000) {
+        snprintf(buffer, length, "%lu s ago", (unsigned long)(ageMs / 1000));
+    } else if (ageMs < 7200000) {
+        snprintf(buffer, length, "%lu min ago", (unsigned long)(ageMs / 60000));
+    } else {
+        snprintf(buffer, length, "%lu h ago", (unsigned long)(ageMs / 3600000));
+    }
+}
+
+int findScanRecord(const WiFiScanStore& store, uint16_t id) {
+    if (id == 0) return -1;
+    for (uint16_t i = 0; i < store.count; i++) {
+        if (store.records[i].id == id) return i;
+    }
+    return -1;
+}
+
+int findScanRecordBySsid(const WiFiScanStore& store, const char* ssid, int previous) {
+    uint32_t hash = ssidHash(ssid);
+    uint8_t i = previous < 0 ? store.ssidBuckets[hash & (WIFI_SCAN_SSID_BUCKETS - 1)]
+                             : store.ssidNext[previous];
+    for (; i != WIFI_SCAN_NO_RECORD; i = store.ssidNext[i]) {
+        if (store.ssidHashes[i] == hash && strcmp(store.records[i].ssid, ssid) == 0) return i;
+    }
+    return -1;
+}
+
+uint16_t readWiFiScanEvents(uint32_t& cursor, ScanDeltaEvent* events, uint16_t max, uint32_t* skipped) {
+    lockScan();
+    uint16_t count = scanDeltaRead(scanDelta, cursor, events, max, skipped);
+    unlockScan();
+    return count;
+}
+
+uint32_t getWiFiScanEventSequence() {
+    lockScan();
+    uint32_t sequence = scanDeltaSequence(scanDelta);
+    unlockScan();
+    return sequence;
+}
+
+void setWiFiScanEventThreshold(uint8_t rssiDb) {
+    lockScan();
+    scanDeltaSetRssiThreshold(scanDelta, rssiDb);
+    unlockScan();
+}
+
+uint8_t getWiFiScanEventThreshold() {
+    lockScan();
+    uint8_t threshold = scanDelta.rssiThreshold;
+    unlockScan();
+    return threshold;
+}
+
+const WiFiScanStore& lockWiFiScanStore() {
+    lockScan();
+    return scanStore;
+}
+
+void unlockWiFiScanStore() {
+    unlockScan();
+}
@@ -0,0 +1,306 @@
+/**
+ * @file wifi_scan.h
+ * @brief Shared asynchronous WiFi scan service
+ *
+ * This header defines the single owner of the WiFi scanner. Scans run with
+ * WiFi.scanNetworks(async=true) in the background; when one completes its
+ * results are copied into a shared, generation-numbered store and the
+ * radio's result buffer is released. Each network is one fixed-size
+ * ScanRecord in a preallocated table, so a scan allocates nothing.
+ *
+ * A scan follows a WiFiScanSchedule: either one sweep over every channel,
+ * or a list of channels scanned one at a time, each with its own dwell time
+ * and active or passive probing. The service measures the time actually
+ * spent on each scheduled channel and merges the steps into one result.
+ *
+ * Each access point keeps the same small ID from scan to scan (keyed by
+ * BSSID), so an ID taken from a printed table or web link still names the
+ * same network after later scans.
+ *
+ * Every published scan is also diffed against the previous ones
+ * (scan_delta.h). The resulting events (network appeared, vanished, moved
+ * channel, changed security or signal) are kept for readers that only want
+ * what changed, such as periodic scanning and the web scan page.
+ *
+ * Consumers (CLI scan, channel analyzer, signal monitor, web pages, secure
+ * connect) read the store instead of scanning themselves. They either reuse
+ * results that are recent enough or request a fresh scan and pick the
+ * results up when the generation advances, so concurrent requests share one
+ * scan and nothing blocks on the radio.
+ *
+ * @author Arunkumar Mourougappane
+ * @version 5.0.0
+ * @date 2026-01-17
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "config.h"
+#include "scan_delta.h"
+
+// ==========================================
+// SCAN SERVICE CONFIGURATION
+// ==========================================
+#define WIFI_SCAN_MAX_NETWORKS 50        // Networks kept per scan
+#define WIFI_SCAN_MAX_CALLBACKS 6        // Completion callbacks waiting on one scan
+#define WIFI_SCAN_MAX_MS_PER_CHANNEL 300 // Active dwell per channel
+#define WIFI_SCAN_FRESH_MS 10000         // Results younger than this are reused
+#define WIFI_SCAN_STUCK_MS 20000         // Abandon a scan that never completes
+#define WIFI_SCAN_TRACKED_BSSIDS 64      // BSSIDs that keep their ID across scans
+#define WIFI_SCAN_MAX_ID 999             // IDs wrap within 1..999 (fits the scan table)
+#define WIFI_SCAN_MAX_CHANNEL 14         // 2.4GHz channels 1-14
+#define WIFI_SCAN_ALL_CHANNELS 0x3FFE    // Channel mask of a full sweep (channels 1-13)
+#define WIFI_SCAN_MIN_DWELL_MS 20        // Shortest per-channel dwell in a schedule
+#define WIFI_SCAN_MAX_DWELL_MS 1500      // Longest per-channel dwell in a schedule
+#define WIFI_SCAN_RADIO_RSSI_DB 8        // Max RSSI spread between SSIDs of one radio
+#define WIFI_SCAN_RADIO_BSSID_SPAN 15    // Max distance between last BSSID bytes of one radio
+
+// ==========================================
+// SCAN STORE
+// ==========================================
+
+// PHY capability flags (ScanRecord::phyFlags)
+#define SCAN_PHY_11B 0x01
+#define SCAN_PHY_11G 0x02
+#define SCAN_PHY_11N 0x04
+#define SCAN_PHY_LR  0x08   // Espressif long range
+#define SCAN_PHY_WPS 0x10
+#define SCAN_PHY_HT40_ABOVE 0x20   // 40 MHz, secondary channel above the primary
+#define SCAN_PHY_HT40_BELOW 0x40   // 40 MHz, secondary channel below the primary
+
+#define WIFI_SCAN_SSID_BUCKETS 64      // SSID hash index buckets (power of two)
+#define WIFI_SCAN_NO_RECORD 0xFF       // End of an SSID hash chain
+
+/**
+ * @brief One network from a completed scan (plain data, no heap)
+ */
+struct ScanRecord {
+    char ssid[SystemConstants::MAX_SSID_LENGTH + 1];  ///< NUL-terminated, empty for hidden networks
+    uint8_t bssid[6];           ///< Access point MAC address
+    uint8_t channel;            ///< Primary channel
+    int8_t rssi;                ///< Signal strength in dBm
+    uint8_t authMode;           ///< wifi_auth_mode_t
+    uint8_t phyFlags;           ///< SCAN_PHY_* bits
+    uint8_t radio;              ///< Physical radio (index into the store's radio groups)
+    uint16_t id;                ///< Stable per-BSSID ID shown in scan tables
+    uint32_t seenAt;            ///< millis() when the scan reported this network
+};
+
+static_assert(sizeof(ScanRecord) <= 52, "ScanRecord should stay compact");
+
+/**
+ * @brief Results of the most recent completed scan
+ * @details Records keep the radio's order (strongest first). The SSID index
+ *          chains records with the same SSID hash for findScanRecordBySsid().
+ *          Records that one access point advertises for several SSIDs share
+ *          a radio number; radios are numbered in order of first (strongest)
+ *          appearance.
+ */
+struct WiFiScanStore {
+    ScanRecord records[WIFI_SCAN_MAX_NETWORKS];
+    uint32_t ssidHashes[WIFI_SCAN_MAX_NETWORKS];     ///< FNV-1a hash of each record's SSID
+    uint8_t ssidNext[WIFI_SCAN_MAX_NETWORKS];        ///< Next record in the same bucket
+    uint8_t ssidBuckets[WIFI_SCAN_SSID_BUCKETS];     ///< First record per bucket
+    uint16_t count;             ///< Records held in records[]
+    uint16_t found;             ///< Networks the radio reported (may exceed count)
+    uint16_t radioCount;        ///< Distinct physical radios among the records
+    uint32_t generation;        ///< Incremented per completed scan, 0 = never scanned
+    unsigned long completedAt;  ///< millis() when this generation was published
+    uint16_t channelMask;       ///< Bit per channel the scan covered (WIFI_SCAN_ALL_CHANNELS for a sweep)
+    uint16_t channelTimeMs[WIFI_SCAN_MAX_CHANNEL + 1];  ///< Measured time per scheduled channel, 0 in a sweep
+    uint32_t durationMs;        ///< Time from the first channel to the last
+    bool passive;               ///< Scanned by listening for beacons only
+};
+
+/**
+ * @brief Channels, dwell times and probing mode for one scan
+ * @details count == 0 asks for a single sweep over every channel with the
+ *          default active dwell. Otherwise each listed channel is scanned
+ *          in turn for its own dwell (the maximum per channel for an active
+ *          scan, the listening time for a passive one).
+ */
+struct WiFiScanSchedule {
+    uint8_t channels[WIFI_SCAN_MAX_CHANNEL];
+    uint16_t dwellMs[WIFI_SCAN_MAX_CHANNEL];
+    uint8_t count;              ///< Channels in the schedule, 0 = full sweep
+    bool passive;               ///< Listen for beacons instead of sending probe requests
+};
+
+/**
+ * @brief Called from the main loop when a requested scan finishes
+ * @param success false if the scan failed or was abandoned (store unchanged)
+ */
+typedef void (*WiFiScanCallback)(bool success);
+
+// ==========================================
+// SCAN SERVICE API
+// ==========================================
+
+/**
+ * @brief Initialize the scan store and its mutex
+ */
+void initializeWiFiScan();
+
+/**
+ * @brief Reset a schedule to an empty channel list
+ * @param schedule Schedule to clear (an empty schedule is a full sweep)
+ * @param passive Listen for beacons instead of probing
+ */
+void clearWiFiScanSchedule(WiFiScanSchedule& schedule, bool passive = false);
+
+/**
+ * @brief Append a channel to a schedule
+ * @param schedule Schedule to extend
+ * @param channel Channel 1-14
+ * @param dwellMs Dwell time, clamped to WIFI_SCAN_MIN_DWELL_MS..WIFI_SCAN_MAX_DWELL_MS
+ * @return false if the channel is invalid, already listed or the schedule is full
+ */
+bool addWiFiScanChannel(WiFiScanSchedule& schedule, uint8_t channel, uint16_t dwellMs);
+
+/**
+ * @brief Channels a schedule covers as a bit mask (bit n = channel n)
+ */
+uint16_t getWiFiScanScheduleMask(const WiFiScanSchedule& schedule);
+
+/**
+ * @brief Start a fresh full background scan, or join the one already running
+ * @param onComplete Optional callback run from handleWiFiScan() when the scan finishes
+ * @return true if a scan is now running and onComplete will be called
+ * @details Fails when the radio has no station interface (AP or idle mode)
+ *          or a partial schedule is running
+ */
+bool requestWiFiScan(WiFiScanCallback onComplete = nullptr);
+
+/**
+ * @brief Start a scan following a channel schedule, or join a running one
+ * @param schedule Channels and dwell times (copied)
+ * @param onComplete Optional callback run from handleWiFiScan() when the scan finishes
+ * @return true if a scan is now running and onComplete will be called
+ * @details A running scan is joined only when it covers every requested
+ *          channel; its dwell times and probing mode apply
+ */
+bool requestWiFiScanSchedule(const WiFiScanSchedule& schedule, WiFiScanCallback onComplete = nullptr);
+
+/**
+ * @brief Reuse recent full-sweep results or start a scan when they are too old
+ * @param maxAgeMs Oldest acceptable result age in milliseconds
+ * @param onComplete Callback, run immediately if the store is fresh enough
+ * @return true if onComplete ran or will run
+ * @details Results of a partial schedule never count as fresh
+ */
+bool requestWiFiScanIfStale(uint32_t maxAgeMs, WiFiScanCallback onComplete);
+
+/**
+ * @brief Poll the running scan and publish its results (call from loop)
+ * @details Starts the next channel of a schedule when one finishes. After
+ *          the last channel, publishes the merged results into the store,
+ *          frees the radio's result buffer and runs the waiting callbacks
+ */
+void handleWiFiScan();
+
+/**
+ * @brief Check if a background scan is in progress
+ */
+bool isWiFiScanRunning();
+
+/**
+ * @brief Generation of the stored results (0 if nothing was scanned yet)
+ */
+uint32_t getWiFiScanGeneration();
+
+/**
+ * @brief Milliseconds since the stored results were published
+ * @return Age in ms, or UINT32_MAX if nothing was scanned yet
+ */
+uint32_t getWiFiScanAge();
+
+/**
+ * @brief Format a result age for display
+ * @param ageMs Age from getWiFiScanAge()
+ * @param buffer Output buffer, e.g. "just now", "42 s ago", "3 min ago"
+ * @param length Size of buffer
+ */
+void formatWiFiScanAge(uint32_t ageMs, char* buffer, size_t length);
+
+/**
+ * @brief Find a network in the store by its stable ID
+ * @param store Locked scan store
+ * @param id ID from a scan table
+ * @return Index into store.records, or -1 if the BSSID was not in the last scan
+ */
+int findScanRecord(const WiFiScanStore& store, uint16_t id);
+
+/**
+ * @brief Check whether two records look like SSIDs of the same physical radio
+ * @details Same channel, RSSI within WIFI_SCAN_RADIO_RSSI_DB, and BSSIDs that
+ *          match except for the locally administered bit and a small
+ *          offset in the last byte (how multi-SSID APs derive BSSIDs)
+ */
+bool isSameScanRadio(const ScanRecord& a, const ScanRecord& b);
+
+/**
+ * @brief Find the next record with a given SSID through the hash index
+ * @param store Locked scan store
+ * @param ssid SSID to look up (exact match)
+ * @param previous Index returned by the previous call, or -1 to start
+ * @return Index into store.records, or -1 when there are no more matches
+ */
+int findScanRecordBySsid(const WiFiScanStore& store, const char* ssid, int previous = -1);
+
+/**
+ * @brief Copy the scan events after a cursor
+ * @param cursor 0 for the oldest event held, or a value from
+ *        getWiFiScanEventSequence() or a previous call; advanced past the
+ *        copied events
+ * @param events Output array
+ * @param max Capacity of events
+ * @param skipped Optional, receives the events lost because the reader fell behind
+ * @return Events copied; call again while it returns max
+ */
+uint16_t readWiFiScanEvents(uint32_t& cursor, ScanDeltaEvent* events, uint16_t max, uint32_t* skipped = nullptr);
+
+/**
+ * @brief Cursor for reading only events from later scans
+ */
+uint32_t getWiFiScanEventSequence();
+
+/**
+ * @brief Set the signal change in dB that makes an RSSI event
+ */
+void setWiFiScanEventThreshold(uint8_t rssiDb);
+
+/**
+ * @brief Signal change in dB that makes an RSSI event
+ */
+uint8_t getWiFiScanEventThreshold();
+
+/**
+ * @brief Short name of a wifi_auth_mode_t for events and logs ("WPA2", "Open", ...)
+ */
+const char* getWiFiAuthModeName(uint8_t authMode);
+
+/**
+ * @brief Reserve the radio for a non-scan user (e.g. a channel survey)
+ * @return false if a scan is running or the radio is already reserved
+ * @details requestWiFiScan() fails until releaseWiFiScanner() is called
+ */
+bool reserveWiFiScanner();
+
+/**
+ * @brief Release a reservation taken with reserveWiFiScanner()
+ */
+void releaseWiFiScanner();
+
+/**
+ * @brief Lock the store for reading
+ * @return The store; valid until unlockWiFiScanStore()
+ * @details Keep the lock short: the loop publishes new results under it
+ */
+const WiFiScanStore& lockWiFiScanStore();
+
+/**
+ * @brief Release the lock taken by lockWiFiScanStore()
+ */
+void unlockWiFiScanStore();
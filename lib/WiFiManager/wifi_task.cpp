@@ -7,6 +7,7 @@
  * - Asynchronous mode switching (AP, Station, Idle)
  * - AP configuration loading from NVS
  * - Safe WiFi state transitions
+ * - WiFi event forwarding into the station connection state machine
  * - Core 1 execution for optimal performance
  * 
  * @author Arunkumar Mourougappane
@@ -19,6 +20,7 @@
 #include "ap_config.h"
 #include "station_config.h"
 #include "logging.h"
+#include <WiFi.h>
 #if defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_TFT) || defined(ARDUINO_ADAFRUIT_FEATHER_ESP32S3_REVERSETFT)
 #include "tft_display.h"
 #endif
@@ -29,6 +31,45 @@
 static QueueHandle_t wifiCommandQueue = nullptr;
 static TaskHandle_t wifiTaskHandle = nullptr;
 
+// ==========================================
+// WIFI EVENT FORWARDING
+// ==========================================
+
+// Runs in the WiFi event task: only translate and queue, the state machine
+// itself runs in wifiCommandTask
+static void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+    StationEvent staEvent;
+    uint8_t reason = 0;
+    
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_START:
+            staEvent = STA_EVENT_START;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_STOP:
+            staEvent = STA_EVENT_STOP;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+            staEvent = STA_EVENT_CONNECTED;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            staEvent = STA_EVENT_GOT_IP;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+            staEvent = STA_EVENT_LOST_IP;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            staEvent = STA_EVENT_DISCONNECTED;
+            reason = info.wifi_sta_disconnected.reason;
+            break;
+        default:
+            return;
+    }
+    
+    if (!requestStationEvent(staEvent, reason)) {
+        LOG_WARN(TAG_TASK, "WiFi command queue full, dropped station event %d", staEvent);
+    }
+}
+
 // ==========================================
 // WIFI COMMAND TASK
 // ==========================================
@@ -38,8 +79,17 @@ static void wifiCommandTask(void* parameter) {
     LOG_INFO(TAG_TASK, "WiFi Command Task started on Core 1");
     
     while (true) {
-        // Wait for commands (block indefinitely)
-        if (xQueueReceive(wifiCommandQueue, &cmd, portMAX_DELAY) == pdTRUE) {
+        // Run connect timeouts and retries, then wait for the next command,
+        // event or deadline
+        uint32_t waitMs = serviceStationConnection();
+        TickType_t waitTicks = waitMs == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(waitMs) + 1;
+        
+        if (xQueueReceive(wifiCommandQueue, &cmd, waitTicks) == pdTRUE) {
+            if (cmd.type == WIFI_CMD_STA_EVENT) {
+                handleStationEvent((StationEvent)cmd.event, cmd.reason);
+                continue;
+            }
+            
             LOG_DEBUG(TAG_TASK, "Processing WiFi command: %d", cmd.type);
             
             switch (cmd.type) {
@@ -75,13 +125,14 @@ static void wifiCommandTask(void* parameter) {
                         
                         if (strlen(cmd.param1) > 0 && strlen(cmd.param2) > 0) {
                             // Use provided credentials
-                            connectToNetwork(String(cmd.param1), String(cmd.param2));
+                            startStationConnection(String(cmd.param1), String(cmd.param2), STA_SEC_AUTO);
                             LOG_DEBUG(TAG_TASK, "Connecting to: %s", cmd.param1);
                         } else {
                             // Try to load saved config
                             StationConfig config;
                             if (loadStationConfig(config)) {
-                                connectToNetwork(String(config.ssid), String(config.password));
+                                startStationConnection(String(config.ssid), String(config.password),
+                                                       config.securityPreference);
                                 LOG_DEBUG(TAG_TASK, "Connecting to saved network: %s", config.ssid);
                             } else {
                                 LOG_ERROR(TAG_TASK, "No saved Station config available");
@@ -104,6 +155,17 @@ static void wifiCommandTask(void* parameter) {
                     setIdleMode();
                     break;
                     
+                case WIFI_CMD_CONNECT:
+                    LOG_DEBUG(TAG_TASK, "Connecting to: %s", cmd.param1);
+                    startStationConnection(String(cmd.param1), String(cmd.param2),
+                                           (StationSecurityPreference)cmd.securityPreference);
+                    break;
+                    
+                case WIFI_CMD_DISCONNECT:
+                    LOG_DEBUG(TAG_TASK, "Disconnecting");
+                    stopStationConnection();
+                    break;
+                    
                 default:
                     LOG_ERROR(TAG_TASK, "Unknown command type: %d", cmd.type);
                     break;
@@ -144,6 +206,9 @@ bool initWiFiTask() {
         return false;
     }
     
+    // Station connections are driven by driver events from here on
+    WiFi.onEvent(onWiFiEvent);
+    
     LOG_INFO(TAG_TASK, "WiFi Command Task initialized on Core 1");
     return true;
 }
@@ -232,3 +297,51 @@ bool requestIdleMode() {
     // Send to queue (don't block if full)
     return xQueueSend(wifiCommandQueue, &cmd, 0) == pdTRUE;
 }
+
+bool requestConnect(const char* ssid, const char* password, uint8_t securityPreference) {
+    if (wifiCommandQueue == nullptr) return false;
+    
+    WiFiCommand cmd;
+    cmd.type = WIFI_CMD_CONNECT;
+    cmd.securityPreference = securityPreference;
+    
+    // Copy strings safely
+    strncpy(cmd.param1, ssid, sizeof(cmd.param1) - 1);
+    cmd.param1[sizeof(cmd.param1) - 1] = '\0';
+    
+    strncpy(cmd.param2, password, sizeof(cmd.param2) - 1);
+    cmd.param2[sizeof(cmd.param2) - 1] = '\0';
+    
+    // Send to queue (don't block if full)
+    return xQueueSend(wifiCommandQueue, &cmd, 0) == pdTRUE;
+}
+
+bool requestDisconnect() {
+    if (wifiCommandQueue == nullptr) return false;
+    
+    WiFiCommand cmd;
+    cmd.type = WIFI_CMD_DISCONNECT;
+    cmd.param1[0] = '\0';
+    cmd.param2[0] = '\0';
+    
+    // Send to queue (don't block if full)
+    return xQueueSend(wifiCommandQueue, &cmd, 0) == pdTRUE;
+}
+
+bool requestStationEvent(uint8_t event, uint8_t reason) {
+    if (wifiCommandQueue == nullptr) return false;
+    
+    WiFiCommand cmd;
+    cmd.type = WIFI_CMD_STA_EVENT;
+    cmd.param1[0] = '\0';
+    cmd.param2[0] = '\0';
+    cmd.event = event;
+    cmd.reason = reason;
+    
+    // Send to queue (don't block if full)
+    return xQueueSend(wifiCommandQueue, &cmd, 0) == pdTRUE;
+}
+
+bool isWiFiTaskContext() {
+    return wifiTaskHandle != nullptr && xTaskGetCurrentTaskHandle() == wifiTaskHandle;
+}
@@ -8,6 +8,12 @@
  * 
  * The task provides asynchronous WiFi control, preventing blocking operations
  * in the main application thread and ensuring clean mode transitions.
+ *
+ * The task also owns station connections: WiFi driver events (start,
+ * connected, got IP, disconnected with its reason code) are forwarded into
+ * the same queue and drive the connection state machine in wifi_manager.cpp,
+ * and the queue wait doubles as the timer for connect timeouts and retry
+ * backoff. Nothing polls the connection from the main loop.
  * 
  * @author Arunkumar Mourougappane
  * @version 5.0.0
@@ -32,7 +38,10 @@ enum WiFiCommandType {
     WIFI_CMD_SWITCH_TO_AP,      ///< Switch to Access Point mode
     WIFI_CMD_SWITCH_TO_STATION, ///< Switch to Station mode
     WIFI_CMD_STOP,              ///< Stop WiFi
-    WIFI_CMD_IDLE               ///< Set to idle mode
+    WIFI_CMD_IDLE,              ///< Set to idle mode
+    WIFI_CMD_CONNECT,           ///< Connect in the current mode (param1/param2, securityPreference)
+    WIFI_CMD_DISCONNECT,        ///< Leave the network and stop retrying
+    WIFI_CMD_STA_EVENT          ///< WiFi driver event for the station state machine (event, reason)
 };
 
 // ==========================================
@@ -46,6 +55,9 @@ struct WiFiCommand {
     WiFiCommandType type;    ///< Command type
     char param1[64];         ///< For SSID or other parameters
     char param2[64];         ///< For password or other parameters
+    uint8_t securityPreference; ///< StationSecurityPreference for WIFI_CMD_CONNECT
+    uint8_t event;           ///< StationEvent for WIFI_CMD_STA_EVENT
+    uint8_t reason;          ///< Disconnect reason code for WIFI_CMD_STA_EVENT
 };
 
 // ==========================================
@@ -55,7 +67,8 @@ struct WiFiCommand {
 /**
  * @brief Initialize WiFi command task and queue
  * @return true if initialization successful
- * @details Creates FreeRTOS task and command queue for WiFi operations
+ * @details Creates FreeRTOS task and command queue for WiFi operations and
+ *          registers the WiFi event handler that feeds the station state machine
  */
 bool initWiFiTask();
 
@@ -100,3 +113,32 @@ bool requestStopWiFi();
  * @return true if command was queued successfully
  */
 bool requestIdleMode();
+
+/**
+ * @brief Send command to connect to a network without changing mode
+ * @param ssid Network SSID to connect to
+ * @param password Network password
+ * @param securityPreference StationSecurityPreference value
+ * @return true if command was queued successfully
+ */
+bool requestConnect(const char* ssid, const char* password, uint8_t securityPreference);
+
+/**
+ * @brief Send command to leave the network and cancel pending retries
+ * @return true if command was queued successfully
+ */
+bool requestDisconnect();
+
+/**
+ * @brief Queue an input for the station state machine
+ * @param event StationEvent value
+ * @param reason Disconnect reason code or event-specific value
+ * @return true if the event was queued successfully
+ * @details Safe from the WiFi event task and scan callbacks
+ */
+bool requestStationEvent(uint8_t event, uint8_t reason);
+
+/**
+ * @brief Whether the caller is the WiFi command task
+ */
+bool isWiFiTaskContext();
@@ -0,0 +1,355 @@
+// Host build of the airtime aggregation (lib/NetworkAnalyzer/airtime_monitor.cpp).
+//
+// Replays recorded frame metadata through the same SPSC ring and aggregation
+// the ESP32 survey uses: one thread plays the Wi-Fi receive callback and
+// pushes frames, another drains the ring and aggregates.
+//
+// Recording format, one record per line ('#' starts a comment):
+//   D <channel> <dwell_us>                                  time spent listening
+//   F <timestamp_us> <channel> <type> <length> <rate> <flags> <rssi>
+// type is 0 mgmt, 1 ctrl, 2 data, 3 misc; rate is the legacy PHY rate code,
+// or the MCS index when flags has 0x01 (HT); flags 0x02 = 40MHz, 0x04 = short
+// GI, 0x08 = bad FCS.
+//
+// Usage:
+//   airtime_test replay <file|->    aggregate a recording
+//   airtime_test synth [dwell_ms]   print a synthetic recording
+//   airtime_test duration <rate> <flags> <length>
+//   airtime_test check              verify durations, ring and aggregation
+//
+// Replay prints a table, then machine-readable lines:
+//   CHANNEL <ch> <util_pct> <frames> <bytes> <busy_us> <dwell_us> <errors>
+//   TYPE <ch> <type> <frames> <bytes> <airtime_us>
+//   TOTAL <frames> <ring_full>
+// ring_full counts pushes that found the ring full; replay waits and retries
+// where the firmware would drop the frame.
+//
+// Check prints every mismatch as a FAIL line and exits non-zero if there was one.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "airtime_monitor.h"
+
+struct Dwell {
+    uint8_t channel;
+    uint32_t dwell_us;
+};
+
+struct Capture {
+    std::vector<AirtimeFrame> frames;
+    std::vector<Dwell> dwells;
+};
+
+static AirtimeRing ring;
+static AirtimeStats stats;
+static std::atomic<bool> producerDone(false);
+
+static void consume() {
+    AirtimeFrame frame;
+    for (;;) {
+        bool done = producerDone.load(std::memory_order_acquire);
+        bool any = false;
+        while (airtimeRingPop(ring, frame)) {
+            airtimeStatsAdd(stats, frame);
+            any = true;
+        }
+        if (done && !any) break;
+        if (!any) std::this_thread::yield();
+    }
+}
+
+// Push the capture through the ring to a consumer thread. Lossless waits for
+// room like replay; otherwise a full ring drops the frame like the firmware.
+static void aggregate(const Capture& capture, bool lossless) {
+    airtimeStatsClear(stats);
+    airtimeRingClear(ring);
+    for (const Dwell& dwell : capture.dwells) airtimeStatsAddDwell(stats, dwell.channel, dwell.dwell_us);
+
+    producerDone.store(false, std::memory_order_relaxed);
+    std::thread consumer(consume);
+    for (const AirtimeFrame& frame : capture.frames) {
+        while (!airtimeRingPush(ring, frame) && lossless) std::this_thread::yield();
+    }
+    producerDone.store(true, std::memory_order_release);
+    consumer.join();
+}
+
+static void parseCapture(FILE* input, Capture& capture) {
+    char line[256];
+    while (fgets(line, sizeof(line), input)) {
+        if (line[0] == 'D') {
+            unsigned channel, dwell;
+            if (sscanf(line + 1, "%u %u", &channel, &dwell) == 2) {
+                capture.dwells.push_back({(uint8_t)channel, dwell});
+            }
+        } else if (line[0] == 'F') {
+            unsigned long timestamp;
+            unsigned channel, type, length, rate, flags;
+            int rssi;
+            if (sscanf(line + 1, "%lu %u %u %u %u %u %d", &timestamp, &channel, &type, &length, &rate, &flags,
+                       &rssi) == 7) {
+                AirtimeFrame frame = {(uint32_t)timestamp, (uint16_t)length, (uint8_t)channel, (uint8_t)type,
+                                      (uint8_t)rate, (uint8_t)flags, (int8_t)rssi, 0};
+                capture.frames.push_back(frame);
+            }
+        }
+    }
+}
+
+static uint32_t channelBytes(uint8_t ch) {
+    uint32_t bytes = 0;
+    for (const AirtimeTypeStats& type : stats.channels[ch].types) bytes += type.bytes;
+    return bytes;
+}
+
+static int replay(FILE* input) {
+    Capture capture;
+    parseCapture(input, capture);
+    aggregate(capture, true);
+
+    printf("  CH  Util%%   Frames     Bytes    Busy ms  Dwell ms  Errors\n");
+    uint32_t total = 0;
+    for (uint8_t ch = 1; ch <= AIRTIME_MAX_CHANNEL; ch++) {
+        const AirtimeChannelStats& channel = stats.channels[ch];
+        uint32_t frameCount = airtimeChannelFrames(stats, ch);
+        if (channel.dwell_us == 0 && frameCount == 0) continue;
+        uint32_t bytes = channelBytes(ch);
+        uint32_t busy = airtimeChannelBusyUs(stats, ch);
+        float utilization = airtimeUtilization(stats, ch);
+        printf("  %2u %6.2f %8u %9u %10.1f %9.1f %7u\n", ch, utilization, frameCount, bytes, busy / 1000.0,
+               channel.dwell_us / 1000.0, channel.error_frames);
+        printf("CHANNEL %u %.2f %u %u %u %u %u\n", ch, utilization, frameCount, bytes, busy, channel.dwell_us,
+               channel.error_frames);
+        for (uint8_t t = 0; t < AIRTIME_FRAME_TYPES; t++) {
+            const AirtimeTypeStats& type = channel.types[t];
+            if (type.frames == 0) continue;
+            printf("TYPE %u %s %u %u %u\n", ch, airtimeFrameTypeName(t), type.frames, type.bytes, type.airtime_us);
+        }
+        total += frameCount;
+    }
+    printf("TOTAL %u %u\n", total, ring.dropped.load());  // Retried, not lost
+    return 0;
+}
+
+// Deterministic capture: beacons on 1/6/11, a busy data flow on 6, a lossy channel 11
+static void synthCapture(uint32_t dwellMs, Capture& capture) {
+    const uint32_t dwell_us = dwellMs * 1000;
+    uint32_t now = 0;
+    for (unsigned ch = 1; ch <= 13; ch++) {
+        uint32_t start = now;
+        unsigned aps = (ch == 1 || ch == 6 || ch == 11) ? 3 : 0;
+        // Beacons: 250 bytes at 1 Mbps every 102.4 ms per AP
+        for (unsigned ap = 0; ap < aps; ap++) {
+            for (uint32_t t = ap * 7000; t < dwell_us; t += 102400) {
+                capture.frames.push_back({start + t, 250, (uint8_t)ch, AIRTIME_FRAME_MGMT, 0x00, 0,
+                                          (int8_t)(-50 - (int)ap * 10), 0});
+            }
+        }
+        if (ch == 6) {
+            // 1500-byte MCS7 data every 2 ms, each acknowledged at 24 Mbps
+            for (uint32_t t = 500; t < dwell_us; t += 2000) {
+                capture.frames.push_back({start + t, 1500, 6, AIRTIME_FRAME_DATA, 7, AIRTIME_FLAG_HT, -55, 0});
+                capture.frames.push_back({start + t + 200, 14, 6, AIRTIME_FRAME_CTRL, 0x09, 0, -55, 0});
+            }
+        }
+        if (ch == 11) {
+            // Half of the 54 Mbps data frames fail their FCS
+            for (uint32_t t = 1000; t < dwell_us; t += 5000) {
+                uint8_t flags = (t / 5000) % 2 ? AIRTIME_FLAG_ERROR : 0;
+                capture.frames.push_back({start + t, 1000, 11, AIRTIME_FRAME_DATA, 0x0C, flags, -70, 0});
+            }
+        }
+        capture.dwells.push_back({(uint8_t)ch, dwell_us});
+        now += dwell_us;
+    }
+}
+
+static void synth(uint32_t dwellMs) {
+    Capture capture;
+    synthCapture(dwellMs, capture);
+    printf("# synthetic capture, %u ms per channel\n", dwellMs);
+    size_t next = 0;
+    for (const Dwell& dwell : capture.dwells) {
+        for (; next < capture.frames.size() && capture.frames[next].channel == dwell.channel; next++) {
+            const AirtimeFrame& f = capture.frames[next];
+            printf("F %u %u %u %u %u %u %d\n", f.timestamp_us, f.channel, f.type, f.length, f.rate, f.flags, f.rssi);
+        }
+        printf("D %u %u\n", dwell.channel, dwell.dwell_us);
+    }
+}
+
+// ==========================================
+// CHECKS
+// ==========================================
+
+static int failures = 0;
+
+#define EXPECT_EQ(actual, expected, what)                                                                  \
+    do {                                                                                                   \
+        long long a_ = (long long)(actual), e_ = (long long)(expected);                                    \
+        if (a_ != e_) {                                                                                    \
+            printf("FAIL %s: got %lld, expected %lld\n", what, a_, e_);                                    \
+            failures++;                                                                                    \
+        }                                                                                                  \
+    } while (0)
+
+// Durations worked out by hand from the 802.11 timing rules
+static void checkDurations() {
+    struct Case {
+        uint8_t rate, flags;
+        uint16_t length;
+        uint32_t expected_us;
+        const char* what;
+    };
+    const Case cases[] = {
+        {0x00, 0, 250, 192 + 2000, "DSSS 1M long 250B"},                        // 2000 bits at 1 Mbps
+        {0x07, 0, 14, 96 + 11, "CCK 11M short 14B"},                             // ceil(112 / 11)
+        {0x0C, 0, 1000, 20 + 38 * 4 + 6, "OFDM 54M 1000B"},                      // ceil(8022 / 216) symbols
+        {0x09, 0, 14, 20 + 2 * 4 + 6, "OFDM 24M 14B"},                           // ceil(134 / 96)
+        {0x0B, 0, 1500, 20 + 501 * 4 + 6, "OFDM 6M 1500B"},                      // ceil(12022 / 24)
+        {0, AIRTIME_FLAG_HT, 100, 36 + 32 * 4 + 6, "HT MCS0 100B"},              // ceil(822 / 26)
+        {7, AIRTIME_FLAG_HT, 1500, 36 + 47 * 4 + 6, "HT MCS7 1500B"},            // ceil(12022 / 260)
+        {7, AIRTIME_FLAG_HT | AIRTIME_FLAG_SGI, 1500, 36 + 170 + 6, "HT MCS7 SGI 1500B"},  // 47 * 3.6 rounded up
+        {15, AIRTIME_FLAG_HT | AIRTIME_FLAG_40MHZ, 1500, 40 + 12 * 4 + 6, "HT MCS15 40MHz 1500B"},  // 2 streams
+    };
+    for (const Case& c : cases) {
+        AirtimeFrame frame = {0, c.length, 1, AIRTIME_FRAME_DATA, c.rate, c.flags, 0, 0};
+        EXPECT_EQ(airtimeFrameDurationUs(frame), c.expected_us, c.what);
+    }
+}
+
+// A ring with no consumer holds exactly AIRTIME_RING_SIZE frames, drops the
+// rest and hands the kept ones back in order
+static void checkRingDrops() {
+    airtimeRingClear(ring);
+    const uint32_t extra = 10;
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < AIRTIME_RING_SIZE + extra; i++) {
+        AirtimeFrame frame = {i, 100, 1, AIRTIME_FRAME_DATA, 0, 0, 0, 0};
+        if (airtimeRingPush(ring, frame)) accepted++;
+    }
+    EXPECT_EQ(accepted, AIRTIME_RING_SIZE, "ring accepted");
+    EXPECT_EQ(ring.dropped.load(), extra, "ring dropped");
+
+    AirtimeFrame frame;
+    uint32_t popped = 0;
+    while (airtimeRingPop(ring, frame)) {
+        if (frame.timestamp_us != popped) {
+            EXPECT_EQ(frame.timestamp_us, popped, "ring order");
+            break;
+        }
+        popped++;
+    }
+    EXPECT_EQ(popped, AIRTIME_RING_SIZE, "ring popped");
+}
+
+// The synthetic capture at 1000 ms per channel, counted by hand:
+//   beacons: 10 per AP, 3 APs on 1/6/11, 2192 us each
+//   ch 6: 500 MCS7 data frames of 230 us and 500 24M ACKs of 34 us
+//   ch 11: 200 54M data frames of 178 us, the 100 odd ones with a bad FCS
+static void checkAggregation() {
+    struct Expected {
+        uint8_t channel;
+        uint32_t frames, bytes, busy_us, errors;
+        float utilization;
+    };
+    const Expected expected[] = {
+        {1, 30, 7500, 65760, 0, 6.576f},
+        {6, 1030, 7500 + 750000 + 7000, 65760 + 115000 + 17000, 0, 19.776f},
+        {11, 230, 7500 + 200000, 65760 + 35600, 100, 10.136f},
+    };
+    Capture capture;
+    synthCapture(1000, capture);
+    aggregate(capture, true);
+
+    char what[64];
+    for (const Expected& e : expected) {
+        snprintf(what, sizeof(what), "ch %u frames", e.channel);
+        EXPECT_EQ(airtimeChannelFrames(stats, e.channel), e.frames, what);
+        snprintf(what, sizeof(what), "ch %u bytes", e.channel);
+        EXPECT_EQ(channelBytes(e.channel), e.bytes, what);
+        snprintf(what, sizeof(what), "ch %u busy_us", e.channel);
+        EXPECT_EQ(airtimeChannelBusyUs(stats, e.channel), e.busy_us, what);
+        snprintf(what, sizeof(what), "ch %u errors", e.channel);
+        EXPECT_EQ(stats.channels[e.channel].error_frames, e.errors, what);
+        float utilization = airtimeUtilization(stats, e.channel);
+        if (std::fabs(utilization - e.utilization) > 0.01f) {
+            printf("FAIL ch %u utilization: got %.3f, expected %.3f\n", e.channel, utilization, e.utilization);
+            failures++;
+        }
+    }
+    EXPECT_EQ(stats.channels[6].types[AIRTIME_FRAME_DATA].airtime_us, 115000, "ch 6 data airtime");
+    EXPECT_EQ(stats.channels[6].types[AIRTIME_FRAME_CTRL].frames, 500, "ch 6 ctrl frames");
+    EXPECT_EQ(stats.channels[1].max_rssi, -50, "ch 1 max rssi");
+    for (uint8_t ch : {2, 3, 4, 5, 7, 8, 9, 10, 12, 13}) {
+        snprintf(what, sizeof(what), "ch %u idle", ch);
+        EXPECT_EQ(airtimeChannelFrames(stats, ch), 0, what);
+        EXPECT_EQ(airtimeChannelBusyUs(stats, ch), 0, what);
+    }
+    EXPECT_EQ(airtimeUtilization(stats, 14), -1, "ch 14 never listened");
+}
+
+// Firmware behaviour under pressure: every frame is either aggregated or
+// counted as dropped, never lost silently or counted twice
+static void checkLossyAccounting() {
+    Capture capture;
+    synthCapture(1000, capture);
+    aggregate(capture, false);
+    uint32_t aggregated = 0;
+    for (uint8_t ch = 1; ch <= AIRTIME_MAX_CHANNEL; ch++) aggregated += airtimeChannelFrames(stats, ch);
+    EXPECT_EQ(aggregated + ring.dropped.load(), capture.frames.size(), "aggregated + dropped");
+    printf("lossy replay: %u aggregated, %u dropped\n", aggregated, ring.dropped.load());
+}
+
+static int check() {
+    checkDurations();
+    checkRingDrops();
+    checkAggregation();
+    checkLossyAccounting();
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK airtime checks\n");
+    return 0;
+}
+
+void printUsage(const char* progName) {
+    fprintf(stderr, "Usage: %s replay <file|->\n", progName);
+    fprintf(stderr, "       %s synth [dwell_ms]\n", progName);
+    fprintf(stderr, "       %s duration <rate> <flags> <length>\n", progName);
+    fprintf(stderr, "       %s check\n", progName);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 3 && strcmp(argv[1], "replay") == 0) {
+        FILE* input = strcmp(argv[2], "-") == 0 ? stdin : fopen(argv[2], "r");
+        if (input == nullptr) {
+            perror(argv[2]);
+            return 1;
+        }
+        int result = replay(input);
+        if (input != stdin) fclose(input);
+        return result;
+    }
+    if (argc >= 2 && strcmp(argv[1], "synth") == 0) {
+        synth(argc > 2 ? (uint32_t)atoi(argv[2]) : 1000);
+        return 0;
+    }
+    if (argc >= 5 && strcmp(argv[1], "duration") == 0) {
+        AirtimeFrame frame = {0, (uint16_t)atoi(argv[4]), 1, AIRTIME_FRAME_DATA, (uint8_t)strtoul(argv[2], nullptr, 0),
+                              (uint8_t)strtoul(argv[3], nullptr, 0), 0, 0};
+        printf("DURATION %u\n", airtimeFrameDurationUs(frame));
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return check();
+    }
+    printUsage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,270 @@
+// Host build of the channel history (lib/NetworkAnalyzer/channel_history.cpp).
+//
+// Feeds analysis passes through the same ring and EWMA code the ESP32 uses.
+//
+// Recording format, one pass per line ('#' starts a comment):
+//   <time_s> <score_ch1> ... <score_ch13>
+// A score of '-' means the channel was not scanned in that pass.
+//
+// Usage:
+//   channel_history_test replay <file|->   feed a recording
+//   channel_history_test synth             print a synthetic recording
+//   channel_history_test check             verify timestamps, trends and peaks
+//
+// Replay prints machine-readable lines:
+//   PASSES <count> <oldest_s> <newest_s>
+//   TREND <ch> <short_ewma> <long_ewma> <rising|falling|steady>
+//   PEAK <ch> <score> <time_s>
+//
+// Check prints every mismatch as a FAIL line and exits non-zero if there was one.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "channel_history.h"
+
+static ChannelHistory history;
+
+static int replay(FILE* input) {
+    char line[256];
+    channelHistoryClear(history);
+    while (fgets(line, sizeof(line), input)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        char* cursor = line;
+        char* end;
+        unsigned long time_s = strtoul(cursor, &end, 10);
+        if (end == cursor) continue;
+        cursor = end;
+
+        ChannelSample samples[CHANNEL_HISTORY_CHANNELS] = {};
+        uint16_t mask = 0;
+        for (uint8_t i = 0; i < CHANNEL_HISTORY_CHANNELS; i++) {
+            while (*cursor == ' ' || *cursor == '\t') cursor++;
+            if (*cursor == '-') {
+                cursor++;
+                continue;
+            }
+            long score = strtol(cursor, &end, 10);
+            if (end == cursor) break;
+            cursor = end;
+            samples[i].score = (uint8_t)score;
+            mask |= 1u << (i + 1);
+        }
+        channelHistoryAdd(history, (uint32_t)time_s, samples, mask);
+    }
+
+    uint8_t count = channelHistoryCount(history);
+    printf("PASSES %u %u %u\n", count, count ? channelHistoryTime(history, 0) : 0, history.newest_s);
+    for (uint8_t ch = 1; ch <= CHANNEL_HISTORY_CHANNELS; ch++) {
+        const ChannelTrend& trend = channelHistoryTrend(history, ch);
+        if (trend.updated_s == 0) continue;
+        printf("TREND %u %.1f %.1f %s\n", ch, trend.short_ewma, trend.long_ewma,
+               channelTrendName(channelTrendDirection(trend)));
+        ChannelSample peak;
+        uint32_t time_s;
+        if (channelHistoryPeak(history, ch, peak, time_s)) {
+            printf("PEAK %u %u %u\n", ch, peak.score, time_s);
+        }
+    }
+    return 0;
+}
+
+// Two hours at 30 s intervals: quiet channels, a neighbour streaming on 6
+// from minute 60 to 90, and channel 11 only scanned every other pass
+static void synth() {
+    printf("# synthetic monitoring, 30 s passes\n");
+    for (unsigned t = 30; t <= 7200; t += 30) {
+        printf("%u", t);
+        for (unsigned ch = 1; ch <= 13; ch++) {
+            if (ch == 11 && (t / 30) % 2) {
+                printf(" -");
+            } else if (ch == 6) {
+                printf(" %u", t > 3600 && t <= 5400 ? 85 : 20);
+            } else {
+                printf(" %u", 10 + ch);
+            }
+        }
+        printf("\n");
+    }
+}
+
+// ==========================================
+// CHECKS
+// ==========================================
+
+static int failures = 0;
+
+#define EXPECT_EQ(actual, expected, what)                                                                  \
+    do {                                                                                                   \
+        long long a_ = (long long)(actual), e_ = (long long)(expected);                                    \
+        if (a_ != e_) {                                                                                    \
+            printf("FAIL %s: got %lld, expected %lld\n", what, a_, e_);                                    \
+            failures++;                                                                                    \
+        }                                                                                                  \
+    } while (0)
+
+#define EXPECT_NEAR(actual, expected, tolerance, what)                                                     \
+    do {                                                                                                   \
+        double a_ = (actual), e_ = (expected);                                                             \
+        if (std::fabs(a_ - e_) > (tolerance)) {                                                            \
+            printf("FAIL %s: got %.4f, expected %.4f\n", what, a_, e_);                                    \
+            failures++;                                                                                    \
+        }                                                                                                  \
+    } while (0)
+
+static const uint16_t ALL_CHANNELS = 0x3FFE;
+
+static void addPass(uint32_t time_s, uint8_t score, uint16_t mask = ALL_CHANNELS) {
+    ChannelSample samples[CHANNEL_HISTORY_CHANNELS] = {};
+    for (ChannelSample& sample : samples) sample.score = score;
+    channelHistoryAdd(history, time_s, samples, mask);
+}
+
+// Irregular intervals across several ring wraps: every retained pass must
+// decode to the time it was added at
+static void checkTimestamps() {
+    channelHistoryClear(history);
+    const unsigned total = CHANNEL_HISTORY_PASSES * 3 + 7;
+    uint32_t times[total];
+    uint32_t t = 1000;
+    for (unsigned k = 0; k < total; k++) {
+        t += 37 + (k % 5) * 11 + (k % 13 == 0 ? 4000 : 0);
+        times[k] = t;
+        addPass(t, 10);
+    }
+    EXPECT_EQ(channelHistoryCount(history), CHANNEL_HISTORY_PASSES, "passes held");
+    char what[64];
+    for (uint8_t i = 0; i < CHANNEL_HISTORY_PASSES; i++) {
+        snprintf(what, sizeof(what), "time of pass %u", i);
+        EXPECT_EQ(channelHistoryTime(history, i), times[total - CHANNEL_HISTORY_PASSES + i], what);
+    }
+}
+
+// Longest representable gap keeps the chain; a longer one starts a new one
+static void checkLongGap() {
+    channelHistoryClear(history);
+    addPass(100, 10);
+    addPass(200, 10);
+    addPass(200 + UINT16_MAX, 10);
+    EXPECT_EQ(channelHistoryCount(history), 3, "passes after a 65535 s gap");
+    EXPECT_EQ(channelHistoryTime(history, 0), 100, "oldest time after a 65535 s gap");
+
+    uint32_t late = 200 + UINT16_MAX + UINT16_MAX + 1;
+    addPass(late, 10);
+    EXPECT_EQ(channelHistoryCount(history), 1, "passes after a 65536 s gap");
+    EXPECT_EQ(channelHistoryTime(history, 0), late, "time after a 65536 s gap");
+    addPass(late + 30, 10);
+    addPass(late + 90, 10);
+    EXPECT_EQ(channelHistoryTime(history, 0), late, "oldest time of the new chain");
+    EXPECT_EQ(channelHistoryTime(history, 1), late + 30, "middle time of the new chain");
+    EXPECT_EQ(channelHistoryTrend(history, 1).updated_s, late + 90, "trend carries on");
+}
+
+// EWMA steps match the closed form, split intervals match one long interval,
+// and a score step shows as rising before both averages settle on it
+static void checkTrends() {
+    channelHistoryClear(history);
+    addPass(100, 20);
+    addPass(220, 80);
+    const ChannelTrend& trend = channelHistoryTrend(history, 1);
+    EXPECT_NEAR(trend.short_ewma, 20 + 60 * (1 - std::exp(-120.0 / CHANNEL_TREND_SHORT_TAU_S)), 1e-3,
+                "short EWMA after one step");
+    EXPECT_NEAR(trend.long_ewma, 20 + 60 * (1 - std::exp(-120.0 / CHANNEL_TREND_LONG_TAU_S)), 1e-3,
+                "long EWMA after one step");
+    EXPECT_EQ(channelTrendDirection(trend), 1, "step up is rising");
+
+    // Same target reached through two 60 s passes: the weights follow real time
+    float shortAfterOne = trend.short_ewma, longAfterOne = trend.long_ewma;
+    channelHistoryClear(history);
+    addPass(100, 20);
+    addPass(160, 80);
+    addPass(220, 80);
+    EXPECT_NEAR(channelHistoryTrend(history, 1).short_ewma, shortAfterOne, 1e-3, "short EWMA split interval");
+    EXPECT_NEAR(channelHistoryTrend(history, 1).long_ewma, longAfterOne, 1e-3, "long EWMA split interval");
+
+    // Hold the new level for four hours of 30 s passes
+    for (uint32_t t = 250; t <= 220 + 4 * 3600; t += 30) addPass(t, 80);
+    EXPECT_NEAR(channelHistoryTrend(history, 1).short_ewma, 80, 0.01, "short EWMA converged");
+    EXPECT_NEAR(channelHistoryTrend(history, 1).long_ewma, 80, 0.05, "long EWMA converged");  // 60 * e^-8
+    EXPECT_EQ(channelTrendDirection(channelHistoryTrend(history, 1)), 0, "settled is steady");
+
+    // Drop back: the short average leads the long one down
+    for (uint32_t t = 220 + 4 * 3600 + 30; t <= 220 + 4 * 3600 + 300; t += 30) addPass(t, 20);
+    EXPECT_EQ(channelTrendDirection(channelHistoryTrend(history, 1)), -1, "step down is falling");
+
+    // Channels left out of a pass keep their trend
+    uint32_t updated = channelHistoryTrend(history, 1).updated_s;
+    addPass(updated + 30, 90, ALL_CHANNELS & ~(1u << 1));
+    EXPECT_EQ(channelHistoryTrend(history, 1).updated_s, updated, "unscanned channel trend untouched");
+}
+
+// Peaks only come from retained, scanned passes; ties report the newest
+static void checkPeaks() {
+    channelHistoryClear(history);
+    ChannelSample samples[CHANNEL_HISTORY_CHANNELS] = {};
+    uint32_t t = 0;
+    // Highest score of all, evicted by the end
+    samples[2].score = 99;
+    channelHistoryAdd(history, t += 30, samples, ALL_CHANNELS);
+    for (unsigned k = 1; k < CHANNEL_HISTORY_PASSES + 10; k++) {
+        samples[2].score = (uint8_t)(k % 7 == 3 ? 60 : 10 + k % 5);
+        t += 30;
+        // An unscanned pass carries a bogus high score that must be ignored
+        uint16_t mask = k == CHANNEL_HISTORY_PASSES ? (uint16_t)(ALL_CHANNELS & ~(1u << 3)) : ALL_CHANNELS;
+        if (k == CHANNEL_HISTORY_PASSES) samples[2].score = 95;
+        channelHistoryAdd(history, t, samples, mask);
+    }
+    ChannelSample peak;
+    uint32_t peakTime = 0;
+    EXPECT_EQ(channelHistoryPeak(history, 3, peak, peakTime), true, "channel 3 has a peak");
+    EXPECT_EQ(peak.score, 60, "retained peak score");
+    // Passes k = 10-73 are retained; the newest with k % 7 == 3 is 73, added at 30 * (k + 1)
+    EXPECT_EQ(peakTime, 30 * (73 + 1), "newest of the tied peaks");
+
+    channelHistoryClear(history);
+    EXPECT_EQ(channelHistoryPeak(history, 3, peak, peakTime), false, "no peak in an empty history");
+    EXPECT_EQ(channelHistoryPeak(history, 14, peak, peakTime), false, "no peak outside 1-13");
+}
+
+static int check() {
+    checkTimestamps();
+    checkLongGap();
+    checkTrends();
+    checkPeaks();
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK channel history checks\n");
+    return 0;
+}
+
+void printUsage(const char* progName) {
+    fprintf(stderr, "Usage: %s replay <file|->\n", progName);
+    fprintf(stderr, "       %s synth\n", progName);
+    fprintf(stderr, "       %s check\n", progName);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 3 && strcmp(argv[1], "replay") == 0) {
+        FILE* input = strcmp(argv[2], "-") == 0 ? stdin : fopen(argv[2], "r");
+        if (input == nullptr) {
+            perror(argv[2]);
+            return 1;
+        }
+        int result = replay(input);
+        if (input != stdin) fclose(input);
+        return result;
+    }
+    if (argc >= 2 && strcmp(argv[1], "synth") == 0) {
+        synth();
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return check();
+    }
+    printUsage(argv[0]);
+    return 1;
+}
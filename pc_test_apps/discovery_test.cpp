@@ -0,0 +1,156 @@
+// Host build of the firmware host discovery engine (lib/NetworkTools/host_discovery.cpp).
+//
+// Sweeps an address range with the same ARP / ICMP / TCP ping windows the
+// ESP32 runs, e.g. inside the namespaces set up by
+// scripts/discovery_netns_test.sh. Needs root (packet and raw sockets).
+//
+// Methods are a comma list of arp, icmp, tcp (default: all). Options:
+//   scan=<ranges>  port scan every live host, e.g. scan=1-1024
+//
+// Prints the host table, then machine-readable lines:
+//   HOST <ip> <mac|-> <method> <rtt_us> <open ports|-> <vendor>   (vendor may contain spaces)
+//   SWEEP <swept> <hosts> <elapsed_ms>
+//   PORTSCAN <hosts_scanned> <elapsed_ms>
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <arpa/inet.h>
+
+#include "host_discovery.h"
+
+static volatile bool cancelRequested = false;
+
+static void handleSignal(int) {
+    cancelRequested = true;
+}
+
+static bool parseMethods(const char* text, uint8_t& methods) {
+    methods = 0;
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%s", text);
+    for (char* token = strtok(buffer, ","); token; token = strtok(nullptr, ",")) {
+        if (strcmp(token, "arp") == 0) methods |= HOSTDISC_METHOD_ARP;
+        else if (strcmp(token, "icmp") == 0) methods |= HOSTDISC_METHOD_ICMP;
+        else if (strcmp(token, "tcp") == 0) methods |= HOSTDISC_METHOD_TCP;
+        else return false;
+    }
+    return methods != 0;
+}
+
+static bool parseRanges(const char* text, PortSet& set) {
+    portSetClear(set);
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", text);
+    for (char* token = strtok(buffer, ","); token; token = strtok(nullptr, ",")) {
+        char* dash = strchr(token, '-');
+        long first = atol(token);
+        long last = dash ? atol(dash + 1) : first;
+        if (first < 1 || last > 65535 || !portSetAddRange(set, (uint16_t)first, (uint16_t)last)) {
+            return false;
+        }
+    }
+    return set.range_count > 0;
+}
+
+static std::string formatPorts(const DiscoveredHost& host) {
+    if (!host.scanned || host.open_count == 0) return "-";
+    std::string ports;
+    uint8_t listed = host.open_count < HOSTDISC_HOST_OPEN_PORTS ? host.open_count : HOSTDISC_HOST_OPEN_PORTS;
+    for (uint8_t i = 0; i < listed; i++) {
+        if (i > 0) ports += ",";
+        ports += std::to_string(host.open_ports[i]);
+    }
+    return ports;
+}
+
+void printUsage(const char* progName) {
+    std::cerr << "Usage: " << progName << " <first_ip> <last_ip> [methods] [timeout_ms] [scan=<ranges>]" << std::endl;
+    std::cerr << "  methods: comma list of arp,icmp,tcp (default: all)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    HostDiscoveryConfig config = getDefaultHostDiscoveryConfig();
+    struct in_addr first, last;
+    if (inet_pton(AF_INET, argv[1], &first) != 1 || inet_pton(AF_INET, argv[2], &last) != 1) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    config.first = first.s_addr;
+    config.last = last.s_addr;
+    if (argc > 3 && !parseMethods(argv[3], config.methods)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (argc > 4) config.timeout_ms = (uint16_t)atoi(argv[4]);
+
+    static PortSet ports;
+    for (int i = 5; i < argc; i++) {
+        if (strncmp(argv[i], "scan=", 5) == 0) {
+            if (!parseRanges(argv[i] + 5, ports)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            config.scan_ports = true;
+        }
+    }
+
+    signal(SIGINT, handleSignal);
+
+    static HostDiscoveryResults results;
+    HostDiscoverySession session;
+    hostDiscoveryResetResults(results, config);
+    if (!hostDiscoveryBegin(session, config)) {
+        std::cerr << "No usable discovery method (root needed for ARP/ICMP)" << std::endl;
+        return 1;
+    }
+    session.cancel = &cancelRequested;
+
+    printf("Sweeping %s - %s: %u addresses, methods %s%s%s (timeout %u ms, %u retries)\n", argv[1], argv[2],
+           results.total, (session.config.methods & HOSTDISC_METHOD_ARP) ? "arp " : "",
+           (session.config.methods & HOSTDISC_METHOD_ICMP) ? "icmp " : "",
+           (session.config.methods & HOSTDISC_METHOD_TCP) ? "tcp" : "", session.config.timeout_ms,
+           session.config.retries);
+    printf("Host table: %zu bytes\n", sizeof(results));
+
+    bool finished = hostDiscoverySweep(session, results);
+    if (finished && config.scan_ports) {
+        finished = hostDiscoveryScanPorts(session, results, ports, CONCURRENT_CONNECTIONS, DEFAULT_SCAN_TIMEOUT);
+    }
+    hostDiscoveryEnd(session);
+
+    for (uint8_t i = 0; i < results.host_count; i++) {
+        const DiscoveredHost& host = results.hosts[i];
+        char address[INET_ADDRSTRLEN];
+        struct in_addr addr;
+        addr.s_addr = host.address;
+        inet_ntop(AF_INET, &addr, address, sizeof(address));
+        char mac[18] = "-";
+        if (host.has_mac) {
+            snprintf(mac, sizeof(mac), "%02x:%02x:%02x:%02x:%02x:%02x", host.mac[0], host.mac[1], host.mac[2],
+                     host.mac[3], host.mac[4], host.mac[5]);
+        }
+        const char* vendor = host.has_mac ? hostVendorForMac(host.mac) : "-";
+        std::string openPorts = formatPorts(host);
+        printf("  %-15s %-17s %-4s %8.3f ms  %-13s %s\n", address, mac, hostDiscoveryMethodToString(host.found_by),
+               host.rtt_us / 1000.0, vendor, openPorts.c_str());
+        printf("HOST %s %s %s %u %s %s\n", address, mac, hostDiscoveryMethodToString(host.found_by),
+               host.rtt_us, openPorts.c_str(), vendor);
+    }
+
+    printf("%s: %u/%u swept, %u hosts in %u ms\n", finished ? "Done" : "Cancelled", results.swept, results.total,
+           results.host_count, results.sweep_ms);
+    printf("SWEEP %u %u %u\n", results.swept, results.host_count, results.sweep_ms);
+    if (config.scan_ports) {
+        printf("PORTSCAN %u %u\n", results.hosts_scanned, results.scan_ms);
+    }
+    return finished ? 0 : 1;
+}
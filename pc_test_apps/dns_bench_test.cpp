@@ -0,0 +1,136 @@
+// Host build of the firmware DNS layer (lib/NetworkTools/dns_resolver.cpp).
+//
+// Without names: resolves each name on the command line through the cache
+// against <resolver>. With "bench": runs the cold/warm resolver benchmark
+// against every listed resolver. scripts/dns_resolver_test.sh drives both
+// against scripts/dns_test_server.py.
+//
+// Machine-readable lines:
+//   RESOLVE <name> <literal|cache|query|fail> <ip|-> <elapsed_us> <ttl_remaining>
+//   CACHE <hits> <misses> <expired> <entries>
+//   BENCH <resolver> <cold|warm> <answered> <sent> <median_ms> <p90_ms>
+//   FASTEST <resolver>
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include "dns_resolver.h"
+
+static std::string addressToString(uint32_t address) {
+    char buffer[INET_ADDRSTRLEN];
+    struct in_addr in;
+    in.s_addr = address;
+    inet_ntop(AF_INET, &in, buffer, sizeof(buffer));
+    return buffer;
+}
+
+static const char* sourceToString(DnsResolveSource source) {
+    switch (source) {
+        case DNS_SOURCE_LITERAL: return "literal";
+        case DNS_SOURCE_CACHE: return "cache";
+        default: return "query";
+    }
+}
+
+static bool parseAddress(const char* text, uint32_t& address) {
+    struct in_addr in;
+    if (inet_pton(AF_INET, text, &in) != 1) return false;
+    address = in.s_addr;
+    return true;
+}
+
+void printUsage(const char* progName) {
+    std::cerr << "Usage: " << progName << " <resolver> <port> <name|sleep:N>..." << std::endl;
+    std::cerr << "       " << progName << " bench <port> <queries> <domain> <resolver>..." << std::endl;
+    std::cerr << "  sleep:N pauses N seconds between lookups (cache expiry)" << std::endl;
+}
+
+static int runResolve(int argc, char* argv[]) {
+    uint32_t resolver;
+    if (!parseAddress(argv[1], resolver)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    dnsSetResolver(resolver, (uint16_t)atoi(argv[2]));
+
+    for (int i = 3; i < argc; i++) {
+        if (strncmp(argv[i], "sleep:", 6) == 0) {
+            sleep((unsigned)atoi(argv[i] + 6));
+            continue;
+        }
+
+        uint32_t address = 0;
+        DnsResolveInfo info;
+        bool resolved = dnsResolve(argv[i], address, &info);
+        printf("%-28s %-8s %-15s %8.2f ms  ttl %lus  (%s)\n", argv[i],
+               resolved ? sourceToString(info.source) : "fail",
+               resolved ? addressToString(address).c_str() : "-", info.elapsed_us / 1000.0,
+               (unsigned long)info.ttl_remaining_s, dnsQueryStatusToString(info.status));
+        printf("RESOLVE %s %s %s %lu %lu\n", argv[i], resolved ? sourceToString(info.source) : "fail",
+               resolved ? addressToString(address).c_str() : "-", (unsigned long)info.elapsed_us,
+               (unsigned long)info.ttl_remaining_s);
+    }
+
+    DnsCacheStats stats = dnsCacheGetStats();
+    printf("CACHE %lu %lu %lu %u\n", (unsigned long)stats.hits, (unsigned long)stats.misses,
+           (unsigned long)stats.expired, stats.entries);
+    return 0;
+}
+
+static void printPhase(const std::string& resolver, const char* phase, const DnsLatencyStats& stats) {
+    printf("  %-15s %-4s %3u/%-3u  min %7.2f  median %7.2f  p90 %7.2f  max %7.2f ms\n",
+           resolver.c_str(), phase, stats.answered, stats.sent, stats.min_ms, stats.median_ms,
+           stats.p90_ms, stats.max_ms);
+}
+
+static int runBenchmark(int argc, char* argv[]) {
+    if (argc < 6) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    DnsBenchConfig config = getDefaultDnsBenchConfig();
+    config.port = (uint16_t)atoi(argv[2]);
+    config.queries = (uint8_t)atoi(argv[3]);
+    config.domains[0] = argv[4];
+    config.domain_count = 1;
+    config.timeout_ms = 1000;
+    for (int i = 5; i < argc && config.resolver_count < DNS_BENCH_MAX_RESOLVERS; i++) {
+        if (!parseAddress(argv[i], config.resolvers[config.resolver_count++])) {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    DnsBenchResults results;
+    dnsRunBenchmark(config, results);
+
+    for (uint8_t i = 0; i < results.resolver_count; i++) {
+        const DnsResolverResult& result = results.resolvers[i];
+        std::string resolver = addressToString(result.resolver);
+        printPhase(resolver, "cold", result.cold);
+        printPhase(resolver, "warm", result.warm);
+        printf("BENCH %s cold %u %u %.3f %.3f\n", resolver.c_str(), result.cold.answered, result.cold.sent,
+               result.cold.median_ms, result.cold.p90_ms);
+        printf("BENCH %s warm %u %u %.3f %.3f\n", resolver.c_str(), result.warm.answered, result.warm.sent,
+               result.warm.median_ms, result.warm.p90_ms);
+    }
+    printf("FASTEST %s\n", addressToString(results.resolvers[results.fastest].resolver).c_str());
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (strcmp(argv[1], "bench") == 0) {
+        return runBenchmark(argc, argv);
+    }
+    return runResolve(argc, argv);
+}
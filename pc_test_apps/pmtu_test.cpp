@@ -0,0 +1,129 @@
+// Host build of the firmware path MTU engine (lib/NetworkTools/pmtu_discovery.cpp).
+//
+// Runs DF-set discovery and the fragmentation-cost measurement against a
+// Linux host, e.g. inside the namespaces set up by scripts/pmtu_netns_test.sh.
+// Needs root (raw ICMP socket).
+//
+// Prints a human-readable report followed by machine-readable lines:
+//   PMTU <path_mtu> <reported_mtu> <reporter|-> <black_hole 0|1> <steps>
+//   SIZE <below|above> <ip_size> <sent> <received> <avg_ms> <goodput_kbps>
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <csignal>
+#include <netdb.h>
+#include <arpa/inet.h>
+
+#include "pmtu_discovery.h"
+
+static volatile bool cancelRequested = false;
+
+static void handleSignal(int) {
+    cancelRequested = true;
+}
+
+static std::string addressToString(uint32_t address) {
+    char buffer[INET_ADDRSTRLEN];
+    struct in_addr in;
+    in.s_addr = address;
+    inet_ntop(AF_INET, &in, buffer, sizeof(buffer));
+    return buffer;
+}
+
+static void printSize(const char* label, const PmtuSizeStats& stats) {
+    printf("  %-6s %5u bytes  loss %5.1f%%  rtt %.2f/%.2f/%.2f ms  goodput %.1f kbps\n",
+           label, stats.ip_size, stats.loss_percent, stats.min_ms, stats.avg_ms, stats.max_ms,
+           stats.goodput_kbps);
+}
+
+void printUsage(const char* progName) {
+    std::cerr << "Usage: " << progName << " <host> [icmp|udp] [udp_port] [measure_count]" << std::endl;
+    std::cerr << "  udp_port:      UDP probe port (default: " << PMTU_DEFAULT_UDP_PORT << ")" << std::endl;
+    std::cerr << "  measure_count: Latency samples per size, 0 skips (default: "
+              << PMTU_DEFAULT_MEASURE_COUNT << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    PmtuProbeType type = PMTU_PROBE_ICMP;
+    if (argc > 2) {
+        std::string mode = argv[2];
+        if (mode == "udp") {
+            type = PMTU_PROBE_UDP;
+        } else if (mode != "icmp") {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    PmtuConfig config = getDefaultPmtuConfig(type);
+    try {
+        if (argc > 3) config.udp_port = (uint16_t)std::stoi(argv[3]);
+        if (argc > 4) config.measure_count = (uint8_t)std::stoi(argv[4]);
+    } catch (...) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    struct addrinfo hints, *res = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    if (getaddrinfo(argv[1], nullptr, &hints, &res) != 0 || res == nullptr) {
+        std::cerr << "Failed to resolve " << argv[1] << std::endl;
+        return 1;
+    }
+    uint32_t target = ((struct sockaddr_in*)res->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(res);
+
+    PmtuSession session;
+    if (!pmtuBegin(session, target, config)) {
+        perror("Failed to open probe sockets (root required)");
+        return 1;
+    }
+    session.cancel = &cancelRequested;
+    signal(SIGINT, handleSignal);
+
+    PmtuResults results;
+    bool discovered = pmtuDiscover(session, results);
+    if (discovered && config.measure_count > 0) {
+        pmtuMeasureFragmentationCost(session, results);
+    }
+    pmtuEnd(session);
+
+    if (!discovered) {
+        std::cerr << (results.target_reachable ? "Discovery interrupted" : "Target did not answer") << std::endl;
+        return 2;
+    }
+
+    printf("Path MTU to %s (%s): %u bytes, %u steps, %u probes, DF %s\n",
+           addressToString(target).c_str(), type == PMTU_PROBE_UDP ? "UDP" : "ICMP",
+           results.path_mtu, results.search_steps, results.probes_sent,
+           results.df_supported ? "set" : "unavailable");
+    if (results.reported_mtu > 0) {
+        printf("  Fragmentation Needed: next-hop MTU %u from %s\n", results.reported_mtu,
+               addressToString(results.frag_needed_from).c_str());
+    }
+    if (results.black_hole) {
+        printf("  PMTU black hole: oversized probes dropped silently\n");
+    }
+    if (results.below.sent > 0) {
+        printSize("below", results.below);
+        printSize("above", results.above);
+    }
+    printf("  Recommended UDP payload: %u bytes\n", results.recommended_udp_payload);
+
+    printf("PMTU %u %u %s %d %u\n", results.path_mtu, results.reported_mtu,
+           results.reported_mtu > 0 ? addressToString(results.frag_needed_from).c_str() : "-",
+           results.black_hole ? 1 : 0, results.search_steps);
+    printf("SIZE below %u %u %u %.3f %.1f\n", results.below.ip_size, results.below.sent,
+           results.below.received, results.below.avg_ms, results.below.goodput_kbps);
+    printf("SIZE above %u %u %u %.3f %.1f\n", results.above.ip_size, results.above.sent,
+           results.above.received, results.above.avg_ms, results.above.goodput_kbps);
+    return 0;
+}
@@ -0,0 +1,217 @@
+// Host build of the firmware port scan engine (lib/NetworkTools/port_scanner.cpp).
+//
+// Scans a TCP (or UDP) port range with the same non-blocking probe window the
+// ESP32 runs, e.g. inside the namespaces set up by
+// scripts/portscan_netns_test.sh.
+//
+// Ports are given as a range list, e.g. "1-1024,8080,9000-9100". Options:
+//   fixed    every probe waits the full timeout, no retries (the old behaviour)
+//   recheck  scan the open ports again, using the result bitmap as a mask
+//   banners  fingerprint the open ports (twice with recheck: the second pass
+//            is answered from the service cache)
+//   udp      UDP probes with service payloads (ICMP errors need root)
+//   rate=N   start at most N probes per second
+//
+// Prints open ports as they are found, then machine-readable lines:
+//   OPEN <port> <connect_us> <service>
+//   SCAN <scanned> <open> <closed> <filtered> <error> <elapsed_ms> <open_filtered>
+//   RTT <srtt_us> <rttvar_us> <probe_timeout_ms>
+//   RECHECK <scanned> <open>
+//   SERVICE <port> <service|-> <detail...>
+//   BANNERS <ports> <identified> <cached> <elapsed_ms>
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <chrono>
+#include <cstring>
+#include <arpa/inet.h>
+
+#include "port_scanner.h"
+
+static volatile bool cancelRequested = false;
+
+static void handleSignal(int) {
+    cancelRequested = true;
+}
+
+struct ScanTally {
+    uint32_t counts[5] = {0, 0, 0, 0, 0};  // Indexed by PortScanOutcome
+    PortBitmap open;
+    bool quiet = false;
+    PortScanProtocol protocol = PORTSCAN_PROTO_TCP;
+};
+
+static void onResult(uint16_t port, PortScanOutcome outcome, uint32_t elapsed_us, void* context) {
+    ScanTally* tally = static_cast<ScanTally*>(context);
+    tally->counts[outcome]++;
+    if (outcome == PORT_OUTCOME_OPEN) {
+        portBitmapSet(tally->open, port);
+    }
+    if (outcome == PORT_OUTCOME_OPEN && !tally->quiet) {
+        const char* service = getServiceName(port, tally->protocol);
+        printf("  %5u open  %8.3f ms  %s\n", port, elapsed_us / 1000.0, service);
+        printf("OPEN %u %lu %s\n", port, (unsigned long)elapsed_us, service);
+    }
+}
+
+#define MAX_FINGERPRINTS 64
+
+static void grabBanners(uint32_t target, const PortBitmap& open, uint8_t window, uint32_t timeout,
+                        ServiceCache& cache, bool print) {
+    static ServiceInfo services[MAX_FINGERPRINTS];
+    uint16_t count = 0;
+    for (uint32_t port = 1; port <= 65535 && count < MAX_FINGERPRINTS; port++) {
+        if (portBitmapTest(open, (uint16_t)port)) services[count++].port = (uint16_t)port;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    portScanGrabBanners(target, services, count, window, timeout, &cache, &cancelRequested);
+    long elapsedMs = (long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started).count();
+
+    uint16_t identified = 0;
+    uint16_t cached = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        const ServiceInfo& info = services[i];
+        if (info.service != nullptr && strcmp(info.service, "unknown") != 0) identified++;
+        if (info.cached) cached++;
+        if (print) {
+            printf("  %5u  %-10s %s\n", info.port, info.service ? info.service : "-", info.detail);
+            printf("SERVICE %u %s %s\n", info.port, info.service ? info.service : "-", info.detail);
+        }
+    }
+    printf("Fingerprinted %u ports: %u identified, %u from cache in %ld ms\n", count, identified, cached,
+           elapsedMs);
+    printf("BANNERS %u %u %u %ld\n", count, identified, cached, elapsedMs);
+}
+
+static bool parseRanges(const char* text, PortSet& set) {
+    portSetClear(set);
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", text);
+    for (char* token = strtok(buffer, ","); token; token = strtok(nullptr, ",")) {
+        char* dash = strchr(token, '-');
+        long first = atol(token);
+        long last = dash ? atol(dash + 1) : first;
+        if (first < 1 || last > 65535 || !portSetAddRange(set, (uint16_t)first, (uint16_t)last)) {
+            return false;
+        }
+    }
+    return set.range_count > 0;
+}
+
+void printUsage(const char* progName) {
+    std::cerr << "Usage: " << progName << " <ip> <ranges> [window] [timeout_ms] [fixed] [recheck] [banners] [udp] [rate=N]"
+              << std::endl;
+    std::cerr << "  ranges: e.g. 1-1024,8080,9000-9100" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    struct in_addr target;
+    if (inet_pton(AF_INET, argv[1], &target) != 1) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    PortSet ports;
+    if (!parseRanges(argv[2], ports)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    uint8_t window = argc > 3 ? (uint8_t)atoi(argv[3]) : CONCURRENT_CONNECTIONS;
+    uint32_t timeout = argc > 4 ? (uint32_t)atoi(argv[4]) : DEFAULT_SCAN_TIMEOUT;
+    bool fixed = false;
+    bool recheck = false;
+    bool banners = false;
+    PortScanProtocol protocol = PORTSCAN_PROTO_TCP;
+    uint32_t rate = 0;
+    for (int i = 5; i < argc; i++) {
+        if (strcmp(argv[i], "fixed") == 0) fixed = true;
+        if (strcmp(argv[i], "recheck") == 0) recheck = true;
+        if (strcmp(argv[i], "banners") == 0) banners = true;
+        if (strcmp(argv[i], "udp") == 0) protocol = PORTSCAN_PROTO_UDP;
+        if (strncmp(argv[i], "rate=", 5) == 0) rate = (uint32_t)atol(argv[i] + 5);
+    }
+
+    signal(SIGINT, handleSignal);
+
+    static ScanTally tally;
+    portBitmapClear(tally.open);
+    tally.protocol = protocol;
+    PortScanSession session;
+    portScanBegin(session, target.s_addr, ports, window, timeout, protocol);
+    portScanSetRate(session, rate);
+    session.on_result = onResult;
+    session.context = &tally;
+    session.cancel = &cancelRequested;
+    if (fixed) {
+        session.min_timeout_ms = timeout;
+        session.max_retries = 0;
+    }
+
+    printf("Scanning %s %s ports %s: %u ports in %u ranges (window %u, %s timeout %u ms)\n", argv[1],
+           protocol == PORTSCAN_PROTO_UDP ? "UDP" : "TCP", argv[2], session.port_count, ports.range_count,
+           session.window, fixed ? "fixed" : "adaptive", timeout);
+    if (protocol == PORTSCAN_PROTO_UDP && session.icmp_fd < 0) {
+        printf("No raw ICMP socket: closed ports rely on ECONNREFUSED\n");
+    }
+    printf("Scanner state: %zu bytes (session %zu, port set %zu, result bitmap %zu)\n",
+           sizeof(session) + sizeof(ports) + sizeof(tally.open), sizeof(session), sizeof(ports),
+           sizeof(tally.open));
+    auto started = std::chrono::steady_clock::now();
+    bool finished = portScanRun(session);
+    portScanEnd(session);
+    long elapsedMs = (long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started).count();
+
+    uint32_t scanned = 0;
+    for (uint32_t count : tally.counts) scanned += count;
+    printf("%s: %u scanned, %u open, %u closed, %u filtered, %u open|filtered, %u errors in %ld ms\n",
+           finished ? "Done" : "Cancelled", scanned, tally.counts[PORT_OUTCOME_OPEN],
+           tally.counts[PORT_OUTCOME_CLOSED], tally.counts[PORT_OUTCOME_FILTERED],
+           tally.counts[PORT_OUTCOME_OPEN_FILTERED], tally.counts[PORT_OUTCOME_ERROR], elapsedMs);
+    printf("SRTT %.3f ms, RTTVAR %.3f ms over %u samples, probe timeout %u ms\n", session.srtt_us / 1000.0,
+           session.rttvar_us / 1000.0, session.rtt_samples, portScanProbeTimeoutMs(session));
+    printf("SCAN %u %u %u %u %u %ld %u\n", scanned, tally.counts[PORT_OUTCOME_OPEN],
+           tally.counts[PORT_OUTCOME_CLOSED], tally.counts[PORT_OUTCOME_FILTERED],
+           tally.counts[PORT_OUTCOME_ERROR], elapsedMs, tally.counts[PORT_OUTCOME_OPEN_FILTERED]);
+    printf("RTT %u %u %u\n", session.srtt_us, session.rttvar_us, portScanProbeTimeoutMs(session));
+
+    static ServiceCache cache;
+    serviceCacheClear(cache);
+    if (finished && banners && protocol == PORTSCAN_PROTO_TCP) {
+        grabBanners(target.s_addr, tally.open, window, timeout, cache, true);
+    }
+
+    if (finished && recheck) {
+        // Same ranges, restricted to what the first pass found open
+        static ScanTally again;
+        portBitmapClear(again.open);
+        again.quiet = true;
+        again.protocol = protocol;
+        ports.mask = &tally.open;
+        portScanBegin(session, target.s_addr, ports, window, timeout, protocol);
+        portScanSetRate(session, rate);
+        session.on_result = onResult;
+        session.context = &again;
+        if (fixed) {
+            session.min_timeout_ms = timeout;
+            session.max_retries = 0;
+        }
+        session.cancel = &cancelRequested;
+        finished = portScanRun(session);
+        portScanEnd(session);
+        printf("Recheck: %u ports, %u still open\n", session.port_count, again.counts[PORT_OUTCOME_OPEN]);
+        printf("RECHECK %u %u\n", session.port_count, again.counts[PORT_OUTCOME_OPEN]);
+        if (finished && banners && protocol == PORTSCAN_PROTO_TCP) {
+            grabBanners(target.s_addr, again.open, window, timeout, cache, false);
+        }
+    }
+    return finished ? 0 : 1;
+}
@@ -0,0 +1,334 @@
+// Host build of the rogue AP detector (lib/NetworkAnalyzer/rogue_detector.cpp).
+//
+// Feeds recorded sightings through the same profile table and alert ring the
+// ESP32 uses.
+//
+// Recording format, one record per line ('#' starts a comment):
+//   L <bssid> <channel> <auth> <ssid>     learn a known-good access point
+//   S <time_s>                            start a scan at this time
+//   N <bssid> <channel> <auth> <ssid>     a network in the scan
+//   V <bssid>                             the network vanished from the scans
+//   E <time_s> <type|resolved> <bssid> [alerts]   an outcome the recording must produce
+// When a recording has E lines, replay compares the alerts it raises and the
+// resolutions it reports against them in order and fails on any difference.
+//
+// Usage:
+//   rogue_detector_test replay <file|->   check a recording
+//   rogue_detector_test synth             print a synthetic recording with its expected alerts
+//   rogue_detector_test stress [rounds]   learn/forget churn checked against std::map
+//   rogue_detector_test check             replay the synthetic recording and scripted cases
+//
+// Replay prints machine-readable lines:
+//   ALERT <time_s> <type> <bssid> <channel> <auth> <expected_auth> <ssid>
+//   RESOLVED <bssid> <alerts>
+//   SUMMARY <profiles> <alerts_raised> <open_alerts>
+//   MISMATCH <index> <expected> <got>
+//   EXPECTED <matched> <expected>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "rogue_detector.h"
+
+static RogueDetector detector;
+
+// One alert or resolution reduced to the fields recordings state; count is
+// the number of alerts a resolution closed
+struct Outcome {
+    uint32_t time_s;
+    std::string type;
+    std::string bssid;
+    bool hasCount;
+    unsigned count;
+};
+
+static std::string formatOutcome(const Outcome& outcome) {
+    char text[96];
+    int length = snprintf(text, sizeof(text), "%u %s %s", outcome.time_s, outcome.type.c_str(),
+                          outcome.bssid.c_str());
+    if (outcome.hasCount) snprintf(text + length, sizeof(text) - length, " %u", outcome.count);
+    return text;
+}
+
+static bool outcomeMatches(const Outcome& expected, const Outcome& got) {
+    return expected.time_s == got.time_s && expected.type == got.type && expected.bssid == got.bssid &&
+           (!expected.hasCount || expected.count == got.count);
+}
+
+static bool parseBssid(const char* text, uint8_t* bssid) {
+    unsigned b[6];
+    if (sscanf(text, "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) return false;
+    for (int i = 0; i < 6; i++) bssid[i] = (uint8_t)b[i];
+    return true;
+}
+
+// Alert type as one word, e.g. "unknown_BSSID"
+static std::string typeWord(uint8_t type) {
+    std::string word = rogueAlertTypeName(type);
+    for (char& c : word) {
+        if (c == ' ') c = '_';
+    }
+    return word;
+}
+
+static std::string bssidText(const uint8_t* b) {
+    char text[18];
+    snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", b[0], b[1], b[2], b[3], b[4], b[5]);
+    return text;
+}
+
+// Parse "<bssid> <channel> <auth> <ssid>"
+static bool parseSighting(const char* text, uint8_t* bssid, unsigned& channel, unsigned& auth, char* ssid) {
+    char bssidText[32];
+    int consumed = 0;
+    if (sscanf(text, "%31s %u %u %n", bssidText, &channel, &auth, &consumed) < 3 || consumed == 0) return false;
+    if (!parseBssid(bssidText, bssid)) return false;
+    snprintf(ssid, ROGUE_SSID_LENGTH + 1, "%s", text + consumed);
+    return ssid[0] != '\0';
+}
+
+static int replay(FILE* input, bool verbose) {
+    char line[256];
+    uint32_t now_s = 0;
+    std::vector<Outcome> produced, expected;
+    rogueClear(detector);
+    while (fgets(line, sizeof(line), input)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        uint8_t bssid[6];
+        unsigned channel, auth;
+        char ssid[ROGUE_SSID_LENGTH + 1];
+        if (line[0] == 'L' && parseSighting(line + 1, bssid, channel, auth, ssid)) {
+            if (!rogueLearn(detector, ssid, bssid, (uint8_t)channel, (uint8_t)auth)) {
+                printf("LEARN_FAILED %s\n", ssid);
+                produced.push_back({now_s, "learn_failed", ssid, false, 0});
+            }
+        } else if (line[0] == 'S') {
+            unsigned long time_s;
+            if (sscanf(line + 1, "%lu", &time_s) == 1) now_s = (uint32_t)time_s;
+        } else if (line[0] == 'N' && parseSighting(line + 1, bssid, channel, auth, ssid)) {
+            uint8_t raised = rogueCheck(detector, ssid, bssid, (uint8_t)channel, (uint8_t)auth, now_s);
+            for (uint8_t i = raised; i-- > 0;) {
+                const RogueAlert& alert = rogueAlert(detector, i);
+                produced.push_back({now_s, typeWord(alert.type), bssidText(alert.bssid), false, 0});
+                if (verbose) {
+                    printf("ALERT %u %s %s %u %u %u %s\n", now_s, typeWord(alert.type).c_str(),
+                           bssidText(alert.bssid).c_str(), alert.channel, alert.authMode, alert.expectedAuthMode,
+                           alert.ssid);
+                }
+            }
+        } else if (line[0] == 'V' && parseBssid(line + 1 + strspn(line + 1, " "), bssid)) {
+            uint8_t resolved = rogueResolve(detector, bssid);
+            if (resolved > 0) {
+                produced.push_back({now_s, "resolved", bssidText(bssid), true, resolved});
+                if (verbose) printf("RESOLVED %s %u\n", bssidText(bssid).c_str(), resolved);
+            }
+        } else if (line[0] == 'E') {
+            unsigned long time_s;
+            char type[32], text[32];
+            unsigned count;
+            int fields = sscanf(line + 1, "%lu %31s %31s %u", &time_s, type, text, &count);
+            if (fields < 3 || !parseBssid(text, bssid)) continue;
+            expected.push_back({(uint32_t)time_s, type, bssidText(bssid), fields == 4, fields == 4 ? count : 0});
+        }
+    }
+    if (verbose) {
+        printf("SUMMARY %u %u %u\n", detector.profileCount, detector.alertsRaised,
+               rogueRecentAlerts(detector, now_s, UINT32_MAX));
+    }
+    if (expected.empty()) return 0;
+
+    size_t matched = 0;
+    size_t count = produced.size() > expected.size() ? produced.size() : expected.size();
+    for (size_t i = 0; i < count; i++) {
+        if (i < expected.size() && i < produced.size() && outcomeMatches(expected[i], produced[i])) {
+            matched++;
+            continue;
+        }
+        printf("MISMATCH %zu %s %s\n", i, i < expected.size() ? formatOutcome(expected[i]).c_str() : "-",
+               i < produced.size() ? formatOutcome(produced[i]).c_str() : "-");
+    }
+    printf("EXPECTED %zu %zu\n", matched, expected.size());
+    return matched == expected.size() && produced.size() == expected.size() ? 0 : 1;
+}
+
+// A corporate SSID on channels 1/6/11 with WPA2 is learned. Over twenty scans
+// an open evil twin of it appears on channel 6 at scan 5 and leaves at scan 14,
+// a known AP moves to channel 3 at scan 9, and a neighbour network that is not
+// protected changes freely throughout.
+//
+// The twin raises its two alerts once, at scan 5; later sightings refresh
+// them instead of raising new ones, and both close when it vanishes
+static void synth(FILE* out) {
+    const unsigned channels[3] = {1, 6, 11};
+    fprintf(out, "# synthetic sightings\n");
+    for (unsigned ap = 0; ap < 3; ap++) {
+        fprintf(out, "L 24:0A:C4:10:00:%02X %u %u Corp\n", ap, channels[ap], ROGUE_AUTH_WPA2_PSK);
+    }
+    for (unsigned scan = 1; scan <= 20; scan++) {
+        fprintf(out, "S %u\n", scan * 30);
+        for (unsigned ap = 0; ap < 3; ap++) {
+            unsigned channel = ap == 1 && scan >= 9 ? 3 : channels[ap];
+            fprintf(out, "N 24:0A:C4:10:00:%02X %u %u Corp\n", ap, channel, ROGUE_AUTH_WPA2_PSK);
+        }
+        fprintf(out, "N 10:20:30:40:50:60 %u %u Neighbour\n", 1 + scan % 11,
+                scan % 2 ? ROGUE_AUTH_OPEN : ROGUE_AUTH_WPA2_PSK);
+        if (scan >= 5 && scan < 14) fprintf(out, "N DE:AD:BE:EF:00:01 6 %u Corp\n", ROGUE_AUTH_OPEN);
+        if (scan == 15) fprintf(out, "V DE:AD:BE:EF:00:01\n");
+    }
+    fprintf(out, "# expected alerts\n");
+    fprintf(out, "E 150 unknown_BSSID DE:AD:BE:EF:00:01\n");
+    fprintf(out, "E 150 security_downgrade DE:AD:BE:EF:00:01\n");
+    fprintf(out, "E 270 unexpected_channel 24:0A:C4:10:00:01\n");
+    fprintf(out, "E 450 resolved DE:AD:BE:EF:00:01 2\n");
+}
+
+// Random learning, forgetting and lookups against a reference map: the SSID
+// table must find exactly the profiles the reference holds after every change
+static int stress(unsigned rounds) {
+    std::mt19937 random(1);
+    std::map<std::string, unsigned> reference;  // SSID -> BSSID count
+    rogueClear(detector);
+    for (unsigned round = 1; round <= rounds; round++) {
+        char ssid[ROGUE_SSID_LENGTH + 1];
+        snprintf(ssid, sizeof(ssid), "Net%u", (unsigned)(random() % 40));  // Small pool, so SSIDs come and go
+        if (random() % 3 == 0) {
+            bool expected = reference.erase(ssid) > 0;
+            if (rogueForget(detector, ssid) != expected) {
+                printf("FAIL round %u: forget %s returned %d\n", round, ssid, !expected);
+                return 1;
+            }
+        } else {
+            uint8_t bssid[6] = {0x24, 0, 0, 0, (uint8_t)(random() % 12), 0};
+            bool known = reference.count(ssid) > 0;
+            if (!known && reference.size() >= ROGUE_MAX_PROFILES) continue;
+            const RogueProfile* before = rogueFindProfile(detector, ssid);
+            bool newBssid = before == nullptr;
+            if (before != nullptr) {
+                newBssid = true;
+                for (uint8_t i = 0; i < before->bssidCount; i++) {
+                    if (memcmp(before->bssids[i], bssid, 6) == 0) newBssid = false;
+                }
+            }
+            bool fits = !newBssid || reference[ssid] < ROGUE_MAX_BSSIDS;
+            if (rogueLearn(detector, ssid, bssid, 6, ROGUE_AUTH_WPA2_PSK) != fits) {
+                printf("FAIL round %u: learn %s returned %d\n", round, ssid, !fits);
+                return 1;
+            }
+            if (fits && newBssid) reference[ssid]++;
+        }
+
+        if (detector.profileCount != reference.size()) {
+            printf("FAIL round %u: %u profiles, expected %zu\n", round, detector.profileCount, reference.size());
+            return 1;
+        }
+        for (const auto& known : reference) {
+            const RogueProfile* profile = rogueFindProfile(detector, known.first.c_str());
+            if (profile == nullptr || profile->bssidCount != known.second) {
+                printf("FAIL round %u: profile %s lost\n", round, known.first.c_str());
+                return 1;
+            }
+        }
+    }
+    printf("OK %u rounds, %u profiles\n", rounds, detector.profileCount);
+    return 0;
+}
+
+// Scripted edge cases, each an inline recording with its expected outcomes
+static const char* const scripts[][2] = {
+    {"re-raise after resolve",
+     // Repeat sightings refresh the open alert; once resolved, the next
+     // sighting is a new alert. Resolving an AP with no alerts reports nothing
+     "L 02:00:00:00:00:01 6 3 Corp\n"
+     "S 30\nN 02:00:00:00:00:66 6 3 Corp\n"
+     "S 60\nN 02:00:00:00:00:66 6 3 Corp\nV 02:00:00:00:00:01\n"
+     "S 90\nV 02:00:00:00:00:66\n"
+     "S 120\nN 02:00:00:00:00:66 6 3 Corp\n"
+     "E 30 unknown_BSSID 02:00:00:00:00:66\nE 90 resolved 02:00:00:00:00:66 1\n"
+     "E 120 unknown_BSSID 02:00:00:00:00:66\n"},
+    {"weakest learned security",
+     // The profile accepts the weakest security it learned (WPA) on the
+     // channels it learned; unprotected SSIDs are never checked
+     "L 02:00:00:00:00:01 1 3 Office\nL 02:00:00:00:00:02 11 2 Office\n"
+     "S 30\nN 02:00:00:00:00:01 11 2 Office\nN 02:00:00:00:00:02 1 3 Office\nN 02:00:00:00:00:77 3 0 Cafe\n"
+     "S 60\nN 02:00:00:00:00:01 1 1 Office\nN 02:00:00:00:00:02 6 2 Office\n"
+     "E 60 security_downgrade 02:00:00:00:00:01\nE 60 unexpected_channel 02:00:00:00:00:02\n"},
+};
+
+static int replayText(const char* text, bool verbose) {
+    FILE* input = tmpfile();
+    if (input == nullptr) {
+        perror("tmpfile");
+        return 1;
+    }
+    fputs(text, input);
+    rewind(input);
+    int result = replay(input, verbose);
+    fclose(input);
+    return result;
+}
+
+static int check() {
+    int failures = 0;
+    for (const auto& script : scripts) {
+        printf("%s: ", script[0]);
+        fflush(stdout);
+        failures += replayText(script[1], false);
+    }
+
+    printf("synthetic recording: ");
+    fflush(stdout);
+    FILE* recording = tmpfile();
+    if (recording == nullptr) {
+        perror("tmpfile");
+        return 1;
+    }
+    synth(recording);
+    rewind(recording);
+    failures += replay(recording, false);
+    fclose(recording);
+
+    failures += stress(2000);
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK rogue detector checks\n");
+    return 0;
+}
+
+void printUsage(const char* progName) {
+    fprintf(stderr, "Usage: %s replay <file|->\n", progName);
+    fprintf(stderr, "       %s synth\n", progName);
+    fprintf(stderr, "       %s stress [rounds]\n", progName);
+    fprintf(stderr, "       %s check\n", progName);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 3 && strcmp(argv[1], "replay") == 0) {
+        FILE* input = strcmp(argv[2], "-") == 0 ? stdin : fopen(argv[2], "r");
+        if (input == nullptr) {
+            perror(argv[2]);
+            return 1;
+        }
+        int result = replay(input, true);
+        if (input != stdin) fclose(input);
+        return result;
+    }
+    if (argc >= 2 && strcmp(argv[1], "synth") == 0) {
+        synth(stdout);
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "stress") == 0) {
+        return stress(argc > 2 ? (unsigned)atoi(argv[2]) : 10000);
+    }
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return check();
+    }
+    printUsage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,364 @@
+// Host build of the scan delta engine (lib/WiFiManager/scan_delta.cpp).
+//
+// Feeds recorded scans through the same BSSID table and event ring the
+// ESP32 uses.
+//
+// Recording format, one record per line ('#' starts a comment):
+//   S <generation> [channel_mask]                  start a scan (mask defaults to 0x3FFE)
+//   N <bssid> <channel> <rssi> <auth> [ssid]       a network in the scan
+//   E <generation> <type> <bssid> [previous current]   an event the recording must produce
+// A scan ends at the next S line or at the end of the input. When a recording
+// has E lines, replay compares the events it produces against them in order
+// and fails on any difference.
+//
+// Usage:
+//   scan_delta_test replay <file|-> [rssi_db]   diff a recording
+//   scan_delta_test synth                       print a synthetic recording with its expected events
+//   scan_delta_test stress [scans]              random churn checked against std::map
+//   scan_delta_test check                       replay the synthetic recording and scripted cases
+//
+// Replay prints machine-readable lines:
+//   EVENT <sequence> <generation> <type> <bssid> <channel> <previous> <current> <ssid>
+//   SCAN <generation> <events> <tracked>
+//   MISMATCH <index> <expected> <got>
+//   EXPECTED <matched> <expected>
+// previous/current are the channel, RSSI or auth mode the event is about.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "scan_delta.h"
+
+static ScanDeltaEngine engine;
+static uint32_t cursor = 0;
+
+// One event reduced to the fields recordings state
+struct EventKey {
+    uint32_t generation;
+    std::string type;
+    std::string bssid;
+    bool hasValues;
+    int previous;
+    int current;
+};
+
+static std::string formatKey(const EventKey& key) {
+    char text[96];
+    if (key.hasValues) {
+        snprintf(text, sizeof(text), "%u %s %s %d %d", key.generation, key.type.c_str(), key.bssid.c_str(),
+                 key.previous, key.current);
+    } else {
+        snprintf(text, sizeof(text), "%u %s %s", key.generation, key.type.c_str(), key.bssid.c_str());
+    }
+    return text;
+}
+
+static bool keyMatches(const EventKey& expected, const EventKey& got) {
+    return expected.generation == got.generation && expected.type == got.type && expected.bssid == got.bssid &&
+           (!expected.hasValues || (expected.previous == got.previous && expected.current == got.current));
+}
+
+static void drainEvents(bool verbose, std::vector<EventKey>& produced) {
+    ScanDeltaEvent events[16];
+    uint32_t skipped;
+    uint16_t count;
+    while ((count = scanDeltaRead(engine, cursor, events, 16, &skipped)) > 0) {
+        if (skipped > 0 && verbose) printf("SKIPPED %u\n", skipped);
+        for (uint16_t i = 0; i < count; i++) {
+            const ScanDeltaEvent& event = events[i];
+            const uint8_t* b = event.network.bssid;
+            int previous = event.previousChannel, current = event.network.channel;
+            if (event.type == SCAN_DELTA_RSSI || event.type == SCAN_DELTA_APPEARED ||
+                event.type == SCAN_DELTA_VANISHED) {
+                previous = event.previousRssi;
+                current = event.network.rssi;
+            } else if (event.type == SCAN_DELTA_AUTH) {
+                previous = event.previousAuthMode;
+                current = event.network.authMode;
+            }
+            char bssid[18];
+            snprintf(bssid, sizeof(bssid), "%02X:%02X:%02X:%02X:%02X:%02X", b[0], b[1], b[2], b[3], b[4], b[5]);
+            produced.push_back({event.generation, scanDeltaTypeName(event.type), bssid, true, previous, current});
+            if (verbose) {
+                printf("EVENT %u %u %s %s %u %d %d %s\n", event.sequence, event.generation,
+                       scanDeltaTypeName(event.type), bssid, event.network.channel, previous, current,
+                       event.network.ssid[0] ? event.network.ssid : "<hidden>");
+            }
+        }
+    }
+}
+
+static void endScan(bool& open, bool verbose, std::vector<EventKey>& produced) {
+    if (!open) return;
+    uint16_t emitted = scanDeltaEnd(engine);
+    drainEvents(verbose, produced);
+    if (verbose) printf("SCAN %u %u %u\n", engine.generation, emitted, engine.tracked);
+    open = false;
+}
+
+static bool parseBssid(const char* text, uint8_t* bssid) {
+    unsigned b[6];
+    if (sscanf(text, "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]) != 6) return false;
+    for (int i = 0; i < 6; i++) bssid[i] = (uint8_t)b[i];
+    return true;
+}
+
+static int replay(FILE* input, uint8_t rssiDb, bool verbose) {
+    char line[256];
+    bool open = false;
+    std::vector<EventKey> produced, expected;
+    scanDeltaClear(engine);
+    scanDeltaSetRssiThreshold(engine, rssiDb);
+    cursor = 0;
+    while (fgets(line, sizeof(line), input)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == 'S') {
+            endScan(open, verbose, produced);
+            unsigned long generation;
+            unsigned mask = 0x3FFE;
+            if (sscanf(line + 1, "%lu %x", &generation, &mask) < 1) continue;
+            scanDeltaBegin(engine, (uint32_t)generation, (uint16_t)mask);
+            open = true;
+        } else if (line[0] == 'N' && open) {
+            char bssidText[32];
+            unsigned channel, auth;
+            int rssi, consumed = 0;
+            if (sscanf(line + 1, "%31s %u %d %u %n", bssidText, &channel, &rssi, &auth, &consumed) < 4) continue;
+            ScanDeltaNetwork network = {};
+            if (!parseBssid(bssidText, network.bssid)) continue;
+            network.channel = (uint8_t)channel;
+            network.rssi = (int8_t)rssi;
+            network.authMode = (uint8_t)auth;
+            if (consumed > 0) snprintf(network.ssid, sizeof(network.ssid), "%s", line + 1 + consumed);
+            scanDeltaAdd(engine, network);
+        } else if (line[0] == 'E') {
+            unsigned long generation;
+            char type[16], bssidText[32];
+            int previous, current;
+            int fields = sscanf(line + 1, "%lu %15s %31s %d %d", &generation, type, bssidText, &previous, &current);
+            uint8_t bssid[6];
+            if (fields < 3 || !parseBssid(bssidText, bssid)) continue;
+            char normalized[18];
+            snprintf(normalized, sizeof(normalized), "%02X:%02X:%02X:%02X:%02X:%02X", bssid[0], bssid[1], bssid[2],
+                     bssid[3], bssid[4], bssid[5]);
+            expected.push_back({(uint32_t)generation, type, normalized, fields == 5, previous, current});
+        }
+    }
+    endScan(open, verbose, produced);
+    if (expected.empty()) return 0;
+
+    size_t matched = 0;
+    size_t count = produced.size() > expected.size() ? produced.size() : expected.size();
+    for (size_t i = 0; i < count; i++) {
+        if (i < expected.size() && i < produced.size() && keyMatches(expected[i], produced[i])) {
+            matched++;
+            continue;
+        }
+        printf("MISMATCH %zu %s %s\n", i, i < expected.size() ? formatKey(expected[i]).c_str() : "-",
+               i < produced.size() ? formatKey(produced[i]).c_str() : "-");
+    }
+    printf("EXPECTED %zu %zu\n", matched, expected.size());
+    return matched == expected.size() && produced.size() == expected.size() ? 0 : 1;
+}
+
+// Thirty scans of twelve networks with a little RSSI noise: one joins at scan 5,
+// one leaves at scan 10, one moves to channel 11 at scan 15, one walks away
+// from scan 18 (4 dB per scan, no noise), one drops to open security at
+// scan 22, and scans 25-26 only cover channels 1-6.
+//
+// The expected events are written out by hand:
+// - the leaver misses scans 10 and 11 and vanishes at the second miss
+//   (SCAN_DELTA_MISS_LIMIT);
+// - the walker reads -66, -70, -74, -78 ... -94 dBm, so with the default
+//   10 dB threshold it reports at -78 (scan 20) and -90 (scan 23);
+// - channel 11 networks are not missed in the partial scans.
+static void synth(FILE* out) {
+    std::mt19937 random(7);
+    fprintf(out, "# synthetic scans\n");
+    for (unsigned scan = 1; scan <= 30; scan++) {
+        bool partial = scan == 25 || scan == 26;
+        fprintf(out, "S %u %s\n", scan, partial ? "7E" : "3FFE");
+        for (unsigned ap = 0; ap < 12; ap++) {
+            if (ap == 10 && scan < 5) continue;
+            if (ap == 11 && scan >= 10) continue;
+            unsigned channel = ap % 3 == 0 ? 1 : ap % 3 == 1 ? 6 : 11;
+            if (ap == 4 && scan >= 15) channel = 11;
+            if (partial && channel > 6) continue;
+            int noise = (int)(random() % 7) - 3;  // mt19937 output is fixed by the standard
+            int rssi = -45 - (int)ap * 3 + (ap == 7 ? 0 : noise);
+            if (ap == 7 && scan >= 18) rssi -= (int)(scan < 24 ? scan - 17 : 7) * 4;
+            unsigned auth = ap == 3 && scan >= 22 ? 0 : 3;
+            fprintf(out, "N 24:0A:C4:00:00:%02X %u %d %u Net%u\n", ap, channel, rssi, auth, ap);
+        }
+    }
+    fprintf(out, "# expected events\n");
+    for (unsigned ap = 0; ap < 12; ap++) {
+        if (ap != 10) fprintf(out, "E 1 appeared 24:0A:C4:00:00:%02X\n", ap);
+    }
+    fprintf(out, "E 5 appeared 24:0A:C4:00:00:0A\n");
+    fprintf(out, "E 11 vanished 24:0A:C4:00:00:0B\n");
+    fprintf(out, "E 15 channel 24:0A:C4:00:00:04 6 11\n");
+    fprintf(out, "E 20 rssi 24:0A:C4:00:00:07 -66 -78\n");
+    fprintf(out, "E 22 auth 24:0A:C4:00:00:03 3 0\n");
+    fprintf(out, "E 23 rssi 24:0A:C4:00:00:07 -78 -90\n");
+}
+
+// Random churn against a reference map: the hash table must track exactly
+// the networks the reference says are present, through many deletions
+static int stress(unsigned scans) {
+    std::mt19937 random(1);
+    std::map<uint32_t, unsigned> reference;  // BSSID tail -> missed scans
+    scanDeltaClear(engine);
+    for (unsigned scan = 1; scan <= scans; scan++) {
+        scanDeltaBegin(engine, scan, 0x3FFE);
+        std::map<uint32_t, bool> seen;
+        unsigned count = 30 + random() % 20;
+        for (unsigned i = 0; i < count; i++) {
+            uint32_t tail = random() % 400;  // Small pool, so BSSIDs come and go
+            ScanDeltaNetwork network = {};
+            network.bssid[0] = 0x24;
+            network.bssid[3] = (uint8_t)(tail >> 16);
+            network.bssid[4] = (uint8_t)(tail >> 8);
+            network.bssid[5] = (uint8_t)tail;
+            network.channel = 6;
+            network.rssi = -60;
+            bool known = reference.count(tail) > 0;
+            if (!known && reference.size() >= SCAN_DELTA_MAX_TRACKED) continue;
+            scanDeltaAdd(engine, network);
+            reference[tail] = 0;
+            seen[tail] = true;
+        }
+        scanDeltaEnd(engine);
+        for (auto it = reference.begin(); it != reference.end();) {
+            if (!seen.count(it->first) && ++it->second >= SCAN_DELTA_MISS_LIMIT) {
+                it = reference.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if (engine.tracked != reference.size()) {
+            printf("FAIL scan %u: tracked %u, expected %zu\n", scan, engine.tracked, reference.size());
+            return 1;
+        }
+        for (const auto& known : reference) {
+            uint8_t bssid[6] = {0x24, 0, 0, (uint8_t)(known.first >> 16), (uint8_t)(known.first >> 8),
+                                (uint8_t)known.first};
+            if (scanDeltaFind(engine, bssid) == nullptr) {
+                printf("FAIL scan %u: BSSID tail %u lost\n", scan, known.first);
+                return 1;
+            }
+        }
+    }
+    printf("OK %u scans, %u events, %u tracked\n", scans, scanDeltaSequence(engine) - 1, engine.tracked);
+    return 0;
+}
+
+// Scripted edge cases, each an inline recording with its expected events
+static const char* const scripts[][2] = {
+    {"miss limit",
+     // A misses scan 2 and comes back (miss count resets), misses scan 4,
+     // is not looked for in partial scan 5, and vanishes at its second
+     // covered miss in scan 6
+     "S 1\nN 02:00:00:00:00:0A 6 -50 3 A\nN 02:00:00:00:00:0B 1 -60 3 B\n"
+     "S 2\nN 02:00:00:00:00:0B 1 -60 3 B\n"
+     "S 3\nN 02:00:00:00:00:0A 6 -50 3 A\nN 02:00:00:00:00:0B 1 -60 3 B\n"
+     "S 4\nN 02:00:00:00:00:0B 1 -60 3 B\n"
+     "S 5 2\nN 02:00:00:00:00:0B 1 -60 3 B\n"
+     "S 6\nN 02:00:00:00:00:0B 1 -60 3 B\n"
+     "E 1 appeared 02:00:00:00:00:0A\nE 1 appeared 02:00:00:00:00:0B\n"
+     "E 6 vanished 02:00:00:00:00:0A\n"},
+    {"rssi drift",
+     // Small steps add up against the last reported level, not the last scan
+     "S 1\nN 02:00:00:00:00:0C 11 -50 3 C\n"
+     "S 2\nN 02:00:00:00:00:0C 11 -54 3 C\n"
+     "S 3\nN 02:00:00:00:00:0C 11 -58 3 C\n"
+     "S 4\nN 02:00:00:00:00:0C 11 -61 3 C\n"
+     "S 5\nN 02:00:00:00:00:0C 11 -65 3 C\n"
+     "S 6\nN 02:00:00:00:00:0C 11 -49 3 C\n"
+     "E 1 appeared 02:00:00:00:00:0C\nE 4 rssi 02:00:00:00:00:0C -50 -61\nE 6 rssi 02:00:00:00:00:0C -61 -49\n"},
+    {"move and rekey",
+     // Channel and security change in one scan; a duplicate sighting is ignored
+     "S 1\nN 02:00:00:00:00:0D 1 -40 4 D\n"
+     "S 2\nN 02:00:00:00:00:0D 6 -40 0 D\nN 02:00:00:00:00:0D 11 -40 3 D\n"
+     "E 1 appeared 02:00:00:00:00:0D\nE 2 channel 02:00:00:00:00:0D 1 6\nE 2 auth 02:00:00:00:00:0D 4 0\n"},
+};
+
+static int replayText(const char* text, bool verbose) {
+    FILE* input = tmpfile();
+    if (input == nullptr) {
+        perror("tmpfile");
+        return 1;
+    }
+    fputs(text, input);
+    rewind(input);
+    int result = replay(input, SCAN_DELTA_RSSI_DB, verbose);
+    fclose(input);
+    return result;
+}
+
+static int check() {
+    int failures = 0;
+    for (const auto& script : scripts) {
+        printf("%s: ", script[0]);
+        fflush(stdout);
+        failures += replayText(script[1], false);
+    }
+
+    printf("synthetic recording: ");
+    fflush(stdout);
+    FILE* recording = tmpfile();
+    if (recording == nullptr) {
+        perror("tmpfile");
+        return 1;
+    }
+    synth(recording);
+    rewind(recording);
+    failures += replay(recording, SCAN_DELTA_RSSI_DB, false);
+    fclose(recording);
+
+    failures += stress(2000);
+    if (failures > 0) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK scan delta checks\n");
+    return 0;
+}
+
+void printUsage(const char* progName) {
+    fprintf(stderr, "Usage: %s replay <file|-> [rssi_db]\n", progName);
+    fprintf(stderr, "       %s synth\n", progName);
+    fprintf(stderr, "       %s stress [scans]\n", progName);
+    fprintf(stderr, "       %s check\n", progName);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 3 && strcmp(argv[1], "replay") == 0) {
+        FILE* input = strcmp(argv[2], "-") == 0 ? stdin : fopen(argv[2], "r");
+        if (input == nullptr) {
+            perror(argv[2]);
+            return 1;
+        }
+        int result = replay(input, argc > 3 ? (uint8_t)atoi(argv[3]) : SCAN_DELTA_RSSI_DB, true);
+        if (input != stdin) fclose(input);
+        return result;
+    }
+    if (argc >= 2 && strcmp(argv[1], "synth") == 0) {
+        synth(stdout);
+        return 0;
+    }
+    if (argc >= 2 && strcmp(argv[1], "stress") == 0) {
+        return stress(argc > 2 ? (unsigned)atoi(argv[2]) : 10000);
+    }
+    if (argc >= 2 && strcmp(argv[1], "check") == 0) {
+        return check();
+    }
+    printUsage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,138 @@
+// Host build of the firmware traceroute engine (lib/NetworkTools/traceroute.cpp).
+//
+// Runs the same probing code the ESP32 uses against a Linux host so hop
+// matching and latency attribution can be checked, e.g. inside the network
+// namespaces set up by scripts/traceroute_netns_test.sh. Needs root (raw
+// ICMP socket).
+//
+// Prints a human-readable table followed by one machine-readable line per hop:
+//   HOP <ttl> <address|*> <sent> <received> <avg_ms> <flags>
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <csignal>
+#include <chrono>
+#include <thread>
+#include <netdb.h>
+#include <arpa/inet.h>
+
+#include "traceroute.h"
+
+static volatile bool cancelRequested = false;
+
+static void handleSignal(int) {
+    cancelRequested = true;
+}
+
+static std::string addressToString(uint32_t address) {
+    char buffer[INET_ADDRSTRLEN];
+    struct in_addr in;
+    in.s_addr = address;
+    inet_ntop(AF_INET, &in, buffer, sizeof(buffer));
+    return buffer;
+}
+
+static std::string hopFlags(const TracerouteHop& hop) {
+    std::string flags;
+    if (hop.flags & TRACE_HOP_DESTINATION) flags += "dest,";
+    if (hop.flags & TRACE_HOP_UNREACHABLE) flags += "unreach" + std::to_string(hop.unreachable_code) + ",";
+    if (hop.flags & TRACE_HOP_MULTIPATH) flags += "multipath,";
+    if (flags.empty()) return "-";
+    flags.pop_back();
+    return flags;
+}
+
+static void printResults(const TracerouteResults& results) {
+    printf("Traceroute to %s (%s), %u round(s), destination %s\n",
+           addressToString(results.target).c_str(),
+           results.probe_type == TRACE_PROBE_ICMP ? "ICMP" : "UDP",
+           results.rounds, results.destination_reached ? "reached" : "not reached");
+    printf("Hop  Address           Loss%%  Sent    Last     Avg     Min     Max\n");
+    for (uint8_t i = 0; i < results.hop_count; i++) {
+        const TracerouteHop& hop = results.hops[i];
+        if (hop.received == 0) {
+            printf("%3u  %-16s %5.1f%% %5u       *\n", i + 1, "???", tracerouteHopLoss(hop), hop.sent);
+            continue;
+        }
+        printf("%3u  %-16s %5.1f%% %5u %7.2f %7.2f %7.2f %7.2f %s\n", i + 1,
+               addressToString(hop.address).c_str(), tracerouteHopLoss(hop), hop.sent,
+               hop.last_ms, hop.avg_ms, hop.min_ms, hop.max_ms, hopFlags(hop).c_str());
+    }
+
+    for (uint8_t i = 0; i < results.hop_count; i++) {
+        const TracerouteHop& hop = results.hops[i];
+        printf("HOP %u %s %u %u %.3f %s\n", i + 1,
+               hop.received > 0 ? addressToString(hop.address).c_str() : "*",
+               hop.sent, hop.received, hop.avg_ms, hopFlags(hop).c_str());
+    }
+}
+
+void printUsage(const char* progName) {
+    std::cerr << "Usage: " << progName << " <host> [udp|icmp] [rounds] [probes] [parallel]" << std::endl;
+    std::cerr << "  rounds:   Path rounds, >1 behaves like MTR (default: 1)" << std::endl;
+    std::cerr << "  probes:   Probes per hop (default: " << TRACEROUTE_DEFAULT_PROBES << ")" << std::endl;
+    std::cerr << "  parallel: TTLs in flight at once (default: " << TRACEROUTE_DEFAULT_PARALLEL << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    TracerouteProbeType type = TRACE_PROBE_UDP;
+    if (argc > 2) {
+        std::string mode = argv[2];
+        if (mode == "icmp") {
+            type = TRACE_PROBE_ICMP;
+        } else if (mode != "udp") {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    TracerouteConfig config = getDefaultTracerouteConfig(type);
+    int rounds = 1;
+    try {
+        if (argc > 3) rounds = std::stoi(argv[3]);
+        if (argc > 4) config.probes_per_hop = (uint8_t)std::stoi(argv[4]);
+        if (argc > 5) config.parallel_hops = (uint8_t)std::stoi(argv[5]);
+    } catch (...) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    struct addrinfo hints, *res = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    if (getaddrinfo(argv[1], nullptr, &hints, &res) != 0 || res == nullptr) {
+        std::cerr << "Failed to resolve " << argv[1] << std::endl;
+        return 1;
+    }
+    uint32_t target = ((struct sockaddr_in*)res->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(res);
+
+    TracerouteSession session;
+    if (!tracerouteBegin(session, target, config)) {
+        perror("Failed to open probe sockets (root required)");
+        return 1;
+    }
+    session.cancel = &cancelRequested;
+    signal(SIGINT, handleSignal);
+
+    TracerouteResults results;
+    tracerouteResetResults(results, target, type);
+
+    for (int round = 0; round < rounds && !cancelRequested; round++) {
+        if (!tracerouteRunRound(session, results)) break;
+        if (round + 1 < rounds) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(config.interval_ms));
+        }
+    }
+
+    tracerouteEnd(session);
+    printResults(results);
+    return results.destination_reached ? 0 : 2;
+}
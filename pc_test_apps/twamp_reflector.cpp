@@ -0,0 +1,186 @@
+// TWAMP-Light (RFC 5357) session-reflector for Linux.
+//
+// Answers unauthenticated TWAMP-Light test packets from the ESP32
+// ('latency test twamp <pc_ip>') or any standard session-sender. Shares the
+// wire codec with the firmware via lib/NetworkTools/twamp_protocol.h.
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <csignal>
+#include <atomic>
+#include <sched.h>
+#include <thread>
+
+#include "twamp_protocol.h"
+
+// Configuration
+#define BUFFER_SIZE 2048
+
+std::atomic<bool> running(true);
+int sockfd = -1; // Global so we can close it to wake up the thread
+
+void signalHandler(int signum) {
+    if (running) {
+        std::cout << "\n🛑 Signal received (" << signum << "). Stopping..." << std::endl;
+        running = false;
+        // shutdown() wakes the blocking recvmsg; the thread closes the socket
+        if (sockfd >= 0) {
+            shutdown(sockfd, SHUT_RDWR);
+        }
+    }
+}
+
+void printUsage(const char* progName) {
+    std::cerr << "Usage: " << progName << " [port]" << std::endl;
+    std::cerr << "  port: UDP port to listen on (default: " << TWAMP_LIGHT_DEFAULT_PORT
+              << ", needs root; use e.g. 8620 otherwise)" << std::endl;
+}
+
+// Set process to high priority for lower latency
+void optimizeThreadPriority() {
+    struct sched_param param;
+    param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0) {
+        std::cout << "🚀 High priority (SCHED_FIFO) enabled for reflector thread!" << std::endl;
+    }
+}
+
+TwampTimestamp timespecToTwamp(const struct timespec& ts) {
+    uint64_t us = (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)(ts.tv_nsec / 1000);
+    return twampTimestampFromMicros(us);
+}
+
+TwampTimestamp nowTwamp() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return timespecToTwamp(ts);
+}
+
+void runReflector(int port) {
+    struct sockaddr_in serverAddr, clientAddr;
+    uint8_t request[BUFFER_SIZE];
+    uint8_t reply[TWAMP_MAX_PACKET_SIZE];
+    char control[256];
+    uint32_t reflectorSequence = 0;
+
+    if ((sockfd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+        perror("❌ Socket creation failed");
+        return;
+    }
+
+    // Kernel receive timestamps give an accurate T2, IP_RECVTTL fills Sender TTL
+    int on = 1;
+    setsockopt(sockfd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+    setsockopt(sockfd, IPPROTO_IP, IP_RECVTTL, &on, sizeof(on));
+
+#ifdef SO_BUSY_POLL
+    int busyPoll = 50; // Microseconds to busy poll
+    setsockopt(sockfd, SOL_SOCKET, SO_BUSY_POLL, &busyPoll, sizeof(busyPoll));
+#endif
+
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_addr.s_addr = INADDR_ANY;
+    serverAddr.sin_port = htons(port);
+
+    if (bind(sockfd, (const struct sockaddr *)&serverAddr, sizeof(serverAddr)) < 0) {
+        perror("❌ Bind failed");
+        close(sockfd);
+        sockfd = -1;
+        return;
+    }
+
+    optimizeThreadPriority();
+
+    std::cout << "📡 TWAMP-Light reflector running on UDP port " << port << std::endl;
+    std::cout << "📥 Waiting for test packets (Ctrl+C to stop)..." << std::endl;
+
+    while (running) {
+        struct iovec iov;
+        iov.iov_base = request;
+        iov.iov_len = sizeof(request);
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &clientAddr;
+        msg.msg_namelen = sizeof(clientAddr);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ssize_t n = recvmsg(sockfd, &msg, 0);
+        if (n < 0) {
+            if (errno == EINTR && running) continue;
+            break;
+        }
+        if (n == 0 && !running) {
+            break;
+        }
+
+        TwampTimestamp receiveTime = nowTwamp();
+        uint8_t senderTtl = TWAMP_UNKNOWN_TTL;
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                struct timespec ts;
+                memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                receiveTime = timespecToTwamp(ts);
+            } else if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_TTL) {
+                int ttl;
+                memcpy(&ttl, CMSG_DATA(cmsg), sizeof(ttl));
+                senderTtl = (uint8_t)ttl;
+            }
+        }
+
+        size_t len = twampBuildReflectorReply(request, (size_t)n, receiveTime, reflectorSequence,
+                                              TWAMP_ERROR_ESTIMATE_UNSYNCED, senderTtl,
+                                              reply, sizeof(reply));
+        if (len == 0) {
+            continue; // Too short to be a TWAMP test packet
+        }
+
+        twampStampReflectorTransmit(reply, nowTwamp());
+        sendto(sockfd, reply, len, 0, (const struct sockaddr *)&clientAddr, msg.msg_namelen);
+        reflectorSequence++;
+    }
+
+    std::cout << "📊 Reflected " << reflectorSequence << " test packets" << std::endl;
+
+    if (sockfd >= 0) {
+        close(sockfd);
+        sockfd = -1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int port = TWAMP_LIGHT_DEFAULT_PORT;
+
+    if (argc > 1) {
+        try {
+            port = std::stoi(argv[1]);
+        } catch (...) {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+
+    std::thread reflectorThread(runReflector, port);
+
+    if (reflectorThread.joinable()) {
+        reflectorThread.join();
+    }
+
+    std::cout << "🛑 Reflector stopped cleanly." << std::endl;
+    return 0;
+}
@@ -0,0 +1,139 @@
+// UDP echo client for measuring round-trip time to the ESP32 echo service.
+//
+// Sends "PING <timestamp_us> <sequence>" datagrams ('echo start' on the
+// device) and reports min/avg/max RTT, jitter and loss. Works against
+// udp_echo_server as well.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+
+// Configuration
+#define DEFAULT_PORT 7
+#define DEFAULT_COUNT 10
+#define DEFAULT_INTERVAL_MS 200
+#define DEFAULT_TIMEOUT_MS 1000
+#define BUFFER_SIZE 2048
+
+static uint64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void printUsage(const char* progName) {
+    std::cerr << "Usage: " << progName << " <host> [port] [count] [interval_ms]" << std::endl;
+    std::cerr << "  port:        UDP port of the echo service (default: " << DEFAULT_PORT << ")" << std::endl;
+    std::cerr << "  count:       Number of probes (default: " << DEFAULT_COUNT << ")" << std::endl;
+    std::cerr << "  interval_ms: Delay between probes (default: " << DEFAULT_INTERVAL_MS << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string host = argv[1];
+    int port = DEFAULT_PORT;
+    int count = DEFAULT_COUNT;
+    int intervalMs = DEFAULT_INTERVAL_MS;
+    try {
+        if (argc > 2) port = std::stoi(argv[2]);
+        if (argc > 3) count = std::stoi(argv[3]);
+        if (argc > 4) intervalMs = std::stoi(argv[4]);
+    } catch (...) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    struct addrinfo hints, *res = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res) != 0 || res == nullptr) {
+        std::cerr << "❌ Cannot resolve " << host << std::endl;
+        return 1;
+    }
+
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sockfd < 0) {
+        perror("❌ Socket creation failed");
+        freeaddrinfo(res);
+        return 1;
+    }
+    // connect() filters out datagrams from other peers
+    if (connect(sockfd, res->ai_addr, res->ai_addrlen) < 0) {
+        perror("❌ Connect failed");
+        freeaddrinfo(res);
+        close(sockfd);
+        return 1;
+    }
+    freeaddrinfo(res);
+
+    struct timeval tv;
+    tv.tv_sec = DEFAULT_TIMEOUT_MS / 1000;
+    tv.tv_usec = (DEFAULT_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    std::cout << "📤 Probing " << host << ":" << port << " (" << count << " probes)" << std::endl;
+
+    std::vector<double> rtts;
+    char buffer[BUFFER_SIZE];
+    for (int seq = 0; seq < count; seq++) {
+        uint64_t sent = nowMicros();
+        int len = snprintf(buffer, sizeof(buffer), "PING %llu %d", (unsigned long long)sent, seq);
+        send(sockfd, buffer, len, 0);
+
+        // Skip late replies from earlier probes until ours arrives or we time out
+        bool matched = false;
+        while (!matched) {
+            ssize_t n = recv(sockfd, buffer, sizeof(buffer) - 1, 0);
+            if (n <= 0) break;
+            buffer[n] = '\0';
+
+            unsigned long long echoedTime;
+            int echoedSeq;
+            if (sscanf(buffer, "PONG %llu %d", &echoedTime, &echoedSeq) == 2 && echoedSeq == seq) {
+                double rtt = (nowMicros() - echoedTime) / 1000.0;
+                rtts.push_back(rtt);
+                printf("📥 seq=%d rtt=%.3f ms\n", seq, rtt);
+                matched = true;
+            }
+        }
+        if (!matched) {
+            printf("⏱️  seq=%d timeout\n", seq);
+        }
+
+        if (seq + 1 < count) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        }
+    }
+    close(sockfd);
+
+    int received = (int)rtts.size();
+    printf("\n📊 %d sent, %d received, %.1f%% loss\n", count, received,
+           count > 0 ? 100.0 * (count - received) / count : 0.0);
+    if (received > 0) {
+        double sum = 0, jitter = 0;
+        for (size_t i = 0; i < rtts.size(); i++) {
+            sum += rtts[i];
+            if (i > 0) jitter += std::fabs(rtts[i] - rtts[i - 1]);
+        }
+        printf("⚡ rtt min/avg/max = %.3f/%.3f/%.3f ms, jitter %.3f ms\n",
+               *std::min_element(rtts.begin(), rtts.end()), sum / received,
+               *std::max_element(rtts.begin(), rtts.end()),
+               received > 1 ? jitter / (received - 1) : 0.0);
+    }
+    return received > 0 ? 0 : 2;
+}
@@ -0,0 +1,200 @@
+#!/bin/bash
+
+# ESP32 WiFi Utility - Host discovery namespace test
+# Builds pc_test_apps/discovery_test (the firmware discovery engine compiled
+# for Linux) and sweeps two subnets:
+#
+#   LAN 10.80.0.0/24 (bridge in disc-r1, r1 is 10.80.0.1)
+#     disc-client 10.80.0.2, disc-h1 .10, disc-h2 .20, disc-h3 .30
+#   Remote 10.81.0.0/24 behind disc-r1 (10.81.0.1)
+#     disc-far1 10.81.0.10, disc-far2 10.81.0.20
+#
+# The LAN hosts have fixed MACs (Espressif, Raspberry Pi, locally
+# administered) and are found by ARP, including h3 which ignores pings.
+# The remote subnet is not on-link, so the sweep falls back to ICMP echo and
+# TCP connect pings: far2 ignores pings and is found by the RST to port 80.
+# Requires root.
+
+set -e
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+BLUE='\033[0;34m'
+NC='\033[0m' # No Color
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+TEST_APPS="$SCRIPT_DIR/../pc_test_apps"
+BINARY="$TEST_APPS/discovery_test"
+LAN_SWEEP_MAX_MS=5000
+FAILURES=0
+LISTENER_PID=""
+
+NAMESPACES="disc-client disc-r1 disc-h1 disc-h2 disc-h3 disc-far1 disc-far2"
+
+cleanup() {
+    [ -n "$LISTENER_PID" ] && kill "$LISTENER_PID" 2>/dev/null || true
+    for ns in $NAMESPACES; do
+        ip netns del "$ns" 2>/dev/null || true
+    done
+}
+
+fail() {
+    echo -e "${RED}FAIL${NC} $1"
+    FAILURES=$((FAILURES + 1))
+}
+
+pass() {
+    echo -e "${GREEN}PASS${NC} $1"
+}
+
+# attach <namespace> <bridge> <address/prefix> [mac]
+attach() {
+    local ns=$1 bridge=$2 address=$3 mac=$4
+    local inside="${ns#disc-}i"
+    local outside="${ns#disc-}o"
+    ip link add "$inside" type veth peer name "$outside"
+    ip link set "$inside" netns "$ns"
+    ip link set "$outside" netns disc-r1
+    ip -n disc-r1 link set "$outside" master "$bridge" up
+    [ -n "$mac" ] && ip -n "$ns" link set "$inside" address "$mac"
+    ip -n "$ns" addr add "$address" dev "$inside"
+    ip -n "$ns" link set "$inside" up
+}
+
+setup() {
+    cleanup
+    for ns in $NAMESPACES; do
+        ip netns add "$ns"
+        ip -n "$ns" link set lo up
+    done
+
+    ip -n disc-r1 link add br0 type bridge
+    ip -n disc-r1 link add br1 type bridge
+    ip -n disc-r1 link set br0 address 00:0c:29:00:00:01
+    ip -n disc-r1 addr add 10.80.0.1/24 dev br0
+    ip -n disc-r1 addr add 10.81.0.1/24 dev br1
+    ip -n disc-r1 link set br0 up
+    ip -n disc-r1 link set br1 up
+    ip netns exec disc-r1 sysctl -qw net.ipv4.ip_forward=1
+
+    attach disc-client br0 10.80.0.2/24
+    attach disc-h1 br0 10.80.0.10/24 24:0a:c4:00:00:01
+    attach disc-h2 br0 10.80.0.20/24 b8:27:eb:00:00:02
+    attach disc-h3 br0 10.80.0.30/24 02:11:22:33:44:55
+    attach disc-far1 br1 10.81.0.10/24
+    attach disc-far2 br1 10.81.0.20/24
+
+    ip -n disc-client route add default via 10.80.0.1
+    ip -n disc-far1 route add default via 10.81.0.1
+    ip -n disc-far2 route add default via 10.81.0.1
+    ip netns exec disc-h3 sysctl -qw net.ipv4.icmp_echo_ignore_all=1
+    ip netns exec disc-far2 sysctl -qw net.ipv4.icmp_echo_ignore_all=1
+
+    # Services for the per-host port scan
+    ip netns exec disc-h1 python3 -c "
+import socket, time
+keep = []
+for port in (22, 80, 8080):
+    s = socket.socket()
+    s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    s.bind(('0.0.0.0', port))
+    s.listen(8)
+    keep.append(s)
+time.sleep(3600)
+" &
+    LISTENER_PID=$!
+    sleep 0.5
+}
+
+host_line() {
+    echo "$1" | awk -v ip="$2" '$1 == "HOST" && $2 == ip'
+}
+
+host_field() {
+    host_line "$1" "$2" | awk -v idx="$3" '{ print $(idx + 1) }'
+}
+
+host_vendor() {
+    host_line "$1" "$2" | cut -d' ' -f7-
+}
+
+check_lan_sweep() {
+    local output hosts elapsed
+    output=$(ip netns exec disc-client "$BINARY" 10.80.0.1 10.80.0.254 || true)
+    echo "$output" | grep -v -E '^(HOST|SWEEP) '
+
+    hosts=$(echo "$output" | awk '$1 == "HOST" { print $2 }' | tr '\n' ' ' | sed 's/ $//')
+    [ "$hosts" = "10.80.0.1 10.80.0.10 10.80.0.20 10.80.0.30" ] && pass "LAN hosts found in address order ($hosts)" ||
+        fail "LAN hosts '$hosts'"
+
+    local methods
+    methods=$(echo "$output" | awk '$1 == "HOST" { print $4 }' | sort -u | tr '\n' ' ' | sed 's/ $//')
+    [ "$methods" = "arp" ] && pass "on-link range swept by ARP only" || fail "methods '$methods', expected arp"
+
+    [ "$(host_field "$output" 10.80.0.10 2)" = "24:0a:c4:00:00:01" ] && pass "MAC read from ARP reply" ||
+        fail "h1 MAC '$(host_field "$output" 10.80.0.10 2)'"
+    [ "$(host_vendor "$output" 10.80.0.10)" = "Espressif" ] && pass "Espressif OUI" || fail "h1 vendor '$(host_vendor "$output" 10.80.0.10)'"
+    [ "$(host_vendor "$output" 10.80.0.20)" = "Raspberry Pi" ] && pass "Raspberry Pi OUI" || fail "h2 vendor '$(host_vendor "$output" 10.80.0.20)'"
+    [ "$(host_vendor "$output" 10.80.0.30)" = "Private" ] && pass "locally administered MAC reported private (ignores pings, found by ARP)" ||
+        fail "h3 vendor '$(host_vendor "$output" 10.80.0.30)'"
+
+    elapsed=$(echo "$output" | awk '$1 == "SWEEP" { print $4 }')
+    if [ "$(echo "$output" | awk '$1 == "SWEEP" { print $2 }')" = "254" ] && [ "${elapsed:-999999}" -le "$LAN_SWEEP_MAX_MS" ]; then
+        pass "/24 swept in ${elapsed} ms"
+    else
+        fail "/24 sweep: '$(echo "$output" | awk '$1 == "SWEEP"')' (expected 254 addresses in <= $LAN_SWEEP_MAX_MS ms)"
+    fi
+}
+
+check_remote_sweep() {
+    local output hosts
+    output=$(ip netns exec disc-client "$BINARY" 10.81.0.1 10.81.0.254 || true)
+    echo "$output" | grep -E '^(Sweeping|Done|Cancelled|  )'
+
+    hosts=$(echo "$output" | awk '$1 == "HOST" { print $2 }' | tr '\n' ' ' | sed 's/ $//')
+    [ "$hosts" = "10.81.0.1 10.81.0.10 10.81.0.20" ] && pass "remote hosts found ($hosts)" || fail "remote hosts '$hosts'"
+    [ "$(host_field "$output" 10.81.0.10 3)" = "icmp" ] && pass "far1 answered ICMP echo" ||
+        fail "far1 found by '$(host_field "$output" 10.81.0.10 3)'"
+    [ "$(host_field "$output" 10.81.0.20 3)" = "tcp" ] && pass "far2 (ignores pings) found by TCP ping" ||
+        fail "far2 found by '$(host_field "$output" 10.81.0.20 3)'"
+    [ "$(host_field "$output" 10.81.0.20 2)" = "-" ] && pass "no MAC for hosts behind a router" ||
+        fail "far2 MAC '$(host_field "$output" 10.81.0.20 2)'"
+}
+
+check_host_scan() {
+    local output ports scanned
+    output=$(ip netns exec disc-client "$BINARY" 10.80.0.1 10.80.0.254 arp 200 scan=1-1024,8080 || true)
+    echo "$output" | grep -E '^(Done|PORTSCAN)'
+
+    ports=$(host_field "$output" 10.80.0.10 5)
+    [ "$ports" = "22,80,8080" ] && pass "live host port scanned ($ports)" || fail "h1 ports '$ports', expected 22,80,8080"
+    [ "$(host_field "$output" 10.80.0.20 5)" = "-" ] && pass "host without services reports no open ports" ||
+        fail "h2 ports '$(host_field "$output" 10.80.0.20 5)'"
+    scanned=$(echo "$output" | awk '$1 == "PORTSCAN" { print $2 }')
+    [ "$scanned" = "4" ] && pass "every live host scanned ($scanned)" || fail "hosts scanned '$scanned', expected 4"
+}
+
+if [ "$(id -u)" -ne 0 ]; then
+    echo -e "${RED}This test needs root (network namespaces)${NC}"
+    exit 1
+fi
+
+trap cleanup EXIT
+
+echo -e "${BLUE}Building discovery_test...${NC}"
+make -C "$TEST_APPS" discovery_test >/dev/null
+
+setup
+
+echo -e "${BLUE}LAN sweep (ARP)${NC}"
+check_lan_sweep
+echo -e "${BLUE}Remote sweep (ICMP / TCP ping)${NC}"
+check_remote_sweep
+echo -e "${BLUE}Port scan of live hosts${NC}"
+check_host_scan
+
+if [ "$FAILURES" -ne 0 ]; then
+    echo -e "${RED}$FAILURES check(s) failed${NC}"
+    exit 1
+fi
+echo -e "${GREEN}All host discovery checks passed${NC}"
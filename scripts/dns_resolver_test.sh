@@ -0,0 +1,117 @@
+#!/bin/bash
+
+# ESP32 WiFi Utility - DNS cache and resolver benchmark test
+# Builds pc_test_apps/dns_bench_test (the firmware DNS layer compiled for
+# Linux) and runs it against two scripted resolvers from dns_test_server.py:
+#
+#   127.0.0.1:$PORT  cold 40 ms, warm 0 ms
+#   127.0.0.2:$PORT  cold 10 ms, warm 15 ms
+#
+# Checks cache hits, TTL expiry, TTL 0, CNAME TTLs, NXDOMAIN and the
+# cold/warm benchmark. No root needed.
+
+set -e
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+BLUE='\033[0;34m'
+NC='\033[0m' # No Color
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+TEST_APPS="$SCRIPT_DIR/../pc_test_apps"
+BINARY="$TEST_APPS/dns_bench_test"
+PORT=5353
+FAILURES=0
+SERVER_PIDS=""
+
+cleanup() {
+    for pid in $SERVER_PIDS; do
+        kill "$pid" 2>/dev/null || true
+    done
+}
+
+fail() {
+    echo -e "${RED}FAIL${NC} $1"
+    FAILURES=$((FAILURES + 1))
+}
+
+pass() {
+    echo -e "${GREEN}PASS${NC} $1"
+}
+
+start_server() {
+    python3 "$SCRIPT_DIR/dns_test_server.py" --host "$1" --port "$PORT" \
+        --cold-delay-ms "$2" --warm-delay-ms "$3" >/dev/null 2>&1 &
+    SERVER_PIDS="$SERVER_PIDS $!"
+}
+
+# resolve_field <output> <line#> <field>: fields are name source ip elapsed_us ttl
+resolve_field() {
+    echo "$1" | awk -v n="$2" -v field="$3" '$1 == "RESOLVE" { if (++seen == n) print $(field + 1) }'
+}
+
+expect() {
+    # expect <label> <actual> <expected>
+    [ "$2" = "$3" ] && pass "$1 ($2)" || fail "$1: got '$2', expected '$3'"
+}
+
+check_cache() {
+    local output
+    output=$("$BINARY" 127.0.0.1 "$PORT" www.test.example WWW.Test.Example. 10.1.2.3 \
+        short.test.example short.test.example sleep:3 short.test.example \
+        nocache.test.example nocache.test.example alias.test.example missing.test.example || true)
+    echo "$output" | grep -v -E '^(RESOLVE|CACHE) '
+
+    expect "first lookup queries the resolver" "$(resolve_field "$output" 1 2)" query
+    expect "repeat (case/dot-insensitive) hits the cache" "$(resolve_field "$output" 2 2)" cache
+    expect "cached address matches" "$(resolve_field "$output" 2 3)" "$(resolve_field "$output" 1 3)"
+    expect "IPv4 literal bypasses DNS" "$(resolve_field "$output" 3 2)" literal
+    expect "TTL 2 answer cached" "$(resolve_field "$output" 5 2)" cache
+    expect "TTL 2 answer expired after 3 s" "$(resolve_field "$output" 6 2)" query
+    expect "TTL 0 answer not cached" "$(resolve_field "$output" 8 2)" query
+    expect "CNAME chain uses lowest TTL" "$(resolve_field "$output" 9 5)" 60
+    expect "NXDOMAIN fails" "$(resolve_field "$output" 10 2)" fail
+
+    local expired
+    expired=$(echo "$output" | awk '$1 == "CACHE" { print $4 }')
+    expect "expired counter" "$expired" 1
+}
+
+check_benchmark() {
+    local output
+    output=$("$BINARY" bench "$PORT" 8 bench.example 127.0.0.1 127.0.0.2 || true)
+    echo "$output" | grep -v -E '^(BENCH|FASTEST) '
+
+    local answered cold warm
+    answered=$(echo "$output" | awk '$1 == "BENCH" && $2 == "127.0.0.1" && $3 == "cold" { print $4 "/" $5 }')
+    expect "cold queries answered" "$answered" "8/8"
+    cold=$(echo "$output" | awk '$1 == "BENCH" && $2 == "127.0.0.1" && $3 == "cold" { print $6 }')
+    warm=$(echo "$output" | awk '$1 == "BENCH" && $2 == "127.0.0.1" && $3 == "warm" { print $6 }')
+    if awk -v c="$cold" -v w="$warm" 'BEGIN { exit !(c >= 40 && w < 10) }'; then
+        pass "cold median ${cold} ms includes recursion, warm median ${warm} ms does not"
+    else
+        fail "cold median '${cold}' / warm median '${warm}' do not reflect the 40 ms recursion delay"
+    fi
+
+    expect "fastest warm resolver" "$(echo "$output" | awk '$1 == "FASTEST" { print $2 }')" 127.0.0.1
+}
+
+trap cleanup EXIT
+
+echo -e "${BLUE}Building dns_bench_test...${NC}"
+make -C "$TEST_APPS" dns_bench_test >/dev/null
+
+start_server 127.0.0.1 40 0
+start_server 127.0.0.2 10 15
+sleep 0.5
+
+echo -e "${BLUE}Resolver cache${NC}"
+check_cache
+echo -e "${BLUE}Resolver benchmark${NC}"
+check_benchmark
+
+if [ "$FAILURES" -ne 0 ]; then
+    echo -e "${RED}$FAILURES check(s) failed${NC}"
+    exit 1
+fi
+echo -e "${GREEN}All DNS checks passed${NC}"
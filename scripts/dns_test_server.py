@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+import socket
+import argparse
+import struct
+import time
+import zlib
+
+# Scripted answers for pc_test_apps/dns_bench_test (see scripts/dns_resolver_test.sh):
+#   short.*     TTL 2            nocache.*   TTL 0
+#   alias.*     CNAME (TTL 60) -> A (TTL 300)
+#   missing.*   NXDOMAIN         anything else: A, TTL 300
+# The first query for a name waits --cold-delay-ms (recursion), repeats
+# wait --warm-delay-ms (resolver cache hit).
+
+def encode_name(name):
+    out = b""
+    for label in name.rstrip(".").split("."):
+        out += bytes([len(label)]) + label.encode("ascii")
+    return out + b"\x00"
+
+def parse_question(data):
+    labels = []
+    pos = 12
+    while data[pos] != 0:
+        length = data[pos]
+        labels.append(data[pos + 1:pos + 1 + length].decode("ascii", errors="replace"))
+        pos += 1 + length
+    return ".".join(labels).lower(), pos + 5  # name, end of question
+
+def address_for(name):
+    value = zlib.crc32(name.encode()) & 0xFFFF
+    return bytes([10, 53, value >> 8, value & 0xFF])
+
+def build_response(data, name, question_end):
+    query_id = data[:2]
+    question = data[12:question_end]
+
+    if name.startswith("missing."):
+        header = query_id + struct.pack(">HHHHH", 0x8183, 1, 0, 0, 0)
+        return header + question
+
+    if name.startswith("alias."):
+        target = "target." + name.split(".", 1)[1]
+        target_wire = encode_name(target)
+        cname = struct.pack(">HHHIH", 0xC00C, 5, 1, 60, len(target_wire)) + target_wire
+        # A record owner is a compression pointer to the CNAME target
+        target_offset = 12 + len(question) + 12
+        a_record = struct.pack(">HHHIH", 0xC000 | target_offset, 1, 1, 300, 4) + address_for(target)
+        header = query_id + struct.pack(">HHHHH", 0x8180, 1, 2, 0, 0)
+        return header + question + cname + a_record
+
+    ttl = 300
+    if name.startswith("short."):
+        ttl = 2
+    elif name.startswith("nocache."):
+        ttl = 0
+    answer = struct.pack(">HHHIH", 0xC00C, 1, 1, ttl, 4) + address_for(name)
+    header = query_id + struct.pack(">HHHHH", 0x8180, 1, 1, 0, 0)
+    return header + question + answer
+
+def start_dns_server(host, port, cold_delay, warm_delay):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((host, port))
+    print(f"DNS test server on {host}:{port} (cold {cold_delay * 1000:.0f} ms, warm {warm_delay * 1000:.0f} ms)")
+    seen = set()
+
+    try:
+        while True:
+            data, addr = sock.recvfrom(512)
+            if len(data) < 17:
+                continue
+            name, question_end = parse_question(data)
+            time.sleep(warm_delay if name in seen else cold_delay)
+            seen.add(name)
+            sock.sendto(build_response(data, name, question_end), addr)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        sock.close()
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Scripted DNS server for resolver/cache tests")
+    parser.add_argument("--host", default="127.0.0.1", help="Address to bind to (default: 127.0.0.1)")
+    parser.add_argument("--port", type=int, default=5353, help="UDP port (default: 5353)")
+    parser.add_argument("--cold-delay-ms", type=float, default=40, help="Delay for first-seen names")
+    parser.add_argument("--warm-delay-ms", type=float, default=0, help="Delay for repeated names")
+
+    args = parser.parse_args()
+
+    start_dns_server(args.host, args.port, args.cold_delay_ms / 1000, args.warm_delay_ms / 1000)
@@ -0,0 +1,160 @@
+#!/bin/bash
+
+# ESP32 WiFi Utility - Path MTU namespace test
+# Builds pc_test_apps/pmtu_test (the firmware PMTU engine compiled for Linux)
+# and runs it across a path with a 1400-byte bottleneck:
+#
+#   pmtu-client 10.78.1.2 -- 10.78.1.1 pmtu-r1 10.78.2.1 ==(MTU 1400)== 10.78.2.2 pmtu-target
+#
+# r1 answers oversized DF probes with Fragmentation Needed (next-hop MTU 1400).
+# pmtu-target runs udp_echo_server on port 7 for UDP probes; port 9 is closed.
+# A final run lowers the client's own link MTU to check the plain binary search.
+# Requires root.
+
+set -e
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+BLUE='\033[0;34m'
+NC='\033[0m' # No Color
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+TEST_APPS="$SCRIPT_DIR/../pc_test_apps"
+BINARY="$TEST_APPS/pmtu_test"
+BOTTLENECK_MTU=1400
+FAILURES=0
+ECHO_PID=""
+
+NAMESPACES="pmtu-client pmtu-r1 pmtu-target"
+
+cleanup() {
+    [ -n "$ECHO_PID" ] && kill "$ECHO_PID" 2>/dev/null || true
+    for ns in $NAMESPACES; do
+        ip netns del "$ns" 2>/dev/null || true
+    done
+}
+
+fail() {
+    echo -e "${RED}FAIL${NC} $1"
+    FAILURES=$((FAILURES + 1))
+}
+
+pass() {
+    echo -e "${GREEN}PASS${NC} $1"
+}
+
+setup() {
+    cleanup
+    for ns in $NAMESPACES; do
+        ip netns add "$ns"
+        ip -n "$ns" link set lo up
+        ip netns exec "$ns" sysctl -qw net.ipv4.icmp_ratelimit=0
+    done
+
+    ip link add pmtu1a type veth peer name pmtu1b
+    ip link set pmtu1a netns pmtu-client
+    ip link set pmtu1b netns pmtu-r1
+    ip -n pmtu-client addr add 10.78.1.2/24 dev pmtu1a
+    ip -n pmtu-r1 addr add 10.78.1.1/24 dev pmtu1b
+
+    ip link add pmtu2a type veth peer name pmtu2b
+    ip link set pmtu2a netns pmtu-r1
+    ip link set pmtu2b netns pmtu-target
+    ip -n pmtu-r1 addr add 10.78.2.1/24 dev pmtu2a
+    ip -n pmtu-target addr add 10.78.2.2/24 dev pmtu2b
+    ip -n pmtu-r1 link set pmtu2a mtu "$BOTTLENECK_MTU"
+    ip -n pmtu-target link set pmtu2b mtu "$BOTTLENECK_MTU"
+
+    for dev in pmtu-client:pmtu1a pmtu-r1:pmtu1b pmtu-r1:pmtu2a pmtu-target:pmtu2b; do
+        ip -n "${dev%%:*}" link set "${dev##*:}" up
+    done
+
+    ip netns exec pmtu-r1 sysctl -qw net.ipv4.ip_forward=1
+    ip -n pmtu-client route add default via 10.78.1.1
+    ip -n pmtu-target route add default via 10.78.2.1
+
+    ip netns exec pmtu-target "$TEST_APPS/udp_echo_server" 7 >/dev/null 2>&1 &
+    ECHO_PID=$!
+    sleep 0.5
+}
+
+# field <output> <tag> <index>
+field() {
+    echo "$1" | awk -v tag="$2" -v idx="$3" '$1 == tag { print $(idx + 1) }'
+}
+
+size_field() {
+    echo "$1" | awk -v which="$2" -v idx="$3" '$1 == "SIZE" && $2 == which { print $(idx + 2) }'
+}
+
+check_discovery() {
+    local label=$1; shift
+    local output
+    output=$(ip netns exec pmtu-client "$BINARY" 10.78.2.2 "$@" || true)
+    echo "$output" | grep -v -E '^(PMTU|SIZE) '
+
+    local mtu reported reporter
+    mtu=$(field "$output" PMTU 1)
+    reported=$(field "$output" PMTU 2)
+    reporter=$(field "$output" PMTU 3)
+
+    [ "$mtu" = "$BOTTLENECK_MTU" ] && pass "$label path MTU $mtu" || fail "$label path MTU '$mtu', expected $BOTTLENECK_MTU"
+    if [ "$reported" = "$BOTTLENECK_MTU" ] && [ "$reporter" = "10.78.1.1" ]; then
+        pass "$label Fragmentation Needed ($reported) from $reporter"
+    else
+        fail "$label Fragmentation Needed '$reported' from '$reporter'"
+    fi
+
+    local above_size above_received
+    above_size=$(size_field "$output" above 1)
+    above_received=$(size_field "$output" above 3)
+    if [ "$above_size" = "$((BOTTLENECK_MTU + 1))" ] && [ "${above_received:-0}" -gt 0 ]; then
+        pass "$label fragmented $above_size-byte probes delivered ($above_received)"
+    else
+        fail "$label fragmented probes: size '$above_size' received '$above_received'"
+    fi
+}
+
+check_local_mtu() {
+    # Our own link is the bottleneck: no ICMP feedback, pure binary search
+    ip -n pmtu-client link set pmtu1a mtu 1280
+    ip -n pmtu-r1 link set pmtu1b mtu 1280
+
+    local output mtu reported steps
+    output=$(ip netns exec pmtu-client "$BINARY" 10.78.2.2 icmp 7 0 || true)
+    mtu=$(field "$output" PMTU 1)
+    reported=$(field "$output" PMTU 2)
+    steps=$(field "$output" PMTU 5)
+    if [ "$mtu" = "1280" ] && [ "$reported" = "0" ]; then
+        pass "local MTU 1280 found by binary search in $steps steps"
+    else
+        fail "local MTU: got '$mtu' (reported '$reported')"
+    fi
+}
+
+if [ "$(id -u)" -ne 0 ]; then
+    echo -e "${RED}This test needs root (network namespaces and raw sockets)${NC}"
+    exit 1
+fi
+
+trap cleanup EXIT
+
+echo -e "${BLUE}Building pmtu_test and udp_echo_server...${NC}"
+make -C "$TEST_APPS" pmtu_test udp_echo_server >/dev/null
+
+setup
+
+echo -e "${BLUE}ICMP probes${NC}"
+check_discovery icmp icmp
+echo -e "${BLUE}UDP probes to echo server${NC}"
+check_discovery udp-echo udp 7
+echo -e "${BLUE}UDP probes to closed port${NC}"
+check_discovery udp-closed udp 9 5
+echo -e "${BLUE}Local interface MTU${NC}"
+check_local_mtu
+
+if [ "$FAILURES" -ne 0 ]; then
+    echo -e "${RED}$FAILURES check(s) failed${NC}"
+    exit 1
+fi
+echo -e "${GREEN}All PMTU checks passed${NC}"
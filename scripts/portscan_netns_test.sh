@@ -0,0 +1,360 @@
+#!/bin/bash
+
+# ESP32 WiFi Utility - Port scanner namespace test
+# Builds pc_test_apps/portscan_test (the firmware scan engine compiled for
+# Linux) and runs it across a routed path:
+#
+#   scan-client 10.79.1.2 -- 10.79.1.1 scan-r1 10.79.2.1 -- 10.79.2.2 scan-target
+#
+# scan-target listens on a few TCP ports; every other port answers with RST.
+# The open ports greet like SSH and SMTP, answer HEAD like an HTTP server, or
+# stay silent, for the fingerprinting pass.
+# The range scan is repeated over a multi-range port set and re-checked with
+# the result bitmap as a mask.
+# Ports 2001-2040 have a full accept queue (backlog 0, already filled from
+# inside scan-target), so Linux drops their SYNs: they look filtered. They
+# compare fixed 1000 ms timeouts with RTT-adaptive ones.
+# r1 blackholes 10.79.9.9, so connects there are silently dropped and only
+# the window bounds how long a scan of that host takes.
+# For the UDP scan, scan-target answers echo (7), DNS (53) and NTP (123)
+# probes, reads but never answers SNMP (161), and sends ICMP port unreachable
+# for every other port (rate limit lifted so each one is answered).
+# Requires root.
+
+set -e
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+BLUE='\033[0;34m'
+NC='\033[0m' # No Color
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+TEST_APPS="$SCRIPT_DIR/../pc_test_apps"
+BINARY="$TEST_APPS/portscan_test"
+OPEN_PORTS="22 80 443 1000"
+UDP_OPEN_PORTS="7 53 123"
+UDP_SILENT_PORT=161
+DROP_TIMEOUT_MS=300
+DROP_PORTS=16
+FILTERED_FIRST=2001
+FILTERED_LAST=2040
+FAILURES=0
+LISTENER_PID=""
+UDP_LISTENER_PID=""
+
+NAMESPACES="scan-client scan-r1 scan-target"
+
+cleanup() {
+    [ -n "$LISTENER_PID" ] && kill "$LISTENER_PID" 2>/dev/null || true
+    [ -n "$UDP_LISTENER_PID" ] && kill "$UDP_LISTENER_PID" 2>/dev/null || true
+    for ns in $NAMESPACES; do
+        ip netns del "$ns" 2>/dev/null || true
+    done
+}
+
+fail() {
+    echo -e "${RED}FAIL${NC} $1"
+    FAILURES=$((FAILURES + 1))
+}
+
+pass() {
+    echo -e "${GREEN}PASS${NC} $1"
+}
+
+setup() {
+    cleanup
+    for ns in $NAMESPACES; do
+        ip netns add "$ns"
+        ip -n "$ns" link set lo up
+    done
+
+    ip link add scan1a type veth peer name scan1b
+    ip link set scan1a netns scan-client
+    ip link set scan1b netns scan-r1
+    ip -n scan-client addr add 10.79.1.2/24 dev scan1a
+    ip -n scan-r1 addr add 10.79.1.1/24 dev scan1b
+
+    ip link add scan2a type veth peer name scan2b
+    ip link set scan2a netns scan-r1
+    ip link set scan2b netns scan-target
+    ip -n scan-r1 addr add 10.79.2.1/24 dev scan2a
+    ip -n scan-target addr add 10.79.2.2/24 dev scan2b
+
+    for dev in scan-client:scan1a scan-r1:scan1b scan-r1:scan2a scan-target:scan2b; do
+        ip -n "${dev%%:*}" link set "${dev##*:}" up
+    done
+
+    ip netns exec scan-r1 sysctl -qw net.ipv4.ip_forward=1
+    ip -n scan-r1 route add blackhole 10.79.9.9/32
+    ip -n scan-client route add default via 10.79.1.1
+    ip -n scan-target route add default via 10.79.2.1
+    ip netns exec scan-target sysctl -qw net.ipv4.icmp_ratelimit=0
+
+    ip netns exec scan-target python3 -c "
+import socket, sys, threading, time
+keep = []
+GREETINGS = {22: b'SSH-2.0-OpenSSH_9.6\\r\\n', 1000: b'220 mail.example.com ESMTP Postfix\\r\\n'}
+def serve(conn, port):
+    try:
+        if port in GREETINGS:
+            conn.sendall(GREETINGS[port])
+        request = conn.recv(256)
+        if port == 80 and request.startswith(b'HEAD'):
+            conn.sendall(b'HTTP/1.0 200 OK\\r\\nDate: Sat, 18 Oct 2026 12:00:00 GMT\\r\\nServer: TestHTTP/1.0\\r\\n\\r\\n')
+        time.sleep(5)  # 443 stays silent
+    except OSError:
+        pass
+    conn.close()
+def accept(s, port):
+    while True:
+        conn, _ = s.accept()
+        threading.Thread(target=serve, args=(conn, port), daemon=True).start()
+def listen(port, backlog):
+    s = socket.socket()
+    s.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    s.bind(('0.0.0.0', port))
+    s.listen(backlog)
+    keep.append(s)
+    return s
+for port in sys.argv[3:]:
+    threading.Thread(target=accept, args=(listen(int(port), 64), int(port)), daemon=True).start()
+for port in range(int(sys.argv[1]), int(sys.argv[2]) + 1):
+    listen(port, 0)
+    for _ in range(2):  # Fill the accept queue; later SYNs are dropped
+        c = socket.socket()
+        c.setblocking(False)
+        c.connect_ex(('127.0.0.1', port))
+        keep.append(c)
+time.sleep(3600)
+" $FILTERED_FIRST $FILTERED_LAST $OPEN_PORTS &
+    LISTENER_PID=$!
+
+    ip netns exec scan-target python3 -c "
+import select, socket, sys
+sockets = {}
+for port in map(int, sys.argv[1:]):
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    s.bind(('0.0.0.0', port))
+    sockets[s] = port
+while True:
+    for s in select.select(list(sockets), [], [])[0]:
+        data, peer = s.recvfrom(512)
+        port = sockets[s]
+        if port == 53 and len(data) >= 12:
+            s.sendto(data[:2] + b'\x81\x80' + data[4:], peer)  # Response, no answers
+        elif port == 123 and len(data) == 48 and data[0] == 0x1b:
+            s.sendto(b'\x1c' + bytes(47), peer)  # Server mode
+        elif port == 7:
+            s.sendto(data, peer)
+" $UDP_OPEN_PORTS $UDP_SILENT_PORT &
+    UDP_LISTENER_PID=$!
+    sleep 0.5
+}
+
+scan_field() {
+    echo "$1" | awk -v idx="$2" '$1 == "SCAN" { print $(idx + 1) }'
+}
+
+check_range_scan() {
+    local output found
+    output=$(ip netns exec scan-client "$BINARY" 10.79.2.2 1-1024 8 1000 recheck || true)
+    echo "$output" | grep -v -E '^(OPEN|SCAN|RTT|RECHECK) '
+
+    found=$(echo "$output" | awk '$1 == "OPEN" { print $2 }' | sort -n | tr '\n' ' ' | sed 's/ $//')
+    [ "$found" = "$OPEN_PORTS" ] && pass "open ports found ($found)" || fail "open ports '$found', expected '$OPEN_PORTS'"
+
+    local names
+    names=$(echo "$output" | awk '$1 == "OPEN" { print $2 ":" $4 }' | sort -n | tr '\n' ' ' | sed 's/ $//')
+    [ "$names" = "22:SSH 80:HTTP 443:HTTPS 1000:Unknown" ] && pass "registered service names ($names)" ||
+        fail "service names '$names'"
+
+    local scanned closed
+    scanned=$(scan_field "$output" 1)
+    closed=$(scan_field "$output" 3)
+    [ "$scanned" = "1024" ] && pass "every port reported once ($scanned)" || fail "scanned '$scanned', expected 1024"
+    [ "$closed" = "1020" ] && pass "remaining ports closed by RST ($closed)" || fail "closed '$closed', expected 1020"
+
+    local recheck
+    recheck=$(echo "$output" | awk '$1 == "RECHECK" { print $2 "/" $3 }')
+    [ "$recheck" = "4/4" ] && pass "bitmap-masked recheck probes only open ports ($recheck)" || fail "recheck '$recheck', expected 4/4"
+}
+
+check_range_list() {
+    local output found scanned
+    output=$(ip netns exec scan-client "$BINARY" 10.79.2.2 20-25,79-81,440-450,999-1001,60000-60010 8 1000 || true)
+    found=$(echo "$output" | awk '$1 == "OPEN" { print $2 }' | sort -n | tr '\n' ' ' | sed 's/ $//')
+    scanned=$(scan_field "$output" 1)
+    [ "$found" = "$OPEN_PORTS" ] && pass "range list finds open ports ($found)" || fail "range list open '$found'"
+    [ "$scanned" = "34" ] && pass "range list yields only listed ports ($scanned)" || fail "range list scanned '$scanned', expected 34"
+}
+
+service_field() {
+    echo "$1" | awk -v port="$2" '$1 == "SERVICE" && $2 == port { $1 = ""; $2 = ""; sub(/^ +/, ""); print }'
+}
+
+check_banners() {
+    # Window 8: the silent port's full timeout bounds the pass, not the sum
+    local output elapsed
+    output=$(ip netns exec scan-client "$BINARY" 10.79.2.2 1-1024 8 1000 recheck banners || true)
+    echo "$output" | grep -E '^(  +[0-9]+  |Fingerprinted)'
+
+    [ "$(service_field "$output" 22)" = "SSH SSH-2.0-OpenSSH_9.6" ] && pass "SSH banner read" ||
+        fail "port 22: '$(service_field "$output" 22)'"
+    [ "$(service_field "$output" 80)" = "HTTP TestHTTP/1.0" ] && pass "HTTP server header from HEAD probe" ||
+        fail "port 80: '$(service_field "$output" 80)'"
+    [ "$(service_field "$output" 1000)" = "SMTP 220 mail.example.com ESMTP Postfix" ] &&
+        pass "SMTP greeting identified on a non-standard port" || fail "port 1000: '$(service_field "$output" 1000)'"
+    [ "$(service_field "$output" 443)" = "-" ] && pass "silent port left unidentified" ||
+        fail "port 443: '$(service_field "$output" 443)'"
+
+    local first second
+    first=$(echo "$output" | awk '$1 == "BANNERS" { print; exit }')
+    second=$(echo "$output" | awk '$1 == "BANNERS" { line = $0 } END { print line }')
+    elapsed=$(echo "$first" | awk '{ print $5 }')
+    if [ "$(echo "$first" | awk '{ print $3 }')" = "3" ] && [ "${elapsed:-999999}" -le 1300 ]; then
+        pass "3 of 4 services identified in ${elapsed} ms (one 1000 ms timeout)"
+    else
+        fail "fingerprint pass: '$first' (expected 3 identified in <= 1300 ms)"
+    fi
+    [ "$(echo "$second" | awk '{ print $4 }')" = "3" ] && pass "repeat pass served from cache ($second)" ||
+        fail "repeat pass: '$second' (expected 3 cached)"
+}
+
+check_adaptive() {
+    # 1000 ms timeout; the target answers RST/SYN-ACK in well under a millisecond
+    local ranges="1-1024,$FILTERED_FIRST-$FILTERED_LAST"
+    local filtered_count=$((FILTERED_LAST - FILTERED_FIRST + 1))
+    local fixed adaptive fixed_ms adaptive_ms
+    fixed=$(ip netns exec scan-client "$BINARY" 10.79.2.2 "$ranges" 8 1000 fixed || true)
+    adaptive=$(ip netns exec scan-client "$BINARY" 10.79.2.2 "$ranges" 8 1000 || true)
+    echo "$adaptive" | grep -E '^(Done|SRTT)'
+
+    local found closed filtered
+    found=$(scan_field "$adaptive" 2)
+    closed=$(scan_field "$adaptive" 3)
+    filtered=$(scan_field "$adaptive" 4)
+    [ "$found" = "4" ] && pass "adaptive scan finds open ports ($found)" || fail "adaptive open '$found', expected 4"
+    [ "$closed" = "1020" ] && pass "RST ports reported closed ($closed)" || fail "closed '$closed', expected 1020"
+    [ "$filtered" = "$filtered_count" ] && pass "silent ports reported filtered ($filtered)" || fail "filtered '$filtered', expected $filtered_count"
+
+    local timeout_ms
+    timeout_ms=$(echo "$adaptive" | awk '$1 == "RTT" { print $4 }')
+    [ "$timeout_ms" = "100" ] && pass "probe timeout adapted to ${timeout_ms} ms floor" || fail "probe timeout '$timeout_ms', expected 100"
+
+    local rtt_max
+    rtt_max=$(echo "$adaptive" | awk '$1 == "OPEN" && $3 > max { max = $3 } END { print max + 0 }')
+    [ "$rtt_max" -lt 100000 ] && pass "open port response times measured (max ${rtt_max} us)" || fail "open port response time '$rtt_max' us"
+
+    fixed_ms=$(scan_field "$fixed" 6)
+    adaptive_ms=$(scan_field "$adaptive" 6)
+    if [ "$(scan_field "$fixed" 4)" = "$filtered_count" ] && [ "${adaptive_ms:-999999}" -le $((fixed_ms / 3)) ]; then
+        pass "fixed timeouts: ${fixed_ms} ms, adaptive: ${adaptive_ms} ms"
+    else
+        fail "fixed timeouts: '${fixed_ms}' ms, adaptive: '${adaptive_ms}' ms (expected <= 1/3)"
+    fi
+}
+
+check_window() {
+    # Dropped SYNs: serial scan costs ports x timeout, the window divides it
+    local serial parallel serial_ms parallel_ms timeouts
+    serial=$(ip netns exec scan-client "$BINARY" 10.79.9.9 "1-$DROP_PORTS" 1 "$DROP_TIMEOUT_MS" fixed || true)
+    parallel=$(ip netns exec scan-client "$BINARY" 10.79.9.9 "1-$DROP_PORTS" 8 "$DROP_TIMEOUT_MS" fixed || true)
+    serial_ms=$(scan_field "$serial" 6)
+    parallel_ms=$(scan_field "$parallel" 6)
+    timeouts=$(scan_field "$parallel" 4)
+
+    [ "$timeouts" = "$DROP_PORTS" ] && pass "dropped connects reported filtered ($timeouts)" || fail "filtered '$timeouts', expected $DROP_PORTS"
+
+    local serial_min=$((DROP_PORTS * DROP_TIMEOUT_MS))
+    local parallel_max=$((DROP_PORTS / 8 * DROP_TIMEOUT_MS + DROP_TIMEOUT_MS))
+    if [ "${serial_ms:-0}" -ge "$serial_min" ] && [ "${parallel_ms:-999999}" -le "$parallel_max" ]; then
+        pass "window 1: ${serial_ms} ms, window 8: ${parallel_ms} ms"
+    else
+        fail "window 1: '${serial_ms}' ms (>= $serial_min), window 8: '${parallel_ms}' ms (<= $parallel_max)"
+    fi
+}
+
+check_unanswered() {
+    # No RTT samples: adaptive mode must not shorten timeouts or retry
+    local output elapsed
+    output=$(ip netns exec scan-client "$BINARY" 10.79.9.9 "1-$DROP_PORTS" 8 "$DROP_TIMEOUT_MS" || true)
+    elapsed=$(scan_field "$output" 6)
+    if [ "$(scan_field "$output" 4)" = "$DROP_PORTS" ] && [ "${elapsed:-0}" -ge $((DROP_PORTS / 8 * DROP_TIMEOUT_MS)) ] &&
+        [ "${elapsed:-999999}" -le $((DROP_PORTS / 8 * DROP_TIMEOUT_MS + DROP_TIMEOUT_MS)) ]; then
+        pass "all $DROP_PORTS ports filtered after the full ${DROP_TIMEOUT_MS} ms (${elapsed} ms)"
+    else
+        fail "unanswered host: '$(scan_field "$output" 4)' filtered in '${elapsed}' ms"
+    fi
+}
+
+check_udp() {
+    local output found closed open_filtered
+    output=$(ip netns exec scan-client "$BINARY" 10.79.2.2 1-200 8 500 udp || true)
+    echo "$output" | grep -E '^(Done|Cancelled|No raw)'
+
+    found=$(echo "$output" | awk '$1 == "OPEN" { print $2 }' | sort -n | tr '\n' ' ' | sed 's/ $//')
+    closed=$(scan_field "$output" 3)
+    open_filtered=$(scan_field "$output" 7)
+    [ "$found" = "$UDP_OPEN_PORTS" ] && pass "answered payloads mark UDP ports open ($found)" ||
+        fail "UDP open '$found', expected '$UDP_OPEN_PORTS'"
+    local names
+    names=$(echo "$output" | awk '$1 == "OPEN" { print $2 ":" $4 }' | sort -n | tr '\n' ' ' | sed 's/ $//')
+    [ "$names" = "7:Echo 53:DNS 123:NTP" ] && pass "UDP service names ($names)" || fail "UDP service names '$names'"
+    [ "$closed" = "196" ] && pass "ICMP port unreachable reported closed ($closed)" || fail "UDP closed '$closed', expected 196"
+    [ "$open_filtered" = "1" ] && pass "silent listener reported open|filtered ($open_filtered)" ||
+        fail "UDP open|filtered '$open_filtered', expected 1"
+
+    # Blackholed host: every attempt (first + retry) waits the full timeout
+    local dropped elapsed
+    dropped=$(ip netns exec scan-client "$BINARY" 10.79.9.9 "1-$DROP_PORTS" 8 "$DROP_TIMEOUT_MS" udp || true)
+    elapsed=$(scan_field "$dropped" 6)
+    if [ "$(scan_field "$dropped" 7)" = "$DROP_PORTS" ] &&
+        [ "${elapsed:-999999}" -le $((2 * (DROP_PORTS / 8 + 1) * DROP_TIMEOUT_MS)) ]; then
+        pass "unanswered UDP ports open|filtered after one retry (${elapsed} ms)"
+    else
+        fail "unanswered UDP: '$(scan_field "$dropped" 7)' open|filtered in '${elapsed}' ms"
+    fi
+
+    # 200 probes at 100 per second take about two seconds
+    local paced paced_ms
+    paced=$(ip netns exec scan-client "$BINARY" 10.79.2.2 1-200 8 500 udp rate=100 || true)
+    paced_ms=$(scan_field "$paced" 6)
+    if [ "$(scan_field "$paced" 3)" = "196" ] && [ "${paced_ms:-0}" -ge 1900 ]; then
+        pass "probe rate limited to 100/s (${paced_ms} ms)"
+    else
+        fail "rate-limited scan: '$(scan_field "$paced" 3)' closed in '${paced_ms}' ms (expected >= 1900)"
+    fi
+}
+
+if [ "$(id -u)" -ne 0 ]; then
+    echo -e "${RED}This test needs root (network namespaces)${NC}"
+    exit 1
+fi
+
+trap cleanup EXIT
+
+echo -e "${BLUE}Building portscan_test...${NC}"
+make -C "$TEST_APPS" portscan_test >/dev/null
+
+setup
+
+echo -e "${BLUE}Range scan 1-1024${NC}"
+check_range_scan
+echo -e "${BLUE}Range list${NC}"
+check_range_list
+echo -e "${BLUE}Service fingerprinting${NC}"
+check_banners
+echo -e "${BLUE}Fixed vs RTT-adaptive timeouts${NC}"
+check_adaptive
+echo -e "${BLUE}Silently dropped connects${NC}"
+check_window
+echo -e "${BLUE}Unanswered host keeps the full timeout${NC}"
+check_unanswered
+echo -e "${BLUE}UDP scan${NC}"
+check_udp
+
+if [ "$FAILURES" -ne 0 ]; then
+    echo -e "${RED}$FAILURES check(s) failed${NC}"
+    exit 1
+fi
+echo -e "${GREEN}All port scan checks passed${NC}"
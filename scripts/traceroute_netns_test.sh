@@ -0,0 +1,188 @@
+#!/bin/bash
+
+# ESP32 WiFi Utility - Traceroute namespace test
+# Builds pc_test_apps/traceroute_test (the firmware traceroute engine compiled
+# for Linux) and runs it across a three-hop path of network namespaces:
+#
+#   trc-client 10.77.1.2 -- 10.77.1.1 trc-r1 10.77.2.1 -- 10.77.2.2 trc-r2 10.77.3.1 -- 10.77.3.2 trc-target
+#
+# netem adds delay on the r2 -> target link, so only the last hop may show it.
+# r2 also owns an unreachable route (10.77.9.0/24) to exercise !N/!H handling.
+# Requires root.
+
+set -e
+
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+BLUE='\033[0;34m'
+YELLOW='\033[1;33m'
+NC='\033[0m' # No Color
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+TEST_APPS="$SCRIPT_DIR/../pc_test_apps"
+BINARY="$TEST_APPS/traceroute_test"
+DELAY_MS=40
+HAVE_NETEM=1
+FAILURES=0
+
+NAMESPACES="trc-client trc-r1 trc-r2 trc-target"
+
+cleanup() {
+    for ns in $NAMESPACES; do
+        ip netns del "$ns" 2>/dev/null || true
+    done
+}
+
+fail() {
+    echo -e "${RED}FAIL${NC} $1"
+    FAILURES=$((FAILURES + 1))
+}
+
+pass() {
+    echo -e "${GREEN}PASS${NC} $1"
+}
+
+link() {
+    # link <ns-a> <addr-a> <ns-b> <addr-b> <name>
+    ip link add "$5a" type veth peer name "$5b"
+    ip link set "$5a" netns "$1"
+    ip link set "$5b" netns "$3"
+    ip -n "$1" addr add "$2/24" dev "$5a"
+    ip -n "$3" addr add "$4/24" dev "$5b"
+    ip -n "$1" link set "$5a" up
+    ip -n "$3" link set "$5b" up
+}
+
+setup() {
+    cleanup
+    for ns in $NAMESPACES; do
+        ip netns add "$ns"
+        ip -n "$ns" link set lo up
+        # Routers must answer every probe, not the default rate-limited subset
+        ip netns exec "$ns" sysctl -qw net.ipv4.icmp_ratelimit=0
+    done
+
+    link trc-client 10.77.1.2 trc-r1 10.77.1.1 trc1
+    link trc-r1 10.77.2.1 trc-r2 10.77.2.2 trc2
+    link trc-r2 10.77.3.1 trc-target 10.77.3.2 trc3
+
+    ip netns exec trc-r1 sysctl -qw net.ipv4.ip_forward=1
+    ip netns exec trc-r2 sysctl -qw net.ipv4.ip_forward=1
+
+    ip -n trc-client route add default via 10.77.1.1
+    ip -n trc-r1 route add default via 10.77.2.2
+    ip -n trc-r2 route add default via 10.77.2.1
+    ip -n trc-r2 route add 10.77.3.0/24 dev trc3a 2>/dev/null || true
+    ip -n trc-r2 route add unreachable 10.77.9.0/24
+    ip -n trc-target route add default via 10.77.3.1
+
+    if ! ip netns exec trc-r2 tc qdisc add dev trc3a root netem delay "${DELAY_MS}ms" 2>/dev/null; then
+        echo -e "${YELLOW}netem unavailable (sch_netem not loaded): skipping latency attribution checks${NC}"
+        HAVE_NETEM=0
+    fi
+}
+
+# hop_field <output> <ttl> <field>: fields are ttl addr sent received avg flags
+hop_field() {
+    echo "$1" | awk -v ttl="$2" -v field="$3" '$1 == "HOP" && $2 == ttl { print $(field + 1) }'
+}
+
+check_path() {
+    local mode=$1 rounds=$2
+    local output
+    output=$(ip netns exec trc-client "$BINARY" 10.77.3.2 "$mode" "$rounds" || true)
+    echo "$output" | grep -v '^HOP'
+
+    local expected=("10.77.1.1" "10.77.2.2" "10.77.3.2")
+    for ttl in 1 2 3; do
+        local addr
+        addr=$(hop_field "$output" "$ttl" 2)
+        if [ "$addr" = "${expected[$((ttl - 1))]}" ]; then
+            pass "$mode hop $ttl is $addr"
+        else
+            fail "$mode hop $ttl expected ${expected[$((ttl - 1))]}, got '$addr'"
+        fi
+    done
+
+    if [ -n "$(hop_field "$output" 4 2)" ]; then
+        fail "$mode reported hops beyond the destination"
+    fi
+
+    local flags
+    flags=$(hop_field "$output" 3 6)
+    [[ "$flags" == *dest* ]] && pass "$mode hop 3 flagged as destination" || fail "$mode hop 3 flags '$flags'"
+
+    local sent received
+    sent=$(hop_field "$output" 3 3)
+    received=$(hop_field "$output" 3 4)
+    if [ "$sent" = "$((rounds * 3))" ] && [ "$received" = "$sent" ]; then
+        pass "$mode hop 3 answered $received/$sent probes"
+    else
+        fail "$mode hop 3 answered $received/$sent probes, expected $((rounds * 3))"
+    fi
+
+    [ "$HAVE_NETEM" -eq 1 ] || return 0
+
+    # Delay sits on the last link: hops 1-2 stay fast, hop 3 carries it
+    local avg2 avg3
+    avg2=$(hop_field "$output" 2 5)
+    avg3=$(hop_field "$output" 3 5)
+    if awk -v a="$avg2" -v d="$DELAY_MS" 'BEGIN { exit !(a < d / 2) }'; then
+        pass "$mode hop 2 latency ${avg2}ms is below the injected delay"
+    else
+        fail "$mode hop 2 latency ${avg2}ms picked up the downstream delay"
+    fi
+    if awk -v a="$avg3" -v d="$DELAY_MS" 'BEGIN { exit !(a >= d) }'; then
+        pass "$mode hop 3 latency ${avg3}ms includes the ${DELAY_MS}ms delay"
+    else
+        fail "$mode hop 3 latency ${avg3}ms is missing the ${DELAY_MS}ms delay"
+    fi
+}
+
+check_unreachable() {
+    # Unreachable-route errors are rate limited per peer by the kernel
+    # (net.ipv4.route.error_cost, not per-namespace) and share the bucket with
+    # Time Exceeded replies: run this first and send one probe per TTL
+    local output
+    output=$(ip netns exec trc-client "$BINARY" 10.77.9.9 udp 1 1 1 || true)
+    echo "$output" | grep -v '^HOP'
+
+    local addr flags
+    addr=$(hop_field "$output" 2 2)
+    flags=$(hop_field "$output" 2 6)
+    if [ "$addr" = "10.77.2.2" ] && [[ "$flags" == *unreach* ]]; then
+        pass "unreachable route reported by hop 2 ($flags)"
+    else
+        fail "unreachable route: hop 2 '$addr' flags '$flags'"
+    fi
+    if [ -n "$(hop_field "$output" 3 2)" ]; then
+        fail "probing continued past the unreachable hop"
+    fi
+}
+
+if [ "$(id -u)" -ne 0 ]; then
+    echo -e "${RED}This test needs root (network namespaces and raw sockets)${NC}"
+    exit 1
+fi
+
+trap cleanup EXIT
+
+echo -e "${BLUE}Building traceroute_test...${NC}"
+make -C "$TEST_APPS" traceroute_test >/dev/null
+
+setup
+
+echo -e "${BLUE}Unreachable destination${NC}"
+check_unreachable
+echo -e "${BLUE}UDP probes${NC}"
+check_path udp 1
+echo -e "${BLUE}ICMP probes${NC}"
+check_path icmp 1
+echo -e "${BLUE}MTR mode (3 rounds)${NC}"
+check_path udp 3
+
+if [ "$FAILURES" -ne 0 ]; then
+    echo -e "${RED}$FAILURES check(s) failed${NC}"
+    exit 1
+fi
+echo -e "${GREEN}All traceroute checks passed${NC}"
@@ -4,12 +4,15 @@
 #include "config.h"
 #include "wifi_manager.h"
 #include "wifi_task.h"
+#include "wifi_scan.h"
 #include "ap_manager.h"
 #include "led_controller.h"
 #include "command_interface.h"
 #include "iperf_manager.h"
 #include "latency_analyzer.h"
 #include "channel_analyzer.h"
+#include "airtime_monitor.h"
+#include "rogue_detector.h"
 #include "signal_monitor.h"
 #include "port_scanner.h"
 #ifdef USE_WEBSERVER
@@ -35,14 +38,15 @@ void setup() {
   delay(2000);
 #endif
   
-  // Initialize WiFi (will be configured by user commands)
-  initializeWiFi();
-  
-  // Initialize WiFi command task (FreeRTOS)
+  // Initialize WiFi command task (FreeRTOS) first: it runs station connections,
+  // including the boot auto-connect
   if (!initWiFiTask()) {
     Serial.println("❌ Failed to initialize WiFi command task");
   }
   
+  // Initialize WiFi (will be configured by user commands)
+  initializeWiFi();
+  
   // Initialize iPerf manager
   initializeIperf();
   
@@ -52,6 +56,9 @@ void setup() {
   // Initialize channel analyzer
   initializeChannelAnalysis();
   
+  // Load rogue AP profiles
+  initializeRogueDetector();
+  
   // Initialize port scanner
   initializePortScanner();
   
@@ -68,8 +75,8 @@ void loop() {
   // Handle serial commands directly in loop
   handleSerialCommands();
   
-  // Handle WiFi connection monitoring (non-blocking)
-  handleWiFiConnection();
+  // Publish completed background scans and run their callbacks
+  handleWiFiScan();
   
   // Handle iPerf background tasks
   handleIperfTasks();
@@ -80,12 +87,15 @@ void loop() {
   // Handle channel monitoring background tasks
   handleChannelMonitoringTasks();
   
+  // Report finished airtime surveys
+  handleAirtimeSurvey();
+  
+  // Check scans for rogue access points
+  handleRogueDetector();
+  
   // Handle signal monitoring background tasks
   updateSignalMonitoring();
   
-  // Handle port scanner background tasks
-  handlePortScanTasks();
-  
 #ifdef USE_WEBSERVER
   // Handle web server requests
   handleWebServerRequests();
@@ -95,8 +105,9 @@ void loop() {
 #endif
   
   // WiFi scanning logic (only in station mode)
-  if (scanningEnabled && currentMode == MODE_STATION && (millis() - lastScan >= SCAN_INTERVAL)) {
-    performWiFiScan();
+  if (scanningEnabled && currentMode == MODE_STATION && !isWiFiScanRunning() &&
+      !isAirtimeSurveyRunning() && (millis() - lastScan >= SCAN_INTERVAL)) {
+    performWiFiScanUpdate();  // Full table first, then only the changes
     lastScan = millis();
   }
   